@@ -8,6 +8,8 @@ def register_scons_options(env, is_extension):
 
     env_vars.Add(BoolVariable("voxel_tests", 
         "Build with tests for the voxel module, which will run on startup of the engine", False))
+    env_vars.Add(BoolVariable("voxel_benchmarks", 
+        "Build with benchmarks for the voxel module, which can be run from the command line or script", False))
     
     env_vars.Add(BoolVariable("voxel_smooth_meshing", "Build with smooth voxels meshing support", True))
     env_vars.Add(BoolVariable("voxel_modifiers", "Build with experimental modifiers support", True))
@@ -42,6 +44,7 @@ def get_sources(env, is_editor_build):
     ])
     
     tests_enabled = env["voxel_tests"]
+    benchmarks_enabled = env["voxel_benchmarks"]
     smoosh_meshing_enabled = env["voxel_smooth_meshing"]
     modifiers_enabled = env["voxel_modifiers"]
     sqlite_enabled = env["voxel_sqlite"]
@@ -183,26 +186,46 @@ def get_sources(env, is_editor_build):
         env.Append(CPPDEFINES={"VOXEL_TESTS": 1})
 
         sources += [
-            "util/testing/*.cpp",
-
             "tests/*.cpp",
             "tests/util/*.cpp",
 
+            "tests/voxel/test_async_edit_queue.cpp",
             "tests/voxel/test_block_serializer.cpp",
+            "tests/voxel/test_clipbox_streaming.cpp",
             "tests/voxel/test_curve_range.cpp",
             "tests/voxel/test_edition_funcs.cpp",
+            "tests/voxel/test_load_block_data_task.cpp",
+            "tests/voxel/test_mesh_apply_queue.cpp",
+            "tests/voxel/test_mesh_block_cache.cpp",
+            "tests/voxel/test_mesh_block_task.cpp",
             "tests/voxel/test_octree.cpp",
             "tests/voxel/test_raycast.cpp",
             "tests/voxel/test_region_file.cpp",
             "tests/voxel/test_storage_funcs.cpp",
             "tests/voxel/test_util.cpp",
+            "tests/voxel/test_voxel_a_star_grid_3d.cpp",
+            "tests/voxel/test_voxel_box_mover.cpp",
             "tests/voxel/test_voxel_buffer.cpp",
             "tests/voxel/test_voxel_data_map.cpp",
+            "tests/voxel/test_voxel_generator_multipass_cb.cpp",
             "tests/voxel/test_voxel_graph.cpp",
             "tests/voxel/test_voxel_instancer.cpp",
             "tests/voxel/test_voxel_mesher_cubes.cpp",
         ]
 
+    if benchmarks_enabled:
+        env.Append(CPPDEFINES={"VOXEL_BENCHMARKS": 1})
+
+        sources += [
+            "tests/benchmarks/*.cpp",
+        ]
+
+    if tests_enabled or benchmarks_enabled:
+        # Shared between tests and benchmarks
+        sources += [
+            "util/testing/*.cpp",
+        ]
+
     if smoosh_meshing_enabled:
         env.Append(CPPDEFINES={"VOXEL_ENABLE_SMOOTH_MESHING": 1})
 
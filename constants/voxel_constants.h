@@ -55,6 +55,12 @@ static const unsigned int DEFAULT_BLOCK_SIZE_PO2 = 4;
 
 static const float DEFAULT_COLLISION_MARGIN = 0.04f;
 
+static const int MAX_MESH_CACHE_SIZE_MB = 4096;
+static const int MAX_EDIT_JOURNAL_SIZE_MB = 4096;
+
+// Upper limit for main thread time budgets set on terrains
+static const int MAX_MAIN_THREAD_BUDGET_USEC = 100000;
+
 // By default, tasks are sorted first by the value of band2.
 // When equal, they are sorted by band1, which usually depends on LOD.
 // When equal, they are sorted by band0, which depends on distance from viewer (when relevant).
@@ -116,6 +116,8 @@ VoxelStringNames::VoxelStringNames() {
 
 	_on_async_search_completed = StringName("_on_async_search_completed");
 	async_search_completed = StringName("async_search_completed");
+	_on_async_batch_search_completed = StringName("_on_async_batch_search_completed");
+	async_batch_search_completed = StringName("async_batch_search_completed");
 
 	file_selected = StringName("file_selected");
 
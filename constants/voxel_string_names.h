@@ -104,6 +104,8 @@ public:
 
 	StringName _on_async_search_completed;
 	StringName async_search_completed;
+	StringName _on_async_batch_search_completed;
+	StringName async_batch_search_completed;
 
 	StringName file_selected;
 
@@ -1,6 +1,11 @@
 #include "floating_chunks.h"
 #include "../constants/voxel_string_names.h"
+#include "../engine/voxel_engine.h"
+#include "../meshers/mesh_block_task.h"
 #include "../storage/voxel_buffer.h"
+#include "../storage/voxel_data.h"
+#include "../terrain/voxel_node.h"
+#include "../util/block_island_finder.h"
 #include "../util/godot/classes/array_mesh.h"
 #include "../util/godot/classes/collision_shape_3d.h"
 #include "../util/godot/classes/convex_polygon_shape_3d.h"
@@ -10,9 +15,13 @@
 #include "../util/godot/classes/shader.h"
 #include "../util/godot/classes/shader_material.h"
 #include "../util/godot/classes/timer.h"
-#include "../util/island_finder.h"
+#include "../util/godot/object_weak_ref.h"
+#include "../util/io/log.h"
+#include "../util/memory/linear_allocator.h"
+#include "../util/memory/memory.h"
 #include "../util/profiling.h"
 #include "voxel_tool.h"
+#include <cstring>
 
 #ifdef ZN_GODOT
 #include "../util/godot/core/callable_mp.h"
@@ -111,60 +120,78 @@ void box_propagate_ccl(Span<uint8_t> cells, const Vector3i size) {
 	}
 }
 
-// Turns floating chunks of voxels into rigidbodies:
-// Detects separate groups of connected voxels within a box. Each group fully contained in the box is removed from
-// the source volume, and turned into a rigidbody.
-// This is one way of doing it, I don't know if it's the best way (there is rarely a best way)
-// so there are probably other approaches that could be explored in the future, if they have better performance
-Array separate_floating_chunks(
-		VoxelTool &voxel_tool,
-		Box3i world_box,
-		Node *parent_node,
-		Transform3D terrain_transform,
-		Ref<VoxelMesher> mesher,
-		Array materials
-) {
-	ZN_PROFILE_SCOPE();
-
-	// Checks
-	ERR_FAIL_COND_V(mesher.is_null(), Array());
-	ERR_FAIL_COND_V(parent_node == nullptr, Array());
-
-	// Copy source data
+namespace {
+
+// TODO Do not assume channel, at the moment it's hardcoded for smooth terrain
+const int g_channels_mask = (1 << VoxelBuffer::CHANNEL_SDF);
+const VoxelBuffer::ChannelId g_main_channel = VoxelBuffer::CHANNEL_SDF;
+
+const int g_min_padding = 2; // mesher->get_minimum_padding();
+const int g_max_padding = 2; // mesher->get_maximum_padding();
+
+// A group of voxels detected as floating, extracted into its own buffer
+struct FloatingChunk {
+	// Has padding for meshing
+	VoxelBuffer voxels;
+	// Position of the buffer's origin in the source volume
+	Vector3i world_pos;
+	VoxelMesher::Output mesh_output;
+
+	FloatingChunk() : voxels(VoxelBuffer::ALLOCATOR_POOL) {}
+};
+
+template <typename T>
+void compute_solid_mask_t(const VoxelBuffer &voxels, Span<uint8_t> mask) {
+	Span<const T> data;
+	ZN_ASSERT_RETURN(voxels.get_channel_data_read_only(g_main_channel, data));
+	ZN_ASSERT_RETURN(data.size() == mask.size());
+	for (unsigned int i = 0; i < data.size(); ++i) {
+		mask[i] = data[i] < 0;
+	}
+}
 
-	// TODO Do not assume channel, at the moment it's hardcoded for smooth terrain
-	static const int channels_mask = (1 << VoxelBuffer::CHANNEL_SDF);
-	static const VoxelBuffer::ChannelId main_channel = VoxelBuffer::CHANNEL_SDF;
+// Marks cells where SDF is negative, reading the channel directly
+void compute_solid_mask(const VoxelBuffer &voxels, Span<uint8_t> mask) {
+	ZN_PROFILE_SCOPE();
 
-	VoxelBuffer source_copy_buffer(VoxelBuffer::ALLOCATOR_POOL);
-	{
-		ZN_PROFILE_SCOPE_NAMED("Copy");
-		source_copy_buffer.create(world_box.size);
-		voxel_tool.copy(world_box.position, source_copy_buffer, channels_mask, false);
+	if (voxels.is_uniform(g_main_channel)) {
+		const uint8_t solid = voxels.get_voxel_f(0, 0, 0, g_main_channel) < 0.f;
+		memset(mask.data(), solid, mask.size());
+		return;
 	}
 
-	// Label distinct voxel groups
-
-	// TODO Candidate for temp allocator
-	static thread_local StdVector<uint8_t> ccl_output;
-	ccl_output.resize(Vector3iUtil::get_volume_u64(world_box.size));
+	// Snorm integers keep the same sign as the value they encode
+	switch (voxels.get_channel_depth(g_main_channel)) {
+		case VoxelBuffer::DEPTH_8_BIT:
+			compute_solid_mask_t<int8_t>(voxels, mask);
+			break;
+		case VoxelBuffer::DEPTH_16_BIT:
+			compute_solid_mask_t<int16_t>(voxels, mask);
+			break;
+		case VoxelBuffer::DEPTH_32_BIT:
+			compute_solid_mask_t<float>(voxels, mask);
+			break;
+		case VoxelBuffer::DEPTH_64_BIT:
+			compute_solid_mask_t<double>(voxels, mask);
+			break;
+		default:
+			ZN_PRINT_ERROR("Unhandled depth");
+			break;
+	}
+}
 
-	unsigned int label_count = 0;
+// Uses labelled groups to extract those that don't touch the borders of the source box.
+// `labels` is modified in the process.
+void extract_floating_chunks(
+		const VoxelBuffer &source,
+		const Vector3i source_origin,
+		Span<uint8_t> labels,
+		const unsigned int label_count,
+		StdVector<FloatingChunk> &out_chunks
+) {
+	ZN_PROFILE_SCOPE();
 
-	{
-		// TODO Allow to run the algorithm at a different LOD, to trade precision for speed
-		ZN_PROFILE_SCOPE_NAMED("CCL scan");
-		IslandFinder island_finder;
-		island_finder.scan_3d(
-				Box3i(Vector3i(), world_box.size),
-				[&source_copy_buffer](Vector3i pos) {
-					// TODO Can be optimized further with direct access
-					return source_copy_buffer.get_voxel_f(pos.x, pos.y, pos.z, main_channel) < 0.f;
-				},
-				to_span(ccl_output),
-				&label_count
-		);
-	}
+	const Vector3i source_size = source.get_size();
 
 	struct Bounds {
 		Vector3i min_pos;
@@ -172,11 +199,11 @@ Array separate_floating_chunks(
 		bool valid = false;
 	};
 
-	if (main_channel == VoxelBuffer::CHANNEL_SDF) {
+	if (g_main_channel == VoxelBuffer::CHANNEL_SDF) {
 		// Propagate labels to improve SDF quality, otherwise gradients of separated chunks would cut off abruptly.
 		// Limitation: if two islands are too close to each other, one will win over the other.
 		// An alternative could be to do this on individual chunks?
-		box_propagate_ccl(to_span(ccl_output), world_box.size);
+		box_propagate_ccl(labels, source_size);
 	}
 
 	// Compute bounds of each group
@@ -189,11 +216,10 @@ Array separate_floating_chunks(
 		bounds_per_label.resize(label_count + 1);
 
 		unsigned int ccl_index = 0;
-		for (int z = 0; z < world_box.size.z; ++z) {
-			for (int x = 0; x < world_box.size.x; ++x) {
-				for (int y = 0; y < world_box.size.y; ++y) {
-					CRASH_COND(ccl_index >= ccl_output.size());
-					const uint8_t label = ccl_output[ccl_index];
+		for (int z = 0; z < source_size.z; ++z) {
+			for (int x = 0; x < source_size.x; ++x) {
+				for (int y = 0; y < source_size.y; ++y) {
+					const uint8_t label = labels[ccl_index];
 					++ccl_index;
 
 					if (label == 0) {
@@ -235,9 +261,8 @@ Array separate_floating_chunks(
 	// Eliminate groups that touch the box border,
 	// because that means we can't tell if they are truly hanging in the air or attached to land further away
 
-	const Vector3i lbmax = world_box.size - Vector3i(1, 1, 1);
+	const Vector3i lbmax = source_size - Vector3i(1, 1, 1);
 	for (unsigned int label = 1; label < bounds_per_label.size(); ++label) {
-		CRASH_COND(label >= bounds_per_label.size());
 		Bounds &local_bounds = bounds_per_label[label];
 		ERR_CONTINUE(!local_bounds.valid);
 
@@ -255,63 +280,52 @@ Array separate_floating_chunks(
 
 	// Create voxel buffer for each group
 
-	struct InstanceInfo {
-		VoxelBuffer voxels;
-		Vector3i world_pos;
-		unsigned int label;
-	};
-	StdVector<InstanceInfo> instances_info;
-
-	const int min_padding = 2; // mesher->get_minimum_padding();
-	const int max_padding = 2; // mesher->get_maximum_padding();
-
 	{
 		ZN_PROFILE_SCOPE_NAMED("Extraction");
 
 		for (unsigned int label = 1; label < bounds_per_label.size(); ++label) {
-			CRASH_COND(label >= bounds_per_label.size());
 			const Bounds local_bounds = bounds_per_label[label];
 
 			if (!local_bounds.valid) {
 				continue;
 			}
 
-			const Vector3i world_pos = world_box.position + local_bounds.min_pos - Vector3iUtil::create(min_padding);
-			const Vector3i size =
-					local_bounds.max_pos - local_bounds.min_pos + Vector3iUtil::create(1 + max_padding + min_padding);
+			const Vector3i world_pos = source_origin + local_bounds.min_pos - Vector3iUtil::create(g_min_padding);
+			const Vector3i size = local_bounds.max_pos - local_bounds.min_pos +
+					Vector3iUtil::create(1 + g_max_padding + g_min_padding);
 
-			instances_info.push_back(InstanceInfo{ VoxelBuffer(VoxelBuffer::ALLOCATOR_POOL), world_pos, label });
+			out_chunks.push_back(FloatingChunk());
+			FloatingChunk &chunk = out_chunks.back();
+			chunk.world_pos = world_pos;
 
-			VoxelBuffer &buffer = instances_info.back().voxels;
+			VoxelBuffer &buffer = chunk.voxels;
 			buffer.create(size.x, size.y, size.z);
 
-			// Read voxels from the source volume
-			voxel_tool.copy(world_pos, buffer, channels_mask, false);
-
-			// Cleanup padding borders
-			const Box3i inner_box(
-					Vector3iUtil::create(min_padding),
-					buffer.get_size() - Vector3iUtil::create(min_padding + max_padding)
+			// Padding borders are cleared, so only the inner part needs to be read. Bounds don't touch the source box
+			// borders, so it is always available in the source copy.
+			buffer.fill_f(constants::SDF_FAR_OUTSIDE, g_main_channel);
+			buffer.copy_channel_from(
+					source,
+					local_bounds.min_pos,
+					local_bounds.max_pos + Vector3i(1, 1, 1),
+					Vector3iUtil::create(g_min_padding),
+					g_main_channel
 			);
-			Box3i(Vector3i(), buffer.get_size()).difference(inner_box, [&buffer](Box3i box) {
-				buffer.fill_area_f(constants::SDF_FAR_OUTSIDE, box.position, box.position + box.size, main_channel);
-			});
 
 			// Filter out voxels that don't belong to this label
 			for (int z = local_bounds.min_pos.z; z <= local_bounds.max_pos.z; ++z) {
 				for (int x = local_bounds.min_pos.x; x <= local_bounds.max_pos.x; ++x) {
 					for (int y = local_bounds.min_pos.y; y <= local_bounds.max_pos.y; ++y) {
-						const unsigned int ccl_index = Vector3iUtil::get_zxy_index(Vector3i(x, y, z), world_box.size);
-						CRASH_COND(ccl_index >= ccl_output.size());
-						const uint8_t label2 = ccl_output[ccl_index];
+						const unsigned int ccl_index = Vector3iUtil::get_zxy_index(Vector3i(x, y, z), source_size);
+						const uint8_t label2 = labels[ccl_index];
 
 						if (label2 != 0 && label != label2) {
 							buffer.set_voxel_f(
 									constants::SDF_FAR_OUTSIDE,
-									min_padding + x - local_bounds.min_pos.x,
-									min_padding + y - local_bounds.min_pos.y,
-									min_padding + z - local_bounds.min_pos.z,
-									main_channel
+									g_min_padding + x - local_bounds.min_pos.x,
+									g_min_padding + y - local_bounds.min_pos.y,
+									g_min_padding + z - local_bounds.min_pos.z,
+									g_main_channel
 							);
 						}
 					}
@@ -319,6 +333,26 @@ Array separate_floating_chunks(
 			}
 		}
 	}
+}
+
+// Can be called from multiple threads, with different chunks
+void build_floating_chunk_mesh(VoxelMesher &mesher, FloatingChunk &chunk) {
+	ZN_PROFILE_SCOPE();
+	// TODO If normalmapping is used here with the Transvoxel mesher, we need to either turn it off just for
+	// this call, or to pass the right options
+	const VoxelMesher::Input input{ chunk.voxels, nullptr, Vector3i(), 0, false, false, false };
+	mesher.build(chunk.mesh_output, input);
+}
+
+// Removes floating chunks from the source volume and creates their nodes. Must be called on the main thread.
+Array instantiate_floating_chunks(
+		VoxelTool &voxel_tool,
+		Span<const FloatingChunk> chunks,
+		Node *parent_node,
+		const Transform3D &terrain_transform,
+		Array materials
+) {
+	ZN_PROFILE_SCOPE();
 
 	// Erase voxels from source volume.
 	// Must be done after we copied voxels from it.
@@ -326,12 +360,10 @@ Array separate_floating_chunks(
 	{
 		ZN_PROFILE_SCOPE_NAMED("Erasing");
 
-		voxel_tool.set_channel(main_channel);
+		voxel_tool.set_channel(g_main_channel);
 
-		for (unsigned int instance_index = 0; instance_index < instances_info.size(); ++instance_index) {
-			CRASH_COND(instance_index >= instances_info.size());
-			const InstanceInfo &info = instances_info[instance_index];
-			voxel_tool.sdf_stamp_erase(info.voxels, info.world_pos);
+		for (const FloatingChunk &chunk : chunks) {
+			voxel_tool.sdf_stamp_erase(chunk.voxels, chunk.world_pos);
 		}
 	}
 
@@ -380,39 +412,14 @@ Array separate_floating_chunks(
 	Array nodes;
 
 	{
-		ZN_PROFILE_SCOPE_NAMED("Remeshing and instancing");
-
-		for (unsigned int instance_index = 0; instance_index < instances_info.size(); ++instance_index) {
-			CRASH_COND(instance_index >= instances_info.size());
-			const InstanceInfo &info = instances_info[instance_index];
-
-			CRASH_COND(info.label >= bounds_per_label.size());
-			const Bounds local_bounds = bounds_per_label[info.label];
-			ERR_CONTINUE(!local_bounds.valid);
-
-			// DEBUG
-			// print_line(String("--- Instance {0}").format(varray(instance_index)));
-			// for (int z = 0; z < info.voxels->get_size().z; ++z) {
-			// 	for (int x = 0; x < info.voxels->get_size().x; ++x) {
-			// 		String s;
-			// 		for (int y = 0; y < info.voxels->get_size().y; ++y) {
-			// 			float sdf = info.voxels->get_voxel_f(x, y, z, VoxelBuffer::CHANNEL_SDF);
-			// 			if (sdf < -0.1f) {
-			// 				s += "X ";
-			// 			} else if (sdf < 0.f) {
-			// 				s += "x ";
-			// 			} else {
-			// 				s += "- ";
-			// 			}
-			// 		}
-			// 		print_line(s);
-			// 	}
-			// 	print_line("//");
-			// }
+		ZN_PROFILE_SCOPE_NAMED("Instancing");
 
+		StdVector<uint16_t> mesh_material_indices;
+
+		for (const FloatingChunk &chunk : chunks) {
 			const Transform3D local_transform(
 					Basis(),
-					info.world_pos
+					chunk.world_pos
 							// Undo min padding
 							+ Vector3i(1, 1, 1)
 			);
@@ -433,44 +440,35 @@ Array separate_floating_chunks(
 				}
 			}
 
-			// TODO If normalmapping is used here with the Transvoxel mesher, we need to either turn it off just for
-			// this call, or to pass the right options
-			Ref<ArrayMesh> mesh = mesher->build_mesh(info.voxels, materials, Dictionary());
-			// The mesh is not supposed to be null,
-			// because we build these buffers from connected groups that had negative SDF.
-			ERR_CONTINUE(mesh.is_null());
-
-			if (zylann::godot::is_mesh_empty(**mesh)) {
+			mesh_material_indices.clear();
+			Ref<ArrayMesh> mesh = build_mesh(
+					to_span(chunk.mesh_output.surfaces),
+					chunk.mesh_output.primitive_type,
+					chunk.mesh_output.mesh_flags,
+					mesh_material_indices
+			);
+			// The mesh is not supposed to be empty, because we build these buffers from connected groups that had
+			// negative SDF. But it can happen if they are too thin.
+			if (mesh.is_null()) {
 				continue;
 			}
 
-			// DEBUG
-			// {
-			// 	Ref<VoxelBlockSerializer> serializer;
-			// 	serializer.instance();
-			// 	Ref<StreamPeerBuffer> peer;
-			// 	peer.instance();
-			// 	serializer->serialize(peer, info.voxels, false);
-			// 	String fpath = String("debug_data/split_dump_{0}.bin").format(varray(instance_index));
-			// 	FileAccess *f = FileAccess::open(fpath, FileAccess::WRITE);
-			// 	PoolByteArray bytes = peer->get_data_array();
-			// 	PoolByteArray::Read bytes_read = bytes.read();
-			// 	f->store_buffer(bytes_read.ptr(), bytes.size());
-			// 	f->close();
-			// 	memdelete(f);
-			// }
+			for (unsigned int surface_index = 0; surface_index < mesh_material_indices.size(); ++surface_index) {
+				const unsigned int material_index = mesh_material_indices[surface_index];
+				if (int(material_index) < materials.size()) {
+					Ref<Material> material = materials[material_index];
+					mesh->surface_set_material(surface_index, material);
+				}
+			}
 
 			// TODO Option to make multiple convex shapes
 			// TODO Use the fast way. This is slow because of the internal TriangleMesh thing and mesh data query.
-			// TODO Don't create a body if the mesh has no triangles
 			Ref<Shape3D> shape = mesh->create_convex_shape();
 			ERR_CONTINUE(shape.is_null());
 			CollisionShape3D *collision_shape = memnew(CollisionShape3D);
 			collision_shape->set_shape(shape);
 			// Center the shape somewhat, because Godot is confusing node origin with center of mass
-			const Vector3i size =
-					local_bounds.max_pos - local_bounds.min_pos + Vector3iUtil::create(1 + max_padding + min_padding);
-			const Vector3 offset = -Vector3(size) * 0.5f;
+			const Vector3 offset = -Vector3(chunk.voxels.get_size()) * 0.5f;
 			collision_shape->set_position(offset);
 
 			RigidBody3D *rigid_body = memnew(RigidBody3D);
@@ -504,4 +502,294 @@ Array separate_floating_chunks(
 	return nodes;
 }
 
+} // namespace
+
+// Turns floating chunks of voxels into rigidbodies:
+// Detects separate groups of connected voxels within a box. Each group fully contained in the box is removed from
+// the source volume, and turned into a rigidbody.
+// This is one way of doing it, I don't know if it's the best way (there is rarely a best way)
+// so there are probably other approaches that could be explored in the future, if they have better performance
+Array separate_floating_chunks(
+		VoxelTool &voxel_tool,
+		Box3i world_box,
+		Node *parent_node,
+		Transform3D terrain_transform,
+		Ref<VoxelMesher> mesher,
+		Array materials
+) {
+	ZN_PROFILE_SCOPE();
+
+	// Checks
+	ERR_FAIL_COND_V(mesher.is_null(), Array());
+	ERR_FAIL_COND_V(parent_node == nullptr, Array());
+
+	// Copy source data
+
+	VoxelBuffer source_copy_buffer(VoxelBuffer::ALLOCATOR_POOL);
+	{
+		ZN_PROFILE_SCOPE_NAMED("Copy");
+		source_copy_buffer.create(world_box.size);
+		voxel_tool.copy(world_box.position, source_copy_buffer, g_channels_mask, false);
+	}
+
+	// Label distinct voxel groups
+
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<uint8_t> solid_mask(temp_allocator);
+	StdTempVector<uint8_t> ccl_output(temp_allocator);
+	solid_mask.resize(Vector3iUtil::get_volume_u64(world_box.size));
+	ccl_output.resize(solid_mask.size());
+
+	compute_solid_mask(source_copy_buffer, to_span(solid_mask));
+
+	unsigned int label_count = 0;
+	{
+		ZN_PROFILE_SCOPE_NAMED("CCL scan");
+		BlockIslandFinder island_finder;
+		if (!island_finder.scan_3d(to_span(solid_mask), world_box.size, to_span(ccl_output), label_count)) {
+			ZN_PRINT_ERROR("Too many separate groups of voxels in the box, try with a smaller box");
+			return Array();
+		}
+	}
+
+	StdVector<FloatingChunk> chunks;
+	extract_floating_chunks(source_copy_buffer, world_box.position, to_span(ccl_output), label_count, chunks);
+
+	{
+		ZN_PROFILE_SCOPE_NAMED("Remeshing");
+		for (FloatingChunk &chunk : chunks) {
+			build_floating_chunk_mesh(**mesher, chunk);
+		}
+	}
+
+	return instantiate_floating_chunks(voxel_tool, to_span(chunks), parent_node, terrain_transform, materials);
+}
+
+namespace {
+
+// State shared by the tasks of an async separation
+struct FloatingChunksAsyncState {
+	std::shared_ptr<VoxelData> data;
+	Ref<VoxelMesher> mesher;
+	Box3i world_box;
+	VoxelBuffer source;
+	StdVector<uint8_t> solid_mask;
+	StdVector<uint8_t> labels;
+	BlockIslandFinder island_finder;
+	StdVector<FloatingChunk> chunks;
+	std::atomic_uint32_t remaining_tasks;
+
+	// Only used on the main thread
+	zylann::godot::ObjectWeakRef<VoxelNode> terrain;
+	zylann::godot::ObjectWeakRef<Node> parent_node;
+	Array materials;
+	Callable callback;
+
+	FloatingChunksAsyncState() : source(VoxelBuffer::ALLOCATOR_POOL) {}
+};
+
+class FloatingChunksInstantiateTask : public ITimeSpreadTask {
+public:
+	std::shared_ptr<FloatingChunksAsyncState> state;
+
+	void run(TimeSpreadTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		FloatingChunksAsyncState &s = *state;
+
+		Array nodes;
+
+		VoxelNode *terrain = s.terrain.get();
+		Node *parent_node = s.parent_node.get();
+
+		if (terrain == nullptr || parent_node == nullptr) {
+			// The nodes can have been destroyed while tasks were running
+			ZN_PRINT_VERBOSE("Cancelling floating chunks instantiation, the terrain or parent node was destroyed");
+
+		} else if (s.chunks.size() > 0) {
+			Ref<VoxelTool> voxel_tool = terrain->get_voxel_tool();
+			ZN_ASSERT_RETURN(voxel_tool.is_valid());
+			// Voxels may have been modified since they were copied. Erasing still uses the copied shape, edits done
+			// in the meantime within the chunks are lost.
+			nodes = instantiate_floating_chunks(
+					**voxel_tool, to_span(s.chunks), parent_node, terrain->get_global_transform(), s.materials
+			);
+		}
+
+		if (s.callback.is_valid()) {
+			s.callback.call(nodes);
+		}
+	}
+};
+
+class FloatingChunksMeshTask : public IThreadedTask {
+public:
+	std::shared_ptr<FloatingChunksAsyncState> state;
+	unsigned int chunk_index;
+
+	void run(ThreadedTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		FloatingChunksAsyncState &s = *state;
+
+		build_floating_chunk_mesh(**s.mesher, s.chunks[chunk_index]);
+
+		if (--s.remaining_tasks == 0) {
+			// Last one to finish schedules nodes creation
+			FloatingChunksInstantiateTask *task = ZN_NEW(FloatingChunksInstantiateTask);
+			task->state = state;
+			VoxelEngine::get_singleton().push_main_thread_time_spread_task(task);
+		}
+	}
+
+	const char *get_debug_name() const override {
+		return "FloatingChunksMesh";
+	}
+};
+
+class FloatingChunksScanTask : public IThreadedTask {
+public:
+	std::shared_ptr<FloatingChunksAsyncState> state;
+	unsigned int block_begin;
+	unsigned int block_end;
+
+	void run(ThreadedTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		FloatingChunksAsyncState &s = *state;
+
+		for (unsigned int i = block_begin; i < block_end; ++i) {
+			s.island_finder.scan_block(i);
+		}
+
+		if (--s.remaining_tasks == 0) {
+			// Last one to finish does the rest
+			finish();
+		}
+	}
+
+	const char *get_debug_name() const override {
+		return "FloatingChunksScan";
+	}
+
+private:
+	void finish() {
+		ZN_PROFILE_SCOPE();
+		FloatingChunksAsyncState &s = *state;
+
+		unsigned int label_count = 0;
+		if (s.island_finder.merge(label_count)) {
+			for (unsigned int i = 0; i < s.island_finder.get_block_count(); ++i) {
+				s.island_finder.write_block_labels(i, to_span(s.labels));
+			}
+			extract_floating_chunks(s.source, s.world_box.position, to_span(s.labels), label_count, s.chunks);
+		} else {
+			ZN_PRINT_ERROR("Too many separate groups of voxels in the box, try with a smaller box");
+		}
+
+		// Not needed anymore
+		s.source.clear();
+		s.solid_mask = StdVector<uint8_t>();
+		s.labels = StdVector<uint8_t>();
+
+		if (s.chunks.size() == 0) {
+			FloatingChunksInstantiateTask *task = ZN_NEW(FloatingChunksInstantiateTask);
+			task->state = state;
+			VoxelEngine::get_singleton().push_main_thread_time_spread_task(task);
+			return;
+		}
+
+		s.remaining_tasks = s.chunks.size();
+
+		StdVector<IThreadedTask *> tasks;
+		tasks.reserve(s.chunks.size());
+		for (unsigned int i = 0; i < s.chunks.size(); ++i) {
+			FloatingChunksMeshTask *task = ZN_NEW(FloatingChunksMeshTask);
+			task->state = state;
+			task->chunk_index = i;
+			tasks.push_back(task);
+		}
+		VoxelEngine::get_singleton().push_async_tasks(to_span(tasks));
+	}
+};
+
+// Copies voxels, then spreads labelling over multiple tasks
+class FloatingChunksPrepareTask : public IThreadedTask {
+public:
+	std::shared_ptr<FloatingChunksAsyncState> state;
+
+	void run(ThreadedTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		FloatingChunksAsyncState &s = *state;
+
+		if (s.world_box.is_empty()) {
+			// Nothing to separate, and no scan task would finish. The callback must still be called.
+			FloatingChunksInstantiateTask *task = ZN_NEW(FloatingChunksInstantiateTask);
+			task->state = state;
+			VoxelEngine::get_singleton().push_main_thread_time_spread_task(task);
+			return;
+		}
+
+		s.source.create(s.world_box.size);
+		s.data->copy(s.world_box.position, s.source, g_channels_mask, false);
+
+		s.solid_mask.resize(Vector3iUtil::get_volume_u64(s.world_box.size));
+		s.labels.resize(s.solid_mask.size());
+		compute_solid_mask(s.source, to_span(s.solid_mask));
+
+		s.island_finder.init(to_span(s.solid_mask), s.world_box.size);
+
+		// Blocks are cheap to scan, so group them to avoid scheduling lots of tiny tasks
+		static const unsigned int BLOCKS_PER_TASK = 64;
+		const unsigned int block_count = s.island_finder.get_block_count();
+		const unsigned int task_count = math::ceildiv(block_count, BLOCKS_PER_TASK);
+
+		s.remaining_tasks = task_count;
+
+		StdVector<IThreadedTask *> tasks;
+		tasks.reserve(task_count);
+		for (unsigned int i = 0; i < task_count; ++i) {
+			FloatingChunksScanTask *task = ZN_NEW(FloatingChunksScanTask);
+			task->state = state;
+			task->block_begin = i * BLOCKS_PER_TASK;
+			task->block_end = math::min((i + 1) * BLOCKS_PER_TASK, block_count);
+			tasks.push_back(task);
+		}
+		VoxelEngine::get_singleton().push_async_tasks(to_span(tasks));
+	}
+
+	const char *get_debug_name() const override {
+		return "FloatingChunksPrepare";
+	}
+};
+
+} // namespace
+
+void separate_floating_chunks_async(
+		std::shared_ptr<VoxelData> data,
+		Box3i world_box,
+		VoxelNode *terrain,
+		Node *parent_node,
+		Ref<VoxelMesher> mesher,
+		Array materials,
+		const Callable &callback
+) {
+	ZN_ASSERT_RETURN(data != nullptr);
+	ZN_ASSERT_RETURN(terrain != nullptr);
+	ZN_ASSERT_RETURN(parent_node != nullptr);
+	ZN_ASSERT_RETURN(mesher.is_valid());
+	ZN_ASSERT_RETURN(Vector3iUtil::is_valid_size(world_box.size));
+
+	std::shared_ptr<FloatingChunksAsyncState> state = make_shared_instance<FloatingChunksAsyncState>();
+	state->data = data;
+	state->mesher = mesher;
+	state->world_box = world_box;
+	state->terrain.set(terrain);
+	state->parent_node.set(parent_node);
+	state->materials = materials;
+	state->callback = callback;
+
+	FloatingChunksPrepareTask *task = ZN_NEW(FloatingChunksPrepareTask);
+	task->state = state;
+	VoxelEngine::get_singleton().push_async_task(task);
+}
+
 } // namespace zylann::voxel
@@ -5,12 +5,16 @@
 #include "../util/godot/core/array.h"
 #include "../util/godot/core/transform_3d.h"
 #include "../util/math/box3i.h"
+#include <memory>
 
 ZN_GODOT_FORWARD_DECLARE(class Node);
+ZN_GODOT_FORWARD_DECLARE(class Callable);
 
 namespace zylann::voxel {
 
 class VoxelTool;
+class VoxelData;
+class VoxelNode;
 
 Array separate_floating_chunks(
 		VoxelTool &voxel_tool,
@@ -21,6 +25,18 @@ Array separate_floating_chunks(
 		Array materials
 );
 
+// Same as `separate_floating_chunks`, but voxels are read from `data`, and detection and meshing run on worker
+// threads. Nodes are created on the main thread once done, and `callback` is then called with an array of them.
+void separate_floating_chunks_async(
+		std::shared_ptr<VoxelData> data,
+		Box3i world_box,
+		VoxelNode *terrain,
+		Node *parent_node,
+		Ref<VoxelMesher> mesher,
+		Array materials,
+		const Callable &callback
+);
+
 } // namespace zylann::voxel
 
 #endif // VOXEL_FLOATING_CHUNKS_H
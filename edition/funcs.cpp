@@ -1,10 +1,12 @@
 #include "funcs.h"
 #include "../meshers/blocky/voxel_blocky_library_base.h"
 #include "../storage/voxel_data.h"
+#include "../storage/voxel_data_read_view.h"
 #include "../util/containers/dynamic_bitset.h"
 #include "../util/containers/span.h"
 #include "../util/containers/std_vector.h"
 #include "../util/godot/core/random_pcg.h"
+#include "../util/memory/linear_allocator.h"
 #include "../util/profiling.h"
 #include "../util/string/format.h"
 
@@ -172,8 +174,9 @@ void run_blocky_random_tick(
 		uint64_t value;
 		Vector3i rpos;
 	};
-	// TODO Candidate for temp allocator
-	static thread_local StdVector<Pick> picks;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<Pick> picks(temp_allocator);
 	picks.reserve(batch_count);
 
 	const float block_volume = math::cubed(block_size);
@@ -202,10 +205,12 @@ void run_blocky_random_tick(
 		picks.clear();
 
 		{
-			SpatialLock3D &spatial_lock = data.get_spatial_lock(lod_index);
-			SpatialLock3D::Read srlock(spatial_lock, BoxBounds3i::from_position(block_pos));
+			// Only the picked block is viewed, and the view is released before running callbacks since they may edit
+			// voxels. That way, next batches also see these edits.
+			VoxelDataReadView view;
+			data.acquire_read_view(view, Box3i(block_origin, Vector3iUtil::create(block_size)), lod_index);
 
-			std::shared_ptr<VoxelBuffer> voxels_ptr = data.try_get_block_voxels(block_pos);
+			const VoxelBuffer *voxels_ptr = view.get_block(block_pos);
 
 			if (voxels_ptr != nullptr) {
 				// Doing ONLY reads here.
@@ -308,6 +313,37 @@ void run_blocky_random_tick(
 	);
 }
 
+float get_sdf_interpolated(const VoxelData &data, unsigned int channel, Vector3 pos) {
+	const Vector3i c = math::floor_to_int(pos);
+
+	FixedArray<Vector3i, 8> positions;
+	positions[0] = Vector3i(c.x, c.y, c.z);
+	positions[1] = Vector3i(c.x + 1, c.y, c.z);
+	positions[2] = Vector3i(c.x, c.y + 1, c.z);
+	positions[3] = Vector3i(c.x + 1, c.y + 1, c.z);
+	positions[4] = Vector3i(c.x, c.y, c.z + 1);
+	positions[5] = Vector3i(c.x + 1, c.y, c.z + 1);
+	positions[6] = Vector3i(c.x, c.y + 1, c.z + 1);
+	positions[7] = Vector3i(c.x + 1, c.y + 1, c.z + 1);
+
+	VoxelSingleValue defval;
+	defval.f = constants::SDF_FAR_OUTSIDE;
+	FixedArray<VoxelSingleValue, 8> values;
+	data.get_voxels(to_span(positions), channel, defval, to_span(values));
+
+	return math::interpolate_trilinear(
+			values[0].f,
+			values[1].f,
+			values[5].f,
+			values[4].f,
+			values[2].f,
+			values[3].f,
+			values[7].f,
+			values[6].f,
+			to_vec3f(math::fract(pos))
+	);
+}
+
 bool indices_to_bitarray_u16(Span<const int32_t> indices, DynamicBitset &bitarray) {
 #ifdef DEBUG_ENABLED
 	const int32_t max_supported_value = 65535;
@@ -372,6 +408,170 @@ Box3i get_round_cone_int_bounds(Vector3f p0, Vector3f p1, float r0, float r1) {
 	return Box3i::from_min_max(to_vec3i(math::floor(minp)), to_vec3i(math::ceil(maxp)));
 }
 
+Box3i BrushBatch::get_box() const {
+	if (items.size() == 0) {
+		return Box3i();
+	}
+	Box3i box = items[0].box;
+	for (unsigned int i = 1; i < items.size(); ++i) {
+		box.merge_with(items[i].box);
+	}
+	return box;
+}
+
+namespace {
+
+// Items are expected to be those overlapping the block being processed. Their boxes are still checked per voxel, since
+// they don't necessarily cover the whole block.
+
+struct BrushBatchSdfOp {
+	Span<const BrushBatch::Item *> items;
+
+	inline int16_t operator()(Vector3i pos, int16_t src) const {
+		const Vector3f posf = to_vec3f(pos);
+		float sd = s16_to_snorm(src) * constants::QUANTIZED_SDF_16_BITS_SCALE_INV;
+
+		for (const BrushBatch::Item *item : items) {
+			if (!item->box.contains(pos)) {
+				continue;
+			}
+			const float shape_sd = item->get_signed_distance(posf);
+			switch (item->mode) {
+				case MODE_ADD:
+					sd = SdfUnion{ item->strength }(sd, shape_sd);
+					break;
+				case MODE_REMOVE:
+					sd = SdfSubtract{ item->strength }(sd, shape_sd);
+					break;
+				case MODE_SET:
+					sd = SdfSet{ item->strength }(sd, shape_sd);
+					break;
+				default:
+					break;
+			}
+		}
+
+		return snorm_to_s16(sd * constants::QUANTIZED_SDF_16_BITS_SCALE);
+	}
+};
+
+struct BrushBatchTextureOp {
+	Span<const BrushBatch::Item *> items;
+
+	inline void operator()(Vector3i pos, uint16_t &indices, uint16_t &weights) const {
+		const Vector3f posf = to_vec3f(pos);
+
+		for (const BrushBatch::Item *item : items) {
+			if (!item->box.contains(pos)) {
+				continue;
+			}
+			if (item->shape_type == BrushBatch::SHAPE_SPHERE) {
+				// Same falloff as `TextureBlendSphereOp`, so results match `do_sphere`
+				const TextureBlendSphereOp op(item->sphere.center, item->sphere.radius, item->texture_params);
+				op(pos, indices, weights);
+			} else {
+				const TextureParams &tp = item->texture_params;
+				const float sd = item->get_signed_distance(posf);
+				if (sd <= 0) {
+					const float target_weight = tp.opacity * math::clamp(-sd * tp.sharpness, 0.f, 1.f);
+					mixel4::blend_texture_packed_u16(tp.index, target_weight, indices, weights);
+				}
+			}
+		}
+	}
+};
+
+struct BrushBatchBlockyOp {
+	Span<const BrushBatch::Item *> items;
+
+	inline uint32_t operator()(Vector3i pos, uint32_t src) const {
+		const Vector3f posf = to_vec3f(pos);
+		uint32_t value = src;
+		for (const BrushBatch::Item *item : items) {
+			if (item->box.contains(pos) && item->is_inside(posf)) {
+				value = item->blocky_value;
+			}
+		}
+		return value;
+	}
+};
+
+} // namespace
+
+void do_brush_batch(const BrushBatch &batch, Box3i box, VoxelDataGrid &grid) {
+	ZN_PROFILE_SCOPE();
+
+	LinearAllocator &allocator = get_tls_temp_allocator();
+	LinearAllocatorScope las(allocator);
+	StdTempVector<const BrushBatch::Item *> main_items(allocator);
+	StdTempVector<const BrushBatch::Item *> texture_items(allocator);
+	main_items.reserve(batch.items.size());
+	texture_items.reserve(batch.items.size());
+
+	const bool is_sdf = batch.channel == VoxelBuffer::CHANNEL_SDF;
+
+	VoxelDataGridAccess block_access{ &grid };
+
+	process_chunked_storage(
+			box,
+			block_access,
+			[&batch, &main_items, &texture_items, is_sdf](VoxelBuffer &vb, const Box3i local_box, Vector3i origin) {
+				const Box3i block_box(local_box.position + origin, local_box.size);
+
+				// Only keep shapes touching this block, and only visit voxels they can affect
+				main_items.clear();
+				texture_items.clear();
+				Box3i main_box;
+				Box3i texture_box;
+
+				for (const BrushBatch::Item &item : batch.items) {
+					if (!item.box.intersects(block_box)) {
+						continue;
+					}
+					const Box3i item_box = item.box.clipped(block_box);
+					if (is_sdf && item.mode == MODE_TEXTURE_PAINT) {
+						if (texture_items.size() == 0) {
+							texture_box = item_box;
+						} else {
+							texture_box.merge_with(item_box);
+						}
+						texture_items.push_back(&item);
+					} else {
+						if (main_items.size() == 0) {
+							main_box = item_box;
+						} else {
+							main_box.merge_with(item_box);
+						}
+						main_items.push_back(&item);
+					}
+				}
+
+				if (main_items.size() > 0) {
+					const Box3i main_local_box(main_box.position - origin, main_box.size);
+					if (is_sdf) {
+						// TODO Support other depths, format should be accessible from the volume
+						vb.write_box(
+								main_local_box, VoxelBuffer::CHANNEL_SDF, BrushBatchSdfOp{ to_span(main_items) }, origin
+						);
+					} else {
+						vb.write_box(main_local_box, batch.channel, BrushBatchBlockyOp{ to_span(main_items) }, origin);
+					}
+				}
+
+				if (texture_items.size() > 0) {
+					const Box3i texture_local_box(texture_box.position - origin, texture_box.size);
+					vb.write_box_2_template<BrushBatchTextureOp, uint16_t, uint16_t>(
+							texture_local_box,
+							VoxelBuffer::CHANNEL_INDICES,
+							VoxelBuffer::CHANNEL_WEIGHTS,
+							BrushBatchTextureOp{ to_span(texture_items) },
+							origin
+					);
+				}
+			}
+	);
+}
+
 #if defined(DEBUG_ENABLED) || defined(VOXEL_TESTS)
 
 // Reference implementation. Correct but very slow.
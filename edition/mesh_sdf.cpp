@@ -6,6 +6,7 @@
 #include "../util/profiling.h"
 #include "../util/string/format.h" // Debug
 #include "../util/voxel_raycast.h"
+#include <algorithm>
 
 // Debug
 // #define ZN_MESH_SDF_DEBUG_SLICES
@@ -743,6 +744,187 @@ float get_mesh_signed_distance_at(const Vector3f pos, const ChunkGrid &chunk_gri
 	return -d;
 }
 
+void build_bvh(Span<const Triangle> triangles, TriangleBVH &bvh) {
+	ZN_PROFILE_SCOPE();
+
+	// Leaves are small enough to stay cache-friendly, but not so small that traversal dominates
+	static const unsigned int MAX_LEAF_TRIANGLES = 4;
+
+	bvh.nodes.clear();
+	bvh.triangles.clear();
+
+	if (triangles.size() == 0) {
+		return;
+	}
+
+	StdVector<Vector3f> centers;
+	centers.resize(triangles.size());
+	StdVector<uint32_t> order;
+	order.resize(triangles.size());
+	for (unsigned int i = 0; i < triangles.size(); ++i) {
+		const Triangle &t = triangles[i];
+		centers[i] = (t.v1 + t.v2 + t.v3) / 3.f;
+		order[i] = i;
+	}
+
+	struct Range {
+		uint32_t node_index;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	StdVector<Range> ranges;
+	bvh.nodes.push_back(TriangleBVH::Node());
+	ranges.push_back(Range{ 0, 0, static_cast<uint32_t>(triangles.size()) });
+
+	while (ranges.size() > 0) {
+		const Range range = ranges.back();
+		ranges.pop_back();
+
+		Vector3f min_pos = triangles[order[range.begin]].v1;
+		Vector3f max_pos = min_pos;
+		Vector3f centers_min_pos = centers[order[range.begin]];
+		Vector3f centers_max_pos = centers_min_pos;
+
+		for (unsigned int i = range.begin; i < range.end; ++i) {
+			const Triangle &t = triangles[order[i]];
+			min_pos = math::min(min_pos, math::min(t.v1, math::min(t.v2, t.v3)));
+			max_pos = math::max(max_pos, math::max(t.v1, math::max(t.v2, t.v3)));
+			const Vector3f center = centers[order[i]];
+			centers_min_pos = math::min(centers_min_pos, center);
+			centers_max_pos = math::max(centers_max_pos, center);
+		}
+
+		TriangleBVH::Node &node = bvh.nodes[range.node_index];
+		node.min_pos = min_pos;
+		node.max_pos = max_pos;
+
+		const uint32_t count = range.end - range.begin;
+		const Vector3f centers_size = centers_max_pos - centers_min_pos;
+		unsigned int axis = centers_size.y > centers_size.x ? 1 : 0;
+		if (centers_size.z > centers_size[axis]) {
+			axis = 2;
+		}
+
+		if (count <= MAX_LEAF_TRIANGLES || centers_size[axis] == 0.f) {
+			node.first_index = range.begin;
+			node.triangle_count = count;
+			continue;
+		}
+
+		// Split at the median along the largest axis, so the tree remains balanced
+		const uint32_t mid = range.begin + count / 2;
+		std::nth_element(
+				order.begin() + range.begin,
+				order.begin() + mid,
+				order.begin() + range.end,
+				[&centers, axis](uint32_t a, uint32_t b) { //
+					return centers[a][axis] < centers[b][axis];
+				}
+		);
+
+		const uint32_t child_index = bvh.nodes.size();
+		node.first_index = child_index;
+		node.triangle_count = 0;
+
+		// Note, this invalidates `node`
+		bvh.nodes.push_back(TriangleBVH::Node());
+		bvh.nodes.push_back(TriangleBVH::Node());
+
+		ranges.push_back(Range{ child_index, range.begin, mid });
+		ranges.push_back(Range{ child_index + 1, mid, range.end });
+	}
+
+	bvh.triangles.resize(triangles.size());
+	for (unsigned int i = 0; i < order.size(); ++i) {
+		bvh.triangles[i] = triangles[order[i]];
+	}
+}
+
+inline float get_distance_to_box_squared(const Vector3f pos, const Vector3f min_pos, const Vector3f max_pos) {
+	return math::length_squared(math::max(math::max(min_pos - pos, pos - max_pos), Vector3f()));
+}
+
+const Triangle *get_closest_triangle(const TriangleBVH &bvh, const Vector3f pos, float &out_distance_squared) {
+	float min_distance_squared = 9999999.f;
+	const Triangle *closest_tri = nullptr;
+
+	if (bvh.nodes.size() == 0) {
+		out_distance_squared = min_distance_squared;
+		return nullptr;
+	}
+
+	struct StackItem {
+		uint32_t node_index;
+		float distance_squared;
+	};
+
+	// The tree is balanced, so its depth remains far below this
+	FixedArray<StackItem, 64> stack;
+	unsigned int stack_size = 0;
+	stack[stack_size++] = StackItem{ 0, 0.f };
+
+	while (stack_size > 0) {
+		const StackItem item = stack[--stack_size];
+
+		// A closer triangle may have been found since the node was pushed
+		if (item.distance_squared >= min_distance_squared) {
+			continue;
+		}
+
+		const TriangleBVH::Node &node = bvh.nodes[item.node_index];
+
+		if (node.triangle_count > 0) {
+			const unsigned int end = node.first_index + node.triangle_count;
+			for (unsigned int i = node.first_index; i < end; ++i) {
+				const Triangle &t = bvh.triangles[i];
+				const float sqd = get_distance_to_triangle_squared_precalc(t, pos);
+				if (sqd < min_distance_squared) {
+					min_distance_squared = sqd;
+					closest_tri = &t;
+				}
+			}
+			continue;
+		}
+
+		const TriangleBVH::Node &child0 = bvh.nodes[node.first_index];
+		const TriangleBVH::Node &child1 = bvh.nodes[node.first_index + 1];
+		const StackItem item0{ node.first_index, get_distance_to_box_squared(pos, child0.min_pos, child0.max_pos) };
+		const StackItem item1{ node.first_index + 1, get_distance_to_box_squared(pos, child1.min_pos, child1.max_pos) };
+
+		// Visit the closest child first, so the search radius shrinks sooner
+		const StackItem &near_item = item0.distance_squared < item1.distance_squared ? item0 : item1;
+		const StackItem &far_item = item0.distance_squared < item1.distance_squared ? item1 : item0;
+
+		ZN_ASSERT(stack_size + 2 <= stack.size());
+		if (far_item.distance_squared < min_distance_squared) {
+			stack[stack_size++] = far_item;
+		}
+		if (near_item.distance_squared < min_distance_squared) {
+			stack[stack_size++] = near_item;
+		}
+	}
+
+	out_distance_squared = min_distance_squared;
+	return closest_tri;
+}
+
+float get_mesh_signed_distance_at(const Vector3f pos, const TriangleBVH &bvh) {
+	float min_distance_squared;
+	const Triangle *closest_tri = get_closest_triangle(bvh, pos, min_distance_squared);
+	ZN_ASSERT(closest_tri != nullptr);
+
+	const float d = Math::sqrt(min_distance_squared);
+
+	const Vector3f plane_normal = get_normal(*closest_tri);
+	const float plane_d = math::dot(plane_normal, closest_tri->v1);
+
+	if (math::dot(plane_normal, pos) > plane_d) {
+		return d;
+	}
+	return -d;
+}
+
 struct GridToSpaceConverter {
 	const Vector3i res;
 	const Vector3f min_pos;
@@ -784,6 +966,15 @@ struct EvaluatorCG {
 	}
 };
 
+struct EvaluatorBVH {
+	const TriangleBVH &bvh;
+	const GridToSpaceConverter grid_to_space;
+
+	inline float operator()(const Vector3i grid_pos) const {
+		return get_mesh_signed_distance_at(grid_to_space(grid_pos), bvh);
+	}
+};
+
 void generate_mesh_sdf_approx_interp(
 		Span<float> sdf_grid,
 		const Vector3i res,
@@ -1004,6 +1195,54 @@ void generate_mesh_sdf_partitioned(
 	generate_mesh_sdf_partitioned(sdf_grid, res, Box3i(Vector3i(), res), min_pos, max_pos, chunk_grid);
 }
 
+void generate_mesh_sdf_bvh(
+		Span<float> sdf_grid,
+		const Vector3i res,
+		const Box3i sub_box,
+		const Vector3f min_pos,
+		const Vector3f max_pos,
+		const TriangleBVH &bvh
+) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT(Box3i(Vector3i(), res).contains(sub_box));
+	ZN_ASSERT(sdf_grid.size() == Vector3iUtil::get_volume_u64(res));
+
+	const Vector3f mesh_size = max_pos - min_pos;
+	const Vector3f cell_size = mesh_size / Vector3f(res.x, res.y, res.z);
+	const EvaluatorBVH eval{ bvh, GridToSpaceConverter(res, min_pos, mesh_size, cell_size * 0.5f) };
+
+	const Vector3i sub_box_end = sub_box.position + sub_box.size;
+
+	Vector3i grid_pos;
+	for (grid_pos.z = sub_box.position.z; grid_pos.z < sub_box_end.z; ++grid_pos.z) {
+		for (grid_pos.x = sub_box.position.x; grid_pos.x < sub_box_end.x; ++grid_pos.x) {
+			grid_pos.y = sub_box.position.y;
+			size_t grid_index = Vector3iUtil::get_zxy_index(grid_pos, res);
+
+			for (; grid_pos.y < sub_box_end.y; ++grid_pos.y) {
+				const float sd = eval(grid_pos);
+
+				ZN_ASSERT(grid_index < sdf_grid.size());
+				sdf_grid[grid_index] = sd;
+
+				++grid_index;
+			}
+		}
+	}
+}
+
+void generate_mesh_sdf_bvh(
+		Span<float> sdf_grid,
+		const Vector3i res,
+		Span<const Triangle> triangles,
+		const Vector3f min_pos,
+		const Vector3f max_pos
+) {
+	TriangleBVH bvh;
+	build_bvh(triangles, bvh);
+	generate_mesh_sdf_bvh(sdf_grid, res, Box3i(Vector3i(), res), min_pos, max_pos, bvh);
+}
+
 CheckResult check_sdf(
 		Span<const float> sdf_grid,
 		Vector3i res,
@@ -1181,6 +1420,13 @@ Vector3i auto_compute_grid_resolution(const Vector3f box_size, int cell_count) {
 	return Vector3i(box_size.x / cs, box_size.y / cs, box_size.z / cs);
 }
 
+unsigned int GenMeshSDFSubBoxTask::init_bricks(SharedData &shared_data, unsigned int max_task_count) {
+	shared_data.brick_grid_size = math::ceildiv(shared_data.buffer.get_size(), BRICK_SIZE);
+	shared_data.next_brick_index = 0;
+	const unsigned int brick_count = Vector3iUtil::get_volume_u64(shared_data.brick_grid_size);
+	return math::max(math::min(brick_count, max_task_count), 1u);
+}
+
 // Called from within the thread pool
 void GenMeshSDFSubBoxTask::run(ThreadedTaskContext &ctx) {
 	ZN_PROFILE_SCOPE();
@@ -1192,24 +1438,41 @@ void GenMeshSDFSubBoxTask::run(ThreadedTaskContext &ctx) {
 	Span<float> sdf_grid;
 	ZN_ASSERT(buffer.get_channel_data(channel, sdf_grid));
 
-	if (shared_data->use_chunk_grid) {
-		generate_mesh_sdf_partitioned(
-				sdf_grid, buffer.get_size(), box, shared_data->min_pos, shared_data->max_pos, shared_data->chunk_grid
-		);
-	} else {
-		generate_mesh_sdf_naive(
-				sdf_grid,
-				buffer.get_size(),
-				box,
-				to_span(shared_data->triangles),
-				shared_data->min_pos,
-				shared_data->max_pos
-		);
+	const Vector3i res = buffer.get_size();
+	const Box3i grid_box(Vector3i(), res);
+	const unsigned int brick_count = Vector3iUtil::get_volume_u64(shared_data->brick_grid_size);
+
+	while (true) {
+		const unsigned int brick_index = shared_data->next_brick_index.fetch_add(1, std::memory_order_relaxed);
+		if (brick_index >= brick_count) {
+			break;
+		}
+
+		const Vector3i brick_pos = Vector3iUtil::from_zxy_index(brick_index, shared_data->brick_grid_size);
+		const Box3i box = Box3i(brick_pos * BRICK_SIZE, Vector3iUtil::create(BRICK_SIZE)).clipped(grid_box);
+
+		switch (shared_data->evaluation) {
+			case EVALUATION_NAIVE:
+				generate_mesh_sdf_naive(
+						sdf_grid, res, box, to_span(shared_data->triangles), shared_data->min_pos, shared_data->max_pos
+				);
+				break;
+			case EVALUATION_CHUNK_GRID:
+				generate_mesh_sdf_partitioned(
+						sdf_grid, res, box, shared_data->min_pos, shared_data->max_pos, shared_data->chunk_grid
+				);
+				break;
+			case EVALUATION_BVH:
+				generate_mesh_sdf_bvh(sdf_grid, res, box, shared_data->min_pos, shared_data->max_pos, shared_data->bvh);
+				break;
+			default:
+				ZN_CRASH();
+		}
 	}
 
 	if (shared_data->pending_jobs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
 		if (shared_data->boundary_sign_fix) {
-			fix_sdf_sign_from_boundary(sdf_grid, buffer.get_size(), shared_data->min_pos, shared_data->max_pos);
+			fix_sdf_sign_from_boundary(sdf_grid, res, shared_data->min_pos, shared_data->max_pos);
 		}
 		// That was the last job
 		on_complete();
@@ -1614,4 +1877,171 @@ void generate_mesh_sdf_approx_floodfill(
 	}
 }
 
+// Solves the eikonal equation `|gradient(d)| = 1` at a cell, given the smallest neighbor distance along each axis and
+// the size of cells along each axis. Distances must be unsigned.
+inline float solve_eikonal(Vector3f a, Vector3f h) {
+	// Sort axes by neighbor distance
+	for (unsigned int i = 0; i < 2; ++i) {
+		for (unsigned int j = 0; j < 2 - i; ++j) {
+			if (a[j] > a[j + 1]) {
+				std::swap(a[j], a[j + 1]);
+				std::swap(h[j], h[j + 1]);
+			}
+		}
+	}
+
+	float u = a[0] + h[0];
+
+	// Include more axes as long as the solution is larger than their neighbor distance.
+	// Solves sum((u - a[i])^2 / h[i]^2) = 1
+	float sa = 0.f;
+	float sb = 0.f;
+	float sc = 0.f;
+	for (unsigned int i = 0; i < 3; ++i) {
+		if (u <= a[i]) {
+			break;
+		}
+		const float inv_h2 = 1.f / math::squared(h[i]);
+		sa += inv_h2;
+		sb += a[i] * inv_h2;
+		sc += math::squared(a[i]) * inv_h2;
+		if (i == 0) {
+			continue;
+		}
+		const float discriminant = sb * sb - sa * (sc - 1.f);
+		if (discriminant < 0.f) {
+			break;
+		}
+		u = (sb + Math::sqrt(discriminant)) / sa;
+	}
+
+	return u;
+}
+
+void generate_mesh_sdf_approx_narrow_band(
+		Span<float> sdf_grid,
+		const Vector3i res,
+		Span<const Triangle> triangles,
+		const Vector3f min_pos,
+		const Vector3f max_pos
+) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT(sdf_grid.size() == Vector3iUtil::get_volume_u64(res));
+
+	if (Vector3iUtil::is_empty_size(res)) {
+		return;
+	}
+
+	TriangleBVH bvh;
+	build_bvh(triangles, bvh);
+
+	const Vector3f mesh_size = max_pos - min_pos;
+	const Vector3f cell_size = mesh_size / Vector3f(res.x, res.y, res.z);
+	const EvaluatorBVH eval{ bvh, GridToSpaceConverter(res, min_pos, mesh_size, cell_size * 0.5f) };
+	const Vector3f inv_gts_scale = Vector3f(1.f) / eval.grid_to_space.scale;
+	const Box3i grid_box(Vector3i(), res);
+
+	sdf_grid.fill(FAR_SD);
+
+	StdVector<uint8_t> flag_grid;
+	flag_grid.resize(sdf_grid.size(), FLAG_NOT_VISITED);
+
+	{
+		ZN_PROFILE_SCOPE_NAMED("Narrow band");
+
+		// Same padding as the hull used by the floodfill method
+		constexpr int pad = 2;
+
+		for (const Triangle &t : bvh.triangles) {
+			const Vector3f aabb_min = math::min(t.v1, math::min(t.v2, t.v3));
+			const Vector3f aabb_max = math::max(t.v1, math::max(t.v2, t.v3));
+
+			// Space to grid
+			const Vector3f aabb_min_g = inv_gts_scale * (aabb_min - eval.grid_to_space.translation);
+			const Vector3f aabb_max_g = inv_gts_scale * (aabb_max - eval.grid_to_space.translation);
+
+			const Box3i tbox = Box3i::from_min_max(to_vec3i(math::floor(aabb_min_g)), to_vec3i(math::ceil(aabb_max_g)))
+									   .padded(pad)
+									   .clipped(grid_box);
+
+			tbox.for_each_cell_zxy([&sdf_grid, &flag_grid, &eval, res](const Vector3i &grid_pos) {
+				const size_t i = Vector3iUtil::get_zxy_index(grid_pos, res);
+				if (flag_grid[i] == FLAG_FROZEN) {
+					// Already computed, boxes of neighbor triangles overlap a lot
+					return;
+				}
+				flag_grid[i] = FLAG_FROZEN;
+				sdf_grid[i] = eval(grid_pos);
+			});
+		}
+	}
+
+	{
+		ZN_PROFILE_SCOPE_NAMED("Fast sweeping");
+
+		// Strides of X, Y and Z in ZXY order
+		const Vector3i strides(res.y, 1, res.y * res.x);
+
+		// Sweeping in the 8 diagonal directions is enough for information to reach every cell from the band
+		for (unsigned int sweep = 0; sweep < 8; ++sweep) {
+			const int dx = (sweep & 1) == 0 ? 1 : -1;
+			const int dy = (sweep & 2) == 0 ? 1 : -1;
+			const int dz = (sweep & 4) == 0 ? 1 : -1;
+
+			const Vector3i begin(dx > 0 ? 0 : res.x - 1, dy > 0 ? 0 : res.y - 1, dz > 0 ? 0 : res.z - 1);
+			const Vector3i end(dx > 0 ? res.x : -1, dy > 0 ? res.y : -1, dz > 0 ? res.z : -1);
+
+			Vector3i pos;
+			for (pos.z = begin.z; pos.z != end.z; pos.z += dz) {
+				for (pos.x = begin.x; pos.x != end.x; pos.x += dx) {
+					for (pos.y = begin.y; pos.y != end.y; pos.y += dy) {
+						const unsigned int loc = Vector3iUtil::get_zxy_index(pos, res);
+						if (flag_grid[loc] == FLAG_FROZEN) {
+							continue;
+						}
+
+						// Smallest unsigned neighbor distance along each axis
+						Vector3f a(FAR_SD);
+						// Signed distance of the closest neighbor, which gives its sign to the cell
+						float closest_sd = FAR_SD;
+
+						for (unsigned int axis = 0; axis < 3; ++axis) {
+							if (pos[axis] > 0) {
+								const float nsd = sdf_grid[loc - strides[axis]];
+								if (Math::abs(nsd) < a[axis]) {
+									a[axis] = Math::abs(nsd);
+									if (a[axis] < Math::abs(closest_sd)) {
+										closest_sd = nsd;
+									}
+								}
+							}
+							if (pos[axis] < res[axis] - 1) {
+								const float nsd = sdf_grid[loc + strides[axis]];
+								if (Math::abs(nsd) < a[axis]) {
+									a[axis] = Math::abs(nsd);
+									if (a[axis] < Math::abs(closest_sd)) {
+										closest_sd = nsd;
+									}
+								}
+							}
+						}
+
+						if (closest_sd == FAR_SD) {
+							// Not reached yet
+							continue;
+						}
+
+						const float ud = solve_eikonal(a, cell_size);
+
+						float &dst_sd = sdf_grid[loc];
+						if (ud < Math::abs(dst_sd)) {
+							dst_sd = closest_sd < 0.f ? -ud : ud;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
 } // namespace zylann::voxel::mesh_sdf
@@ -48,8 +48,35 @@ struct ChunkGrid {
 	float chunk_size; // Size of a cubic cell in space units
 };
 
+// Bounding volume hierarchy of triangles, used to find the closest triangle to a point without checking all of them.
+// Unlike `ChunkGrid`, it adapts to how triangles are distributed, so it doesn't need tuning and stays exact.
+struct TriangleBVH {
+	struct Node {
+		Vector3f min_pos;
+		Vector3f max_pos;
+		// If the node is a leaf, index of its first triangle. Otherwise, index of its first child, and the second
+		// child follows it.
+		uint32_t first_index;
+		// Zero if the node is not a leaf
+		uint32_t triangle_count;
+	};
+
+	// The first node is the root
+	StdVector<Node> nodes;
+	// Copy of triangles, ordered such that those of a leaf are contiguous
+	StdVector<Triangle> triangles;
+};
+
 class GenMeshSDFSubBoxTask : public IThreadedTask {
 public:
+	enum Evaluation { //
+		EVALUATION_NAIVE,
+		EVALUATION_CHUNK_GRID,
+		EVALUATION_BVH
+	};
+
+	static const int BRICK_SIZE = 8;
+
 	struct SharedData {
 		StdVector<Triangle> triangles;
 		std::atomic_int pending_jobs = { 0 };
@@ -57,14 +84,22 @@ public:
 		Vector3f min_pos;
 		Vector3f max_pos;
 		ChunkGrid chunk_grid;
-		bool use_chunk_grid = false;
+		TriangleBVH bvh;
+		Evaluation evaluation = EVALUATION_NAIVE;
 		bool boundary_sign_fix = false;
+		// The grid is processed in bricks of cells, which tasks take one after the other until none remain. That way,
+		// tasks finishing early keep working instead of waiting for others, since the cost of cells varies a lot.
+		Vector3i brick_grid_size;
+		std::atomic_uint next_brick_index = { 0 };
 
 		SharedData() : buffer(VoxelBuffer::ALLOCATOR_DEFAULT) {}
 	};
 
 	std::shared_ptr<SharedData> shared_data;
-	Box3i box;
+
+	// Sets up bricks of the grid and returns how many tasks are worth spawning to process them.
+	// The buffer must have been created before.
+	static unsigned int init_bricks(SharedData &shared_data, unsigned int max_task_count);
 
 	void run(ThreadedTaskContext &ctx) override;
 
@@ -100,6 +135,12 @@ void partition_triangles(
 // This is necessary for functions using ChunkGrid.
 void compute_near_chunks(ChunkGrid &chunk_grid);
 
+// Builds a BVH over triangles, which must have been prepared with `prepare_triangles()`.
+void build_bvh(Span<const Triangle> triangles, TriangleBVH &bvh);
+
+// Finds the closest triangle to a point. Returns null if the BVH is empty.
+const Triangle *get_closest_triangle(const TriangleBVH &bvh, const Vector3f pos, float &out_distance_squared);
+
 // A naive method to get a sampled SDF from a mesh, by checking every triangle at every cell. It's accurate, but much
 // slower than other techniques, but could be used as a CPU-based alternative, for less
 // realtime-intensive tasks. The mesh must be closed, otherwise the SDF will contain errors.
@@ -123,6 +164,29 @@ void generate_mesh_sdf_partitioned(
 		int subdiv
 );
 
+// Computes the SDF with the same accuracy as the naive method, finding closest triangles with a BVH. It is usually
+// much faster than partitioning with a grid, especially with meshes having large triangles or uneven density.
+void generate_mesh_sdf_bvh(
+		Span<float> sdf_grid,
+		const Vector3i res,
+		Span<const Triangle> triangles,
+		const Vector3f min_pos,
+		const Vector3f max_pos
+);
+
+// Generates an approximation.
+// Computes accurate signed distances only in a narrow band of cells around triangles, using a BVH. Remaining cells are
+// filled with the fast sweeping method, which solves the distance equation outwards from the band and carries signs
+// along. Compared to the floodfill method, signs don't require raycasts and distances far from the surface are closer
+// to euclidean. The mesh must be closed.
+void generate_mesh_sdf_approx_narrow_band(
+		Span<float> sdf_grid,
+		const Vector3i res,
+		Span<const Triangle> triangles,
+		const Vector3f min_pos,
+		const Vector3f max_pos
+);
+
 // Generates an approximation.
 // Subdivides the grid into nodes spanning 4*4*4 cells each.
 // If a node's corner distances are close to the surface, the SDF is fully evaluated. Otherwise, it is interpolated.
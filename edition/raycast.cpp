@@ -14,36 +14,37 @@ namespace zylann::voxel {
 
 // Binary search can be more accurate than linear regression because the SDF can be inaccurate in the first place.
 // An alternative would be to polygonize a tiny area around the middle-phase hit position.
+// `float sdf_func(Vector3 pos)` returns the interpolated SDF at a position.
 // `d1` is how far from `pos0` along `dir` the binary search will take place.
 // The segment may be adjusted internally if it does not contain a zero-crossing of the
-template <typename Volume_F>
+template <typename Sdf_F>
 float approximate_distance_to_isosurface_binary_search(
-		const Volume_F &f,
+		const Sdf_F &sdf_func,
 		const Vector3 pos0,
 		const Vector3 dir,
 		float d1,
 		const int iterations
 ) {
 	float d0 = 0.f;
-	float sdf0 = get_sdf_interpolated(f, pos0);
+	float sdf0 = sdf_func(pos0);
 	// The position given as argument may be a rough approximation coming from the middle-phase,
 	// so it can be slightly below the surface. We can adjust it a little so it is above.
 	for (int i = 0; i < 4 && sdf0 < 0.f; ++i) {
 		d0 -= 0.5f;
-		sdf0 = get_sdf_interpolated(f, pos0 + dir * d0);
+		sdf0 = sdf_func(pos0 + dir * d0);
 	}
 
-	float sdf1 = get_sdf_interpolated(f, pos0 + dir * d1);
+	float sdf1 = sdf_func(pos0 + dir * d1);
 	for (int i = 0; i < 4 && sdf1 > 0.f; ++i) {
 		d1 += 0.5f;
-		sdf1 = get_sdf_interpolated(f, pos0 + dir * d1);
+		sdf1 = sdf_func(pos0 + dir * d1);
 	}
 
 	if ((sdf0 > 0) != (sdf1 > 0)) {
 		// Binary search
 		for (int i = 0; i < iterations; ++i) {
 			const float dm = 0.5f * (d0 + d1);
-			const float sdf_mid = get_sdf_interpolated(f, pos0 + dir * dm);
+			const float sdf_mid = sdf_func(pos0 + dir * dm);
 
 			if ((sdf_mid > 0) != (sdf0 > 0)) {
 				sdf1 = sdf_mid;
@@ -214,22 +215,12 @@ Ref<VoxelRaycastResult> raycast_sdf(
 		float d = hit_distance;
 
 		if (binary_search_iterations > 0) {
-			// This is not particularly optimized, but runs fast enough for player raycasts
-			struct VolumeSampler {
-				const VoxelData &data;
-
-				inline float operator()(const Vector3i &pos) const {
-					VoxelSingleValue defval;
-					defval.f = constants::SDF_FAR_OUTSIDE;
-					const VoxelSingleValue value = data.get_voxel(pos, VoxelBuffer::CHANNEL_SDF, defval);
-					return value.f;
-				}
-			};
-
-			VolumeSampler sampler{ voxel_data };
+			// Each step gets its 8 voxels in a single query, so those that have to be generated are generated together
 			d = hit_distance_prev +
 					approximate_distance_to_isosurface_binary_search(
-							sampler,
+							[&voxel_data](Vector3 pos) {
+								return get_sdf_interpolated(voxel_data, VoxelBuffer::CHANNEL_SDF, pos);
+							},
 							ray_origin + ray_dir * hit_distance_prev,
 							ray_dir,
 							hit_distance - hit_distance_prev,
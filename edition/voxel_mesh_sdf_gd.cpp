@@ -145,6 +145,12 @@ void VoxelMeshSDF::bake() {
 		case BAKE_MODE_APPROX_INTERP:
 			mesh_sdf::generate_mesh_sdf_approx_interp(sdf_grid, res, to_span(triangles), box_min_pos, box_max_pos);
 			break;
+		case BAKE_MODE_ACCURATE_BVH:
+			mesh_sdf::generate_mesh_sdf_bvh(sdf_grid, res, to_span(triangles), box_min_pos, box_max_pos);
+			break;
+		case BAKE_MODE_APPROX_NARROW_BAND:
+			mesh_sdf::generate_mesh_sdf_approx_narrow_band(sdf_grid, res, to_span(triangles), box_min_pos, box_max_pos);
+			break;
 		case BAKE_MODE_APPROX_FLOODFILL: {
 			mesh_sdf::ChunkGrid chunk_grid;
 			mesh_sdf::partition_triangles(_partition_subdiv, to_span(triangles), box_min_pos, box_max_pos, chunk_grid);
@@ -249,11 +255,11 @@ void VoxelMeshSDF::bake_async(SceneTree *scene_tree) {
 
 			switch (bake_mode) {
 				case BAKE_MODE_ACCURATE_NAIVE:
-				case BAKE_MODE_ACCURATE_PARTITIONED: {
-					// These two approaches are better parallelized
+				case BAKE_MODE_ACCURATE_PARTITIONED:
+				case BAKE_MODE_ACCURATE_BVH: {
+					// These approaches are better parallelized
 
-					const bool partitioned = bake_mode == BAKE_MODE_ACCURATE_PARTITIONED;
-					if (partitioned) {
+					if (bake_mode == BAKE_MODE_ACCURATE_PARTITIONED) {
 						mesh_sdf::partition_triangles(
 								partition_subdiv,
 								to_span(shared_data->triangles),
@@ -262,25 +268,49 @@ void VoxelMeshSDF::bake_async(SceneTree *scene_tree) {
 								shared_data->chunk_grid
 						);
 						mesh_sdf::compute_near_chunks(shared_data->chunk_grid);
+						shared_data->evaluation = mesh_sdf::GenMeshSDFSubBoxTask::EVALUATION_CHUNK_GRID;
+
+					} else if (bake_mode == BAKE_MODE_ACCURATE_BVH) {
+						mesh_sdf::build_bvh(to_span(shared_data->triangles), shared_data->bvh);
+						shared_data->evaluation = mesh_sdf::GenMeshSDFSubBoxTask::EVALUATION_BVH;
+
+					} else {
+						shared_data->evaluation = mesh_sdf::GenMeshSDFSubBoxTask::EVALUATION_NAIVE;
 					}
-					shared_data->use_chunk_grid = partitioned;
 
 					shared_data->boundary_sign_fix = boundary_sign_fix;
 
-					// Spawn a parallel task for every Z slice of the grid.
-					// Indexing is ZXY so each thread accesses a contiguous part of memory.
-					shared_data->pending_jobs = res.z;
+					// Spawn one task per thread, each taking bricks of the grid until none remain
+					const unsigned int task_count = mesh_sdf::GenMeshSDFSubBoxTask::init_bricks(
+							*shared_data, VoxelEngine::get_singleton().get_thread_count()
+					);
+					shared_data->pending_jobs = task_count;
 
-					for (int z = 0; z < res.z; ++z) {
+					for (unsigned int i = 0; i < task_count; ++i) {
 						GenMeshSDFSubBoxTaskGD *task = ZN_NEW(GenMeshSDFSubBoxTaskGD);
 						task->shared_data = shared_data;
-						task->box = Box3i(Vector3i(0, 0, z), Vector3i(res.x, res.y, 1));
 						task->obj_to_notify = obj_to_notify;
 
 						VoxelEngine::get_singleton().push_async_task(task);
 					}
 				} break;
 
+				case BAKE_MODE_APPROX_NARROW_BAND: {
+					VoxelBuffer &buffer = shared_data->buffer;
+					Span<float> sdf_grid;
+					ZN_ASSERT(buffer.get_channel_data(channel, sdf_grid));
+
+					mesh_sdf::generate_mesh_sdf_approx_narrow_band(
+							sdf_grid, res, to_span(shared_data->triangles), box_min_pos, box_max_pos
+					);
+
+					if (boundary_sign_fix) {
+						mesh_sdf::fix_sdf_sign_from_boundary(sdf_grid, res, box_min_pos, box_max_pos);
+					}
+
+					L::notify_on_complete(**obj_to_notify, *shared_data);
+				} break;
+
 				case BAKE_MODE_APPROX_INTERP: {
 					VoxelBuffer &buffer = shared_data->buffer;
 					Span<float> sdf_grid;
@@ -563,7 +593,7 @@ void VoxelMeshSDF::_bind_methods() {
 					Variant::INT,
 					"bake_mode",
 					PROPERTY_HINT_ENUM,
-					"AccurateNaive,AccuratePartitioned,ApproxInterp,FloodFill"
+					"AccurateNaive,AccuratePartitioned,ApproxInterp,FloodFill,AccurateBVH,NarrowBand"
 			),
 			"set_bake_mode",
 			"get_bake_mode"
@@ -599,6 +629,8 @@ void VoxelMeshSDF::_bind_methods() {
 	BIND_ENUM_CONSTANT(BAKE_MODE_ACCURATE_PARTITIONED);
 	BIND_ENUM_CONSTANT(BAKE_MODE_APPROX_INTERP);
 	BIND_ENUM_CONSTANT(BAKE_MODE_APPROX_FLOODFILL);
+	BIND_ENUM_CONSTANT(BAKE_MODE_ACCURATE_BVH);
+	BIND_ENUM_CONSTANT(BAKE_MODE_APPROX_NARROW_BAND);
 	BIND_ENUM_CONSTANT(BAKE_MODE_COUNT);
 }
 
@@ -24,6 +24,8 @@ public:
 		BAKE_MODE_ACCURATE_PARTITIONED,
 		BAKE_MODE_APPROX_INTERP,
 		BAKE_MODE_APPROX_FLOODFILL,
+		BAKE_MODE_ACCURATE_BVH,
+		BAKE_MODE_APPROX_NARROW_BAND,
 		BAKE_MODE_COUNT
 	};
 
@@ -2,6 +2,7 @@
 
 #include "../storage/voxel_buffer_gd.h"
 #include "../storage/voxel_data.h"
+#include "../util/containers/std_unordered_set.h"
 #include "../util/godot/core/packed_arrays.h"
 #include "../util/io/log.h"
 #include "../util/math/color8.h"
@@ -130,6 +131,7 @@ void VoxelTool::set_voxel(Vector3i pos, uint64_t v) {
 		ZN_PRINT_WARNING("Area not editable");
 		return;
 	}
+	_pre_edit(box);
 	_set_voxel(pos, v);
 	_post_edit(box);
 }
@@ -140,6 +142,7 @@ void VoxelTool::set_voxel_f(Vector3i pos, float v) {
 		ZN_PRINT_WARNING("Area not editable");
 		return;
 	}
+	_pre_edit(box);
 	_set_voxel_f(pos, v);
 	_post_edit(box);
 }
@@ -149,6 +152,7 @@ void VoxelTool::do_point(Vector3i pos) {
 	if (!is_area_editable(box)) {
 		return;
 	}
+	_pre_edit(box);
 	if (_channel == VoxelBuffer::CHANNEL_SDF) {
 		// Not consistent SDF, but should work
 		_set_voxel_f(pos, _mode == MODE_REMOVE ? constants::SDF_FAR_OUTSIDE : constants::SDF_FAR_INSIDE);
@@ -194,6 +198,8 @@ void VoxelTool::do_sphere(Vector3 p_center, float radius) {
 		return;
 	}
 
+	_pre_edit(box);
+
 	if (_channel == VoxelBuffer::CHANNEL_SDF) {
 		const Vector3f center = to_vec3f(p_center);
 		box.for_each_cell([this, center, radius](Vector3i pos) {
@@ -231,6 +237,8 @@ void VoxelTool::sdf_stamp_erase(const VoxelBuffer &stamp, Vector3i pos) {
 		return;
 	}
 
+	_pre_edit(box);
+
 	box.for_each_cell_zxy([this, &stamp, pos](Vector3i pos_in_volume) {
 		const Vector3i pos_in_stamp = pos_in_volume - pos;
 		const float dst_sdf =
@@ -256,6 +264,8 @@ void VoxelTool::do_box(Vector3i begin, Vector3i end) {
 		return;
 	}
 
+	_pre_edit(box);
+
 	if (_channel == VoxelBuffer::CHANNEL_SDF) {
 		// TODO Better quality
 		// Not consistent SDF, but should work ok
@@ -414,10 +424,26 @@ bool VoxelTool::is_area_editable(const Box3i &box) const {
 	return false;
 }
 
+void VoxelTool::_pre_edit(const Box3i &box) {
+	// Optional
+}
+
 void VoxelTool::_post_edit(const Box3i &box) {
 	ERR_PRINT("Not implemented");
 }
 
+void VoxelTool::_pre_edit_boxes(Span<const Box3i> boxes) {
+	for (const Box3i &box : boxes) {
+		_pre_edit(box);
+	}
+}
+
+void VoxelTool::_post_edit_boxes(Span<const Box3i> boxes) {
+	for (const Box3i &box : boxes) {
+		_post_edit(box);
+	}
+}
+
 void VoxelTool::set_voxel_metadata(const Vector3i pos, const Variant &meta) {
 	ERR_PRINT("Not implemented");
 }
@@ -432,6 +458,181 @@ VoxelFormat VoxelTool::get_format() const {
 	return VoxelFormat();
 }
 
+bool VoxelTool::undo() {
+	ERR_PRINT("Not implemented");
+	return false;
+}
+
+bool VoxelTool::redo() {
+	ERR_PRINT("Not implemented");
+	return false;
+}
+
+void VoxelTool::begin_brush_batch() {
+	ERR_FAIL_COND_MSG(_brush_batch_open, "A brush batch is already open");
+	_brush_batch.items.clear();
+	_brush_batch.channel = _channel;
+	_brush_batch_open = true;
+}
+
+void VoxelTool::end_brush_batch() {
+	ERR_FAIL_COND_MSG(!_brush_batch_open, "No brush batch is open");
+	_brush_batch_open = false;
+	if (_brush_batch.items.size() > 0) {
+		_do_brush_batch(_brush_batch);
+	}
+	_brush_batch.items.clear();
+}
+
+void VoxelTool::_do_brush_batch(const ops::BrushBatch &batch) {
+	ERR_PRINT("Not implemented");
+	// Implemented in derived classes
+}
+
+namespace {
+
+ops::BrushBatch::Item make_brush_batch_item(
+		ops::BrushBatch::ShapeType shape_type,
+		VoxelTool::Mode mode,
+		float strength,
+		uint64_t value,
+		const ops::TextureParams &texture_params
+) {
+	ops::BrushBatch::Item item;
+	item.shape_type = shape_type;
+	item.mode = ops::Mode(mode);
+	item.strength = strength;
+	item.blocky_value = value;
+	item.texture_params = texture_params;
+	return item;
+}
+
+} // namespace
+
+bool VoxelTool::_try_add_sphere_to_brush_batch(Vector3 center, float radius) {
+	if (!_brush_batch_open) {
+		return false;
+	}
+	const uint64_t value = get_mode() == MODE_REMOVE ? _eraser_value : _value;
+	ops::BrushBatch::Item item = make_brush_batch_item(
+			ops::BrushBatch::SHAPE_SPHERE, get_mode(), get_sdf_strength(), value, _texture_params
+	);
+	item.sphere.center = to_vec3f(center);
+	item.sphere.radius = radius;
+	item.sphere.sdf_scale = get_sdf_scale();
+	item.box = item.sphere.get_box();
+	_brush_batch.items.push_back(item);
+	return true;
+}
+
+bool VoxelTool::_try_add_box_to_brush_batch(Vector3i begin, Vector3i end) {
+	if (!_brush_batch_open) {
+		return false;
+	}
+	Vector3iUtil::sort_min_max(begin, end);
+	const uint64_t value = get_mode() == MODE_REMOVE ? _eraser_value : _value;
+	ops::BrushBatch::Item item = make_brush_batch_item(
+			ops::BrushBatch::SHAPE_BOX, get_mode(), get_sdf_strength(), value, _texture_params
+	);
+	item.aabox.center = to_vec3f(begin + end) * 0.5f;
+	item.aabox.half_size = to_vec3f(end - begin) * 0.5f;
+	item.aabox.sdf_scale = get_sdf_scale();
+	item.box = item.aabox.get_box();
+	_brush_batch.items.push_back(item);
+	return true;
+}
+
+bool VoxelTool::_try_add_path_to_brush_batch(Span<const Vector3> positions, Span<const float> radii) {
+	if (!_brush_batch_open) {
+		return false;
+	}
+	ERR_FAIL_COND_V(positions.size() < 2, true);
+	ERR_FAIL_COND_V(positions.size() != radii.size(), true);
+
+	// Same as `do_path_chunked`
+	const int margin = 1;
+	const uint64_t value = get_mode() == MODE_REMOVE ? _eraser_value : _value;
+
+	for (unsigned int point_index = 1; point_index < positions.size(); ++point_index) {
+		ops::BrushBatch::Item item = make_brush_batch_item(
+				ops::BrushBatch::SHAPE_ROUND_CONE, get_mode(), get_sdf_strength(), value, _texture_params
+		);
+		item.round_cone.cone.a = to_vec3f(positions[point_index - 1]);
+		item.round_cone.cone.b = to_vec3f(positions[point_index]);
+		item.round_cone.cone.r1 = radii[point_index - 1];
+		item.round_cone.cone.r2 = radii[point_index];
+		item.round_cone.cone.update();
+		item.round_cone.sdf_scale = get_sdf_scale();
+		item.box = item.round_cone.get_box().padded(margin);
+		_brush_batch.items.push_back(item);
+	}
+	return true;
+}
+
+void VoxelTool::do_brush_batch_chunked(VoxelData &vdata, const ops::BrushBatch &batch, const bool with_pre_generate) {
+	ZN_PROFILE_SCOPE();
+
+	// Shapes in areas that can't be edited are skipped, without preventing others from being applied
+	ops::BrushBatch editable_batch;
+	editable_batch.channel = batch.channel;
+	editable_batch.items.reserve(batch.items.size());
+	StdVector<Box3i> boxes;
+	boxes.reserve(batch.items.size());
+	bool has_non_editable_items = false;
+
+	for (const ops::BrushBatch::Item &item : batch.items) {
+		const Box3i box = item.box.clipped(vdata.get_bounds());
+		if (box.is_empty()) {
+			continue;
+		}
+		if (!is_area_editable(box)) {
+			has_non_editable_items = true;
+			continue;
+		}
+		ops::BrushBatch::Item editable_item = item;
+		editable_item.box = box;
+		editable_batch.items.push_back(editable_item);
+		boxes.push_back(box);
+	}
+
+	if (has_non_editable_items) {
+		ZN_PRINT_WARNING("Area not editable, some shapes of the brush batch were skipped");
+	}
+	if (boxes.size() == 0) {
+		return;
+	}
+
+	if (with_pre_generate) {
+		for (const Box3i &box : boxes) {
+			vdata.pre_generate_box(box);
+		}
+	}
+
+	_pre_edit_boxes(to_span(boxes));
+
+	// Only process blocks touched by shapes, so shapes far apart don't lock or process the blocks in between
+	const int block_size = vdata.get_block_size();
+	StdUnorderedSet<Vector3i> touched_blocks_set;
+	StdVector<Vector3i> touched_blocks;
+	for (const Box3i &box : boxes) {
+		box.downscaled(block_size).for_each_cell_zxy([&touched_blocks_set, &touched_blocks](Vector3i bpos) {
+			if (touched_blocks_set.insert(bpos).second) {
+				touched_blocks.push_back(bpos);
+			}
+		});
+	}
+
+	VoxelDataGrid grid;
+	for (const Vector3i bpos : touched_blocks) {
+		const Box3i block_box = Box3i(bpos * block_size, Vector3iUtil::create(block_size)).clipped(vdata.get_bounds());
+		vdata.get_blocks_grid_for_write(grid, block_box, 0);
+		VoxelDataGrid::LockWrite wlock(grid);
+		ops::do_brush_batch(editable_batch, block_box, grid);
+	}
+
+	_post_edit_boxes(to_span(boxes));
+}
+
 void VoxelTool::do_path_chunked(
 		VoxelData &vdata,
 		Span<const Vector3> positions,
@@ -461,9 +662,11 @@ void VoxelTool::do_path_chunked(
 		vdata.pre_generate_box(total_voxel_box);
 	}
 
+	_pre_edit(total_voxel_box);
+
 	VoxelDataGrid grid;
 
-	vdata.get_blocks_grid(grid, total_voxel_box, 0);
+	vdata.get_blocks_grid_for_write(grid, total_voxel_box, 0);
 
 	{
 		VoxelDataGrid::LockWrite wlock(grid);
@@ -560,6 +763,8 @@ void VoxelTool::do_mesh_chunked(
 		vdata.pre_generate_box(voxel_box);
 	}
 
+	_pre_edit(voxel_box);
+
 	// TODO Maybe more efficient to "rasterize" the box? We're going to iterate voxels the box doesn't intersect.
 	// TODO Maybe we should scale SDF values based on the scale of the transform too
 	// TODO Support other depths, format should be accessible from the volume
@@ -588,7 +793,7 @@ void VoxelTool::do_mesh_chunked(
 	op.box = voxel_box;
 
 	VoxelDataGrid grid;
-	vdata.get_blocks_grid(grid, voxel_box, 0);
+	vdata.get_blocks_grid_for_write(grid, voxel_box, 0);
 	op.block_access.grid = &grid;
 
 	{
@@ -765,6 +970,8 @@ void VoxelTool::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("do_sphere", "center", "radius"), &VoxelTool::_b_do_sphere);
 	ClassDB::bind_method(D_METHOD("do_box", "begin", "end"), &VoxelTool::_b_do_box);
 	ClassDB::bind_method(D_METHOD("do_path", "points", "radii"), &VoxelTool::_b_do_path);
+	ClassDB::bind_method(D_METHOD("begin_brush_batch"), &VoxelTool::begin_brush_batch);
+	ClassDB::bind_method(D_METHOD("end_brush_batch"), &VoxelTool::end_brush_batch);
 #ifdef VOXEL_ENABLE_MESH_SDF
 	ClassDB::bind_method(D_METHOD("do_mesh", "mesh_sdf", "transform", "isolevel"), &VoxelTool::_b_do_mesh, DEFVAL(0.0));
 #endif
@@ -819,6 +1026,9 @@ void VoxelTool::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("is_area_editable", "box"), &VoxelTool::_b_is_area_editable);
 
+	ClassDB::bind_method(D_METHOD("undo"), &VoxelTool::undo);
+	ClassDB::bind_method(D_METHOD("redo"), &VoxelTool::redo);
+
 	// Encoding helpers
 	ClassDB::bind_static_method(VoxelTool::get_class_static(), D_METHOD("color_to_u16", "color"), &_b_color_to_u16);
 	ClassDB::bind_static_method(VoxelTool::get_class_static(), D_METHOD("color_to_u32", "color"), &_b_color_to_u32);
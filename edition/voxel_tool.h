@@ -80,6 +80,13 @@ public:
 	virtual void do_mesh(const VoxelMeshSDF &mesh_sdf, const Transform3D &transform, const float isolevel);
 #endif
 
+	// While a brush batch is open, shapes from `do_sphere`, `do_box` and `do_path` are not applied immediately. They
+	// are collected with the current mode and parameters, and applied all at once in a single pass when the batch
+	// ends, as a single edit. The channel used is the one that was set when the batch began.
+	// Tools that don't support batching apply shapes immediately.
+	void begin_brush_batch();
+	void end_brush_batch();
+
 	void sdf_stamp_erase(Ref<godot::VoxelBuffer> stamp, Vector3i pos);
 	void sdf_stamp_erase(const VoxelBuffer &stamp, Vector3i pos);
 
@@ -132,6 +139,11 @@ public:
 
 	virtual VoxelFormat get_format() const;
 
+	// Reverts the last edit recorded in the edit journal of the volume. Returns false if there is nothing to undo.
+	virtual bool undo();
+	// Applies again the last undone edit. Returns false if there is nothing to redo.
+	virtual bool redo();
+
 protected:
 	static void _bind_methods();
 
@@ -141,7 +153,22 @@ protected:
 	virtual float _get_voxel_f(Vector3i pos) const;
 	virtual void _set_voxel(Vector3i pos, uint64_t v);
 	virtual void _set_voxel_f(Vector3i pos, float v);
+	// Called before an edit modifies voxels in the given box, and after checking that the area is editable
+	virtual void _pre_edit(const Box3i &box);
 	virtual void _post_edit(const Box3i &box);
+	// Same as `_pre_edit` and `_post_edit`, for a single edit modifying voxels in several boxes. By default, calls them
+	// for each box.
+	virtual void _pre_edit_boxes(Span<const Box3i> boxes);
+	virtual void _post_edit_boxes(Span<const Box3i> boxes);
+
+	// Each returns true if the shape was added to the current brush batch, in which case it must not be applied now
+	bool _try_add_sphere_to_brush_batch(Vector3 center, float radius);
+	bool _try_add_box_to_brush_batch(Vector3i begin, Vector3i end);
+	bool _try_add_path_to_brush_batch(Span<const Vector3> positions, Span<const float> radii);
+
+	virtual void _do_brush_batch(const ops::BrushBatch &batch);
+
+	void do_brush_batch_chunked(VoxelData &vdata, const ops::BrushBatch &batch, const bool with_pre_generate);
 
 	void do_path_chunked(
 			VoxelData &vdata,
@@ -206,6 +233,9 @@ protected:
 
 	// Used on smooth terrain
 	ops::TextureParams _texture_params;
+
+	ops::BrushBatch _brush_batch;
+	bool _brush_batch_open = false;
 };
 
 } // namespace zylann::voxel
@@ -56,6 +56,10 @@ void VoxelToolLodTerrain::do_box(Vector3i begin, Vector3i end) {
 	ZN_PROFILE_SCOPE();
 	ERR_FAIL_COND(_terrain == nullptr);
 
+	if (_try_add_box_to_brush_batch(begin, end)) {
+		return;
+	}
+
 	ops::DoShapeChunked<ops::SdfAxisAlignedBox, ops::VoxelDataGridAccess> op;
 	op.shape.center = to_vec3f(begin + end) * 0.5f;
 	op.shape.half_size = to_vec3f(end - begin) * 0.5f;
@@ -75,9 +79,10 @@ void VoxelToolLodTerrain::do_box(Vector3i begin, Vector3i end) {
 	VoxelData &data = _terrain->get_storage();
 
 	data.pre_generate_box(op.box);
+	_pre_edit(op.box);
 
 	VoxelDataGrid grid;
-	data.get_blocks_grid(grid, op.box, 0);
+	data.get_blocks_grid_for_write(grid, op.box, 0);
 	op.block_access.grid = &grid;
 
 	{
@@ -92,6 +97,10 @@ void VoxelToolLodTerrain::do_sphere(Vector3 center, float radius) {
 	ZN_PROFILE_SCOPE();
 	ERR_FAIL_COND(_terrain == nullptr);
 
+	if (_try_add_sphere_to_brush_batch(center, radius)) {
+		return;
+	}
+
 	ops::DoSphere op;
 	op.shape.center = to_vec3f(center);
 	op.shape.radius = radius;
@@ -113,7 +122,8 @@ void VoxelToolLodTerrain::do_sphere(Vector3 center, float radius) {
 	VoxelData &data = _terrain->get_storage();
 
 	data.pre_generate_box(world_box);
-	data.get_blocks_grid(op.blocks, world_box, 0);
+	_pre_edit(world_box);
+	data.get_blocks_grid_for_write(op.blocks, world_box, 0);
 
 	// We can use floats by doing the operation in local space
 	const Vector3i origin_in_voxels = op.blocks.get_origin_block_position_in_voxels();
@@ -152,9 +162,10 @@ void VoxelToolLodTerrain::do_hemisphere(Vector3 center, float radius, Vector3 fl
 	VoxelData &data = _terrain->get_storage();
 
 	data.pre_generate_box(op.box);
+	_pre_edit(op.box);
 
 	VoxelDataGrid grid;
-	data.get_blocks_grid(grid, op.box, 0);
+	data.get_blocks_grid_for_write(grid, op.box, 0);
 	op.block_access.grid = &grid;
 
 	{
@@ -167,9 +178,17 @@ void VoxelToolLodTerrain::do_hemisphere(Vector3 center, float radius, Vector3 fl
 
 void VoxelToolLodTerrain::do_path(Span<const Vector3> positions, Span<const float> radii) {
 	ZN_ASSERT_RETURN(_terrain != nullptr);
+	if (_try_add_path_to_brush_batch(positions, radii)) {
+		return;
+	}
 	do_path_chunked(_terrain->get_storage(), positions, radii, true);
 }
 
+void VoxelToolLodTerrain::_do_brush_batch(const ops::BrushBatch &batch) {
+	ZN_ASSERT_RETURN(_terrain != nullptr);
+	do_brush_batch_chunked(_terrain->get_storage(), batch, true);
+}
+
 template <typename Op_T>
 class VoxelToolAsyncEdit : public IThreadedTask {
 public:
@@ -186,7 +205,7 @@ public:
 		ZN_ASSERT(_data != nullptr);
 		// TODO May want to fail if not all blocks were found
 		// TODO Need to apply modifiers
-		_data->get_blocks_grid(_op.blocks, _op.box, 0);
+		_data->get_blocks_grid_for_write(_op.blocks, _op.box, 0);
 		_op();
 		_tracker->post_complete();
 	}
@@ -253,6 +272,7 @@ void VoxelToolLodTerrain::paste(Vector3i pos, const VoxelBuffer &src, uint8_t ch
 	VoxelData &data = _terrain->get_storage();
 
 	data.pre_generate_box(box);
+	_pre_edit(box);
 	data.paste(pos, src, channels_mask, false, true);
 
 	_post_edit(box);
@@ -275,17 +295,8 @@ float VoxelToolLodTerrain::get_voxel_f_interpolated(Vector3 position) const {
 	ZN_PROFILE_SCOPE();
 	ERR_FAIL_COND_V(_terrain == nullptr, 0);
 	const int channel = get_channel();
-	VoxelData &data = _terrain->get_storage();
-	// TODO Optimization: is it worth making a fast-path for this?
-	return get_sdf_interpolated(
-			[&data, channel](Vector3i ipos) {
-				VoxelSingleValue defval;
-				defval.f = constants::SDF_FAR_OUTSIDE;
-				VoxelSingleValue value = data.get_voxel(ipos, channel, defval);
-				return value.f;
-			},
-			position
-	);
+	const VoxelData &data = _terrain->get_storage();
+	return get_sdf_interpolated(data, channel, position);
 }
 
 uint64_t VoxelToolLodTerrain::_get_voxel(Vector3i pos) const {
@@ -315,11 +326,54 @@ void VoxelToolLodTerrain::_set_voxel_f(Vector3i pos, float v) {
 	// No post_update, the parent class does it, it's a generic slow implementation.
 }
 
+void VoxelToolLodTerrain::_pre_edit(const Box3i &box) {
+	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().begin_edit_recording(box, _edit_recording);
+}
+
 void VoxelToolLodTerrain::_post_edit(const Box3i &box) {
 	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().end_edit_recording(_edit_recording);
 	_terrain->post_edit_area(box, true);
 }
 
+void VoxelToolLodTerrain::_pre_edit_boxes(Span<const Box3i> boxes) {
+	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().begin_edit_recording(boxes, _edit_recording);
+}
+
+void VoxelToolLodTerrain::_post_edit_boxes(Span<const Box3i> boxes) {
+	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().end_edit_recording(_edit_recording);
+	for (const Box3i &box : boxes) {
+		_terrain->post_edit_area(box, true);
+	}
+}
+
+bool VoxelToolLodTerrain::undo() {
+	ERR_FAIL_COND_V(_terrain == nullptr, false);
+	StdVector<Box3i> boxes;
+	if (!_terrain->get_storage().undo_edit(boxes)) {
+		return false;
+	}
+	for (const Box3i &box : boxes) {
+		_terrain->post_edit_area(box, true);
+	}
+	return true;
+}
+
+bool VoxelToolLodTerrain::redo() {
+	ERR_FAIL_COND_V(_terrain == nullptr, false);
+	StdVector<Box3i> boxes;
+	if (!_terrain->get_storage().redo_edit(boxes)) {
+		return false;
+	}
+	for (const Box3i &box : boxes) {
+		_terrain->post_edit_area(box, true);
+	}
+	return true;
+}
+
 int VoxelToolLodTerrain::get_raycast_binary_search_iterations() const {
 	return _raycast_binary_search_iterations;
 }
@@ -345,6 +399,29 @@ Array VoxelToolLodTerrain::separate_floating_chunks(AABB world_box, Object *pare
 	);
 }
 
+#if defined(ZN_GODOT)
+void VoxelToolLodTerrain::separate_floating_chunks_async(AABB world_box, Node *parent_node, const Callable &callback) {
+#elif defined(ZN_GODOT_EXTENSION)
+void VoxelToolLodTerrain::separate_floating_chunks_async(
+		AABB world_box,
+		Object *parent_node_o,
+		const Callable &callback
+) {
+	Node *parent_node = Object::cast_to<Node>(parent_node_o);
+#endif
+	ERR_FAIL_COND(_terrain == nullptr);
+	ERR_FAIL_COND(!math::is_valid_size(world_box.size));
+	ERR_FAIL_COND(parent_node == nullptr);
+	Ref<VoxelMesher> mesher = _terrain->get_mesher();
+	ERR_FAIL_COND(mesher.is_null());
+	Array materials;
+	materials.append(_terrain->get_material());
+	const Box3i int_world_box(math::floor_to_int(world_box.position), math::ceil_to_int(world_box.size));
+	zylann::voxel::separate_floating_chunks_async(
+			_terrain->get_storage_shared(), int_world_box, _terrain, parent_node, mesher, materials, callback
+	);
+}
+
 #ifdef VOXEL_ENABLE_MESH_SDF
 
 // Combines a precalculated SDF with the terrain at a specific position, rotation and scale.
@@ -413,8 +490,10 @@ void VoxelToolLodTerrain::stamp_sdf(
 	// buffer.decompress_channel(channel);
 	ZN_ASSERT_RETURN(buffer.get_channel_data_read_only(channel, op.shape.buffer));
 
+	_pre_edit(voxel_box);
+
 	VoxelDataGrid grid;
-	data.get_blocks_grid(grid, voxel_box, 0);
+	data.get_blocks_grid_for_write(grid, voxel_box, 0);
 	grid.write_box(voxel_box, VoxelBuffer::CHANNEL_SDF, op);
 
 	_post_edit(voxel_box);
@@ -545,6 +624,7 @@ void VoxelToolLodTerrain::do_graph(Ref<VoxelGeneratorGraph> graph, Transform3D t
 
 	scale_and_store_sdf(buffer, in_sdf_full);
 
+	_pre_edit(box);
 	data.paste(box.position, buffer, 1 << channel_index, false, false);
 
 	_post_edit(box);
@@ -599,6 +679,10 @@ void VoxelToolLodTerrain::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_raycast_binary_search_iterations"), &Self::get_raycast_binary_search_iterations);
 	ClassDB::bind_method(D_METHOD("get_voxel_f_interpolated", "position"), &Self::get_voxel_f_interpolated);
 	ClassDB::bind_method(D_METHOD("separate_floating_chunks", "box", "parent_node"), &Self::separate_floating_chunks);
+	ClassDB::bind_method(
+			D_METHOD("separate_floating_chunks_async", "box", "parent_node", "callback"),
+			&Self::separate_floating_chunks_async
+	);
 	ClassDB::bind_method(D_METHOD("do_sphere_async", "center", "radius"), &Self::do_sphere_async);
 #ifdef VOXEL_ENABLE_MESH_SDF
 	ClassDB::bind_method(D_METHOD("stamp_sdf", "mesh_sdf", "transform", "isolevel", "sdf_scale"), &Self::stamp_sdf);
@@ -1,6 +1,7 @@
 #ifndef VOXEL_TOOL_LOD_TERRAIN_H
 #define VOXEL_TOOL_LOD_TERRAIN_H
 
+#include "../storage/voxel_edit_journal.h"
 #include "../util/godot/core/random_pcg.h"
 #include "../util/macros.h"
 #include "voxel_tool.h"
@@ -49,8 +50,10 @@ public:
 	// TODO GDX: it seems binding a method taking a `Node*` fails to compile. It is supposed to be working.
 #if defined(ZN_GODOT)
 	Array separate_floating_chunks(AABB world_box, Node *parent_node);
+	void separate_floating_chunks_async(AABB world_box, Node *parent_node, const Callable &callback);
 #elif defined(ZN_GODOT_EXTENSION)
 	Array separate_floating_chunks(AABB world_box, Object *parent_node_o);
+	void separate_floating_chunks_async(AABB world_box, Object *parent_node_o, const Callable &callback);
 #endif
 
 #ifdef VOXEL_ENABLE_MESH_SDF
@@ -69,12 +72,19 @@ public:
 
 	VoxelFormat get_format() const override;
 
+	bool undo() override;
+	bool redo() override;
+
 protected:
 	uint64_t _get_voxel(Vector3i pos) const override;
 	float _get_voxel_f(Vector3i pos) const override;
 	void _set_voxel(Vector3i pos, uint64_t v) override;
 	void _set_voxel_f(Vector3i pos, float v) override;
+	void _pre_edit(const Box3i &box) override;
 	void _post_edit(const Box3i &box) override;
+	void _pre_edit_boxes(Span<const Box3i> boxes) override;
+	void _post_edit_boxes(Span<const Box3i> boxes) override;
+	void _do_brush_batch(const ops::BrushBatch &batch) override;
 
 private:
 	static void _bind_methods();
@@ -82,6 +92,7 @@ private:
 	VoxelLodTerrain *_terrain = nullptr;
 	int _raycast_binary_search_iterations = 0;
 	RandomPCG _random;
+	VoxelEditJournal::Recording _edit_recording;
 };
 
 } // namespace zylann::voxel
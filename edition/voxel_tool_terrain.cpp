@@ -5,10 +5,14 @@
 #include "../storage/voxel_buffer_gd.h"
 #include "../storage/voxel_data.h"
 #include "../terrain/fixed_lod/voxel_terrain.h"
+#include "../terrain/voxel_save_completion_tracker.h"
 #include "../util/godot/classes/ref_counted.h"
 #include "../util/godot/core/array.h"
 #include "../util/godot/core/packed_arrays.h"
 #include "../util/math/conv.h"
+#include "../util/tasks/async_dependency_tracker.h"
+#include "../util/tasks/threaded_task.h"
+#include "funcs.h"
 #include "raycast.h"
 
 using namespace zylann::godot;
@@ -66,8 +70,10 @@ void VoxelToolTerrain::paste(Vector3i pos, const VoxelBuffer &src, uint8_t chann
 	if (channels_mask == 0) {
 		channels_mask = (1 << _channel);
 	}
+	const Box3i box(pos, src.get_size());
+	_pre_edit(box);
 	_terrain->get_storage().paste(pos, src, channels_mask, false, true);
-	_post_edit(Box3i(pos, src.get_size()));
+	_post_edit(box);
 }
 
 void VoxelToolTerrain::paste_masked(
@@ -82,8 +88,10 @@ void VoxelToolTerrain::paste_masked(
 	if (channels_mask == 0) {
 		channels_mask = (1 << _channel);
 	}
+	const Box3i box(pos, p_voxels->get_buffer().get_size());
+	_pre_edit(box);
 	_terrain->get_storage().paste_masked(pos, p_voxels->get_buffer(), channels_mask, mask_channel, mask_value, false);
-	_post_edit(Box3i(pos, p_voxels->get_buffer().get_size()));
+	_post_edit(box);
 }
 
 void VoxelToolTerrain::paste_masked_writable_list(
@@ -100,6 +108,8 @@ void VoxelToolTerrain::paste_masked_writable_list(
 	if (channels_mask == 0) {
 		channels_mask = (1 << _channel);
 	}
+	const Box3i box(pos, p_voxels->get_buffer().get_size());
+	_pre_edit(box);
 	_terrain->get_storage().paste_masked_writable_list(
 			pos,
 			p_voxels->get_buffer(),
@@ -110,13 +120,17 @@ void VoxelToolTerrain::paste_masked_writable_list(
 			to_span(dst_writable_list),
 			false
 	);
-	_post_edit(Box3i(pos, p_voxels->get_buffer().get_size()));
+	_post_edit(box);
 }
 
 void VoxelToolTerrain::do_box(Vector3i begin, Vector3i end) {
 	ZN_PROFILE_SCOPE();
 	ERR_FAIL_COND(_terrain == nullptr);
 
+	if (_try_add_box_to_brush_batch(begin, end)) {
+		return;
+	}
+
 	if (get_channel() != VoxelBuffer::CHANNEL_SDF) {
 		// Fallback on generic do_box, which pretty much does a naive fill in the exact boundaries, though it's still
 		// slower than necessary because it uses random access.
@@ -141,10 +155,12 @@ void VoxelToolTerrain::do_box(Vector3i begin, Vector3i end) {
 		return;
 	}
 
+	_pre_edit(op.box);
+
 	VoxelData &data = _terrain->get_storage();
 
 	VoxelDataGrid grid;
-	data.get_blocks_grid(grid, op.box, 0);
+	data.get_blocks_grid_for_write(grid, op.box, 0);
 	op.block_access.grid = &grid;
 
 	{
@@ -159,6 +175,10 @@ void VoxelToolTerrain::do_sphere(Vector3 center, float radius) {
 	ZN_PROFILE_SCOPE();
 	ERR_FAIL_COND(_terrain == nullptr);
 
+	if (_try_add_sphere_to_brush_batch(center, radius)) {
+		return;
+	}
+
 	ops::DoSphere op;
 	op.shape.center = to_vec3f(center);
 	op.shape.radius = radius;
@@ -175,14 +195,128 @@ void VoxelToolTerrain::do_sphere(Vector3 center, float radius) {
 		return;
 	}
 
+	_pre_edit(op.box);
+
 	VoxelData &data = _terrain->get_storage();
 
-	data.get_blocks_grid(op.blocks, op.box, 0);
+	data.get_blocks_grid_for_write(op.blocks, op.box, 0);
 	op();
 
 	_post_edit(op.box);
 }
 
+namespace {
+
+struct AsyncSphereOp {
+	ops::DoSphere op;
+
+	void operator()(VoxelData &data) {
+		data.get_blocks_grid_for_write(op.blocks, op.box, 0);
+		op();
+	}
+};
+
+struct AsyncPasteOp {
+	Vector3i position;
+	std::shared_ptr<VoxelBuffer> voxels;
+	uint8_t channels_mask;
+
+	void operator()(VoxelData &data) {
+		data.paste(position, *voxels, channels_mask, false, true);
+	}
+};
+
+template <typename Op_T>
+class VoxelToolTerrainAsyncEdit : public IThreadedTask {
+public:
+	VoxelToolTerrainAsyncEdit(Op_T op, std::shared_ptr<VoxelData> data) : _op(op), _data(data) {
+		_tracker = make_shared_instance<AsyncDependencyTracker>(1);
+	}
+
+	const char *get_debug_name() const override {
+		return "VoxelToolTerrainAsyncEdit";
+	}
+
+	void run(ThreadedTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		ZN_ASSERT(_data != nullptr);
+		// Voxel access goes through spatial locks, so it doesn't race with other tasks or the main thread. Edits
+		// touching the same area are not scheduled at the same time, so they complete in the order they were made.
+		_op(*_data);
+		_tracker->post_complete();
+	}
+
+	std::shared_ptr<AsyncDependencyTracker> get_tracker() {
+		return _tracker;
+	}
+
+private:
+	Op_T _op;
+	// We reference this just to keep map pointers alive
+	std::shared_ptr<VoxelData> _data;
+	std::shared_ptr<AsyncDependencyTracker> _tracker;
+};
+
+template <typename Op_T>
+Ref<VoxelSaveCompletionTracker> push_async_edit(VoxelTerrain &terrain, Op_T op, Box3i box) {
+	VoxelToolTerrainAsyncEdit<Op_T> *task = ZN_NEW(VoxelToolTerrainAsyncEdit<Op_T>(op, terrain.get_storage_shared()));
+	std::shared_ptr<AsyncDependencyTracker> tracker = task->get_tracker();
+	terrain.push_async_edit(task, box, tracker);
+	return VoxelSaveCompletionTracker::create(tracker);
+}
+
+} // namespace
+
+Ref<VoxelSaveCompletionTracker> VoxelToolTerrain::do_sphere_async(Vector3 center, float radius) {
+	ZN_PROFILE_SCOPE();
+	ERR_FAIL_COND_V(_terrain == nullptr, Ref<VoxelSaveCompletionTracker>());
+
+	AsyncSphereOp async_op;
+	ops::DoSphere &op = async_op.op;
+	op.shape.center = to_vec3f(center);
+	op.shape.radius = radius;
+	op.shape.sdf_scale = get_sdf_scale();
+	op.box = op.shape.get_box().clipped(_terrain->get_bounds());
+	op.mode = ops::Mode(get_mode());
+	op.texture_params = _texture_params;
+	op.blocky_value = _value;
+	op.channel = get_channel();
+	op.strength = get_sdf_strength();
+
+	if (!is_area_editable(op.box)) {
+		ZN_PRINT_WARNING("Area not editable");
+		return Ref<VoxelSaveCompletionTracker>();
+	}
+
+	return push_async_edit(*_terrain, async_op, op.box);
+}
+
+Ref<VoxelSaveCompletionTracker> VoxelToolTerrain::paste_async(
+		Vector3i pos,
+		Ref<godot::VoxelBuffer> p_voxels,
+		int channels_mask
+) {
+	ZN_PROFILE_SCOPE();
+	ERR_FAIL_COND_V(_terrain == nullptr, Ref<VoxelSaveCompletionTracker>());
+	ERR_FAIL_COND_V(p_voxels.is_null(), Ref<VoxelSaveCompletionTracker>());
+
+	const VoxelBuffer &src = p_voxels->get_buffer();
+	const Box3i box(pos, src.get_size());
+	if (!is_area_editable(box)) {
+		ZN_PRINT_WARNING("Area not editable");
+		return Ref<VoxelSaveCompletionTracker>();
+	}
+
+	AsyncPasteOp op;
+	op.position = pos;
+	op.channels_mask = channels_mask == 0 ? (1 << _channel) : channels_mask;
+	// Copied so the script can keep modifying its buffer while the task runs
+	op.voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
+	src.copy_to(*op.voxels, true);
+
+	return push_async_edit(*_terrain, op, box);
+}
+
 void VoxelToolTerrain::do_hemisphere(Vector3 center, float radius, Vector3 flat_direction, float smoothness) {
 	ZN_PROFILE_SCOPE();
 	ERR_FAIL_COND(_terrain == nullptr);
@@ -206,10 +340,12 @@ void VoxelToolTerrain::do_hemisphere(Vector3 center, float radius, Vector3 flat_
 		return;
 	}
 
+	_pre_edit(op.box);
+
 	VoxelData &data = _terrain->get_storage();
 
 	VoxelDataGrid grid;
-	data.get_blocks_grid(grid, op.box, 0);
+	data.get_blocks_grid_for_write(grid, op.box, 0);
 	op.block_access.grid = &grid;
 
 	{
@@ -232,6 +368,11 @@ float VoxelToolTerrain::_get_voxel_f(Vector3i pos) const {
 	return _terrain->get_storage().get_voxel_f(pos, _channel);
 }
 
+float VoxelToolTerrain::get_voxel_f_interpolated(Vector3 position) const {
+	ERR_FAIL_COND_V(_terrain == nullptr, 0);
+	return get_sdf_interpolated(_terrain->get_storage(), _channel, position);
+}
+
 void VoxelToolTerrain::_set_voxel(Vector3i pos, uint64_t v) {
 	ERR_FAIL_COND(_terrain == nullptr);
 	_terrain->get_storage().try_set_voxel(v, pos, _channel);
@@ -242,11 +383,54 @@ void VoxelToolTerrain::_set_voxel_f(Vector3i pos, float v) {
 	_terrain->get_storage().try_set_voxel_f(v, pos, _channel);
 }
 
+void VoxelToolTerrain::_pre_edit(const Box3i &box) {
+	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().begin_edit_recording(box, _edit_recording);
+}
+
 void VoxelToolTerrain::_post_edit(const Box3i &box) {
 	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().end_edit_recording(_edit_recording);
 	_terrain->post_edit_area(box, true);
 }
 
+void VoxelToolTerrain::_pre_edit_boxes(Span<const Box3i> boxes) {
+	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().begin_edit_recording(boxes, _edit_recording);
+}
+
+void VoxelToolTerrain::_post_edit_boxes(Span<const Box3i> boxes) {
+	ERR_FAIL_COND(_terrain == nullptr);
+	_terrain->get_storage().end_edit_recording(_edit_recording);
+	for (const Box3i &box : boxes) {
+		_terrain->post_edit_area(box, true);
+	}
+}
+
+bool VoxelToolTerrain::undo() {
+	ERR_FAIL_COND_V(_terrain == nullptr, false);
+	StdVector<Box3i> boxes;
+	if (!_terrain->get_storage().undo_edit(boxes)) {
+		return false;
+	}
+	for (const Box3i &box : boxes) {
+		_terrain->post_edit_area(box, true);
+	}
+	return true;
+}
+
+bool VoxelToolTerrain::redo() {
+	ERR_FAIL_COND_V(_terrain == nullptr, false);
+	StdVector<Box3i> boxes;
+	if (!_terrain->get_storage().redo_edit(boxes)) {
+		return false;
+	}
+	for (const Box3i &box : boxes) {
+		_terrain->post_edit_area(box, true);
+	}
+	return true;
+}
+
 void VoxelToolTerrain::set_voxel_metadata(const Vector3i pos, const Variant &meta) {
 	ERR_FAIL_COND(_terrain == nullptr);
 	VoxelData &data = _terrain->get_storage();
@@ -318,7 +502,8 @@ void VoxelToolTerrain::for_each_voxel_metadata_in_area(AABB voxel_area, const Ca
 	VoxelData &data = _terrain->get_storage();
 
 	data_block_box.for_each_cell([&data, &callback, voxel_box](Vector3i block_pos) {
-		std::shared_ptr<VoxelBuffer> voxels_ptr = data.try_get_block_voxels(block_pos);
+		// Metadata can contain reference types the callback may modify, so they must not be shared with saves
+		std::shared_ptr<VoxelBuffer> voxels_ptr = data.try_get_block_voxels_for_write(block_pos);
 
 		if (voxels_ptr == nullptr) {
 			return;
@@ -356,9 +541,17 @@ void VoxelToolTerrain::for_each_voxel_metadata_in_area(AABB voxel_area, const Ca
 
 void VoxelToolTerrain::do_path(Span<const Vector3> positions, Span<const float> radii) {
 	ZN_ASSERT_RETURN(_terrain != nullptr);
+	if (_try_add_path_to_brush_batch(positions, radii)) {
+		return;
+	}
 	do_path_chunked(_terrain->get_storage(), positions, radii, false);
 }
 
+void VoxelToolTerrain::_do_brush_batch(const ops::BrushBatch &batch) {
+	ZN_ASSERT_RETURN(_terrain != nullptr);
+	do_brush_batch_chunked(_terrain->get_storage(), batch, false);
+}
+
 #ifdef VOXEL_ENABLE_MESH_SDF
 void VoxelToolTerrain::do_mesh(const VoxelMeshSDF &mesh_sdf, const Transform3D &transform, const float isolevel) {
 	ZN_ASSERT_RETURN(_terrain != nullptr);
@@ -387,6 +580,10 @@ void VoxelToolTerrain::_bind_methods() {
 			&VoxelToolTerrain::do_hemisphere,
 			DEFVAL(0.0)
 	);
+	ClassDB::bind_method(D_METHOD("do_sphere_async", "center", "radius"), &VoxelToolTerrain::do_sphere_async);
+	ClassDB::bind_method(
+			D_METHOD("paste_async", "dst_pos", "src_buffer", "channels_mask"), &VoxelToolTerrain::paste_async
+	);
 }
 
 } // namespace zylann::voxel
@@ -1,6 +1,7 @@
 #ifndef VOXEL_TOOL_TERRAIN_H
 #define VOXEL_TOOL_TERRAIN_H
 
+#include "../storage/voxel_edit_journal.h"
 #include "../util/godot/core/random_pcg.h"
 #include "voxel_tool.h"
 
@@ -9,6 +10,7 @@ namespace zylann::voxel {
 class VoxelTerrain;
 class VoxelBlockyLibraryBase;
 class VoxelData;
+class VoxelSaveCompletionTracker;
 
 class VoxelToolTerrain : public VoxelTool {
 	GDCLASS(VoxelToolTerrain, VoxelTool)
@@ -27,6 +29,8 @@ public:
 	void set_voxel_metadata(const Vector3i pos, const Variant &meta) override;
 	Variant get_voxel_metadata(const Vector3i pos) const override;
 
+	float get_voxel_f_interpolated(Vector3 position) const override;
+
 	void copy(
 			const Vector3i pos,
 			VoxelBuffer &dst,
@@ -65,6 +69,10 @@ public:
 
 	void do_hemisphere(Vector3 center, float radius, Vector3 flat_direction, float smoothness);
 
+	// Edits running on a worker thread. Changes become visible once the returned tracker completes.
+	Ref<VoxelSaveCompletionTracker> do_sphere_async(Vector3 center, float radius);
+	Ref<VoxelSaveCompletionTracker> paste_async(Vector3i pos, Ref<godot::VoxelBuffer> p_voxels, int channels_mask);
+
 	void run_blocky_random_tick(
 			const AABB voxel_area,
 			const int voxel_count,
@@ -77,18 +85,26 @@ public:
 
 	VoxelFormat get_format() const override;
 
+	bool undo() override;
+	bool redo() override;
+
 protected:
 	uint64_t _get_voxel(Vector3i pos) const override;
 	float _get_voxel_f(Vector3i pos) const override;
 	void _set_voxel(Vector3i pos, uint64_t v) override;
 	void _set_voxel_f(Vector3i pos, float v) override;
+	void _pre_edit(const Box3i &box) override;
 	void _post_edit(const Box3i &box) override;
+	void _pre_edit_boxes(Span<const Box3i> boxes) override;
+	void _post_edit_boxes(Span<const Box3i> boxes) override;
+	void _do_brush_batch(const ops::BrushBatch &batch) override;
 
 private:
 	static void _bind_methods();
 
 	VoxelTerrain *_terrain = nullptr;
 	RandomPCG _random;
+	VoxelEditJournal::Recording _edit_recording;
 };
 
 } // namespace zylann::voxel
@@ -2,6 +2,7 @@
 #define VOXEL_MESHING_DEPENDENCY_H
 
 #include "../generators/voxel_generator.h"
+#include "../meshers/mesh_block_cache.h"
 #include "../meshers/voxel_mesher.h"
 #include "../util/memory/memory.h"
 
@@ -14,15 +15,21 @@ namespace zylann::voxel {
 struct MeshingDependency {
 	Ref<VoxelMesher> mesher;
 	Ref<VoxelGenerator> generator;
+	// Results built with the mesher and generator above. Disabled if its capacity is 0.
+	MeshBlockCache mesh_cache;
 	bool valid = true;
 
 	static void reset(std::shared_ptr<MeshingDependency> &ref, Ref<VoxelMesher> mesher, Ref<VoxelGenerator> generator) {
+		size_t mesh_cache_capacity = 0;
 		if (ref != nullptr) {
 			ref->valid = false;
+			// Cached results are not carried over, since they may no longer match what the mesher would produce
+			mesh_cache_capacity = ref->mesh_cache.get_capacity();
 		}
 		ref = make_shared_instance<MeshingDependency>();
 		ref->mesher = mesher;
 		ref->generator = generator;
+		ref->mesh_cache.set_capacity(mesh_cache_capacity);
 		ref->valid = true;
 	}
 };
@@ -5,6 +5,7 @@
 #include "../streams/load_all_blocks_data_task.h"
 #include "../streams/load_block_data_task.h"
 #include "../streams/save_block_data_task.h"
+#include "../streams/stream_metrics.h"
 #include "../util/godot/classes/os.h"
 #include "../util/godot/classes/project_settings.h"
 #include "../util/godot/classes/rd_sampler_state.h"
@@ -12,7 +13,9 @@
 #include "../util/io/log.h"
 #include "../util/macros.h"
 #include "../util/math/conv.h"
+#include "../util/memory/linear_allocator.h"
 #include "../util/profiling.h"
+#include "../util/profiling_clock.h"
 #include "../util/string/format.h"
 
 namespace zylann::voxel {
@@ -261,6 +264,18 @@ void VoxelEngine::set_main_thread_time_budget_usec(unsigned int usec) {
 	_main_thread_time_budget_usec = usec;
 }
 
+uint32_t VoxelEngine::get_shared_mesh_apply_budget_usec() const {
+	return _shared_mesh_apply_budget_usec;
+}
+
+void VoxelEngine::consume_shared_mesh_apply_budget_usec(uint32_t usec) {
+	_shared_mesh_apply_budget_usec -= math::min(usec, _shared_mesh_apply_budget_usec);
+}
+
+void VoxelEngine::add_main_thread_volume_time_usec(uint32_t usec) {
+	_main_thread_volumes_usec += usec;
+}
+
 bool VoxelEngine::is_threaded_graphics_resource_building_enabled() const {
 	return _threaded_graphics_resource_building_enabled;
 }
@@ -277,6 +292,17 @@ void VoxelEngine::push_async_tasks(Span<zylann::IThreadedTask *> tasks) {
 	_general_thread_pool.enqueue(tasks, false);
 }
 
+TaskScheduler VoxelEngine::get_task_scheduler() {
+	TaskScheduler scheduler;
+	scheduler.push_tasks = [](Span<IThreadedTask *> tasks) { //
+		VoxelEngine::get_singleton().push_async_tasks(tasks);
+	};
+	scheduler.get_thread_count = []() -> unsigned int { //
+		return VoxelEngine::get_singleton().get_thread_count();
+	};
+	return scheduler;
+}
+
 void VoxelEngine::push_async_io_task(zylann::IThreadedTask *task) {
 	// I/O tasks run in serial because they usually can't run well in parallel due to locking shared resources.
 	_general_thread_pool.enqueue(task, true);
@@ -308,6 +334,8 @@ void VoxelEngine::process() {
 			int64_t(StdDefaultAllocatorCounters::g_allocated - StdDefaultAllocatorCounters::g_deallocated)
 	);
 
+	ProfilingClock main_thread_clock;
+
 	// Receive generation and meshing results
 	_general_thread_pool.dequeue_completed_tasks([](zylann::IThreadedTask *task) {
 		task->apply_result();
@@ -320,9 +348,20 @@ void VoxelEngine::process() {
 
 	_progressive_task_runner.process();
 
+	// Volumes may process before or after this, but in any case they share one budget per frame
+	_shared_mesh_apply_budget_usec = _main_thread_time_budget_usec;
+
+	// Volumes processing after this in the same frame are counted in the next one
+	_main_thread_last_frame_usec = main_thread_clock.get_elapsed_microseconds() + _main_thread_volumes_usec;
+	_main_thread_volumes_usec = 0;
+	_main_thread_frame_time.add(_main_thread_last_frame_usec);
+
 	// Update viewer dependencies
 	sync_viewers_task_priority_data();
 
+	// Main thread functions may use temporary memory too, don't keep big allocations forever
+	get_tls_temp_allocator().trim();
+
 #ifdef VOXEL_ENABLE_GPU
 	ZN_PROFILE_PLOT("Pending GPU tasks", int64_t(_gpu_task_runner.get_pending_task_count()));
 #endif
@@ -391,6 +430,41 @@ VoxelEngine::Stats::ThreadPoolStats debug_get_pool_stats(const zylann::ThreadedT
 	return d;
 }
 
+void get_task_type_stats(const TaskMetrics &metrics, StdVector<VoxelEngine::Stats::TaskTypeStats> &out_stats) {
+	const unsigned int count = metrics.get_task_type_count();
+	for (unsigned int i = 0; i < count; ++i) {
+		const TaskMetrics::TaskType &task_type = metrics.get_task_type(i);
+		VoxelEngine::Stats::TaskTypeStats s;
+		s.name = task_type.name;
+		s.queue_wait = task_type.queue_wait.get_snapshot();
+		s.run = task_type.run.get_snapshot();
+		s.completed = task_type.completed_count.load(std::memory_order_relaxed);
+		s.cancelled = task_type.cancelled_count.load(std::memory_order_relaxed);
+		s.postponed = task_type.postponed_count.load(std::memory_order_relaxed);
+		out_stats.push_back(s);
+	}
+}
+
+void get_stream_stats(StdVector<VoxelEngine::Stats::StreamStats> &out_stats) {
+	const StreamMetricsRegistry &registry = StreamMetricsRegistry::get_singleton();
+	const unsigned int count = registry.get_count();
+	for (unsigned int i = 0; i < count; ++i) {
+		const StreamMetrics &metrics = registry.get_metrics(i);
+		VoxelEngine::Stats::StreamStats s;
+		s.name = registry.get_name(i);
+		s.load_latency = metrics.load_latency.get_snapshot();
+		s.save_latency = metrics.save_latency.get_snapshot();
+		s.flush_latency = metrics.flush_latency.get_snapshot();
+		s.loaded_blocks = metrics.loaded_blocks.load(std::memory_order_relaxed);
+		s.not_found_blocks = metrics.not_found_blocks.load(std::memory_order_relaxed);
+		s.saved_blocks = metrics.saved_blocks.load(std::memory_order_relaxed);
+		s.errors = metrics.errors.load(std::memory_order_relaxed);
+		s.loaded_bytes = metrics.loaded_bytes.load(std::memory_order_relaxed);
+		s.saved_bytes = metrics.saved_bytes.load(std::memory_order_relaxed);
+		out_stats.push_back(s);
+	}
+}
+
 } // namespace
 
 VoxelEngine::Stats VoxelEngine::get_stats() const {
@@ -403,6 +477,10 @@ VoxelEngine::Stats VoxelEngine::get_stats() const {
 #ifdef VOXEL_ENABLE_GPU
 	s.gpu_tasks = _gpu_task_runner.get_pending_task_count();
 #endif
+	get_task_type_stats(_general_thread_pool.get_metrics(), s.task_types);
+	get_stream_stats(s.streams);
+	s.main_thread_frame = _main_thread_frame_time.get_snapshot();
+	s.main_thread_last_frame_usec = _main_thread_last_frame_usec;
 	return s;
 }
 
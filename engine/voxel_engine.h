@@ -8,7 +8,9 @@
 #include "../util/io/file_locker.h"
 #include "../util/memory/memory.h"
 #include "../util/string/std_string.h"
+#include "../util/tasks/parallel_jobs.h"
 #include "../util/tasks/progressive_task_runner.h"
+#include "../util/tasks/task_metrics.h"
 #include "../util/tasks/threaded_task_runner.h"
 #include "../util/tasks/time_spread_task_runner.h"
 #include "ids.h"
@@ -206,6 +208,17 @@ public:
 	int get_main_thread_time_budget_usec() const;
 	void set_main_thread_time_budget_usec(unsigned int usec);
 
+	// Time left in the current frame for volumes applying meshes without a budget of their own. It is shared, so that
+	// having more volumes doesn't multiply the time spent on the main thread. Reset every frame to the main thread
+	// budget.
+	uint32_t get_shared_mesh_apply_budget_usec() const;
+	// Must be called by volumes after they applied meshes using the shared budget.
+	void consume_shared_mesh_apply_budget_usec(uint32_t usec);
+
+	// Volumes report the time they spent processing on the main thread, so it is counted in main thread metrics along
+	// with the time spent in `process`.
+	void add_main_thread_volume_time_usec(uint32_t usec);
+
 	// This should be fast and safe to access from multiple threads.
 	bool is_threaded_graphics_resource_building_enabled() const;
 	// void set_threaded_graphics_resource_building_enabled(bool enabled);
@@ -221,6 +234,9 @@ public:
 	// Thread-safe.
 	void push_async_io_tasks(Span<IThreadedTask *> tasks);
 
+	// Gets a scheduler pushing tasks with `push_async_tasks`, for code that must not depend on the engine.
+	static TaskScheduler get_task_scheduler();
+
 #ifdef VOXEL_ENABLE_GPU
 	void push_gpu_task(IGPUTask *task);
 
@@ -262,6 +278,28 @@ public:
 			FixedArray<const char *, ThreadedTaskRunner::MAX_THREADS> active_task_names;
 		};
 
+		struct TaskTypeStats {
+			const char *name;
+			DurationHistogram::Snapshot queue_wait;
+			DurationHistogram::Snapshot run;
+			uint64_t completed;
+			uint64_t cancelled;
+			uint64_t postponed;
+		};
+
+		struct StreamStats {
+			StdString name;
+			DurationHistogram::Snapshot load_latency;
+			DurationHistogram::Snapshot save_latency;
+			DurationHistogram::Snapshot flush_latency;
+			uint64_t loaded_blocks;
+			uint64_t not_found_blocks;
+			uint64_t saved_blocks;
+			uint64_t errors;
+			uint64_t loaded_bytes;
+			uint64_t saved_bytes;
+		};
+
 		ThreadPoolStats general;
 		int generation_tasks;
 		int streaming_tasks;
@@ -270,6 +308,13 @@ public:
 #ifdef VOXEL_ENABLE_GPU
 		int gpu_tasks;
 #endif
+
+		// Metrics accumulated since startup. They are always collected, unlike profiling.
+		StdVector<TaskTypeStats> task_types;
+		StdVector<StreamStats> streams;
+		// Time spent by the engine each frame on the main thread (applying results of tasks, time-spread tasks...)
+		DurationHistogram::Snapshot main_thread_frame;
+		uint64_t main_thread_last_frame_usec;
 	};
 
 	Stats get_stats() const;
@@ -340,6 +385,7 @@ private:
 	// For tasks that can only run on the main thread and be spread out over frames
 	TimeSpreadTaskRunner _time_spread_task_runner;
 	unsigned int _main_thread_time_budget_usec = DEFAULT_MAIN_THREAD_BUDGET_USEC;
+	uint32_t _shared_mesh_apply_budget_usec = DEFAULT_MAIN_THREAD_BUDGET_USEC;
 	ProgressiveTaskRunner _progressive_task_runner;
 
 	FileLocker _file_locker;
@@ -355,6 +401,11 @@ private:
 
 	// There can be multiple types of generation tasks, so we count them with a common counter.
 	std::atomic_int _debug_generate_block_task_count = { 0 };
+
+	DurationHistogram _main_thread_frame_time;
+	uint64_t _main_thread_last_frame_usec = 0;
+	// Reported by volumes since the last call to `process`
+	uint64_t _main_thread_volumes_usec = 0;
 };
 
 struct VoxelFileLockerRead {
@@ -12,9 +12,16 @@
 
 #ifdef VOXEL_TESTS
 #include "../tests/tests.h"
+#endif
+
+#if defined(VOXEL_TESTS) || defined(VOXEL_BENCHMARKS)
 #include "../util/testing/test_options.h"
 #endif
 
+#ifdef VOXEL_BENCHMARKS
+#include "../tests/benchmarks/benchmarks.h"
+#endif
+
 #ifdef ZN_GODOT
 #include "../util/godot/core/callable_mp.h"
 #endif
@@ -141,6 +148,55 @@ Dictionary to_dict(const zylann::voxel::VoxelEngine::Stats::ThreadPoolStats &sta
 	return d;
 }
 
+Dictionary to_dict(const DurationHistogram::Snapshot &s) {
+	Dictionary d;
+	d["count"] = static_cast<int64_t>(s.count);
+	d["mean_usec"] = s.get_mean_usec();
+	d["p50_usec"] = static_cast<int64_t>(s.get_percentile_usec(0.5f));
+	d["p90_usec"] = static_cast<int64_t>(s.get_percentile_usec(0.9f));
+	d["p99_usec"] = static_cast<int64_t>(s.get_percentile_usec(0.99f));
+	d["max_usec"] = static_cast<int64_t>(s.max_usec);
+	return d;
+}
+
+Dictionary to_metrics_dict(const zylann::voxel::VoxelEngine::Stats &stats) {
+	Dictionary task_types;
+	for (const zylann::voxel::VoxelEngine::Stats::TaskTypeStats &tts : stats.task_types) {
+		Dictionary d;
+		d["queue_wait"] = to_dict(tts.queue_wait);
+		d["run"] = to_dict(tts.run);
+		d["completed"] = static_cast<int64_t>(tts.completed);
+		d["cancelled"] = static_cast<int64_t>(tts.cancelled);
+		d["postponed"] = static_cast<int64_t>(tts.postponed);
+		task_types[String(tts.name)] = d;
+	}
+
+	Dictionary streams;
+	for (const zylann::voxel::VoxelEngine::Stats::StreamStats &ss : stats.streams) {
+		Dictionary d;
+		d["load"] = to_dict(ss.load_latency);
+		d["save"] = to_dict(ss.save_latency);
+		d["flush"] = to_dict(ss.flush_latency);
+		d["loaded_blocks"] = static_cast<int64_t>(ss.loaded_blocks);
+		d["not_found_blocks"] = static_cast<int64_t>(ss.not_found_blocks);
+		d["saved_blocks"] = static_cast<int64_t>(ss.saved_blocks);
+		d["errors"] = static_cast<int64_t>(ss.errors);
+		d["loaded_bytes"] = static_cast<int64_t>(ss.loaded_bytes);
+		d["saved_bytes"] = static_cast<int64_t>(ss.saved_bytes);
+		streams[String(ss.name.c_str())] = d;
+	}
+
+	Dictionary main_thread;
+	main_thread["frame"] = to_dict(stats.main_thread_frame);
+	main_thread["last_frame_usec"] = static_cast<int64_t>(stats.main_thread_last_frame_usec);
+
+	Dictionary d;
+	d["task_types"] = task_types;
+	d["streams"] = streams;
+	d["main_thread"] = main_thread;
+	return d;
+}
+
 Dictionary to_dict(const zylann::voxel::VoxelEngine::Stats &stats) {
 	Dictionary pools;
 	pools["general"] = to_dict(stats.general);
@@ -175,14 +231,54 @@ Dictionary to_dict(const zylann::voxel::VoxelEngine::Stats &stats) {
 	d["thread_pools"] = pools;
 	d["tasks"] = tasks;
 	d["memory_pools"] = mem;
+	d["metrics"] = to_metrics_dict(stats);
 	return d;
 }
 
+void add_counters(Dictionary &counters, const String &prefix, const DurationHistogram::Snapshot &s) {
+	counters[prefix + ".count"] = static_cast<int64_t>(s.count);
+	counters[prefix + ".total_usec"] = static_cast<int64_t>(s.total_usec);
+}
+
 Dictionary VoxelEngine::get_stats() const {
 	ZN_PROFILE_SCOPE();
 	return to_dict(zylann::voxel::VoxelEngine::get_singleton().get_stats());
 }
 
+Dictionary VoxelEngine::get_metrics_counters() const {
+	ZN_PROFILE_SCOPE();
+	const zylann::voxel::VoxelEngine::Stats stats = zylann::voxel::VoxelEngine::get_singleton().get_stats();
+
+	// Flat and monotonic, so it can be forwarded as-is to monitoring systems, which compute rates themselves
+	Dictionary counters;
+
+	for (const zylann::voxel::VoxelEngine::Stats::TaskTypeStats &tts : stats.task_types) {
+		const String prefix = String("tasks.") + tts.name;
+		add_counters(counters, prefix + ".queue_wait", tts.queue_wait);
+		add_counters(counters, prefix + ".run", tts.run);
+		counters[prefix + ".completed"] = static_cast<int64_t>(tts.completed);
+		counters[prefix + ".cancelled"] = static_cast<int64_t>(tts.cancelled);
+		counters[prefix + ".postponed"] = static_cast<int64_t>(tts.postponed);
+	}
+
+	for (const zylann::voxel::VoxelEngine::Stats::StreamStats &ss : stats.streams) {
+		const String prefix = String("streams.") + ss.name.c_str();
+		add_counters(counters, prefix + ".load", ss.load_latency);
+		add_counters(counters, prefix + ".save", ss.save_latency);
+		add_counters(counters, prefix + ".flush", ss.flush_latency);
+		counters[prefix + ".loaded_blocks"] = static_cast<int64_t>(ss.loaded_blocks);
+		counters[prefix + ".not_found_blocks"] = static_cast<int64_t>(ss.not_found_blocks);
+		counters[prefix + ".saved_blocks"] = static_cast<int64_t>(ss.saved_blocks);
+		counters[prefix + ".errors"] = static_cast<int64_t>(ss.errors);
+		counters[prefix + ".loaded_bytes"] = static_cast<int64_t>(ss.loaded_bytes);
+		counters[prefix + ".saved_bytes"] = static_cast<int64_t>(ss.saved_bytes);
+	}
+
+	add_counters(counters, "main_thread.frame", stats.main_thread_frame);
+
+	return counters;
+}
+
 int VoxelEngine::get_thread_count() const {
 	return zylann::voxel::VoxelEngine::get_singleton().get_thread_count();
 }
@@ -233,6 +329,15 @@ void VoxelEngine::run_tests(Dictionary options_dict) {
 
 #endif
 
+#ifdef VOXEL_BENCHMARKS
+
+String VoxelEngine::run_benchmarks(Dictionary options_dict) {
+	zylann::testing::TestOptions options(options_dict);
+	return zylann::voxel::benchmarks::run_voxel_benchmarks(options);
+}
+
+#endif
+
 bool VoxelEngine::_b_get_threaded_graphics_resource_building_enabled() const {
 	const zylann::voxel::VoxelEngine &ve = zylann::voxel::VoxelEngine::get_singleton();
 	return ve.is_threaded_graphics_resource_building_enabled();
@@ -253,6 +358,7 @@ void VoxelEngine::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_version_status"), &VoxelEngine::get_version_status);
 	ClassDB::bind_method(D_METHOD("get_version_git_hash"), &VoxelEngine::get_version_git_hash);
 	ClassDB::bind_method(D_METHOD("get_stats"), &VoxelEngine::get_stats);
+	ClassDB::bind_method(D_METHOD("get_metrics_counters"), &VoxelEngine::get_metrics_counters);
 	ClassDB::bind_method(D_METHOD("get_thread_count"), &VoxelEngine::get_thread_count);
 	ClassDB::bind_method(D_METHOD("set_thread_count", "count"), &VoxelEngine::set_thread_count);
 
@@ -265,6 +371,10 @@ void VoxelEngine::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("run_tests", "options"), &VoxelEngine::run_tests);
 #endif
 
+#ifdef VOXEL_BENCHMARKS
+	ClassDB::bind_method(D_METHOD("run_benchmarks", "options"), &VoxelEngine::run_benchmarks);
+#endif
+
 	// ClassDB::bind_method(
 	// 		D_METHOD("set_threaded_graphics_resource_building_enabled", "enabled"),
 	// 		&VoxelEngine::_b_set_threaded_graphics_resource_building_enabled
@@ -36,6 +36,7 @@ public:
 	String get_version_git_hash() const;
 
 	Dictionary get_stats() const;
+	Dictionary get_metrics_counters() const;
 	void schedule_task(Ref<ZN_ThreadedTask> task);
 
 	int get_thread_count() const;
@@ -51,6 +52,10 @@ public:
 	void run_tests(Dictionary options_dict);
 #endif
 
+#ifdef VOXEL_BENCHMARKS
+	String run_benchmarks(Dictionary options_dict);
+#endif
+
 private:
 	void _on_rendering_server_frame_post_draw();
 
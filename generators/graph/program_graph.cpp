@@ -5,6 +5,7 @@
 #include "../../util/godot/classes/object.h"
 #include "../../util/godot/classes/resource.h"
 #include "../../util/godot/core/string.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/memory/memory.h"
 #include "../../util/string/format.h"
 #include <fstream>
@@ -278,8 +279,11 @@ void ProgramGraph::find_dependencies(uint32_t node_id, StdVector<uint32_t> &out_
 void ProgramGraph::find_dependencies(Span<const uint32_t> p_nodes_to_process, StdVector<uint32_t> &out_order) const {
 	StdUnorderedSet<uint32_t> visited_nodes;
 
-	// TODO Candidate for temp allocator
-	StdVector<uint32_t> nodes_to_process;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<uint32_t> nodes_to_process(temp_allocator);
+	// The stack can't get bigger than the graph, reserving avoids leaving unused storage behind when growing
+	nodes_to_process.reserve(get_nodes_count());
 	nodes_to_process.resize(p_nodes_to_process.size());
 	p_nodes_to_process.copy_to(to_span(nodes_to_process));
 
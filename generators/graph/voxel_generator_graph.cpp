@@ -13,6 +13,7 @@
 #include "../../util/io/log.h"
 #include "../../util/macros.h"
 #include "../../util/math/conv.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 #include "../../util/profiling_clock.h"
 #include "../../util/string/expression_parser.h"
@@ -1939,11 +1940,12 @@ void VoxelGeneratorGraph::generate_image_from_sdf(Ref<Image> image, const Transf
 			runtime_ptr->sdf_input_index == -1, "This function doesn't support graphs that have an SDF input."
 	);
 
-	StdVector<float> x_buffer;
-	StdVector<float> y_buffer;
-	StdVector<float> z_buffer;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<float> x_buffer(temp_allocator);
+	StdTempVector<float> y_buffer(temp_allocator);
+	StdTempVector<float> z_buffer(temp_allocator);
 
-	// TODO Candidate for temp allocator
 	x_buffer.resize(resolution.x);
 	y_buffer.resize(resolution.x);
 	z_buffer.resize(resolution.x);
@@ -75,6 +75,7 @@ void GenerateBlockMultipassCBTask::run(zylann::ThreadedTaskContext &ctx) {
 			}
 
 			column = &column_it->second;
+			column->last_access = ++map.access_counter;
 		}
 
 		if (column == nullptr) {
@@ -155,13 +156,25 @@ void GenerateBlockMultipassCBTask::run(zylann::ThreadedTaskContext &ctx) {
 
 			VoxelGeneratorMultipassCBStructs::Block &block = column->blocks[block_index];
 
-			// TODO Take out voxel data from this block to save memory, it must not be touched by generation anymore
-			// (if we do, we need to change the column's spatial lock to WRITE)
 			voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
-			voxels->create(block.voxels.get_size());
-			voxels->copy_format(block.voxels);
-			voxels->copy_channels_from(block.voxels);
-			voxels->copy_voxel_metadata(block.voxels);
+
+			if (column->spilled) {
+				// Read it directly from spilled data, the column doesn't need to come back in memory
+				if (!VoxelGeneratorMultipassCBStructs::load_spilled_block(
+							*multipass_generator_internal, column_position, *column, block_index, *voxels
+					)) {
+					// Drop
+					return;
+				}
+
+			} else {
+				// TODO Take out voxel data from this block to save memory, it must not be touched by generation
+				// anymore (if we do, we need to change the column's spatial lock to WRITE)
+				voxels->create(block.voxels.get_size());
+				voxels->copy_format(block.voxels);
+				voxels->copy_channels_from(block.voxels);
+				voxels->copy_voxel_metadata(block.voxels);
+			}
 
 			run_stream_saving_and_finish();
 		}
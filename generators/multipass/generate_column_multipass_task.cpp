@@ -54,6 +54,8 @@ GenerateColumnMultipassTask::GenerateColumnMultipassTask(
 	_caller_task = p_caller;
 	_caller_task_dependency_counter = p_caller_dependency_count;
 
+	++_generator_internal->map.column_task_count[_subpass_index];
+
 #ifdef ZN_PROFILER_ENABLED
 	int64_t v = ++g_task_count[_subpass_index];
 	ZN_PROFILE_PLOT(g_profiling_task_names[_subpass_index], v);
@@ -66,6 +68,8 @@ GenerateColumnMultipassTask::GenerateColumnMultipassTask(
 GenerateColumnMultipassTask::~GenerateColumnMultipassTask() {
 	ZN_ASSERT(_caller_task == nullptr);
 
+	--_generator_internal->map.column_task_count[_subpass_index];
+
 #ifdef ZN_PROFILER_ENABLED
 	int64_t v = --g_task_count[_subpass_index];
 	ZN_PROFILE_PLOT(g_profiling_task_names[_subpass_index], v);
@@ -80,11 +84,14 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 	ZN_PROFILE_SCOPE();
 	ZN_ASSERT(_generator.is_valid());
 
-	Map &map = _generator_internal->map;
+	// Keep a reference, because once the task is waiting, it can be resumed (and deleted) by another thread before
+	// this function returns
+	std::shared_ptr<Internal> generator_internal = _generator_internal;
+	Map &map = generator_internal->map;
 	BufferedTaskScheduler &task_scheduler = BufferedTaskScheduler::get_for_current_thread();
 
 	const int final_subpass_index =
-			VoxelGeneratorMultipassCB::get_subpass_count_from_pass_count(_generator_internal->passes.size()) - 1;
+			VoxelGeneratorMultipassCB::get_subpass_count_from_pass_count(generator_internal->passes.size()) - 1;
 
 	if (_cancelled) {
 		// At least one subtask was cancelled, therefore we have to cleanup and return too.
@@ -93,6 +100,7 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 		{
 			if (!map.spatial_lock.try_lock_write(BoxBounds2i::from_position(_column_position))) {
 				// Try later (funny situation, but that's the pattern)
+				++map.lock_postpone_total;
 				ctx.status = ThreadedTaskContext::STATUS_POSTPONED;
 				return;
 			}
@@ -106,6 +114,7 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 				// Unregister task from the column
 				Column &column = column_it->second;
 				column.pending_subpass_tasks_mask &= ~(1 << _subpass_index);
+				schedule_subpass_waiters(map, column, _subpass_index, task_scheduler);
 
 				if (_subpass_index == final_subpass_index) {
 					// Schedule pending block requests to make them handle cancellation
@@ -150,6 +159,7 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 		// SpatialLock3D::Write swlock(map->spatial_lock, neighbors_box);
 		if (!map.spatial_lock.try_lock_write(neighbors_box)) {
 			// Try later
+			++map.lock_postpone_total;
 			ctx.status = ThreadedTaskContext::STATUS_POSTPONED;
 			return;
 		}
@@ -163,12 +173,15 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 			// TODO We don't create new columns from here, could use a shared lock?
 			MutexLock mlock(map.mutex);
 
+			const uint64_t access = ++map.access_counter;
+
 			// Coordinate order matters (note, Y in Vector2i corresponds to Z in 3D here).
-			neighbors_box.for_each_cell_yx([&columns, &map](Vector2i cpos) {
+			neighbors_box.for_each_cell_yx([&columns, &map, access](Vector2i cpos) {
 				auto it = map.columns.find(cpos);
 				Column *column = nullptr;
 				if (it != map.columns.end()) {
 					column = &it->second;
+					column->last_access = access;
 				}
 				columns.push_back(column);
 			});
@@ -180,6 +193,7 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 		Column *main_column = columns[central_block_index];
 
 		bool spawned_subtasks = false;
+		bool waiting = false;
 		bool postpone = false;
 
 		// Check loading levels
@@ -199,6 +213,7 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 
 					if (main_column != nullptr) {
 						main_column->pending_subpass_tasks_mask &= ~(1 << _subpass_index);
+						schedule_subpass_waiters(map, *main_column, _subpass_index, task_scheduler);
 
 						if (_subpass_index == final_subpass_index) {
 							// Schedule pending block requests to make them handle cancellation
@@ -233,12 +248,21 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 							postpone = true;
 
 						} else if ((column->pending_subpass_tasks_mask & (1 << prev_subpass_index)) != 0) {
-							// A task is pending to work on the dependency, so we wait.
-							// TODO Ideally we should subscribe to the completion of that task.
-							// We can do that
-							// println(format("O {} {} {} {} {}", int(_subpass_index), _column_position.x, 0,
-							// 		_column_position.y, Time::get_singleton()->get_ticks_usec()));
-							postpone = true;
+							// A task is pending to work on the dependency. Subscribe to its completion, it will
+							// schedule us again. It can't complete before we release the region lock.
+
+							if (dependency_counter == nullptr) {
+								dependency_counter = make_shared_instance<std::atomic_int>();
+							}
+							++(*dependency_counter);
+
+							column->subpass_waiters.push_back(
+									SubpassWaiter{ this, dependency_counter, uint8_t(prev_subpass_index) }
+							);
+							++map.subpass_waiter_count;
+							++map.subpass_wait_total;
+
+							waiting = true;
 
 						} else {
 							// No task is pending to work on the dependency, spawn one.
@@ -280,10 +304,12 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 			}
 		}
 
-		if (spawned_subtasks) {
+		if (spawned_subtasks || waiting) {
+			// Columns being loaded will be checked again once we are scheduled back
 			ctx.status = ThreadedTaskContext::STATUS_TAKEN_OUT;
 
 		} else if (postpone) {
+			++map.lock_postpone_total;
 			ctx.status = ThreadedTaskContext::STATUS_POSTPONED;
 			return;
 
@@ -294,7 +320,7 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 			ZN_ASSERT(main_column != nullptr);
 
 			if (main_column->subpass_index == prev_subpass_index) {
-				const int column_height_blocks = _generator_internal->column_height_blocks;
+				const int column_height_blocks = generator_internal->column_height_blocks;
 
 				if (_subpass_index == 0) {
 					// First pass creates blocks
@@ -315,7 +341,36 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 				const int prev_pass_index = VoxelGeneratorMultipassCB::get_pass_index_from_subpass(prev_subpass_index);
 
 				if (pass_index == 0 || prev_pass_index != pass_index) {
-					const int column_base_y_blocks = _generator_internal->column_base_y_blocks;
+					const int column_base_y_blocks = generator_internal->column_base_y_blocks;
+
+					// Bring back columns that were moved out of memory
+					bool unspill_failed = false;
+					for (unsigned int column_index = 0; column_index < columns.size(); ++column_index) {
+						Column *column = columns[column_index];
+						if (column->spilled) {
+							const Vector2i cpos = neighbors_box.position +
+									Vector2iUtil::from_yx_index(column_index, neighbors_box.size);
+							if (!unspill_column(*generator_internal, cpos, *column)) {
+								reset_unspillable_column(map, cpos, *column);
+								unspill_failed = true;
+							}
+						}
+					}
+
+					if (unspill_failed) {
+						// Voxels we depend on are lost. Cancel, so the next request generates them again.
+						main_column->pending_subpass_tasks_mask &= ~(1 << _subpass_index);
+						schedule_subpass_waiters(map, *main_column, _subpass_index, task_scheduler);
+
+						if (_subpass_index == final_subpass_index) {
+							// Schedule pending block requests to make them handle cancellation
+							schedule_final_block_tasks(*main_column, task_scheduler);
+						}
+
+						return_to_caller(false);
+						task_scheduler.flush();
+						return;
+					}
 
 					// TODO Cache memory
 					StdVector<Block *> blocks;
@@ -340,6 +395,10 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 
 					// This should be the ONLY place where `_generator` is used.
 					_generator->generate_pass(input);
+
+					for (Column *column : columns) {
+						update_column_memory_usage(map, *column);
+					}
 				}
 
 				// Update levels
@@ -355,6 +414,7 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 			}
 
 			main_column->pending_subpass_tasks_mask &= ~(1 << _subpass_index);
+			schedule_subpass_waiters(map, *main_column, _subpass_index, task_scheduler);
 
 			if (main_column->subpass_index == final_subpass_index) {
 				// All tasks that were waiting for this column to be complete (and did not spawn column subtasks
@@ -369,6 +429,9 @@ void GenerateColumnMultipassTask::run(ThreadedTaskContext &ctx) {
 
 	// println(format("End of {} t {}", uint64_t(this), Thread::get_caller_id()));
 	task_scheduler.flush();
+
+	// Done after releasing the region lock, since it has to lock other columns
+	spill_least_recently_used_columns(*generator_internal);
 }
 
 void GenerateColumnMultipassTask::schedule_final_block_tasks(Column &column, BufferedTaskScheduler &task_scheduler) {
@@ -384,15 +447,17 @@ void GenerateColumnMultipassTask::schedule_final_block_tasks(Column &column, Buf
 void GenerateColumnMultipassTask::return_to_caller(bool success) {
 	ZN_ASSERT(_caller_task != nullptr);
 	ZN_ASSERT(_caller_task_dependency_counter != nullptr);
-	const int counter = --(*_caller_task_dependency_counter);
-	ZN_ASSERT(counter >= 0);
 	if (!success) {
+		// Must be done before decrementing the counter, because the caller can also be waiting on tasks from other
+		// callers, which may resume it as soon as the counter reaches zero
 		if (_caller_mp_task != nullptr) {
 			_caller_mp_task->_cancelled = true;
 		}
 		// println(format("C {} {} {} {} {}", int(_subpass_index), _column_position.x, 0, _column_position.y,
 		// 		Time::get_singleton()->get_ticks_usec()));
 	}
+	const int counter = --(*_caller_task_dependency_counter);
+	ZN_ASSERT(counter >= 0);
 	if (counter == 0) {
 		VoxelEngine::get_singleton().push_async_task(_caller_task);
 	}
@@ -13,9 +13,10 @@ class BufferedTaskScheduler;
 // If at least one column isn't found in the map, the task is cancelled, and so should be all its callers.
 // Otherwise:
 // If a column doesn't fulfills dependency requirements:
-//     - If another task is working on that column, the current task is postponed to run later.
+//     - If another task is working on that column, the current task registers itself as waiting on that column.
 //     - Otherwise, a subtask is spawned to work on the dependency.
-//       The current task is queued after every subtask spawned this way.
+//     The current task is queued again after every subtask it spawned and every task it waits on have completed.
+//     Tasks are only postponed (polled) when columns they need are locked, or are being loaded.
 // Otherwise, the task runs the pass, re-schedules its caller, and returns.
 //
 // One reason to use this pattern instead of "pyramid diffs", is that it can be invoked without assumptions. It will
@@ -5,6 +5,7 @@
 #include "../../util/godot/check_ref_ownership.h"
 #include "../../util/godot/classes/time.h"
 #include "../../util/godot/core/array.h"
+#include "../../util/godot/core/packed_arrays.h"
 #include "../../util/profiling.h"
 #include "../../util/string/format.h"
 #include "generate_block_multipass_cb_task.h"
@@ -160,6 +161,61 @@ void VoxelGeneratorMultipassCB::set_pass_extent_blocks(int pass_index, int new_e
 	re_initialize_column_refcounts();
 }
 
+int VoxelGeneratorMultipassCB::get_cache_memory_budget_mb() const {
+	return int(get_internal()->cache_memory_budget_bytes / (1024 * 1024));
+}
+
+void VoxelGeneratorMultipassCB::set_cache_memory_budget_mb(int mb) {
+	mb = math::clamp(mb, 0, MAX_CACHE_MEMORY_BUDGET_MB);
+	if (get_cache_memory_budget_mb() == mb) {
+		return;
+	}
+	reset_internal([mb](Internal &internal) { //
+		internal.cache_memory_budget_bytes = size_t(mb) * 1024 * 1024;
+	});
+	re_initialize_column_refcounts();
+}
+
+String VoxelGeneratorMultipassCB::get_cache_spill_directory() const {
+	return get_internal()->cache_spill_directory;
+}
+
+void VoxelGeneratorMultipassCB::set_cache_spill_directory(String directory) {
+	if (get_cache_spill_directory() == directory) {
+		return;
+	}
+	reset_internal([&directory](Internal &internal) { //
+		internal.cache_spill_directory = directory;
+	});
+	re_initialize_column_refcounts();
+}
+
+uint64_t VoxelGeneratorMultipassCB::get_cache_memory_usage() const {
+	return get_internal()->map.memory_usage.load(std::memory_order_relaxed);
+}
+
+Dictionary VoxelGeneratorMultipassCB::_b_get_statistics() const {
+	std::shared_ptr<Internal> internal = get_internal();
+	const Map &map = internal->map;
+
+	Dictionary d;
+
+	const int subpass_count = get_subpass_count_from_pass_count(internal->passes.size());
+	PackedInt32Array column_tasks;
+	column_tasks.resize(subpass_count);
+	for (int subpass_index = 0; subpass_index < subpass_count; ++subpass_index) {
+		column_tasks.set(subpass_index, map.column_task_count[subpass_index].load(std::memory_order_relaxed));
+	}
+	d["column_tasks_per_subpass"] = column_tasks;
+
+	d["waiting_column_tasks"] = map.subpass_waiter_count.load(std::memory_order_relaxed);
+	d["total_dependency_waits"] = int64_t(map.subpass_wait_total.load(std::memory_order_relaxed));
+	d["total_lock_postpones"] = int64_t(map.lock_postpone_total.load(std::memory_order_relaxed));
+	d["cache_memory_usage"] = int64_t(map.memory_usage.load(std::memory_order_relaxed));
+
+	return d;
+}
+
 // Internal
 
 std::shared_ptr<Internal> VoxelGeneratorMultipassCB::get_internal() const {
@@ -346,6 +402,11 @@ void VoxelGeneratorMultipassCB::process_viewer_diff_internal(Box3i p_requested_b
 						}
 					}
 
+					// Tasks waiting on this column must run to notice it's gone
+					schedule_all_subpass_waiters(map, column, task_scheduler);
+
+					discard_spilled_column(map, cpos, column);
+
 					// TODO Implement saving tasks
 					// We remove immediately for now
 					map.columns.erase(it);
@@ -645,6 +706,23 @@ void VoxelGeneratorMultipassCB::_bind_methods() {
 			D_METHOD("set_column_height_blocks", "y"), &VoxelGeneratorMultipassCB::set_column_height_blocks
 	);
 
+	ClassDB::bind_method(
+			D_METHOD("get_cache_memory_budget_mb"), &VoxelGeneratorMultipassCB::get_cache_memory_budget_mb
+	);
+	ClassDB::bind_method(
+			D_METHOD("set_cache_memory_budget_mb", "mb"), &VoxelGeneratorMultipassCB::set_cache_memory_budget_mb
+	);
+
+	ClassDB::bind_method(
+			D_METHOD("get_cache_spill_directory"), &VoxelGeneratorMultipassCB::get_cache_spill_directory
+	);
+	ClassDB::bind_method(
+			D_METHOD("set_cache_spill_directory", "directory"), &VoxelGeneratorMultipassCB::set_cache_spill_directory
+	);
+
+	ClassDB::bind_method(D_METHOD("get_cache_memory_usage"), &VoxelGeneratorMultipassCB::get_cache_memory_usage);
+	ClassDB::bind_method(D_METHOD("get_statistics"), &VoxelGeneratorMultipassCB::_b_get_statistics);
+
 	ClassDB::bind_method(
 			D_METHOD("debug_generate_test_column", "column_position_blocks"),
 			&VoxelGeneratorMultipassCB::debug_generate_test_column
@@ -673,6 +751,25 @@ void VoxelGeneratorMultipassCB::_bind_methods() {
 			"get_pass_count"
 	);
 
+	ADD_GROUP("Cache", "cache_");
+
+	ADD_PROPERTY(
+			PropertyInfo(
+					Variant::INT,
+					"cache_memory_budget_mb",
+					PROPERTY_HINT_RANGE,
+					String("0,{0},1").format(varray(MAX_CACHE_MEMORY_BUDGET_MB))
+			),
+			"set_cache_memory_budget_mb",
+			"get_cache_memory_budget_mb"
+	);
+
+	ADD_PROPERTY(
+			PropertyInfo(Variant::STRING, "cache_spill_directory", PROPERTY_HINT_GLOBAL_DIR),
+			"set_cache_spill_directory",
+			"get_cache_spill_directory"
+	);
+
 	BIND_CONSTANT(MAX_PASSES);
 	BIND_CONSTANT(MAX_PASS_EXTENT);
 }
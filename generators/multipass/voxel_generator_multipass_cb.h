@@ -4,6 +4,7 @@
 #include "../../engine/ids.h"
 #include "../../storage/voxel_buffer_gd.h"
 #include "../../util/containers/std_vector.h"
+#include "../../util/godot/core/dictionary.h"
 #include "../../util/godot/core/gdvirtual.h"
 #include "../../util/math/box3i.h"
 #include "../../util/math/vector2i.h"
@@ -39,6 +40,8 @@ public:
 	// For reference, Minecraft is 24 blocks high (384 voxels)
 	static constexpr int MAX_COLUMN_HEIGHT_BLOCKS = 32;
 
+	static constexpr int MAX_CACHE_MEMORY_BUDGET_MB = 1024 * 1024;
+
 	static inline int get_subpass_count_from_pass_count(int pass_count) {
 		return pass_count * 2 - 1;
 	}
@@ -84,6 +87,17 @@ public:
 	int get_pass_extent_blocks(int pass_index) const;
 	void set_pass_extent_blocks(int pass_index, int new_extent);
 
+	// Memory budget for voxels of partially generated columns kept in cache. When exceeded, least recently used
+	// columns are compressed and moved out of memory. 0 means unlimited.
+	int get_cache_memory_budget_mb() const;
+	void set_cache_memory_budget_mb(int mb);
+
+	// Directory where columns exceeding the memory budget are written. If empty, they remain compressed in memory.
+	String get_cache_spill_directory() const;
+	void set_cache_spill_directory(String directory);
+
+	uint64_t get_cache_memory_usage() const;
+
 	// Run the generator to get a particular column from scratch, using a single thread for better script debugging
 	// (since Godot 4 still doesn't support debugging scripts in different threads, at time of writing). This doesn't
 	// use the internal cache and can be extremely slow.
@@ -132,6 +146,8 @@ private:
 	void re_initialize_column_refcounts();
 	void generate_block_fallback_script(VoxelQueryData &input);
 
+	Dictionary _b_get_statistics() const;
+
 	// This must be called each time the structure of passes changes (number of passes, extents)
 	template <typename F>
 	void reset_internal(F f) {
@@ -0,0 +1,410 @@
+#include "voxel_generator_multipass_cb_structs.h"
+#include "../../engine/buffered_task_scheduler.h"
+#include "../../streams/voxel_block_serializer.h"
+#include "../../util/godot/classes/directory.h"
+#include "../../util/godot/classes/file_access.h"
+#include "../../util/godot/classes/time.h"
+#include "../../util/io/serialization.h"
+#include "../../util/memory/linear_allocator.h"
+#include "../../util/profiling.h"
+#include "../../util/string/format.h"
+#include <algorithm>
+
+namespace zylann::voxel::VoxelGeneratorMultipassCBStructs {
+
+namespace {
+
+size_t get_voxels_memory_usage(const VoxelBuffer &voxels) {
+	size_t size = 0;
+	for (unsigned int channel_index = 0; channel_index < VoxelBuffer::MAX_CHANNELS; ++channel_index) {
+		if (!voxels.is_uniform(channel_index)) {
+			size += VoxelBuffer::get_size_in_bytes_for_volume(
+					voxels.get_size(), voxels.get_channel_depth(channel_index)
+			);
+		}
+	}
+	return size;
+}
+
+String get_spill_file_path(const Map &map, Vector2i column_position) {
+	return map.spill_path.path_join(String("c.{0}.{1}.bin").format(varray(column_position.x, column_position.y)));
+}
+
+// Gets the directory where columns of the map are spilled, creating it if needed.
+// Each map gets its own directory, because an old map can still be in use by tasks after the generator was modified.
+bool get_or_create_spill_path(Internal &internal, String &out_path) {
+	Map &map = internal.map;
+	MutexLock mlock(map.spill_path_mutex);
+
+	if (map.spill_path.is_empty()) {
+		static std::atomic_uint32_t s_map_counter = { 0 };
+		const String path = internal.cache_spill_directory.path_join(
+				String("multipass_{0}_{1}")
+						.format(varray(Time::get_singleton()->get_ticks_usec(), s_map_counter.fetch_add(1)))
+		);
+		const Error err = DirAccess::make_dir_recursive_absolute(path);
+		if (err != OK) {
+			ZN_PRINT_ERROR(format("Could not create multipass spill directory {}, error {}", path, int(err)));
+			return false;
+		}
+		map.spill_path = path;
+	}
+
+	out_path = map.spill_path;
+	return true;
+}
+
+// Reads back the serialized voxels of a spilled column. `file_data` receives the data if it has to be read from a file.
+bool get_spilled_data(
+		const Map &map,
+		Vector2i column_position,
+		const Column &column,
+		StdVector<uint8_t> &file_data,
+		Span<const uint8_t> &out_data
+) {
+	if (column.spilled_data.size() > 0) {
+		out_data = to_span(column.spilled_data);
+		return true;
+	}
+
+	const String path = get_spill_file_path(map, column_position);
+	Error err;
+	Ref<FileAccess> f = zylann::godot::open_file(path, FileAccess::READ, err);
+	if (f.is_null()) {
+		ZN_PRINT_ERROR(format("Could not open multipass spill file {}, error {}", path, int(err)));
+		return false;
+	}
+
+	file_data.resize(f->get_length());
+	const uint64_t read_size = zylann::godot::get_buffer(**f, to_span(file_data));
+	ZN_ASSERT_RETURN_V(read_size == file_data.size(), false);
+
+	out_data = to_span(file_data);
+	return true;
+}
+
+// Column data is a sequence of compressed blocks, each prefixed with its size
+bool deserialize_block(Span<const uint8_t> data, unsigned int block_index, VoxelBuffer &out_voxels) {
+	MemoryReader reader(data, ENDIANNESS_LITTLE_ENDIAN);
+	const uint32_t block_count = reader.get_32();
+	ZN_ASSERT_RETURN_V(block_index < block_count, false);
+
+	for (unsigned int i = 0; i < block_index; ++i) {
+		const uint32_t size = reader.get_32();
+		reader.pos += size;
+	}
+
+	const uint32_t size = reader.get_32();
+	ZN_ASSERT_RETURN_V(reader.pos + size <= data.size(), false);
+	return BlockSerializer::decompress_and_deserialize(data.sub(reader.pos, size), out_voxels);
+}
+
+void schedule_subpass_waiter(Map &map, SubpassWaiter &waiter, BufferedTaskScheduler &task_scheduler) {
+	map.subpass_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+	const int counter = --(*waiter.dependency_counter);
+	ZN_ASSERT(counter >= 0);
+	if (counter == 0) {
+		task_scheduler.push_main_task(waiter.task);
+	}
+}
+
+} // namespace
+
+void Map::remove_spill_files() {
+	if (spill_path.is_empty()) {
+		return;
+	}
+	for (auto it = columns.begin(); it != columns.end(); ++it) {
+		Column &column = it->second;
+		if (column.spilled && column.spilled_data.size() == 0) {
+			DirAccess::remove_absolute(get_spill_file_path(*this, it->first));
+		}
+	}
+	DirAccess::remove_absolute(spill_path);
+}
+
+void schedule_subpass_waiters(
+		Map &map,
+		Column &column,
+		uint8_t subpass_index,
+		BufferedTaskScheduler &task_scheduler
+) {
+	for (unsigned int i = 0; i < column.subpass_waiters.size();) {
+		SubpassWaiter &waiter = column.subpass_waiters[i];
+		if (waiter.subpass_index == subpass_index) {
+			schedule_subpass_waiter(map, waiter, task_scheduler);
+			column.subpass_waiters[i] = std::move(column.subpass_waiters.back());
+			column.subpass_waiters.pop_back();
+		} else {
+			++i;
+		}
+	}
+}
+
+void schedule_all_subpass_waiters(Map &map, Column &column, BufferedTaskScheduler &task_scheduler) {
+	for (SubpassWaiter &waiter : column.subpass_waiters) {
+		schedule_subpass_waiter(map, waiter, task_scheduler);
+	}
+	column.subpass_waiters.clear();
+}
+
+void update_column_memory_usage(Map &map, Column &column) {
+	size_t memory_usage = 0;
+	for (const Block &block : column.blocks) {
+		memory_usage += get_voxels_memory_usage(block.voxels);
+	}
+	if (memory_usage > column.memory_usage) {
+		map.memory_usage.fetch_add(memory_usage - column.memory_usage, std::memory_order_relaxed);
+	} else {
+		map.memory_usage.fetch_sub(column.memory_usage - memory_usage, std::memory_order_relaxed);
+	}
+	column.memory_usage = memory_usage;
+}
+
+bool spill_column(Internal &internal, Vector2i column_position, Column &column) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN_V(!column.spilled, false);
+
+	Map &map = internal.map;
+
+	StdVector<uint8_t> data;
+	MemoryWriter writer(data, ENDIANNESS_LITTLE_ENDIAN);
+	writer.store_32(column.blocks.size());
+
+	for (const Block &block : column.blocks) {
+		BlockSerializer::SerializeResult result =
+				BlockSerializer::serialize_and_compress(block.voxels, CompressedData::COMPRESSION_LZ4);
+		ZN_ASSERT_RETURN_V(result.success, false);
+		writer.store_32(result.data.size());
+		writer.store_buffer(to_span(result.data));
+	}
+
+	size_t spilled_memory_usage = 0;
+
+	if (internal.cache_spill_directory.is_empty()) {
+		column.spilled_data = std::move(data);
+		// Compressed data remains in memory, so it still counts
+		spilled_memory_usage = column.spilled_data.size();
+
+	} else {
+		String spill_path;
+		if (!get_or_create_spill_path(internal, spill_path)) {
+			return false;
+		}
+		const String path = get_spill_file_path(map, column_position);
+		Error err;
+		Ref<FileAccess> f = zylann::godot::open_file(path, FileAccess::WRITE, err);
+		if (f.is_null()) {
+			ZN_PRINT_ERROR(format("Could not write multipass spill file {}, error {}", path, int(err)));
+			return false;
+		}
+		zylann::godot::store_buffer(**f, to_span(data));
+		f->flush();
+		const Error write_err = f->get_error();
+		if (write_err != OK) {
+			ZN_PRINT_ERROR(format("Could not write multipass spill file {}, error {}", path, int(write_err)));
+			// Voxels are kept in memory, a partial file must not be read later
+			f.unref();
+			DirAccess::remove_absolute(path);
+			return false;
+		}
+	}
+
+	for (Block &block : column.blocks) {
+		block.voxels.clear();
+	}
+
+	map.memory_usage.fetch_sub(column.memory_usage, std::memory_order_relaxed);
+	map.memory_usage.fetch_add(spilled_memory_usage, std::memory_order_relaxed);
+	column.memory_usage = spilled_memory_usage;
+
+	{
+		MutexLock mlock(map.mutex);
+		column.spilled = true;
+	}
+
+	return true;
+}
+
+bool unspill_column(Internal &internal, Vector2i column_position, Column &column) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN_V(column.spilled, false);
+
+	Map &map = internal.map;
+
+	StdVector<uint8_t> file_data;
+	Span<const uint8_t> data;
+	if (!get_spilled_data(map, column_position, column, file_data, data)) {
+		return false;
+	}
+
+	for (unsigned int block_index = 0; block_index < column.blocks.size(); ++block_index) {
+		Block &block = column.blocks[block_index];
+		ZN_ASSERT_RETURN_V(deserialize_block(data, block_index, block.voxels), false);
+	}
+
+	if (column.spilled_data.size() > 0) {
+		// Free memory
+		column.spilled_data = StdVector<uint8_t>();
+	} else {
+		DirAccess::remove_absolute(get_spill_file_path(map, column_position));
+	}
+
+	{
+		MutexLock mlock(map.mutex);
+		column.spilled = false;
+	}
+
+	update_column_memory_usage(map, column);
+	return true;
+}
+
+void reset_unspillable_column(Map &map, Vector2i column_position, Column &column) {
+	ZN_PRINT_ERROR(format("Could not unspill multipass column {}, it will be generated again", column_position));
+
+	// Blocks may have been partially deserialized
+	for (Block &block : column.blocks) {
+		block.voxels.clear();
+	}
+
+	MutexLock mlock(map.mutex);
+	discard_spilled_column(map, column_position, column);
+	column.subpass_index = -1;
+}
+
+bool load_spilled_block(
+		const Internal &internal,
+		Vector2i column_position,
+		const Column &column,
+		unsigned int block_index,
+		VoxelBuffer &out_voxels
+) {
+	ZN_PROFILE_SCOPE();
+	StdVector<uint8_t> file_data;
+	Span<const uint8_t> data;
+	if (!get_spilled_data(internal.map, column_position, column, file_data, data)) {
+		return false;
+	}
+	return deserialize_block(data, block_index, out_voxels);
+}
+
+void discard_spilled_column(Map &map, Vector2i column_position, Column &column) {
+	map.memory_usage.fetch_sub(column.memory_usage, std::memory_order_relaxed);
+	column.memory_usage = 0;
+
+	if (!column.spilled) {
+		return;
+	}
+	if (column.spilled_data.size() == 0) {
+		DirAccess::remove_absolute(get_spill_file_path(map, column_position));
+	}
+	column.spilled_data = StdVector<uint8_t>();
+	column.spilled = false;
+}
+
+void spill_least_recently_used_columns(Internal &internal) {
+	Map &map = internal.map;
+	const size_t budget = internal.cache_memory_budget_bytes;
+
+	if (budget == 0) {
+		return;
+	}
+
+	const size_t memory_usage = map.memory_usage.load(std::memory_order_relaxed);
+	if (memory_usage <= budget) {
+		if (map.spill_threshold.load(std::memory_order_relaxed) != 0) {
+			map.spill_threshold.store(0, std::memory_order_relaxed);
+		}
+		return;
+	}
+	if (memory_usage <= map.spill_threshold.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	// Only one thread at a time, others would compete for the same columns
+	bool expected_spilling = false;
+	if (!map.spilling.compare_exchange_strong(expected_spilling, true)) {
+		return;
+	}
+
+	ZN_PROFILE_SCOPE();
+
+	// Spill more than needed, so it doesn't have to be done again for every new column
+	const size_t target_memory_usage = budget - budget / 4;
+
+	struct ColumnUse {
+		uint64_t last_access;
+		Vector2i position;
+	};
+
+	LinearAllocator &allocator = get_tls_temp_allocator();
+	LinearAllocatorScope las(allocator);
+	StdTempVector<ColumnUse> candidates(allocator);
+
+	{
+		MutexLock mlock(map.mutex);
+		candidates.reserve(map.columns.size());
+		for (auto it = map.columns.begin(); it != map.columns.end(); ++it) {
+			if (!it->second.spilled) {
+				candidates.push_back(ColumnUse{ it->second.last_access, it->first });
+			}
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const ColumnUse &a, const ColumnUse &b) {
+		return a.last_access < b.last_access;
+	});
+
+	for (const ColumnUse &candidate : candidates) {
+		if (map.memory_usage.load(std::memory_order_relaxed) <= target_memory_usage) {
+			break;
+		}
+
+		const BoxBounds2i bounds = BoxBounds2i::from_position(candidate.position);
+		if (!map.spatial_lock.try_lock_write(bounds)) {
+			// A task is working on it, so it is probably not a good candidate anyways
+			continue;
+		}
+		SpatialLock2D::UnlockWriteOnScopeExit swlock(map.spatial_lock, bounds);
+
+		Column *column = nullptr;
+		{
+			MutexLock mlock(map.mutex);
+			auto it = map.columns.find(candidate.position);
+			if (it == map.columns.end()) {
+				// Got removed in the meantime
+				continue;
+			}
+			column = &it->second;
+		}
+
+		if (column->spilled || column->subpass_index < 0 || column->pending_subpass_tasks_mask != 0 ||
+			column->loading || column->saving) {
+			continue;
+		}
+
+		bool has_pending_block_task = false;
+		for (const Block &block : column->blocks) {
+			if (block.final_pending_task != nullptr) {
+				has_pending_block_task = true;
+				break;
+			}
+		}
+		if (has_pending_block_task) {
+			continue;
+		}
+
+		spill_column(internal, candidate.position, *column);
+	}
+
+	// If not enough columns could be spilled because they were busy, wait for memory usage to grow further before
+	// trying again, rather than sorting all columns again after every task
+	const size_t end_memory_usage = map.memory_usage.load(std::memory_order_relaxed);
+	map.spill_threshold.store(
+			end_memory_usage > target_memory_usage ? end_memory_usage + budget / 8 : 0, std::memory_order_relaxed
+	);
+
+	map.spilling.store(false);
+}
+
+} // namespace zylann::voxel::VoxelGeneratorMultipassCBStructs
@@ -6,12 +6,15 @@
 #include "../../util/containers/span.h"
 #include "../../util/containers/std_unordered_map.h"
 #include "../../util/containers/std_vector.h"
+#include "../../util/godot/core/string.h"
 #include "../../util/math/vector2i.h"
 #include "../../util/math/vector3i.h"
 #include "../../util/ref_count.h"
 #include "../../util/thread/mutex.h"
 #include "../../util/thread/spatial_lock_2d.h"
 
+#include <atomic>
+#include <memory>
 #include <utility>
 
 // Data structures used internally in multipass generation.
@@ -25,6 +28,9 @@ namespace zylann {
 class IThreadedTask;
 
 namespace voxel {
+
+class BufferedTaskScheduler;
+
 namespace VoxelGeneratorMultipassCBStructs {
 
 // Pass limit is pretty low because in practice not that many should be needed, and it gets expensive really quick
@@ -66,6 +72,14 @@ struct Block {
 	}
 };
 
+// A task waiting for a column to complete a subpass, which another task is working on.
+struct SubpassWaiter {
+	// Scheduled when `dependency_counter` reaches zero
+	IThreadedTask *task = nullptr;
+	std::shared_ptr<std::atomic_int> dependency_counter;
+	uint8_t subpass_index = 0;
+};
+
 struct Column {
 	RefCount viewers;
 	// Index of the last subpass that was executed directly on this chunk.
@@ -77,6 +91,10 @@ struct Column {
 	// Each bit is set to 1 when a task is pending to process this block at a given subpass.
 	uint8_t pending_subpass_tasks_mask = 0;
 
+	// Tasks to notify when a pending subpass task completes on this column. Tasks depending on this column register
+	// here instead of polling until the pending task is done.
+	StdVector<SubpassWaiter> subpass_waiters;
+
 	// Currently unused, because if chunks get removed from the cache or don't get saved for any reason,
 	// it can become out of sync and we wouldn't know. It would be a nice optimization tho...
 	//
@@ -90,6 +108,19 @@ struct Column {
 	// TODO Maybe replace with a dynamic non-resizeable array?
 	StdVector<Block> blocks;
 
+	// Memory used by voxels of blocks, or by their compressed data if they are spilled in memory, in bytes.
+	size_t memory_usage = 0;
+
+	// Used to choose which columns to spill first when the cache exceeds its memory budget.
+	// Protected by the map's mutex.
+	uint64_t last_access = 0;
+
+	// If true, voxels of blocks are not in memory. They were compressed into `spilled_data`, or into a file if the
+	// generator has a spill directory. Blocks remain in the column, without voxels.
+	// Protected by the map's mutex, in addition to the spatial lock.
+	bool spilled = false;
+	StdVector<uint8_t> spilled_data;
+
 	// Column() {
 	// 	fill(subpass_iterations, uint8_t(0));
 	// }
@@ -102,6 +133,29 @@ struct Map {
 	// Protects columns
 	mutable SpatialLock2D spatial_lock;
 
+	// Sum of memory used by columns, in bytes
+	std::atomic<size_t> memory_usage = { 0 };
+	// Memory usage above which columns get spilled, if higher than the budget. Raised when columns could not be
+	// spilled enough, so it isn't attempted again after every task while they are busy.
+	std::atomic<size_t> spill_threshold = { 0 };
+	// True while a thread is spilling columns
+	std::atomic_bool spilling = { false };
+	// Incremented each time columns are accessed by a task. Protected by `mutex`.
+	uint64_t access_counter = 0;
+
+	// Column tasks currently alive (queued, running or waiting), per subpass
+	std::atomic_int column_task_count[MAX_SUBPASSES] = {};
+	// Tasks currently registered as waiting for a subpass to complete on a column
+	std::atomic_int subpass_waiter_count = { 0 };
+	// Total times tasks had to wait for another task to complete a dependency
+	std::atomic_uint64_t subpass_wait_total = { 0 };
+	// Total times tasks were postponed because columns they needed were locked by another task
+	std::atomic_uint64_t lock_postpone_total = { 0 };
+
+	// Directory where columns of this map are spilled. Created when the first column gets spilled to a file.
+	String spill_path;
+	Mutex spill_path_mutex;
+
 	~Map() {
 		// If the map gets destroyed then we know the last reference to it was removed, which means only one thread had
 		// access to it, so we can get away not locking anything if cleanup is needed.
@@ -114,7 +168,11 @@ struct Map {
 		//
 		// That said, that pretty much describes a cyclic reference. This cycle is usually broken by VoxelTerrain, which
 		// controls the streaming behavior. If a terrain gets destroyed, it must tell the generator to unload its cache.
+
+		remove_spill_files();
 	}
+
+	void remove_spill_files();
 };
 
 struct Pass {
@@ -137,6 +195,12 @@ struct Internal {
 	SmallVector<Pass, MAX_PASSES> passes;
 	int column_base_y_blocks = -4;
 	int column_height_blocks = 8;
+	// When voxels of cached columns use more memory than this, least recently used columns are compressed and moved
+	// out of memory until a task needs them again. 0 means unlimited.
+	size_t cache_memory_budget_bytes = 0;
+	// If not empty, spilled columns are written to files under this directory instead of remaining compressed in
+	// memory.
+	String cache_spill_directory;
 
 	// Set to `true` if the generator's configuration changed. Means a new instance of Internal has been made.
 	// Existing tasks may still finish their work using the old instance, but results will be thrown away. Such
@@ -152,9 +216,63 @@ struct Internal {
 		passes = other.passes;
 		column_base_y_blocks = other.column_base_y_blocks;
 		column_height_blocks = other.column_height_blocks;
+		cache_memory_budget_bytes = other.cache_memory_budget_bytes;
+		cache_spill_directory = other.cache_spill_directory;
 	}
 };
 
+// Schedules tasks waiting for the given subpass to complete on a column, if they have no other dependency left.
+// The column must be locked for writing.
+void schedule_subpass_waiters(
+		Map &map,
+		Column &column,
+		uint8_t subpass_index,
+		BufferedTaskScheduler &task_scheduler
+);
+
+// Schedules all tasks waiting on a column that is about to be removed. They will notice it's gone when they run.
+// The column must be locked for writing.
+void schedule_all_subpass_waiters(Map &map, Column &column, BufferedTaskScheduler &task_scheduler);
+
+// Spilling
+// Columns hold all intermediate blocks of every pass, which can use a lot of memory with large view distances. To
+// keep it bounded, columns that are not being worked on can be compressed and moved out of memory, and brought back
+// when a task needs them.
+
+// Must be called after voxels of a column changed while it was locked for writing.
+void update_column_memory_usage(Map &map, Column &column);
+
+// Compresses voxels of a column and removes them from memory. The column must be locked for writing, and must not
+// have pending tasks. Returns false if the column could not be spilled, in which case it remains in memory.
+bool spill_column(Internal &internal, Vector2i column_position, Column &column);
+
+// Brings back voxels of a spilled column. The column must be locked for writing. Returns false if spilled data could
+// not be read, in which case voxels of the column are lost and `reset_unspillable_column` must be called.
+bool unspill_column(Internal &internal, Vector2i column_position, Column &column);
+
+// Drops what remains of a column that could not be unspilled, so it gets generated again from the first pass. The
+// column must be locked for writing.
+void reset_unspillable_column(Map &map, Vector2i column_position, Column &column);
+
+// Gets voxels of one block of a spilled column without bringing back the column. The column must be locked for
+// reading.
+bool load_spilled_block(
+		const Internal &internal,
+		Vector2i column_position,
+		const Column &column,
+		unsigned int block_index,
+		VoxelBuffer &out_voxels
+);
+
+// Frees spilled data of a column that is about to be removed. The column must be locked for writing, and the map's
+// mutex must be locked.
+void discard_spilled_column(Map &map, Vector2i column_position, Column &column);
+
+// Spills least recently used columns until the cache is below its memory budget. Columns that are locked or have
+// pending tasks are skipped. If that doesn't free enough memory, spilling is not attempted again until memory usage
+// grows further. Must be called without holding any lock on the map.
+void spill_least_recently_used_columns(Internal &internal);
+
 struct PassInput {
 	// 3D grid of blocks as a linear sequence, ZXY order
 	Span<Block *> grid;
@@ -119,6 +119,45 @@ VoxelGenerator::Result VoxelGeneratorFlat::generate_block(VoxelGenerator::VoxelQ
 	return result;
 }
 
+VoxelSingleValue VoxelGeneratorFlat::generate_single(Vector3i pos, unsigned int channel) {
+	VoxelSingleValue v;
+	generate_single_batch(to_single_element_span(pos), channel, to_single_element_span(v));
+	return v;
+}
+
+void VoxelGeneratorFlat::generate_single_batch(
+		Span<const Vector3i> positions,
+		unsigned int channel,
+		Span<VoxelSingleValue> out_values
+) {
+	ZN_ASSERT_RETURN(positions.size() == out_values.size());
+
+	Parameters params;
+	{
+		RWLockRead rlock(_parameters_lock);
+		params = _parameters;
+	}
+
+	if (channel != static_cast<unsigned int>(params.channel)) {
+		const VoxelSingleValue defval = get_default_single_value(channel);
+		for (VoxelSingleValue &v : out_values) {
+			v = defval;
+		}
+		return;
+	}
+
+	if (channel == VoxelBuffer::CHANNEL_SDF) {
+		for (unsigned int i = 0; i < positions.size(); ++i) {
+			out_values[i].f = params.iso_scale * (positions[i].y - params.height);
+		}
+	} else {
+		for (unsigned int i = 0; i < positions.size(); ++i) {
+			// Same rounding as `generate_block`
+			out_values[i].i = static_cast<int>(params.height - positions[i].y) > 0 ? params.voxel_type : 0;
+		}
+	}
+}
+
 void VoxelGeneratorFlat::_b_set_channel(godot::VoxelBuffer::ChannelId p_channel) {
 	set_channel(VoxelBuffer::ChannelId(p_channel));
 }
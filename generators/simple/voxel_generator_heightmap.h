@@ -155,6 +155,46 @@ protected:
 		}
 	}
 
+	// Same results as `generate` at LOD0, computed directly at each position.
+	// float height_func(x, z)
+	template <typename Height_F>
+	void generate_single_batch_template(
+			Height_F height_func,
+			Span<const Vector3i> positions,
+			unsigned int channel,
+			Span<VoxelSingleValue> out_values
+	) {
+		ZN_ASSERT_RETURN(positions.size() == out_values.size());
+
+		Parameters params;
+		{
+			RWLockRead rlock(_parameters_lock);
+			params = _parameters;
+		}
+
+		if (channel != static_cast<unsigned int>(params.channel)) {
+			const VoxelSingleValue defval = get_default_single_value(channel);
+			for (VoxelSingleValue &v : out_values) {
+				v = defval;
+			}
+			return;
+		}
+
+		if (channel == VoxelBuffer::CHANNEL_SDF) {
+			for (unsigned int i = 0; i < positions.size(); ++i) {
+				const Vector3i pos = positions[i];
+				const float h = params.range.xform(height_func(pos.x - params.offset.x, pos.z - params.offset.y));
+				out_values[i].f = params.iso_scale * (pos.y - h);
+			}
+		} else {
+			for (unsigned int i = 0; i < positions.size(); ++i) {
+				const Vector3i pos = positions[i];
+				const float h = params.range.xform(height_func(pos.x - params.offset.x, pos.z - params.offset.y));
+				out_values[i].i = static_cast<int>(h - pos.y) > 0 ? params.matter_type : 0;
+			}
+		}
+	}
+
 private:
 	static void _bind_methods();
 
@@ -94,6 +94,37 @@ VoxelGenerator::Result VoxelGeneratorImage::generate_block(VoxelGenerator::Voxel
 	return result;
 }
 
+VoxelSingleValue VoxelGeneratorImage::generate_single(Vector3i pos, unsigned int channel) {
+	VoxelSingleValue v;
+	generate_single_batch(to_single_element_span(pos), channel, to_single_element_span(v));
+	return v;
+}
+
+void VoxelGeneratorImage::generate_single_batch(
+		Span<const Vector3i> positions,
+		unsigned int channel,
+		Span<VoxelSingleValue> out_values
+) {
+	Parameters params;
+	{
+		RWLockRead rlock(_parameters_lock);
+		params = _parameters;
+	}
+
+	ERR_FAIL_COND(params.image.is_null());
+	const Image &image = **params.image;
+
+	if (params.blur_enabled) {
+		VoxelGeneratorHeightmap::generate_single_batch_template(
+				[&image](int x, int z) { return get_height_blurred(image, x, z); }, positions, channel, out_values
+		);
+	} else {
+		VoxelGeneratorHeightmap::generate_single_batch_template(
+				[&image](int x, int z) { return get_height_repeat(image, x, z); }, positions, channel, out_values
+		);
+	}
+}
+
 void VoxelGeneratorImage::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_image", "image"), &VoxelGeneratorImage::set_image);
 	ClassDB::bind_method(D_METHOD("get_image"), &VoxelGeneratorImage::get_image);
@@ -247,6 +247,75 @@ VoxelGenerator::Result VoxelGeneratorNoise::generate_block(VoxelGenerator::Voxel
 	return result;
 }
 
+VoxelSingleValue VoxelGeneratorNoise::generate_single(Vector3i pos, unsigned int channel) {
+	VoxelSingleValue v;
+	generate_single_batch(to_single_element_span(pos), channel, to_single_element_span(v));
+	return v;
+}
+
+void VoxelGeneratorNoise::generate_single_batch(
+		Span<const Vector3i> positions,
+		unsigned int channel,
+		Span<VoxelSingleValue> out_values
+) {
+	ZN_ASSERT_RETURN(positions.size() == out_values.size());
+
+	Parameters params;
+	{
+		RWLockRead rlock(_parameters_lock);
+		params = _parameters;
+	}
+
+	ERR_FAIL_COND(params.noise.is_null());
+
+	if (channel != static_cast<unsigned int>(params.channel) ||
+		(channel != VoxelBuffer::CHANNEL_SDF && channel != VoxelBuffer::CHANNEL_TYPE &&
+		 channel != VoxelBuffer::CHANNEL_COLOR)) {
+		const VoxelSingleValue defval = get_default_single_value(channel);
+		for (VoxelSingleValue &v : out_values) {
+			v = defval;
+		}
+		return;
+	}
+
+	FastNoiseLite &noise = **params.noise;
+
+	// Same as `generate_block` at LOD0
+	const float noise_period = 1.0 / math::max<real_t>(noise.get_frequency(), 0.0001);
+	const int isosurface_lower_bound = static_cast<int>(Math::floor(params.height_start));
+	const int isosurface_upper_bound = static_cast<int>(Math::ceil(params.height_start + params.height_range));
+	const float height_range_inv = 1.f / params.height_range;
+
+	const int air_type = 0;
+	const int matter_type = 1;
+	const int air_color = 0;
+	const int matter_color = 1;
+
+	for (unsigned int i = 0; i < positions.size(); ++i) {
+		const Vector3i pos = positions[i];
+
+		float d;
+		if (pos.y < isosurface_lower_bound) {
+			d = constants::SDF_FAR_INSIDE;
+		} else if (pos.y >= isosurface_upper_bound) {
+			d = constants::SDF_FAR_OUTSIDE;
+		} else {
+			const float t = (pos.y - params.height_start) * height_range_inv;
+			const float bias = 2.0 * t - 1.0;
+			const float n = noise.get_noise_3d(pos.x, pos.y, pos.z);
+			d = (n + bias) * noise_period;
+		}
+
+		if (channel == VoxelBuffer::CHANNEL_SDF) {
+			out_values[i].f = d;
+		} else if (channel == VoxelBuffer::CHANNEL_TYPE) {
+			out_values[i].i = d < 0 ? matter_type : air_type;
+		} else {
+			out_values[i].i = d < 0 ? matter_color : air_color;
+		}
+	}
+}
+
 void VoxelGeneratorNoise::_b_set_channel(godot::VoxelBuffer::ChannelId p_channel) {
 	set_channel(VoxelBuffer::ChannelId(p_channel));
 }
@@ -103,6 +103,41 @@ VoxelGenerator::Result VoxelGeneratorNoise2D::generate_block(VoxelGenerator::Vox
 	return result;
 }
 
+VoxelSingleValue VoxelGeneratorNoise2D::generate_single(Vector3i pos, unsigned int channel) {
+	VoxelSingleValue v;
+	generate_single_batch(to_single_element_span(pos), channel, to_single_element_span(v));
+	return v;
+}
+
+void VoxelGeneratorNoise2D::generate_single_batch(
+		Span<const Vector3i> positions,
+		unsigned int channel,
+		Span<VoxelSingleValue> out_values
+) {
+	Parameters params;
+	{
+		RWLockRead rlock(_parameters_lock);
+		params = _parameters;
+	}
+
+	ERR_FAIL_COND(params.noise.is_null());
+	Noise &noise = **params.noise;
+
+	if (params.curve.is_null()) {
+		generate_single_batch_template(
+				[&noise](int x, int z) { return 0.5 + 0.5 * noise.get_noise_2d(x, z); }, positions, channel, out_values
+		);
+	} else {
+		Curve &curve = **params.curve;
+		generate_single_batch_template(
+				[&noise, &curve](int x, int z) { return curve.sample_baked(0.5 + 0.5 * noise.get_noise_2d(x, z)); },
+				positions,
+				channel,
+				out_values
+		);
+	}
+}
+
 void VoxelGeneratorNoise2D::generate_series(
 		Span<const float> positions_x,
 		Span<const float> positions_y,
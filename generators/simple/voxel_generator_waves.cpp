@@ -37,6 +37,36 @@ VoxelGenerator::Result VoxelGeneratorWaves::generate_block(VoxelGenerator::Voxel
 	);
 }
 
+VoxelSingleValue VoxelGeneratorWaves::generate_single(Vector3i pos, unsigned int channel) {
+	VoxelSingleValue v;
+	generate_single_batch(to_single_element_span(pos), channel, to_single_element_span(v));
+	return v;
+}
+
+void VoxelGeneratorWaves::generate_single_batch(
+		Span<const Vector3i> positions,
+		unsigned int channel,
+		Span<VoxelSingleValue> out_values
+) {
+	Parameters params;
+	{
+		RWLockRead rlock(_parameters_lock);
+		params = _parameters;
+	}
+
+	const Vector2 freq(math::PI<real_t> / params.pattern_size.x, math::PI<real_t> / params.pattern_size.y);
+	const Vector2 offset = params.pattern_offset;
+
+	VoxelGeneratorHeightmap::generate_single_batch_template(
+			[freq, offset](int x, int z) {
+				return 0.5 + 0.25 * (Math::cos((x + offset.x) * freq.x) + Math::sin((z + offset.y) * freq.y));
+			},
+			positions,
+			channel,
+			out_values
+	);
+}
+
 Vector2 VoxelGeneratorWaves::get_pattern_size() const {
 	RWLockRead rlock(_parameters_lock);
 	return _parameters.pattern_size;
@@ -16,6 +16,18 @@ public:
 
 	Result generate_block(VoxelGenerator::VoxelQueryData input) override;
 
+	bool supports_single_generation() const override {
+		return true;
+	}
+
+	VoxelSingleValue generate_single(Vector3i pos, unsigned int channel) override;
+
+	void generate_single_batch(
+			Span<const Vector3i> positions,
+			unsigned int channel,
+			Span<VoxelSingleValue> out_values
+	) override;
+
 	Vector2 get_pattern_size() const;
 	void set_pattern_size(Vector2 size);
 
@@ -33,10 +33,9 @@ VoxelSingleValue VoxelGenerator::generate_single(Vector3i pos, unsigned int chan
 	VoxelSingleValue v;
 	v.i = 0;
 	ZN_ASSERT_RETURN_V(channel < VoxelBuffer::MAX_CHANNELS, v);
-	// Default slow implementation
-	// TODO Optimize: a small part of the slowness is caused by the allocator.
-	// It is not a good use of `VoxelMemoryPool` for such a small size called so often.
-	// Instead it would be faster if it was using a temp allocator, or maybe stack-allocated.
+	// Default slow implementation, generators able to compute single voxels directly should override it.
+	// A small part of the slowness is caused by the allocator: it is not a good use of `VoxelMemoryPool` for such a
+	// small size called so often.
 	VoxelBuffer buffer(VoxelBuffer::ALLOCATOR_POOL);
 	buffer.create(1, 1, 1);
 	VoxelQueryData q{ buffer, pos, 0 };
@@ -49,6 +48,36 @@ VoxelSingleValue VoxelGenerator::generate_single(Vector3i pos, unsigned int chan
 	return v;
 }
 
+void VoxelGenerator::generate_single_batch(
+		Span<const Vector3i> positions,
+		unsigned int channel,
+		Span<VoxelSingleValue> out_values
+) {
+	ZN_ASSERT_RETURN(positions.size() == out_values.size());
+	for (unsigned int i = 0; i < positions.size(); ++i) {
+		out_values[i] = generate_single(positions[i], channel);
+	}
+}
+
+VoxelSingleValue VoxelGenerator::get_default_single_value(unsigned int channel) {
+	VoxelSingleValue v;
+	switch (channel) {
+		case VoxelBuffer::CHANNEL_SDF: {
+			const VoxelBuffer::Depth depth = VoxelBuffer::DEFAULT_SDF_CHANNEL_DEPTH;
+			v.f = VoxelBuffer::raw_voxel_to_real(VoxelBuffer::get_default_sdf_raw_value(depth), depth);
+		} break;
+		case VoxelBuffer::CHANNEL_INDICES:
+			v.i = VoxelBuffer::get_default_indices_raw_value(VoxelBuffer::DEFAULT_INDICES_CHANNEL_DEPTH);
+			break;
+		default:
+			v.i = VoxelBuffer::get_default_raw_value(
+					static_cast<VoxelBuffer::ChannelId>(channel), VoxelBuffer::DEFAULT_CHANNEL_DEPTH
+			);
+			break;
+	}
+	return v;
+}
+
 void VoxelGenerator::generate_series(
 		Span<const float> positions_x,
 		Span<const float> positions_y,
@@ -102,9 +102,17 @@ public:
 		return true;
 	}
 
-	// TODO Not sure if it's a good API regarding performance
+	// Generates one voxel at LOD0. Prefer `generate_single_batch` when several voxels are needed.
 	virtual VoxelSingleValue generate_single(Vector3i pos, unsigned int channel);
 
+	// Generates voxels of one channel at several positions of LOD0, without going through a `VoxelBuffer`.
+	// Must be thread-safe. The default implementation calls `generate_single` for each position.
+	virtual void generate_single_batch(
+			Span<const Vector3i> positions,
+			unsigned int channel,
+			Span<VoxelSingleValue> out_values
+	);
+
 	virtual void generate_series(
 			Span<const float> positions_x,
 			Span<const float> positions_y,
@@ -196,6 +204,9 @@ public:
 protected:
 	static void _bind_methods();
 
+	// Value found in channels `generate_block` does not write to
+	static VoxelSingleValue get_default_single_value(unsigned int channel);
+
 	void _b_generate_block(Ref<godot::VoxelBuffer> out_buffer, Vector3 origin_in_voxels, int lod);
 
 #ifdef VOXEL_ENABLE_GPU
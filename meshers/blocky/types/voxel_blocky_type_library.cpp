@@ -47,6 +47,7 @@ void VoxelBlockyTypeLibrary::bake() {
 	const uint64_t time_before = Time::get_singleton()->get_ticks_usec();
 
 	// This is the only place we modify the data.
+	++_baked_version;
 
 	_indexed_materials.clear();
 	_baked_data.models.clear();
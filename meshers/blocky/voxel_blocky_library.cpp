@@ -67,6 +67,7 @@ void VoxelBlockyLibrary::bake() {
 	const uint64_t time_before = Time::get_singleton()->get_ticks_usec();
 
 	// This is the only place we modify the data.
+	++_baked_version;
 
 	_indexed_materials.clear();
 	blocky::MaterialIndexer materials{ _indexed_materials };
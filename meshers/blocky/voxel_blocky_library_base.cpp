@@ -4,6 +4,7 @@
 #include "../../util/math/box2f.h"
 #include "../../util/math/triangle.h"
 #include "../../util/math/vector4f.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 // #include "../../util/string/format.h" // DEBUG
 #include "voxel_blocky_model.h"
@@ -238,8 +239,8 @@ namespace blocky {
 void get_side_geometry_2d_all_surfaces(
 		const BakedModel::Model &model,
 		int side,
-		StdVector<Vector2f> &out_vertices,
-		StdVector<int32_t> &out_indices
+		StdTempVector<Vector2f> &out_vertices,
+		StdTempVector<int32_t> &out_indices
 ) {
 	unsigned int vertex_count = 0;
 	unsigned int index_count = 0;
@@ -432,8 +433,9 @@ void generate_cutout_side_surface(
 	// Not done currently because what we really want here is a full-blown mesh boolean operation. The quad stuff is
 	// only here as an early shortcut because I couldn't find how to do the former.
 
-	// TODO Candidate for temp allocator
-	StdVector<Vector2f> vertices_2d;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<Vector2f> vertices_2d(temp_allocator);
 	vertices_2d.resize(side_surface.positions.size());
 	to_2d(to_span(side_surface.positions), to_span(vertices_2d), side);
 
@@ -523,9 +525,10 @@ void generate_model_cutout_sides(BakedModel &model_data, const uint16_t model_id
 
 			const uint16_t other_side = Cube::g_opposite_side[side];
 
-			// TODO Candidate for temp allocator
-			StdVector<Vector2f> other_all_vertices_2d;
-			StdVector<int32_t> other_all_indices;
+			LinearAllocator &temp_allocator = get_tls_temp_allocator();
+			LinearAllocatorScope temp_scope(temp_allocator);
+			StdTempVector<Vector2f> other_all_vertices_2d(temp_allocator);
+			StdTempVector<int32_t> other_all_indices(temp_allocator);
 			get_side_geometry_2d_all_surfaces(other_model, other_side, other_all_vertices_2d, other_all_indices);
 
 			QuadIndices other_quad_indices;
@@ -7,6 +7,7 @@
 #include "../../util/godot/classes/resource.h"
 #include "../../util/thread/rw_lock.h"
 #include "blocky_baked_library.h"
+#include <atomic>
 
 namespace zylann::voxel {
 
@@ -44,6 +45,10 @@ public:
 	const RWLock &get_baked_data_rw_lock() const {
 		return _baked_data_rw_lock;
 	}
+	// Changes every time the library is baked
+	uint32_t get_baked_version() const {
+		return _baked_version.load(std::memory_order_relaxed);
+	}
 
 	Ref<Material> get_material_by_index(unsigned int index) const;
 	unsigned int get_material_index_count() const;
@@ -68,6 +73,7 @@ protected:
 	// Used in multithread context by the mesher. Don't modify that outside of bake().
 	RWLock _baked_data_rw_lock;
 	blocky::BakedLibrary _baked_data;
+	std::atomic_uint32_t _baked_version = { 0 };
 	// One of the entries can be null to represent "The default material". If all non-empty models have materials, there
 	// won't be a null entry.
 	StdVector<Ref<Material>> _indexed_materials;
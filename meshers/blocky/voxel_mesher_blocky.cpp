@@ -506,6 +506,7 @@ VoxelMesherBlocky::Cache &VoxelMesherBlocky::get_tls_cache() {
 void VoxelMesherBlocky::set_library(Ref<VoxelBlockyLibraryBase> library) {
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.library = library;
+	increment_settings_version();
 }
 
 Ref<VoxelBlockyLibraryBase> VoxelMesherBlocky::get_library() const {
@@ -516,6 +517,7 @@ Ref<VoxelBlockyLibraryBase> VoxelMesherBlocky::get_library() const {
 void VoxelMesherBlocky::set_occlusion_darkness(float darkness) {
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.baked_occlusion_darkness = math::clamp(darkness, 0.0f, 1.0f);
+	increment_settings_version();
 }
 
 float VoxelMesherBlocky::get_occlusion_darkness() const {
@@ -526,6 +528,7 @@ float VoxelMesherBlocky::get_occlusion_darkness() const {
 void VoxelMesherBlocky::set_occlusion_enabled(bool enable) {
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.bake_occlusion = enable;
+	increment_settings_version();
 }
 
 bool VoxelMesherBlocky::get_occlusion_enabled() const {
@@ -540,6 +543,7 @@ void VoxelMesherBlocky::set_shadow_occluder_side(Side side, bool enabled) {
 	} else {
 		_parameters.shadow_occluders_mask &= ~(1 << side);
 	}
+	increment_settings_version();
 }
 
 bool VoxelMesherBlocky::get_shadow_occluder_side(Side side) const {
@@ -561,6 +565,7 @@ void VoxelMesherBlocky::set_tint_mode(const VoxelMesherBlocky::TintMode new_mode
 	ZN_ASSERT_RETURN(new_mode >= 0 && new_mode < TINT_MODE_COUNT);
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.tint_mode = new_mode;
+	increment_settings_version();
 }
 
 void VoxelMesherBlocky::build(VoxelMesher::Output &output, const VoxelMesher::Input &input) {
@@ -803,6 +808,7 @@ void VoxelMesherBlocky::build(VoxelMesher::Output &output, const VoxelMesher::In
 	}
 
 	output.primitive_type = Mesh::PRIMITIVE_TRIANGLES;
+	output.mesh_flags = get_attribute_compression_flags();
 }
 
 // Ref<Resource> VoxelMesherBlocky::duplicate(bool p_subresources) const {
@@ -837,6 +843,13 @@ int VoxelMesherBlocky::get_used_channels_mask() const {
 	return mask;
 }
 
+uint64_t VoxelMesherBlocky::get_settings_version() const {
+	// The library can be baked again without being re-assigned
+	Ref<VoxelBlockyLibraryBase> lib = get_library();
+	const uint64_t library_version = lib.is_valid() ? lib->get_baked_version() : 0;
+	return (VoxelMesher::get_settings_version() << 32) ^ library_version;
+}
+
 Ref<Material> VoxelMesherBlocky::get_material_by_index(unsigned int index) const {
 	Ref<VoxelBlockyLibraryBase> lib = get_library();
 	if (lib.is_null()) {
@@ -69,6 +69,8 @@ public:
 
 	int get_used_channels_mask() const override;
 
+	uint64_t get_settings_version() const override;
+
 	bool supports_lod() const override {
 		return true;
 	}
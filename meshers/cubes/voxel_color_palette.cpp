@@ -18,6 +18,7 @@ VoxelColorPalette::VoxelColorPalette() {
 void VoxelColorPalette::set_color(int index, Color color) {
 	ERR_FAIL_INDEX(index, static_cast<int>(_colors.size()));
 	_colors[index] = Color8(color);
+	++_version;
 }
 
 Color VoxelColorPalette::get_color(int index) const {
@@ -41,12 +42,14 @@ void VoxelColorPalette::set_colors(PackedColorArray colors) {
 	for (unsigned int i = 0; i < _colors.size(); ++i) {
 		_colors[i] = Color8(colors[i]);
 	}
+	++_version;
 }
 
 void VoxelColorPalette::clear() {
 	for (size_t i = 0; i < _colors.size(); ++i) {
 		_colors[i] = Color8();
 	}
+	++_version;
 }
 
 PackedInt32Array VoxelColorPalette::_b_get_data() const {
@@ -64,6 +67,7 @@ void VoxelColorPalette::_b_set_data(PackedInt32Array colors) {
 	for (int i = 0; i < colors.size(); ++i) {
 		_colors[i] = Color8::from_u32(colors[i]);
 	}
+	++_version;
 }
 
 void VoxelColorPalette::_bind_methods() {
@@ -4,6 +4,7 @@
 #include "../../util/containers/fixed_array.h"
 #include "../../util/godot/classes/resource.h"
 #include "../../util/math/color8.h"
+#include <atomic>
 
 namespace zylann::voxel {
 
@@ -27,12 +28,18 @@ public:
 
 	inline void set_color8(uint8_t i, Color8 c) {
 		_colors[i] = c;
+		++_version;
 	}
 
 	inline Color8 get_color8(uint8_t i) const {
 		return _colors[i];
 	}
 
+	// Changes every time colors are modified
+	inline uint32_t get_version() const {
+		return _version.load(std::memory_order_relaxed);
+	}
+
 private:
 	PackedInt32Array _b_get_data() const;
 	void _b_set_data(PackedInt32Array colors);
@@ -40,6 +47,7 @@ private:
 	static void _bind_methods();
 
 	FixedArray<Color8, MAX_COLORS> _colors;
+	std::atomic_uint32_t _version = { 0 };
 };
 
 } // namespace zylann::voxel
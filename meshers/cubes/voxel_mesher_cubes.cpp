@@ -1050,6 +1050,7 @@ void VoxelMesherCubes::build(VoxelMesher::Output &output, const VoxelMesher::Inp
 	}
 
 	output.primitive_type = Mesh::PRIMITIVE_TRIANGLES;
+	output.mesh_flags = get_attribute_compression_flags();
 	output.atlas_image = atlas_image;
 
 	// if (params.store_colors_in_texture) {
@@ -1062,6 +1063,7 @@ void VoxelMesherCubes::build(VoxelMesher::Output &output, const VoxelMesher::Inp
 void VoxelMesherCubes::set_greedy_meshing_enabled(bool enable) {
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.greedy_meshing = enable;
+	increment_settings_version();
 }
 
 bool VoxelMesherCubes::is_greedy_meshing_enabled() const {
@@ -1072,6 +1074,7 @@ bool VoxelMesherCubes::is_greedy_meshing_enabled() const {
 void VoxelMesherCubes::set_palette(Ref<VoxelColorPalette> palette) {
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.palette = palette;
+	increment_settings_version();
 }
 
 Ref<VoxelColorPalette> VoxelMesherCubes::get_palette() const {
@@ -1083,6 +1086,7 @@ void VoxelMesherCubes::set_color_mode(ColorMode mode) {
 	ERR_FAIL_INDEX(mode, COLOR_MODE_COUNT);
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.color_mode = mode;
+	increment_settings_version();
 }
 
 VoxelMesherCubes::ColorMode VoxelMesherCubes::get_color_mode() const {
@@ -1093,6 +1097,7 @@ VoxelMesherCubes::ColorMode VoxelMesherCubes::get_color_mode() const {
 void VoxelMesherCubes::set_store_colors_in_texture(bool enable) {
 	RWLockWrite wlock(_parameters_lock);
 	_parameters.store_colors_in_texture = enable;
+	increment_settings_version();
 }
 
 bool VoxelMesherCubes::get_store_colors_in_texture() const {
@@ -1121,6 +1126,13 @@ int VoxelMesherCubes::get_used_channels_mask() const {
 	return (1 << VoxelBuffer::CHANNEL_COLOR);
 }
 
+uint64_t VoxelMesherCubes::get_settings_version() const {
+	// Colors of the palette can be modified without re-assigning it
+	Ref<VoxelColorPalette> palette = get_palette();
+	const uint64_t palette_version = palette.is_valid() ? palette->get_version() : 0;
+	return (VoxelMesher::get_settings_version() << 32) ^ palette_version;
+}
+
 void VoxelMesherCubes::set_material_by_index(Materials id, Ref<Material> material) {
 	ERR_FAIL_INDEX(id, int(_materials.size()));
 	_materials[id] = material;
@@ -61,6 +61,8 @@ public:
 
 	int get_used_channels_mask() const override;
 
+	uint64_t get_settings_version() const override;
+
 	void set_store_colors_in_texture(bool enable);
 	bool get_store_colors_in_texture() const;
 
@@ -0,0 +1,188 @@
+#include "mesh_block_cache.h"
+#include "../storage/voxel_buffer.h"
+#include "../util/hash_funcs.h"
+#include "../util/memory/linear_allocator.h"
+#include "../util/profiling.h"
+#include <algorithm>
+
+namespace zylann::voxel {
+
+namespace {
+
+size_t get_output_size_in_bytes(const VoxelMesher::Output &output) {
+	size_t size = sizeof(VoxelMesher::Output);
+
+	for (const VoxelMesher::Output::Surface &surface : output.surfaces) {
+		size += zylann::godot::get_surface_size_in_bytes(surface.arrays);
+#ifdef ZN_GODOT_PACKED_SURFACES
+		if (surface.is_packed) {
+			size += surface.packed.vertex_data.size() + surface.packed.attribute_data.size() +
+					surface.packed.skin_data.size() + surface.packed.index_data.size();
+		}
+#endif
+	}
+	for (const StdVector<VoxelMesher::Output::Surface> &surfaces : output.transition_surfaces) {
+		for (const VoxelMesher::Output::Surface &surface : surfaces) {
+			size += zylann::godot::get_surface_size_in_bytes(surface.arrays);
+		}
+	}
+
+	size += output.collision_surface.positions.size() * sizeof(Vector3f);
+	size += output.collision_surface.indices.size() * sizeof(int);
+	size += zylann::godot::get_surface_size_in_bytes(output.shadow_occluder);
+
+	return size;
+}
+
+// Arrays are shared by reference, so they are duplicated to prevent users of a result from modifying what is in the
+// cache. Arrays they contain are copy-on-write, so this is cheap.
+void duplicate_surface_arrays(StdVector<VoxelMesher::Output::Surface> &surfaces) {
+	for (VoxelMesher::Output::Surface &surface : surfaces) {
+		surface.arrays = surface.arrays.duplicate();
+	}
+}
+
+void copy_output(const VoxelMesher::Output &src, VoxelMesher::Output &dst) {
+	dst = src;
+	duplicate_surface_arrays(dst.surfaces);
+	for (StdVector<VoxelMesher::Output::Surface> &surfaces : dst.transition_surfaces) {
+		duplicate_surface_arrays(surfaces);
+	}
+	dst.shadow_occluder = src.shadow_occluder.duplicate();
+}
+
+} // namespace
+
+void MeshBlockCache::set_capacity(size_t capacity_in_bytes) {
+	MutexLock mlock(_mutex);
+	_capacity = capacity_in_bytes;
+	_enabled.store(capacity_in_bytes > 0, std::memory_order_relaxed);
+	evict_no_lock(_capacity);
+}
+
+size_t MeshBlockCache::get_capacity() const {
+	MutexLock mlock(_mutex);
+	return _capacity;
+}
+
+bool MeshBlockCache::try_get(const Key &key, VoxelMesher::Output &out_output) {
+	ZN_PROFILE_SCOPE();
+	MutexLock mlock(_mutex);
+
+	auto it = _entries.find(key);
+	if (it == _entries.end()) {
+		return false;
+	}
+
+	Entry &entry = it->second;
+	entry.last_use = ++_use_counter;
+	copy_output(entry.output, out_output);
+	return true;
+}
+
+void MeshBlockCache::put(const Key &key, const VoxelMesher::Output &output) {
+	ZN_PROFILE_SCOPE();
+
+	// Done before locking, since it can be a bit expensive
+	const size_t size_in_bytes = get_output_size_in_bytes(output);
+
+	MutexLock mlock(_mutex);
+
+	if (size_in_bytes > _capacity) {
+		// Would not fit, or the cache is disabled
+		return;
+	}
+
+	Entry &entry = _entries[key];
+	_size_in_bytes -= entry.size_in_bytes;
+	copy_output(output, entry.output);
+	entry.size_in_bytes = size_in_bytes;
+	entry.last_use = ++_use_counter;
+	_size_in_bytes += size_in_bytes;
+
+	if (_size_in_bytes > _capacity) {
+		// Evict more than needed, so it doesn't have to be done again for every new entry
+		evict_no_lock(_capacity - _capacity / 4);
+	}
+}
+
+void MeshBlockCache::evict_no_lock(size_t target_size) {
+	if (_size_in_bytes <= target_size) {
+		return;
+	}
+	ZN_PROFILE_SCOPE();
+
+	struct EntryUse {
+		uint64_t last_use;
+		Key key;
+	};
+
+	LinearAllocator &allocator = get_tls_temp_allocator();
+	LinearAllocatorScope las(allocator);
+	StdTempVector<EntryUse> entries(allocator);
+	entries.reserve(_entries.size());
+
+	for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+		entries.push_back({ it->second.last_use, it->first });
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const EntryUse &a, const EntryUse &b) {
+		return a.last_use < b.last_use;
+	});
+
+	for (const EntryUse &eu : entries) {
+		if (_size_in_bytes <= target_size) {
+			break;
+		}
+		auto it = _entries.find(eu.key);
+		ZN_ASSERT_CONTINUE(it != _entries.end());
+		_size_in_bytes -= it->second.size_in_bytes;
+		_entries.erase(it);
+	}
+}
+
+void MeshBlockCache::clear() {
+	MutexLock mlock(_mutex);
+	_entries.clear();
+	_size_in_bytes = 0;
+}
+
+size_t MeshBlockCache::get_size_in_bytes() const {
+	MutexLock mlock(_mutex);
+	return _size_in_bytes;
+}
+
+unsigned int MeshBlockCache::get_entry_count() const {
+	MutexLock mlock(_mutex);
+	return _entries.size();
+}
+
+uint64_t MeshBlockCache::hash_voxels(const VoxelBuffer &voxels, uint32_t channels_mask) {
+	ZN_PROFILE_SCOPE();
+
+	const Vector3i size = voxels.get_size();
+	uint64_t h = hash_djb2_one_64(size.x);
+	h = hash_djb2_one_64(size.y, h);
+	h = hash_djb2_one_64(size.z, h);
+
+	for (unsigned int channel_index = 0; channel_index < VoxelBuffer::MAX_CHANNELS; ++channel_index) {
+		if ((channels_mask & (1 << channel_index)) == 0) {
+			continue;
+		}
+
+		h = hash_djb2_one_64(voxels.get_channel_depth(channel_index), h);
+
+		if (voxels.is_uniform(channel_index)) {
+			h = hash_djb2_one_64(voxels.get_voxel(Vector3i(), channel_index), h);
+
+		} else {
+			Span<const uint8_t> data;
+			ZN_ASSERT_CONTINUE(voxels.get_channel_as_bytes_read_only(channel_index, data));
+			h = hash_murmur64a_buffer(data.data(), data.size(), h);
+		}
+	}
+
+	return h;
+}
+
+} // namespace zylann::voxel
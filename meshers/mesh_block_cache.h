@@ -0,0 +1,93 @@
+#ifndef VOXEL_MESH_BLOCK_CACHE_H
+#define VOXEL_MESH_BLOCK_CACHE_H
+
+#include "../util/containers/std_unordered_map.h"
+#include "../util/math/vector3i.h"
+#include "../util/thread/mutex.h"
+#include "voxel_mesher.h"
+#include <atomic>
+
+namespace zylann::voxel {
+
+class VoxelBuffer;
+
+// Keeps results of recent meshing tasks, so meshes of blocks that didn't change can be re-used instead of being
+// rebuilt when they come back into view, or when LODs change back and forth.
+// Results are identified by the content of the voxels they were built from and the version of mesher settings, so edits
+// and changes of mesher properties naturally cause misses. It is expected to be owned by something that is re-created
+// when the mesher or generator changes.
+// Memory usage is bounded. When full, least recently used results are removed first.
+// It is thread-safe.
+class MeshBlockCache {
+public:
+	enum KeyFlags : uint8_t {
+		KEY_FLAG_COLLISION_HINT = 1,
+		KEY_FLAG_LOD_HINT = 2,
+	};
+
+	struct Key {
+		// Hash of the voxels given to the mesher, including padding
+		uint64_t voxels_hash = 0;
+		// Changes when properties of the mesher change, see `VoxelMesher::get_settings_version`
+		uint64_t settings_version = 0;
+		// Position of the block is included because some meshers produce results depending on it
+		Vector3i position;
+		uint8_t lod_index = 0;
+		uint8_t flags = 0;
+
+		inline bool operator==(const Key &other) const {
+			return voxels_hash == other.voxels_hash && settings_version == other.settings_version &&
+					position == other.position && lod_index == other.lod_index && flags == other.flags;
+		}
+	};
+
+	// Capacity is in bytes. 0 means disabled.
+	void set_capacity(size_t capacity_in_bytes);
+	size_t get_capacity() const;
+
+	inline bool is_enabled() const {
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	// If found, copies the cached result into the output and returns true.
+	bool try_get(const Key &key, VoxelMesher::Output &out_output);
+
+	// Stores a copy of the given result.
+	void put(const Key &key, const VoxelMesher::Output &output);
+
+	void clear();
+
+	size_t get_size_in_bytes() const;
+	unsigned int get_entry_count() const;
+
+	// Hashes channels of the given voxels, where `channels_mask` has one bit per channel index.
+	static uint64_t hash_voxels(const VoxelBuffer &voxels, uint32_t channels_mask);
+
+private:
+	struct KeyHasher {
+		inline size_t operator()(const Key &key) const {
+			return key.voxels_hash ^ hash_djb2_one_64(key.settings_version) ^ Vector3iHasher::hash(key.position) ^
+					(uint64_t(key.lod_index) << 8) ^ key.flags;
+		}
+	};
+
+	struct Entry {
+		VoxelMesher::Output output;
+		size_t size_in_bytes = 0;
+		uint64_t last_use = 0;
+	};
+
+	void evict_no_lock(size_t target_size);
+
+	StdUnorderedMap<Key, Entry, KeyHasher> _entries;
+	size_t _capacity = 0;
+	size_t _size_in_bytes = 0;
+	// Incremented on every access, used to know which entries were used least recently
+	uint64_t _use_counter = 0;
+	std::atomic_bool _enabled = { false };
+	Mutex _mutex;
+};
+
+} // namespace zylann::voxel
+
+#endif // VOXEL_MESH_BLOCK_CACHE_H
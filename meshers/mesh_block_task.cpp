@@ -5,6 +5,7 @@
 #include "../util/godot/classes/mesh.h"
 #include "../util/io/log.h"
 #include "../util/math/conv.h"
+#include "../util/memory/linear_allocator.h"
 #include "../util/profiling.h"
 // #include "../util/string/format.h" // Debug
 #include "../engine/voxel_engine.h"
@@ -61,7 +62,7 @@ CubicAreaInfo get_cubic_area_info_from_size(unsigned int size) {
 // Voxels from central blocks are copied, and part of side blocks are also copied so we get a temporary buffer
 // which includes enough neighbors for the mesher to avoid doing bound checks.
 void copy_block_and_neighbors(
-		Span<std::shared_ptr<VoxelBuffer>> blocks,
+		Span<const std::shared_ptr<const VoxelBuffer>> blocks,
 		VoxelBuffer &dst,
 		int min_padding,
 		int max_padding,
@@ -83,7 +84,7 @@ void copy_block_and_neighbors(
 	const CubicAreaInfo area_info = get_cubic_area_info_from_size(blocks.size());
 	ERR_FAIL_COND(!area_info.is_valid());
 
-	std::shared_ptr<VoxelBuffer> &central_buffer = blocks[area_info.anchor_buffer_index];
+	const std::shared_ptr<const VoxelBuffer> &central_buffer = blocks[area_info.anchor_buffer_index];
 	ERR_FAIL_COND_MSG(central_buffer == nullptr && generator.is_null(), "Central buffer must be valid");
 	if (central_buffer != nullptr) {
 		ERR_FAIL_COND_MSG(
@@ -112,10 +113,11 @@ void copy_block_and_neighbors(
 	const Vector3i origin_in_voxels_lod0 = origin_in_voxels << lod_index;
 
 	// These boxes are initially relative to the minimum corner of the minimum chunk.
-	// TODO Candidate for temp allocator (or SmallVector?)
-	StdVector<Box3i> boxes_to_generate;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<Box3i> boxes_to_generate(temp_allocator);
 	const Box3i mesh_data_box = Box3i::from_min_max(min_pos, max_pos);
-	if (contains(blocks.to_const(), std::shared_ptr<VoxelBuffer>())) {
+	if (contains(blocks, std::shared_ptr<const VoxelBuffer>())) {
 		const Box3i bounds_local(bounds_in_voxels.position - origin_in_voxels_without_padding, bounds_in_voxels.size);
 		const Box3i box = mesh_data_box.clipped(bounds_local); // Prevent generation outside fixed bounds
 		if (!box.is_empty()) {
@@ -127,13 +129,7 @@ void copy_block_and_neighbors(
 		// TODO The following logic might as well be simplified and moved to VoxelData.
 		// We are just sampling or generating data in a given area.
 
-		const Vector3i data_block_pos0 = mesh_block_pos * area_info.mesh_block_size_factor;
-		SpatialLock3D::Read srlock(
-				voxel_data.get_spatial_lock(lod_index),
-				BoxBounds3i(
-						data_block_pos0 - Vector3i(1, 1, 1), data_block_pos0 + Vector3iUtil::create(area_info.edge_size)
-				)
-		);
+		// No locking needed, blocks are snapshots which don't change while we reference them.
 
 		// Using ZXY as convention to reconstruct positions with thread locking consistency
 		unsigned int block_index = 0;
@@ -141,7 +137,7 @@ void copy_block_and_neighbors(
 			for (int x = -1; x < area_info.edge_size - 1; ++x) {
 				for (int y = -1; y < area_info.edge_size - 1; ++y) {
 					const Vector3i offset = data_block_size * Vector3i(x, y, z);
-					const std::shared_ptr<VoxelBuffer> &src = blocks[block_index];
+					const std::shared_ptr<const VoxelBuffer> &src = blocks[block_index];
 					++block_index;
 
 					if (src == nullptr) {
@@ -230,6 +226,32 @@ void copy_block_and_neighbors(
 	}
 }
 
+#ifdef ZN_GODOT_PACKED_SURFACES
+
+void pack_surfaces(VoxelMesher::Output &output) {
+	ZN_PROFILE_SCOPE();
+
+	for (VoxelMesher::Output::Surface &surface : output.surfaces) {
+		if (surface.is_packed || surface.arrays.is_empty() || !zylann::godot::is_surface_triangulated(surface.arrays)) {
+			continue;
+		}
+		surface.is_packed =
+				zylann::godot::pack_surface(surface.arrays, output.primitive_type, output.mesh_flags, surface.packed);
+	}
+}
+
+// Packed surfaces hold a converted copy of their arrays, so keeping both would double the memory used by results
+// waiting to be applied
+void clear_packed_surface_arrays(VoxelMesher::Output &output) {
+	for (VoxelMesher::Output::Surface &surface : output.surfaces) {
+		if (surface.is_packed) {
+			surface.arrays = Array();
+		}
+	}
+}
+
+#endif
+
 } // namespace
 
 Ref<ArrayMesh> build_mesh(
@@ -247,6 +269,19 @@ Ref<ArrayMesh> build_mesh(
 
 	for (unsigned int i = 0; i < surfaces.size(); ++i) {
 		const VoxelMesher::Output::Surface &surface = surfaces[i];
+
+#ifdef ZN_GODOT_PACKED_SURFACES
+		if (surface.is_packed) {
+			// Arrays may have been cleared after packing
+			if (mesh.is_null()) {
+				mesh.instantiate();
+			}
+			zylann::godot::add_packed_surface(**mesh, surface.packed);
+			mesh_material_indices.push_back(surface.material_index);
+			continue;
+		}
+#endif
+
 		Array arrays = surface.arrays;
 
 		if (arrays.is_empty()) {
@@ -262,8 +297,6 @@ Ref<ArrayMesh> build_mesh(
 			mesh.instantiate();
 		}
 
-		// TODO Use `add_surface`, it's about 20% faster after measuring in Tracy (though we may see if Godot 4 expects
-		// the same)
 		mesh->add_surface_from_arrays(primitive, arrays, Array(), Dictionary(), flags);
 
 		mesh_material_indices.push_back(surface.material_index);
@@ -515,25 +548,52 @@ void MeshBlockTask::build_mesh() {
 		// TODO Gathering detail texture information is not always necessary
 		true // detail_texture_hint
 	};
-	mesher->build(_surfaces_output, input);
 
 #ifdef VOXEL_ENABLE_SMOOTH_MESHING
-	const bool mesh_is_empty = VoxelMesher::is_mesh_empty(_surfaces_output.surfaces);
-
 	// Currently, Transvoxel only is supported in combination with detail normalmap texturing, because the algorithm
 	// provides a cheap source for cells subdividing the mesh. It should be possible to obtain cells from any mesh,
 	// but it is more expensive to find them from scratch, and for now Transvoxel is the most viable algorithm for
 	// smooth terrain.
 	Ref<VoxelMesherTransvoxel> transvoxel_mesher;
 
-	if (
-			require_visual //
+	const bool detail_texture_required = require_visual //
 			&& zylann::godot::try_get_as(mesher, transvoxel_mesher) //
 			&& detail_texture_settings.enabled //
-			&& !mesh_is_empty //
 			&& lod_index >= detail_texture_settings.begin_lod_index //
-			&& require_detail_texture //
-	) {
+			&& require_detail_texture;
+#endif
+
+	MeshBlockCache &mesh_cache = meshing_dependency->mesh_cache;
+	const bool use_mesh_cache = mesh_cache.is_enabled();
+	MeshBlockCache::Key mesh_cache_key;
+	bool mesh_cache_hit = false;
+
+	if (use_mesh_cache) {
+		mesh_cache_key.voxels_hash = MeshBlockCache::hash_voxels(_voxels, mesher->get_used_channels_mask());
+		mesh_cache_key.settings_version = mesher->get_settings_version();
+		mesh_cache_key.position = mesh_block_position;
+		mesh_cache_key.lod_index = lod_index;
+		mesh_cache_key.flags = (collision_hint ? MeshBlockCache::KEY_FLAG_COLLISION_HINT : 0) |
+				(lod_hint ? MeshBlockCache::KEY_FLAG_LOD_HINT : 0);
+
+#ifdef VOXEL_ENABLE_SMOOTH_MESHING
+		// Detail textures are computed from intermediate data the mesher leaves in the current thread, so it has to
+		// run anyways
+		if (!detail_texture_required)
+#endif
+		{
+			mesh_cache_hit = mesh_cache.try_get(mesh_cache_key, _surfaces_output);
+		}
+	}
+
+	if (!mesh_cache_hit) {
+		mesher->build(_surfaces_output, input);
+	}
+
+#ifdef VOXEL_ENABLE_SMOOTH_MESHING
+	const bool mesh_is_empty = VoxelMesher::is_mesh_empty(_surfaces_output.surfaces);
+
+	if (detail_texture_required && !mesh_is_empty) {
 		ZN_PROFILE_SCOPE_NAMED("Schedule detail render");
 
 		const transvoxel::MeshArrays &mesh_arrays = VoxelMesherTransvoxel::get_mesh_cache_from_current_thread();
@@ -596,8 +656,27 @@ void MeshBlockTask::build_mesh() {
 
 	} else {
 		_has_mesh_resource = false;
+
+#ifdef ZN_GODOT_PACKED_SURFACES
+		if (require_visual) {
+			// The mesh resource has to be created on the main thread, but converting surfaces into renderer buffers
+			// can be done here, so less work remains to do there
+			pack_surfaces(_surfaces_output);
+		}
+#endif
 	}
 
+	if (use_mesh_cache && !mesh_cache_hit) {
+		mesh_cache.put(mesh_cache_key, _surfaces_output);
+	}
+
+#ifdef ZN_GODOT_PACKED_SURFACES
+	// Done after caching, because other requests hitting the cache may need the arrays
+	if (!surface_arrays_required) {
+		clear_packed_surface_arrays(_surfaces_output);
+	}
+#endif
+
 	_has_run = true;
 }
 
@@ -50,8 +50,8 @@ public:
 
 	static int debug_get_running_count();
 
-	// 3x3x3 or 4x4x4 grid of voxel blocks.
-	FixedArray<std::shared_ptr<VoxelBuffer>, constants::MAX_BLOCK_COUNT_PER_REQUEST> blocks;
+	// 3x3x3 or 4x4x4 grid of voxel blocks. They are snapshots, so they can be read without locking.
+	FixedArray<std::shared_ptr<const VoxelBuffer>, constants::MAX_BLOCK_COUNT_PER_REQUEST> blocks;
 	// TODO Need to provide format
 	// FixedArray<uint8_t, VoxelBuffer::MAX_CHANNELS> channel_depths;
 	Vector3i mesh_block_position; // In mesh blocks of the specified lod
@@ -65,6 +65,9 @@ public:
 	// If true, the mesh will be used in a context with LOD, which might require a few extra things in the way it is
 	// built
 	bool lod_hint = false;
+	// If false, surface arrays are only needed for rendering, so they can be released once converted into renderer
+	// buffers. Collision and instancing read them.
+	bool surface_arrays_required = true;
 	// Detail textures might be enabled, but we don't always want to update them in every mesh update.
 	// So this boolean is also checked to know if they should be computed.
 	bool require_detail_texture = false;
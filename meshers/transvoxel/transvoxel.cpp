@@ -4,6 +4,7 @@
 #include "../../util/godot/core/sort_array.h"
 #include "../../util/math/conv.h"
 #include "../../util/math/funcs.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 #include "transvoxel_materials_mixel4.h"
 #include "transvoxel_materials_null.h"
@@ -1089,8 +1090,12 @@ void build_transition_mesh(
 	} // for y
 }
 
-template <typename T>
-Span<const T> get_or_decompress_channel(const VoxelBuffer &voxels, StdVector<T> &backing_buffer, unsigned int channel) {
+template <typename T, typename TAllocator>
+Span<const T> get_or_decompress_channel(
+		const VoxelBuffer &voxels,
+		StdVector<T, TAllocator> &backing_buffer,
+		unsigned int channel
+) {
 	//
 	ZN_ASSERT_RETURN_V(
 			voxels.get_channel_depth(channel) == VoxelBuffer::get_depth_from_size(sizeof(T)), Span<const T>()
@@ -1152,18 +1157,6 @@ Span<const Sdf_T> apply_zero_sdf_fix(Span<const Sdf_T> p_sdf_data) {
 	return to_span_const(sdf_data);
 }*/
 
-// TODO Candidate for temp allocator
-StdVector<uint16_t> &get_tls_weights_backing_buffer_u16() {
-	thread_local StdVector<uint16_t> tls_weights_backing_buffer_u16;
-	return tls_weights_backing_buffer_u16;
-}
-
-// TODO Candidate for temp allocator
-StdVector<uint8_t> &get_tls_u8_conversion_buffer() {
-	static thread_local StdVector<uint8_t> tls_conversion_backing_buffer;
-	return tls_conversion_backing_buffer;
-}
-
 template <typename TMaterialProcessor>
 inline void build_regular_mesh_dispatch_sd(
 		const VoxelBuffer &voxels,
@@ -1257,6 +1250,9 @@ DefaultTextureIndicesData build_regular_mesh(
 
 	const unsigned int voxels_count = Vector3iUtil::get_volume_u64(voxels.get_size());
 
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+
 	output.clear();
 
 	DefaultTextureIndicesData default_texture_indices;
@@ -1277,6 +1273,7 @@ DefaultTextureIndicesData build_regular_mesh(
 			break;
 
 		case TEXTURES_MIXEL4_S4: {
+			StdTempVector<uint16_t> weights_backing_buffer(temp_allocator);
 			materials::mixel4::TextureIndicesData voxel_material_indices;
 			materials::mixel4::WeightSamplerPackedU16 voxel_material_weights;
 			{
@@ -1289,8 +1286,7 @@ DefaultTextureIndicesData build_regular_mesh(
 				);
 				voxel_material_weights.u16_data = get_or_decompress_channel(
 						voxels,
-						// TODO Candidate for Temp allocator
-						get_tls_weights_backing_buffer_u16(),
+						weights_backing_buffer,
 						VoxelBuffer::CHANNEL_WEIGHTS
 				);
 				ZN_ASSERT_RETURN_V(voxel_material_weights.u16_data.size() == voxels_count, default_texture_indices);
@@ -1313,9 +1309,10 @@ DefaultTextureIndicesData build_regular_mesh(
 		} break;
 
 		case TEXTURES_SINGLE_S4: {
+			StdTempVector<uint8_t> conversion_buffer(temp_allocator);
 			const materials::single::VoxelMaterialIndices voxel_material_indices =
 					materials::single::get_material_indices_from_vb(
-							voxels, VoxelBuffer::CHANNEL_INDICES, get_tls_u8_conversion_buffer()
+							voxels, VoxelBuffer::CHANNEL_INDICES, conversion_buffer
 					);
 			if (voxel_material_indices.is_uniform) {
 				default_texture_indices.indices[0] = voxel_material_indices.uniform_value;
@@ -1335,9 +1332,10 @@ DefaultTextureIndicesData build_regular_mesh(
 
 #ifdef VOXEL_ENABLE_TRANSVOXEL_MATERIAL_SINGLE_S2
 		case TEXTURES_SINGLE_S2: {
+			StdTempVector<uint8_t> conversion_buffer(temp_allocator);
 			const materials::single::VoxelMaterialIndices voxel_material_indices =
 					materials::single::get_material_indices_from_vb(
-							voxels, VoxelBuffer::CHANNEL_INDICES, get_tls_u8_conversion_buffer()
+							voxels, VoxelBuffer::CHANNEL_INDICES, conversion_buffer
 					);
 			if (voxel_material_indices.is_uniform) {
 				default_texture_indices.indices[0] = voxel_material_indices.uniform_value;
@@ -1449,6 +1447,9 @@ void build_transition_mesh(
 
 	const unsigned int voxels_count = Vector3iUtil::get_volume_u64(voxels.get_size());
 
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+
 	switch (texturing_mode) {
 		case TEXTURES_NONE:
 			build_transition_mesh_dispatch_sd(
@@ -1464,6 +1465,7 @@ void build_transition_mesh(
 			break;
 
 		case TEXTURES_MIXEL4_S4: {
+			StdTempVector<uint16_t> weights_backing_buffer(temp_allocator);
 			materials::mixel4::TextureIndicesData indices_data;
 			materials::mixel4::WeightSamplerPackedU16 weights_data;
 
@@ -1480,8 +1482,7 @@ void build_transition_mesh(
 			}
 			weights_data.u16_data = get_or_decompress_channel(
 					voxels,
-					// TODO Candidate for Temp allocator
-					get_tls_weights_backing_buffer_u16(),
+					weights_backing_buffer,
 					VoxelBuffer::CHANNEL_WEIGHTS
 			);
 			ZN_ASSERT_RETURN(weights_data.u16_data.size() == voxels_count);
@@ -1501,13 +1502,14 @@ void build_transition_mesh(
 		} break;
 
 		case TEXTURES_SINGLE_S4: {
+			StdTempVector<uint8_t> conversion_buffer(temp_allocator);
 			materials::single::VoxelMaterialIndices voxel_material_indices;
 			if (default_texture_indices_data.use) {
 				voxel_material_indices.is_uniform = true;
 				voxel_material_indices.uniform_value = default_texture_indices_data.indices[0];
 			} else {
 				voxel_material_indices = materials::single::get_material_indices_from_vb(
-						voxels, VoxelBuffer::CHANNEL_INDICES, get_tls_u8_conversion_buffer()
+						voxels, VoxelBuffer::CHANNEL_INDICES, conversion_buffer
 				);
 			}
 			build_transition_mesh_dispatch_sd(
@@ -1524,13 +1526,14 @@ void build_transition_mesh(
 
 #ifdef VOXEL_ENABLE_TRANSVOXEL_MATERIAL_SINGLE_S2
 		case TEXTURES_SINGLE_S2: {
+			StdTempVector<uint8_t> conversion_buffer(temp_allocator);
 			materials::single::VoxelMaterialIndices voxel_material_indices;
 			if (default_texture_indices_data.use) {
 				voxel_material_indices.is_uniform = true;
 				voxel_material_indices.uniform_value = default_texture_indices_data.indices[0];
 			} else {
 				voxel_material_indices = materials::single::get_material_indices_from_vb(
-						voxels, VoxelBuffer::CHANNEL_INDICES, get_tls_u8_conversion_buffer()
+						voxels, VoxelBuffer::CHANNEL_INDICES, conversion_buffer
 				);
 			}
 			build_transition_mesh_dispatch_sd(
@@ -41,10 +41,11 @@ struct VoxelMaterialIndices {
 	}
 };
 
+template <typename TAllocator>
 VoxelMaterialIndices get_material_indices_from_vb(
 		const VoxelBuffer &voxels,
 		const unsigned int channel,
-		StdVector<uint8_t> &conversion_buffer
+		StdVector<uint8_t, TAllocator> &conversion_buffer
 ) {
 	ZN_ASSERT_RETURN_V(voxels.get_channel_depth(channel) == VoxelBuffer::DEPTH_8_BIT, VoxelMaterialIndices());
 
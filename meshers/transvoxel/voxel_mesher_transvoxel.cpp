@@ -384,6 +384,8 @@ void VoxelMesherTransvoxel::build(VoxelMesher::Output &output, const VoxelMesher
 
 	// Transvoxel transitions data
 	output.mesh_flags = (RenderingServerEnums::ARRAY_CUSTOM_RGBA_FLOAT << Mesh::ARRAY_FORMAT_CUSTOM0_SHIFT);
+	// Custom attributes are left as they are when compressing
+	output.mesh_flags |= get_attribute_compression_flags();
 
 	// Texture data
 	switch (texture_mode) {
@@ -447,6 +449,7 @@ void VoxelMesherTransvoxel::set_texturing_mode(TexturingMode mode) {
 	ZN_ASSERT_RETURN(mode >= 0 && mode < TEXTURES_MODE_COUNT);
 	if (mode != _texture_mode) {
 		_texture_mode = mode;
+		increment_settings_version();
 		emit_changed();
 	}
 }
@@ -457,6 +460,7 @@ VoxelMesherTransvoxel::TexturingMode VoxelMesherTransvoxel::get_texturing_mode()
 
 void VoxelMesherTransvoxel::set_textures_ignore_air_voxels(const bool enable) {
 	_textures_ignore_air_voxels = enable;
+	increment_settings_version();
 }
 
 bool VoxelMesherTransvoxel::get_textures_ignore_air_voxels() const {
@@ -465,6 +469,7 @@ bool VoxelMesherTransvoxel::get_textures_ignore_air_voxels() const {
 
 void VoxelMesherTransvoxel::set_mesh_optimization_enabled(bool enabled) {
 	_mesh_optimization_params.enabled = enabled;
+	increment_settings_version();
 }
 
 bool VoxelMesherTransvoxel::is_mesh_optimization_enabled() const {
@@ -473,6 +478,7 @@ bool VoxelMesherTransvoxel::is_mesh_optimization_enabled() const {
 
 void VoxelMesherTransvoxel::set_mesh_optimization_error_threshold(float threshold) {
 	_mesh_optimization_params.error_threshold = math::clamp(threshold, 0.f, 1.f);
+	increment_settings_version();
 }
 
 float VoxelMesherTransvoxel::get_mesh_optimization_error_threshold() const {
@@ -481,6 +487,7 @@ float VoxelMesherTransvoxel::get_mesh_optimization_error_threshold() const {
 
 void VoxelMesherTransvoxel::set_mesh_optimization_target_ratio(float ratio) {
 	_mesh_optimization_params.target_ratio = math::clamp(ratio, 0.f, 1.f);
+	increment_settings_version();
 }
 
 float VoxelMesherTransvoxel::get_mesh_optimization_target_ratio() const {
@@ -489,6 +496,7 @@ float VoxelMesherTransvoxel::get_mesh_optimization_target_ratio() const {
 
 void VoxelMesherTransvoxel::set_transitions_enabled(bool enable) {
 	_transitions_enabled = enable;
+	increment_settings_version();
 }
 
 bool VoxelMesherTransvoxel::get_transitions_enabled() const {
@@ -501,6 +509,7 @@ Ref<ShaderMaterial> VoxelMesherTransvoxel::get_default_lod_material() const {
 
 void VoxelMesherTransvoxel::set_edge_clamp_margin(float margin) {
 	_edge_clamp_margin = math::clamp(margin, 0.f, 0.5f);
+	increment_settings_version();
 }
 
 float VoxelMesherTransvoxel::get_edge_clamp_margin() const {
@@ -5,6 +5,7 @@
 #include "../util/godot/classes/array_mesh.h"
 #include "../util/godot/classes/mesh.h"
 #include "../util/godot/classes/shader_material.h"
+#include "../util/godot/core/version.h"
 #include "../util/profiling.h"
 #include "transvoxel/transvoxel_cell_iterator.h"
 
@@ -175,7 +176,12 @@ bool VoxelMesher::is_mesh_empty(const StdVector<Output::Surface> &surfaces) {
 		return true;
 	}
 	for (const Output::Surface &surface : surfaces) {
-		if (is_surface_triangulated(surface.arrays)) {
+#ifdef ZN_GODOT_PACKED_SURFACES
+		if (surface.is_packed) {
+			return false;
+		}
+#endif
+		if (!surface.arrays.is_empty() && is_surface_triangulated(surface.arrays)) {
 			return false;
 		}
 	}
@@ -186,6 +192,25 @@ Ref<ShaderMaterial> VoxelMesher::get_default_lod_material() const {
 	return Ref<ShaderMaterial>();
 }
 
+void VoxelMesher::set_attribute_compression_enabled(bool enabled) {
+	_attribute_compression_enabled.store(enabled, std::memory_order_relaxed);
+	increment_settings_version();
+	emit_changed();
+}
+
+bool VoxelMesher::is_attribute_compression_enabled() const {
+	return _attribute_compression_enabled.load(std::memory_order_relaxed);
+}
+
+uint32_t VoxelMesher::get_attribute_compression_flags() const {
+#if GODOT_VERSION_MAJOR == 4 && GODOT_VERSION_MINOR <= 1
+	// Attribute compression is available since Godot 4.2
+	return 0;
+#else
+	return _attribute_compression_enabled.load(std::memory_order_relaxed) ? Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES : 0;
+#endif
+}
+
 Ref<Mesh> VoxelMesher::_b_build_mesh(
 		Ref<godot::VoxelBuffer> voxels,
 		TypedArray<Material> materials,
@@ -206,6 +231,17 @@ void VoxelMesher::_bind_methods() {
 	);
 	ClassDB::bind_method(D_METHOD("get_minimum_padding"), &VoxelMesher::get_minimum_padding);
 	ClassDB::bind_method(D_METHOD("get_maximum_padding"), &VoxelMesher::get_maximum_padding);
+
+	ClassDB::bind_method(
+			D_METHOD("set_attribute_compression_enabled", "enabled"), &VoxelMesher::set_attribute_compression_enabled
+	);
+	ClassDB::bind_method(D_METHOD("is_attribute_compression_enabled"), &VoxelMesher::is_attribute_compression_enabled);
+
+	ADD_PROPERTY(
+			PropertyInfo(Variant::BOOL, "attribute_compression_enabled"),
+			"set_attribute_compression_enabled",
+			"is_attribute_compression_enabled"
+	);
 }
 
 } // namespace zylann::voxel
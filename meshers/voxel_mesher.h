@@ -8,6 +8,7 @@
 #include "../util/godot/classes/image.h"
 #include "../util/godot/classes/mesh.h"
 #include "../util/macros.h"
+#include <atomic>
 
 ZN_GODOT_FORWARD_DECLARE(class ShaderMaterial)
 
@@ -51,6 +52,12 @@ public:
 		struct Surface {
 			Array arrays;
 			uint16_t material_index = 0;
+#ifdef ZN_GODOT_PACKED_SURFACES
+			// Renderer buffers converted from `arrays` ahead of time, so adding the surface to a mesh is cheaper.
+			// `arrays` may then be cleared, if nothing else than rendering needs them.
+			zylann::godot::PackedSurface packed;
+			bool is_packed = false;
+#endif
 		};
 		StdVector<Surface> surfaces;
 		FixedArray<StdVector<Surface>, Cube::SIDE_COUNT> transition_surfaces;
@@ -130,16 +137,39 @@ public:
 	// Such material is not meant to be modified.
 	virtual Ref<ShaderMaterial> get_default_lod_material() const;
 
+	// If enabled, meshes are uploaded to the renderer with compressed vertex attributes: positions are quantized to 16
+	// bits relative to the mesh's bounding box, and normals are octahedral-encoded. Custom attributes are not affected.
+	void set_attribute_compression_enabled(bool enabled);
+	bool is_attribute_compression_enabled() const;
+
+	// Changes every time a setting affecting results of the mesher changes, including resources it depends on.
+	// Used to tell apart cached results built with previous settings.
+	virtual uint64_t get_settings_version() const {
+		return _settings_version.load(std::memory_order_relaxed);
+	}
+
 protected:
 	Ref<Mesh> _b_build_mesh(Ref<godot::VoxelBuffer> voxels, TypedArray<Material> materials, Dictionary additional_data);
 	static void _bind_methods();
 
 	void set_padding(int minimum, int maximum);
 
+	// Gets flags to add to `Output::mesh_flags` for meshes to use compressed vertex attributes, if enabled.
+	uint32_t get_attribute_compression_flags() const;
+
+	// Must be called by setters of properties affecting results of the mesher
+	inline void increment_settings_version() {
+		++_settings_version;
+	}
+
 private:
 	// Set in constructor and never changed after.
 	unsigned int _minimum_padding = 0;
 	unsigned int _maximum_padding = 0;
+
+	// Atomic because meshing threads read it while the main thread may change it
+	std::atomic_bool _attribute_compression_enabled = { false };
+	std::atomic_uint64_t _settings_version = { 0 };
 };
 
 } // namespace zylann::voxel
@@ -192,6 +192,14 @@
 #include "util/testing/test_options.h"
 #endif
 
+#ifdef VOXEL_BENCHMARKS
+#include "tests/benchmarks/benchmarks.h"
+#include "util/godot/classes/file_access.h"
+#include "util/godot/core/print_string.h"
+#include "util/io/log.h"
+#include "util/testing/test_options.h"
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // This is used to have an idea of the memory footprint of various objects as Godot and Voxel development progresses.
@@ -441,6 +449,45 @@ void initialize_voxel_module(ModuleInitializationLevel p_level) {
 			}
 		}
 #endif
+
+#ifdef VOXEL_BENCHMARKS
+		{
+			const PackedStringArray command_line_arguments = zylann::godot::get_command_line_arguments();
+			const String benchmarks_cmd = "--run_voxel_benchmarks";
+			const String output_cmd_prefix = "--voxel_benchmarks_output=";
+
+			bool run_benchmarks = false;
+			String output_path;
+
+			for (int i = 0; i < command_line_arguments.size(); ++i) {
+				const String arg = command_line_arguments[i];
+				if (arg == benchmarks_cmd) {
+					run_benchmarks = true;
+				} else if (arg.begins_with(output_cmd_prefix)) {
+					output_path = arg.substr(output_cmd_prefix.length());
+				}
+			}
+
+			if (run_benchmarks) {
+				const String json =
+						zylann::voxel::benchmarks::run_voxel_benchmarks(zylann::testing::TestOptions());
+
+				if (output_path.is_empty()) {
+					::print_line(json);
+				} else {
+					Error err;
+					Ref<FileAccess> f = zylann::godot::open_file(output_path, FileAccess::WRITE, err);
+					if (f.is_valid()) {
+						f->store_string(json);
+					} else {
+						ZN_PRINT_ERROR(zylann::format(
+								"Could not write benchmark results to {}", GodotStringWrapper(output_path)
+						));
+					}
+				}
+			}
+		}
+#endif
 	}
 
 #ifdef TOOLS_ENABLED
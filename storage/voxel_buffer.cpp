@@ -4,6 +4,7 @@
 #include "../util/containers/dynamic_bitset.h"
 #include "../util/dstack.h"
 #include "../util/math/box_bounds_3i.h"
+#include "../util/memory/linear_allocator.h"
 #include "../util/profiling.h"
 #include "../util/string/format.h"
 #include "mixel4.h"
@@ -1020,8 +1021,9 @@ Vector3i transform_channel(
 		const math::OrthoBasis &basis,
 		Vector3i &out_trans_origin
 ) {
-	// TODO Candidate for temp allocator
-	StdVector<T> temp;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<T> temp(temp_allocator);
 	temp.resize(channel_data.size());
 	Span<T> temp_s = to_span(temp);
 	const Vector3i transformed_size =
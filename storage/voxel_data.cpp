@@ -1,12 +1,16 @@
 #include "voxel_data.h"
+#include "../util/containers/std_unordered_map.h"
 #include "../util/containers/std_vector.h"
 #include "../util/dstack.h"
+#include "../util/hash_funcs.h"
 #include "../util/math/conv.h"
+#include "../util/memory/linear_allocator.h"
 #include "../util/string/format.h"
 #include "../util/thread/mutex.h"
 #include "metadata/voxel_metadata_variant.h"
 #include "voxel_buffer_gd.h"
 #include "voxel_data_grid.h"
+#include "voxel_data_read_view.h"
 
 namespace zylann::voxel {
 
@@ -43,8 +47,12 @@ struct ScheduleSaveAction {
 			// If a modified block has no voxels, it is equivalent to removing the block from the stream
 			if (block.has_voxels()) {
 				if (with_copy) {
-					b.voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
-					block.get_voxels_const().copy_to(*b.voxels, true);
+					// The block remains, so it will copy voxels itself if it gets modified while the save is pending
+					b.voxels = block.try_share_voxels_readonly();
+					if (b.voxels == nullptr) {
+						b.voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
+						block.get_voxels_const().copy_to(*b.voxels, true);
+					}
 				} else {
 					b.voxels = block.get_voxels_shared();
 				}
@@ -104,6 +112,9 @@ void VoxelData::reset_maps_no_settings_lock() {
 			data_lod.map.clear();
 		}
 	}
+
+	// Recorded edits refer to voxels that are gone
+	_edit_journal.clear();
 }
 
 void VoxelData::set_bounds(Box3i bounds) {
@@ -114,6 +125,7 @@ void VoxelData::set_bounds(Box3i bounds) {
 void VoxelData::set_generator(Ref<VoxelGenerator> generator) {
 	MutexLock wlock(_settings_mutex);
 	_generator = generator;
+	++_generator_version;
 }
 
 VoxelFormat VoxelData::get_format() const {
@@ -160,11 +172,11 @@ inline VoxelSingleValue get_voxel_sv(VoxelBuffer &vb, Vector3i pos, unsigned int
 }
 
 // TODO Piggyback on `copy`? The implementation is quite complex, and it's not supposed to be an efficient use case
-VoxelSingleValue VoxelData::get_voxel(Vector3i pos, unsigned int channel_index, VoxelSingleValue defval) const {
+bool VoxelData::try_get_stored_voxel(Vector3i pos, unsigned int channel_index, VoxelSingleValue &out_value) const {
 	// ZN_PROFILE_SCOPE();
 
 	if (!_bounds_in_voxels.contains(pos)) {
-		return defval;
+		return true;
 	}
 
 	Vector3i block_pos = pos >> get_block_size_po2();
@@ -172,7 +184,7 @@ VoxelSingleValue VoxelData::get_voxel(Vector3i pos, unsigned int channel_index,
 
 	if (!_streaming_enabled) {
 		if (_full_load_completed == false) {
-			return defval;
+			return true;
 		}
 
 		const Lod &data_lod0 = _lods[0];
@@ -183,34 +195,19 @@ VoxelSingleValue VoxelData::get_voxel(Vector3i pos, unsigned int channel_index,
 
 		if (voxels == nullptr) {
 			data_lod0.spatial_lock.unlock_read(BoxBounds3i::from_position(block_pos));
-
 			// No voxel data. We know everything is loaded when data streaming is not used, so try to generate directly.
-			// TODO We should be able to get a value if modifiers are used but not a base generator
-			Ref<VoxelGenerator> generator = get_generator();
-			if (generator.is_valid()) {
-				VoxelSingleValue value = generator->generate_single(pos, channel_index);
-#ifdef VOXEL_ENABLE_MODIFIERS
-				if (channel_index == VoxelBuffer::CHANNEL_SDF) {
-					float sdf = value.f;
-					_modifiers.apply(sdf, to_vec3f(pos));
-					value.f = sdf;
-				}
-#endif
-				return value;
-			}
-		} else {
-			const Vector3i rpos = data_lod0.map.to_local(pos);
-			const VoxelSingleValue sv = get_voxel_sv(*voxels, rpos, channel_index);
-			data_lod0.spatial_lock.unlock_read(BoxBounds3i::from_position(block_pos));
-			return sv;
+			return false;
 		}
-		return defval;
+
+		const Vector3i rpos = data_lod0.map.to_local(pos);
+		out_value = get_voxel_sv(*voxels, rpos, channel_index);
+		data_lod0.spatial_lock.unlock_read(BoxBounds3i::from_position(block_pos));
+		return true;
 
 	} else {
 		// When data streaming is used, we try to find voxel data. If we don't and the location is also not loaded, we
 		// have to return the default value.
 		Vector3i voxel_pos = pos;
-		Ref<VoxelGenerator> generator = get_generator();
 		const unsigned int lod_count = get_lod_count();
 
 		// Check all LODs until we find a loaded location
@@ -222,28 +219,15 @@ VoxelSingleValue VoxelData::get_voxel(Vector3i pos, unsigned int channel_index,
 			std::shared_ptr<VoxelBuffer> voxels = try_get_voxel_buffer_with_lock(data_lod, block_pos, generate);
 
 			if (voxels != nullptr) {
-				const VoxelSingleValue sv = get_voxel_sv(*voxels, data_lod.map.to_local(voxel_pos), channel_index);
+				out_value = get_voxel_sv(*voxels, data_lod.map.to_local(voxel_pos), channel_index);
 				data_lod.spatial_lock.unlock_read(BoxBounds3i::from_position(block_pos));
-				return sv;
+				return true;
 
 			} else {
 				data_lod.spatial_lock.unlock_read(BoxBounds3i::from_position(block_pos));
 
 				if (generate) {
-					// TODO We should be able to get a value if modifiers are used but not a base generator
-					if (generator.is_valid()) {
-						VoxelSingleValue value = generator->generate_single(pos, channel_index);
-#ifdef VOXEL_ENABLE_MODIFIERS
-						if (channel_index == VoxelBuffer::CHANNEL_SDF) {
-							float sdf = value.f;
-							_modifiers.apply(sdf, to_vec3f(pos));
-							value.f = sdf;
-						}
-#endif
-						return value;
-					} else {
-						return defval;
-					}
+					return false;
 				}
 			}
 
@@ -251,14 +235,99 @@ VoxelSingleValue VoxelData::get_voxel(Vector3i pos, unsigned int channel_index,
 			block_pos = block_pos >> 1;
 			voxel_pos = voxel_pos >> 1;
 		}
+		return true;
+	}
+}
+
+VoxelSingleValue VoxelData::get_voxel(Vector3i pos, unsigned int channel_index, VoxelSingleValue defval) const {
+	VoxelSingleValue value = defval;
+	if (try_get_stored_voxel(pos, channel_index, value)) {
+		return value;
+	}
+
+	// TODO We should be able to get a value if modifiers are used but not a base generator
+	Ref<VoxelGenerator> generator = get_generator();
+	if (generator.is_null()) {
 		return defval;
 	}
+
+	value = generator->generate_single(pos, channel_index);
+#ifdef VOXEL_ENABLE_MODIFIERS
+	if (channel_index == VoxelBuffer::CHANNEL_SDF) {
+		float sdf = value.f;
+		_modifiers.apply(sdf, to_vec3f(pos));
+		value.f = sdf;
+	}
+#endif
+	return value;
+}
+
+void VoxelData::get_voxels(
+		Span<const Vector3i> positions,
+		unsigned int channel_index,
+		VoxelSingleValue defval,
+		Span<VoxelSingleValue> out_values
+) const {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN(positions.size() == out_values.size());
+
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+
+	// Voxels that are not stored are generated all at once after looking up the others
+	StdTempVector<unsigned int> generated_indices(temp_allocator);
+	StdTempVector<Vector3i> generated_positions(temp_allocator);
+	generated_indices.reserve(positions.size());
+	generated_positions.reserve(positions.size());
+
+	for (unsigned int i = 0; i < positions.size(); ++i) {
+		out_values[i] = defval;
+		if (!try_get_stored_voxel(positions[i], channel_index, out_values[i])) {
+			generated_indices.push_back(i);
+			generated_positions.push_back(positions[i]);
+		}
+	}
+
+	if (generated_indices.size() == 0) {
+		return;
+	}
+
+	// TODO We should be able to get a value if modifiers are used but not a base generator
+	Ref<VoxelGenerator> generator = get_generator();
+	if (generator.is_null()) {
+		return;
+	}
+
+	StdTempVector<VoxelSingleValue> generated_values(generated_positions.size(), temp_allocator);
+	generator->generate_single_batch(to_span(generated_positions), channel_index, to_span(generated_values));
+
+	for (unsigned int i = 0; i < generated_indices.size(); ++i) {
+		VoxelSingleValue value = generated_values[i];
+#ifdef VOXEL_ENABLE_MODIFIERS
+		if (channel_index == VoxelBuffer::CHANNEL_SDF) {
+			float sdf = value.f;
+			_modifiers.apply(sdf, to_vec3f(generated_positions[i]));
+			value.f = sdf;
+		}
+#endif
+		out_values[generated_indices[i]] = value;
+	}
 }
 
 std::shared_ptr<VoxelBuffer> VoxelData::try_get_writable_voxel_buffer_assuming_spatial_lock(
 		Lod &lod,
 		const Vector3i bpos
 ) {
+	{
+		RWLockRead rlock(lod.map_lock);
+		VoxelDataBlock *block = lod.map.get_block(bpos);
+		if (block != nullptr && block->has_voxels()) {
+			// Voxels may still be read by a save
+			block->unshare_voxels();
+			block->mark_voxels_changed();
+		}
+	}
+
 	bool can_generate = false;
 	std::shared_ptr<VoxelBuffer> voxels = try_get_voxel_buffer_with_lock(lod, bpos, can_generate);
 
@@ -556,6 +625,16 @@ bool VoxelData::is_area_loaded(const Box3i p_voxels_box) const {
 	}
 }
 
+namespace {
+
+// Below this amount of blocks to generate, `pre_generate_box` doesn't use the task scheduler
+static const unsigned int PARALLEL_PRE_GENERATE_MIN_BLOCKS = 8;
+// Large boxes are pre-generated region by region, so the amount of generated blocks held in memory before insertion
+// and the time spent holding write locks remain bounded. Size is in blocks of LOD0.
+static const int PRE_GENERATE_REGION_SIZE_IN_BLOCKS = 8;
+
+} // namespace
+
 void VoxelData::pre_generate_box(
 		Box3i voxel_box,
 		Span<Lod> lods,
@@ -566,10 +645,59 @@ void VoxelData::pre_generate_box(
 #ifdef VOXEL_ENABLE_MODIFIERS
 		VoxelModifierStack &modifiers,
 #endif
-		const VoxelFormat format
+		const VoxelFormat format,
+		const TaskScheduler &task_scheduler
 ) {
 	// This is mostly used by VoxelLodTerrain, in cases non-edited blocks aren't cached.
 
+	ZN_PROFILE_SCOPE();
+
+	const int region_size = data_block_size * PRE_GENERATE_REGION_SIZE_IN_BLOCKS;
+	const Box3i regions_box = voxel_box.downscaled(region_size);
+
+	regions_box.for_each_cell([&voxel_box,
+							   region_size,
+							   lods,
+							   data_block_size,
+							   streaming,
+							   lod_count,
+							   &generator,
+#ifdef VOXEL_ENABLE_MODIFIERS
+							   &modifiers,
+#endif
+							   &format,
+							   &task_scheduler](Vector3i region_pos) {
+		const Box3i region_voxel_box =
+				Box3i(region_pos * region_size, Vector3iUtil::create(region_size)).clipped(voxel_box);
+		pre_generate_region(
+				region_voxel_box,
+				lods,
+				data_block_size,
+				streaming,
+				lod_count,
+				generator,
+#ifdef VOXEL_ENABLE_MODIFIERS
+				modifiers,
+#endif
+				format,
+				task_scheduler
+		);
+	});
+}
+
+void VoxelData::pre_generate_region(
+		Box3i voxel_box,
+		Span<Lod> lods,
+		unsigned int data_block_size,
+		bool streaming,
+		unsigned int lod_count,
+		Ref<VoxelGenerator> generator,
+#ifdef VOXEL_ENABLE_MODIFIERS
+		VoxelModifierStack &modifiers,
+#endif
+		const VoxelFormat &format,
+		const TaskScheduler &task_scheduler
+) {
 	ZN_PROFILE_SCOPE();
 	// ERR_FAIL_COND_MSG(_full_load_mode == false, nullptr, "This function can only be used in full load mode");
 
@@ -629,7 +757,14 @@ void VoxelData::pre_generate_box(
 	const Vector3i block_size = Vector3iUtil::create(data_block_size);
 
 	// Generate
-	for (unsigned int i = 0; i < todo.size(); ++i) {
+	auto generate_func = [&todo,
+						  &block_size,
+						  data_block_size,
+						  &generator,
+#ifdef VOXEL_ENABLE_MODIFIERS
+						  &modifiers,
+#endif
+						  &format](uint32_t i) {
 		Task &task = todo[i];
 		task.voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
 		task.voxels->create(block_size, &format);
@@ -645,6 +780,15 @@ void VoxelData::pre_generate_box(
 			modifiers.apply(q.voxel_buffer, AABB(q.origin_in_voxels, q.voxel_buffer.get_size() << q.lod));
 #endif
 		}
+	};
+
+	if (todo.size() >= PARALLEL_PRE_GENERATE_MIN_BLOCKS) {
+		// Generators and modifiers are already used from multiple threads by generation tasks
+		run_parallel_jobs(todo.size(), generate_func, task_scheduler);
+	} else {
+		for (unsigned int i = 0; i < todo.size(); ++i) {
+			generate_func(i);
+		}
 	}
 
 	// Populate slots
@@ -693,7 +837,8 @@ void VoxelData::pre_generate_box(Box3i voxel_box) {
 #ifdef VOXEL_ENABLE_MODIFIERS
 			_modifiers,
 #endif
-			get_format()
+			get_format(),
+			_task_scheduler
 	);
 }
 
@@ -720,6 +865,23 @@ void VoxelData::clear_cached_blocks_in_voxel_area(Box3i p_voxel_box) {
 	}
 }
 
+uint64_t VoxelData::get_voxels_version(Box3i voxel_box) const {
+	ZN_PROFILE_SCOPE();
+	const Box3i block_box = voxel_box.downscaled(get_block_size());
+	const Lod &data_lod0 = _lods[0];
+
+	uint64_t version = hash_djb2_one_64(_generator_version.load());
+
+	RWLockRead rlock(data_lod0.map_lock);
+	block_box.for_each_cell_zxy([&data_lod0, &version](Vector3i bpos) {
+		const VoxelDataBlock *block = data_lod0.map.get_block(bpos);
+		// Block versions are never zero, so a missing block is different from any block
+		version = hash_djb2_one_64(block != nullptr ? block->get_voxels_version() : 0, version);
+	});
+
+	return version;
+}
+
 void VoxelData::mark_area_modified(
 		Box3i p_voxel_box,
 		StdVector<Vector3i> *lod0_new_blocks_to_lod,
@@ -753,6 +915,8 @@ void VoxelData::mark_area_modified(
 			// RWLockWrite wlock(block->get_voxels_shared()->get_lock());
 			block->set_modified(true);
 			block->set_edited(true);
+			// Voxels may have been modified through a grid, which doesn't do it
+			block->mark_voxels_changed();
 
 			// TODO That boolean is also modified by the threaded update task (always set to false)
 			if (!block->get_needs_lodding() && require_lod_updates) {
@@ -1010,7 +1174,7 @@ void VoxelData::update_lods(Span<const Vector3i> modified_lod0_blocks, StdVector
 				// TODO The destination block should be locked!
 				// Maybe it hasn't been done so far because nothing else accesses higher LOD indices yet, or because we
 				// are holding a lock on the map that contains it
-				src_block->get_voxels().downscale_to(
+				src_block->get_voxels_const().downscale_to(
 						dst_block->get_voxels(), Vector3i(), src_block->get_voxels_const().get_size(), rel * half_bs
 				);
 			}
@@ -1072,8 +1236,11 @@ bool VoxelData::consume_block_modifications(Vector3i bpos, VoxelData::BlockToSav
 	}
 	if (block->is_modified()) {
 		if (block->has_voxels()) {
-			out_to_save.voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
-			block->get_voxels_const().copy_to(*out_to_save.voxels, true);
+			out_to_save.voxels = block->try_share_voxels_readonly();
+			if (out_to_save.voxels == nullptr) {
+				out_to_save.voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
+				block->get_voxels_const().copy_to(*out_to_save.voxels, true);
+			}
 		}
 		out_to_save.position = bpos;
 		out_to_save.lod_index = 0;
@@ -1131,7 +1298,7 @@ void VoxelData::get_missing_blocks(Box3i p_blocks_box, unsigned int lod_index, S
 void VoxelData::get_blocks_with_voxel_data(
 		Box3i p_blocks_box,
 		unsigned int lod_index,
-		Span<std::shared_ptr<VoxelBuffer>> out_blocks
+		Span<std::shared_ptr<const VoxelBuffer>> out_blocks
 ) const {
 	ZN_PROFILE_SCOPE();
 	ZN_ASSERT(out_blocks.size() >= Vector3iUtil::get_volume_u64(p_blocks_box.size));
@@ -1139,7 +1306,7 @@ void VoxelData::get_blocks_with_voxel_data(
 	const Lod &data_lod = _lods[lod_index];
 
 	// Locking also with spatial lock because we need to check if blocks have voxels, which is a state that could be
-	// changed by another thread (in theory)
+	// changed by another thread (in theory). Once snapshots are taken, the lock is no longer needed to read them.
 	SpatialLock3D::Read srlock(data_lod.spatial_lock, p_blocks_box);
 
 	RWLockRead rlock(data_lod.map_lock);
@@ -1151,7 +1318,7 @@ void VoxelData::get_blocks_with_voxel_data(
 		// The block can actually be null on some occasions. Not sure yet if it's that bad
 		// CRASH_COND(nblock == nullptr);
 		if (nblock != nullptr && nblock->has_voxels()) {
-			out_blocks[index] = nblock->get_voxels_shared();
+			out_blocks[index] = nblock->get_voxels_snapshot();
 		}
 		++index;
 	});
@@ -1165,6 +1332,42 @@ void VoxelData::get_blocks_grid(VoxelDataGrid &grid, Box3i box_in_voxels, unsign
 	grid.reference_area_block_coords(data_lod.map, data_lod.map_lock, box_in_blocks, data_lod.spatial_lock);
 }
 
+void VoxelData::get_blocks_grid_for_write(VoxelDataGrid &grid, Box3i box_in_voxels, unsigned int lod_index) {
+	ZN_PROFILE_SCOPE();
+	Lod &data_lod = _lods[lod_index];
+	const int bs = data_lod.map.get_block_size() << lod_index;
+	const Box3i box_in_blocks = box_in_voxels.downscaled(bs);
+	grid.reference_area_block_coords_for_write(data_lod.map, data_lod.map_lock, box_in_blocks, data_lod.spatial_lock);
+}
+
+void VoxelData::acquire_read_view(VoxelDataReadView &view, Box3i box_in_voxels, unsigned int lod_index) const {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN(lod_index < get_lod_count());
+	view.release();
+
+	const Lod &data_lod = _lods[lod_index];
+	const int bs = data_lod.map.get_block_size() << lod_index;
+	const Box3i box_in_blocks = box_in_voxels.downscaled(bs);
+
+	// The lock is kept until the view is released, which is what allows it to access voxels without copying them
+	data_lod.spatial_lock.lock_read(BoxBounds3i(box_in_blocks));
+	view._spatial_lock = &data_lod.spatial_lock;
+	view._block_box = box_in_blocks;
+	view._block_size_po2 = data_lod.map.get_block_size_pow2();
+	view._blocks.resize(Vector3iUtil::get_volume_u64(box_in_blocks.size));
+
+	RWLockRead rlock(data_lod.map_lock);
+	unsigned int index = 0;
+	box_in_blocks.for_each_cell_zxy([&data_lod, &view, &index](Vector3i bpos) {
+		const VoxelDataBlock *block = data_lod.map.get_block(bpos);
+		// Holding references keeps voxels alive if the block gets replaced while the view is acquired
+		if (block != nullptr && block->has_voxels()) {
+			view._blocks[index] = block->get_voxels_shared();
+		}
+		++index;
+	});
+}
+
 SpatialLock3D &VoxelData::get_spatial_lock(unsigned int lod_index) const {
 	const Lod &data_lod = _lods[lod_index];
 	return data_lod.spatial_lock;
@@ -1305,6 +1508,22 @@ std::shared_ptr<VoxelBuffer> VoxelData::try_get_block_voxels(Vector3i bpos) {
 	return nullptr;
 }
 
+std::shared_ptr<VoxelBuffer> VoxelData::try_get_block_voxels_for_write(Vector3i bpos) {
+	Lod &lod = _lods[0];
+
+	SpatialLock3D::Write swlock(lod.spatial_lock, BoxBounds3i::from_position(bpos));
+	RWLockRead rlock(lod.map_lock);
+
+	VoxelDataBlock *block = lod.map.get_block(bpos);
+	if (block == nullptr || !block->has_voxels()) {
+		return nullptr;
+	}
+	// Voxels may still be read by a save
+	block->unshare_voxels();
+	block->mark_voxels_changed();
+	return block->get_voxels_shared();
+}
+
 void VoxelData::set_voxel_metadata(const Vector3i pos, const Variant &meta) {
 	Lod &lod = _lods[0];
 
@@ -1352,4 +1571,169 @@ Variant VoxelData::get_voxel_metadata(const Vector3i pos) {
 	return Variant();
 }
 
+void VoxelData::set_edit_journal_capacity(size_t capacity_in_bytes) {
+	_edit_journal.set_capacity(capacity_in_bytes);
+}
+
+size_t VoxelData::get_edit_journal_capacity() const {
+	return _edit_journal.get_capacity();
+}
+
+void VoxelData::begin_edit_recording(Box3i voxel_box, VoxelEditJournal::Recording &recording) const {
+	begin_edit_recording(Span<const Box3i>(&voxel_box, 1), recording);
+}
+
+void VoxelData::begin_edit_recording(Span<const Box3i> voxel_boxes, VoxelEditJournal::Recording &recording) const {
+	recording.blocks.clear();
+	recording.active = false;
+
+	if (!_edit_journal.is_enabled()) {
+		return;
+	}
+
+	ZN_PROFILE_SCOPE();
+
+	const Lod &lod = _lods[0];
+	const int block_size = lod.map.get_block_size();
+
+	// Find the area of each block touched by the boxes. Blocks touched by several boxes record the area enclosing them.
+	StdUnorderedMap<Vector3i, unsigned int> block_indices;
+	for (const Box3i &voxel_box : voxel_boxes) {
+		const Box3i blocks_box = voxel_box.downscaled(block_size);
+		blocks_box.for_each_cell_zxy([&recording, &block_indices, &voxel_box, block_size](Vector3i bpos) {
+			const Box3i block_voxel_box(bpos * block_size, Vector3iUtil::create(block_size));
+			Box3i local_box = voxel_box.clipped(block_voxel_box);
+			local_box.position -= block_voxel_box.position;
+
+			auto it = block_indices.find(bpos);
+			if (it != block_indices.end()) {
+				recording.blocks[it->second].box.merge_with(local_box);
+				return;
+			}
+			block_indices.insert({ bpos, recording.blocks.size() });
+			VoxelEditJournal::Recording::Block recorded_block;
+			recorded_block.position = bpos;
+			recorded_block.box = local_box;
+			recording.blocks.push_back(std::move(recorded_block));
+		});
+	}
+
+	unsigned int recorded_count = 0;
+
+	for (unsigned int i = 0; i < recording.blocks.size(); ++i) {
+		VoxelEditJournal::Recording::Block &recorded_block = recording.blocks[i];
+
+		SpatialLock3D::Read srlock(lod.spatial_lock, BoxBounds3i::from_position(recorded_block.position));
+		RWLockRead rlock(lod.map_lock);
+
+		const VoxelDataBlock *block = lod.map.get_block(recorded_block.position);
+		if (block == nullptr || !block->has_voxels()) {
+			continue;
+		}
+		recorded_block.voxels_version = block->get_voxels_version();
+		// Copying only the edited area rather than sharing the whole block, which would then be copied entirely when
+		// modified
+		recorded_block.voxels = make_unique_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
+		VoxelEditJournal::copy_voxels_in_box(block->get_voxels_const(), recorded_block.box, *recorded_block.voxels);
+
+		if (recorded_count != i) {
+			recording.blocks[recorded_count] = std::move(recorded_block);
+		}
+		++recorded_count;
+	}
+
+	recording.blocks.resize(recorded_count);
+	recording.active = true;
+}
+
+void VoxelData::end_edit_recording(VoxelEditJournal::Recording &recording) {
+	if (!recording.active) {
+		return;
+	}
+	recording.active = false;
+
+	ZN_PROFILE_SCOPE();
+
+	VoxelEditJournal::Edit edit;
+	{
+		const Lod &lod = _lods[0];
+		VoxelBuffer voxels_after(VoxelBuffer::ALLOCATOR_POOL);
+
+		for (const VoxelEditJournal::Recording::Block &recorded_block : recording.blocks) {
+			SpatialLock3D::Read srlock(lod.spatial_lock, BoxBounds3i::from_position(recorded_block.position));
+			RWLockRead rlock(lod.map_lock);
+
+			const VoxelDataBlock *block = lod.map.get_block(recorded_block.position);
+			if (block == nullptr || !block->has_voxels()) {
+				// Unloaded in the meantime
+				continue;
+			}
+			if (block->get_voxels_version() == recorded_block.voxels_version) {
+				// Not modified
+				continue;
+			}
+
+			VoxelEditJournal::copy_voxels_in_box(block->get_voxels_const(), recorded_block.box, voxels_after);
+
+			VoxelEditJournal::BlockDelta delta;
+			delta.position = recorded_block.position;
+			delta.box = recorded_block.box;
+			if (VoxelEditJournal::compute_block_delta(*recorded_block.voxels, voxels_after, delta)) {
+				edit.blocks.push_back(std::move(delta));
+			}
+		}
+	}
+
+	recording.blocks.clear();
+
+	if (edit.blocks.size() > 0) {
+		_edit_journal.push(std::move(edit));
+	}
+}
+
+bool VoxelData::undo_edit(StdVector<Box3i> &out_modified_voxel_boxes) {
+	VoxelEditJournal::Edit edit;
+	if (!_edit_journal.pop_undo(edit)) {
+		return false;
+	}
+	apply_journal_edit(edit, true, out_modified_voxel_boxes);
+	_edit_journal.push_undone(std::move(edit));
+	return true;
+}
+
+bool VoxelData::redo_edit(StdVector<Box3i> &out_modified_voxel_boxes) {
+	VoxelEditJournal::Edit edit;
+	if (!_edit_journal.pop_redo(edit)) {
+		return false;
+	}
+	apply_journal_edit(edit, false, out_modified_voxel_boxes);
+	_edit_journal.push_redone(std::move(edit));
+	return true;
+}
+
+void VoxelData::apply_journal_edit(
+		const VoxelEditJournal::Edit &edit,
+		bool undo,
+		StdVector<Box3i> &out_modified_voxel_boxes
+) {
+	ZN_PROFILE_SCOPE();
+
+	Lod &lod = _lods[0];
+	const int block_size = lod.map.get_block_size();
+
+	for (const VoxelEditJournal::BlockDelta &delta : edit.blocks) {
+		SpatialLock3D::Write swlock(lod.spatial_lock, BoxBounds3i::from_position(delta.position));
+		RWLockRead rlock(lod.map_lock);
+
+		VoxelDataBlock *block = lod.map.get_block(delta.position);
+		if (block == nullptr || !block->has_voxels()) {
+			// The block was unloaded since the edit, it can't be changed until it is loaded again
+			continue;
+		}
+
+		VoxelEditJournal::apply_block_delta(delta, block->get_voxels(), undo);
+		out_modified_voxel_boxes.push_back(Box3i(delta.position * block_size + delta.box.position, delta.box.size));
+	}
+}
+
 } // namespace zylann::voxel
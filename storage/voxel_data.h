@@ -3,10 +3,13 @@
 
 #include "../generators/voxel_generator.h"
 #include "../streams/voxel_stream.h"
+#include "../util/tasks/parallel_jobs.h"
 #include "../util/thread/mutex.h"
 #include "../util/thread/spatial_lock_3d.h"
 #include "voxel_data_map.h"
+#include "voxel_edit_journal.h"
 #include "voxel_format.h"
+#include <atomic>
 
 #ifdef VOXEL_ENABLE_MODIFIERS
 #include "../modifiers/voxel_modifier_stack.h"
@@ -15,6 +18,7 @@
 namespace zylann::voxel {
 
 class VoxelDataGrid;
+class VoxelDataReadView;
 
 // Generic storage containing everything needed to access voxel data.
 // Contains edits, procedural sources and file stream so voxels not physically stored in memory can be obtained.
@@ -102,11 +106,27 @@ public:
 		return _full_load_completed;
 	}
 
+	// Thread pool used to parallelize some operations, such as `pre_generate_box`. If not set, they run on the calling
+	// thread only. This must be set before the data is accessed from multiple threads.
+	inline void set_task_scheduler(TaskScheduler scheduler) {
+		_task_scheduler = scheduler;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Voxel queries.
 	// When not specified, the used LOD index is 0.
 
 	VoxelSingleValue get_voxel(Vector3i pos, unsigned int channel_index, VoxelSingleValue defval) const;
+
+	// Gets several voxels at once. Those that are not stored are generated together, which is faster than calling
+	// `get_voxel` for each of them.
+	void get_voxels(
+			Span<const Vector3i> positions,
+			unsigned int channel_index,
+			VoxelSingleValue defval,
+			Span<VoxelSingleValue> out_values
+	) const;
+
 	bool try_set_voxel(uint64_t value, Vector3i pos, unsigned int channel_index);
 
 	float get_voxel_f(Vector3i pos, unsigned int channel_index) const;
@@ -159,7 +179,8 @@ public:
 
 	// Generates all non-present blocks in preparation for an edit.
 	// Every block intersecting with the box at every LOD will be checked.
-	// This function runs sequentially and should be thread-safe. May be used if blocks are immediately needed.
+	// This function returns once blocks are generated and should be thread-safe. May be used if blocks are immediately
+	// needed. Large boxes are processed region by region, generating blocks of each region with the task scheduler.
 	// It will block if other threads are accessing the same data.
 	// When streaming is enabled, non-loaded areas will not be touched.
 	// WARNING: this does not check if the area is editable.
@@ -175,6 +196,12 @@ public:
 	// Optionally, returns a list of affected block positions which did not require LOD updates before.
 	void mark_area_modified(Box3i p_voxel_box, StdVector<Vector3i> *lod0_new_blocks_to_lod, bool require_lod_updates);
 
+	// Gets a number that changes every time voxels at LOD0 in the given box may have changed, from edits, blocks
+	// getting loaded or unloaded, or the generator changing. Caches built from voxels of the box can compare it to tell
+	// if they are outdated. Changes in other areas don't affect it. Cost is proportional to the number of blocks in the
+	// box.
+	uint64_t get_voxels_version(Box3i voxel_box) const;
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Block-aware API
 
@@ -198,6 +225,7 @@ public:
 		VoxelDataBlock *existing_block = lod.map.get_block(block_position);
 		if (existing_block != nullptr) {
 			action_when_exists(*existing_block, block);
+			existing_block->mark_voxels_changed();
 			return false;
 		} else {
 			lod.map.set_block(block_position, block);
@@ -274,12 +302,16 @@ public:
 	// their data will be returned for the caller to save.
 	// void unload_blocks(Span<const Vector3i> positions, StdVector<BlockToSave> *to_save);
 
-	// If the block at the specified LOD0 position exists and is modified, marks it as non-modified and returns a copy
-	// of its data to save. Returns true if there is something to save.
+	// If the block at the specified LOD0 position exists and is modified, marks it as non-modified and returns its data
+	// to save. The returned voxels must not be modified. They are shared without copy when possible, in which case the
+	// block will copy them if it gets modified while they are still referenced. Returns true if there is something to
+	// save.
 	bool consume_block_modifications(Vector3i bpos, BlockToSave &out_to_save);
 
 	// Marks all modified blocks as unmodified and returns their data to save. if `with_copy` is true, the returned data
-	// will be a copy, otherwise it will reference voxel data. Prefer using references when about to quit for example.
+	// will not be affected by further modifications of blocks (shared with copy-on-write when possible, like
+	// `consume_block_modifications`), otherwise it will reference voxel data. Prefer using references when about to
+	// quit for example.
 	void consume_all_modifications(StdVector<BlockToSave> &to_save, bool with_copy);
 
 	// Gets missing blocks out of the given block positions.
@@ -301,16 +333,25 @@ public:
 	// Voxel data references are returned in an array big enough to contain a grid of the size of the area.
 	// Blocks found will be placed at an index computed as if the array was a flat grid (ZXY).
 	// Entries without voxel data will be left to null.
+	// Voxels are immutable snapshots (see `VoxelDataBlock::get_voxels_snapshot`), so they can be read without locking.
 	void get_blocks_with_voxel_data(
 			Box3i p_blocks_box,
 			unsigned int lod_index,
-			Span<std::shared_ptr<VoxelBuffer>> out_blocks
+			Span<std::shared_ptr<const VoxelBuffer>> out_blocks
 	) const;
 
 	// Gets blocks with voxels at the given LOD and indexes them in a grid. This will query every location
 	// intersecting the box at the specified LOD, so if the area is large, you may want to do a broad check first.
 	// WARNING: data isn't locked, you have to keep a shared reference to VoxelData in order to use SpatialLock3D.
 	void get_blocks_grid(VoxelDataGrid &grid, Box3i box_in_voxels, unsigned int lod_index) const;
+	// Same as `get_blocks_grid`, but voxels still referenced by pending saves are copied first, so the grid can be used
+	// to modify them. Only use this when voxels are going to be modified, reads don't need the copies.
+	void get_blocks_grid_for_write(VoxelDataGrid &grid, Box3i box_in_voxels, unsigned int lod_index);
+
+	// Locks blocks intersecting the box at the given LOD for reading, and gives access to their voxels until the view
+	// is released. This is faster than getting voxels one by one when many of them have to be read in the same area.
+	// The box is in voxels of LOD0. Positions used in the view are in voxels of the requested LOD.
+	void acquire_read_view(VoxelDataReadView &view, Box3i box_in_voxels, unsigned int lod_index) const;
 
 	// TODO Areas that use this accessor might as well move their logic in this class
 	SpatialLock3D &get_spatial_lock(unsigned int lod_index) const;
@@ -325,6 +366,9 @@ public:
 	// WARNING: you must hold the spatial lock before calling this, and until you're done working on such blocks.
 	// Can return null.
 	std::shared_ptr<VoxelBuffer> try_get_block_voxels(Vector3i bpos);
+	// Same as `try_get_block_voxels`, but voxels still referenced by pending saves are copied first, so they can be
+	// modified. Locks the block only while doing so. Can return null.
+	std::shared_ptr<VoxelBuffer> try_get_block_voxels_for_write(Vector3i bpos);
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Reference-counted API (LOD0 only)
@@ -364,7 +408,44 @@ public:
 	void set_voxel_metadata(const Vector3i pos, const Variant &meta);
 	Variant get_voxel_metadata(const Vector3i pos);
 
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Edit journal.
+	// Only at LOD0. Edits are recorded as differences per block, so they can be undone and redone. Only blocks that
+	// had voxels before an edit are recorded. Metadata is not recorded.
+
+	// Capacity is in bytes. 0 disables the journal.
+	void set_edit_journal_capacity(size_t capacity_in_bytes);
+	size_t get_edit_journal_capacity() const;
+
+	inline const VoxelEditJournal &get_edit_journal() const {
+		return _edit_journal;
+	}
+
+	// Captures voxels in the area before an edit is done in it. Does nothing if the journal is disabled.
+	// Only voxels within the area are copied, and only those are compared when the recording ends.
+	void begin_edit_recording(Box3i voxel_box, VoxelEditJournal::Recording &recording) const;
+	// Same as the single box version, for edits done in several areas. They are recorded as a single edit.
+	void begin_edit_recording(Span<const Box3i> voxel_boxes, VoxelEditJournal::Recording &recording) const;
+
+	// Compares voxels captured with `begin_edit_recording` with their current state, and records differences in the
+	// journal as a single edit. Blocks that were not modified since then are skipped.
+	void end_edit_recording(VoxelEditJournal::Recording &recording);
+
+	// Reverts the last recorded edit. Returns false if there is nothing to undo. Boxes of modified areas are appended
+	// to `out_modified_voxel_boxes`, so the caller can update meshes. Blocks that were unloaded since the edit are
+	// skipped.
+	bool undo_edit(StdVector<Box3i> &out_modified_voxel_boxes);
+
+	// Applies again the last undone edit. Returns false if there is nothing to redo.
+	bool redo_edit(StdVector<Box3i> &out_modified_voxel_boxes);
+
 private:
+	void apply_journal_edit(
+			const VoxelEditJournal::Edit &edit,
+			bool undo,
+			StdVector<Box3i> &out_modified_voxel_boxes
+	);
+
 	void reset_maps_no_settings_lock();
 
 	struct Lod {
@@ -398,9 +479,28 @@ private:
 #ifdef VOXEL_ENABLE_MODIFIERS
 			VoxelModifierStack &modifiers,
 #endif
-			const VoxelFormat format
+			const VoxelFormat format,
+			const TaskScheduler &task_scheduler
+	);
+
+	static void pre_generate_region(
+			Box3i voxel_box,
+			Span<Lod> lods,
+			unsigned int data_block_size,
+			bool streaming,
+			unsigned int lod_count,
+			Ref<VoxelGenerator> generator,
+#ifdef VOXEL_ENABLE_MODIFIERS
+			VoxelModifierStack &modifiers,
+#endif
+			const VoxelFormat &format,
+			const TaskScheduler &task_scheduler
 	);
 
+	// Gets a voxel from blocks in memory. Returns false if it must be obtained from the generator instead.
+	// If the voxel is not stored and must not be generated either, returns true and leaves `out_value` untouched.
+	bool try_get_stored_voxel(Vector3i pos, unsigned int channel_index, VoxelSingleValue &out_value) const;
+
 	static inline std::shared_ptr<VoxelBuffer> try_get_voxel_buffer_with_lock(
 			const Lod &data_lod,
 			Vector3i block_pos,
@@ -463,9 +563,17 @@ private:
 #endif
 	Ref<VoxelGenerator> _generator;
 
+	TaskScheduler _task_scheduler;
+
 	// Persistent storage (file(s)).
 	Ref<VoxelStream> _stream;
 
+	VoxelEditJournal _edit_journal;
+
+	// Incremented when the generator changes, since it provides voxels where there are no blocks or no voxels in
+	// blocks. See `get_voxels_version`.
+	std::atomic_uint64_t _generator_version = { 0 };
+
 	VoxelFormat _format;
 
 	// This should be locked when accessing settings members.
@@ -1,9 +1,20 @@
 #include "voxel_data_block.h"
+#include "../util/errors.h"
 #include "../util/io/log.h"
+#include "../util/memory/memory.h"
 #include "../util/string/format.h"
+#include "voxel_buffer.h"
 
 namespace zylann::voxel {
 
+namespace {
+std::atomic_uint64_t g_voxels_version_clock = { 0 };
+}
+
+uint64_t VoxelDataBlock::make_voxels_version() {
+	return g_voxels_version_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 void VoxelDataBlock::set_modified(bool modified) {
 	// #ifdef TOOLS_ENABLED
 	// 	if (_modified == false && modified) {
@@ -13,4 +24,48 @@ void VoxelDataBlock::set_modified(bool modified) {
 	_modified = modified;
 }
 
+bool VoxelDataBlock::try_mark_voxels_shared() const {
+	// Other references could have been obtained to modify voxels later (like an edit in progress), in which case it
+	// isn't safe to share them. If they are already shared, such references would have unshared them.
+	// The flag is set before the caller makes its own reference, so a concurrent reader can't see an extra reference
+	// without also seeing the flag. At worst it will not share and make a copy.
+	if (!_voxels_shared && _voxels.use_count() != 1) {
+		return false;
+	}
+	_voxels_shared = true;
+	return true;
+}
+
+std::shared_ptr<VoxelBuffer> VoxelDataBlock::try_share_voxels_readonly() {
+	ZN_ASSERT_RETURN_V(_voxels != nullptr, nullptr);
+	if (!try_mark_voxels_shared()) {
+		return nullptr;
+	}
+	return _voxels;
+}
+
+std::shared_ptr<const VoxelBuffer> VoxelDataBlock::get_voxels_snapshot() const {
+	ZN_ASSERT_RETURN_V(_voxels != nullptr, nullptr);
+	if (try_mark_voxels_shared()) {
+		return _voxels;
+	}
+	std::shared_ptr<VoxelBuffer> voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
+	_voxels->copy_to(*voxels, true);
+	return voxels;
+}
+
+void VoxelDataBlock::unshare_voxels() {
+	if (!_voxels_shared) {
+		return;
+	}
+	_voxels_shared = false;
+	if (_voxels.use_count() == 1) {
+		// Readers are done with them
+		return;
+	}
+	std::shared_ptr<VoxelBuffer> voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
+	_voxels->copy_to(*voxels, true);
+	_voxels = voxels;
+}
+
 } // namespace zylann::voxel
@@ -2,6 +2,7 @@
 #define VOXEL_DATA_BLOCK_H
 
 #include "../util/ref_count.h"
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -17,12 +18,12 @@ class VoxelDataBlock {
 public:
 	RefCount viewers;
 
-	VoxelDataBlock() {}
+	VoxelDataBlock() : _voxels_version(make_voxels_version()) {}
 
-	VoxelDataBlock(unsigned int p_lod_index) : _lod_index(p_lod_index) {}
+	VoxelDataBlock(unsigned int p_lod_index) : _lod_index(p_lod_index), _voxels_version(make_voxels_version()) {}
 
 	VoxelDataBlock(std::shared_ptr<VoxelBuffer> &buffer, unsigned int p_lod_index) :
-			_voxels(buffer), _lod_index(p_lod_index) {}
+			_voxels(buffer), _lod_index(p_lod_index), _voxels_version(make_voxels_version()) {}
 
 	VoxelDataBlock(VoxelDataBlock &&src) :
 			viewers(src.viewers),
@@ -30,7 +31,9 @@ public:
 			_lod_index(src._lod_index),
 			_needs_lodding(src._needs_lodding),
 			_modified(src._modified),
-			_edited(src._edited) {}
+			_edited(src._edited),
+			_voxels_shared(src._voxels_shared.load()),
+			_voxels_version(src._voxels_version.load()) {}
 
 	VoxelDataBlock(const VoxelDataBlock &src) :
 			viewers(src.viewers),
@@ -38,7 +41,9 @@ public:
 			_lod_index(src._lod_index),
 			_needs_lodding(src._needs_lodding),
 			_modified(src._modified),
-			_edited(src._edited) {}
+			_edited(src._edited),
+			_voxels_shared(src._voxels_shared.load()),
+			_voxels_version(src._voxels_version.load()) {}
 
 	VoxelDataBlock &operator=(VoxelDataBlock &&src) {
 		viewers = src.viewers;
@@ -47,6 +52,8 @@ public:
 		_needs_lodding = src._needs_lodding;
 		_modified = src._modified;
 		_edited = src._edited;
+		_voxels_shared = src._voxels_shared.load();
+		_voxels_version = src._voxels_version.load();
 		return *this;
 	}
 
@@ -57,6 +64,8 @@ public:
 		_needs_lodding = src._needs_lodding;
 		_modified = src._modified;
 		_edited = src._edited;
+		_voxels_shared = src._voxels_shared.load();
+		_voxels_version = src._voxels_version.load();
 		return *this;
 	}
 
@@ -71,11 +80,17 @@ public:
 		return _voxels != nullptr;
 	}
 
-	// Get voxels, expecting them to be present
+	// Get voxels for modification, expecting them to be present.
+	// If they are shared with a reader expecting them to not change, they are copied first. The caller must hold a
+	// spatial write lock on the block.
 	VoxelBuffer &get_voxels() {
 #ifdef DEBUG_ENABLED
 		ZN_ASSERT(_voxels != nullptr);
 #endif
+		if (_voxels_shared) {
+			unshare_voxels();
+		}
+		mark_voxels_changed();
 		return *_voxels;
 	}
 
@@ -95,14 +110,48 @@ public:
 		return _voxels;
 	}
 
+	// Gets voxels so another thread can read them later without copying, such as a save task.
+	// The next modification of the block will copy them instead, if they are still referenced at that point.
+	// Returns null if they are also referenced by something that could modify them, in which case the caller has to
+	// copy them.
+	std::shared_ptr<VoxelBuffer> try_share_voxels_readonly();
+
+	// Gets an immutable snapshot of the voxels, which can be read without holding any lock for as long as it is
+	// referenced. Writers copy voxels before modifying them if a snapshot still references them, so readers never see
+	// partial edits.
+	// It is shared without copying when possible, otherwise it is a copy. The caller must hold at least a spatial read
+	// lock on the block while calling this. It can be called by multiple readers at the same time.
+	std::shared_ptr<const VoxelBuffer> get_voxels_snapshot() const;
+
+	// Makes sure voxels can be modified without affecting readers obtained with `try_share_voxels_readonly`, copying
+	// them if necessary. The caller must hold a spatial write lock on the block.
+	void unshare_voxels();
+
 	void set_voxels(const std::shared_ptr<VoxelBuffer> &buffer) {
 		ZN_ASSERT_RETURN(buffer != nullptr);
 		_voxels = buffer;
+		_voxels_shared = false;
+		mark_voxels_changed();
 	}
 
 	void clear_voxels() {
 		_voxels = nullptr;
 		_edited = false;
+		_voxels_shared = false;
+		mark_voxels_changed();
+	}
+
+	// Gets a number that changes every time voxels of the block may have changed. It is never zero, and unique among
+	// all blocks, so a block that was removed and replaced also has a different version.
+	inline uint64_t get_voxels_version() const {
+		return _voxels_version.load(std::memory_order_relaxed);
+	}
+
+	// Must be called after voxels were modified without using `get_voxels`, such as through a grid. It is also done
+	// by `get_voxels`, but before the caller modifies them, so another thread could read the new version with the
+	// old voxels in between.
+	inline void mark_voxels_changed() {
+		_voxels_version.store(make_voxels_version(), std::memory_order_relaxed);
 	}
 
 	void set_modified(bool modified);
@@ -128,6 +177,10 @@ public:
 	}
 
 private:
+	bool try_mark_voxels_shared() const;
+
+	static uint64_t make_voxels_version();
+
 	// Voxel data. If null, it means the data may be obtained with procedural generation.
 	std::shared_ptr<VoxelBuffer> _voxels;
 
@@ -146,6 +199,15 @@ private:
 	// Once it becomes `true`, it usually never comes back to `false` unless reverted.
 	bool _edited = false;
 
+	// Tells if voxels are referenced by readers expecting them to not change, so they must be copied before being
+	// modified.
+	// Atomic because readers holding only a read lock may set it concurrently.
+	mutable std::atomic_bool _voxels_shared = { false };
+
+	// See `get_voxels_version`.
+	// Atomic because it may be read by threads holding only a read lock on the map.
+	std::atomic_uint64_t _voxels_version;
+
 	// TODO Optimization: design a proper way to implement client-side caching for multiplayer
 	//
 	// Represents how many times the block was edited.
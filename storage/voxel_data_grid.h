@@ -57,6 +57,43 @@ public:
 		_spatial_lock = &spatial_lock;
 	}
 
+	// Same as `reference_area_block_coords`, but voxels shared with readers expecting them to not change (like pending
+	// saves) are copied first, so the grid can be used to modify them.
+	inline void reference_area_block_coords_for_write(
+			VoxelDataMap &map,
+			RWLock &map_lock,
+			const Box3i blocks_box,
+			SpatialLock3D &spatial_lock
+	) {
+		ZN_PROFILE_SCOPE();
+		create(blocks_box.size, map.get_block_size());
+
+		_offset_in_blocks = blocks_box.position;
+		_logical_offset_in_blocks = blocks_box.position;
+
+		// Locking for write because blocks may have their voxels replaced by a copy
+		spatial_lock.lock_write(blocks_box);
+
+		{
+			RWLockRead rlock(map_lock);
+			blocks_box.for_each_cell_zxy([&map, this](const Vector3i pos) {
+				VoxelDataBlock *block = map.get_block(pos);
+				if (block != nullptr && block->has_voxels()) {
+					block->unshare_voxels();
+					// Voxels are assumed to change once referenced for writing
+					block->mark_voxels_changed();
+					set_block(pos, block->get_voxels_shared());
+				} else {
+					set_block(pos, nullptr);
+				}
+			});
+		}
+
+		spatial_lock.unlock_write(blocks_box);
+
+		_spatial_lock = &spatial_lock;
+	}
+
 	inline bool has_any_block() const {
 		for (unsigned int i = 0; i < _blocks.size(); ++i) {
 			if (_blocks[i] != nullptr) {
@@ -0,0 +1,135 @@
+#ifndef VOXEL_DATA_READ_VIEW_H
+#define VOXEL_DATA_READ_VIEW_H
+
+#include "../constants/voxel_constants.h"
+#include "../util/containers/std_vector.h"
+#include "../util/math/box3i.h"
+#include "../util/thread/spatial_lock_3d.h"
+#include "voxel_buffer.h"
+#include <memory>
+
+namespace zylann::voxel {
+
+// Read-only access to voxels of all blocks intersecting an area, for bulk queries such as random ticks, AI sensing or
+// simulations. It is obtained with `VoxelData::acquire_read_view`.
+// Blocks are locked for reading as long as the view is acquired, so their voxels can be accessed directly, without
+// per-voxel locking or map lookups. Edits touching these blocks wait until the view is released, so views should be
+// short-lived. Editing blocks of the view from the thread holding it would deadlock.
+// Blocks can still be replaced entirely in the meantime (for example when loading responses arrive). The view keeps
+// references to the voxels it was acquired with, so these remain valid, but it won't see the new ones.
+class VoxelDataReadView {
+public:
+	struct ChannelData {
+		// Raw voxel values, indexed with `VoxelBuffer::get_index`. Empty if the channel is uniform.
+		Span<const uint8_t> bytes;
+		// Value of every voxel if the channel is uniform
+		uint64_t uniform_value = 0;
+		VoxelBuffer::Depth depth = VoxelBuffer::DEPTH_8_BIT;
+	};
+
+	VoxelDataReadView() {}
+
+	VoxelDataReadView(const VoxelDataReadView &) = delete;
+	VoxelDataReadView &operator=(const VoxelDataReadView &) = delete;
+
+	~VoxelDataReadView() {
+		release();
+	}
+
+	// Unlocks blocks. Voxels obtained from the view must not be accessed after this.
+	inline void release() {
+		if (_spatial_lock != nullptr) {
+			_spatial_lock->unlock_read(BoxBounds3i(_block_box));
+			_spatial_lock = nullptr;
+		}
+		_blocks.clear();
+	}
+
+	inline bool is_acquired() const {
+		return _spatial_lock != nullptr;
+	}
+
+	// Area covered by the view, in blocks
+	inline Box3i get_block_box() const {
+		return _block_box;
+	}
+
+	inline unsigned int get_block_size_po2() const {
+		return _block_size_po2;
+	}
+
+	// Gets voxels of a block. Returns null if the block is outside the view, not loaded, or if it has no voxels (which
+	// happens with blocks that were not edited, when they are not cached).
+	inline const VoxelBuffer *get_block(Vector3i block_pos) const {
+		const Vector3i rpos = block_pos - _block_box.position;
+		if (!Box3i(Vector3i(), _block_box.size).contains(rpos)) {
+			return nullptr;
+		}
+		return _blocks[Vector3iUtil::get_zxy_index(rpos, _block_box.size)].get();
+	}
+
+	// Gets direct access to a channel of a block. Returns false if the block isn't available.
+	inline bool try_get_block_channel(Vector3i block_pos, unsigned int channel_index, ChannelData &out_data) const {
+		const VoxelBuffer *voxels = get_block(block_pos);
+		if (voxels == nullptr) {
+			return false;
+		}
+		out_data.depth = voxels->get_channel_depth(channel_index);
+		if (voxels->is_uniform(channel_index)) {
+			out_data.bytes = Span<const uint8_t>();
+			out_data.uniform_value = voxels->get_voxel(Vector3i(), channel_index);
+		} else {
+			ZN_ASSERT_RETURN_V(voxels->get_channel_as_bytes_read_only(channel_index, out_data.bytes), false);
+		}
+		return true;
+	}
+
+	// Gets a single voxel. Returns false if its block isn't available.
+	inline bool try_get_voxel(Vector3i pos, unsigned int channel_index, uint64_t &out_value) const {
+		const VoxelBuffer *voxels = get_block(pos >> _block_size_po2);
+		if (voxels == nullptr) {
+			return false;
+		}
+		const int mask = (1 << _block_size_po2) - 1;
+		out_value = voxels->get_voxel(pos & mask, channel_index);
+		return true;
+	}
+
+	inline bool try_get_voxel_f(Vector3i pos, unsigned int channel_index, float &out_value) const {
+		const VoxelBuffer *voxels = get_block(pos >> _block_size_po2);
+		if (voxels == nullptr) {
+			return false;
+		}
+		const int mask = (1 << _block_size_po2) - 1;
+		out_value = voxels->get_voxel_f(pos & mask, channel_index);
+		return true;
+	}
+
+	// Calls `f(Vector3i block_pos, const VoxelBuffer &voxels)` for every available block of the view.
+	template <typename F>
+	void for_each_block(F f) const {
+		unsigned int index = 0;
+		_block_box.for_each_cell_zxy([this, &index, &f](Vector3i block_pos) {
+			const VoxelBuffer *voxels = _blocks[index].get();
+			++index;
+			if (voxels != nullptr) {
+				f(block_pos, *voxels);
+			}
+		});
+	}
+
+private:
+	friend class VoxelData;
+
+	Box3i _block_box;
+	unsigned int _block_size_po2 = constants::DEFAULT_BLOCK_SIZE_PO2;
+	// Flat grid indexed in ZXY order. Voxels are referenced rather than snapshotted: the spatial lock prevents them
+	// from being modified in place, so they don't need to be copied by writers.
+	StdVector<std::shared_ptr<const VoxelBuffer>> _blocks;
+	// Not owned. Lifetime must be guaranteed by the user, for example with a std::shared_ptr<VoxelData>.
+	SpatialLock3D *_spatial_lock = nullptr;
+};
+
+} // namespace zylann::voxel
+
+#endif // VOXEL_DATA_READ_VIEW_H
@@ -0,0 +1,313 @@
+#include "voxel_edit_journal.h"
+#include "../util/io/serialization.h"
+#include "../util/memory/linear_allocator.h"
+#include "../util/profiling.h"
+#include "voxel_buffer.h"
+#include <cstring>
+
+namespace zylann::voxel {
+
+namespace {
+
+// Unchanged bytes between two changed ones are included in the same run if there are fewer than this, since starting a
+// new run costs 8 bytes
+static const unsigned int MIN_GAP_BETWEEN_RUNS = 8;
+
+template <typename T>
+void fill_as(Span<uint8_t> dst, uint64_t value) {
+	dst.reinterpret_cast_to<T>().fill(static_cast<T>(value));
+}
+
+// Gets the bytes of a channel. Uniform channels are expanded into `storage`.
+Span<const uint8_t> get_channel_bytes(
+		const VoxelBuffer &voxels,
+		unsigned int channel_index,
+		StdTempVector<uint8_t> &storage
+) {
+	if (!voxels.is_uniform(channel_index)) {
+		Span<const uint8_t> bytes;
+		ZN_ASSERT(voxels.get_channel_as_bytes_read_only(channel_index, bytes));
+		return bytes;
+	}
+
+	const VoxelBuffer::Depth depth = voxels.get_channel_depth(channel_index);
+	const uint64_t value = voxels.get_voxel(Vector3i(), channel_index);
+	storage.resize(VoxelBuffer::get_size_in_bytes_for_volume(voxels.get_size(), depth));
+	Span<uint8_t> bytes = to_span(storage);
+
+	switch (depth) {
+		case VoxelBuffer::DEPTH_8_BIT:
+			fill_as<uint8_t>(bytes, value);
+			break;
+		case VoxelBuffer::DEPTH_16_BIT:
+			fill_as<uint16_t>(bytes, value);
+			break;
+		case VoxelBuffer::DEPTH_32_BIT:
+			fill_as<uint32_t>(bytes, value);
+			break;
+		case VoxelBuffer::DEPTH_64_BIT:
+			fill_as<uint64_t>(bytes, value);
+			break;
+		default:
+			ZN_CRASH();
+	}
+
+	return bytes;
+}
+
+void write_runs(Span<const uint8_t> before, Span<const uint8_t> after, StdVector<uint8_t> &runs) {
+	MemoryWriter writer(runs, ENDIANNESS_LITTLE_ENDIAN);
+	const size_t size = after.size();
+	size_t previous_end = 0;
+	size_t i = 0;
+
+	while (i < size) {
+		if (before[i] == after[i]) {
+			++i;
+			continue;
+		}
+
+		const size_t begin = i;
+		size_t end = i + 1;
+		for (size_t j = end; j < size && j - end < MIN_GAP_BETWEEN_RUNS; ++j) {
+			if (before[j] != after[j]) {
+				end = j + 1;
+			}
+		}
+
+		const size_t count = end - begin;
+		writer.store_32(begin - previous_end);
+		writer.store_32(count);
+		writer.store_buffer(before.sub(begin, count));
+		writer.store_buffer(after.sub(begin, count));
+
+		previous_end = end;
+		i = end;
+	}
+}
+
+void apply_runs(Span<const uint8_t> runs, Span<uint8_t> dst, bool undo) {
+	MemoryReader reader(runs, ENDIANNESS_LITTLE_ENDIAN);
+	size_t pos = 0;
+
+	while (reader.pos < runs.size()) {
+		pos += reader.get_32();
+		const uint32_t count = reader.get_32();
+		ZN_ASSERT_RETURN(pos + count <= dst.size());
+		ZN_ASSERT_RETURN(reader.pos + 2 * count <= runs.size());
+
+		const uint8_t *src = runs.data() + reader.pos + (undo ? 0 : count);
+		memcpy(dst.data() + pos, src, count);
+
+		reader.pos += 2 * count;
+		pos += count;
+	}
+}
+
+size_t get_edit_size_in_bytes(const VoxelEditJournal::Edit &edit) {
+	size_t size = sizeof(VoxelEditJournal::Edit) + edit.blocks.capacity() * sizeof(VoxelEditJournal::BlockDelta);
+	for (const VoxelEditJournal::BlockDelta &block : edit.blocks) {
+		size += block.channels.capacity() * sizeof(VoxelEditJournal::ChannelDelta);
+		for (const VoxelEditJournal::ChannelDelta &channel : block.channels) {
+			size += channel.runs.capacity();
+		}
+	}
+	return size;
+}
+
+// Removes edits from the front of the stack until the size fits the capacity, in a single erase
+void evict_front(StdVector<VoxelEditJournal::Edit> &stack, size_t &size_in_bytes, size_t capacity) {
+	unsigned int count = 0;
+	while (size_in_bytes > capacity && count < stack.size()) {
+		size_in_bytes -= stack[count].size_in_bytes;
+		++count;
+	}
+	if (count > 0) {
+		stack.erase(stack.begin(), stack.begin() + count);
+	}
+}
+
+void apply_channel_deltas(Span<const VoxelEditJournal::ChannelDelta> channel_deltas, VoxelBuffer &voxels, bool undo) {
+	for (const VoxelEditJournal::ChannelDelta &channel_delta : channel_deltas) {
+		ZN_ASSERT_CONTINUE(voxels.get_channel_depth(channel_delta.channel_index) == channel_delta.depth);
+
+		voxels.decompress_channel(channel_delta.channel_index);
+		Span<uint8_t> bytes;
+		ZN_ASSERT_CONTINUE(voxels.get_channel_as_bytes(channel_delta.channel_index, bytes));
+
+		apply_runs(to_span(channel_delta.runs), bytes, undo);
+	}
+}
+
+} // namespace
+
+void VoxelEditJournal::set_capacity(size_t capacity_in_bytes) {
+	MutexLock mlock(_mutex);
+	_capacity = capacity_in_bytes;
+	_enabled.store(capacity_in_bytes > 0, std::memory_order_relaxed);
+	evict_no_lock();
+}
+
+size_t VoxelEditJournal::get_capacity() const {
+	MutexLock mlock(_mutex);
+	return _capacity;
+}
+
+void VoxelEditJournal::push(Edit &&edit) {
+	edit.size_in_bytes = get_edit_size_in_bytes(edit);
+
+	MutexLock mlock(_mutex);
+
+	for (const Edit &undone_edit : _redo_stack) {
+		_size_in_bytes -= undone_edit.size_in_bytes;
+	}
+	_redo_stack.clear();
+
+	if (edit.size_in_bytes > _capacity) {
+		// Would not fit, or the journal is disabled. Older edits can't be undone correctly without undoing this one
+		// first, so they are forgotten too.
+		_undo_stack.clear();
+		_size_in_bytes = 0;
+		return;
+	}
+
+	_size_in_bytes += edit.size_in_bytes;
+	_undo_stack.push_back(std::move(edit));
+	evict_no_lock();
+}
+
+bool VoxelEditJournal::pop_undo(Edit &out_edit) {
+	MutexLock mlock(_mutex);
+	if (_undo_stack.size() == 0) {
+		return false;
+	}
+	out_edit = std::move(_undo_stack.back());
+	_undo_stack.pop_back();
+	_size_in_bytes -= out_edit.size_in_bytes;
+	return true;
+}
+
+void VoxelEditJournal::push_undone(Edit &&edit) {
+	MutexLock mlock(_mutex);
+	_size_in_bytes += edit.size_in_bytes;
+	_redo_stack.push_back(std::move(edit));
+	evict_no_lock();
+}
+
+bool VoxelEditJournal::pop_redo(Edit &out_edit) {
+	MutexLock mlock(_mutex);
+	if (_redo_stack.size() == 0) {
+		return false;
+	}
+	out_edit = std::move(_redo_stack.back());
+	_redo_stack.pop_back();
+	_size_in_bytes -= out_edit.size_in_bytes;
+	return true;
+}
+
+void VoxelEditJournal::push_redone(Edit &&edit) {
+	MutexLock mlock(_mutex);
+	_size_in_bytes += edit.size_in_bytes;
+	_undo_stack.push_back(std::move(edit));
+	evict_no_lock();
+}
+
+void VoxelEditJournal::clear() {
+	MutexLock mlock(_mutex);
+	_undo_stack.clear();
+	_redo_stack.clear();
+	_size_in_bytes = 0;
+}
+
+unsigned int VoxelEditJournal::get_undo_count() const {
+	MutexLock mlock(_mutex);
+	return _undo_stack.size();
+}
+
+unsigned int VoxelEditJournal::get_redo_count() const {
+	MutexLock mlock(_mutex);
+	return _redo_stack.size();
+}
+
+size_t VoxelEditJournal::get_size_in_bytes() const {
+	MutexLock mlock(_mutex);
+	return _size_in_bytes;
+}
+
+void VoxelEditJournal::evict_no_lock() {
+	// Oldest edits are forgotten first, then edits that are the furthest to redo
+	evict_front(_undo_stack, _size_in_bytes, _capacity);
+	evict_front(_redo_stack, _size_in_bytes, _capacity);
+}
+
+bool VoxelEditJournal::compute_block_delta(const VoxelBuffer &before, const VoxelBuffer &after, BlockDelta &out_delta) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN_V(before.get_size() == after.get_size(), false);
+
+	bool changed = false;
+
+	for (unsigned int channel_index = 0; channel_index < VoxelBuffer::MAX_CHANNELS; ++channel_index) {
+		const VoxelBuffer::Depth depth = after.get_channel_depth(channel_index);
+		ZN_ASSERT_CONTINUE(before.get_channel_depth(channel_index) == depth);
+
+		if (before.is_uniform(channel_index) && after.is_uniform(channel_index) &&
+			before.get_voxel(Vector3i(), channel_index) == after.get_voxel(Vector3i(), channel_index)) {
+			continue;
+		}
+
+		LinearAllocator &allocator = get_tls_temp_allocator();
+		LinearAllocatorScope las(allocator);
+		StdTempVector<uint8_t> before_storage(allocator);
+		StdTempVector<uint8_t> after_storage(allocator);
+
+		const Span<const uint8_t> before_bytes = get_channel_bytes(before, channel_index, before_storage);
+		const Span<const uint8_t> after_bytes = get_channel_bytes(after, channel_index, after_storage);
+		ZN_ASSERT_CONTINUE(before_bytes.size() == after_bytes.size());
+
+		if (memcmp(before_bytes.data(), after_bytes.data(), after_bytes.size()) == 0) {
+			continue;
+		}
+
+		ChannelDelta channel_delta;
+		channel_delta.channel_index = channel_index;
+		channel_delta.depth = depth;
+		write_runs(before_bytes, after_bytes, channel_delta.runs);
+		channel_delta.runs.shrink_to_fit();
+
+		out_delta.channels.push_back(std::move(channel_delta));
+		changed = true;
+	}
+
+	return changed;
+}
+
+void VoxelEditJournal::apply_block_delta(const BlockDelta &delta, VoxelBuffer &voxels, bool undo) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN(Box3i(Vector3i(), voxels.get_size()).contains(delta.box));
+
+	if (delta.box.size == voxels.get_size()) {
+		apply_channel_deltas(to_span(delta.channels), voxels, undo);
+		return;
+	}
+
+	// Runs are relative to voxels of the box
+	VoxelBuffer box_voxels(VoxelBuffer::ALLOCATOR_POOL);
+	copy_voxels_in_box(voxels, delta.box, box_voxels);
+	apply_channel_deltas(to_span(delta.channels), box_voxels, undo);
+
+	for (const ChannelDelta &channel_delta : delta.channels) {
+		voxels.copy_channel_from(
+				box_voxels, Vector3i(), box_voxels.get_size(), delta.box.position, channel_delta.channel_index
+		);
+	}
+}
+
+void VoxelEditJournal::copy_voxels_in_box(const VoxelBuffer &src, Box3i box, VoxelBuffer &dst) {
+	dst.copy_format(src);
+	dst.create(box.size);
+	for (unsigned int channel_index = 0; channel_index < VoxelBuffer::MAX_CHANNELS; ++channel_index) {
+		dst.copy_channel_from(src, box.position, box.position + box.size, Vector3i(), channel_index);
+	}
+}
+
+} // namespace zylann::voxel
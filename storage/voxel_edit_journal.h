@@ -0,0 +1,114 @@
+#ifndef VOXEL_EDIT_JOURNAL_H
+#define VOXEL_EDIT_JOURNAL_H
+
+#include "../util/containers/std_vector.h"
+#include "../util/math/box3i.h"
+#include "../util/math/vector3i.h"
+#include "../util/memory/memory.h"
+#include "../util/thread/mutex.h"
+#include <atomic>
+#include <memory>
+
+namespace zylann::voxel {
+
+class VoxelBuffer;
+
+// Keeps a history of edits done on voxel data, so they can be undone and redone.
+// Edits are not stored as full copies of voxels. Instead, each edited block stores runs of bytes that changed in each
+// of its channels, with their values before and after the edit. So memory usage and the cost of undoing are
+// proportional to the amount of voxels that changed, not to the size of the edited area.
+// Memory usage is bounded. When full, oldest edits are forgotten first.
+// It is thread-safe.
+class VoxelEditJournal {
+public:
+	struct ChannelDelta {
+		uint8_t channel_index = 0;
+		uint8_t depth = 0;
+		// Sequence of runs of changed bytes. Each run is: offset from the end of the previous run (32-bit), byte count
+		// (32-bit), bytes before the edit, bytes after the edit.
+		StdVector<uint8_t> runs;
+	};
+
+	struct BlockDelta {
+		// Position of the block at LOD0, in blocks
+		Vector3i position;
+		// Area of the block the edit was recorded in, in voxels relative to the block. Runs of bytes are relative to
+		// voxels of that area only.
+		Box3i box;
+		StdVector<ChannelDelta> channels;
+	};
+
+	struct Edit {
+		StdVector<BlockDelta> blocks;
+		size_t size_in_bytes = 0;
+	};
+
+	// State of blocks captured before an edit, so the edit can be recorded once it is done.
+	// Only voxels within the edited area are captured, so the cost is proportional to its size rather than to the size
+	// of the blocks it touches.
+	struct Recording {
+		struct Block {
+			Vector3i position;
+			// Area of the block being edited, in voxels relative to the block
+			Box3i box;
+			uint64_t voxels_version = 0;
+			// Copy of voxels in the area before the edit
+			UniquePtr<VoxelBuffer> voxels;
+		};
+		StdVector<Block> blocks;
+		bool active = false;
+	};
+
+	// Capacity is in bytes. 0 means disabled, and clears the journal.
+	void set_capacity(size_t capacity_in_bytes);
+	size_t get_capacity() const;
+
+	inline bool is_enabled() const {
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	// Records a new edit. Edits that were undone can no longer be redone.
+	void push(Edit &&edit);
+
+	// Takes the last edit to undo. Once applied, it should be given back with `push_undone`.
+	bool pop_undo(Edit &out_edit);
+	void push_undone(Edit &&edit);
+
+	// Takes the last undone edit to redo. Once applied, it should be given back with `push_redone`.
+	bool pop_redo(Edit &out_edit);
+	void push_redone(Edit &&edit);
+
+	void clear();
+
+	unsigned int get_undo_count() const;
+	unsigned int get_redo_count() const;
+	size_t get_size_in_bytes() const;
+
+	// Compares two states of the same block and appends the channels that differ to `out_delta`.
+	// Returns false if they don't differ.
+	static bool compute_block_delta(const VoxelBuffer &before, const VoxelBuffer &after, BlockDelta &out_delta);
+
+	// Writes voxels recorded in the delta into a block, either the values they had before the edit (`undo` is true),
+	// or after the edit. Voxels that were not changed by the edit are left untouched.
+	static void apply_block_delta(const BlockDelta &delta, VoxelBuffer &voxels, bool undo);
+
+	// Copies all channels of voxels within a box of `src` into `dst`, which is resized to the size of the box.
+	// Metadata is not copied.
+	static void copy_voxels_in_box(const VoxelBuffer &src, Box3i box, VoxelBuffer &dst);
+
+private:
+	void evict_no_lock();
+
+	// Oldest edits first
+	StdVector<Edit> _undo_stack;
+	// Edits furthest to redo first
+	StdVector<Edit> _redo_stack;
+	size_t _capacity = 0;
+	size_t _size_in_bytes = 0;
+	std::atomic_bool _enabled = { false };
+	Mutex _mutex;
+};
+
+} // namespace zylann::voxel
+
+#endif // VOXEL_EDIT_JOURNAL_H
@@ -1,11 +1,16 @@
 #include "load_block_data_task.h"
+#include "../engine/buffered_task_scheduler.h"
 #include "../engine/voxel_engine.h"
 #include "../generators/generate_block_task.h"
 #include "../storage/voxel_buffer.h"
 #include "../storage/voxel_data.h"
 #include "../util/dstack.h"
 #include "../util/io/log.h"
+#include "../util/memory/linear_allocator.h"
 #include "../util/profiling.h"
+#include "../util/profiling_clock.h"
+#include "stream_metrics.h"
+#include <algorithm>
 
 namespace zylann::voxel {
 
@@ -15,19 +20,14 @@ std::atomic_int g_debug_load_block_tasks_count = { 0 };
 
 LoadBlockDataTask::LoadBlockDataTask(
 		VolumeID p_volume_id,
-		Vector3i p_block_pos,
 		uint8_t p_lod,
 		uint8_t p_block_size,
 		bool p_request_instances,
 		std::shared_ptr<StreamingDependency> p_stream_dependency,
-		PriorityDependency p_priority_dependency,
 		bool generate_cache_data,
 		bool generator_use_gpu,
-		const std::shared_ptr<VoxelData> &vdata,
-		TaskCancellationToken cancellation_token
+		const std::shared_ptr<VoxelData> &vdata
 ) :
-		_priority_dependency(p_priority_dependency),
-		_position(p_block_pos),
 		_volume_id(p_volume_id),
 		_lod_index(p_lod),
 		_block_size(p_block_size),
@@ -40,8 +40,7 @@ LoadBlockDataTask::LoadBlockDataTask(
 #endif
 		//_request_voxels(true),
 		_stream_dependency(p_stream_dependency),
-		_voxel_data(vdata),
-		_cancellation_token(cancellation_token) {
+		_voxel_data(vdata) {
 	//
 	++g_debug_load_block_tasks_count;
 }
@@ -54,6 +53,26 @@ int LoadBlockDataTask::debug_get_running_count() {
 	return g_debug_load_block_tasks_count;
 }
 
+void LoadBlockDataTask::add_block(
+		Vector3i p_block_pos,
+		PriorityDependency p_priority_dependency,
+		TaskCancellationToken p_cancellation_token
+) {
+	ZN_ASSERT_RETURN(_blocks.size() < MAX_BATCH_SIZE);
+	Block block;
+	block.position = p_block_pos;
+	block.priority_dependency = p_priority_dependency;
+	block.cancellation_token = p_cancellation_token;
+	_blocks.push_back(std::move(block));
+}
+
+bool LoadBlockDataTask::Block::is_cancelled() const {
+	if (cancellation_token.is_valid()) {
+		return cancellation_token.is_cancelled();
+	}
+	return too_far;
+}
+
 void LoadBlockDataTask::run(zylann::ThreadedTaskContext &ctx) {
 	ZN_DSTACK();
 	ZN_PROFILE_SCOPE();
@@ -62,97 +81,178 @@ void LoadBlockDataTask::run(zylann::ThreadedTaskContext &ctx) {
 	Ref<VoxelStream> stream = _stream_dependency->stream;
 	CRASH_COND(stream.is_null());
 
-	ERR_FAIL_COND(_voxels != nullptr);
-	_voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
 	const VoxelFormat format = _voxel_data->get_format();
-	_voxels->create(Vector3iUtil::create(_block_size), &format);
 
-	// TODO We should consider batching this again, but it needs to be done carefully.
-	// Each task is one block, and priority depends on distance to closest viewer.
-	// If we batch blocks, we have to do it by distance too.
+	LinearAllocatorScope temp_scope(ctx.temp_allocator);
+
+	// Indices of blocks queried from the stream, in the same order as queries.
+	// Blocks may have been cancelled individually while the task was waiting. Those are skipped, and will be reported
+	// as dropped.
+	StdTempVector<unsigned int> block_indices(ctx.temp_allocator);
+	block_indices.reserve(_blocks.size());
+
+	StdTempVector<VoxelStream::VoxelQueryData> voxel_queries(ctx.temp_allocator);
+	voxel_queries.reserve(_blocks.size());
+
+	for (unsigned int block_index = 0; block_index < _blocks.size(); ++block_index) {
+		Block &block = _blocks[block_index];
+		if (block.is_cancelled()) {
+			continue;
+		}
+		// Don't fail the whole batch, other blocks can still be loaded
+		ERR_CONTINUE(block.voxels != nullptr);
+		block_indices.push_back(block_index);
+		block.voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_POOL);
+		block.voxels->create(Vector3iUtil::create(_block_size), &format);
+		voxel_queries.push_back(
+				VoxelStream::VoxelQueryData{ *block.voxels, block.position, _lod_index, VoxelStream::RESULT_ERROR }
+		);
+	}
+
+	if (voxel_queries.size() == 0) {
+		return;
+	}
 
 	// TODO Assign max_lod_hint when available
 
-	VoxelStream::VoxelQueryData voxel_query_data{ *_voxels, _position, _lod_index, VoxelStream::RESULT_ERROR };
-	stream->load_voxel_block(voxel_query_data);
-
-	if (voxel_query_data.result == VoxelStream::RESULT_ERROR) {
-		ERR_PRINT("Error loading voxel block");
-
-	} else if (voxel_query_data.result == VoxelStream::RESULT_BLOCK_NOT_FOUND) {
-		if (_generate_cache_data) {
-			Ref<VoxelGenerator> generator = _stream_dependency->generator;
-
-			if (generator.is_valid()) {
-				VoxelGenerator::BlockTaskParams params;
-				params.voxels = _voxels;
-				params.volume_id = _volume_id;
-				params.block_position = _position;
-				params.format = format;
-				params.lod_index = _lod_index;
-				params.block_size = _block_size;
-				params.stream_dependency = _stream_dependency;
-				params.priority_dependency = _priority_dependency;
+	{
+		ProfilingClock clock;
+		stream->load_voxel_blocks(to_span(voxel_queries));
+		StreamMetrics &metrics = stream->get_metrics();
+		// Latency is recorded per block, so it stays comparable to streams that aren't batched
+		const uint64_t latency_per_block_usec = clock.get_elapsed_microseconds() / voxel_queries.size();
+
+		for (const VoxelStream::VoxelQueryData &q : voxel_queries) {
+			metrics.load_latency.add(latency_per_block_usec);
+
+			switch (q.result) {
+				case VoxelStream::RESULT_BLOCK_FOUND:
+					metrics.loaded_blocks.fetch_add(1, std::memory_order_relaxed);
+					metrics.loaded_bytes.fetch_add(
+							StreamMetrics::get_voxel_data_size(q.voxel_buffer), std::memory_order_relaxed
+					);
+					break;
+				case VoxelStream::RESULT_BLOCK_NOT_FOUND:
+					metrics.not_found_blocks.fetch_add(1, std::memory_order_relaxed);
+					break;
+				default:
+					metrics.errors.fetch_add(1, std::memory_order_relaxed);
+					break;
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < voxel_queries.size(); ++i) {
+		const VoxelStream::VoxelQueryData &q = voxel_queries[i];
+		Block &block = _blocks[block_indices[i]];
+
+		if (q.result == VoxelStream::RESULT_ERROR) {
+			ERR_PRINT("Error loading voxel block");
+
+		} else if (q.result == VoxelStream::RESULT_BLOCK_NOT_FOUND) {
+			if (_generate_cache_data) {
+				Ref<VoxelGenerator> generator = _stream_dependency->generator;
+
+				if (generator.is_valid()) {
+					VoxelGenerator::BlockTaskParams params;
+					params.voxels = block.voxels;
+					params.volume_id = _volume_id;
+					params.block_position = block.position;
+					params.format = format;
+					params.lod_index = _lod_index;
+					params.block_size = _block_size;
+					params.stream_dependency = _stream_dependency;
+					params.priority_dependency = block.priority_dependency;
 #ifdef VOXEL_ENABLE_GPU
-				params.use_gpu = _generator_use_gpu;
+					params.use_gpu = _generator_use_gpu;
 #endif
-				params.data = _voxel_data;
+					params.data = _voxel_data;
 
-				IThreadedTask *task = generator->create_block_task(params);
+					IThreadedTask *task = generator->create_block_task(params);
 
-				VoxelEngine::get_singleton().push_async_task(task);
-				_requested_generator_task = true;
+					VoxelEngine::get_singleton().push_async_task(task);
+					block.requested_generator_task = true;
 
+				} else {
+					// If there is no generator... what do we do? What defines the format of that empty block?
+					// If the user leaves the defaults it's fine, but otherwise blocks of inconsistent format can
+					// end up in the volume and that can cause errors.
+					// TODO Define format on volume?
+				}
 			} else {
-				// If there is no generator... what do we do? What defines the format of that empty block?
-				// If the user leaves the defaults it's fine, but otherwise blocks of inconsistent format can
-				// end up in the volume and that can cause errors.
-				// TODO Define format on volume?
+				block.voxels.reset();
 			}
-		} else {
-			_voxels.reset();
 		}
 	}
 
 #ifdef VOXEL_ENABLE_INSTANCER
 	if (_request_instances && stream->supports_instance_blocks()) {
-		ERR_FAIL_COND(_instances != nullptr);
+		// Indices of voxel queries, in the same order as instance queries
+		StdTempVector<unsigned int> query_indices(ctx.temp_allocator);
+		query_indices.reserve(block_indices.size());
+
+		StdTempVector<VoxelStream::InstancesQueryData> instance_queries(ctx.temp_allocator);
+		instance_queries.reserve(block_indices.size());
+
+		for (unsigned int i = 0; i < block_indices.size(); ++i) {
+			const Block &block = _blocks[block_indices[i]];
+			ERR_CONTINUE(block.instances != nullptr);
+			query_indices.push_back(i);
+			VoxelStream::InstancesQueryData q;
+			q.lod_index = _lod_index;
+			q.position_in_blocks = block.position;
+			instance_queries.push_back(std::move(q));
+		}
 
-		VoxelStream::InstancesQueryData instances_query;
-		instances_query.lod_index = _lod_index;
-		instances_query.position_in_blocks = _position;
-		stream->load_instance_blocks(Span<VoxelStream::InstancesQueryData>(&instances_query, 1));
+		stream->load_instance_blocks(to_span(instance_queries));
 
-		if (instances_query.result == VoxelStream::RESULT_ERROR) {
-			ERR_PRINT("Error loading instance block");
+		for (unsigned int i = 0; i < instance_queries.size(); ++i) {
+			VoxelStream::InstancesQueryData &q = instance_queries[i];
+			const unsigned int query_index = query_indices[i];
 
-		} else if (voxel_query_data.result == VoxelStream::RESULT_BLOCK_FOUND) {
-			_instances = std::move(instances_query.data);
+			if (q.result == VoxelStream::RESULT_ERROR) {
+				ERR_PRINT("Error loading instance block");
+
+			} else if (voxel_queries[query_index].result == VoxelStream::RESULT_BLOCK_FOUND) {
+				_blocks[block_indices[query_index]].instances = std::move(q.data);
+			}
+			// If not found, instances will return null,
+			// which means it can be generated by the instancer after the meshing process
 		}
-		// If not found, instances will return null,
-		// which means it can be generated by the instancer after the meshing process
 	}
 #endif
 
-	_has_run = true;
+	for (const unsigned int block_index : block_indices) {
+		_blocks[block_index].has_run = true;
+	}
 }
 
 TaskPriority LoadBlockDataTask::get_priority() {
-	float closest_viewer_distance_sq;
-	const TaskPriority p =
-			_priority_dependency.evaluate(_lod_index, constants::TASK_PRIORITY_LOAD_BAND2, &closest_viewer_distance_sq);
-	_too_far = closest_viewer_distance_sq > _priority_dependency.drop_distance_squared;
-	return p;
+	// The task is as urgent as its most urgent block
+	TaskPriority priority = TaskPriority::min();
+	for (Block &block : _blocks) {
+		float closest_viewer_distance_sq;
+		const TaskPriority p = block.priority_dependency.evaluate(
+				_lod_index, constants::TASK_PRIORITY_LOAD_BAND2, &closest_viewer_distance_sq
+		);
+		block.too_far = closest_viewer_distance_sq > block.priority_dependency.drop_distance_squared;
+		if (!block.is_cancelled() && p > priority) {
+			priority = p;
+		}
+	}
+	return priority;
 }
 
 bool LoadBlockDataTask::is_cancelled() {
 	if (_stream_dependency->valid == false) {
 		return true;
 	}
-	if (_cancellation_token.is_valid()) {
-		return _cancellation_token.is_cancelled();
+	for (const Block &block : _blocks) {
+		if (!block.is_cancelled()) {
+			return false;
+		}
 	}
-	return _too_far;
+	return true;
 }
 
 void LoadBlockDataTask::apply_result() {
@@ -160,22 +260,30 @@ void LoadBlockDataTask::apply_result() {
 		// TODO Comparing pointer may not be guaranteed
 		// The request response must match the dependency it would have been requested with.
 		// If it doesn't match, we are no longer interested in the result.
-		if (_stream_dependency->valid && !_requested_generator_task) {
-			VoxelEngine::BlockDataOutput o;
-			o.voxels = _voxels;
+		if (_stream_dependency->valid) {
+			VoxelEngine::VolumeCallbacks callbacks = VoxelEngine::get_singleton().get_volume_callbacks(_volume_id);
+			CRASH_COND(callbacks.data_output_callback == nullptr);
+
+			for (Block &block : _blocks) {
+				if (block.requested_generator_task) {
+					// The generator task will output the block
+					continue;
+				}
+
+				VoxelEngine::BlockDataOutput o;
+				o.voxels = block.voxels;
 #ifdef VOXEL_ENABLE_INSTANCER
-			o.instances = std::move(_instances);
+				o.instances = std::move(block.instances);
 #endif
-			o.position = _position;
-			o.lod_index = _lod_index;
-			o.dropped = !_has_run;
-			o.max_lod_hint = _max_lod_hint;
-			o.initial_load = false;
-			o.type = VoxelEngine::BlockDataOutput::TYPE_LOADED;
+				o.position = block.position;
+				o.lod_index = _lod_index;
+				o.dropped = !block.has_run;
+				o.max_lod_hint = _max_lod_hint;
+				o.initial_load = false;
+				o.type = VoxelEngine::BlockDataOutput::TYPE_LOADED;
 
-			VoxelEngine::VolumeCallbacks callbacks = VoxelEngine::get_singleton().get_volume_callbacks(_volume_id);
-			CRASH_COND(callbacks.data_output_callback == nullptr);
-			callbacks.data_output_callback(callbacks.data, o);
+				callbacks.data_output_callback(callbacks.data, o);
+			}
 		}
 
 	} else {
@@ -184,4 +292,93 @@ void LoadBlockDataTask::apply_result() {
 	}
 }
 
+LoadBlockDataTaskBatcher::LoadBlockDataTaskBatcher(
+		VolumeID p_volume_id,
+		uint8_t p_block_size,
+		bool p_request_instances,
+		std::shared_ptr<StreamingDependency> p_stream_dependency,
+		bool generate_cache_data,
+		bool generator_use_gpu,
+		std::shared_ptr<VoxelData> vdata
+) :
+		_volume_id(p_volume_id),
+		_block_size(p_block_size),
+		_request_instances(p_request_instances),
+		_generate_cache_data(generate_cache_data),
+		_generator_use_gpu(generator_use_gpu),
+		_stream_dependency(p_stream_dependency),
+		_voxel_data(vdata) {}
+
+void LoadBlockDataTaskBatcher::add(
+		Vector3i block_pos,
+		uint8_t lod_index,
+		PriorityDependency priority_dependency,
+		TaskCancellationToken cancellation_token
+) {
+	const TaskPriority priority =
+			priority_dependency.evaluate(lod_index, constants::TASK_PRIORITY_LOAD_BAND2, nullptr);
+	// Closer blocks sort first
+	const uint64_t band = (TaskPriority::BAND_MAX - priority.band0) >> PRIORITY_BAND_SIZE_PO2;
+	const Vector3i neighborhood = block_pos >> NEIGHBORHOOD_SIZE_PO2;
+
+	Request request;
+	request.key = (uint64_t(lod_index) << 56) | (band << 48) | ((uint64_t(neighborhood.x) & 0xffff) << 32) |
+			((uint64_t(neighborhood.y) & 0xffff) << 16) | (uint64_t(neighborhood.z) & 0xffff);
+	request.position = block_pos;
+	request.lod_index = lod_index;
+	request.priority_dependency = priority_dependency;
+	request.cancellation_token = cancellation_token;
+	_requests.push_back(std::move(request));
+}
+
+void LoadBlockDataTaskBatcher::flush(BufferedTaskScheduler &scheduler) {
+	StdVector<LoadBlockDataTask *> tasks;
+	flush(tasks);
+	for (LoadBlockDataTask *task : tasks) {
+		scheduler.push_io_task(task);
+	}
+}
+
+void LoadBlockDataTaskBatcher::flush(StdVector<LoadBlockDataTask *> &out_tasks) {
+	ZN_PROFILE_SCOPE();
+
+	struct RequestComparator {
+		inline bool operator()(const Request &a, const Request &b) const {
+			return a.key < b.key;
+		}
+	};
+	// Stable, so the order in which blocks were requested is kept within batches
+	std::stable_sort(_requests.begin(), _requests.end(), RequestComparator());
+
+	LoadBlockDataTask *task = nullptr;
+	uint64_t task_key = 0;
+
+	for (const Request &request : _requests) {
+		const bool batch_full = task != nullptr && task->get_block_count() == LoadBlockDataTask::MAX_BATCH_SIZE;
+		if (task == nullptr || request.key != task_key || batch_full) {
+			if (task != nullptr) {
+				out_tasks.push_back(task);
+			}
+			task = ZN_NEW(LoadBlockDataTask(
+					_volume_id,
+					request.lod_index,
+					_block_size,
+					_request_instances,
+					_stream_dependency,
+					_generate_cache_data,
+					_generator_use_gpu,
+					_voxel_data
+			));
+			task_key = request.key;
+		}
+		task->add_block(request.position, request.priority_dependency, request.cancellation_token);
+	}
+
+	if (task != nullptr) {
+		out_tasks.push_back(task);
+	}
+
+	_requests.clear();
+}
+
 } // namespace zylann::voxel
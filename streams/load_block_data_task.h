@@ -4,31 +4,48 @@
 #include "../engine/ids.h"
 #include "../engine/priority_dependency.h"
 #include "../engine/streaming_dependency.h"
+#include "../util/containers/std_vector.h"
 #include "../util/memory/memory.h"
+#include "../util/tasks/cancellation_token.h"
 #include "../util/tasks/threaded_task.h"
 
 namespace zylann::voxel {
 
 class VoxelData;
+class BufferedTaskScheduler;
 
+// Loads a batch of blocks of the same LOD from a stream, in a single call to `VoxelStream::load_voxel_blocks`.
+// Blocks not found in the stream are passed on to the generator.
+// Each block keeps its own priority and cancellation: the task runs as soon as its most urgent block would, and blocks
+// cancelled or gone too far in the meantime are skipped and reported as dropped.
 class LoadBlockDataTask : public IThreadedTask {
 public:
+	static const unsigned int MAX_BATCH_SIZE = 16;
+
 	LoadBlockDataTask(
 			VolumeID p_volume_id,
-			Vector3i p_block_pos,
 			uint8_t p_lod,
 			uint8_t p_block_size,
 			bool p_request_instances,
 			std::shared_ptr<StreamingDependency> p_stream_dependency,
-			PriorityDependency p_priority_dependency,
 			bool generate_cache_data,
 			bool generator_use_gpu,
-			const std::shared_ptr<VoxelData> &vdata,
-			TaskCancellationToken cancellation_token
+			const std::shared_ptr<VoxelData> &vdata
 	);
 
 	~LoadBlockDataTask();
 
+	// Must be called before the task is scheduled
+	void add_block(
+			Vector3i p_block_pos,
+			PriorityDependency p_priority_dependency,
+			TaskCancellationToken p_cancellation_token
+	);
+
+	unsigned int get_block_count() const {
+		return _blocks.size();
+	}
+
 	const char *get_debug_name() const override {
 		return "LoadBlockData";
 	}
@@ -41,30 +58,87 @@ public:
 	static int debug_get_running_count();
 
 private:
-	PriorityDependency _priority_dependency;
-	std::shared_ptr<VoxelBuffer> _voxels;
+	struct Block {
+		PriorityDependency priority_dependency;
+		TaskCancellationToken cancellation_token;
+		std::shared_ptr<VoxelBuffer> voxels;
 #ifdef VOXEL_ENABLE_INSTANCER
-	UniquePtr<InstanceBlockData> _instances;
+		UniquePtr<InstanceBlockData> instances;
 #endif
-	Vector3i _position; // In data blocks of the specified lod
+		Vector3i position; // In data blocks of the specified lod
+		bool has_run = false;
+		bool too_far = false;
+		bool requested_generator_task = false;
+
+		bool is_cancelled() const;
+	};
+
+	StdVector<Block> _blocks;
 	VolumeID _volume_id;
 	uint8_t _lod_index;
 	uint8_t _block_size;
-	bool _has_run = false;
-	bool _too_far = false;
 #ifdef VOXEL_ENABLE_INSTANCER
 	bool _request_instances = false;
 #endif
 	// bool _request_voxels = false;
 	bool _max_lod_hint = false;
 	bool _generate_cache_data = true;
-	bool _requested_generator_task = false;
 #ifdef VOXEL_ENABLE_GPU
 	bool _generator_use_gpu = false;
 #endif
 	std::shared_ptr<StreamingDependency> _stream_dependency;
 	std::shared_ptr<VoxelData> _voxel_data;
-	TaskCancellationToken _cancellation_token;
+};
+
+// Groups block loading requests into batched `LoadBlockDataTask`s.
+// Blocks are batched together when they have the same LOD, are in the same neighborhood and in the same priority band,
+// so blocks close to viewers don't wait behind far ones, and streams can read nearby blocks in one go.
+class LoadBlockDataTaskBatcher {
+public:
+	// Size of neighborhoods, in blocks
+	static const unsigned int NEIGHBORHOOD_SIZE_PO2 = 2;
+	// How many distance priority levels are grouped in the same band
+	static const unsigned int PRIORITY_BAND_SIZE_PO2 = 3;
+
+	LoadBlockDataTaskBatcher(
+			VolumeID p_volume_id,
+			uint8_t p_block_size,
+			bool p_request_instances,
+			std::shared_ptr<StreamingDependency> p_stream_dependency,
+			bool generate_cache_data,
+			bool generator_use_gpu,
+			std::shared_ptr<VoxelData> vdata
+	);
+
+	void add(
+			Vector3i block_pos,
+			uint8_t lod_index,
+			PriorityDependency priority_dependency,
+			TaskCancellationToken cancellation_token
+	);
+
+	// Creates tasks from requests added so far and pushes them to the scheduler
+	void flush(BufferedTaskScheduler &scheduler);
+	// Creates tasks from requests added so far. The caller takes ownership of them.
+	void flush(StdVector<LoadBlockDataTask *> &out_tasks);
+
+private:
+	struct Request {
+		uint64_t key;
+		Vector3i position;
+		uint8_t lod_index;
+		PriorityDependency priority_dependency;
+		TaskCancellationToken cancellation_token;
+	};
+
+	StdVector<Request> _requests;
+	VolumeID _volume_id;
+	uint8_t _block_size;
+	bool _request_instances;
+	bool _generate_cache_data;
+	bool _generator_use_gpu;
+	std::shared_ptr<StreamingDependency> _stream_dependency;
+	std::shared_ptr<VoxelData> _voxel_data;
 };
 
 } // namespace zylann::voxel
@@ -0,0 +1,150 @@
+#include "pre_generate_stream_task.h"
+#include "../storage/voxel_buffer.h"
+#include "../storage/voxel_data.h"
+#include "../util/containers/std_vector.h"
+#include "../util/io/log.h"
+#include "../util/memory/linear_allocator.h"
+#include "../util/profiling.h"
+#include "../util/profiling_clock.h"
+#include "../util/string/format.h"
+#include "../util/tasks/async_dependency_tracker.h"
+#include "stream_metrics.h"
+
+namespace zylann::voxel {
+
+PreGenerateStreamTask::PreGenerateStreamTask(
+		Box3i p_block_box,
+		std::shared_ptr<StreamingDependency> p_stream_dependency,
+		std::shared_ptr<VoxelData> p_data,
+		std::shared_ptr<AsyncDependencyTracker> p_tracker,
+		std::shared_ptr<std::atomic_uint32_t> p_remaining_regions
+) :
+		_block_box(p_block_box),
+		_stream_dependency(p_stream_dependency),
+		_data(p_data),
+		_tracker(p_tracker),
+		_remaining_regions(p_remaining_regions) {}
+
+std::shared_ptr<AsyncDependencyTracker> PreGenerateStreamTask::create_tasks(
+		Box3i block_box,
+		std::shared_ptr<StreamingDependency> stream_dependency,
+		std::shared_ptr<VoxelData> data,
+		StdVector<IThreadedTask *> &out_tasks
+) {
+	const Box3i regions_box = block_box.downscaled(REGION_SIZE_IN_BLOCKS);
+	const unsigned int region_count = Vector3iUtil::get_volume_u64(regions_box.size);
+
+	std::shared_ptr<AsyncDependencyTracker> tracker = make_shared_instance<AsyncDependencyTracker>(region_count);
+	std::shared_ptr<std::atomic_uint32_t> remaining_regions = make_shared_instance<std::atomic_uint32_t>(region_count);
+
+	out_tasks.reserve(out_tasks.size() + region_count);
+
+	regions_box.for_each_cell(
+			[&block_box, &stream_dependency, &data, &tracker, &remaining_regions, &out_tasks](Vector3i region_pos) {
+				const Box3i region_block_box(
+						region_pos * REGION_SIZE_IN_BLOCKS, Vector3iUtil::create(REGION_SIZE_IN_BLOCKS)
+				);
+				out_tasks.push_back(ZN_NEW(PreGenerateStreamTask(
+						region_block_box.clipped(block_box), stream_dependency, data, tracker, remaining_regions
+				)));
+			}
+	);
+
+	return tracker;
+}
+
+void PreGenerateStreamTask::run(ThreadedTaskContext &ctx) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT(_stream_dependency != nullptr);
+	ZN_ASSERT(_data != nullptr);
+	ZN_ASSERT(_tracker != nullptr);
+	ZN_ASSERT(_remaining_regions != nullptr);
+
+	if (_tracker->is_aborted()) {
+		return;
+	}
+	if (!_stream_dependency->valid) {
+		// The stream or generator changed in the meantime
+		_tracker->abort();
+		return;
+	}
+
+	Ref<VoxelStream> stream = _stream_dependency->stream;
+	Ref<VoxelGenerator> generator = _stream_dependency->generator;
+	if (stream.is_null() || generator.is_null()) {
+		_tracker->abort();
+		ZN_PRINT_ERROR("Pre-generation task was triggered without a stream or generator, this is a bug");
+		return;
+	}
+
+	const Vector3i block_size = Vector3iUtil::create(_data->get_block_size());
+	const VoxelFormat voxel_format = _data->get_format();
+	const unsigned int block_count = Vector3iUtil::get_volume_u64(_block_box.size);
+
+	LinearAllocatorScope temp_scope(ctx.temp_allocator);
+
+	StdVector<VoxelBuffer> voxels;
+	voxels.reserve(block_count);
+	StdTempVector<VoxelStream::VoxelQueryData> queries(ctx.temp_allocator);
+	queries.reserve(block_count);
+
+	_block_box.for_each_cell([&voxels, &queries, &block_size, &voxel_format](Vector3i block_pos) {
+		VoxelBuffer &block_voxels = voxels.emplace_back(VoxelBuffer::ALLOCATOR_POOL);
+		block_voxels.create(block_size, &voxel_format);
+		queries.push_back(VoxelStream::VoxelQueryData{ block_voxels, block_pos, 0, VoxelStream::RESULT_ERROR });
+	});
+
+	// Find which blocks are not saved yet. Blocks that were edited must not be overwritten.
+	stream->load_voxel_blocks(to_span(queries));
+
+	StdTempVector<VoxelStream::VoxelQueryData> to_save(ctx.temp_allocator);
+
+	for (VoxelStream::VoxelQueryData &q : queries) {
+		if (q.result != VoxelStream::RESULT_BLOCK_NOT_FOUND) {
+			if (q.result == VoxelStream::RESULT_ERROR) {
+				ZN_PRINT_ERROR(format(
+						"Could not load block {} from the stream, it won't be pre-generated", q.position_in_blocks
+				));
+			}
+			// Release memory early
+			q.voxel_buffer.clear(nullptr);
+			continue;
+		}
+
+		ZN_PROFILE_SCOPE_NAMED("Generate");
+		// Start from defaults, in case the stream wrote into the buffer
+		q.voxel_buffer.create(block_size, &voxel_format);
+		VoxelGenerator::VoxelQueryData gq{ q.voxel_buffer, q.position_in_blocks * block_size, 0 };
+		generator->generate_block(gq);
+#ifdef VOXEL_ENABLE_MODIFIERS
+		_data->get_modifiers().apply(gq.voxel_buffer, AABB(gq.origin_in_voxels, gq.voxel_buffer.get_size()));
+#endif
+		to_save.push_back(
+				VoxelStream::VoxelQueryData{ q.voxel_buffer, q.position_in_blocks, 0, VoxelStream::RESULT_ERROR }
+		);
+	}
+
+	if (to_save.size() > 0) {
+		ProfilingClock clock;
+		stream->save_voxel_blocks(to_span(to_save));
+		StreamMetrics &metrics = stream->get_metrics();
+		metrics.save_latency.add(clock.get_elapsed_microseconds());
+		metrics.saved_blocks.fetch_add(to_save.size(), std::memory_order_relaxed);
+	}
+
+	// Reading the tracker's count before completing it is not enough, two regions finishing at the same time could
+	// both see it above 1. A single decrement decides which one is last.
+	if (_remaining_regions->fetch_sub(1) == 1) {
+		// This was the last region to pre-generate. Flush before completing, so the tracker only reports completion
+		// once everything is written.
+		stream->flush();
+	}
+	_tracker->post_complete();
+}
+
+TaskPriority PreGenerateStreamTask::get_priority() {
+	// Pre-generation can take a long time, so other tasks go first, such as loading blocks near viewers
+	return TaskPriority::min();
+}
+
+} // namespace zylann::voxel
@@ -0,0 +1,67 @@
+#ifndef VOXEL_PRE_GENERATE_STREAM_TASK_H
+#define VOXEL_PRE_GENERATE_STREAM_TASK_H
+
+#include "../engine/streaming_dependency.h"
+#include "../util/containers/std_vector.h"
+#include "../util/math/box3i.h"
+#include "../util/memory/memory.h"
+#include "../util/tasks/threaded_task.h"
+#include <atomic>
+
+namespace zylann {
+
+class AsyncDependencyTracker;
+
+namespace voxel {
+
+class VoxelData;
+
+// Generates a region of blocks and saves them into the stream, without adding them to the terrain.
+// Blocks already present in the stream are left untouched.
+// This is used to pre-generate whole worlds, with many tasks running in parallel. Each task only holds the blocks of
+// its region, so memory usage remains bounded by the number of threads.
+class PreGenerateStreamTask : public IThreadedTask {
+public:
+	PreGenerateStreamTask(
+			Box3i p_block_box,
+			std::shared_ptr<StreamingDependency> p_stream_dependency,
+			std::shared_ptr<VoxelData> p_data,
+			std::shared_ptr<AsyncDependencyTracker> p_tracker,
+			std::shared_ptr<std::atomic_uint32_t> p_remaining_regions
+	);
+
+	// Each task generates and saves one region at a time. Regions are not too large so memory usage remains bounded,
+	// and not too small so stream queries are batched. Size is in data blocks of LOD0.
+	static const int REGION_SIZE_IN_BLOCKS = 8;
+
+	// Creates one task per region of the given box of LOD0 blocks. Returns a tracker counting these tasks.
+	static std::shared_ptr<AsyncDependencyTracker> create_tasks(
+			Box3i block_box,
+			std::shared_ptr<StreamingDependency> stream_dependency,
+			std::shared_ptr<VoxelData> data,
+			StdVector<IThreadedTask *> &out_tasks
+	);
+
+	const char *get_debug_name() const override {
+		return "PreGenerateStream";
+	}
+
+	void run(ThreadedTaskContext &ctx) override;
+	TaskPriority get_priority() override;
+
+private:
+	// In data blocks of LOD0
+	Box3i _block_box;
+	std::shared_ptr<StreamingDependency> _stream_dependency;
+	// Used for the format of voxels and modifiers
+	std::shared_ptr<VoxelData> _data;
+	std::shared_ptr<AsyncDependencyTracker> _tracker;
+	// Shared by all tasks of the same pre-generation. The task decrementing it to zero is the last one, and flushes
+	// the stream before completing the tracker.
+	std::shared_ptr<std::atomic_uint32_t> _remaining_regions;
+};
+
+} // namespace voxel
+} // namespace zylann
+
+#endif // VOXEL_PRE_GENERATE_STREAM_TASK_H
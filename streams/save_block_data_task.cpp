@@ -5,8 +5,10 @@
 #include "../util/godot/core/string.h"
 #include "../util/io/log.h"
 #include "../util/profiling.h"
+#include "../util/profiling_clock.h"
 #include "../util/string/format.h"
 #include "../util/tasks/async_dependency_tracker.h"
+#include "stream_metrics.h"
 
 namespace zylann::voxel {
 
@@ -86,15 +88,20 @@ void SaveBlockDataTask::run(zylann::ThreadedTaskContext &ctx) {
 			return;
 		}
 
-		VoxelBuffer voxels_copy(VoxelBuffer::ALLOCATOR_POOL);
-		// Note, we are not locking voxels here. This is supposed to be done at the time this task is scheduled.
-		// If this is not a copy, it means the map it came from is getting unloaded anyways.
-		// TODO Optimization: is that copy necessary? It's possible it was already done while issuing the
-		// request
-		_voxels->copy_to(voxels_copy, true);
-		_voxels = nullptr;
-		VoxelStream::VoxelQueryData q{ voxels_copy, _position, _lod, VoxelStream::RESULT_ERROR };
+		// Note, we are not locking voxels here, and not copying them either. They were either shared with
+		// copy-on-write by `VoxelData`, copied at the time this task was scheduled, or come from a map that is getting
+		// unloaded anyways. Streams only read voxels when saving.
+		VoxelStream::VoxelQueryData q{ *_voxels, _position, _lod, VoxelStream::RESULT_ERROR };
+
+		ProfilingClock clock;
 		stream->save_voxel_block(q);
+		StreamMetrics &metrics = stream->get_metrics();
+		metrics.save_latency.add(clock.get_elapsed_microseconds());
+		metrics.saved_blocks.fetch_add(1, std::memory_order_relaxed);
+		metrics.saved_bytes.fetch_add(StreamMetrics::get_voxel_data_size(*_voxels), std::memory_order_relaxed);
+
+		// Release early, so the block doesn't have to copy voxels if it gets modified while this task finishes
+		_voxels = nullptr;
 	}
 
 #ifdef VOXEL_ENABLE_INSTANCER
@@ -1,5 +1,7 @@
 #include "connection.h"
 #include "../../thirdparty/sqlite/sqlite3.h"
+#include "../../util/math/funcs.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 #include "../../util/string/format.h"
 
@@ -169,12 +171,71 @@ struct TransactionScope {
 // How long a connection waits for a lock held by another connection before giving up with SQLITE_BUSY.
 // Several connections of the same stream can be open on the same file at once (see VoxelStreamSQLite's connection
 // pool), so they do contend: a background streaming thread loading blocks, and a `flush()` called from game code,
-// for example. Transactions here are bounded (a cache flush writes at most VoxelStreamSQLite::CACHE_SIZE blocks), so
-// realistic waits are much shorter than this; the timeout is a safety net rather than an expected cost. It is kept
+// for example. Transactions here are bounded (a cache flush writes about as much as the stream's flush threshold),
+// so realistic waits are much shorter than this; the timeout is a safety net rather than an expected cost. It is kept
 // modest because `flush()` is callable from the main thread, where a long block would be a visible freeze, and
 // because exceeding it is no longer fatal: callers recover the connection with `rollback_transaction`.
 const int TRANSACTION_BUSY_TIMEOUT_MS = 1000;
 
+// Builds a statement repeating `row` a number of times, separated by commas
+StdString make_multi_row_sql(const char *prefix, const char *row, const unsigned int row_count, const char *suffix) {
+	StdString sql = prefix;
+	for (unsigned int i = 0; i < row_count; ++i) {
+		if (i > 0) {
+			sql += ",";
+		}
+		sql += row;
+	}
+	sql += suffix;
+	return sql;
+}
+
+inline bool bind_blob_or_null(sqlite3 *db, sqlite3_stmt *statement, int param_index, Span<const uint8_t> data) {
+	int rc;
+	if (data.size() == 0) {
+		rc = sqlite3_bind_null(statement, param_index);
+	} else {
+		// We use SQLITE_STATIC to tell SQLite we are managing that memory, which avoids a copy
+		rc = sqlite3_bind_blob(statement, param_index, data.data(), data.size(), SQLITE_STATIC);
+	}
+	if (rc != SQLITE_OK) {
+		ERR_PRINT(sqlite3_errmsg(db));
+		return false;
+	}
+	return true;
+}
+
+bool set_journal_mode(sqlite3 *db, const Connection::Options &options) {
+	char *error_message = nullptr;
+
+	// The journal mode is stored in the database file, so it has to be reverted explicitly when WAL is not wanted.
+	const char *journal_mode_sql = options.wal_enabled ? "PRAGMA journal_mode=WAL" : "PRAGMA journal_mode=DELETE";
+	int rc = sqlite3_exec(db, journal_mode_sql, nullptr, nullptr, &error_message);
+	if (rc != SQLITE_OK) {
+		// Can happen if other connections are using the database. Not fatal, it will keep using its current mode.
+		ZN_PRINT_VERBOSE(format("Could not set journal mode: {}", error_message));
+		sqlite3_free(error_message);
+		return false;
+	}
+
+	if (options.wal_enabled) {
+		// With WAL, this can't corrupt the database, only lose the last commits in case of power loss. That's
+		// acceptable for game saves, and avoids syncing the disk on every commit.
+		rc = sqlite3_exec(db, "PRAGMA synchronous=NORMAL", nullptr, nullptr, &error_message);
+		if (rc != SQLITE_OK) {
+			ZN_PRINT_VERBOSE(format("Could not set synchronous mode: {}", error_message));
+			sqlite3_free(error_message);
+		}
+
+		rc = sqlite3_wal_autocheckpoint(db, math::max(options.wal_autocheckpoint_pages, 0));
+		if (rc != SQLITE_OK) {
+			ZN_PRINT_VERBOSE(format("Could not set WAL autocheckpoint: {}", sqlite3_errmsg(db)));
+		}
+	}
+
+	return true;
+}
+
 static bool prepare(sqlite3 *db, sqlite3_stmt **s, const char *sql) {
 	const int rc = sqlite3_prepare_v2(db, sql, -1, s, nullptr);
 	if (rc != SQLITE_OK) {
@@ -200,6 +261,14 @@ Connection::~Connection() {
 }
 
 bool Connection::open(const char *fpath, const BlockLocation::CoordinateFormat preferred_coordinate_format) {
+	return open(fpath, preferred_coordinate_format, Options());
+}
+
+bool Connection::open(
+		const char *fpath,
+		const BlockLocation::CoordinateFormat preferred_coordinate_format,
+		const Options &options
+) {
 	ZN_PROFILE_SCOPE();
 	close();
 
@@ -214,6 +283,8 @@ bool Connection::open(const char *fpath, const BlockLocation::CoordinateFormat p
 	// instead of waiting for it. That notably affects COMMIT, which leaves the transaction open when it fails.
 	sqlite3_busy_timeout(_db, TRANSACTION_BUSY_TIMEOUT_MS);
 
+	set_journal_mode(_db, options);
+
 	// Note, SQLite uses UTF-8 encoding by default. We rely on that.
 	// https://www.sqlite.org/c3ref/open.html
 
@@ -284,6 +355,71 @@ bool Connection::open(const char *fpath, const BlockLocation::CoordinateFormat p
 	if (!prepare(db, &_get_instance_block_statement, "SELECT instances FROM blocks WHERE loc=:loc")) {
 		return false;
 	}
+	if (!prepare(
+				db,
+				&_update_block_statement,
+				"INSERT INTO blocks VALUES (:loc, :vb, :instances) "
+				"ON CONFLICT(loc) DO UPDATE SET vb=excluded.vb, instances=excluded.instances"
+		)) {
+		return false;
+	}
+	if (!prepare(
+				db,
+				&_update_voxel_blocks_statement,
+				make_multi_row_sql(
+						"INSERT INTO blocks VALUES ",
+						"(?, ?, null)",
+						MAX_BLOCKS_PER_STATEMENT,
+						" ON CONFLICT(loc) DO UPDATE SET vb=excluded.vb"
+				)
+						.c_str()
+		)) {
+		return false;
+	}
+	if (!prepare(
+				db,
+				&_update_instance_blocks_statement,
+				make_multi_row_sql(
+						"INSERT INTO blocks VALUES ",
+						"(?, null, ?)",
+						MAX_BLOCKS_PER_STATEMENT,
+						" ON CONFLICT(loc) DO UPDATE SET instances=excluded.instances"
+				)
+						.c_str()
+		)) {
+		return false;
+	}
+	if (!prepare(
+				db,
+				&_update_blocks_statement,
+				make_multi_row_sql(
+						"INSERT INTO blocks VALUES ",
+						"(?, ?, ?)",
+						MAX_BLOCKS_PER_STATEMENT,
+						" ON CONFLICT(loc) DO UPDATE SET vb=excluded.vb, instances=excluded.instances"
+				)
+						.c_str()
+		)) {
+		return false;
+	}
+	if (!prepare(
+				db,
+				&_get_voxel_blocks_statement,
+				make_multi_row_sql("SELECT loc, vb FROM blocks WHERE loc IN (", "?", MAX_BLOCKS_PER_STATEMENT, ")")
+						.c_str()
+		)) {
+		return false;
+	}
+	if (!prepare(
+				db,
+				&_get_instance_blocks_statement,
+				make_multi_row_sql(
+						"SELECT loc, instances FROM blocks WHERE loc IN (", "?", MAX_BLOCKS_PER_STATEMENT, ")"
+				)
+						.c_str()
+		)) {
+		return false;
+	}
 	if (!prepare(db, &_begin_statement, "BEGIN")) {
 		return false;
 	}
@@ -384,6 +520,12 @@ void Connection::close() {
 	finalize(_get_voxel_block_statement);
 	finalize(_update_instance_block_statement);
 	finalize(_get_instance_block_statement);
+	finalize(_update_block_statement);
+	finalize(_update_voxel_blocks_statement);
+	finalize(_update_instance_blocks_statement);
+	finalize(_update_blocks_statement);
+	finalize(_get_voxel_blocks_statement);
+	finalize(_get_instance_blocks_statement);
 	finalize(_load_meta_statement);
 	finalize(_save_meta_statement);
 	finalize(_load_channels_statement);
@@ -514,6 +656,116 @@ bool Connection::save_block(const BlockLocation loc, const Span<const uint8_t> b
 	return true;
 }
 
+bool Connection::save_blocks(Span<const BlockData> blocks) {
+	ZN_PROFILE_SCOPE();
+
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+
+	// Blocks are grouped by the columns they update, since that is decided by statements
+	StdTempVector<unsigned int> voxel_blocks(temp_allocator);
+	StdTempVector<unsigned int> instance_blocks(temp_allocator);
+	StdTempVector<unsigned int> full_blocks(temp_allocator);
+	voxel_blocks.reserve(blocks.size());
+
+	for (unsigned int i = 0; i < blocks.size(); ++i) {
+		const BlockData &block = blocks[i];
+		if (block.has_voxels) {
+			if (block.has_instances) {
+				full_blocks.push_back(i);
+			} else {
+				voxel_blocks.push_back(i);
+			}
+		} else if (block.has_instances) {
+			instance_blocks.push_back(i);
+		}
+	}
+
+	if (!save_blocks(
+				blocks,
+				to_span(voxel_blocks),
+				_update_voxel_blocks_statement,
+				_update_voxel_block_statement,
+				true,
+				false
+		)) {
+		return false;
+	}
+	if (!save_blocks(
+				blocks,
+				to_span(instance_blocks),
+				_update_instance_blocks_statement,
+				_update_instance_block_statement,
+				false,
+				true
+		)) {
+		return false;
+	}
+	return save_blocks(blocks, to_span(full_blocks), _update_blocks_statement, _update_block_statement, true, true);
+}
+
+bool Connection::save_blocks(
+		Span<const BlockData> blocks,
+		Span<const unsigned int> indices,
+		sqlite3_stmt *multi_row_statement,
+		sqlite3_stmt *single_row_statement,
+		const bool with_voxels,
+		const bool with_instances
+) {
+	sqlite3 *db = _db;
+	const int params_per_row = 1 + (with_voxels ? 1 : 0) + (with_instances ? 1 : 0);
+
+	// Bound keys reference these, so they must remain valid until statements are executed
+	FixedArray<BindBlockCoordinates, MAX_BLOCKS_PER_STATEMENT> key_bindings;
+
+	unsigned int begin = 0;
+	while (begin < indices.size()) {
+		// Remaining blocks that can't fill a multi-row statement are written one by one
+		const unsigned int row_count =
+				indices.size() - begin >= MAX_BLOCKS_PER_STATEMENT ? MAX_BLOCKS_PER_STATEMENT : 1;
+		sqlite3_stmt *statement = row_count == 1 ? single_row_statement : multi_row_statement;
+
+		int rc = sqlite3_reset(statement);
+		if (rc != SQLITE_OK) {
+			ERR_PRINT(sqlite3_errmsg(db));
+			return false;
+		}
+
+		for (unsigned int row = 0; row < row_count; ++row) {
+			const BlockData &block = blocks[indices[begin + row]];
+			int param_index = row * params_per_row + 1;
+
+			if (!key_bindings[row].bind(db, statement, param_index, _meta.coordinate_format, block.location)) {
+				return false;
+			}
+			++param_index;
+
+			if (with_voxels) {
+				if (!bind_blob_or_null(db, statement, param_index, block.voxels)) {
+					return false;
+				}
+				++param_index;
+			}
+
+			if (with_instances) {
+				if (!bind_blob_or_null(db, statement, param_index, block.instances)) {
+					return false;
+				}
+			}
+		}
+
+		rc = sqlite3_step(statement);
+		if (rc != SQLITE_DONE) {
+			ERR_PRINT(sqlite3_errmsg(db));
+			return false;
+		}
+
+		begin += row_count;
+	}
+
+	return true;
+}
+
 VoxelStream::ResultCode Connection::load_block(
 		const BlockLocation loc,
 		StdVector<uint8_t> &out_block_data,
@@ -575,6 +827,91 @@ VoxelStream::ResultCode Connection::load_block(
 	return result;
 }
 
+bool Connection::load_blocks(
+		Span<const BlockLocation> locations,
+		const BlockType type,
+		void *callback_data,
+		void (*process_block_func)(void *callback_data, unsigned int location_index, Span<const uint8_t> data)
+) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT(process_block_func != nullptr);
+
+	sqlite3 *db = _db;
+
+	sqlite3_stmt *get_blocks_statement;
+	switch (type) {
+		case VOXELS:
+			get_blocks_statement = _get_voxel_blocks_statement;
+			break;
+		case INSTANCES:
+			get_blocks_statement = _get_instance_blocks_statement;
+			break;
+		default:
+			get_blocks_statement = nullptr;
+			CRASH_NOW();
+	}
+
+	const CoordinateColumnType key_column_type = get_coordinate_column_type(_meta.coordinate_format);
+
+	// Bound keys reference these, so they must remain valid until the statement is done
+	FixedArray<BindBlockCoordinates, MAX_BLOCKS_PER_STATEMENT> key_bindings;
+
+	for (unsigned int begin = 0; begin < locations.size(); begin += MAX_BLOCKS_PER_STATEMENT) {
+		const Span<const BlockLocation> batch =
+				locations.sub(begin, math::min(locations.size() - begin, size_t(MAX_BLOCKS_PER_STATEMENT)));
+
+		int rc = sqlite3_reset(get_blocks_statement);
+		if (rc != SQLITE_OK) {
+			ERR_PRINT(sqlite3_errmsg(db));
+			return false;
+		}
+
+		// All parameters have to be bound. When there are fewer locations, the first one is repeated, which doesn't
+		// change the result.
+		for (unsigned int i = 0; i < MAX_BLOCKS_PER_STATEMENT; ++i) {
+			const BlockLocation &location = batch[i < batch.size() ? i : 0];
+			if (!key_bindings[i].bind(db, get_blocks_statement, i + 1, _meta.coordinate_format, location)) {
+				return false;
+			}
+		}
+
+		while (true) {
+			rc = sqlite3_step(get_blocks_statement);
+
+			if (rc == SQLITE_ROW) {
+				BlockLocation location;
+				ZN_ASSERT_CONTINUE(read_block_location(
+						_meta.coordinate_format, key_column_type, get_blocks_statement, 0, location
+				));
+
+				const void *blob = sqlite3_column_blob(get_blocks_statement, 1);
+				const size_t blob_size = sqlite3_column_bytes(get_blocks_statement, 1);
+				if (blob_size == 0) {
+					// The block exists, but not with the type of data we want
+					continue;
+				}
+				const Span<const uint8_t> data(static_cast<const uint8_t *>(blob), blob_size);
+
+				// Rows don't come in the same order as locations. Batches are small, so a linear search is fine.
+				for (unsigned int i = 0; i < batch.size(); ++i) {
+					if (batch[i] == location) {
+						process_block_func(callback_data, begin + i, data);
+					}
+				}
+
+			} else if (rc == SQLITE_DONE) {
+				break;
+
+			} else {
+				ERR_PRINT(sqlite3_errmsg(db));
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 bool Connection::load_all_blocks(
 		void *callback_data,
 		void (*process_block_func)(
@@ -38,10 +38,38 @@ public:
 		INSTANCES
 	};
 
+	// How many blocks a single statement writes or reads, when processing several blocks at once
+	static constexpr unsigned int MAX_BLOCKS_PER_STATEMENT = 32;
+	// Same as SQLite's default
+	static constexpr int DEFAULT_WAL_AUTOCHECKPOINT_PAGES = 1000;
+
+	struct Options {
+		// Use write-ahead logging. Commits then only append to a separate file, and don't block readers.
+		bool wal_enabled = false;
+		// How many pages the write-ahead log can reach before being written back into the database. 0 disables
+		// automatic checkpoints.
+		int wal_autocheckpoint_pages = DEFAULT_WAL_AUTOCHECKPOINT_PAGES;
+	};
+
+	// Data of a block to write with `save_blocks`
+	struct BlockData {
+		BlockLocation location;
+		Span<const uint8_t> voxels;
+		Span<const uint8_t> instances;
+		// If false, the data already in the database is left untouched. If true and data is empty, it is erased.
+		bool has_voxels = false;
+		bool has_instances = false;
+	};
+
 	Connection();
 	~Connection();
 
 	bool open(const char *fpath, const BlockLocation::CoordinateFormat preferred_coordinate_format);
+	bool open(
+			const char *fpath,
+			const BlockLocation::CoordinateFormat preferred_coordinate_format,
+			const Options &options
+	);
 	void close();
 
 	bool is_open() const {
@@ -68,12 +96,25 @@ public:
 
 	bool save_block(const BlockLocation loc, const Span<const uint8_t> block_data, const BlockType type);
 
+	// Writes several blocks with multi-row statements, updating voxels and instances of a block at once. It should be
+	// called inside a transaction. Data is not copied, so it must remain valid until the function returns.
+	bool save_blocks(Span<const BlockData> blocks);
+
 	VoxelStream::ResultCode load_block(
 			const BlockLocation loc,
 			StdVector<uint8_t> &out_block_data,
 			const BlockType type
 	);
 
+	// Reads several blocks with multi-row statements. The function is called with the index of each location that
+	// has data. That data is only valid during the call.
+	bool load_blocks(
+			Span<const BlockLocation> locations,
+			const BlockType type,
+			void *callback_data,
+			void (*process_block_func)(void *callback_data, unsigned int location_index, Span<const uint8_t> data)
+	);
+
 	bool load_all_blocks(
 			void *callback_data,
 			void (*process_block_func)(
@@ -101,6 +142,14 @@ private:
 	void save_meta(Meta meta);
 	bool migrate_to_next_version();
 	bool migrate_from_v0_to_v1();
+	bool save_blocks(
+			Span<const BlockData> blocks,
+			Span<const unsigned int> indices,
+			sqlite3_stmt *multi_row_statement,
+			sqlite3_stmt *single_row_statement,
+			const bool with_voxels,
+			const bool with_instances
+	);
 
 	StdString _opened_path;
 	Meta _meta;
@@ -113,6 +162,12 @@ private:
 	sqlite3_stmt *_get_voxel_block_statement = nullptr;
 	sqlite3_stmt *_update_instance_block_statement = nullptr;
 	sqlite3_stmt *_get_instance_block_statement = nullptr;
+	sqlite3_stmt *_update_block_statement = nullptr;
+	sqlite3_stmt *_update_voxel_blocks_statement = nullptr;
+	sqlite3_stmt *_update_instance_blocks_statement = nullptr;
+	sqlite3_stmt *_update_blocks_statement = nullptr;
+	sqlite3_stmt *_get_voxel_blocks_statement = nullptr;
+	sqlite3_stmt *_get_instance_blocks_statement = nullptr;
 	sqlite3_stmt *_load_meta_statement = nullptr;
 	sqlite3_stmt *_save_meta_statement = nullptr;
 	sqlite3_stmt *_load_channels_statement = nullptr;
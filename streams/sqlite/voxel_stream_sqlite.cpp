@@ -1,12 +1,22 @@
 #include "voxel_stream_sqlite.h"
+#include "../../engine/voxel_engine.h"
+#include "../../storage/voxel_buffer.h"
 #include "../../util/godot/classes/project_settings.h"
 #include "../../util/godot/core/string.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
+#include "../../util/profiling_clock.h"
 #include "../../util/string/format.h"
 #include "../../util/string/std_string.h"
+#include "../../util/tasks/threaded_task.h"
 #include "../compressed_data.h"
+#include "../stream_metrics.h"
 #include "connection.h"
 
+#ifdef VOXEL_ENABLE_INSTANCER
+#include "../instance_data.h"
+#endif
+
 #ifdef ZN_GODOT
 #include "../../util/godot/core/class_db.h"
 #endif
@@ -23,10 +33,12 @@ StdVector<uint8_t> &get_tls_temp_block_data() {
 	thread_local StdVector<uint8_t> tls_temp_block_data;
 	return tls_temp_block_data;
 }
+#ifdef VOXEL_ENABLE_INSTANCER
 StdVector<uint8_t> &get_tls_temp_compressed_block_data() {
 	thread_local StdVector<uint8_t> tls_temp_compressed_block_data;
 	return tls_temp_compressed_block_data;
 }
+#endif
 
 BlockLocation::CoordinateFormat to_internal_coordinate_format(VoxelStreamSQLite::CoordinateFormat format) {
 	return static_cast<BlockLocation::CoordinateFormat>(format);
@@ -60,9 +72,63 @@ bool validate_range(Vector3i pos, unsigned int lod_index, const Box3i coordinate
 	return true;
 }
 
+#ifdef VOXEL_ENABLE_INSTANCER
+
+// Serializes and compresses instances in the format they are stored in the database. Null instances give empty data.
+bool encode_instance_block(const InstanceBlockData *instances, StdVector<uint8_t> &out_compressed_data) {
+	out_compressed_data.clear();
+	if (instances == nullptr) {
+		return true;
+	}
+	StdVector<uint8_t> &temp_data = get_tls_temp_block_data();
+	temp_data.clear();
+	ZN_ASSERT_RETURN_V(serialize_instance_block_data(*instances, temp_data), false);
+	ZN_ASSERT_RETURN_V(
+			CompressedData::compress(to_span_const(temp_data), out_compressed_data, CompressedData::COMPRESSION_NONE),
+			false
+	);
+	return true;
+}
+
+bool decode_instance_block(Span<const uint8_t> compressed_data, UniquePtr<InstanceBlockData> &out_instances) {
+	StdVector<uint8_t> &temp_data = get_tls_temp_block_data();
+	if (!CompressedData::decompress(compressed_data, temp_data)) {
+		ERR_PRINT("Failed to decompress instance block");
+		return false;
+	}
+	out_instances = make_unique_instance<InstanceBlockData>();
+	if (!deserialize_instance_block_data(*out_instances, to_span_const(temp_data))) {
+		ERR_PRINT("Failed to deserialize instance block");
+		return false;
+	}
+	return true;
+}
+
+#endif
+
 } // namespace
 
-VoxelStreamSQLite::VoxelStreamSQLite() {}
+// Writes the cache to the database outside of the thread that saved blocks, so streaming isn't held up by it.
+class VoxelStreamSQLite::FlushCacheTask : public IThreadedTask {
+public:
+	FlushCacheTask(Ref<VoxelStreamSQLite> p_stream) : _stream(p_stream) {}
+
+	const char *get_debug_name() const override {
+		return "VoxelStreamSQLiteFlush";
+	}
+
+	void run(ThreadedTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		_stream->run_background_flush();
+	}
+
+private:
+	// Keeps the stream alive until the task is done
+	Ref<VoxelStreamSQLite> _stream;
+};
+
+VoxelStreamSQLite::VoxelStreamSQLite() :
+		_wal_autocheckpoint_pages(sqlite::Connection::DEFAULT_WAL_AUTOCHECKPOINT_PAGES) {}
 
 VoxelStreamSQLite::~VoxelStreamSQLite() {
 	ZN_PRINT_VERBOSE("~VoxelStreamSQLite");
@@ -82,6 +148,7 @@ VoxelStreamSQLite::~VoxelStreamSQLite() {
 }
 
 void VoxelStreamSQLite::set_database_path(String path) {
+	MutexLock flush_lock(_flush_mutex);
 	MutexLock lock(_connection_mutex);
 	if (path == _user_specified_connection_path) {
 		return;
@@ -90,10 +157,17 @@ void VoxelStreamSQLite::set_database_path(String path) {
 		// Save cached data before changing the path.
 		// Not using get_connection() because it locks, we are already locked.
 		sqlite::Connection con;
+		sqlite::Connection::Options options;
+		options.wal_enabled = _wal_enabled;
+		options.wal_autocheckpoint_pages = _wal_autocheckpoint_pages;
 		// Note, the path could be invalid,
 		// Since Godot helpfully sets the property for every character typed in the inspector.
 		// So there can be lots of errors in the editor if you type it.
-		if (con.open(_globalized_connection_path.data(), to_internal_coordinate_format(_preferred_coordinate_format))) {
+		if (con.open(
+					_globalized_connection_path.data(),
+					to_internal_coordinate_format(_preferred_coordinate_format),
+					options
+			)) {
 			if (!flush_cache_to_connection(&con)) {
 				// The connection is local and destroyed right after, so there is nothing to recover, but the
 				// data could not be saved to the previous database before switching away from it.
@@ -104,11 +178,8 @@ void VoxelStreamSQLite::set_database_path(String path) {
 			}
 		}
 	}
-	for (auto it = _connection_pool.begin(); it != _connection_pool.end(); ++it) {
-		delete *it;
-	}
+	clear_connection_pool_no_lock();
 	_block_keys_cache.clear();
-	_connection_pool.clear();
 
 	_user_specified_connection_path = path;
 	// To support Godot shortcuts like `user://` and `res://` (though the latter won't work on exported builds)
@@ -189,8 +260,15 @@ void VoxelStreamSQLite::load_voxel_blocks(Span<VoxelStream::VoxelQueryData> p_bl
 			continue;
 		}
 
-		if (_cache.load_voxel_block(pos, q.lod_index, q.voxel_buffer)) {
-			q.result = RESULT_BLOCK_FOUND;
+		StdVector<uint8_t> &temp_block_data = get_tls_temp_block_data();
+
+		if (load_cached_voxel_block(pos, q.lod_index, temp_block_data)) {
+			if (BlockSerializer::decompress_and_deserialize(to_span_const(temp_block_data), q.voxel_buffer)) {
+				q.result = RESULT_BLOCK_FOUND;
+			} else {
+				ZN_PRINT_ERROR("VoxelStreamSQLite: failed to deserialize cached block");
+				q.result = RESULT_ERROR;
+			}
 
 		} else {
 			blocks_to_load.push_back(i);
@@ -209,24 +287,48 @@ void VoxelStreamSQLite::load_voxel_blocks(Span<VoxelStream::VoxelQueryData> p_bl
 		return;
 	}
 
-	for (unsigned int i = 0; i < blocks_to_load.size(); ++i) {
-		const unsigned int ri = blocks_to_load[i];
-		VoxelStream::VoxelQueryData &q = p_blocks[ri];
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
 
+	StdTempVector<BlockLocation> locations(temp_allocator);
+	locations.reserve(blocks_to_load.size());
+	for (const unsigned int ri : blocks_to_load) {
+		const VoxelStream::VoxelQueryData &q = p_blocks[ri];
 		BlockLocation loc;
 		loc.position = q.position_in_blocks;
 		loc.lod = q.lod_index;
+		locations.push_back(loc);
+	}
 
-		StdVector<uint8_t> &temp_block_data = get_tls_temp_block_data();
+	set_result_codes(p_blocks, blocks_to_load, RESULT_BLOCK_NOT_FOUND);
 
-		const ResultCode res = con->load_block(loc, temp_block_data, sqlite::Connection::VOXELS);
+	struct Context {
+		Span<VoxelStream::VoxelQueryData> blocks;
+		const StdVector<unsigned int> &indices;
+	};
 
-		if (res == RESULT_BLOCK_FOUND) {
-			// TODO Not sure if we should actually expect non-null. There can be legit not found blocks.
-			BlockSerializer::decompress_and_deserialize(to_span_const(temp_block_data), q.voxel_buffer);
+	struct L {
+		static void process_block_func(
+				void *callback_data,
+				const unsigned int location_index,
+				Span<const uint8_t> data
+		) {
+			Context *ctx = static_cast<Context *>(callback_data);
+			VoxelStream::VoxelQueryData &q = ctx->blocks[ctx->indices[location_index]];
+			// Deserializing straight from SQLite's memory, no need to copy it first
+			if (BlockSerializer::decompress_and_deserialize(data, q.voxel_buffer)) {
+				q.result = VoxelStream::RESULT_BLOCK_FOUND;
+			} else {
+				ZN_PRINT_ERROR("VoxelStreamSQLite: failed to deserialize block");
+				q.result = VoxelStream::RESULT_ERROR;
+			}
 		}
+	};
 
-		q.result = res;
+	Context context{ p_blocks, blocks_to_load };
+	if (!con->load_blocks(to_span(locations), sqlite::Connection::VOXELS, &context, L::process_block_func)) {
+		ZN_PRINT_ERROR("VoxelStreamSQLite: failed to load blocks");
+		set_result_codes(p_blocks, blocks_to_load, RESULT_ERROR);
 	}
 
 	if (con->end_transaction() == false) {
@@ -256,7 +358,10 @@ void VoxelStreamSQLite::save_voxel_blocks(Span<VoxelStream::VoxelQueryData> p_bl
 	const Box3i coordinate_range = BlockLocation::get_coordinate_range(coordinate_format);
 	const unsigned int lod_count = BlockLocation::get_lod_count(coordinate_format);
 
-	// First put in cache
+	const CompressedData::Compression compression_mode = _compression_mode;
+
+	// First put in cache. Serializing now rather than when flushing keeps flushes short, and allows to measure how
+	// much memory the cache uses.
 	for (unsigned int i = 0; i < p_blocks.size(); ++i) {
 		VoxelStream::VoxelQueryData &q = p_blocks[i];
 		const Vector3i pos = q.position_in_blocks;
@@ -265,20 +370,22 @@ void VoxelStreamSQLite::save_voxel_blocks(Span<VoxelStream::VoxelQueryData> p_bl
 			continue;
 		}
 
-		_cache.save_voxel_block(pos, q.lod_index, q.voxel_buffer);
+		ZN_ASSERT_CONTINUE_MSG(
+				!Vector3iUtil::is_empty_size(q.voxel_buffer.get_size()),
+				"Saving voxel buffer with empty size is not expected. Bug?"
+		);
+
+		const BlockSerializer::SerializeResult res =
+				BlockSerializer::serialize_and_compress(q.voxel_buffer, compression_mode);
+		ZN_ASSERT_CONTINUE(res.success);
+
+		_cache.save_voxel_block(pos, q.lod_index, to_span(res.data));
 		if (_block_keys_cache_enabled) {
 			_block_keys_cache.add(pos, q.lod_index);
 		}
 	}
 
-	// TODO We should consider using a serialized cache, and measure the threshold in bytes
-	if (_cache.get_indicative_block_count() >= CACHE_SIZE) {
-		if (!flush_cache()) {
-			// Recoverable: blocks stay cached (unless the commit itself failed, which reported above), and the
-			// next save that grows the cache past the threshold will retry.
-			ZN_PRINT_WARNING("VoxelStreamSQLite: automatic cache flush did not complete, will retry later");
-		}
-	}
+	schedule_background_flush();
 }
 
 #ifdef VOXEL_ENABLE_INSTANCER
@@ -298,8 +405,18 @@ void VoxelStreamSQLite::load_instance_blocks(Span<VoxelStream::InstancesQueryDat
 	for (size_t i = 0; i < out_blocks.size(); ++i) {
 		VoxelStream::InstancesQueryData &q = out_blocks[i];
 
-		if (_cache.load_instance_block(q.position_in_blocks, q.lod_index, q.data)) {
-			q.result = RESULT_BLOCK_FOUND;
+		StdVector<uint8_t> &temp_compressed_block_data = get_tls_temp_compressed_block_data();
+
+		if (load_cached_instance_block(q.position_in_blocks, q.lod_index, temp_compressed_block_data)) {
+			if (temp_compressed_block_data.size() == 0) {
+				// The block was saved without instances
+				q.data = nullptr;
+				q.result = RESULT_BLOCK_FOUND;
+			} else if (decode_instance_block(to_span_const(temp_compressed_block_data), q.data)) {
+				q.result = RESULT_BLOCK_FOUND;
+			} else {
+				q.result = RESULT_ERROR;
+			}
 
 		} else {
 			blocks_to_load.push_back(i);
@@ -333,35 +450,46 @@ void VoxelStreamSQLite::load_instance_blocks(Span<VoxelStream::InstancesQueryDat
 		return;
 	}
 
-	for (unsigned int i = 0; i < blocks_to_load.size(); ++i) {
-		const unsigned int ri = blocks_to_load[i];
-		VoxelStream::InstancesQueryData &q = out_blocks[ri];
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
 
+	StdTempVector<BlockLocation> locations(temp_allocator);
+	locations.reserve(blocks_to_load.size());
+	for (const unsigned int ri : blocks_to_load) {
+		const VoxelStream::InstancesQueryData &q = out_blocks[ri];
 		BlockLocation loc;
 		loc.position = q.position_in_blocks;
 		loc.lod = q.lod_index;
+		locations.push_back(loc);
+	}
 
-		StdVector<uint8_t> &temp_compressed_block_data = get_tls_temp_compressed_block_data();
-
-		const ResultCode res = con->load_block(loc, temp_compressed_block_data, sqlite::Connection::INSTANCES);
+	set_result_codes(out_blocks, blocks_to_load, RESULT_BLOCK_NOT_FOUND);
 
-		if (res == RESULT_BLOCK_FOUND) {
-			StdVector<uint8_t> &temp_block_data = get_tls_temp_block_data();
+	struct Context {
+		Span<VoxelStream::InstancesQueryData> blocks;
+		const StdVector<unsigned int> &indices;
+	};
 
-			if (!CompressedData::decompress(to_span_const(temp_compressed_block_data), temp_block_data)) {
-				ERR_PRINT("Failed to decompress instance block");
-				q.result = RESULT_ERROR;
-				continue;
-			}
-			q.data = make_unique_instance<InstanceBlockData>();
-			if (!deserialize_instance_block_data(*q.data, to_span_const(temp_block_data))) {
-				ERR_PRINT("Failed to deserialize instance block");
-				q.result = RESULT_ERROR;
-				continue;
+	struct L {
+		static void process_block_func(
+				void *callback_data,
+				const unsigned int location_index,
+				Span<const uint8_t> data
+		) {
+			Context *ctx = static_cast<Context *>(callback_data);
+			VoxelStream::InstancesQueryData &q = ctx->blocks[ctx->indices[location_index]];
+			if (decode_instance_block(data, q.data)) {
+				q.result = VoxelStream::RESULT_BLOCK_FOUND;
+			} else {
+				q.result = VoxelStream::RESULT_ERROR;
 			}
 		}
+	};
 
-		q.result = res;
+	Context context{ out_blocks, blocks_to_load };
+	if (!con->load_blocks(to_span(locations), sqlite::Connection::INSTANCES, &context, L::process_block_func)) {
+		ZN_PRINT_ERROR("VoxelStreamSQLite: failed to load instance blocks");
+		set_result_codes(out_blocks, blocks_to_load, RESULT_ERROR);
 	}
 
 	if (con->end_transaction() == false) {
@@ -390,6 +518,8 @@ void VoxelStreamSQLite::save_instance_blocks(Span<VoxelStream::InstancesQueryDat
 	const Box3i coordinate_range = BlockLocation::get_coordinate_range(coordinate_format);
 	const unsigned int lod_count = BlockLocation::get_lod_count(coordinate_format);
 
+	StdVector<uint8_t> &temp_compressed_data = get_tls_temp_compressed_block_data();
+
 	// First put in cache
 	for (size_t i = 0; i < p_blocks.size(); ++i) {
 		VoxelStream::InstancesQueryData &q = p_blocks[i];
@@ -398,20 +528,15 @@ void VoxelStreamSQLite::save_instance_blocks(Span<VoxelStream::InstancesQueryDat
 			continue;
 		}
 
-		_cache.save_instance_block(q.position_in_blocks, q.lod_index, std::move(q.data));
+		ZN_ASSERT_CONTINUE(encode_instance_block(q.data.get(), temp_compressed_data));
+
+		_cache.save_instance_block(q.position_in_blocks, q.lod_index, to_span_const(temp_compressed_data));
 		if (_block_keys_cache_enabled) {
 			_block_keys_cache.add(q.position_in_blocks, q.lod_index);
 		}
 	}
 
-	// TODO Optimization: we should consider using a serialized cache, and measure the threshold in bytes
-	if (_cache.get_indicative_block_count() >= CACHE_SIZE) {
-		if (!flush_cache()) {
-			// Recoverable: blocks stay cached (unless the commit itself failed, which reported above), and the
-			// next save that grows the cache past the threshold will retry.
-			ZN_PRINT_WARNING("VoxelStreamSQLite: automatic cache flush did not complete, will retry later");
-		}
-	}
+	schedule_background_flush();
 }
 
 #endif
@@ -434,6 +559,13 @@ void VoxelStreamSQLite::load_all_blocks(FullLoadingResult &result) {
 
 	const ScopeRecycle con_scope(this, con);
 
+	// Only the database is read below, so recently saved blocks have to be written first
+	if (!flush_cache()) {
+		ZN_PRINT_WARNING(
+				"VoxelStreamSQLite: could not flush cache before loading all blocks, recent saves may be missing"
+		);
+	}
+
 	struct Context {
 		FullLoadingResult &result;
 	};
@@ -469,14 +601,7 @@ void VoxelStreamSQLite::load_all_blocks(FullLoadingResult &result) {
 
 #ifdef VOXEL_ENABLE_INSTANCER
 			if (instances_data.size() > 0) {
-				StdVector<uint8_t> &temp_block_data = get_tls_temp_block_data();
-				if (!CompressedData::decompress(instances_data, temp_block_data)) {
-					ERR_PRINT("Failed to decompress instance block");
-					return;
-				}
-				result_block.instances_data = make_unique_instance<InstanceBlockData>();
-				if (!deserialize_instance_block_data(*result_block.instances_data, to_span_const(temp_block_data))) {
-					ERR_PRINT("Failed to deserialize instance block");
+				if (!decode_instance_block(instances_data, result_block.instances_data)) {
 					return;
 				}
 			}
@@ -499,6 +624,9 @@ int VoxelStreamSQLite::get_used_channels_mask() const {
 }
 
 bool VoxelStreamSQLite::flush_cache() {
+	// Waits for a background flush to finish if one is running
+	MutexLock flush_lock(_flush_mutex);
+
 	const ConnectionResult con_res = get_connection();
 	switch (con_res.code) {
 		case ConnectionResult::SUCCESS:
@@ -524,90 +652,163 @@ void VoxelStreamSQLite::flush() {
 	}
 }
 
-// This function does not lock any mutex for internal use.
+void VoxelStreamSQLite::schedule_background_flush() {
+	const size_t threshold = _cache_flush_threshold_bytes.load(std::memory_order_relaxed);
+	const size_t cache_size = _cache.get_size_in_bytes();
+
+	if (cache_size >= threshold * CACHE_FLUSH_THRESHOLD_HARD_LIMIT_FACTOR) {
+		// The background flush doesn't keep up, or it can't run. Block the caller until the cache is written, so it
+		// can't grow indefinitely.
+		ZN_PRINT_VERBOSE("VoxelStreamSQLite: cache exceeded its hard limit, flushing synchronously");
+		if (!flush_cache()) {
+			// Recoverable: blocks stay cached, and the next save will retry.
+			ZN_PRINT_WARNING("VoxelStreamSQLite: automatic cache flush did not complete, will retry later");
+		}
+		return;
+	}
+
+	if (cache_size < threshold) {
+		return;
+	}
+
+	bool expected = false;
+	if (!_background_flush_scheduled.compare_exchange_strong(expected, true)) {
+		// Already scheduled, it will pick up blocks saved in the meantime
+		return;
+	}
+
+	// Not using the I/O lane, since it runs tasks one by one and loading blocks would have to wait for the flush
+	VoxelEngine::get_singleton().push_async_task(ZN_NEW(FlushCacheTask(this)));
+}
+
+void VoxelStreamSQLite::run_background_flush() {
+	// Saves may keep filling the cache while a flush runs, so keep going until it is below the threshold
+	while (_cache.get_size_in_bytes() >= _cache_flush_threshold_bytes.load(std::memory_order_relaxed)) {
+		if (!flush_cache()) {
+			// Recoverable: blocks stay cached, and the next save that grows the cache past the threshold will retry.
+			ZN_PRINT_WARNING("VoxelStreamSQLite: background cache flush did not complete, will retry later");
+			break;
+		}
+	}
+	_background_flush_scheduled = false;
+}
+
+bool VoxelStreamSQLite::load_cached_voxel_block(
+		Vector3i position,
+		uint8_t lod_index,
+		StdVector<uint8_t> &out_data
+) const {
+	// `_cache` must be checked first: blocks move from it to `_flushing_cache` when a flush starts, and it holds the
+	// most recent data.
+	return _cache.load_voxel_block(position, lod_index, out_data) ||
+			_flushing_cache.load_voxel_block(position, lod_index, out_data);
+}
+
+#ifdef VOXEL_ENABLE_INSTANCER
+
+bool VoxelStreamSQLite::load_cached_instance_block(
+		Vector3i position,
+		uint8_t lod_index,
+		StdVector<uint8_t> &out_data
+) const {
+	return _cache.load_instance_block(position, lod_index, out_data) ||
+			_flushing_cache.load_instance_block(position, lod_index, out_data);
+}
+
+#endif
+
+// This function does not lock any mutex for internal use, `_flush_mutex` must be locked by the caller.
 // Returns false if the transaction failed, in which case the connection may need to be recovered before reuse (see
-// `recover_after_failed_transaction`).
+// `recover_after_failed_transaction`). Blocks that could not be saved are put back in the cache.
 bool VoxelStreamSQLite::flush_cache_to_connection(sqlite::Connection *p_connection) {
 	ZN_PROFILE_SCOPE();
-	ZN_PRINT_VERBOSE(format("VoxelStreamSQLite: Flushing cache ({} elements)", _cache.get_indicative_block_count()));
-
 	ERR_FAIL_COND_V(p_connection == nullptr, false);
+
+	// From here, blocks can still be loaded from `_flushing_cache`, while new saves go to `_cache` without waiting
+	// for the transaction to complete.
+	_cache.move_all_to(_flushing_cache);
+
+	const unsigned int block_count = _flushing_cache.get_indicative_block_count();
+	if (block_count == 0) {
+		return true;
+	}
+
+	ZN_PRINT_VERBOSE(format(
+			"VoxelStreamSQLite: Flushing cache ({} elements, {} bytes)",
+			block_count,
+			_flushing_cache.get_size_in_bytes()
+	));
+
+	ProfilingClock profiling_clock;
+
 	if (p_connection->begin_transaction() == false) {
-		// Nothing was written or dropped at this point: cached blocks are retained, so a later flush will retry
-		// them. Detailed reporting is left to callers, which know their context.
+		// Nothing was written at this point. Detailed reporting is left to callers, which know their context.
 		ZN_PRINT_VERBOSE("VoxelStreamSQLite: could not begin flush transaction, keeping cached blocks");
+		_flushing_cache.move_unsaved_to(_cache);
 		return false;
 	}
 
-#ifdef VOXEL_ENABLE_INSTANCER
-	StdVector<uint8_t> &temp_data = get_tls_temp_block_data();
-#endif
-	StdVector<uint8_t> &temp_compressed_data = get_tls_temp_compressed_block_data();
-
 	const BlockLocation::CoordinateFormat coordinate_format = p_connection->get_meta().coordinate_format;
 	const Box3i coordinate_range = BlockLocation::get_coordinate_range(coordinate_format);
 	const unsigned int lod_count = BlockLocation::get_lod_count(coordinate_format);
 
-	const CompressedData::Compression compression_mode = _compression_mode;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
 
-	// TODO Needs better error rollback handling
-	_cache.flush([p_connection,
-#ifdef VOXEL_ENABLE_INSTANCER
-				  &temp_data,
-#endif
-				  &temp_compressed_data,
-				  coordinate_range,
-				  compression_mode,
-				  lod_count](VoxelStreamCache::Block &block) {
+	// Blocks are already serialized, so only database work is left here. Data is referenced without copy, since
+	// `_flushing_cache` can't change until the flush is done.
+	StdTempVector<sqlite::Connection::BlockData> blocks_data(temp_allocator);
+	blocks_data.reserve(block_count);
+
+	_flushing_cache.for_each_block([&blocks_data, coordinate_range, lod_count](const VoxelStreamCache::Block &block) {
 		ZN_ASSERT_RETURN(validate_range(block.position, block.lod, coordinate_range, lod_count));
 
-		BlockLocation loc;
-		loc.position = block.position;
-		loc.lod = block.lod;
+		sqlite::Connection::BlockData block_data;
+		block_data.location.position = block.position;
+		block_data.location.lod = block.lod;
 
-		// Save voxels
 		if (block.has_voxels) {
-			if (block.voxels_deleted) {
-				p_connection->save_block(loc, Span<const uint8_t>(), sqlite::Connection::VOXELS);
-			} else {
-				BlockSerializer::SerializeResult res =
-						BlockSerializer::serialize_and_compress(block.voxels, compression_mode);
-				ERR_FAIL_COND(!res.success);
-				p_connection->save_block(loc, to_span(res.data), sqlite::Connection::VOXELS);
+			block_data.has_voxels = true;
+			if (!block.voxels_deleted) {
+				block_data.voxels = to_span(block.voxels);
 			}
 		}
 
-		// Save instances
-		temp_compressed_data.clear();
 #ifdef VOXEL_ENABLE_INSTANCER
-		if (block.instances != nullptr) {
-			temp_data.clear();
-
-			ERR_FAIL_COND(!serialize_instance_block_data(*block.instances, temp_data));
-
-			ERR_FAIL_COND(!CompressedData::compress(
-					to_span_const(temp_data), temp_compressed_data, CompressedData::COMPRESSION_NONE
-			));
+		if (block.has_instances) {
+			block_data.has_instances = true;
+			block_data.instances = to_span(block.instances);
 		}
 #endif
-		p_connection->save_block(loc, to_span(temp_compressed_data), sqlite::Connection::INSTANCES);
 
-		// TODO Optimization: add a version of the query that can update both at once
+		blocks_data.push_back(block_data);
 	});
 
+	if (!p_connection->save_blocks(to_span(blocks_data))) {
+		// The transaction is left open, callers have to recover the connection
+		ZN_PRINT_ERROR("VoxelStreamSQLite: failed to write blocks, keeping cached blocks");
+		_flushing_cache.move_unsaved_to(_cache);
+		return false;
+	}
+
 	if (p_connection->end_transaction() == false) {
-		// The cache was already drained into this transaction, so these blocks are dropped without being saved.
-		// This is the lossy case, unlike a failed begin above.
-		ZN_PRINT_ERROR("VoxelStreamSQLite: failed to commit flush transaction, unsaved cached blocks were dropped");
+		// Blocks that were not saved again in the meantime go back to the cache, so the next flush retries them
+		ZN_PRINT_ERROR("VoxelStreamSQLite: failed to commit flush transaction, keeping cached blocks");
+		_flushing_cache.move_unsaved_to(_cache);
 		return false;
 	}
 
+	_flushing_cache.clear();
+
+	get_metrics().flush_latency.add(profiling_clock.get_elapsed_microseconds());
+
 	return true;
 }
 
 VoxelStreamSQLite::ConnectionResult VoxelStreamSQLite::get_connection() {
 	StdString fpath;
 	CoordinateFormat preferred_coordinate_format;
+	sqlite::Connection::Options options;
 	{
 		MutexLock mlock(_connection_mutex);
 
@@ -623,6 +824,8 @@ VoxelStreamSQLite::ConnectionResult VoxelStreamSQLite::get_connection() {
 		// First connection we get since we set the database path
 		fpath = _globalized_connection_path;
 		preferred_coordinate_format = _preferred_coordinate_format;
+		options.wal_enabled = _wal_enabled;
+		options.wal_autocheckpoint_pages = _wal_autocheckpoint_pages;
 	}
 
 	if (fpath.empty()) {
@@ -630,7 +833,7 @@ VoxelStreamSQLite::ConnectionResult VoxelStreamSQLite::get_connection() {
 		return { nullptr, ConnectionResult::NOT_CONFIGURED };
 	}
 	sqlite::Connection *con = new sqlite::Connection();
-	if (!con->open(fpath.data(), to_internal_coordinate_format(preferred_coordinate_format))) {
+	if (!con->open(fpath.data(), to_internal_coordinate_format(preferred_coordinate_format), options)) {
 		delete con;
 		return { nullptr, ConnectionResult::ERROR };
 	}
@@ -657,12 +860,28 @@ void VoxelStreamSQLite::recycle_connection(sqlite::Connection *con) {
 	delete con;
 }
 
+void VoxelStreamSQLite::clear_connection_pool_no_lock() {
+	for (auto it = _connection_pool.begin(); it != _connection_pool.end(); ++it) {
+		delete *it;
+	}
+	_connection_pool.clear();
+}
+
 void VoxelStreamSQLite::destroy_connection(sqlite::Connection *con) {
 	// Defined here rather than inline in the header, where `Connection` is only forward-declared and its destructor
 	// would therefore not run.
 	delete con;
 }
 
+void VoxelStreamSQLite::set_cache_flush_threshold_bytes(int bytes) {
+	ZN_ASSERT_RETURN(bytes >= 0);
+	_cache_flush_threshold_bytes = bytes;
+}
+
+int VoxelStreamSQLite::get_cache_flush_threshold_bytes() const {
+	return _cache_flush_threshold_bytes;
+}
+
 void VoxelStreamSQLite::set_key_cache_enabled(bool enable) {
 	_block_keys_cache_enabled = enable;
 }
@@ -671,6 +890,35 @@ bool VoxelStreamSQLite::is_key_cache_enabled() const {
 	return _block_keys_cache_enabled;
 }
 
+void VoxelStreamSQLite::set_wal_enabled(bool enabled) {
+	MutexLock lock(_connection_mutex);
+	if (enabled == _wal_enabled) {
+		return;
+	}
+	_wal_enabled = enabled;
+	clear_connection_pool_no_lock();
+}
+
+bool VoxelStreamSQLite::is_wal_enabled() const {
+	MutexLock lock(_connection_mutex);
+	return _wal_enabled;
+}
+
+void VoxelStreamSQLite::set_wal_autocheckpoint_pages(int pages) {
+	ZN_ASSERT_RETURN(pages >= 0);
+	MutexLock lock(_connection_mutex);
+	if (pages == _wal_autocheckpoint_pages) {
+		return;
+	}
+	_wal_autocheckpoint_pages = pages;
+	clear_connection_pool_no_lock();
+}
+
+int VoxelStreamSQLite::get_wal_autocheckpoint_pages() const {
+	MutexLock lock(_connection_mutex);
+	return _wal_autocheckpoint_pages;
+}
+
 Box3i VoxelStreamSQLite::get_supported_block_range() const {
 	// const Connection *con = get_connection();
 	// const CoordinateFormat format = con != nullptr ? con->get_meta().coordinate_format :
@@ -739,8 +987,13 @@ bool VoxelStreamSQLite::copy_blocks_to_other_sqlite_stream(Ref<VoxelStreamSQLite
 				Span<const uint8_t> instances_data
 		) {
 			Context *ctx = static_cast<Context *>(cb_data);
-			ctx->dst_con->save_block(location, voxel_data, sqlite::Connection::VOXELS);
-			ctx->dst_con->save_block(location, instances_data, sqlite::Connection::INSTANCES);
+			sqlite::Connection::BlockData block_data;
+			block_data.location = location;
+			block_data.voxels = voxel_data;
+			block_data.instances = instances_data;
+			block_data.has_voxels = true;
+			block_data.has_instances = true;
+			ctx->dst_con->save_blocks(Span<const sqlite::Connection::BlockData>(&block_data, 1));
 		}
 	};
 
@@ -758,9 +1011,24 @@ void VoxelStreamSQLite::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_database_path", "path"), &VoxelStreamSQLite::set_database_path);
 	ClassDB::bind_method(D_METHOD("get_database_path"), &VoxelStreamSQLite::get_database_path);
 
+	ClassDB::bind_method(
+			D_METHOD("set_cache_flush_threshold_bytes", "bytes"), &VoxelStreamSQLite::set_cache_flush_threshold_bytes
+	);
+	ClassDB::bind_method(
+			D_METHOD("get_cache_flush_threshold_bytes"), &VoxelStreamSQLite::get_cache_flush_threshold_bytes
+	);
+
 	ClassDB::bind_method(D_METHOD("set_key_cache_enabled", "enabled"), &VoxelStreamSQLite::set_key_cache_enabled);
 	ClassDB::bind_method(D_METHOD("is_key_cache_enabled"), &VoxelStreamSQLite::is_key_cache_enabled);
 
+	ClassDB::bind_method(D_METHOD("set_wal_enabled", "enabled"), &VoxelStreamSQLite::set_wal_enabled);
+	ClassDB::bind_method(D_METHOD("is_wal_enabled"), &VoxelStreamSQLite::is_wal_enabled);
+
+	ClassDB::bind_method(
+			D_METHOD("set_wal_autocheckpoint_pages", "pages"), &VoxelStreamSQLite::set_wal_autocheckpoint_pages
+	);
+	ClassDB::bind_method(D_METHOD("get_wal_autocheckpoint_pages"), &VoxelStreamSQLite::get_wal_autocheckpoint_pages);
+
 	ClassDB::bind_method(
 			D_METHOD("set_preferred_coordinate_format", "format"), &VoxelStreamSQLite::set_preferred_coordinate_format
 	);
@@ -788,6 +1056,20 @@ void VoxelStreamSQLite::_bind_methods() {
 			"set_preferred_coordinate_format",
 			"get_preferred_coordinate_format"
 	);
+
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "cache_flush_threshold_bytes", PROPERTY_HINT_RANGE, "0,268435456,1,or_greater"),
+			"set_cache_flush_threshold_bytes",
+			"get_cache_flush_threshold_bytes"
+	);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "wal_enabled"), "set_wal_enabled", "is_wal_enabled");
+
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "wal_autocheckpoint_pages", PROPERTY_HINT_RANGE, "0,100000,1,or_greater"),
+			"set_wal_autocheckpoint_pages",
+			"get_wal_autocheckpoint_pages"
+	);
 }
 
 } // namespace zylann::voxel
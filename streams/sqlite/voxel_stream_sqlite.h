@@ -8,6 +8,7 @@
 #include "../voxel_stream.h"
 #include "../voxel_stream_cache.h"
 #include "block_key_cache.h"
+#include <atomic>
 
 namespace zylann::voxel::sqlite {
 class Connection;
@@ -16,10 +17,15 @@ class Connection;
 namespace zylann::voxel {
 
 // Saves voxel data into a single SQLite database file.
+// Saved blocks are first serialized into an in-memory cache, which is written to the database in the background once
+// it holds enough data.
 class VoxelStreamSQLite : public VoxelStream {
 	GDCLASS(VoxelStreamSQLite, VoxelStream)
 public:
-	static const unsigned int CACHE_SIZE = 64;
+	static const unsigned int DEFAULT_CACHE_FLUSH_THRESHOLD_BYTES = 4 * 1024 * 1024;
+	// If the cache keeps growing while the background flush can't keep up, saves flush it themselves once it gets
+	// this many times bigger than the threshold.
+	static const unsigned int CACHE_FLUSH_THRESHOLD_HARD_LIMIT_FACTOR = 4;
 
 	VoxelStreamSQLite();
 	~VoxelStreamSQLite();
@@ -51,14 +57,27 @@ public:
 	int get_used_channels_mask() const override;
 
 	void flush() override;
-	// Returns false if flushing did not complete. In that case, cached blocks are retained if the transaction could
-	// not start, but are lost if the commit itself failed.
+	// Writes cached blocks to the database now, waiting for a background flush to finish if one is running.
+	// Returns false if flushing did not complete. In that case, cached blocks are retained so a later flush can retry.
 	bool flush_cache();
 
+	// When cached saved data exceeds this size, it gets written to the database in the background.
+	void set_cache_flush_threshold_bytes(int bytes);
+	int get_cache_flush_threshold_bytes() const;
+
 	// Might improve query performance if saved data is very sparse (like when only edited blocks are saved).
 	void set_key_cache_enabled(bool enable);
 	bool is_key_cache_enabled() const;
 
+	// Write-ahead logging makes writes cheaper, and lets loading continue while the cache is written. Applies to
+	// connections opened afterwards, so it should be set before using the stream.
+	void set_wal_enabled(bool enabled);
+	bool is_wal_enabled() const;
+
+	// When using write-ahead logging, how many pages the log can reach before it gets written back into the database.
+	void set_wal_autocheckpoint_pages(int pages);
+	int get_wal_autocheckpoint_pages() const;
+
 	Box3i get_supported_block_range() const override;
 	int get_lod_count() const override;
 
@@ -102,6 +121,8 @@ private:
 	};
 
 	ConnectionResult get_connection();
+	// Closes pooled connections, so new ones get opened with the current settings
+	void clear_connection_pool_no_lock();
 	void recycle_connection(sqlite::Connection *con);
 	void destroy_connection(sqlite::Connection *con);
 
@@ -132,6 +153,16 @@ private:
 
 	bool flush_cache_to_connection(sqlite::Connection *p_connection);
 
+	class FlushCacheTask;
+
+	void schedule_background_flush();
+	void run_background_flush();
+
+	bool load_cached_voxel_block(Vector3i position, uint8_t lod_index, StdVector<uint8_t> &out_data) const;
+#ifdef VOXEL_ENABLE_INSTANCER
+	bool load_cached_instance_block(Vector3i position, uint8_t lod_index, StdVector<uint8_t> &out_data) const;
+#endif
+
 	static void _bind_methods();
 
 	String _user_specified_connection_path;
@@ -142,6 +173,13 @@ private:
 	// This is because save queries are more expensive.
 	// It also speeds up queries of blocks that were recently saved.
 	VoxelStreamCache _cache;
+	// Blocks being written to the database by a flush. They are kept until the transaction is committed, so they can
+	// still be loaded in the meantime, and given back to `_cache` if it fails.
+	VoxelStreamCache _flushing_cache;
+	// Held while flushing. Must be locked before `_connection_mutex` if both are needed.
+	Mutex _flush_mutex;
+	std::atomic_bool _background_flush_scheduled = { false };
+	std::atomic_uint32_t _cache_flush_threshold_bytes = { DEFAULT_CACHE_FLUSH_THRESHOLD_BYTES };
 	// The current way we stream data is by querying every block location near each player, to know if there is data.
 	// Therefore testing if a block is present is the beginning of the most frequently executed code path.
 	// In configurations where only edited blocks get saved, very few blocks even get stored in the database,
@@ -153,6 +191,9 @@ private:
 	// Format that will be used when creating new databases. May not necessarily match the format actually used by
 	// existing databases.
 	CoordinateFormat _preferred_coordinate_format = COORDINATE_FORMAT_STRING_CSD;
+	// Protected by `_connection_mutex`
+	bool _wal_enabled = false;
+	int _wal_autocheckpoint_pages;
 };
 
 } // namespace zylann::voxel
@@ -0,0 +1,48 @@
+#include "stream_metrics.h"
+#include "../storage/voxel_buffer.h"
+
+namespace zylann::voxel {
+
+uint64_t StreamMetrics::get_voxel_data_size(const VoxelBuffer &voxels) {
+	uint64_t size = 0;
+	for (unsigned int channel_index = 0; channel_index < VoxelBuffer::MAX_CHANNELS; ++channel_index) {
+		if (!voxels.is_uniform(channel_index)) {
+			size += VoxelBuffer::get_size_in_bytes_for_volume(
+					voxels.get_size(), voxels.get_channel_depth(channel_index)
+			);
+		}
+	}
+	return size;
+}
+
+StreamMetricsRegistry &StreamMetricsRegistry::get_singleton() {
+	static StreamMetricsRegistry s_registry;
+	return s_registry;
+}
+
+StreamMetrics &StreamMetricsRegistry::get_or_create(const StdString &class_name) {
+	MutexLock lock(_mutex);
+
+	const unsigned int count = _count.load(std::memory_order_acquire);
+	for (unsigned int i = 0; i < count; ++i) {
+		if (_names[i] == class_name) {
+			return _metrics[i];
+		}
+	}
+
+	if (count == MAX_STREAM_TYPES) {
+		return _metrics[MAX_STREAM_TYPES - 1];
+	}
+
+	if (count == MAX_STREAM_TYPES - 1) {
+		// Keep the last slot for everything that doesn't fit
+		_names[count] = "<other>";
+	} else {
+		_names[count] = class_name;
+	}
+	// Readers only access entries below the count, so the name must be written before it is published
+	_count.store(count + 1, std::memory_order_release);
+	return _metrics[count];
+}
+
+} // namespace zylann::voxel
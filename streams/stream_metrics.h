@@ -0,0 +1,65 @@
+#ifndef VOXEL_STREAM_METRICS_H
+#define VOXEL_STREAM_METRICS_H
+
+#include "../util/containers/fixed_array.h"
+#include "../util/string/std_string.h"
+#include "../util/tasks/task_metrics.h"
+#include "../util/thread/mutex.h"
+#include <atomic>
+
+namespace zylann::voxel {
+
+class VoxelBuffer;
+
+// I/O metrics of streams, measured by the tasks calling them. Always collected.
+struct StreamMetrics {
+	DurationHistogram load_latency;
+	DurationHistogram save_latency;
+	// Time taken to write cached data to storage, for streams that save in batches. Such streams may report short
+	// save latencies, since saving only puts data in their cache.
+	DurationHistogram flush_latency;
+	std::atomic_uint64_t loaded_blocks = { 0 };
+	std::atomic_uint64_t not_found_blocks = { 0 };
+	std::atomic_uint64_t saved_blocks = { 0 };
+	std::atomic_uint64_t errors = { 0 };
+	// Size of voxel data going through the stream, as it is in memory. Actual storage size depends on the stream's
+	// encoding and compression.
+	std::atomic_uint64_t loaded_bytes = { 0 };
+	std::atomic_uint64_t saved_bytes = { 0 };
+
+	// Size of the data of non-uniform channels, which is what streams have to encode
+	static uint64_t get_voxel_data_size(const VoxelBuffer &voxels);
+};
+
+// Metrics grouped by stream class, so they can be inspected engine-wide without referencing stream instances.
+class StreamMetricsRegistry {
+public:
+	static constexpr unsigned int MAX_STREAM_TYPES = 16;
+
+	static StreamMetricsRegistry &get_singleton();
+
+	// Thread-safe. Types beyond the maximum count are grouped together.
+	StreamMetrics &get_or_create(const StdString &class_name);
+
+	unsigned int get_count() const {
+		return _count.load(std::memory_order_acquire);
+	}
+
+	const StdString &get_name(unsigned int i) const {
+		return _names[i];
+	}
+
+	const StreamMetrics &get_metrics(unsigned int i) const {
+		return _metrics[i];
+	}
+
+private:
+	FixedArray<StdString, MAX_STREAM_TYPES> _names;
+	FixedArray<StreamMetrics, MAX_STREAM_TYPES> _metrics;
+	std::atomic_uint32_t _count = { 0 };
+	Mutex _mutex;
+};
+
+} // namespace zylann::voxel
+
+#endif // VOXEL_STREAM_METRICS_H
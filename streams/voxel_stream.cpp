@@ -2,6 +2,7 @@
 #include "../storage/voxel_buffer_gd.h"
 #include "../util/godot/core/string.h"
 #include "../util/string/format.h"
+#include "stream_metrics.h"
 
 #ifdef ZN_GODOT
 #include "../util/godot/core/class_db.h"
@@ -100,6 +101,16 @@ godot::VoxelBlockSerializer::Compression VoxelStream::get_compression_mode() con
 	return godot::VoxelBlockSerializer::compression_to_gd(_compression_mode);
 }
 
+StreamMetrics &VoxelStream::get_metrics() {
+	StreamMetrics *metrics = _metrics.load(std::memory_order_acquire);
+	if (metrics == nullptr) {
+		// Several threads could get here at the same time, but they would all find the same entry
+		metrics = &StreamMetricsRegistry::get_singleton().get_or_create(zylann::godot::to_std_string(get_class()));
+		_metrics.store(metrics, std::memory_order_release);
+	}
+	return *metrics;
+}
+
 // Binding land
 
 VoxelStream::ResultCode VoxelStream::_b_load_voxel_block(
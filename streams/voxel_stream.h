@@ -13,6 +13,7 @@
 #include "compressed_data.h"
 #include "voxel_block_serializer_gd.h"
 
+#include <atomic>
 #include <cstdint>
 
 namespace zylann::voxel {
@@ -22,6 +23,8 @@ class VoxelBuffer;
 struct InstanceBlockData;
 #endif
 
+struct StreamMetrics;
+
 namespace godot {
 class VoxelBuffer;
 }
@@ -85,6 +88,8 @@ public:
 
 	// Returns multiple blocks of voxels to the stream.
 	// This function is recommended if you save to files, because you can batch their access.
+	// Voxels given to save must not be modified: they may be shared with terrain data, which is not copied before
+	// saving.
 	virtual void save_voxel_blocks(Span<VoxelQueryData> p_blocks);
 
 #ifdef VOXEL_ENABLE_INSTANCER
@@ -147,6 +152,9 @@ public:
 	void set_compression_mode(const godot::VoxelBlockSerializer::Compression mode);
 	godot::VoxelBlockSerializer::Compression get_compression_mode() const;
 
+	// Metrics shared by all streams of the same class. Thread-safe.
+	StreamMetrics &get_metrics();
+
 protected:
 	CompressedData::Compression _compression_mode = CompressedData::COMPRESSION_LZ4;
 
@@ -164,6 +172,9 @@ private:
 
 	Parameters _parameters;
 	RWLock _parameters_lock;
+
+	// Looked up on first use, because the class name isn't final yet when the base constructor runs
+	std::atomic<StreamMetrics *> _metrics = { nullptr };
 };
 
 } // namespace zylann::voxel
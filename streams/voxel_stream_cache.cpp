@@ -1,8 +1,46 @@
 #include "voxel_stream_cache.h"
+#include "../util/errors.h"
 
 namespace zylann::voxel {
 
-bool VoxelStreamCache::load_voxel_block(Vector3i position, uint8_t lod_index, VoxelBuffer &out_voxels) {
+size_t VoxelStreamCache::Block::get_size_in_bytes() const {
+#ifdef VOXEL_ENABLE_INSTANCER
+	return voxels.size() + instances.size();
+#else
+	return voxels.size();
+#endif
+}
+
+namespace {
+
+size_t get_blocks_size_in_bytes(const StdUnorderedMap<Vector3i, VoxelStreamCache::Block> &blocks) {
+	size_t size = 0;
+	for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+		size += it->second.get_size_in_bytes();
+	}
+	return size;
+}
+
+} // namespace
+
+VoxelStreamCache::Block &VoxelStreamCache::get_or_create_block_no_lock(
+		Lod &lod,
+		Vector3i position,
+		uint8_t lod_index
+) {
+	auto it = lod.blocks.find(position);
+	if (it != lod.blocks.end()) {
+		return it->second;
+	}
+	// Not cached yet, create an entry
+	Block &block = lod.blocks[position];
+	block.position = position;
+	block.lod = lod_index;
+	_count.fetch_add(1, std::memory_order_relaxed);
+	return block;
+}
+
+bool VoxelStreamCache::load_voxel_block(Vector3i position, uint8_t lod_index, StdVector<uint8_t> &out_data) const {
 	const Lod &lod = _cache[lod_index];
 
 	RWLockRead rlock(lod.rw_lock);
@@ -20,103 +58,137 @@ bool VoxelStreamCache::load_voxel_block(Vector3i position, uint8_t lod_index, Vo
 			return false;
 		}
 		// In cache, serve it
-
-		// Copying is required since the cache has ownership on its data,
-		// and the requests wants us to populate the buffer it provides
-		block.voxels.copy_to(out_voxels, true);
-
+		out_data = block.voxels;
 		return true;
 	}
 }
 
-void VoxelStreamCache::save_voxel_block(Vector3i position, uint8_t lod_index, VoxelBuffer &voxels) {
+void VoxelStreamCache::save_voxel_block(Vector3i position, uint8_t lod_index, Span<const uint8_t> data) {
+	ZN_ASSERT_RETURN_MSG(data.size() > 0, "Saving empty voxel data is not expected. Bug?");
+
 	Lod &lod = _cache[lod_index];
 	RWLockWrite wlock(lod.rw_lock);
-	auto it = lod.blocks.find(position);
-
-	ZN_ASSERT_RETURN_MSG(
-			!Vector3iUtil::is_empty_size(voxels.get_size()), "Saving voxel buffer with empty size is not expected. Bug?"
-	);
 
-	if (it == lod.blocks.end()) {
-		// Not cached yet, create an entry
-		Block b;
-		b.position = position;
-		b.lod = lod_index;
-		// TODO Optimization: if we know the buffer is not shared, we could use move instead
-		voxels.copy_to(b.voxels, true);
-		b.has_voxels = true;
-		lod.blocks.insert(std::make_pair(position, std::move(b)));
-		++_count;
+	Block &block = get_or_create_block_no_lock(lod, position, lod_index);
 
-	} else {
-		// Cached already, overwrite
-		voxels.move_to(it->second.voxels);
-		it->second.has_voxels = true;
-	}
+	_size_in_bytes.fetch_sub(block.voxels.size(), std::memory_order_relaxed);
+	block.voxels.assign(data.data(), data.data() + data.size());
+	block.has_voxels = true;
+	_size_in_bytes.fetch_add(block.voxels.size(), std::memory_order_relaxed);
 }
 
 #ifdef VOXEL_ENABLE_INSTANCER
 
-bool VoxelStreamCache::load_instance_block(
-		Vector3i position,
-		uint8_t lod_index,
-		UniquePtr<InstanceBlockData> &out_instances
-) {
+bool VoxelStreamCache::load_instance_block(Vector3i position, uint8_t lod_index, StdVector<uint8_t> &out_data) const {
 	const Lod &lod = _cache[lod_index];
-	lod.rw_lock.read_lock();
+
+	RWLockRead rlock(lod.rw_lock);
+
 	auto it = lod.blocks.find(position);
 
 	if (it == lod.blocks.end()) {
 		// Not in cache, will have to query
-		lod.rw_lock.read_unlock();
 		return false;
 
 	} else {
-		// In cache, serve it
-
-		if (it->second.instances == nullptr) {
-			out_instances = nullptr;
-
-		} else {
-			// Copying is required since the cache has ownership on its data
-			out_instances = make_unique_instance<InstanceBlockData>();
-			it->second.instances->copy_to(*out_instances);
+		const Block &block = it->second;
+		if (!block.has_instances) {
+			// Only voxels were saved, the stream may still have instances for this block
+			return false;
 		}
-
-		lod.rw_lock.read_unlock();
+		// In cache, serve it
+		out_data = block.instances;
 		return true;
 	}
 }
 
-void VoxelStreamCache::save_instance_block(
-		Vector3i position,
-		uint8_t lod_index,
-		UniquePtr<InstanceBlockData> instances
-) {
+void VoxelStreamCache::save_instance_block(Vector3i position, uint8_t lod_index, Span<const uint8_t> data) {
 	Lod &lod = _cache[lod_index];
 	RWLockWrite wlock(lod.rw_lock);
-	auto it = lod.blocks.find(position);
 
-	if (it == lod.blocks.end()) {
-		// Not cached yet, create an entry
-		Block b;
-		b.position = position;
-		b.lod = lod_index;
-		b.instances = std::move(instances);
-		lod.blocks.insert(std::make_pair(position, std::move(b)));
-		++_count;
+	Block &block = get_or_create_block_no_lock(lod, position, lod_index);
 
-	} else {
-		// Cached already, overwrite
-		it->second.instances = std::move(instances);
+	_size_in_bytes.fetch_sub(block.instances.size(), std::memory_order_relaxed);
+	block.instances.assign(data.data(), data.data() + data.size());
+	block.has_instances = true;
+	_size_in_bytes.fetch_add(block.instances.size(), std::memory_order_relaxed);
+}
+
+#endif
+
+void VoxelStreamCache::move_all_to(VoxelStreamCache &dst) {
+	ZN_ASSERT_RETURN(&dst != this);
+
+	for (unsigned int lod_index = 0; lod_index < _cache.size(); ++lod_index) {
+		Lod &src_lod = _cache[lod_index];
+		Lod &dst_lod = dst._cache[lod_index];
+
+		// Locking both so blocks are never absent from both caches from the point of view of readers
+		RWLockWrite src_wlock(src_lod.rw_lock);
+		RWLockWrite dst_wlock(dst_lod.rw_lock);
+
+		ZN_ASSERT_CONTINUE(dst_lod.blocks.size() == 0);
+
+		const uint32_t count = src_lod.blocks.size();
+		const size_t size = get_blocks_size_in_bytes(src_lod.blocks);
+
+		std::swap(src_lod.blocks, dst_lod.blocks);
+
+		_count.fetch_sub(count, std::memory_order_relaxed);
+		_size_in_bytes.fetch_sub(size, std::memory_order_relaxed);
+		dst._count.fetch_add(count, std::memory_order_relaxed);
+		dst._size_in_bytes.fetch_add(size, std::memory_order_relaxed);
 	}
 }
 
+void VoxelStreamCache::move_unsaved_to(VoxelStreamCache &dst) {
+	ZN_ASSERT_RETURN(&dst != this);
+
+	for (unsigned int lod_index = 0; lod_index < _cache.size(); ++lod_index) {
+		Lod &src_lod = _cache[lod_index];
+		Lod &dst_lod = dst._cache[lod_index];
+
+		RWLockWrite src_wlock(src_lod.rw_lock);
+		RWLockWrite dst_wlock(dst_lod.rw_lock);
+
+		// Counted before, since data gets moved out of blocks
+		const uint32_t count = src_lod.blocks.size();
+		const size_t size = get_blocks_size_in_bytes(src_lod.blocks);
+
+		for (auto it = src_lod.blocks.begin(); it != src_lod.blocks.end(); ++it) {
+			Block &src_block = it->second;
+			Block &dst_block = dst.get_or_create_block_no_lock(dst_lod, src_block.position, lod_index);
+
+			// Data present in the destination was saved after, so it takes precedence
+			if (src_block.has_voxels && !dst_block.has_voxels) {
+				dst_block.voxels = std::move(src_block.voxels);
+				dst_block.has_voxels = true;
+				dst_block.voxels_deleted = src_block.voxels_deleted;
+				dst._size_in_bytes.fetch_add(dst_block.voxels.size(), std::memory_order_relaxed);
+			}
+#ifdef VOXEL_ENABLE_INSTANCER
+			if (src_block.has_instances && !dst_block.has_instances) {
+				dst_block.instances = std::move(src_block.instances);
+				dst_block.has_instances = true;
+				dst._size_in_bytes.fetch_add(dst_block.instances.size(), std::memory_order_relaxed);
+			}
 #endif
+		}
 
-unsigned int VoxelStreamCache::get_indicative_block_count() const {
-	return _count;
+		_count.fetch_sub(count, std::memory_order_relaxed);
+		_size_in_bytes.fetch_sub(size, std::memory_order_relaxed);
+		src_lod.blocks.clear();
+	}
+}
+
+void VoxelStreamCache::clear() {
+	for (unsigned int lod_index = 0; lod_index < _cache.size(); ++lod_index) {
+		Lod &lod = _cache[lod_index];
+		RWLockWrite wlock(lod.rw_lock);
+		_count.fetch_sub(lod.blocks.size(), std::memory_order_relaxed);
+		_size_in_bytes.fetch_sub(get_blocks_size_in_bytes(lod.blocks), std::memory_order_relaxed);
+		lod.blocks.clear();
+	}
 }
 
 } // namespace zylann::voxel
@@ -1,19 +1,21 @@
 #ifndef VOXEL_STREAM_CACHE_H
 #define VOXEL_STREAM_CACHE_H
 
-#include "../storage/voxel_buffer.h"
+#include "../constants/voxel_constants.h"
+#include "../util/containers/fixed_array.h"
+#include "../util/containers/span.h"
 #include "../util/containers/std_unordered_map.h"
-#include "../util/memory/memory.h"
+#include "../util/containers/std_vector.h"
+#include "../util/math/vector3i.h"
 #include "../util/thread/rw_lock.h"
-
-#ifdef VOXEL_ENABLE_INSTANCER
-#include "instance_data.h"
-#endif
+#include <atomic>
 
 namespace zylann::voxel {
 
 // In-memory database for voxel streams.
 // It allows to cache blocks so we can save to the filesystem later less frequently, or quickly reload recent blocks.
+// Blocks are stored already serialized and compressed, in the format the stream will write them. This makes the
+// memory used by the cache measurable, and leaves only I/O to do when flushing.
 class VoxelStreamCache {
 public:
 	struct Block {
@@ -25,42 +27,61 @@ public:
 		// - Voxel data has never been saved over, so should be left untouched
 		bool has_voxels = false;
 		bool voxels_deleted = false;
+#ifdef VOXEL_ENABLE_INSTANCER
+		// Same as voxels. If instances were saved but the data is empty, it means the block has no instances.
+		bool has_instances = false;
+#endif
 
-		VoxelBuffer voxels;
+		StdVector<uint8_t> voxels;
 #ifdef VOXEL_ENABLE_INSTANCER
-		UniquePtr<InstanceBlockData> instances;
+		StdVector<uint8_t> instances;
 #endif
 
-		Block() : voxels(VoxelBuffer::ALLOCATOR_POOL) {}
+		size_t get_size_in_bytes() const;
 	};
 
-	// Copies cached block into provided buffer
-	bool load_voxel_block(Vector3i position, uint8_t lod_index, VoxelBuffer &out_voxels);
+	// Copies cached block data into the provided vector
+	bool load_voxel_block(Vector3i position, uint8_t lod_index, StdVector<uint8_t> &out_data) const;
 
-	// Stores provided block into the cache. The cache will take ownership of the provided data.
-	void save_voxel_block(Vector3i position, uint8_t lod_index, VoxelBuffer &voxels);
+	// Stores a copy of the provided data into the cache
+	void save_voxel_block(Vector3i position, uint8_t lod_index, Span<const uint8_t> data);
 
 #ifdef VOXEL_ENABLE_INSTANCER
-	// Copies cached data into the provided pointer. A new instance will be made if found.
-	bool load_instance_block(Vector3i position, uint8_t lod_index, UniquePtr<InstanceBlockData> &out_instances);
+	// Copies cached data into the provided vector. If found, empty data means the block has no instances.
+	bool load_instance_block(Vector3i position, uint8_t lod_index, StdVector<uint8_t> &out_data) const;
 
-	// Stores provided block into the cache. The cache will take ownership of the provided data.
-	void save_instance_block(Vector3i position, uint8_t lod_index, UniquePtr<InstanceBlockData> instances);
+	// Stores a copy of the provided data into the cache
+	void save_instance_block(Vector3i position, uint8_t lod_index, Span<const uint8_t> data);
 #endif
 
-	unsigned int get_indicative_block_count() const;
+	unsigned int get_indicative_block_count() const {
+		return _count.load(std::memory_order_relaxed);
+	}
+
+	// Gets how much serialized data is held by the cache
+	size_t get_size_in_bytes() const {
+		return _size_in_bytes.load(std::memory_order_relaxed);
+	}
+
+	// Moves all blocks into another cache, which must be empty. Readers looking up this cache first and then the
+	// destination will always find blocks, even if this runs concurrently.
+	void move_all_to(VoxelStreamCache &dst);
 
+	// Moves all blocks into another cache, except data for which the destination has a newer version.
+	// Used to give back blocks that could not be saved.
+	void move_unsaved_to(VoxelStreamCache &dst);
+
+	void clear();
+
+	// Blocks must not be added or removed while iterating.
 	template <typename F>
-	void flush(F save_func) {
-		_count = 0;
+	void for_each_block(F f) const {
 		for (unsigned int lod_index = 0; lod_index < _cache.size(); ++lod_index) {
-			Lod &lod = _cache[lod_index];
-			RWLockWrite wlock(lod.rw_lock);
+			const Lod &lod = _cache[lod_index];
+			RWLockRead rlock(lod.rw_lock);
 			for (auto it = lod.blocks.begin(); it != lod.blocks.end(); ++it) {
-				Block &block = it->second;
-				save_func(block);
+				f(it->second);
 			}
-			lod.blocks.clear();
 		}
 	}
 
@@ -71,8 +92,11 @@ private:
 		RWLock rw_lock;
 	};
 
+	Block &get_or_create_block_no_lock(Lod &lod, Vector3i position, uint8_t lod_index);
+
 	FixedArray<Lod, constants::MAX_LOD> _cache;
-	unsigned int _count = 0;
+	std::atomic_uint32_t _count = { 0 };
+	std::atomic_size_t _size_in_bytes = { 0 };
 };
 
 } // namespace zylann::voxel
@@ -0,0 +1,73 @@
+#include "async_edit_queue.h"
+#include "../../util/containers/container_funcs.h"
+#include "../../util/errors.h"
+#include "../../util/profiling.h"
+#include "../../util/tasks/async_dependency_tracker.h"
+#include "../../util/tasks/threaded_task.h"
+
+namespace zylann::voxel {
+
+AsyncEditQueue::~AsyncEditQueue() {
+	abort_pending();
+}
+
+void AsyncEditQueue::push(IThreadedTask *task, Box3i box, std::shared_ptr<AsyncDependencyTracker> tracker) {
+	ZN_ASSERT_RETURN(task != nullptr);
+	ZN_ASSERT_RETURN(tracker != nullptr);
+	_pending_edits.push_back(Edit{ task, box, tracker });
+}
+
+void AsyncEditQueue::process(StdVector<IThreadedTask *> &out_tasks, StdVector<Box3i> &out_completed_boxes) {
+	if (_pending_edits.size() == 0 && _running_edits.size() == 0) {
+		return;
+	}
+
+	ZN_PROFILE_SCOPE();
+
+	unordered_remove_if(_running_edits, [&out_completed_boxes](const Edit &edit) {
+		if (edit.tracker->is_complete()) {
+			out_completed_boxes.push_back(edit.box);
+			return true;
+		}
+		return edit.tracker->is_aborted();
+	});
+
+	unsigned int waiting_count = 0;
+	for (unsigned int edit_index = 0; edit_index < _pending_edits.size(); ++edit_index) {
+		Edit &edit = _pending_edits[edit_index];
+
+		bool must_wait = false;
+		for (const Edit &running_edit : _running_edits) {
+			if (running_edit.box.intersects(edit.box)) {
+				must_wait = true;
+				break;
+			}
+		}
+		for (unsigned int i = 0; i < waiting_count && !must_wait; ++i) {
+			if (_pending_edits[i].box.intersects(edit.box)) {
+				must_wait = true;
+			}
+		}
+
+		if (must_wait) {
+			_pending_edits[waiting_count] = std::move(edit);
+			++waiting_count;
+		} else {
+			out_tasks.push_back(edit.task);
+			edit.task = nullptr;
+			_running_edits.push_back(std::move(edit));
+		}
+	}
+	_pending_edits.resize(waiting_count);
+}
+
+void AsyncEditQueue::abort_pending() {
+	for (Edit &edit : _pending_edits) {
+		// Scripts may be waiting on the tracker
+		edit.tracker->abort();
+		ZN_DELETE(edit.task);
+	}
+	_pending_edits.clear();
+}
+
+} // namespace zylann::voxel
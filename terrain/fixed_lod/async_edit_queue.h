@@ -0,0 +1,56 @@
+#ifndef VOXEL_ASYNC_EDIT_QUEUE_H
+#define VOXEL_ASYNC_EDIT_QUEUE_H
+
+#include "../../util/containers/std_vector.h"
+#include "../../util/math/box3i.h"
+#include "../../util/memory/memory.h"
+
+namespace zylann {
+
+class IThreadedTask;
+class AsyncDependencyTracker;
+
+namespace voxel {
+
+// Edits of a terrain running on the thread pool. Only accessed from the main thread.
+// Edits whose area intersects a running edit or an edit pushed before them have to wait, so edits in the same area
+// complete in the order they were pushed. Others can run in parallel.
+class AsyncEditQueue {
+public:
+	~AsyncEditQueue();
+
+	// Takes ownership of the task until it is scheduled. The tracker must be completed or aborted by the task.
+	void push(IThreadedTask *task, Box3i box, std::shared_ptr<AsyncDependencyTracker> tracker);
+
+	// Forgets running edits that are finished, adding the area of those that completed to `out_completed_boxes`. Then
+	// moves pending edits that can run into `out_tasks`, in the order they were pushed. The caller must schedule them.
+	void process(StdVector<IThreadedTask *> &out_tasks, StdVector<Box3i> &out_completed_boxes);
+
+	// Drops pending edits and aborts their trackers. Edits already running can't be cancelled, so they are kept and
+	// their area will still be reported by `process` once they complete.
+	void abort_pending();
+
+	inline unsigned int get_pending_count() const {
+		return _pending_edits.size();
+	}
+
+	inline unsigned int get_running_count() const {
+		return _running_edits.size();
+	}
+
+private:
+	struct Edit {
+		// Null once the task was scheduled
+		IThreadedTask *task;
+		Box3i box;
+		std::shared_ptr<AsyncDependencyTracker> tracker;
+	};
+	// Edits waiting for previous edits in the same area to complete, in the order they were pushed
+	StdVector<Edit> _pending_edits;
+	StdVector<Edit> _running_edits;
+};
+
+} // namespace voxel
+} // namespace zylann
+
+#endif // VOXEL_ASYNC_EDIT_QUEUE_H
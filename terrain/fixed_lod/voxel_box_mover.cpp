@@ -4,6 +4,8 @@
 #include "../../storage/voxel_buffer.h"
 #include "../../storage/voxel_data.h"
 #include "../../util/containers/std_vector.h"
+#include "../../util/godot/core/packed_arrays.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 // #include "../../util/string/format.h"
 #include "../variable_lod/voxel_lod_terrain.h"
@@ -90,8 +92,10 @@ Vector3 get_motion(AABB box, Vector3 motion, Span<const AABB> environment_boxes,
 	// This also makes the algorithm tunnelling-free
 	const AABB expanded_box = expand_with_vector(box, motion);
 
-	// TODO Candidate for temp allocator
-	StdVector<AABB> colliding_boxes;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<AABB> colliding_boxes(temp_allocator);
+	colliding_boxes.reserve(environment_boxes.size());
 	for (size_t i = 0; i < environment_boxes.size(); ++i) {
 		const AABB &other = environment_boxes[i];
 		if (expanded_box.intersects(other)) {
@@ -199,96 +203,162 @@ bool intersects(Span<const AABB> aabbs, const AABB &box) {
 	return false;
 }
 
+// Calls `f(Vector3i rpos, uint64_t value)` for every voxel of a channel, reading its memory directly.
+// Positions are relative to the buffer.
+template <typename T, typename F>
+void for_each_voxel_in_channel_t(const VoxelBuffer &voxels, const unsigned int channel, F f) {
+	Span<const T> data;
+	ZN_ASSERT_RETURN(voxels.get_channel_data_read_only(channel, data));
+	const Vector3i size = voxels.get_size();
+	size_t i = 0;
+	Vector3i rpos;
+	// ZXY order
+	for (rpos.z = 0; rpos.z < size.z; ++rpos.z) {
+		for (rpos.x = 0; rpos.x < size.x; ++rpos.x) {
+			for (rpos.y = 0; rpos.y < size.y; ++rpos.y) {
+				f(rpos, data[i]);
+				++i;
+			}
+		}
+	}
+}
+
+template <typename F>
+void for_each_voxel_in_channel(const VoxelBuffer &voxels, const unsigned int channel, F f) {
+	const Vector3i size = voxels.get_size();
+
+	if (voxels.is_uniform(channel)) {
+		const uint64_t v = voxels.get_voxel(0, 0, 0, channel);
+		Vector3i rpos;
+		for (rpos.z = 0; rpos.z < size.z; ++rpos.z) {
+			for (rpos.x = 0; rpos.x < size.x; ++rpos.x) {
+				for (rpos.y = 0; rpos.y < size.y; ++rpos.y) {
+					f(rpos, v);
+				}
+			}
+		}
+		return;
+	}
+
+	switch (voxels.get_channel_depth(channel)) {
+		case VoxelBuffer::DEPTH_8_BIT:
+			for_each_voxel_in_channel_t<uint8_t>(voxels, channel, f);
+			break;
+		case VoxelBuffer::DEPTH_16_BIT:
+			for_each_voxel_in_channel_t<uint16_t>(voxels, channel, f);
+			break;
+		case VoxelBuffer::DEPTH_32_BIT:
+			for_each_voxel_in_channel_t<uint32_t>(voxels, channel, f);
+			break;
+		case VoxelBuffer::DEPTH_64_BIT:
+			for_each_voxel_in_channel_t<uint64_t>(voxels, channel, f);
+			break;
+		default:
+			ZN_PRINT_ERROR("Unhandled depth");
+			break;
+	}
+}
+
 void collect_boxes_blocky(
-		const VoxelData &voxels,
+		const VoxelBuffer &voxels,
+		const Vector3i origin,
 		const VoxelMesherBlocky &mesher,
-		const Vector3i minp,
-		const Vector3i maxp,
 		const uint32_t collision_mask,
-		StdVector<AABB> &potential_boxes
+		StdTempVector<AABB> &potential_boxes
 ) {
 	Ref<VoxelBlockyLibraryBase> library_ref = mesher.get_library();
 	ERR_FAIL_COND_MSG(library_ref.is_null(), "VoxelMesherBlocky has no library assigned");
 	const int channel = VoxelBuffer::CHANNEL_TYPE;
-	VoxelSingleValue defval;
-	defval.i = 0;
 
 	const blocky::BakedLibrary &baked_data = library_ref->get_baked_data();
 
-	Vector3i i = minp;
-
-	// TODO Optimization: read the whole box of voxels at once, querying individually is slower
-	for (i.z = minp.z; i.z < maxp.z; ++i.z) {
-		for (i.y = minp.y; i.y < maxp.y; ++i.y) {
-			for (i.x = minp.x; i.x < maxp.x; ++i.x) {
-				const int type_id = voxels.get_voxel(i, channel, defval).i;
+	if (voxels.is_uniform(channel)) {
+		// Common case (air, or buried underground): skip the whole box at once if it can't collide
+		const uint32_t type_id = voxels.get_voxel(0, 0, 0, channel);
+		if (!baked_data.has_model(type_id) ||
+			(baked_data.models[type_id].box_collision_mask & collision_mask) == 0) {
+			return;
+		}
+	}
 
-				if (baked_data.has_model(type_id)) {
-					const blocky::BakedModel &model = baked_data.models[type_id];
+	for_each_voxel_in_channel(
+			voxels,
+			channel,
+			[&baked_data, &potential_boxes, origin, collision_mask](const Vector3i rpos, const uint64_t value) {
+				const uint32_t type_id = value;
+				if (!baked_data.has_model(type_id)) {
+					return;
+				}
+				const blocky::BakedModel &model = baked_data.models[type_id];
 
-					if ((model.box_collision_mask & collision_mask) == 0) {
-						continue;
-					}
+				if ((model.box_collision_mask & collision_mask) == 0) {
+					return;
+				}
 
-					for (const AABB &aabb : model.box_collision_aabbs) {
-						AABB world_box = aabb;
-						world_box.position += i;
-						potential_boxes.push_back(world_box);
-					}
+				const Vector3 pos = origin + rpos;
+				for (const AABB &aabb : model.box_collision_aabbs) {
+					AABB world_box = aabb;
+					world_box.position += pos;
+					potential_boxes.push_back(world_box);
 				}
 			}
-		}
-	}
+	);
 }
 
-void collect_boxes_cubes(
-		const VoxelData &voxels,
-		const Vector3i minp,
-		const Vector3i maxp,
-		StdVector<AABB> &potential_boxes
-) {
+void collect_boxes_cubes(const VoxelBuffer &voxels, const Vector3i origin, StdTempVector<AABB> &potential_boxes) {
 	const int channel = VoxelBuffer::CHANNEL_COLOR;
-	VoxelSingleValue defval;
-	defval.i = 0;
-
-	Vector3i i = minp;
-
-	// TODO Optimization: read the whole box of voxels at once, querying individually is slower
-	for (i.z = minp.z; i.z < maxp.z; ++i.z) {
-		for (i.y = minp.y; i.y < maxp.y; ++i.y) {
-			for (i.x = minp.x; i.x < maxp.x; ++i.x) {
-				const int color_data = voxels.get_voxel(i, channel, defval).i;
-				if (color_data != 0) {
-					potential_boxes.push_back(AABB(i, Vector3(1, 1, 1)));
-				}
-			}
-		}
+
+	if (voxels.is_uniform(channel) && voxels.get_voxel(0, 0, 0, channel) == 0) {
+		return;
 	}
+
+	for_each_voxel_in_channel(voxels, channel, [&potential_boxes, origin](const Vector3i rpos, const uint64_t color) {
+		if (color != 0) {
+			potential_boxes.push_back(AABB(origin + rpos, Vector3(1, 1, 1)));
+		}
+	});
 }
 
 void collect_boxes(
-		const VoxelData &voxels,
+		const VoxelData &data,
 		const VoxelMesher &mesher,
 		const AABB query_box,
 		const uint32_t collision_nask,
-		StdVector<AABB> &potential_boxes
+		StdTempVector<AABB> &potential_boxes
 ) {
 	ZN_PROFILE_SCOPE();
 
 	const Vector3i minp = math::floor_to_int(query_box.position);
 	const Vector3i maxp = math::ceil_to_int(query_box.position + query_box.size);
+	const Vector3i size = maxp - minp;
 
-	const VoxelMesherBlocky *mesher_blocky = Object::cast_to<VoxelMesherBlocky>(&mesher);
-	if (mesher_blocky != nullptr) {
-		collect_boxes_blocky(voxels, *mesher_blocky, minp, maxp, collision_nask, potential_boxes);
+	if (Vector3iUtil::get_volume_u64(size) == 0) {
 		return;
 	}
 
-	const VoxelMesherCubes *mesher_cubes = Object::cast_to<VoxelMesherCubes>(&mesher);
-	if (mesher_cubes != nullptr) {
-		collect_boxes_cubes(voxels, minp, maxp, potential_boxes);
+	const VoxelMesherBlocky *mesher_blocky = Object::cast_to<VoxelMesherBlocky>(&mesher);
+	const VoxelMesherCubes *mesher_cubes =
+			mesher_blocky == nullptr ? Object::cast_to<VoxelMesherCubes>(&mesher) : nullptr;
+
+	if (mesher_blocky == nullptr && mesher_cubes == nullptr) {
 		return;
 	}
+
+	const unsigned int channel = mesher_blocky != nullptr ? VoxelBuffer::CHANNEL_TYPE : VoxelBuffer::CHANNEL_COLOR;
+
+	// Read the whole box at once, which takes the spatial lock only once and avoids per-voxel lookups.
+	// The buffer is re-used between calls so it keeps its allocations.
+	// TODO Candidate for temp allocator
+	static thread_local VoxelBuffer s_voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+	VoxelBuffer &voxels = s_voxels;
+	voxels.create(size);
+	data.copy(minp, voxels, 1 << channel, false);
+
+	if (mesher_blocky != nullptr) {
+		collect_boxes_blocky(voxels, minp, *mesher_blocky, collision_nask, potential_boxes);
+	} else {
+		collect_boxes_cubes(voxels, minp, potential_boxes);
+	}
 }
 
 } // namespace
@@ -313,15 +383,67 @@ Vector3 VoxelBoxMover::get_motion(
 
 	const AABB box(aabb.position + pos, aabb.size);
 
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<AABB> colliding_boxes(temp_allocator);
+
+	const Vector3 final_motion = get_motion_local(box, input_motion, terrain_data, mesher, colliding_boxes);
+
+	// Switch back to world
+	const Vector3 world_slided_motion = to_world.basis.xform(final_motion);
+
+	return world_slided_motion;
+}
+
+void VoxelBoxMover::get_motions(
+		Span<const Body> bodies,
+		Span<Vector3> out_motions,
+		const VoxelData &terrain_data,
+		const Transform3D &terrain_transform,
+		const VoxelMesher &mesher
+) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN(bodies.size() == out_motions.size());
+
+	// Transform to local in case the volume is transformed.
+	// Done once for all bodies.
+	const Transform3D to_world = terrain_transform;
+	const Transform3D to_local = to_world.affine_inverse();
+	const Transform3D to_local_basis(to_local.basis, Vector3());
+
+	// Re-used for every body, so it only grows until it fits the body with the most potential collisions
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<AABB> colliding_boxes(temp_allocator);
+
+	for (unsigned int i = 0; i < bodies.size(); ++i) {
+		const Body &body = bodies[i];
+
+		const Vector3 pos = to_local.xform(body.position);
+		const Vector3 input_motion = to_local.basis.xform(body.motion);
+		const AABB aabb = to_local_basis.xform(body.aabb);
+
+		const AABB box(aabb.position + pos, aabb.size);
+
+		const Vector3 final_motion = get_motion_local(box, input_motion, terrain_data, mesher, colliding_boxes);
+
+		out_motions[i] = to_world.basis.xform(final_motion);
+	}
+}
+
+Vector3 VoxelBoxMover::get_motion_local(
+		const AABB box,
+		const Vector3 input_motion,
+		const VoxelData &terrain_data,
+		const VoxelMesher &mesher,
+		StdTempVector<AABB> &potential_boxes
+) {
 	AABB expanded_box = expand_with_vector(box, input_motion);
 	if (_step_climbing_enabled) {
 		// We'll have to gather a bit higher for ceilings in case we have to climb up steps
 		expanded_box.size.y += _max_step_height;
 	}
 
-	// TODO Candidate for temp allocator
-	static thread_local StdVector<AABB> s_colliding_boxes;
-	StdVector<AABB> &potential_boxes = s_colliding_boxes;
 	potential_boxes.clear();
 
 	// Collect potential collisions with the terrain (broad phase)
@@ -394,10 +516,7 @@ Vector3 VoxelBoxMover::get_motion(
 		}
 	}
 
-	// Switch back to world
-	const Vector3 world_slided_motion = to_world.basis.xform(final_motion);
-
-	return world_slided_motion;
+	return final_motion;
 }
 
 void VoxelBoxMover::set_collision_mask(uint32_t mask) {
@@ -435,10 +554,9 @@ bool VoxelBoxMover::intersects(
 	const Transform3D to_local = to_world.affine_inverse();
 	const AABB aabb = to_local.xform(aabb_world);
 
-	// TODO Candidate for temp allocator
-	static thread_local StdVector<AABB> s_colliding_boxes;
-	StdVector<AABB> &potential_boxes = s_colliding_boxes;
-	potential_boxes.clear();
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<AABB> potential_boxes(temp_allocator);
 
 	// Collect potential collisions with the terrain (broad phase)
 	collect_boxes(terrain_data, mesher, aabb, _collision_mask, potential_boxes);
@@ -462,6 +580,50 @@ Vector3 VoxelBoxMover::_b_get_motion(Vector3 pos, Vector3 motion, AABB aabb, Obj
 	return get_motion(pos, motion, aabb, terrain->get_storage(), terrain->get_global_transform(), **mesher);
 }
 
+#if defined(ZN_GODOT)
+PackedVector3Array VoxelBoxMover::_b_get_motions(
+		PackedVector3Array p_positions,
+		PackedVector3Array p_motions,
+		AABB p_aabb,
+		Node *p_terrain_node
+) {
+#elif defined(ZN_GODOT_EXTENSION)
+PackedVector3Array VoxelBoxMover::_b_get_motions(
+		PackedVector3Array p_positions,
+		PackedVector3Array p_motions,
+		AABB p_aabb,
+		Object *p_terrain_node
+) {
+#endif
+	ERR_FAIL_COND_V(p_terrain_node == nullptr, PackedVector3Array());
+	VoxelNode *terrain = Object::cast_to<VoxelNode>(p_terrain_node);
+	ERR_FAIL_COND_V(terrain == nullptr, PackedVector3Array());
+	ERR_FAIL_COND_V(p_positions.size() != p_motions.size(), PackedVector3Array());
+
+	// The mesher is required to know how collisions should be processed
+	Ref<VoxelMesher> mesher = terrain->get_mesher();
+	ERR_FAIL_COND_V(mesher.is_null(), PackedVector3Array());
+
+	const Span<const Vector3> positions = to_span(p_positions);
+	const Span<const Vector3> motions = to_span(p_motions);
+
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<Body> bodies(temp_allocator);
+	bodies.resize(positions.size());
+	for (unsigned int i = 0; i < bodies.size(); ++i) {
+		bodies[i] = Body{ positions[i], motions[i], p_aabb };
+	}
+
+	PackedVector3Array results;
+	results.resize(bodies.size());
+	Span<Vector3> results_s(results.ptrw(), results.size());
+
+	get_motions(to_span(bodies), results_s, terrain->get_storage(), terrain->get_global_transform(), **mesher);
+
+	return results;
+}
+
 bool VoxelBoxMover::_b_intersects(AABB p_aabb, Object *p_terrain_node) const {
 	ERR_FAIL_COND_V(p_terrain_node == nullptr, false);
 	VoxelNode *terrain = Object::cast_to<VoxelNode>(p_terrain_node);
@@ -476,6 +638,9 @@ bool VoxelBoxMover::_b_intersects(AABB p_aabb, Object *p_terrain_node) const {
 
 void VoxelBoxMover::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_motion", "pos", "motion", "aabb", "terrain"), &VoxelBoxMover::_b_get_motion);
+	ClassDB::bind_method(
+			D_METHOD("get_motions", "positions", "motions", "aabb", "terrain"), &VoxelBoxMover::_b_get_motions
+	);
 	ClassDB::bind_method(D_METHOD("intersects", "aabb", "terrain"), &VoxelBoxMover::_b_intersects);
 
 	ClassDB::bind_method(D_METHOD("set_collision_mask", "mask"), &VoxelBoxMover::set_collision_mask);
@@ -1,7 +1,11 @@
 #ifndef VOXEL_BOX_MOVER_H
 #define VOXEL_BOX_MOVER_H
 
+#include "../../util/containers/span.h"
+#include "../../util/containers/std_vector.h"
 #include "../../util/godot/classes/ref_counted.h"
+#include "../../util/godot/core/packed_arrays.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/godot/macros.h"
 
 ZN_GODOT_FORWARD_DECLARE(class Node);
@@ -24,6 +28,22 @@ public:
 			const VoxelMesher &mesher
 	);
 
+	struct Body {
+		Vector3 position;
+		Vector3 motion;
+		AABB aabb;
+	};
+
+	// Same as `get_motion`, but processes many bodies in one call. Results are written in `out_motions`, which must
+	// have the same size as `bodies`. After this call, `has_stepped_up` refers to the last body.
+	void get_motions(
+			Span<const Body> bodies,
+			Span<Vector3> out_motions,
+			const VoxelData &terrain_data,
+			const Transform3D &terrain_transform,
+			const VoxelMesher &mesher
+	);
+
 	bool intersects(
 			const AABB aabb_world,
 			const VoxelData &terrain_data,
@@ -45,11 +65,32 @@ public:
 	bool has_stepped_up() const;
 
 private:
+	// Works in terrain local space
+	Vector3 get_motion_local(
+			const AABB box,
+			const Vector3 input_motion,
+			const VoxelData &terrain_data,
+			const VoxelMesher &mesher,
+			StdTempVector<AABB> &potential_boxes
+	);
+
 #if defined(ZN_GODOT)
 	Vector3 _b_get_motion(Vector3 p_pos, Vector3 p_motion, AABB p_aabb, Node *p_terrain_node);
+	PackedVector3Array _b_get_motions(
+			PackedVector3Array p_positions,
+			PackedVector3Array p_motions,
+			AABB p_aabb,
+			Node *p_terrain_node
+	);
 #elif defined(ZN_GODOT_EXTENSION)
 	// TODO GDX: it seems binding a method taking a `Node*` fails to compile. It is supposed to be working.
 	Vector3 _b_get_motion(Vector3 p_pos, Vector3 p_motion, AABB p_aabb, Object *p_terrain_node);
+	PackedVector3Array _b_get_motions(
+			PackedVector3Array p_positions,
+			PackedVector3Array p_motions,
+			AABB p_aabb,
+			Object *p_terrain_node
+	);
 #endif
 
 	bool _b_intersects(AABB p_aabb, Object *p_terrain_node) const;
@@ -1,7 +1,9 @@
 #ifndef VOXEL_MESH_BLOCK_VT_H
 #define VOXEL_MESH_BLOCK_VT_H
 
+#include "../../meshers/voxel_mesher.h"
 #include "../../util/godot/classes/material.h"
+#include "../../util/memory/memory.h"
 #include "../voxel_mesh_block.h"
 
 namespace zylann::voxel {
@@ -31,6 +33,9 @@ public:
 	// collision, it may be a better idea to use `is_area_editable` and not use mesh blocks
 	bool is_loaded = false;
 
+	// Set when building the collider was deferred, so it can be amortized separately from meshes
+	UniquePtr<VoxelMesher::Output> deferred_collider_data;
+
 	VoxelMeshBlockVT(const Vector3i bpos, unsigned int size) : VoxelMeshBlock(bpos) {
 		_position_in_voxels = bpos * size;
 	}
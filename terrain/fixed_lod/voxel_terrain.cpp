@@ -11,6 +11,7 @@
 #include "../../storage/voxel_buffer_gd.h"
 #include "../../storage/voxel_data.h"
 #include "../../streams/load_block_data_task.h"
+#include "../../streams/pre_generate_stream_task.h"
 #include "../../streams/save_block_data_task.h"
 #include "../../util/containers/container_funcs.h"
 #include "../../util/godot/classes/base_material_3d.h" // For property hint in release mode in GDExtension...
@@ -52,6 +53,7 @@ VoxelTerrain::VoxelTerrain() {
 	set_notify_transform(true);
 
 	_data = make_shared_instance<VoxelData>();
+	_data->set_task_scheduler(VoxelEngine::get_task_scheduler());
 
 	// TODO Should it actually be finite for better discovery?
 	// Infinite by default
@@ -60,32 +62,41 @@ VoxelTerrain::VoxelTerrain() {
 	_streaming_dependency = make_shared_instance<StreamingDependency>();
 	_meshing_dependency = make_shared_instance<MeshingDependency>();
 
-	struct ApplyMeshUpdateTask : public ITimeSpreadTask {
+	// Applies pending meshes within the budget of the terrain, and runs again next frame if some remain
+	struct ApplyMeshQueueTask : public ITimeSpreadTask {
 		void run(TimeSpreadTaskContext &ctx) override {
 			if (!VoxelEngine::get_singleton().is_volume_valid(volume_id)) {
 				// The node can have been destroyed while this task was still pending
-				ZN_PRINT_VERBOSE("Cancelling ApplyMeshUpdateTask, volume_id is invalid");
+				ZN_PRINT_VERBOSE("Cancelling ApplyMeshQueueTask, volume_id is invalid");
 				return;
 			}
-			self->apply_mesh_update(data);
+			self->process_mesh_apply_queue();
+			if (self->_mesh_apply_queue.get_pending_count() > 0) {
+				ctx.postpone = true;
+			} else {
+				self->_mesh_apply_task_scheduled = false;
+			}
 		}
 		VolumeID volume_id;
 		VoxelTerrain *self = nullptr;
-		VoxelEngine::BlockMeshOutput data;
 	};
 
-	// Mesh updates are spread over frames by scheduling them in a task runner of VoxelEngine,
+	// Mesh updates are spread over frames by a task processing the apply queue in a task runner of VoxelEngine,
 	// but instead of using a reception buffer we use a callback,
 	// because this kind of task scheduling would otherwise delay the update by 1 frame
 	VoxelEngine::VolumeCallbacks callbacks;
 	callbacks.data = this;
 	callbacks.mesh_output_callback = [](void *cb_data, VoxelEngine::BlockMeshOutput &ob) {
 		VoxelTerrain *self = reinterpret_cast<VoxelTerrain *>(cb_data);
-		ApplyMeshUpdateTask *task = ZN_NEW(ApplyMeshUpdateTask);
-		task->volume_id = self->_volume_id;
-		task->self = self;
-		task->data = std::move(ob);
-		VoxelEngine::get_singleton().push_main_thread_time_spread_task(task);
+		self->_mesh_apply_queue.push(std::move(ob));
+
+		if (!self->_mesh_apply_task_scheduled) {
+			ApplyMeshQueueTask *task = ZN_NEW(ApplyMeshQueueTask);
+			task->volume_id = self->_volume_id;
+			task->self = self;
+			VoxelEngine::get_singleton().push_main_thread_time_spread_task(task);
+			self->_mesh_apply_task_scheduled = true;
+		}
 	};
 	callbacks.data_output_callback = [](void *cb_data, VoxelEngine::BlockDataOutput &ob) {
 		VoxelTerrain *self = reinterpret_cast<VoxelTerrain *>(cb_data);
@@ -132,6 +143,40 @@ bool VoxelTerrain::get_generator_use_gpu() const {
 }
 #endif
 
+void VoxelTerrain::set_mesh_cache_size_mb(int size_mb) {
+	const size_t capacity = size_t(math::clamp(size_mb, 0, constants::MAX_MESH_CACHE_SIZE_MB)) * 1024 * 1024;
+	_meshing_dependency->mesh_cache.set_capacity(capacity);
+}
+
+int VoxelTerrain::get_mesh_cache_size_mb() const {
+	return _meshing_dependency->mesh_cache.get_capacity() / (1024 * 1024);
+}
+
+void VoxelTerrain::set_edit_journal_size_mb(int size_mb) {
+	const size_t capacity = size_t(math::clamp(size_mb, 0, constants::MAX_EDIT_JOURNAL_SIZE_MB)) * 1024 * 1024;
+	_data->set_edit_journal_capacity(capacity);
+}
+
+int VoxelTerrain::get_edit_journal_size_mb() const {
+	return _data->get_edit_journal_capacity() / (1024 * 1024);
+}
+
+void VoxelTerrain::set_mesh_apply_budget_usec(int usec) {
+	_mesh_apply_budget_usec = math::clamp(usec, 0, constants::MAX_MAIN_THREAD_BUDGET_USEC);
+}
+
+int VoxelTerrain::get_mesh_apply_budget_usec() const {
+	return _mesh_apply_budget_usec;
+}
+
+void VoxelTerrain::set_collision_apply_budget_usec(int usec) {
+	_collision_apply_budget_usec = math::clamp(usec, 0, constants::MAX_MAIN_THREAD_BUDGET_USEC);
+}
+
+int VoxelTerrain::get_collision_apply_budget_usec() const {
+	return _collision_apply_budget_usec;
+}
+
 VoxelData &VoxelTerrain::get_storage() const {
 	ZN_ASSERT(_data != nullptr);
 	return *_data;
@@ -516,6 +561,7 @@ void VoxelTerrain::unview_mesh_block(Vector3i bpos, bool mesh_flag, bool collisi
 		if (block->collision_viewers.get() == 0) {
 			// Collision no longer required
 			block->drop_collision();
+			block->deferred_collider_data.reset();
 			block->set_collision_enabled(false);
 		}
 	}
@@ -583,6 +629,21 @@ void VoxelTerrain::save_all_modified_blocks(bool with_copy, std::shared_ptr<Asyn
 	task_scheduler.flush();
 }
 
+std::shared_ptr<AsyncDependencyTracker> VoxelTerrain::pre_generate_to_stream(Box3i voxel_box) {
+	ZN_PROFILE_SCOPE();
+	ERR_FAIL_COND_V_MSG(get_stream().is_null(), nullptr, "Attempting to pre-generate blocks, but there is no stream.");
+	ERR_FAIL_COND_V_MSG(get_generator().is_null(), nullptr, "Attempting to pre-generate blocks without generator.");
+
+	const Box3i block_box = voxel_box.clipped(_data->get_bounds()).downscaled(_data->get_block_size());
+
+	StdVector<IThreadedTask *> tasks;
+	std::shared_ptr<AsyncDependencyTracker> tracker =
+			PreGenerateStreamTask::create_tasks(block_box, _streaming_dependency, _data, tasks);
+	VoxelEngine::get_singleton().push_async_tasks(to_span(tasks));
+
+	return tracker;
+}
+
 const VoxelTerrain::Stats &VoxelTerrain::get_stats() const {
 	return _stats;
 }
@@ -705,6 +766,13 @@ Dictionary VoxelTerrain::_b_get_statistics() const {
 	d["dropped_block_meshs"] = _stats.dropped_block_meshs;
 	d["updated_blocks"] = _stats.updated_blocks;
 
+	// Main thread mesh application
+	const MeshApplyQueue::Stats &mesh_apply_stats = _mesh_apply_queue.get_stats();
+	d["mesh_apply_queue_size"] = mesh_apply_stats.pending_count;
+	d["applied_meshes"] = mesh_apply_stats.applied_count;
+	d["time_apply_meshes"] = mesh_apply_stats.time_usec;
+	d["deferred_collision_updates"] = int(_deferred_collision_updates.size());
+
 	return d;
 }
 
@@ -742,6 +810,8 @@ void VoxelTerrain::stop_updater() {
 }
 
 void VoxelTerrain::remesh_all_blocks() {
+	// Cached meshes would be re-used otherwise
+	_meshing_dependency->mesh_cache.clear();
 	_mesh_map.for_each_block([this](VoxelMeshBlockVT &block) { //
 		try_schedule_mesh_update(block);
 	});
@@ -834,6 +904,10 @@ void VoxelTerrain::reset_map() {
 	_blocks_pending_load.clear();
 	_blocks_pending_update.clear();
 	_blocks_to_save.clear();
+	_mesh_apply_queue.clear();
+	_deferred_collision_updates.clear();
+	// Edits already running are kept, so their area gets remeshed once they complete
+	_async_edits.abort_pending();
 
 	// No need to care about refcounts, we drop everything anyways. Will pair it back on next process.
 	_paired_viewers.clear();
@@ -894,6 +968,25 @@ void VoxelTerrain::post_edit_area(Box3i box_in_voxels, bool update_mesh) {
 	}
 }
 
+void VoxelTerrain::push_async_edit(IThreadedTask *task, Box3i box, std::shared_ptr<AsyncDependencyTracker> tracker) {
+	_async_edits.push(task, box, tracker);
+}
+
+void VoxelTerrain::process_async_edits() {
+	StdVector<IThreadedTask *> tasks_to_schedule;
+	StdVector<Box3i> completed_boxes;
+	_async_edits.process(tasks_to_schedule, completed_boxes);
+
+	for (const Box3i &box : completed_boxes) {
+		// Assume the edit modified voxels in a way that affects meshes
+		post_edit_area(box, true);
+	}
+
+	if (tasks_to_schedule.size() > 0) {
+		VoxelEngine::get_singleton().push_async_tasks(to_span(tasks_to_schedule));
+	}
+}
+
 void VoxelTerrain::_notification(int p_what) {
 	struct SetWorldAction {
 		World3D *world;
@@ -1022,17 +1115,12 @@ void request_block_load(
 		std::shared_ptr<PriorityDependency::ViewersData> &shared_viewers_data,
 		const Transform3D volume_transform,
 		BufferedTaskScheduler &scheduler,
+		LoadBlockDataTaskBatcher &load_batcher,
 		bool use_gpu,
 		const std::shared_ptr<VoxelData> &voxel_data
 ) {
 	ZN_ASSERT(stream_dependency != nullptr);
 
-#ifdef VOXEL_ENABLE_GPU
-	if (use_gpu && (stream_dependency->generator.is_null() || !stream_dependency->generator->supports_shaders())) {
-		use_gpu = false;
-	}
-#endif
-
 	const unsigned int data_block_size = voxel_data->get_block_size();
 
 	if (stream_dependency->stream.is_valid()) {
@@ -1041,22 +1129,7 @@ void request_block_load(
 				priority_dependency, block_pos, data_block_size, shared_viewers_data, volume_transform
 		);
 
-		const bool request_instances = false;
-		LoadBlockDataTask *task = ZN_NEW(LoadBlockDataTask(
-				volume_id,
-				block_pos,
-				0,
-				data_block_size,
-				request_instances,
-				stream_dependency,
-				priority_dependency,
-				true,
-				use_gpu,
-				voxel_data,
-				TaskCancellationToken()
-		));
-
-		scheduler.push_io_task(task);
+		load_batcher.add(block_pos, 0, priority_dependency, TaskCancellationToken());
 
 	} else {
 		// Directly generate the block without checking the stream
@@ -1096,6 +1169,19 @@ void VoxelTerrain::send_data_load_requests() {
 
 		BufferedTaskScheduler &scheduler = BufferedTaskScheduler::get_for_current_thread();
 
+		bool use_gpu = _generator_use_gpu;
+#ifdef VOXEL_ENABLE_GPU
+		if (use_gpu &&
+			(_streaming_dependency->generator.is_null() || !_streaming_dependency->generator->supports_shaders())) {
+			use_gpu = false;
+		}
+#endif
+
+		const bool request_instances = false;
+		LoadBlockDataTaskBatcher load_batcher(
+				_volume_id, _data->get_block_size(), request_instances, _streaming_dependency, true, use_gpu, _data
+		);
+
 		// Blocks to load
 		for (size_t i = 0; i < _blocks_pending_load.size(); ++i) {
 			const Vector3i block_pos = _blocks_pending_load[i];
@@ -1135,11 +1221,13 @@ void VoxelTerrain::send_data_load_requests() {
 						shared_viewers_data,
 						volume_transform,
 						scheduler,
-						_generator_use_gpu,
+						load_batcher,
+						use_gpu,
 						_data
 				);
 			}
 		}
+		load_batcher.flush(scheduler);
 		scheduler.flush();
 		_blocks_pending_load.clear();
 	}
@@ -1247,6 +1335,7 @@ void VoxelTerrain::notify_data_block_enter(const VoxelDataBlock &block, Vector3i
 
 void VoxelTerrain::process() {
 	ZN_PROFILE_SCOPE();
+	ProfilingClock profiling_clock;
 
 #ifdef VOXEL_ENABLE_GPU
 	if (get_generator_use_gpu()) {
@@ -1280,15 +1369,26 @@ void VoxelTerrain::process() {
 		_quick_reloading_blocks.clear();
 	}
 
+	process_async_edits();
 	process_viewers();
 	// process_received_data_blocks();
 	process_meshing();
 
+	// Colliders are amortized separately from meshes, because building them is often more expensive
+	if (_deferred_collision_updates.size() > 0) {
+		const uint32_t collision_budget_usec = _collision_apply_budget_usec != 0
+				? _collision_apply_budget_usec
+				: VoxelEngine::get_singleton().get_main_thread_time_budget_usec();
+		process_deferred_collision_updates(collision_budget_usec);
+	}
+
 #ifdef TOOLS_ENABLED
 	if (debug_is_draw_enabled() && is_visible_in_tree()) {
 		process_debug_draw();
 	}
 #endif
+
+	VoxelEngine::get_singleton().add_main_thread_volume_time_usec(profiling_clock.get_elapsed_microseconds());
 }
 
 void VoxelTerrain::process_viewers() {
@@ -1942,6 +2042,11 @@ void VoxelTerrain::process_meshing() {
 		task->meshing_dependency = _meshing_dependency;
 		task->require_visual = mesh_block->mesh_viewers.get() > 0;
 		task->collision_hint = _generate_collisions && mesh_block->collision_viewers.get() > 0;
+		// Collision viewers can change before the result is applied
+		task->surface_arrays_required = _generate_collisions;
+#ifdef VOXEL_ENABLE_INSTANCER
+		task->surface_arrays_required |= (_instancer != nullptr);
+#endif
 		task->data = _data;
 
 		// This iteration order is specifically chosen to match VoxelEngine and threaded access
@@ -1988,7 +2093,59 @@ void VoxelTerrain::process_meshing() {
 	// String::num(_block_update_queue.size()));
 }
 
-void VoxelTerrain::apply_mesh_update(const VoxelEngine::BlockMeshOutput &ob) {
+void VoxelTerrain::process_mesh_apply_queue() {
+	ZN_PROFILE_SCOPE();
+
+	if (!is_inside_tree()) {
+		// Results can't be applied outside of the scene tree
+		_stats.dropped_block_meshs += _mesh_apply_queue.get_pending_count();
+		_mesh_apply_queue.clear();
+		return;
+	}
+
+	VoxelEngine &engine = VoxelEngine::get_singleton();
+	const bool use_shared_budget = _mesh_apply_budget_usec == 0;
+	const uint32_t budget_usec =
+			use_shared_budget ? engine.get_shared_mesh_apply_budget_usec() : _mesh_apply_budget_usec;
+
+	// Costs are evaluated in the local space of the terrain
+	const LocalCameraInfo camera = get_local_camera_info();
+	const Transform3D world_to_local = get_global_transform().affine_inverse();
+	const Vector3 camera_pos = world_to_local.xform(camera.position);
+	const Vector3 camera_forward = world_to_local.basis.xform(camera.forward).normalized();
+	const int block_size = get_mesh_block_size();
+	// Half of the diagonal of a block
+	const float block_radius = 0.87f * block_size;
+
+	_mesh_apply_queue.process(
+			budget_usec,
+			[this, camera_pos, camera_forward, block_size, block_radius](const VoxelEngine::BlockMeshOutput &ob) {
+				const Vector3 block_center = to_vec3(ob.position * block_size + Vector3iUtil::create(block_size / 2));
+
+				float closest_distance_sq = 0.f;
+				for (unsigned int i = 0; i < _paired_viewers.size(); ++i) {
+					const Vector3 viewer_pos = to_vec3(_paired_viewers[i].state.local_position_voxels);
+					const float distance_sq = block_center.distance_squared_to(viewer_pos);
+					if (i == 0 || distance_sq < closest_distance_sq) {
+						closest_distance_sq = distance_sq;
+					}
+				}
+
+				return MeshApplyQueue::get_block_cost(
+						block_center, block_radius, closest_distance_sq, camera_pos, camera_forward
+				);
+			},
+			[this](VoxelEngine::BlockMeshOutput &ob) { //
+				apply_mesh_update(ob);
+			}
+	);
+
+	if (use_shared_budget) {
+		engine.consume_shared_mesh_apply_budget_usec(_mesh_apply_queue.get_stats().time_usec);
+	}
+}
+
+void VoxelTerrain::apply_mesh_update(VoxelEngine::BlockMeshOutput &ob) {
 	ZN_PROFILE_SCOPE();
 	// print_line(String("DDD receive {0}").format(varray(ob.position.to_vec3())));
 
@@ -2093,25 +2250,22 @@ void VoxelTerrain::apply_mesh_update(const VoxelEngine::BlockMeshOutput &ob) {
 	}
 
 	const bool gen_collisions = _generate_collisions && block->collision_viewers.get() > 0;
+	bool collider_deferred = false;
 	if (gen_collisions) {
-		Ref<Shape3D> collision_shape = make_collision_shape_from_mesher_output(ob.surfaces, **_mesher);
+		if (_collision_apply_budget_usec == 0) {
+			update_block_collider(*block, ob.surfaces);
+			// In case the budget was changed while a collider was pending
+			block->deferred_collider_data.reset();
 
-		bool debug_collisions = false;
-		if (is_inside_tree()) {
-			const SceneTree *scene_tree = get_tree();
-#if DEBUG_ENABLED
-			if (collision_shape.is_valid()) {
-				const Color debug_color = zylann::godot::get_shape_3d_default_color(*scene_tree);
-				zylann::godot::set_shape_3d_debug_color(**collision_shape, debug_color);
+		} else {
+			if (block->deferred_collider_data == nullptr) {
+				_deferred_collision_updates.push_back(ob.position);
+				block->deferred_collider_data = make_unique_instance<VoxelMesher::Output>();
 			}
-#endif
-			debug_collisions = scene_tree->is_debugging_collisions_hint();
+			// Only the latest result matters
+			*block->deferred_collider_data = std::move(ob.surfaces);
+			collider_deferred = true;
 		}
-
-		block->set_collision_shape(collision_shape, debug_collisions, this, _collision_margin);
-
-		block->set_collision_layer(_collision_layer);
-		block->set_collision_mask(_collision_mask);
 	}
 
 	block->set_visible(block->mesh_viewers.get() > 0);
@@ -2122,12 +2276,68 @@ void VoxelTerrain::apply_mesh_update(const VoxelEngine::BlockMeshOutput &ob) {
 	// Can't set the state because there could be more than one update in progress. Perhaps it needs refactoring.
 	// block->set_mesh_state(VoxelMeshBlockVT::MESH_UP_TO_DATE);
 
-	if (block->is_loaded == false) {
+	// When the collider is deferred, the block is considered loaded once the collider is built
+	if (block->is_loaded == false && !collider_deferred) {
 		block->is_loaded = true;
 		emit_mesh_block_entered(ob.position);
 	}
 }
 
+void VoxelTerrain::update_block_collider(VoxelMeshBlockVT &block, const VoxelMesher::Output &mesher_output) {
+	Ref<Shape3D> collision_shape = make_collision_shape_from_mesher_output(mesher_output, **_mesher);
+
+	bool debug_collisions = false;
+	if (is_inside_tree()) {
+		const SceneTree *scene_tree = get_tree();
+#if DEBUG_ENABLED
+		if (collision_shape.is_valid()) {
+			const Color debug_color = zylann::godot::get_shape_3d_default_color(*scene_tree);
+			zylann::godot::set_shape_3d_debug_color(**collision_shape, debug_color);
+		}
+#endif
+		debug_collisions = scene_tree->is_debugging_collisions_hint();
+	}
+
+	block.set_collision_shape(collision_shape, debug_collisions, this, _collision_margin);
+
+	block.set_collision_layer(_collision_layer);
+	block.set_collision_mask(_collision_mask);
+}
+
+void VoxelTerrain::process_deferred_collision_updates(uint32_t budget_usec) {
+	ZN_PROFILE_SCOPE();
+
+	const ProfilingClock profiling_clock;
+
+	for (unsigned int i = 0; i < _deferred_collision_updates.size(); ++i) {
+		const Vector3i block_pos = _deferred_collision_updates[i];
+		VoxelMeshBlockVT *block = _mesh_map.get_block(block_pos);
+
+		unordered_remove(_deferred_collision_updates, i);
+		--i;
+
+		if (block == nullptr || block->deferred_collider_data == nullptr) {
+			// Block was unloaded or no longer needs a collider
+			continue;
+		}
+
+		if (_mesher.is_valid() && _generate_collisions) {
+			update_block_collider(*block, *block->deferred_collider_data);
+		}
+		block->deferred_collider_data.reset();
+
+		if (block->is_loaded == false) {
+			block->is_loaded = true;
+			emit_mesh_block_entered(block_pos);
+		}
+
+		// We always process at least one, then we check the budget
+		if (profiling_clock.get_elapsed_microseconds() >= budget_usec) {
+			return;
+		}
+	}
+}
+
 Ref<VoxelTool> VoxelTerrain::get_voxel_tool() {
 	Ref<VoxelTool> vt = memnew(VoxelToolTerrain(this));
 	const int used_channels_mask = get_used_channels_mask();
@@ -2398,6 +2608,15 @@ Ref<VoxelSaveCompletionTracker> VoxelTerrain::_b_save_modified_blocks() {
 	return VoxelSaveCompletionTracker::create(tracker);
 }
 
+Ref<VoxelSaveCompletionTracker> VoxelTerrain::_b_pre_generate_to_stream(AABB voxel_area) {
+	std::shared_ptr<AsyncDependencyTracker> tracker =
+			pre_generate_to_stream(Box3i(voxel_area.position, voxel_area.size));
+	if (tracker == nullptr) {
+		return Ref<VoxelSaveCompletionTracker>();
+	}
+	return VoxelSaveCompletionTracker::create(tracker);
+}
+
 // Explicitly ask to save a block if it was modified
 void VoxelTerrain::_b_save_block(Vector3i p_block_pos) {
 	VoxelData::BlockToSave to_save;
@@ -2507,10 +2726,22 @@ void VoxelTerrain::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("save_modified_blocks"), &Self::_b_save_modified_blocks);
 	ClassDB::bind_method(D_METHOD("save_block", "position"), &Self::_b_save_block);
+	ClassDB::bind_method(D_METHOD("pre_generate_to_stream", "voxel_area"), &Self::_b_pre_generate_to_stream);
 
 	ClassDB::bind_method(D_METHOD("set_run_stream_in_editor", "enable"), &Self::set_run_stream_in_editor);
 	ClassDB::bind_method(D_METHOD("is_stream_running_in_editor"), &Self::is_stream_running_in_editor);
 
+	ClassDB::bind_method(D_METHOD("set_mesh_cache_size_mb", "size_mb"), &Self::set_mesh_cache_size_mb);
+	ClassDB::bind_method(D_METHOD("get_mesh_cache_size_mb"), &Self::get_mesh_cache_size_mb);
+	ClassDB::bind_method(D_METHOD("set_edit_journal_size_mb", "size_mb"), &Self::set_edit_journal_size_mb);
+	ClassDB::bind_method(D_METHOD("get_edit_journal_size_mb"), &Self::get_edit_journal_size_mb);
+
+	ClassDB::bind_method(D_METHOD("set_mesh_apply_budget_usec", "usec"), &Self::set_mesh_apply_budget_usec);
+	ClassDB::bind_method(D_METHOD("get_mesh_apply_budget_usec"), &Self::get_mesh_apply_budget_usec);
+
+	ClassDB::bind_method(D_METHOD("set_collision_apply_budget_usec", "usec"), &Self::set_collision_apply_budget_usec);
+	ClassDB::bind_method(D_METHOD("get_collision_apply_budget_usec"), &Self::get_collision_apply_budget_usec);
+
 	ClassDB::bind_method(D_METHOD("set_automatic_loading_enabled", "enable"), &Self::set_automatic_loading_enabled);
 	ClassDB::bind_method(D_METHOD("is_automatic_loading_enabled"), &Self::is_automatic_loading_enabled);
 
@@ -2569,6 +2800,11 @@ void VoxelTerrain::_bind_methods() {
 			"get_collision_mask"
 	);
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "collision_margin"), "set_collision_margin", "get_collision_margin");
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "collision_apply_budget_usec", PROPERTY_HINT_RANGE, "0,100000"),
+			"set_collision_apply_budget_usec",
+			"get_collision_apply_budget_usec"
+	);
 
 	ADD_GROUP("Materials", "");
 
@@ -2613,6 +2849,21 @@ void VoxelTerrain::_bind_methods() {
 			"is_stream_running_in_editor"
 	);
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "mesh_block_size"), "set_mesh_block_size", "get_mesh_block_size");
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "mesh_cache_size_mb", PROPERTY_HINT_RANGE, "0,4096"),
+			"set_mesh_cache_size_mb",
+			"get_mesh_cache_size_mb"
+	);
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "edit_journal_size_mb", PROPERTY_HINT_RANGE, "0,4096"),
+			"set_edit_journal_size_mb",
+			"get_edit_journal_size_mb"
+	);
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "mesh_apply_budget_usec", PROPERTY_HINT_RANGE, "0,100000"),
+			"set_mesh_apply_budget_usec",
+			"get_mesh_apply_budget_usec"
+	);
 #ifdef VOXEL_ENABLE_GPU
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_gpu_generation"), "set_generator_use_gpu", "get_generator_use_gpu");
 #endif
@@ -9,9 +9,11 @@
 #include "../../util/godot/core/gdvirtual.h"
 #include "../../util/godot/memory.h"
 #include "../../util/math/box3i.h"
+#include "../mesh_apply_queue.h"
 #include "../voxel_data_block_enter_info.h"
 #include "../voxel_mesh_map.h"
 #include "../voxel_node.h"
+#include "async_edit_queue.h"
 #include "voxel_mesh_block_vt.h"
 #include "voxel_terrain_multiplayer_synchronizer.h"
 
@@ -22,6 +24,7 @@
 namespace zylann {
 
 class AsyncDependencyTracker;
+class IThreadedTask;
 
 namespace voxel {
 
@@ -70,6 +73,12 @@ public:
 	void post_edit_voxel(Vector3i pos);
 	void post_edit_area(Box3i box_in_voxels, bool update_mesh);
 
+	// Schedules a task modifying voxels in the given box on a worker thread. The task must lock what it modifies, and
+	// call `post_complete` on the tracker when done. Edits whose boxes intersect run one after the other, in the order
+	// they were pushed. Once an edit completes, its box is updated as with `post_edit_area`.
+	// Must be called from the main thread.
+	void push_async_edit(IThreadedTask *task, Box3i box, std::shared_ptr<AsyncDependencyTracker> tracker);
+
 	void set_generate_collisions(bool enabled);
 	bool get_generate_collisions() const {
 		return _generate_collisions;
@@ -104,6 +113,20 @@ public:
 	bool get_generator_use_gpu() const;
 #endif
 
+	void set_mesh_cache_size_mb(int size_mb);
+	int get_mesh_cache_size_mb() const;
+
+	void set_edit_journal_size_mb(int size_mb);
+	int get_edit_journal_size_mb() const;
+
+	// 0 means the main thread time budget of VoxelEngine is used
+	void set_mesh_apply_budget_usec(int usec);
+	int get_mesh_apply_budget_usec() const;
+
+	// 0 means colliders are built along with meshes
+	void set_collision_apply_budget_usec(int usec);
+	int get_collision_apply_budget_usec() const;
+
 	VoxelData &get_storage() const override;
 
 	std::shared_ptr<VoxelData> get_storage_shared() const {
@@ -133,6 +156,11 @@ public:
 	// If the block is out of range of any viewer, it will be cancelled.
 	void generate_block_async(Vector3i block_position);
 
+	// Generates blocks in the given area and saves them into the stream, using the thread pool. Blocks already present
+	// in the stream are left untouched. Generated blocks are not loaded into the terrain. This is meant to prepare
+	// worlds ahead of time. Returns a tracker to check for progress, or null if the terrain has no stream or generator.
+	std::shared_ptr<AsyncDependencyTracker> pre_generate_to_stream(Box3i voxel_box);
+
 	struct Stats {
 		int updated_blocks = 0;
 		int dropped_block_loads = 0;
@@ -216,8 +244,12 @@ private:
 	);
 	// void process_received_data_blocks();
 	void process_meshing();
-	void apply_mesh_update(const VoxelEngine::BlockMeshOutput &ob);
+	void process_mesh_apply_queue();
+	void apply_mesh_update(VoxelEngine::BlockMeshOutput &ob);
+	void update_block_collider(VoxelMeshBlockVT &block, const VoxelMesher::Output &mesher_output);
+	void process_deferred_collision_updates(uint32_t budget_usec);
 	void apply_data_block_response(VoxelEngine::BlockDataOutput &ob);
+	void process_async_edits();
 
 	void _on_stream_params_changed();
 	// void _set_block_size_po2(int p_block_size_po2);
@@ -279,6 +311,7 @@ private:
 	Vector3i _b_data_block_to_voxel(Vector3i pos) const;
 	// void _force_load_blocks_binding(Vector3 center, Vector3 extents) { force_load_blocks(center, extents); }
 	Ref<VoxelSaveCompletionTracker> _b_save_modified_blocks();
+	Ref<VoxelSaveCompletionTracker> _b_pre_generate_to_stream(AABB voxel_area);
 	void _b_save_block(Vector3i p_block_pos);
 	void _b_set_bounds(AABB aabb);
 	AABB _b_get_bounds() const;
@@ -349,6 +382,8 @@ private:
 	};
 	StdVector<QuickReloadingBlock> _quick_reloading_blocks;
 
+	AsyncEditQueue _async_edits;
+
 	Ref<VoxelMesher> _mesher;
 
 	// Data stored with a shared pointer so it can be sent to asynchronous tasks, and these tasks can be cancelled by
@@ -356,6 +391,15 @@ private:
 	std::shared_ptr<StreamingDependency> _streaming_dependency;
 	std::shared_ptr<MeshingDependency> _meshing_dependency;
 
+	// Meshing results waiting to be applied on the main thread
+	MeshApplyQueue _mesh_apply_queue;
+	bool _mesh_apply_task_scheduled = false;
+	unsigned int _mesh_apply_budget_usec = 0;
+
+	unsigned int _collision_apply_budget_usec = 0;
+	// Blocks having a collider to build. The order in that list does not matter.
+	StdVector<Vector3i> _deferred_collision_updates;
+
 	bool _generate_collisions = true;
 	unsigned int _collision_layer = 1;
 	unsigned int _collision_mask = 1;
@@ -13,36 +13,35 @@ namespace zylann::voxel {
 // It is a deferred cost (it is not spent at the exact time the Mesh object is destroyed, it happens later), so had to
 // use a different type of task to load-balance it. What this task actually does is just to hold a reference on a mesh a
 // bit longer, assuming that mesh is no longer used. Then the execution of the task releases that reference.
+// Freeing mesh instances is also slow (it can cause the renderer to update lots of materials), so they are hidden
+// right away and freed along with their mesh.
 class FreeMeshTask : public IProgressiveTask {
 public:
 	static inline void try_add_and_destroy(zylann::godot::DirectMeshInstance &mi) {
-		const Mesh *mesh = mi.get_mesh_ptr();
-		if (mesh != nullptr && mesh->get_reference_count() == 1) {
-			// That instances holds the last reference to this mesh
-			add(mi.get_mesh());
+		if (!mi.is_valid()) {
+			// Releases the mesh, if any
+			mi.destroy();
+			return;
 		}
-		mi.destroy();
+		mi.set_visible(false);
+		add(std::move(mi));
 	}
 
 	void run() override {
 		ZN_PROFILE_SCOPE();
-		if (_mesh->get_reference_count() > 1) {
-			ZN_PRINT_WARNING("Mesh has more than one ref left, task spreading will not be effective at smoothing "
-							 "destruction cost");
-		}
-		_mesh.unref();
+		// If the instance held the last reference to its mesh, this frees the mesh too
+		_mesh_instance.destroy();
 	}
 
 private:
-	static void add(Ref<Mesh> mesh) {
-		ZN_ASSERT(mesh.is_valid());
-		FreeMeshTask *task = ZN_NEW(FreeMeshTask(mesh));
+	static void add(zylann::godot::DirectMeshInstance &&mi) {
+		FreeMeshTask *task = ZN_NEW(FreeMeshTask(std::move(mi)));
 		VoxelEngine::get_singleton().push_main_thread_progressive_task(task);
 	}
 
-	FreeMeshTask(Ref<Mesh> p_mesh) : _mesh(p_mesh) {}
+	FreeMeshTask(zylann::godot::DirectMeshInstance &&p_mesh_instance) : _mesh_instance(std::move(p_mesh_instance)) {}
 
-	Ref<Mesh> _mesh;
+	zylann::godot::DirectMeshInstance _mesh_instance;
 };
 
 } // namespace zylann::voxel
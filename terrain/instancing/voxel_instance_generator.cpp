@@ -12,6 +12,7 @@
 #include "../../util/math/conv.h"
 #include "../../util/math/triangle.h"
 #include "../../util/math/vector4f.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 #include "../../util/string/format.h"
 
@@ -73,11 +74,12 @@ void snap_surface_points_from_generator_sdf(
 	ZN_ASSERT_RETURN(sample_count >= GEN_SDF_SAMPLE_COUNT_MIN);
 	ZN_ASSERT_RETURN_MSG(sample_count <= GEN_SDF_SAMPLE_COUNT_MAX, "Sample count is too high");
 
-	// TODO Candidates for temp allocator
-	StdVector<float> x_buffer;
-	StdVector<float> y_buffer;
-	StdVector<float> z_buffer;
-	StdVector<float> sd_buffer;
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+	StdTempVector<float> x_buffer(temp_allocator);
+	StdTempVector<float> y_buffer(temp_allocator);
+	StdTempVector<float> z_buffer(temp_allocator);
+	StdTempVector<float> sd_buffer(temp_allocator);
 
 	const Vector3f positions_origin_f = to_vec3f(positions_origin);
 
@@ -302,43 +304,93 @@ inline bool triangle_contains_enough_material_interpolated(
 	return false;
 }
 
+// Instance candidates of a block, stored as a structure of arrays. Each filtering stage is a loop over contiguous
+// data telling which candidates to keep, after which all rejected candidates are removed in one go.
+struct InstanceCandidates {
+	StdTempVector<Vector3f> positions;
+	StdTempVector<Vector3f> normals;
+	// In vertex emission mode, index in the mesh vertex array.
+	// In other modes, index of the first triangle index in the mesh's index array.
+	// Only filled if needed.
+	StdTempVector<uint32_t> indices;
+	// Barycentric coordinates that were used to position candidates in triangles, 3 per candidate.
+	// Not used in vertex emission mode. Only filled if needed.
+	StdTempVector<float> barycentrics;
+	// Only filled if noise is used.
+	StdTempVector<float> noise;
+	// Up direction at each candidate, only filled in sphere up mode.
+	StdTempVector<Vector3f> ups;
+
+	InstanceCandidates(LinearAllocator &allocator) :
+			positions(allocator),
+			normals(allocator),
+			indices(allocator),
+			barycentrics(allocator),
+			noise(allocator),
+			ups(allocator) {}
+
+	inline unsigned int size() const {
+		return positions.size();
+	}
+
+	// Removes candidates for which `keep` is zero, preserving the order of the others.
+	// Arrays that are not filled are left untouched.
+	void compact(Span<const uint8_t> keep) {
+		ZN_PROFILE_SCOPE();
+		ZN_ASSERT(keep.size() == size());
+		compact_array(positions, keep, 1);
+		compact_array(normals, keep, 1);
+		compact_array(indices, keep, 1);
+		compact_array(barycentrics, keep, 3);
+		compact_array(noise, keep, 1);
+		compact_array(ups, keep, 1);
+	}
+
+private:
+	template <typename T>
+	static void compact_array(StdTempVector<T> &array, Span<const uint8_t> keep, const unsigned int stride) {
+		if (array.size() == 0) {
+			return;
+		}
+		ZN_ASSERT(array.size() == keep.size() * stride);
+		unsigned int dst = 0;
+		for (unsigned int src = 0; src < keep.size(); ++src) {
+			if (keep[src] != 0) {
+				for (unsigned int i = 0; i < stride; ++i) {
+					array[dst * stride + i] = array[src * stride + i];
+				}
+				++dst;
+			}
+		}
+		// Shrinking doesn't allocate
+		array.resize(dst * stride);
+	}
+};
+
 // Filter out by voxel materials
 // Assuming 4x8-bit weights and 4x8-bit indices as used in VoxelMesherTransvoxel for now, but might have other
 // formats in the future
 void filter_instances_by_voxel_materials(
-		StdVector<Vector3f> &instance_positions,
-		StdVector<Vector3f> &instance_normals,
-		// Barycentric coordinates that were used to position the instance in the triangle.
-		// Not used in vertex emission mode.
-		StdVector<float> &instance_barycentrics,
-		// In vertex emission mode, index in the mesh vertex array.
-		// In other modes, index of the first triangle index in the mesh's index array.
-		StdVector<uint32_t> &instance_indices,
-
+		const InstanceCandidates &candidates,
 		Span<const int32_t> mesh_indices,
 		Span<const TexAttrib> mesh_tex_attrib_array,
 		const float weight_threshold,
 		const uint32_t material_mask,
-		const VoxelInstanceGenerator::EmitMode emit_mode
+		const VoxelInstanceGenerator::EmitMode emit_mode,
+		Span<uint8_t> out_keep
 ) {
 	ZN_PROFILE_SCOPE();
+	ZN_ASSERT(candidates.indices.size() == out_keep.size());
 
 	switch (emit_mode) {
 		case VoxelInstanceGenerator::EMIT_FROM_VERTICES: {
 			const unsigned int weight_threshold_i =
 					math::clamp(static_cast<unsigned int>(weight_threshold * 255.f), 0u, 255u);
 			// Indices are vertices
-			for (unsigned int instance_index = 0; instance_index < instance_positions.size();) {
-				const unsigned int vi = instance_indices[instance_index];
+			for (unsigned int instance_index = 0; instance_index < out_keep.size(); ++instance_index) {
+				const unsigned int vi = candidates.indices[instance_index];
 				const TexAttrib attrib = mesh_tex_attrib_array[vi];
-				if (vertex_contains_enough_material(attrib, weight_threshold_i, material_mask)) {
-					instance_index += 1;
-				} else {
-					// Remove instance
-					unordered_remove(instance_positions, instance_index);
-					unordered_remove(instance_normals, instance_index);
-					unordered_remove(instance_indices, instance_index);
-				}
+				out_keep[instance_index] = vertex_contains_enough_material(attrib, weight_threshold_i, material_mask);
 			}
 		} break;
 
@@ -346,40 +398,30 @@ void filter_instances_by_voxel_materials(
 		case VoxelInstanceGenerator::EMIT_FROM_FACES_FAST:
 		case VoxelInstanceGenerator::EMIT_ONE_PER_TRIANGLE: {
 #ifdef DEV_ENABLED
-			ZN_ASSERT(instance_barycentrics.size() / 3 == instance_positions.size());
+			ZN_ASSERT(candidates.barycentrics.size() / 3 == out_keep.size());
 #endif
 
 			// Indices are the index in the index buffer of the first vertex of the triangle in which the instance
 			// was spawned in
-			const Span<const float> barycentrics_s = to_span(instance_barycentrics);
-			for (unsigned int instance_index = 0; instance_index < instance_positions.size();) {
-				const uint32_t ii0 = instance_indices[instance_index];
-				// if (L::triangle_contains_enough_material_rough(
-				if (triangle_contains_enough_material_interpolated(
-							mesh_tex_attrib_array,
-							mesh_indices,
-							barycentrics_s,
-							instance_index,
-							ii0,
-							weight_threshold,
-							material_mask
-					)) {
-					instance_index += 1;
-				} else {
-					// Remove instance
-					unordered_remove(instance_positions, instance_index);
-					unordered_remove(instance_normals, instance_index);
-					unordered_remove(instance_indices, instance_index);
-
-					unordered_remove(instance_barycentrics, instance_index * 3 + 2);
-					unordered_remove(instance_barycentrics, instance_index * 3 + 1);
-					unordered_remove(instance_barycentrics, instance_index * 3 + 0);
-				}
+			const Span<const float> barycentrics_s = to_span(candidates.barycentrics);
+			for (unsigned int instance_index = 0; instance_index < out_keep.size(); ++instance_index) {
+				const uint32_t ii0 = candidates.indices[instance_index];
+				// out_keep[instance_index] = L::triangle_contains_enough_material_rough(
+				out_keep[instance_index] = triangle_contains_enough_material_interpolated(
+						mesh_tex_attrib_array,
+						mesh_indices,
+						barycentrics_s,
+						instance_index,
+						ii0,
+						weight_threshold,
+						material_mask
+				);
 			}
 		} break;
 
 		default:
 			ZN_PRINT_ERROR_ONCE("Unhandled emit mode");
+			out_keep.fill(1);
 			break;
 	}
 }
@@ -391,9 +433,9 @@ void generate_random_points_from_vertices(
 		// The mesh vertices are assumed to be within (0,0,0) and (block_size, block_size, block_size)
 		const float block_size,
 		RandomPCG &pcg,
-		StdVector<Vector3f> &out_positions,
-		StdVector<Vector3f> &out_normals,
-		StdVector<uint32_t> *out_indices
+		StdTempVector<Vector3f> &out_positions,
+		StdTempVector<Vector3f> &out_normals,
+		StdTempVector<uint32_t> *out_indices
 ) {
 	// Density is interpreted differently here,
 	// so it's possible a different emit mode will produce different amounts of instances.
@@ -431,10 +473,10 @@ void generate_random_points_from_triangles_fast(
 		const float density,
 		RandomPCG &pcg0,
 		RandomPCG &pcg1,
-		StdVector<Vector3f> &out_positions,
-		StdVector<Vector3f> &out_normals,
-		StdVector<uint32_t> *out_indices,
-		StdVector<float> *out_barycentrics
+		StdTempVector<Vector3f> &out_positions,
+		StdTempVector<Vector3f> &out_normals,
+		StdTempVector<uint32_t> *out_indices,
+		StdTempVector<float> *out_barycentrics
 ) {
 	const int triangle_count = mesh_indices.size() / 3;
 
@@ -497,10 +539,10 @@ void generate_random_points_from_triangles(
 		const float density,
 		const float triangle_area_threshold,
 		RandomPCG &pcg,
-		StdVector<Vector3f> &out_positions,
-		StdVector<Vector3f> &out_normals,
-		StdVector<uint32_t> *out_indices,
-		StdVector<float> *out_barycentrics
+		StdTempVector<Vector3f> &out_positions,
+		StdTempVector<Vector3f> &out_normals,
+		StdTempVector<uint32_t> *out_indices,
+		StdTempVector<float> *out_barycentrics
 ) {
 	// PackedInt32Array::Read indices_r = indices.read();
 
@@ -584,10 +626,10 @@ void generate_one_random_point_per_triangle(
 		const float triangle_area_threshold,
 		const float jitter,
 		RandomPCG &pcg,
-		StdVector<Vector3f> &out_positions,
-		StdVector<Vector3f> &out_normals,
-		StdVector<uint32_t> *out_indices,
-		StdVector<float> *out_barycentrics
+		StdTempVector<Vector3f> &out_positions,
+		StdTempVector<Vector3f> &out_normals,
+		StdTempVector<uint32_t> *out_indices,
+		StdTempVector<float> *out_barycentrics
 ) {
 	const int triangle_count = mesh_indices.size() / 3;
 	const float one_third = 1.f / 3.f;
@@ -663,14 +705,15 @@ void generate_one_random_point_per_triangle(
 }
 
 void generate_noise_at_positions_with_graph(
-		StdVector<Vector3f> &instance_positions,
+		Span<const Vector3f> instance_positions,
 		const Vector3 mesh_block_origin_d,
 		// TODO Should be const, investigate if it can be fixed
 		pg::VoxelGraphFunction &noise_graph,
 		const VoxelInstanceGenerator::Dimension noise_dimension,
-		StdVector<float> &out_noise
+		Span<float> out_noise
 ) {
-	out_noise.resize(instance_positions.size());
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT(out_noise.size() == instance_positions.size());
 
 	// Check noise graph validity
 	std::shared_ptr<pg::VoxelGraphFunction::CompiledGraph> compiled_graph = noise_graph.get_compiled_graph();
@@ -701,20 +744,17 @@ void generate_noise_at_positions_with_graph(
 	}
 
 	if (compiled_graph != nullptr) {
-		// Execute graph
-
-		// TODO Candidates for temp allocator
-		static thread_local StdVector<float> g_noise_graph_x_cache;
-		static thread_local StdVector<float> g_noise_graph_y_cache;
-		static thread_local StdVector<float> g_noise_graph_z_cache;
+		// Execute graph on all positions at once
 
-		StdVector<float> &x_buffer = g_noise_graph_x_cache;
-		StdVector<float> &z_buffer = g_noise_graph_z_cache;
+		LinearAllocator &temp_allocator = get_tls_temp_allocator();
+		LinearAllocatorScope temp_scope(temp_allocator);
+		StdTempVector<float> x_buffer(temp_allocator);
+		StdTempVector<float> z_buffer(temp_allocator);
 		x_buffer.resize(instance_positions.size());
 		z_buffer.resize(instance_positions.size());
 
 		FixedArray<Span<float>, 1> outputs;
-		outputs[0] = to_span(out_noise);
+		outputs[0] = out_noise;
 
 		switch (noise_dimension) {
 			case VoxelInstanceGenerator::DIMENSION_2D: {
@@ -732,7 +772,7 @@ void generate_noise_at_positions_with_graph(
 			} break;
 
 			case VoxelInstanceGenerator::DIMENSION_3D: {
-				StdVector<float> &y_buffer = g_noise_graph_y_cache;
+				StdTempVector<float> y_buffer(temp_allocator);
 				y_buffer.resize(instance_positions.size());
 
 				for (size_t i = 0; i < instance_positions.size(); ++i) {
@@ -756,9 +796,7 @@ void generate_noise_at_positions_with_graph(
 
 	} else {
 		// Error fallback
-		for (float &v : out_noise) {
-			v = 0.f;
-		}
+		out_noise.fill(0.f);
 	}
 }
 
@@ -829,32 +867,16 @@ MeshData parse_arrays(
 }
 
 void filter_instances_by_octant(
-		StdVector<Vector3f> &instance_positions,
-		StdVector<Vector3f> &instance_normals,
-		StdVector<uint32_t> *instance_indices,
-		StdVector<float> *instance_barycentrics,
+		Span<const Vector3f> instance_positions,
 		const float block_size,
-		const uint8_t octant_mask
+		const uint8_t octant_mask,
+		Span<uint8_t> out_keep
 ) {
 	ZN_PROFILE_SCOPE();
 	const float h = block_size / 2.f;
-	for (unsigned int i = 0; i < instance_positions.size();) {
-		const Vector3f &pos = instance_positions[i];
-		const uint8_t octant_index = VoxelInstanceGenerator::get_octant_index(pos, h);
-		if ((octant_mask & (1 << octant_index)) == 0) {
-			unordered_remove(instance_positions, i);
-			unordered_remove(instance_normals, i);
-			if (instance_indices != nullptr) {
-				unordered_remove(*instance_indices, i);
-			}
-			if (instance_barycentrics != nullptr) {
-				unordered_remove(*instance_barycentrics, i * 3 + 2);
-				unordered_remove(*instance_barycentrics, i * 3 + 1);
-				unordered_remove(*instance_barycentrics, i * 3 + 0);
-			}
-		} else {
-			++i;
-		}
+	for (unsigned int i = 0; i < instance_positions.size(); ++i) {
+		const uint8_t octant_index = VoxelInstanceGenerator::get_octant_index(instance_positions[i], h);
+		out_keep[i] = (octant_mask & (1 << octant_index)) != 0;
 	}
 }
 
@@ -982,7 +1004,7 @@ void VoxelInstanceGenerator::generate_transforms(
 
 	const uint32_t block_pos_hash = Vector3iHasher::hash(grid_position);
 
-	Vector3f global_up(0.f, 1.f, 0.f);
+	const Vector3f global_up(0.f, 1.f, 0.f);
 
 	// Using different number generators so changing parameters affecting one doesn't affect the other
 	const uint64_t seed = block_pos_hash + layer_id;
@@ -993,30 +1015,10 @@ void VoxelInstanceGenerator::generate_transforms(
 
 	out_transforms.clear();
 
-	// TODO Candidates for temp allocator
-	static thread_local StdVector<Vector3f> g_vertex_cache;
-	static thread_local StdVector<Vector3f> g_normal_cache;
-	static thread_local StdVector<uint32_t> g_index_cache;
-	static thread_local StdVector<float> g_noise_cache;
-	// static thread_local StdVector<float> g_noise_graph_output_cache;
-
-	static thread_local StdVector<float> g_barycentrics_cache;
-
-	StdVector<Vector3f> &vertex_cache = g_vertex_cache;
-	StdVector<Vector3f> &normal_cache = g_normal_cache;
-	StdVector<uint32_t> &index_cache = g_index_cache;
-
-	StdVector<float> &barycentrics = g_barycentrics_cache;
-
-	vertex_cache.clear();
-	normal_cache.clear();
-	index_cache.clear();
-	barycentrics.clear();
-
 	const bool voxel_material_filter_enabled = _voxel_material_filter_enabled;
 	const uint32_t voxel_material_filter_mask = _voxel_material_filter_mask;
 
-	const bool index_cache_used = voxel_material_filter_enabled;
+	const bool indices_used = voxel_material_filter_enabled;
 	const bool barycentrics_used = voxel_material_filter_enabled && _emit_mode != EMIT_FROM_VERTICES;
 
 	// Do an early check to see if there is any material that we can potentially find
@@ -1035,6 +1037,14 @@ void VoxelInstanceGenerator::generate_transforms(
 		}
 	}
 
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	LinearAllocatorScope temp_scope(temp_allocator);
+
+	// Candidates go through a pipeline of stages, each working on all of them before the next one starts. Rejected
+	// candidates are removed after each filter, so later stages, which tend to be more expensive, only process
+	// survivors.
+	InstanceCandidates candidates(temp_allocator);
+
 	// Pick random points
 	// Generate base positions
 	switch (_emit_mode) {
@@ -1045,9 +1055,9 @@ void VoxelInstanceGenerator::generate_transforms(
 					_density,
 					block_size,
 					pcg0,
-					vertex_cache,
-					normal_cache,
-					index_cache_used ? &index_cache : nullptr
+					candidates.positions,
+					candidates.normals,
+					indices_used ? &candidates.indices : nullptr
 			);
 			break;
 
@@ -1059,10 +1069,10 @@ void VoxelInstanceGenerator::generate_transforms(
 					_density,
 					pcg0,
 					pcg1,
-					vertex_cache,
-					normal_cache,
-					index_cache_used ? &index_cache : nullptr,
-					barycentrics_used ? &barycentrics : nullptr
+					candidates.positions,
+					candidates.normals,
+					indices_used ? &candidates.indices : nullptr,
+					barycentrics_used ? &candidates.barycentrics : nullptr
 			);
 			break;
 
@@ -1074,10 +1084,10 @@ void VoxelInstanceGenerator::generate_transforms(
 					_density,
 					math::squared(1 << lod_index) * _triangle_area_threshold_lod0,
 					pcg1,
-					vertex_cache,
-					normal_cache,
-					index_cache_used ? &index_cache : nullptr,
-					barycentrics_used ? &barycentrics : nullptr
+					candidates.positions,
+					candidates.normals,
+					indices_used ? &candidates.indices : nullptr,
+					barycentrics_used ? &candidates.barycentrics : nullptr
 			);
 			break;
 
@@ -1090,10 +1100,10 @@ void VoxelInstanceGenerator::generate_transforms(
 					math::squared(1 << lod_index) * _triangle_area_threshold_lod0,
 					_jitter,
 					pcg1,
-					vertex_cache,
-					normal_cache,
-					index_cache_used ? &index_cache : nullptr,
-					barycentrics_used ? &barycentrics : nullptr
+					candidates.positions,
+					candidates.normals,
+					indices_used ? &candidates.indices : nullptr,
+					barycentrics_used ? &candidates.barycentrics : nullptr
 			);
 			break;
 
@@ -1103,40 +1113,46 @@ void VoxelInstanceGenerator::generate_transforms(
 
 #ifdef DEV_ENABLED
 	if (barycentrics_used) {
-		ZN_ASSERT((barycentrics.size() % 3) == 0);
-		ZN_ASSERT(barycentrics.size() / 3 == vertex_cache.size());
+		ZN_ASSERT((candidates.barycentrics.size() % 3) == 0);
+		ZN_ASSERT(candidates.barycentrics.size() / 3 == candidates.size());
 	}
 #endif
 
+	if (candidates.size() == 0) {
+		return;
+	}
+
+	// Allocated after candidates so they don't grow while other temporary arrays exist.
+	// Filters only shrink the set of candidates, so this is large enough for all of them.
+	StdTempVector<uint8_t> keep(temp_allocator);
+	keep.reserve(candidates.size());
+
 	// Filter out by octants
 	// This is done so some octants can be filled with user-edited data instead,
 	// because mesh size may not necessarily match data block size
 	if ((octant_mask & 0xff) != 0xff) {
-		filter_instances_by_octant(
-				vertex_cache,
-				normal_cache,
-				index_cache_used ? &index_cache : nullptr,
-				barycentrics_used ? &barycentrics : nullptr,
-				block_size,
-				octant_mask
-		);
+		keep.resize(candidates.size());
+		filter_instances_by_octant(to_span(candidates.positions), block_size, octant_mask, to_span(keep));
+		candidates.compact(to_span(keep));
 	}
 
 	if (voxel_material_filter_enabled) {
+		keep.resize(candidates.size());
 		filter_instances_by_voxel_materials(
-				vertex_cache,
-				normal_cache,
-				barycentrics,
-				index_cache,
+				candidates,
 				mesh.indices,
 				mesh.texture_data,
 				_voxel_material_filter_threshold,
 				_voxel_material_filter_mask,
-				_emit_mode
+				_emit_mode,
+				to_span(keep)
 		);
+		candidates.compact(to_span(keep));
 
-		// Index cache has no use yet after this. To detect future mistakes if any, make it obvious by clearing it
-		index_cache.clear();
+		// Indices and barycentrics have no use yet after this. To detect future mistakes if any, make it obvious by
+		// clearing them. It also saves compacting them in later stages.
+		candidates.indices.clear();
+		candidates.barycentrics.clear();
 	}
 
 	// Position of the block relative to the instancer node.
@@ -1153,48 +1169,56 @@ void VoxelInstanceGenerator::generate_transforms(
 		noise_graph = _noise_graph;
 	}
 
-	StdVector<float> &noise_cache = g_noise_cache;
+	const bool use_noise = noise.is_valid() || noise_graph.is_valid();
+
+	if (use_noise) {
+		// Sized before running the graph, which can use temporary memory too
+		candidates.noise.resize(candidates.size());
+	}
+
+	const Span<const Vector3f> positions = to_span(candidates.positions);
+	Span<float> noise_values = to_span(candidates.noise);
 
 	// Filter out by noise graph
 	if (noise_graph.is_valid()) {
 		generate_noise_at_positions_with_graph(
-				vertex_cache, mesh_block_origin_d, **noise_graph, _noise_dimension, noise_cache
+				positions, mesh_block_origin_d, **noise_graph, _noise_dimension, noise_values
 		);
 	}
 
 	// Legacy noise (noise graph is more versatile, but this remains for compatibility)
 	if (noise.is_valid()) {
-		noise_cache.resize(vertex_cache.size());
+		ZN_PROFILE_SCOPE_NAMED("Noise");
 
 		switch (_noise_dimension) {
 			case DIMENSION_2D: {
 				if (noise_graph.is_valid()) {
 					// Multiply output of noise graph
-					for (size_t i = 0; i < vertex_cache.size(); ++i) {
-						const Vector3 &pos = to_vec3(vertex_cache[i]) + mesh_block_origin_d;
+					for (size_t i = 0; i < positions.size(); ++i) {
+						const Vector3 &pos = to_vec3(positions[i]) + mesh_block_origin_d;
 						// Casting to float because Noise returns `real_t`, which is `double` in 64-bit float builds,
 						// but we don't need doubles for noise in this context...
-						noise_cache[i] *= math::max(float(noise->get_noise_2d(pos.x, pos.z)), 0.f);
+						noise_values[i] *= math::max(float(noise->get_noise_2d(pos.x, pos.z)), 0.f);
 					}
 				} else {
 					// Use noise directly
-					for (size_t i = 0; i < vertex_cache.size(); ++i) {
-						const Vector3 &pos = to_vec3(vertex_cache[i]) + mesh_block_origin_d;
-						noise_cache[i] = noise->get_noise_2d(pos.x, pos.z);
+					for (size_t i = 0; i < positions.size(); ++i) {
+						const Vector3 &pos = to_vec3(positions[i]) + mesh_block_origin_d;
+						noise_values[i] = noise->get_noise_2d(pos.x, pos.z);
 					}
 				}
 			} break;
 
 			case DIMENSION_3D: {
 				if (noise_graph.is_valid()) {
-					for (size_t i = 0; i < vertex_cache.size(); ++i) {
-						const Vector3 &pos = to_vec3(vertex_cache[i]) + mesh_block_origin_d;
-						noise_cache[i] *= math::max(float(noise->get_noise_3d(pos.x, pos.y, pos.z)), 0.f);
+					for (size_t i = 0; i < positions.size(); ++i) {
+						const Vector3 &pos = to_vec3(positions[i]) + mesh_block_origin_d;
+						noise_values[i] *= math::max(float(noise->get_noise_3d(pos.x, pos.y, pos.z)), 0.f);
 					}
 				} else {
-					for (size_t i = 0; i < vertex_cache.size(); ++i) {
-						const Vector3 &pos = to_vec3(vertex_cache[i]) + mesh_block_origin_d;
-						noise_cache[i] = noise->get_noise_3d(pos.x, pos.y, pos.z);
+					for (size_t i = 0; i < positions.size(); ++i) {
+						const Vector3 &pos = to_vec3(positions[i]) + mesh_block_origin_d;
+						noise_values[i] = noise->get_noise_3d(pos.x, pos.y, pos.z);
 					}
 				}
 			} break;
@@ -1204,8 +1228,6 @@ void VoxelInstanceGenerator::generate_transforms(
 		}
 	}
 
-	const bool use_noise = noise.is_valid() || noise_graph.is_valid();
-
 	// Filter out by noise
 	if (use_noise) {
 		ZN_PROFILE_SCOPE_NAMED("Noise filter");
@@ -1214,44 +1236,30 @@ void VoxelInstanceGenerator::generate_transforms(
 
 		const float threshold = _noise_threshold;
 		if (threshold != 0.f) {
-			for (float &n : noise_cache) {
+			for (float &n : noise_values) {
 				n += threshold;
 			}
 		}
 
+		keep.resize(candidates.size());
+
 		if (falloff <= 0.f) {
-			for (size_t i = 0; i < vertex_cache.size();) {
-				const float n = noise_cache[i];
-				if (n <= 0.f) {
-					unordered_remove(vertex_cache, i);
-					unordered_remove(normal_cache, i);
-					unordered_remove(noise_cache, i);
-					// We don't use the index cache after this... for now
-					// if (index_cache_used) {
-					// 	unordered_remove(index_cache, i);
-					// }
-				} else {
-					++i;
-				}
+			for (unsigned int i = 0; i < noise_values.size(); ++i) {
+				keep[i] = noise_values[i] > 0.f;
 			}
 		} else {
-			for (size_t i = 0; i < vertex_cache.size();) {
-				const float n = noise_cache[i];
+			for (unsigned int i = 0; i < noise_values.size(); ++i) {
 				const float r = pcg1.randf();
-				const float d = n / falloff;
-				if (d < 0.f || r > d * d) {
-					unordered_remove(vertex_cache, i);
-					unordered_remove(normal_cache, i);
-					unordered_remove(noise_cache, i);
-					// We don't use the index cache after this... for now
-					// if (index_cache_used) {
-					// 	unordered_remove(index_cache, i);
-					// }
-				} else {
-					++i;
-				}
+				const float d = noise_values[i] / falloff;
+				keep[i] = !(d < 0.f || r > d * d);
 			}
 		}
+
+		candidates.compact(to_span(keep));
+	}
+
+	if (candidates.size() == 0) {
+		return;
 	}
 
 	// snap from generator SDF
@@ -1260,8 +1268,8 @@ void VoxelInstanceGenerator::generate_transforms(
 		const Vector3f max_pos = min_pos + Vector3f(block_size);
 
 		snap_surface_points_from_generator_sdf(
-				to_span(vertex_cache),
-				to_span(normal_cache),
+				to_span(candidates.positions),
+				to_span(candidates.normals),
 				mesh_block_origin_d,
 				**voxel_generator,
 				_gen_sdf_snap_settings.search_distance,
@@ -1271,95 +1279,108 @@ void VoxelInstanceGenerator::generate_transforms(
 		);
 	}
 
-	const float vertical_alignment = _vertical_alignment;
-	const float scale_min = _min_scale;
-	const float scale_range = _max_scale - _min_scale;
-	const bool random_vertical_flip = _random_vertical_flip;
-	const float offset_along_normal = _offset_along_normal;
+	const Vector3f mesh_block_origin = to_vec3f(grid_position * block_size);
+
+	{
+		ZN_PROFILE_SCOPE_NAMED("Normals");
+
+		// Warning: sometimes mesh normals are not perfectly normalized.
+		// The cause is for meshing speed on CPU. It's normalized on GPU anyways.
+		for (Vector3f &normal : candidates.normals) {
+			normal = math::normalized(normal);
+		}
+
+		if (up_mode == UP_MODE_SPHERE) {
+			candidates.ups.resize(candidates.size());
+			for (unsigned int i = 0; i < candidates.size(); ++i) {
+				candidates.ups[i] = math::normalized(mesh_block_origin + candidates.positions[i]);
+			}
+		}
+	}
 
 	const bool slope_filter_active = _min_slope_degrees != 0.f || _max_slope_degrees != 180.f;
-	const AngularFalloffRange slope_filter(
-			_min_slope_degrees, _max_slope_degrees, _min_slope_falloff_degrees, _max_slope_falloff_degrees
-	);
+	if (slope_filter_active) {
+		ZN_PROFILE_SCOPE_NAMED("Slope filter");
+
+		const AngularFalloffRange slope_filter(
+				_min_slope_degrees, _max_slope_degrees, _min_slope_falloff_degrees, _max_slope_falloff_degrees
+		);
+
+		keep.resize(candidates.size());
+
+		// If the normal points straight up, it will be 1, and angle is considered to be 0. Then angle increases as
+		// ground gets sloped or goes upside down, up to 180 degrees
+		if (up_mode == UP_MODE_SPHERE) {
+			for (unsigned int i = 0; i < candidates.size(); ++i) {
+				const float ny = math::dot(candidates.normals[i], candidates.ups[i]);
+				keep[i] = !slope_filter.should_discard_cosine(ny, pcg1);
+			}
+		} else {
+			for (unsigned int i = 0; i < candidates.size(); ++i) {
+				keep[i] = !slope_filter.should_discard_cosine(candidates.normals[i].y, pcg1);
+			}
+		}
+
+		candidates.compact(to_span(keep));
+	}
 
 	const bool height_filter_active =
 			_min_height != std::numeric_limits<float>::min() || _max_height != std::numeric_limits<float>::max();
-	const LinearFalloffRange height_filter(_min_height, _max_height, _min_height_falloff, _max_height_falloff);
+	if (height_filter_active) {
+		ZN_PROFILE_SCOPE_NAMED("Height filter");
+
+		const LinearFalloffRange height_filter(_min_height, _max_height, _min_height_falloff, _max_height_falloff);
+
+		keep.resize(candidates.size());
+
+		if (up_mode == UP_MODE_SPHERE) {
+			for (unsigned int i = 0; i < candidates.size(); ++i) {
+				const float distance = math::length(mesh_block_origin + candidates.positions[i]);
+				keep[i] = !height_filter.should_discard(distance, pcg1);
+			}
+		} else {
+			for (unsigned int i = 0; i < candidates.size(); ++i) {
+				const float y = mesh_block_origin.y + candidates.positions[i].y;
+				keep[i] = !height_filter.should_discard(y, pcg1);
+			}
+		}
+
+		candidates.compact(to_span(keep));
+	}
+
+	ZN_PROFILE_SCOPE_NAMED("Transforms");
+
+	const float vertical_alignment = _vertical_alignment;
+	const float scale_min = _min_scale;
+	const float scale_range = _max_scale - _min_scale;
+	const bool random_vertical_flip = _random_vertical_flip;
+	const float offset_along_normal = _offset_along_normal;
 
 	const Vector3f fixed_look_axis = up_mode == UP_MODE_POSITIVE_Y ? Vector3f(1, 0, 0) : Vector3f(0, 1, 0);
 	const Vector3f fixed_look_axis_alternative = up_mode == UP_MODE_POSITIVE_Y ? Vector3f(0, 1, 0) : Vector3f(1, 0, 0);
-	const Vector3f mesh_block_origin = to_vec3f(grid_position * block_size);
+
+	out_transforms.reserve(candidates.size());
 
 	// Calculate orientations and scales
-	for (size_t vertex_index = 0; vertex_index < vertex_cache.size(); ++vertex_index) {
+	for (unsigned int candidate_index = 0; candidate_index < candidates.size(); ++candidate_index) {
 		Transform3f t;
-		t.origin = vertex_cache[vertex_index];
+		t.origin = candidates.positions[candidate_index];
 
-		// Warning: sometimes mesh normals are not perfectly normalized.
-		// The cause is for meshing speed on CPU. It's normalized on GPU anyways.
-		Vector3f surface_normal = normal_cache[vertex_index];
+		const Vector3f surface_normal = candidates.normals[candidate_index];
 
 		Vector3f axis_y;
 
-		bool surface_normal_is_normalized = false;
-		bool sphere_up_is_computed = false;
-		bool sphere_distance_is_computed = false;
-		float sphere_distance;
-
 		if (vertical_alignment == 0.f) {
-			surface_normal = math::normalized(surface_normal);
-			surface_normal_is_normalized = true;
 			axis_y = surface_normal;
 
 		} else {
-			if (up_mode == UP_MODE_SPHERE) {
-				global_up = math::normalized(mesh_block_origin + t.origin, sphere_distance);
-				sphere_up_is_computed = true;
-				sphere_distance_is_computed = true;
-			}
+			const Vector3f up = up_mode == UP_MODE_SPHERE ? candidates.ups[candidate_index] : global_up;
 
 			if (vertical_alignment < 1.f) {
-				axis_y = math::normalized(math::lerp(surface_normal, global_up, vertical_alignment));
+				axis_y = math::normalized(math::lerp(surface_normal, up, vertical_alignment));
 
 			} else {
-				axis_y = global_up;
-			}
-		}
-
-		if (slope_filter_active) {
-			if (!surface_normal_is_normalized) {
-				surface_normal = math::normalized(surface_normal);
-			}
-
-			// If the normal points straight up, it will be 1, and angle is considered to be 0. Then angle increases as
-			// ground gets sloped or goes upside down, up to 180 degrees
-			float ny = surface_normal.y;
-			if (up_mode == UP_MODE_SPHERE) {
-				if (!sphere_up_is_computed) {
-					global_up = math::normalized(mesh_block_origin + t.origin, sphere_distance);
-					sphere_up_is_computed = true;
-					sphere_distance_is_computed = true;
-				}
-				ny = math::dot(surface_normal, global_up);
-			}
-
-			if (slope_filter.should_discard_cosine(ny, pcg1)) {
-				continue;
-			}
-		}
-
-		if (height_filter_active) {
-			float y = mesh_block_origin.y + t.origin.y;
-			if (up_mode == UP_MODE_SPHERE) {
-				if (!sphere_distance_is_computed) {
-					sphere_distance = math::length(mesh_block_origin + t.origin);
-					sphere_distance_is_computed = true;
-				}
-				y = sphere_distance;
-			}
-
-			if (height_filter.should_discard(y, pcg1)) {
-				continue;
+				axis_y = up;
 			}
 		}
 
@@ -1419,10 +1440,10 @@ void VoxelInstanceGenerator::generate_transforms(
 
 			if (use_noise && _noise_on_scale > 0.f) {
 #ifdef DEBUG_ENABLED
-				CRASH_COND(vertex_index >= noise_cache.size());
+				CRASH_COND(candidate_index >= candidates.noise.size());
 #endif
 				// Multiplied noise because it gives more pronounced results
-				const float n = math::clamp(noise_cache[vertex_index] * 2.f, 0.f, 1.f);
+				const float n = math::clamp(candidates.noise[candidate_index] * 2.f, 0.f, 1.f);
 				r *= Math::lerp(1.f, n, _noise_on_scale);
 			}
 
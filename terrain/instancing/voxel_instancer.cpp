@@ -18,6 +18,7 @@
 #include "../../util/godot/core/array.h"
 #include "../../util/godot/core/basis.h"
 #include "../../util/math/conv.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 #include "../../util/string/format.h"
 #include "../fixed_lod/voxel_terrain.h"
@@ -1448,8 +1449,10 @@ void VoxelInstancer::remove_instances_in_sphere(const Vector3 p_center, const fl
 			StdVector<Vector3f> instance_positions;
 			get_instance_positions_local(block, base_block_size, instance_positions, nullptr);
 
-			// TODO Candidate for temp allocator
-			StdVector<uint32_t> instances_to_remove;
+			LinearAllocator &temp_allocator = get_tls_temp_allocator();
+			LinearAllocatorScope temp_scope(temp_allocator);
+			StdTempVector<uint32_t> instances_to_remove(temp_allocator);
+			instances_to_remove.reserve(instance_positions.size());
 			unsigned int instance_index = 0;
 			for (const Vector3f &instance_pos : instance_positions) {
 				const float ds = math::distance_squared(instance_pos, center_local);
@@ -2792,8 +2795,10 @@ void VoxelInstancer::remove_floating_instances(const Box3i voxel_box) {
 					to_vec3f(_voxel_box.position - block_origin_i + _voxel_box.size)
 			);
 
-			// TODO Candidate for temp allocator
-			StdVector<uint32_t> instances_to_remove;
+			LinearAllocator &temp_allocator = get_tls_temp_allocator();
+			LinearAllocatorScope temp_scope(temp_allocator);
+			StdTempVector<uint32_t> instances_to_remove(temp_allocator);
+			instances_to_remove.reserve(instance_positions.size());
 			for (unsigned int instance_index = 0; instance_index < instance_positions.size(); ++instance_index) {
 				const Vector3f instance_pos = instance_positions[instance_index];
 				if (!box_local.contains(instance_pos)) {
@@ -0,0 +1,62 @@
+#include "mesh_apply_queue.h"
+
+namespace zylann::voxel {
+
+void MeshApplyQueue::push(VoxelEngine::BlockMeshOutput &&output) {
+	ZN_ASSERT_RETURN(output.lod < _indices_per_lod.size());
+
+	StdUnorderedMap<Vector3i, uint32_t> &indices = _indices_per_lod[output.lod];
+	auto it = indices.find(output.position);
+
+	if (it != indices.end()) {
+		// A result for this block is already pending. It is outdated now, so replace it.
+		_items[it->second] = std::move(output);
+	} else {
+		indices.insert({ output.position, _items.size() });
+		_items.push_back(std::move(output));
+	}
+}
+
+void MeshApplyQueue::remove_applied(Span<uint32_t> indices) {
+	// Removing from the back first, so swapping with the last item never moves an item that has to be removed
+	std::sort(indices.data(), indices.data() + indices.size(), [](uint32_t a, uint32_t b) { //
+		return a > b;
+	});
+
+	for (const uint32_t index : indices) {
+		const VoxelEngine::BlockMeshOutput &removed = _items[index];
+		_indices_per_lod[removed.lod].erase(removed.position);
+
+		const uint32_t last_index = _items.size() - 1;
+		if (index != last_index) {
+			_items[index] = std::move(_items[last_index]);
+			const VoxelEngine::BlockMeshOutput &moved = _items[index];
+			_indices_per_lod[moved.lod][moved.position] = index;
+		}
+		_items.pop_back();
+	}
+}
+
+void MeshApplyQueue::clear() {
+	_items.clear();
+	for (StdUnorderedMap<Vector3i, uint32_t> &indices : _indices_per_lod) {
+		indices.clear();
+	}
+}
+
+float MeshApplyQueue::get_block_cost(
+		Vector3 block_center,
+		float block_radius,
+		float closest_viewer_distance_sq,
+		Vector3 camera_position,
+		Vector3 camera_forward
+) {
+	float cost = closest_viewer_distance_sq;
+	// A block can be partially visible even if its center is behind the camera
+	if (camera_forward.dot(block_center - camera_position) < -block_radius) {
+		cost *= BEHIND_CAMERA_COST_SCALE;
+	}
+	return cost;
+}
+
+} // namespace zylann::voxel
@@ -0,0 +1,131 @@
+#ifndef VOXEL_MESH_APPLY_QUEUE_H
+#define VOXEL_MESH_APPLY_QUEUE_H
+
+#include "../constants/voxel_constants.h"
+#include "../engine/voxel_engine.h"
+#include "../util/containers/fixed_array.h"
+#include "../util/containers/std_unordered_map.h"
+#include "../util/containers/std_vector.h"
+#include "../util/memory/linear_allocator.h"
+#include "../util/profiling.h"
+#include "../util/profiling_clock.h"
+#include <algorithm>
+
+namespace zylann::voxel {
+
+// Holds meshing results received from threads until a terrain applies them on the main thread.
+// Applying a result (creating mesh instances, setting materials...) is expensive, and lots of results can arrive in the
+// same frame, for example when turning quickly in dense areas. So results are applied within a time budget, most urgent
+// first, and the rest waits for the next frames.
+// Only the latest result is kept for a given block. This is for cases where creating the mesh is slower than the speed
+// at which it is generated, which would otherwise cause a buildup that never seems to stop.
+class MeshApplyQueue {
+public:
+	struct Stats {
+		// How many results were waiting when the queue was last processed
+		uint32_t pending_count = 0;
+		// How many results were applied when the queue was last processed
+		uint32_t applied_count = 0;
+		// Time spent applying results when the queue was last processed, in microseconds
+		uint32_t time_usec = 0;
+	};
+
+	// Blocks behind the camera are applied after those in front of it, as if they were this many times further away
+	static constexpr float BEHIND_CAMERA_COST_SCALE = 4.f;
+
+	// Adds a result to the queue, replacing any pending result for the same block.
+	void push(VoxelEngine::BlockMeshOutput &&output);
+
+	// Applies pending results in order of increasing cost, until the time budget is exceeded. At least one result is
+	// applied, so the queue always makes progress.
+	// `get_cost` has signature `float (const BlockMeshOutput &)`, lower is more urgent.
+	// `apply` has signature `void (BlockMeshOutput &)`. It must not push to the queue.
+	template <typename FCost, typename FApply>
+	void process(uint64_t time_budget_usec, FCost get_cost, FApply apply);
+
+	void clear();
+
+	inline unsigned int get_pending_count() const {
+		return _items.size();
+	}
+
+	inline const Stats &get_stats() const {
+		return _stats;
+	}
+
+	// Cost of a block based on its squared distance to the closest viewer. All parameters must be in the same space.
+	// `camera_forward` can be zero if there is no camera, in which case blocks are all considered visible.
+	static float get_block_cost(
+			Vector3 block_center,
+			float block_radius,
+			float closest_viewer_distance_sq,
+			Vector3 camera_position,
+			Vector3 camera_forward
+	);
+
+private:
+	// Indices get sorted in the process
+	void remove_applied(Span<uint32_t> indices);
+
+	StdVector<VoxelEngine::BlockMeshOutput> _items;
+	// Index of pending results in `_items`, per LOD
+	FixedArray<StdUnorderedMap<Vector3i, uint32_t>, constants::MAX_LOD> _indices_per_lod;
+	Stats _stats;
+};
+
+template <typename FCost, typename FApply>
+void MeshApplyQueue::process(uint64_t time_budget_usec, FCost get_cost, FApply apply) {
+	ZN_PROFILE_SCOPE();
+
+	_stats.pending_count = _items.size();
+	_stats.applied_count = 0;
+	_stats.time_usec = 0;
+
+	if (_items.size() == 0) {
+		return;
+	}
+
+	ProfilingClock profiling_clock;
+
+	struct Entry {
+		float cost;
+		uint32_t index;
+	};
+
+	LinearAllocator &allocator = get_tls_temp_allocator();
+	LinearAllocatorScope las(allocator);
+
+	StdTempVector<Entry> entries(allocator);
+	entries.reserve(_items.size());
+	{
+		ZN_PROFILE_SCOPE_NAMED("Sort");
+		for (uint32_t i = 0; i < _items.size(); ++i) {
+			entries.push_back(Entry{ get_cost(_items[i]), i });
+		}
+		std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { //
+			return a.cost < b.cost;
+		});
+	}
+
+	StdTempVector<uint32_t> applied_indices(allocator);
+	// Reserved upfront because applying results can use the temp allocator too
+	applied_indices.reserve(entries.size());
+
+	for (const Entry &entry : entries) {
+		apply(_items[entry.index]);
+		applied_indices.push_back(entry.index);
+
+		if (profiling_clock.get_elapsed_microseconds() >= time_budget_usec) {
+			break;
+		}
+	}
+
+	remove_applied(to_span(applied_indices));
+
+	_stats.applied_count = applied_indices.size();
+	_stats.time_usec = profiling_clock.get_elapsed_microseconds();
+}
+
+} // namespace zylann::voxel
+
+#endif // VOXEL_MESH_APPLY_QUEUE_H
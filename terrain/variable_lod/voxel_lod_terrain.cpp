@@ -24,6 +24,7 @@
 #include "../../util/godot/classes/viewport.h"
 #include "../../util/godot/core/array.h"
 #include "../../util/godot/core/string.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/math/color.h"
 #include "../../util/math/conv.h"
 #include "../../util/profiling.h"
@@ -96,27 +97,20 @@ void copy_vlt_block_params(ShaderMaterial &src, ShaderMaterial &dst) {
 
 } // namespace
 
-void VoxelLodTerrain::ApplyMeshUpdateTask::run(TimeSpreadTaskContext &ctx) {
+void VoxelLodTerrain::ApplyMeshQueueTask::run(TimeSpreadTaskContext &ctx) {
 	if (!VoxelEngine::get_singleton().is_volume_valid(volume_id)) {
 		// The node can have been destroyed while this task was still pending
-		ZN_PRINT_VERBOSE("Cancelling ApplyMeshUpdateTask, volume_id is invalid");
+		ZN_PRINT_VERBOSE("Cancelling ApplyMeshQueueTask, volume_id is invalid");
 		return;
 	}
 
-	StdUnorderedMap<Vector3i, RefCount> &queued_tasks_in_lod = self->_queued_main_thread_mesh_updates[data.lod];
-	auto it = queued_tasks_in_lod.find(data.position);
-	if (it != queued_tasks_in_lod.end()) {
-		RefCount &count = it->second;
-		count.remove();
-		if (count.get() > 0) {
-			// This is not the only main thread task queued for this block.
-			// Cancel it to avoid buildup.
-			return;
-		}
-		queued_tasks_in_lod.erase(it);
-	}
+	self->process_mesh_apply_queue();
 
-	self->apply_mesh_update(data);
+	if (self->_mesh_apply_queue.get_pending_count() > 0) {
+		ctx.postpone = true;
+	} else {
+		self->_mesh_apply_task_scheduled = false;
+	}
 }
 
 VoxelLodTerrain::VoxelLodTerrain() {
@@ -127,6 +121,7 @@ VoxelLodTerrain::VoxelLodTerrain() {
 	ZN_PRINT_VERBOSE("Construct VoxelLodTerrain");
 
 	_data = make_shared_instance<VoxelData>();
+	_data->set_task_scheduler(VoxelEngine::get_task_scheduler());
 	_update_data = make_shared_instance<VoxelLodTerrainUpdateData>();
 	_update_data->task_is_complete = true;
 	_streaming_dependency = make_shared_instance<StreamingDependency>();
@@ -140,27 +135,21 @@ VoxelLodTerrain::VoxelLodTerrain() {
 	// Infinite by default
 	_data->set_bounds(Box3i::from_center_extents(Vector3i(), Vector3iUtil::create(constants::MAX_VOLUME_EXTENT)));
 
-	// Mesh updates are spread over frames by scheduling them in a task runner of VoxelEngine,
+	// Mesh updates are spread over frames by a task processing the apply queue in a task runner of VoxelEngine,
 	// but instead of using a reception buffer we use a callback,
 	// because this kind of task scheduling would otherwise delay the update by 1 frame
 	VoxelEngine::VolumeCallbacks callbacks;
 	callbacks.data = this;
 	callbacks.mesh_output_callback = [](void *cb_data, VoxelEngine::BlockMeshOutput &ob) {
 		VoxelLodTerrain *self = reinterpret_cast<VoxelLodTerrain *>(cb_data);
-		ApplyMeshUpdateTask *task = ZN_NEW(ApplyMeshUpdateTask);
-		task->volume_id = self->get_volume_id();
-		task->self = self;
-		task->data = std::move(ob);
-		VoxelEngine::get_singleton().push_main_thread_time_spread_task(task);
-
-		// If two tasks are queued for the same mesh, cancel the old ones.
-		// This is for cases where creating the mesh is slower than the speed at which it is generated,
-		// which can cause a buildup that never seems to stop.
-		// This is at the expense of holes appearing until all tasks are done.
-		StdUnorderedMap<Vector3i, RefCount> &queued_tasks_in_lod = self->_queued_main_thread_mesh_updates[ob.lod];
-		auto p = queued_tasks_in_lod.insert({ ob.position, RefCount(1) });
-		if (!p.second) {
-			p.first->second.add();
+		self->_mesh_apply_queue.push(std::move(ob));
+
+		if (!self->_mesh_apply_task_scheduled) {
+			ApplyMeshQueueTask *task = ZN_NEW(ApplyMeshQueueTask);
+			task->volume_id = self->get_volume_id();
+			task->self = self;
+			VoxelEngine::get_singleton().push_main_thread_time_spread_task(task);
+			self->_mesh_apply_task_scheduled = true;
 		}
 	};
 	callbacks.data_output_callback = [](void *cb_data, VoxelEngine::BlockDataOutput &ob) {
@@ -880,9 +869,7 @@ void VoxelLodTerrain::_set_lod_count(int p_lod_count) {
 		item.octree.create(p_lod_count, nda);
 	}
 
-	for (unsigned int i = 0; i < _queued_main_thread_mesh_updates.size(); ++i) {
-		_queued_main_thread_mesh_updates[i].clear();
-	}
+	_mesh_apply_queue.clear();
 
 	// Not entirely required, but changing LOD count at runtime is rarely needed
 	reset_maps();
@@ -1215,6 +1202,7 @@ inline bool check_block_sizes(int data_block_size, int mesh_block_size) {
 
 void VoxelLodTerrain::process(float delta) {
 	ZN_PROFILE_SCOPE();
+	ProfilingClock profiling_clock;
 
 	_stats.dropped_block_loads = 0;
 	_stats.dropped_block_meshs = 0;
@@ -1259,8 +1247,11 @@ void VoxelLodTerrain::process(float delta) {
 	// It should only happen on first load, though.
 	// process_block_loading_responses();
 
-	// TODO This could go into time spread tasks too
-	process_deferred_collision_updates(VoxelEngine::get_singleton().get_main_thread_time_budget_usec());
+	// Colliders are amortized separately from meshes, because building them is often more expensive
+	const uint32_t collision_budget_usec = _collision_apply_budget_usec != 0
+			? _collision_apply_budget_usec
+			: VoxelEngine::get_singleton().get_main_thread_time_budget_usec();
+	process_deferred_collision_updates(collision_budget_usec);
 
 #ifdef TOOLS_ENABLED
 	if (debug_is_draw_enabled() && is_visible_in_tree()) {
@@ -1307,8 +1298,12 @@ void VoxelLodTerrain::process(float delta) {
 			VoxelEngine::get_singleton().push_async_task(task);
 
 		} else {
-			ThreadedTaskContext ctx(0, TaskPriority());
-			task->run(ctx);
+			LinearAllocator &temp_allocator = get_tls_temp_allocator();
+			ThreadedTaskContext ctx(0, TaskPriority(), temp_allocator);
+			{
+				LinearAllocatorScope temp_scope(temp_allocator);
+				task->run(ctx);
+			}
 			ZN_DELETE(task);
 			apply_main_thread_update_tasks();
 		}
@@ -1316,6 +1311,8 @@ void VoxelLodTerrain::process(float delta) {
 
 	// Do it after we change mesh block states so materials are updated
 	process_fading_blocks(delta);
+
+	VoxelEngine::get_singleton().add_main_thread_volume_time_usec(profiling_clock.get_elapsed_microseconds());
 }
 
 void VoxelLodTerrain::apply_main_thread_update_tasks() {
@@ -1832,6 +1829,54 @@ inline void set_block_collision_shape(
 	block.deferred_collider_data.reset();
 }
 
+void VoxelLodTerrain::process_mesh_apply_queue() {
+	ZN_PROFILE_SCOPE();
+
+	if (!is_inside_tree()) {
+		// Results can't be applied outside of the scene tree
+		_stats.dropped_block_meshs += _mesh_apply_queue.get_pending_count();
+		_mesh_apply_queue.clear();
+		return;
+	}
+
+	VoxelEngine &engine = VoxelEngine::get_singleton();
+	const bool use_shared_budget = _mesh_apply_budget_usec == 0;
+	const uint32_t budget_usec =
+			use_shared_budget ? engine.get_shared_mesh_apply_budget_usec() : _mesh_apply_budget_usec;
+
+	// Costs are evaluated in the local space of the terrain
+	const Vector3 viewer_pos = get_local_viewer_pos();
+	const LocalCameraInfo camera = get_local_camera_info();
+	const Transform3D world_to_local = get_global_transform().affine_inverse();
+	const Vector3 camera_pos = world_to_local.xform(camera.position);
+	const Vector3 camera_forward = world_to_local.basis.xform(camera.forward).normalized();
+	const int mesh_block_size = get_mesh_block_size();
+
+	_mesh_apply_queue.process(
+			budget_usec,
+			[viewer_pos, camera_pos, camera_forward, mesh_block_size](const VoxelEngine::BlockMeshOutput &ob) {
+				const int block_size = mesh_block_size << ob.lod;
+				const Vector3 block_center = to_vec3(ob.position * block_size + Vector3iUtil::create(block_size / 2));
+				// Half of the diagonal of the block
+				const float block_radius = 0.87f * block_size;
+				return MeshApplyQueue::get_block_cost(
+						block_center,
+						block_radius,
+						block_center.distance_squared_to(viewer_pos),
+						camera_pos,
+						camera_forward
+				);
+			},
+			[this](VoxelEngine::BlockMeshOutput &ob) { //
+				apply_mesh_update(ob);
+			}
+	);
+
+	if (use_shared_budget) {
+		engine.consume_shared_mesh_apply_budget_usec(_mesh_apply_queue.get_stats().time_usec);
+	}
+}
+
 void VoxelLodTerrain::apply_mesh_update(VoxelEngine::BlockMeshOutput &ob) {
 	// The following is done on the main thread because Godot doesn't really support everything done here.
 	// Building meshes can be done in the threaded task when using Vulkan, but not OpenGL.
@@ -2129,8 +2174,9 @@ void VoxelLodTerrain::apply_mesh_update(VoxelEngine::BlockMeshOutput &ob) {
 	if (has_collision && collision_expected) {
 		const uint64_t now = get_ticks_msec();
 
-		if (_collision_update_delay == 0 ||
-			static_cast<int>(now - block->last_collider_update_time) > _collision_update_delay) {
+		if (_collision_apply_budget_usec == 0 &&
+			(_collision_update_delay == 0 ||
+			 static_cast<int>(now - block->last_collider_update_time) > _collision_update_delay)) {
 			ZN_ASSERT(_mesher.is_valid());
 			Ref<Shape3D> collision_shape = make_collision_shape_from_mesher_output(ob.surfaces, **_mesher);
 			set_block_collision_shape(*this, *block, collision_shape, now);
@@ -2355,12 +2401,11 @@ void VoxelLodTerrain::apply_detail_texture_update_to_block(
 
 #endif
 
-void VoxelLodTerrain::process_deferred_collision_updates(uint32_t timeout_msec) {
+void VoxelLodTerrain::process_deferred_collision_updates(uint32_t budget_usec) {
 	ZN_PROFILE_SCOPE();
 
 	const unsigned int lod_count = get_lod_count();
-	// TODO We may move this in a time spread task somehow, the timeout does not account for them so could take longer
-	const uint64_t then = get_ticks_msec();
+	const ProfilingClock profiling_clock;
 
 	for (unsigned int lod_index = 0; lod_index < lod_count; ++lod_index) {
 		VoxelMeshMap<VoxelMeshBlockVLT> &mesh_map = _mesh_maps_per_lod[lod_index];
@@ -2379,7 +2424,8 @@ void VoxelLodTerrain::process_deferred_collision_updates(uint32_t timeout_msec)
 
 			const uint64_t now = get_ticks_msec();
 
-			if (static_cast<int>(now - block->last_collider_update_time) > _collision_update_delay) {
+			if (_collision_update_delay == 0 ||
+				static_cast<int>(now - block->last_collider_update_time) > _collision_update_delay) {
 				Ref<Shape3D> collision_shape;
 				if (_mesher.is_valid()) {
 					collision_shape =
@@ -2392,8 +2438,8 @@ void VoxelLodTerrain::process_deferred_collision_updates(uint32_t timeout_msec)
 				--i;
 			}
 
-			// We always process at least one, then we check the timeout
-			if (get_ticks_msec() - then >= timeout_msec) {
+			// We always process at least one, then we check the budget
+			if (profiling_clock.get_elapsed_microseconds() >= budget_usec) {
 				return;
 			}
 		}
@@ -2456,15 +2502,13 @@ void VoxelLodTerrain::process_fading_blocks(float delta) {
 			FadingOutMesh &item = _fading_out_meshes[i];
 			item.progress -= speed;
 			if (item.progress <= 0.f) {
+				// Mesh instances can be really slow to destroy due to materials: profiling has shown that
+				// `RendererSceneCull::free` of a mesh instance leads to
+				// `RendererRD::MaterialStorage::_update_queued_materials()` to be called, which internally updates
+				// hundreds of materials (supposedly from every block). Can take 1ms for a single instance, while the
+				// rest of the work is barely 1%! So destruction is spread over frames by this task.
 				FreeMeshTask::try_add_and_destroy(item.mesh_instance);
 				_shader_material_pool.recycle(item.shader_material);
-				// TODO Optimize: mesh instances destroyed here can be really slow due to materials...
-				// Profiling has shown that `RendererSceneCull::free` of a mesh instance
-				// leads to `RendererRD::MaterialStorage::_update_queued_materials()` to be called, which internally
-				// updates hundreds of materials (supposedly from every block). Can take 1ms for a single instance,
-				// while the rest of the work is barely 1%! Why is Godot doing this? I tried resetting the material like
-				// with blocks, but that didn't improve anything...
-				// item.mesh_instance.set_material_override(Ref<Material>());
 				_fading_out_meshes[i] = std::move(_fading_out_meshes.back());
 				_fading_out_meshes.pop_back();
 			} else {
@@ -2510,39 +2554,13 @@ void VoxelLodTerrain::process_fading_blocks(float delta) {
 	}
 }
 
-VoxelLodTerrain::LocalCameraInfo VoxelLodTerrain::get_local_camera_info() const {
-	LocalCameraInfo info;
-	if (!is_inside_tree()) {
-		return info;
-	}
-#ifdef TOOLS_ENABLED
-	if (Engine::get_singleton()->is_editor_hint()) {
-		// Falling back on the editor's camera
-		info.position = godot::VoxelEngine::get_singleton()->get_editor_camera_position();
-		info.forward = godot::VoxelEngine::get_singleton()->get_editor_camera_direction();
-		return info;
-	}
-#endif
-	const Viewport *vp = get_viewport();
-	if (vp == nullptr) {
-		return info;
-	}
-	const Camera3D *camera = vp->get_camera_3d();
-	if (camera == nullptr) {
-		return info;
-	}
-	Transform3D trans = camera->get_global_transform();
-	info.forward = get_forward(trans);
-	info.position = trans.get_origin();
-	return info;
-}
-
 #ifdef VOXEL_ENABLE_INSTANCER
 void VoxelLodTerrain::set_instancer(VoxelInstancer *instancer) {
 	if (_instancer != nullptr && instancer != nullptr) {
 		ERR_FAIL_COND_MSG(_instancer != nullptr, "No more than one VoxelInstancer per terrain");
 	}
 	_instancer = instancer;
+	_update_data->settings.instancer_enabled = (instancer != nullptr);
 }
 #endif
 
@@ -2647,12 +2665,12 @@ const VoxelLodTerrain::Stats &VoxelLodTerrain::get_stats() const {
 Dictionary VoxelLodTerrain::_b_get_statistics() const {
 	Dictionary d;
 
-	// const unsigned int lod_count = _update_data->settings.lod_count;
+	const unsigned int lod_count = _update_data->settings.lod_count;
 
-	// int deferred_collision_updates = 0;
-	// for (unsigned int lod_index = 0; lod_index < lod_count; ++lod_index) {
-	// 	deferred_collision_updates += _deferred_collision_updates_per_lod[lod_index].size();
-	// }
+	int deferred_collision_updates = 0;
+	for (unsigned int lod_index = 0; lod_index < lod_count; ++lod_index) {
+		deferred_collision_updates += _deferred_collision_updates_per_lod[lod_index].size();
+	}
 
 	// Breakdown of information and time spent in _process and the update task.
 
@@ -2667,6 +2685,13 @@ Dictionary VoxelLodTerrain::_b_get_statistics() const {
 	d["dropped_block_loads"] = _stats.dropped_block_loads;
 	d["dropped_block_meshs"] = _stats.dropped_block_meshs;
 
+	// Main thread mesh application
+	const MeshApplyQueue::Stats &mesh_apply_stats = _mesh_apply_queue.get_stats();
+	d["mesh_apply_queue_size"] = mesh_apply_stats.pending_count;
+	d["applied_meshes"] = mesh_apply_stats.applied_count;
+	d["time_apply_meshes"] = mesh_apply_stats.time_usec;
+	d["deferred_collision_updates"] = deferred_collision_updates;
+
 	return d;
 }
 
@@ -2699,6 +2724,8 @@ void VoxelLodTerrain::restart_stream() {
 
 void VoxelLodTerrain::remesh_all_blocks() {
 	// Requests a new mesh for all mesh blocks, without dropping everything first
+	// Cached meshes would be re-used otherwise
+	_meshing_dependency->mesh_cache.clear();
 	_update_data->wait_for_end_of_task();
 	const unsigned int lod_count = get_lod_count();
 	for (unsigned int lod_index = 0; lod_index < lod_count; ++lod_index) {
@@ -2783,6 +2810,22 @@ int VoxelLodTerrain::get_collision_update_delay() const {
 	return _collision_update_delay;
 }
 
+void VoxelLodTerrain::set_mesh_apply_budget_usec(int usec) {
+	_mesh_apply_budget_usec = math::clamp(usec, 0, constants::MAX_MAIN_THREAD_BUDGET_USEC);
+}
+
+int VoxelLodTerrain::get_mesh_apply_budget_usec() const {
+	return _mesh_apply_budget_usec;
+}
+
+void VoxelLodTerrain::set_collision_apply_budget_usec(int usec) {
+	_collision_apply_budget_usec = math::clamp(usec, 0, constants::MAX_MAIN_THREAD_BUDGET_USEC);
+}
+
+int VoxelLodTerrain::get_collision_apply_budget_usec() const {
+	return _collision_apply_budget_usec;
+}
+
 void VoxelLodTerrain::set_lod_fade_duration(float seconds) {
 	_lod_fade_duration = math::clamp(seconds, 0.f, 1.f);
 
@@ -2905,6 +2948,24 @@ bool VoxelLodTerrain::get_generator_use_gpu() const {
 
 #endif
 
+void VoxelLodTerrain::set_mesh_cache_size_mb(int size_mb) {
+	const size_t capacity = size_t(math::clamp(size_mb, 0, constants::MAX_MESH_CACHE_SIZE_MB)) * 1024 * 1024;
+	_meshing_dependency->mesh_cache.set_capacity(capacity);
+}
+
+int VoxelLodTerrain::get_mesh_cache_size_mb() const {
+	return _meshing_dependency->mesh_cache.get_capacity() / (1024 * 1024);
+}
+
+void VoxelLodTerrain::set_edit_journal_size_mb(int size_mb) {
+	const size_t capacity = size_t(math::clamp(size_mb, 0, constants::MAX_EDIT_JOURNAL_SIZE_MB)) * 1024 * 1024;
+	_data->set_edit_journal_capacity(capacity);
+}
+
+int VoxelLodTerrain::get_edit_journal_size_mb() const {
+	return _data->get_edit_journal_capacity() / (1024 * 1024);
+}
+
 void VoxelLodTerrain::set_cache_generated_blocks(const bool enabled) {
 	if (enabled == _update_data->settings.cache_generated_blocks) {
 		return;
@@ -3976,6 +4037,17 @@ void VoxelLodTerrain::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_generator_use_gpu"), &Self::get_generator_use_gpu);
 #endif
 
+	ClassDB::bind_method(D_METHOD("set_mesh_cache_size_mb", "size_mb"), &Self::set_mesh_cache_size_mb);
+	ClassDB::bind_method(D_METHOD("get_mesh_cache_size_mb"), &Self::get_mesh_cache_size_mb);
+	ClassDB::bind_method(D_METHOD("set_edit_journal_size_mb", "size_mb"), &Self::set_edit_journal_size_mb);
+	ClassDB::bind_method(D_METHOD("get_edit_journal_size_mb"), &Self::get_edit_journal_size_mb);
+
+	ClassDB::bind_method(D_METHOD("set_mesh_apply_budget_usec", "usec"), &Self::set_mesh_apply_budget_usec);
+	ClassDB::bind_method(D_METHOD("get_mesh_apply_budget_usec"), &Self::get_mesh_apply_budget_usec);
+
+	ClassDB::bind_method(D_METHOD("set_collision_apply_budget_usec", "usec"), &Self::set_collision_apply_budget_usec);
+	ClassDB::bind_method(D_METHOD("get_collision_apply_budget_usec"), &Self::get_collision_apply_budget_usec);
+
 	ClassDB::bind_method(D_METHOD("set_streaming_system", "system"), &Self::set_streaming_system);
 	ClassDB::bind_method(D_METHOD("get_streaming_system"), &Self::get_streaming_system);
 
@@ -4111,6 +4183,11 @@ void VoxelLodTerrain::_bind_methods() {
 			"set_collision_update_delay",
 			"get_collision_update_delay"
 	);
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "collision_apply_budget_usec", PROPERTY_HINT_RANGE, "0,100000"),
+			"set_collision_apply_budget_usec",
+			"get_collision_apply_budget_usec"
+	);
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "collision_margin"), "set_collision_margin", "get_collision_margin");
 
 	ADD_GROUP("Advanced", "");
@@ -4122,6 +4199,21 @@ void VoxelLodTerrain::_bind_methods() {
 			"is_stream_running_in_editor"
 	);
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "mesh_block_size"), "set_mesh_block_size", "get_mesh_block_size");
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "mesh_cache_size_mb", PROPERTY_HINT_RANGE, "0,4096"),
+			"set_mesh_cache_size_mb",
+			"get_mesh_cache_size_mb"
+	);
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "edit_journal_size_mb", PROPERTY_HINT_RANGE, "0,4096"),
+			"set_edit_journal_size_mb",
+			"get_edit_journal_size_mb"
+	);
+	ADD_PROPERTY(
+			PropertyInfo(Variant::INT, "mesh_apply_budget_usec", PROPERTY_HINT_RANGE, "0,100000"),
+			"set_mesh_apply_budget_usec",
+			"get_mesh_apply_budget_usec"
+	);
 	ADD_PROPERTY(
 			PropertyInfo(Variant::BOOL, "full_load_mode_enabled"),
 			"set_full_load_mode_enabled",
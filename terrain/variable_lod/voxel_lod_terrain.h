@@ -7,6 +7,7 @@
 #include "../../util/containers/std_map.h"
 #include "../../util/containers/std_unordered_map.h"
 #include "../../util/containers/std_vector.h"
+#include "../mesh_apply_queue.h"
 #include "../voxel_mesh_map.h"
 #include "../voxel_node.h"
 #include "lod_octree.h"
@@ -137,6 +138,12 @@ public:
 	void set_cache_generated_blocks(bool enabled);
 	bool get_cache_generated_blocks() const;
 
+	void set_mesh_cache_size_mb(int size_mb);
+	int get_mesh_cache_size_mb() const;
+
+	void set_edit_journal_size_mb(int size_mb);
+	int get_edit_journal_size_mb() const;
+
 	// These must be called after an edit
 	void post_edit_area(Box3i p_box, bool update_mesh);
 	void post_edit_modifiers(Box3i p_voxel_box);
@@ -155,6 +162,14 @@ public:
 	void set_collision_update_delay(int delay_msec);
 	int get_collision_update_delay() const;
 
+	// 0 means the main thread time budget of VoxelEngine is used
+	void set_mesh_apply_budget_usec(int usec);
+	int get_mesh_apply_budget_usec() const;
+
+	// 0 means colliders are built along with meshes, unless they are delayed by `collision_update_delay`
+	void set_collision_apply_budget_usec(int usec);
+	int get_collision_apply_budget_usec() const;
+
 	void set_lod_fade_duration(float seconds);
 	float get_lod_fade_duration() const;
 
@@ -337,16 +352,10 @@ private:
 
 	void save_all_modified_blocks(bool with_copy, std::shared_ptr<AsyncDependencyTracker> tracker);
 
-	void process_deferred_collision_updates(uint32_t timeout_msec);
+	void process_mesh_apply_queue();
+	void process_deferred_collision_updates(uint32_t budget_usec);
 	void process_fading_blocks(float delta);
 
-	struct LocalCameraInfo {
-		Vector3 position;
-		Vector3 forward;
-	};
-
-	LocalCameraInfo get_local_camera_info() const;
-
 #ifdef TOOLS_ENABLED
 	void update_gizmos();
 #endif
@@ -409,6 +418,7 @@ private:
 	unsigned int _collision_mask = 1;
 	float _collision_margin = constants::DEFAULT_COLLISION_MARGIN;
 	int _collision_update_delay = 0;
+	unsigned int _collision_apply_budget_usec = 0;
 	FixedArray<StdVector<Vector3i>, constants::MAX_LOD> _deferred_collision_updates_per_lod;
 
 	float _lod_fade_duration = 0.f;
@@ -438,15 +448,17 @@ private:
 	std::shared_ptr<StreamingDependency> _streaming_dependency;
 	std::shared_ptr<MeshingDependency> _meshing_dependency;
 
-	struct ApplyMeshUpdateTask : public ITimeSpreadTask {
+	// Applies pending meshes within the budget of the terrain, and runs again next frame if some remain
+	struct ApplyMeshQueueTask : public ITimeSpreadTask {
 		void run(TimeSpreadTaskContext &ctx) override;
 
 		VolumeID volume_id;
 		VoxelLodTerrain *self = nullptr;
-		VoxelEngine::BlockMeshOutput data;
 	};
 
-	FixedArray<StdUnorderedMap<Vector3i, RefCount>, constants::MAX_LOD> _queued_main_thread_mesh_updates;
+	MeshApplyQueue _mesh_apply_queue;
+	bool _mesh_apply_task_scheduled = false;
+	unsigned int _mesh_apply_budget_usec = 0;
 
 #ifdef TOOLS_ENABLED
 	bool _debug_draw_enabled = false;
@@ -1,9 +1,11 @@
 #include "voxel_lod_terrain_update_clipbox_streaming.h"
 #include "../../util/containers/std_unordered_set.h"
 #include "../../util/math/conv.h"
+#include "../../util/memory/linear_allocator.h"
 #include "../../util/profiling.h"
 #include "../../util/string/format.h"
 #include "voxel_lod_terrain_update_task.h"
+#include <algorithm>
 
 // #include <fstream>
 
@@ -564,6 +566,18 @@ void process_data_blocks_sliding_box(
 						data.view_area(box_to_load, lod_index, &tls_missing_blocks, nullptr, nullptr);
 					});
 
+					// Request closest blocks first
+					const Vector3i viewer_bpos = paired_viewer.state.local_position_voxels >> lod_data_block_size_po2;
+					std::sort(
+							tls_missing_blocks.begin(),
+							tls_missing_blocks.end(),
+							[viewer_bpos](const Vector3i &a, const Vector3i &b) {
+								const Vector3i da = a - viewer_bpos;
+								const Vector3i db = b - viewer_bpos;
+								return math::dot(da, da) < math::dot(db, db);
+							}
+					);
+
 					{
 						ZN_PROFILE_SCOPE_NAMED("Add loading blocks");
 						MutexLock mlock(lod.loading_blocks_mutex);
@@ -662,31 +676,6 @@ void process_data_blocks_sliding_box(
 	// state.clipbox_streaming.lod_distance_in_data_chunks_previous_update = lod_distance_in_data_chunks;
 }
 
-// TODO Copypasta from octree streaming file
-VoxelLodTerrainUpdateData::MeshBlockState &insert_new(
-		StdUnorderedMap<Vector3i, VoxelLodTerrainUpdateData::MeshBlockState> &mesh_map,
-		Vector3i pos
-) {
-#ifdef DEBUG_ENABLED
-	// We got here because the map didn't contain the element. If it did contain it already, that's a bug.
-	static VoxelLodTerrainUpdateData::MeshBlockState s_default;
-	ERR_FAIL_COND_V(mesh_map.find(pos) != mesh_map.end(), s_default);
-#endif
-	// C++ standard says if the element is not present, it will be default-constructed.
-	// So here is how to insert a default, non-movable struct into an unordered_map.
-	// https://stackoverflow.com/questions/22229773/map-unordered-map-with-non-movable-default-constructible-value-type
-	VoxelLodTerrainUpdateData::MeshBlockState &block = mesh_map[pos];
-
-	// This approach doesn't compile, had to workaround with the writing [] operator.
-	/*
-	auto p = lod.mesh_map_state.map.emplace(pos, VoxelLodTerrainUpdateData::MeshBlockState());
-	// We got here because the map didn't contain the element. If it did contain it already, that's a bug.
-	CRASH_COND(p.second == false);
-	*/
-
-	return block;
-}
-
 inline Vector3i get_relative_child_position(unsigned int child_index) {
 	return Vector3i( //
 			(child_index & 1), //
@@ -747,136 +736,169 @@ inline void schedule_mesh_load(
 	// mesh_block.pending_update_has_visuals = require_visual;
 }
 
-void view_mesh_box(
-		const Box3i box_to_add,
+} // namespace
+
+void get_entering_cells_by_distance(
+		const Box3i &new_box,
+		const Box3i &prev_box,
+		Vector3i center,
+		StdTempVector<Vector3i> &out_cells
+) {
+	new_box.difference(prev_box, [&out_cells](const Box3i &sub_box) {
+		sub_box.for_each_cell([&out_cells](Vector3i pos) { //
+			out_cells.push_back(pos);
+		});
+	});
+
+	std::sort(out_cells.begin(), out_cells.end(), [center](const Vector3i &a, const Vector3i &b) {
+		const Vector3i da = a - center;
+		const Vector3i db = b - center;
+		return math::dot(da, da) < math::dot(db, db);
+	});
+}
+
+namespace {
+
+void view_mesh_block(
+		const Vector3i bpos,
 		VoxelLodTerrainUpdateData::Lod &lod,
 		unsigned int lod_index,
 		bool is_full_load_mode,
 		int mesh_to_data_factor,
 		const VoxelData &voxel_data,
+		const Box3i &bounds_in_data_blocks,
 		bool require_visuals,
 		bool require_collisions
 ) {
-	ZN_PROFILE_SCOPE();
+	// Single lookup: the block gets default-constructed if it wasn't present
+	VoxelLodTerrainUpdateData::MeshBlockState *mesh_block = &lod.mesh_map_state.map[bpos];
 
-	const Box3i bounds_in_data_blocks = voxel_data.get_bounds().downscaled(voxel_data.get_block_size() << lod_index);
-
-	box_to_add.for_each_cell([&lod, //
-							  is_full_load_mode, //
-							  mesh_to_data_factor, //
-							  &voxel_data,
-							  lod_index, //
-							  require_visuals, //
-							  require_collisions, //
-							  bounds_in_data_blocks](Vector3i bpos) {
-		VoxelLodTerrainUpdateData::MeshBlockState *mesh_block;
-		auto mesh_block_it = lod.mesh_map_state.map.find(bpos);
+	bool first_visuals = false;
+	if (require_visuals) {
+		first_visuals = mesh_block->mesh_viewers.get() == 0;
+		mesh_block->mesh_viewers.add();
+	}
 
-		if (mesh_block_it == lod.mesh_map_state.map.end()) {
-			// RWLockWrite wlock(lod.mesh_map_state.map_lock);
-			mesh_block = &insert_new(lod.mesh_map_state.map, bpos);
+	bool first_collision = false;
+	if (require_collisions) {
+		first_collision = mesh_block->collision_viewers.get() == 0;
+		mesh_block->collision_viewers.add();
+	}
 
-			// if (is_full_load_mode) {
-			// 	// Everything is loaded up-front, so we directly trigger meshing instead of
-			// 	// reacting to data chunks being loaded
-			// 	schedule_mesh_load(lod.mesh_blocks_pending_update, bpos, *mesh_block, require_visuals);
-			// }
+	if (first_visuals || first_collision) {
+		// TODO Optimize: don't schedule again if an update has been sent to the task system with the same options.
+		// Currently we only avoid that for requests in the list before they get sent to the task system.
+		// This could be a problem if many viewers with increasingly different options are spawned in the same area
+		// at consecutive frames.
+
+		// TODO Optimize: don't trigger tasks with options we already scheduled calculations for.
+		// For example, in case there is no task in the update list, but the last scheduled ones did compute
+		// collision but not visual, if a viewer requests visuals then the scheduled task must only compute
+		// visuals. Recomputing collision is unnecessary because the mesh won't have changed in this scenario.
+		// (Voxel changes trigger an update of each refcounted option and use a different code path).
+		// We would still remesh (and so generate unedited voxel data in some cases) though, and to avoid that we'd
+		// need to keep a cache mesh data ourselves. The issue is that Godot is also caching mesh data in ArrayMesh
+		// (but for different reasons so it's not reliable), so it would come at a noticeable memory cost.
+
+		if (is_full_load_mode) {
+			// Everything is loaded up-front, so we have to directly trigger meshing instead of
+			// reacting to data chunks being loaded
+			schedule_mesh_load(lod.mesh_blocks_pending_update, bpos, *mesh_block, require_visuals);
 
 		} else {
-			mesh_block = &mesh_block_it->second;
-		}
+			// (Re-)Trigger meshing if data is already available.
+			// This is needed especially in streaming mode because then there won't be any "data loaded" event to
+			// react to if data is already there. Before that, meshes were updated only when a data block was loaded
+			// or modified, so changing block size or viewer flags did not make meshes appear. Having two viewer
+			// regions meet also caused problems.
+
+			const Box3i data_box = Box3i(bpos * mesh_to_data_factor, Vector3iUtil::create(mesh_to_data_factor))
+										   .padded(1)
+										   .clipped(bounds_in_data_blocks);
 
-		bool first_visuals = false;
-		if (require_visuals) {
-			first_visuals = mesh_block->mesh_viewers.get() == 0;
-			mesh_block->mesh_viewers.add();
-		}
+			// If we get an empty box at this point, something is wrong with the caller
+			ZN_ASSERT_RETURN(!data_box.is_empty());
 
-		bool first_collision = false;
-		if (require_collisions) {
-			first_collision = mesh_block->collision_viewers.get() == 0;
-			mesh_block->collision_viewers.add();
-		}
+			const bool data_available = voxel_data.has_all_blocks_in_area_unbound(data_box, lod_index);
 
-		if (first_visuals || first_collision) {
-			// TODO Optimize: don't schedule again if an update has been sent to the task system with the same options.
-			// Currently we only avoid that for requests in the list before they get sent to the task system.
-			// This could be a problem if many viewers with increasingly different options are spawned in the same area
-			// at consecutive frames.
-
-			// TODO Optimize: don't trigger tasks with options we already scheduled calculations for.
-			// For example, in case there is no task in the update list, but the last scheduled ones did compute
-			// collision but not visual, if a viewer requests visuals then the scheduled task must only compute
-			// visuals. Recomputing collision is unnecessary because the mesh won't have changed in this scenario.
-			// (Voxel changes trigger an update of each refcounted option and use a different code path).
-			// We would still remesh (and so generate unedited voxel data in some cases) though, and to avoid that we'd
-			// need to keep a cache mesh data ourselves. The issue is that Godot is also caching mesh data in ArrayMesh
-			// (but for different reasons so it's not reliable), so it would come at a noticeable memory cost.
-
-			if (is_full_load_mode) {
-				// Everything is loaded up-front, so we have to directly trigger meshing instead of
-				// reacting to data chunks being loaded
+			if (data_available) {
 				schedule_mesh_load(lod.mesh_blocks_pending_update, bpos, *mesh_block, require_visuals);
-
-			} else {
-				// (Re-)Trigger meshing if data is already available.
-				// This is needed especially in streaming mode because then there won't be any "data loaded" event to
-				// react to if data is already there. Before that, meshes were updated only when a data block was loaded
-				// or modified, so changing block size or viewer flags did not make meshes appear. Having two viewer
-				// regions meet also caused problems.
-
-				const Box3i data_box = Box3i(bpos * mesh_to_data_factor, Vector3iUtil::create(mesh_to_data_factor))
-											   .padded(1)
-											   .clipped(bounds_in_data_blocks);
-
-				// If we get an empty box at this point, something is wrong with the caller
-				ZN_ASSERT_RETURN(!data_box.is_empty());
-
-				const bool data_available = voxel_data.has_all_blocks_in_area_unbound(data_box, lod_index);
-
-				if (data_available) {
-					schedule_mesh_load(lod.mesh_blocks_pending_update, bpos, *mesh_block, require_visuals);
-				}
-				// Else, we'll react to when data is loaded
 			}
+			// Else, we'll react to when data is loaded
 		}
+	}
 
 #if 0
-		// TODO Trigger a mesh update with visuals if that's the first viewer with visuals.
-		// Disregard the fact a mesh update is already pending when that happens, unless it was triggered with
-		// the same flags.
-
-		// Trigger meshing if data is already available.
-		// This is needed because then there won't be any "data loaded" event to react to.
-		// Before that, meshes were updated only when a data block was loaded or modified,
-		// so changing block size or viewer flags did not make meshes appear. Having two
-		// viewer regions meet also caused problems.
+	// TODO Trigger a mesh update with visuals if that's the first viewer with visuals.
+	// Disregard the fact a mesh update is already pending when that happens, unless it was triggered with
+	// the same flags.
+
+	// Trigger meshing if data is already available.
+	// This is needed because then there won't be any "data loaded" event to react to.
+	// Before that, meshes were updated only when a data block was loaded or modified,
+	// so changing block size or viewer flags did not make meshes appear. Having two
+	// viewer regions meet also caused problems.
+	//
+	// TODO This tends to suggest that data blocks should be allocated from here
+	// instead, however it would couple mesh loading to data loading, forcing to
+	// duplicate the data code path in case of viewers that don't need meshes.
+	// try_schedule_mesh_update(*block);
+	// Alternative: in data diff, put every found block into a list which we'll also
+	// run through in `process_loaded_data_blocks_trigger_meshing`?
+	//
+	if (!is_full_load_mode && (!mesh_block->loaded || first_visuals) &&
+			// Is an update already pending?
+			mesh_block->state != VoxelLodTerrainUpdateData::MESH_UPDATE_NOT_SENT &&
+			mesh_block->state != VoxelLodTerrainUpdateData::MESH_UPDATE_SENT) {
 		//
-		// TODO This tends to suggest that data blocks should be allocated from here
-		// instead, however it would couple mesh loading to data loading, forcing to
-		// duplicate the data code path in case of viewers that don't need meshes.
-		// try_schedule_mesh_update(*block);
-		// Alternative: in data diff, put every found block into a list which we'll also
-		// run through in `process_loaded_data_blocks_trigger_meshing`?
-		//
-		if (!is_full_load_mode && (!mesh_block->loaded || first_visuals) &&
-				// Is an update already pending?
-				mesh_block->state != VoxelLodTerrainUpdateData::MESH_UPDATE_NOT_SENT &&
-				mesh_block->state != VoxelLodTerrainUpdateData::MESH_UPDATE_SENT) {
-			//
-			const Box3i data_box =
-					Box3i(bpos * mesh_to_data_factor, Vector3iUtil::create(mesh_to_data_factor)).padded(1);
+		const Box3i data_box =
+				Box3i(bpos * mesh_to_data_factor, Vector3iUtil::create(mesh_to_data_factor)).padded(1);
 
-			// If we get an empty box at this point, something is wrong with the caller
-			ZN_ASSERT_RETURN(!data_box.is_empty());
+		// If we get an empty box at this point, something is wrong with the caller
+		ZN_ASSERT_RETURN(!data_box.is_empty());
 
-			const bool data_available = voxel_data.has_all_blocks_in_area(data_box, lod_index);
+		const bool data_available = voxel_data.has_all_blocks_in_area(data_box, lod_index);
 
-			if (data_available) {
-				schedule_mesh_load(lod.mesh_blocks_pending_update, bpos, *mesh_block, first_visuals);
-			}
+		if (data_available) {
+			schedule_mesh_load(lod.mesh_blocks_pending_update, bpos, *mesh_block, first_visuals);
 		}
+	}
 #endif
+}
+
+void view_mesh_box(
+		const Box3i box_to_add,
+		VoxelLodTerrainUpdateData::Lod &lod,
+		unsigned int lod_index,
+		bool is_full_load_mode,
+		int mesh_to_data_factor,
+		const VoxelData &voxel_data,
+		bool require_visuals,
+		bool require_collisions
+) {
+	ZN_PROFILE_SCOPE();
+
+	const Box3i bounds_in_data_blocks = voxel_data.get_bounds().downscaled(voxel_data.get_block_size() << lod_index);
+
+	box_to_add.for_each_cell([&lod, //
+							  is_full_load_mode, //
+							  mesh_to_data_factor, //
+							  &voxel_data,
+							  lod_index, //
+							  require_visuals, //
+							  require_collisions, //
+							  &bounds_in_data_blocks](Vector3i bpos) {
+		view_mesh_block(
+				bpos,
+				lod,
+				lod_index,
+				is_full_load_mode,
+				mesh_to_data_factor,
+				voxel_data,
+				bounds_in_data_blocks,
+				require_visuals,
+				require_collisions
+		);
 	});
 }
 
@@ -1106,19 +1128,27 @@ void process_viewer_mesh_blocks_sliding_box(
 		if (prev_mesh_box != new_mesh_box) {
 			RWLockWrite wlock(lod.mesh_map_state.map_lock);
 
-			// Add meshes entering range
+			// Add meshes entering range, closest first
 			if (requires_meshes(paired_viewer.state) && can_load) {
-				SmallVector<Box3i, 6> new_mesh_boxes;
-				new_mesh_box.difference_to_vec(prev_mesh_box, new_mesh_boxes);
+				LinearAllocator &allocator = get_tls_temp_allocator();
+				LinearAllocatorScope las(allocator);
+				StdTempVector<Vector3i> entering_positions(allocator);
+
+				const Vector3i viewer_bpos = paired_viewer.state.local_position_voxels >> lod_mesh_block_size_po2;
+				get_entering_cells_by_distance(new_mesh_box, prev_mesh_box, viewer_bpos, entering_positions);
+
+				const Box3i bounds_in_data_blocks =
+						volume_bounds_in_voxels.downscaled(data.get_block_size() << lod_index);
 
-				for (const Box3i &box_to_add : new_mesh_boxes) {
-					view_mesh_box(
-							box_to_add,
+				for (const Vector3i bpos : entering_positions) {
+					view_mesh_block(
+							bpos,
 							lod,
 							lod_index,
 							is_full_load_mode,
 							mesh_to_data_factor,
 							data,
+							bounds_in_data_blocks,
 							paired_viewer.state.requires_visuals,
 							paired_viewer.state.requires_collisions
 					);
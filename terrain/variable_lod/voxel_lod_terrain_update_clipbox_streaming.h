@@ -2,6 +2,7 @@
 #define VOXEL_LOD_TERRAIN_UPDATE_CLIPBOX_STREAMING_H
 
 #include "../../storage/voxel_data.h"
+#include "../../util/memory/linear_allocator.h"
 #include "voxel_lod_terrain_update_data.h"
 
 namespace zylann::voxel {
@@ -18,6 +19,16 @@ void process_clipbox_streaming(
 		bool can_mesh
 );
 
+// Gets positions of cells contained in `new_box` but not in `prev_box`, ordered by increasing distance to `center`.
+// Only the difference between boxes is visited, so the cost depends on how much the box moved rather than its size.
+// Ordering allows blocks closest to the viewer to be requested first.
+void get_entering_cells_by_distance(
+		const Box3i &new_box,
+		const Box3i &prev_box,
+		Vector3i center,
+		StdTempVector<Vector3i> &out_cells
+);
+
 } // namespace zylann::voxel
 
 #endif // VOXEL_LOD_TERRAIN_UPDATE_CLIPBOX_STREAMING_H
@@ -77,6 +77,8 @@ struct VoxelLodTerrainUpdateData {
 		// If streaming is disabled, this option has no effect.
 		bool cache_generated_blocks = false;
 		bool collision_enabled = true;
+		// If true, mesh surface arrays are read by a VoxelInstancer when results are applied
+		bool instancer_enabled = false;
 		bool detail_textures_use_gpu = false;
 		bool generator_use_gpu = false;
 		uint8_t detail_texture_generator_override_begin_lod_index = 0;
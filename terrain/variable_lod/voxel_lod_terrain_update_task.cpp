@@ -118,6 +118,7 @@ void request_block_load(
 		const Transform3D &volume_transform,
 		const VoxelLodTerrainUpdateData::Settings &settings,
 		BufferedTaskScheduler &task_scheduler,
+		LoadBlockDataTaskBatcher &load_batcher,
 		const TaskCancellationToken cancellation_token,
 		VoxelLodTerrainUpdateData::State &state
 ) {
@@ -152,22 +153,7 @@ void request_block_load(
 				settings.lod_distance
 		);
 
-		const bool request_instances = false;
-		LoadBlockDataTask *task = ZN_NEW(LoadBlockDataTask(
-				volume_id,
-				block_pos,
-				lod_index,
-				data_block_size,
-				request_instances,
-				stream_dependency,
-				priority_dependency,
-				settings.cache_generated_blocks,
-				settings.generator_use_gpu,
-				data,
-				cancellation_token
-		));
-
-		task_scheduler.push_io_task(task);
+		load_batcher.add(block_pos, lod_index, priority_dependency, cancellation_token);
 
 	} else if (settings.cache_generated_blocks) {
 		// Directly generate the block without checking the stream.
@@ -204,6 +190,17 @@ void send_block_data_requests(
 		BufferedTaskScheduler &task_scheduler,
 		VoxelLodTerrainUpdateData::State &state
 ) {
+	const bool request_instances = false;
+	LoadBlockDataTaskBatcher load_batcher(
+			volume_id,
+			data_block_size,
+			request_instances,
+			stream_dependency,
+			settings.cache_generated_blocks,
+			settings.generator_use_gpu,
+			data
+	);
+
 	for (unsigned int i = 0; i < blocks_to_load.size(); ++i) {
 		const VoxelLodTerrainUpdateData::BlockToLoad btl = blocks_to_load[i];
 		request_block_load(
@@ -217,10 +214,13 @@ void send_block_data_requests(
 				volume_transform,
 				settings,
 				task_scheduler,
+				load_batcher,
 				btl.cancellation_token,
 				state
 		);
 	}
+
+	load_batcher.flush(task_scheduler);
 }
 
 // This is used when streaming is enabled, yet the terrain has no stream and no generator (There can only be empty
@@ -339,6 +339,7 @@ void send_mesh_requests(
 			task->data = data_ptr;
 			task->require_visual = mesh_to_update.require_visual;
 			task->collision_hint = settings.collision_enabled;
+			task->surface_arrays_required = settings.collision_enabled || settings.instancer_enabled;
 #ifdef VOXEL_ENABLE_SMOOTH_MESHING
 			task->detail_texture_settings = settings.detail_texture_settings;
 			task->detail_texture_generator_override = settings.detail_texture_generator_override;
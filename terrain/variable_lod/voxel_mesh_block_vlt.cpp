@@ -445,7 +445,12 @@ void VoxelMeshBlockVLT::clear_fading() {
 
 bool is_mesh_empty(Span<const VoxelMesher::Output::Surface> surfaces) {
 	for (const VoxelMesher::Output::Surface &surf : surfaces) {
-		if (is_surface_triangulated(surf.arrays)) {
+#ifdef ZN_GODOT_PACKED_SURFACES
+		if (surf.is_packed) {
+			return false;
+		}
+#endif
+		if (!surf.arrays.is_empty() && is_surface_triangulated(surf.arrays)) {
 			return false;
 		}
 	}
@@ -2,101 +2,113 @@
 #include "../terrain/fixed_lod/voxel_terrain.h"
 // #include "../util/string/format.h"
 #include "../constants/voxel_string_names.h"
+#include "../util/godot/core/typed_array.h"
 #include "../util/math/conv.h"
+#include "../util/memory/memory.h"
 #include "../util/string/format.h"
 
 namespace zylann::voxel {
 
-VoxelAStarGrid3DInternal::VoxelAStarGrid3DInternal() : _voxel_buffer(VoxelBuffer::ALLOCATOR_POOL) {}
-
-void VoxelAStarGrid3DInternal::init_cache() {
-	_grid_cache_size = math::ceildiv(get_region().size, Chunk::SIZE);
-	_grid_cache.resize(_grid_cache_size.x * _grid_cache_size.y * _grid_cache_size.z);
-	_grid_chunk_states.resize_no_init(_grid_cache.size());
-	_grid_chunk_states.fill(false);
-	_voxel_buffer.create(Vector3iUtil::create(Chunk::SIZE));
-
-	// const Box3i region = get_region();
-	// for (int y = region.pos.y; y < region.pos.y + region.size.y; ++y) {
-	// 	println(format("Y={}", y));
-	// 	for (int z = region.pos.z; z < region.pos.z + region.size.z; ++z) {
-	// 		std::string s;
-	// 		for (int x = region.pos.x; x < region.pos.x + region.size.x; ++x) {
-	// 			if (is_solid(Vector3i(x, y, z))) {
-	// 				s += " O";
-	// 			} else {
-	// 				s += " -";
-	// 			}
-	// 		}
-	// 		println(s);
-	// 	}
-	// }
+VoxelAStarGrid3DInternal::VoxelAStarGrid3DInternal() {}
+
+void VoxelAStarGrid3DInternal::update_cache() {
+	ZN_ASSERT_RETURN(data != nullptr);
+	if (is_cache_up_to_date()) {
+		return;
+	}
+	// Read before building, so changes made while building cause another rebuild next time
+	_cache_voxels_version = data->get_voxels_version(get_region());
+	set_region_cache(build_region_cache(*data, get_region()));
 }
 
-bool VoxelAStarGrid3DInternal::is_solid(Vector3i pos) {
-	// TODO We could align the cache with the voxel chunk grid to avoid more expensive copies across chunk borders
-	const Vector3i gpos = pos - get_region().position;
-	const Vector3i cpos = gpos >> Chunk::SIZE_PO2;
-	const Vector3i rpos = gpos & Chunk::SIZE_MASK;
-
-	const unsigned int chunk_loc = Vector3iUtil::get_zxy_index(cpos, _grid_cache_size);
-	Chunk chunk;
-
-	if (_grid_chunk_states.get(chunk_loc)) {
-		chunk = _grid_cache[chunk_loc];
-
-	} else {
-		ZN_PROFILE_SCOPE_NAMED("Caching voxels");
-		ZN_ASSERT(data != nullptr);
-
-		const VoxelBuffer::ChannelId channel_index = VoxelBuffer::CHANNEL_TYPE;
-		const Vector3i copy_origin = (cpos << Chunk::SIZE_PO2) + get_region().position;
-		data->copy(copy_origin, _voxel_buffer, 1 << channel_index, false);
-
-		if (_voxel_buffer.get_channel_compression(channel_index) == VoxelBuffer::COMPRESSION_UNIFORM) {
-			if (_voxel_buffer.get_voxel(0, 0, 0, channel_index) != 0) {
-				chunk.solid_bits = 0xffffffffffffffff;
-			} else {
-				chunk.solid_bits = 0;
-			}
+bool VoxelAStarGrid3DInternal::is_cache_up_to_date() const {
+	const std::shared_ptr<const RegionCache> &cache = get_region_cache();
+	return cache != nullptr && data != nullptr && cache->region == get_region() &&
+			_cache_voxels_version == data->get_voxels_version(get_region());
+}
 
-		} else {
-			chunk.solid_bits = 0;
-
-			switch (_voxel_buffer.get_channel_depth(channel_index)) {
-				case VoxelBuffer::DEPTH_8_BIT: {
-					Span<const uint8_t> values;
-					ZN_ASSERT(_voxel_buffer.get_channel_data(channel_index, values));
-					uint64_t i = 0;
-					// Assuming ZXY loop order
-					for (const uint8_t v : values) {
-						chunk.solid_bits |= (v == 0 ? uint64_t(0) : (uint64_t(1) << i));
-						++i;
-					}
-				} break;
-
-				case VoxelBuffer::DEPTH_16_BIT: {
-					Span<const uint16_t> values;
-					ZN_ASSERT(_voxel_buffer.get_channel_data(channel_index, values));
-					uint64_t i = 0;
-					for (const uint16_t v : values) {
-						chunk.solid_bits |= (v == 0 ? uint64_t(0) : (uint64_t(1) << i));
-						++i;
-					}
-				} break;
+std::shared_ptr<AStarGrid3D::RegionCache> VoxelAStarGrid3DInternal::build_region_cache(
+		const VoxelData &data,
+		const Box3i region
+) {
+	ZN_PROFILE_SCOPE();
 
-				default:
-					ZN_PRINT_ERROR("Unhandled channel depth");
-					break;
-			}
+	std::shared_ptr<RegionCache> cache = make_shared_instance<RegionCache>();
+	const unsigned int block_size_po2 = data.get_block_size_po2();
+	cache->create(region, block_size_po2);
 
-			_grid_chunk_states.set(chunk_loc);
-		}
+	if (region.is_empty()) {
+		return cache;
+	}
+
+	const VoxelBuffer::ChannelId channel_index = VoxelBuffer::CHANNEL_TYPE;
+	const Vector3i block_size = Vector3iUtil::create(1 << block_size_po2);
+
+	// TODO Candidate for temp allocator
+	VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_POOL);
 
-		_grid_cache[chunk_loc] = chunk;
+	Vector3i cpos;
+	for (cpos.z = 0; cpos.z < cache->chunk_grid_size.z; ++cpos.z) {
+		for (cpos.x = 0; cpos.x < cache->chunk_grid_size.x; ++cpos.x) {
+			for (cpos.y = 0; cpos.y < cache->chunk_grid_size.y; ++cpos.y) {
+				ZN_PROFILE_SCOPE_NAMED("Caching voxels");
+
+				voxels.create(block_size);
+				const Vector3i copy_origin = (cpos << block_size_po2) + cache->aligned_box.position;
+				data.copy(copy_origin, voxels, 1 << channel_index, false);
+
+				const uint64_t bit_offset = cache->get_chunk_bit_offset(cpos);
+				DynamicBitset &bits = cache->solid_bits;
+
+				if (voxels.get_channel_compression(channel_index) == VoxelBuffer::COMPRESSION_UNIFORM) {
+					if (voxels.get_voxel(0, 0, 0, channel_index) != 0) {
+						const uint64_t volume = Vector3iUtil::get_volume_u64(block_size);
+						for (uint64_t i = 0; i < volume; ++i) {
+							bits.set(bit_offset + i);
+						}
+					}
+					continue;
+				}
+
+				// Voxels and bits are both in ZXY order
+				switch (voxels.get_channel_depth(channel_index)) {
+					case VoxelBuffer::DEPTH_8_BIT: {
+						Span<const uint8_t> values;
+						ZN_ASSERT(voxels.get_channel_data_read_only(channel_index, values));
+						for (unsigned int i = 0; i < values.size(); ++i) {
+							if (values[i] != 0) {
+								bits.set(bit_offset + i);
+							}
+						}
+					} break;
+
+					case VoxelBuffer::DEPTH_16_BIT: {
+						Span<const uint16_t> values;
+						ZN_ASSERT(voxels.get_channel_data_read_only(channel_index, values));
+						for (unsigned int i = 0; i < values.size(); ++i) {
+							if (values[i] != 0) {
+								bits.set(bit_offset + i);
+							}
+						}
+					} break;
+
+					default:
+						ZN_PRINT_ERROR("Unhandled channel depth");
+						break;
+				}
+			}
+		}
 	}
 
-	return chunk.get_solid_bit(rpos);
+	return cache;
+}
+
+bool VoxelAStarGrid3DInternal::is_solid(Vector3i pos) {
+	// Slow fallback, only used if no region cache was built
+	ZN_ASSERT_RETURN_V(data != nullptr, false);
+	VoxelSingleValue defval;
+	defval.i = 0;
+	return data->get_voxel(pos, VoxelBuffer::CHANNEL_TYPE, defval).i != 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -106,6 +118,8 @@ void VoxelAStarGrid3D::set_terrain(VoxelTerrain *node) {
 	// Can't modify the pathfinder while it is running in a different thread
 	ZN_ASSERT_RETURN(_is_running_async == false);
 	_path_finder.data = node->get_storage_shared();
+	// The cache was built from other voxels
+	_path_finder.set_region_cache(nullptr);
 }
 
 TypedArray<Vector3i> VoxelAStarGrid3D::find_path(Vector3i from_position, Vector3i to_position) {
@@ -155,7 +169,7 @@ TypedArray<Vector3i> to_typed_array(Span<const Vector3i> items) {
 
 TypedArray<Vector3i> VoxelAStarGrid3D::find_path_internal(Vector3i from_position, Vector3i to_position) {
 	_path_finder.start(from_position, to_position);
-	_path_finder.init_cache();
+	_path_finder.update_cache();
 
 	while (_path_finder.is_running()) {
 		_path_finder.step();
@@ -210,6 +224,138 @@ void VoxelAStarGrid3D::find_path_async(Vector3i from_position, Vector3i to_posit
 	VoxelEngine::get_singleton().push_async_task(task);
 }
 
+namespace {
+
+// State shared by all searches of a batch
+struct AStarBatchSearch {
+	Ref<VoxelAStarGrid3D> astar;
+	std::shared_ptr<VoxelData> data;
+	std::shared_ptr<const AStarGrid3D::RegionCache> region_cache;
+	Box3i region;
+	Vector3f agent_size;
+	int max_fall_height;
+	float max_path_cost;
+	StdVector<Vector3i> from_positions;
+	StdVector<Vector3i> to_positions;
+	StdVector<StdVector<Vector3i>> paths;
+	std::atomic_uint32_t remaining_searches;
+};
+
+class AStarBatchSearchTask : public IThreadedTask {
+public:
+	std::shared_ptr<AStarBatchSearch> batch;
+	unsigned int index;
+
+	void run(ThreadedTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		AStarBatchSearch &b = *batch;
+
+		// Each search has its own state, but they all share the same cache of voxels
+		AStarGrid3D path_finder;
+		path_finder.set_region(b.region);
+		path_finder.set_agent_size(b.agent_size);
+		path_finder.set_max_fall_height(b.max_fall_height);
+		path_finder.set_max_path_cost(b.max_path_cost);
+		path_finder.set_region_cache(b.region_cache);
+
+		path_finder.start(b.from_positions[index], b.to_positions[index]);
+		while (path_finder.is_running()) {
+			path_finder.step();
+		}
+
+		const Span<const Vector3i> path = path_finder.get_path();
+		b.paths[index].assign(path.data(), path.data() + path.size());
+
+		if (--b.remaining_searches == 0) {
+			// Last one to finish reports results
+			Array paths;
+			paths.resize(b.paths.size());
+			for (unsigned int i = 0; i < b.paths.size(); ++i) {
+				paths[i] = to_typed_array(to_span(b.paths[i]));
+			}
+			b.astar->call_deferred(VoxelStringNames::get_singleton()._on_async_batch_search_completed, paths);
+		}
+	}
+
+	const char *get_debug_name() const override {
+		return "VoxelAStarGrid3DBatchSearchTask";
+	}
+};
+
+// Builds the cache once if needed, then spawns one task per search
+class AStarBatchPrepareTask : public IThreadedTask {
+public:
+	std::shared_ptr<AStarBatchSearch> batch;
+
+	void run(ThreadedTaskContext &ctx) override {
+		ZN_PROFILE_SCOPE();
+		AStarBatchSearch &b = *batch;
+
+		if (b.region_cache == nullptr) {
+			b.region_cache = VoxelAStarGrid3DInternal::build_region_cache(*b.data, b.region);
+		}
+
+		StdVector<IThreadedTask *> tasks;
+		tasks.reserve(b.from_positions.size());
+		for (unsigned int i = 0; i < b.from_positions.size(); ++i) {
+			AStarBatchSearchTask *task = ZN_NEW(AStarBatchSearchTask);
+			task->batch = batch;
+			task->index = i;
+			tasks.push_back(task);
+		}
+		VoxelEngine::get_singleton().push_async_tasks(to_span(tasks));
+	}
+
+	const char *get_debug_name() const override {
+		return "VoxelAStarGrid3DBatchPrepareTask";
+	}
+};
+
+} // namespace
+
+void VoxelAStarGrid3D::find_paths_async(TypedArray<Vector3i> from_positions, TypedArray<Vector3i> to_positions) {
+	ZN_ASSERT_RETURN(_is_running_async == false);
+	ZN_ASSERT_RETURN_MSG(_path_finder.data != nullptr, "Terrain to pathfind was not set, use `set_terrain()`");
+	ZN_ASSERT_RETURN_MSG(
+			from_positions.size() == to_positions.size(), "Source and destination arrays must have the same size"
+	);
+
+	if (from_positions.size() == 0) {
+		// Keep the same behavior as if there was something to search
+		call_deferred(VoxelStringNames::get_singleton()._on_async_batch_search_completed, Array());
+		_is_running_async = true;
+		return;
+	}
+
+	std::shared_ptr<AStarBatchSearch> batch = make_shared_instance<AStarBatchSearch>();
+	batch->astar = Ref<VoxelAStarGrid3D>(this);
+	batch->data = _path_finder.data;
+	batch->region = _path_finder.get_region();
+	batch->agent_size = _path_finder.get_agent_size();
+	batch->max_fall_height = _path_finder.get_max_fall_height();
+	batch->max_path_cost = _path_finder.get_max_path_cost();
+	if (_path_finder.is_cache_up_to_date()) {
+		// Reuse the cache from previous searches instead of building it again
+		batch->region_cache = _path_finder.get_region_cache();
+	}
+	godot::copy_to(batch->from_positions, from_positions);
+	godot::copy_to(batch->to_positions, to_positions);
+	batch->paths.resize(batch->from_positions.size());
+	batch->remaining_searches = batch->from_positions.size();
+
+#ifdef DEBUG_ENABLED
+	for (unsigned int i = 0; i < batch->from_positions.size(); ++i) {
+		check_params(batch->from_positions[i], batch->to_positions[i]);
+	}
+#endif
+
+	_is_running_async = true;
+
+	AStarBatchPrepareTask *task = ZN_NEW(AStarBatchPrepareTask);
+	task->batch = batch;
+	VoxelEngine::get_singleton().push_async_task(task);
+}
+
 bool VoxelAStarGrid3D::is_running_async() const {
 	return _is_running_async;
 }
@@ -236,6 +382,11 @@ void VoxelAStarGrid3D::_b_on_async_search_completed(TypedArray<Vector3i> path) {
 	emit_signal(VoxelStringNames::get_singleton().async_search_completed, path);
 }
 
+void VoxelAStarGrid3D::_b_on_async_batch_search_completed(Array paths) {
+	_is_running_async = false;
+	emit_signal(VoxelStringNames::get_singleton().async_batch_search_completed, paths);
+}
+
 void VoxelAStarGrid3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_terrain", "terrain"), &VoxelAStarGrid3D::set_terrain);
 
@@ -246,6 +397,9 @@ void VoxelAStarGrid3D::_bind_methods() {
 	ClassDB::bind_method(
 			D_METHOD("find_path_async", "from_position", "to_position"), &VoxelAStarGrid3D::find_path_async
 	);
+	ClassDB::bind_method(
+			D_METHOD("find_paths_async", "from_positions", "to_positions"), &VoxelAStarGrid3D::find_paths_async
+	);
 	ClassDB::bind_method(D_METHOD("is_running_async"), &VoxelAStarGrid3D::is_running_async);
 
 	ClassDB::bind_method(D_METHOD("debug_get_visited_positions"), &VoxelAStarGrid3D::debug_get_visited_positions);
@@ -254,10 +408,15 @@ void VoxelAStarGrid3D::_bind_methods() {
 	ClassDB::bind_method(
 			D_METHOD("_on_async_search_completed", "path"), &VoxelAStarGrid3D::_b_on_async_search_completed
 	);
+	ClassDB::bind_method(
+			D_METHOD("_on_async_batch_search_completed", "paths"),
+			&VoxelAStarGrid3D::_b_on_async_batch_search_completed
+	);
 
 	ADD_SIGNAL(MethodInfo(
 			"async_search_completed", PropertyInfo(Variant::ARRAY, "path", PROPERTY_HINT_ARRAY_TYPE, "Vector3i")
 	));
+	ADD_SIGNAL(MethodInfo("async_batch_search_completed", PropertyInfo(Variant::ARRAY, "paths")));
 }
 
 } // namespace zylann::voxel
@@ -4,7 +4,6 @@
 #include "../storage/voxel_buffer.h"
 #include "../storage/voxel_data.h"
 #include "../util/a_star_grid_3d.h"
-#include "../util/containers/dynamic_bitset.h"
 #include "../util/containers/std_vector.h"
 #include <atomic>
 
@@ -21,39 +20,24 @@ public:
 	// any time.
 	std::shared_ptr<VoxelData> data;
 
-	void init_cache();
+	// Makes sure the cache of solid voxels used by searches covers the current region and matches current voxels. It
+	// is only rebuilt if the region or voxels within it changed since it was built. It must be cleared if `data`
+	// changes.
+	void update_cache();
+
+	// Tells if the current cache can be used to search in the current region of `data`.
+	bool is_cache_up_to_date() const;
+
+	// Builds a cache of solid voxels covering a region. Voxels are read one data block at a time, so the cache is
+	// aligned with data blocks and no copy crosses block borders.
+	static std::shared_ptr<AStarGrid3D::RegionCache> build_region_cache(const VoxelData &data, const Box3i region);
 
 protected:
 	bool is_solid(Vector3i pos) override;
 
 private:
-	// We store a cache of solid bits for the whole pathfindable region.
-	// To minimize multithreaded access to the main voxel data, we only load chunks of bits as they are needed.
-
-	struct Chunk {
-		static const int SIZE_PO2 = 2;
-		static const int SIZE = 1 << SIZE_PO2;
-		static const int SIZE_MASK = SIZE - 1;
-
-		// 4x4x4 bits in ZXY order
-		uint64_t solid_bits = 0;
-
-		inline bool get_solid_bit(Vector3i rel) const {
-			const uint64_t i = Vector3iUtil::get_zxy_index(rel, Vector3i(SIZE, SIZE, SIZE));
-			// const unsigned int i = rel.y + (rel.x << 2) + (rel.z << 4);
-			return ((solid_bits >> i) & uint64_t(1)) != 0;
-		}
-	};
-
-	// Cached 3D bitmap
-	StdVector<Chunk> _grid_cache;
-	Vector3i _grid_cache_size;
-
-	// Tracks which chunks are loaded
-	DynamicBitset _grid_chunk_states;
-
-	// Temporary buffer used to read voxels from the main voxel storage
-	VoxelBuffer _voxel_buffer;
+	// Version of voxels in the region the current cache was built from
+	uint64_t _cache_voxels_version = 0;
 };
 
 // Godot-facing API for voxel grid A* pathfinding. Suitable for blocky terrains.
@@ -61,7 +45,7 @@ class VoxelAStarGrid3D : public RefCounted {
 	GDCLASS(VoxelAStarGrid3D, RefCounted)
 public:
 	// Bare bones at the moment. May need more configurations and customization.
-	// Also, it does not cache data between queries.
+	// Solid voxels of the region are cached between queries, until the region or voxels change.
 
 	void set_terrain(VoxelTerrain *node);
 
@@ -73,6 +57,10 @@ public:
 	void find_path_async(Vector3i from_position, Vector3i to_position);
 	bool is_running_async() const;
 
+	// Runs many searches in parallel on worker threads, all within the current region.
+	// Results are returned with the `async_batch_search_completed` signal, once all searches are complete.
+	void find_paths_async(TypedArray<Vector3i> from_positions, TypedArray<Vector3i> to_positions);
+
 	TypedArray<Vector3i> debug_get_visited_positions() const;
 
 private:
@@ -84,6 +72,7 @@ private:
 	void _b_set_region(AABB aabb);
 	AABB _b_get_region();
 	void _b_on_async_search_completed(TypedArray<Vector3i> path);
+	void _b_on_async_batch_search_completed(Array paths);
 
 	static void _bind_methods();
 
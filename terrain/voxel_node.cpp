@@ -1,14 +1,19 @@
 #include "voxel_node.h"
 #include "../constants/voxel_string_names.h"
 #include "../edition/voxel_tool.h"
+#include "../engine/voxel_engine_gd.h"
 #include "../generators/graph/voxel_generator_graph.h"
 #include "../generators/voxel_generator.h"
 #include "../meshers/blocky/voxel_mesher_blocky.h"
 #include "../meshers/voxel_mesher.h"
 #include "../storage/voxel_data.h"
 #include "../streams/voxel_stream.h"
+#include "../util/godot/classes/camera_3d.h"
+#include "../util/godot/classes/engine.h"
 #include "../util/godot/classes/script.h"
+#include "../util/godot/classes/viewport.h"
 #include "../util/godot/core/string.h"
+#include "../util/godot/core/transform_3d.h"
 
 #ifdef ZN_GODOT
 #include "../util/godot/core/callable_mp.h"
@@ -88,6 +93,33 @@ VoxelFormat VoxelNode::get_internal_format() const {
 	return VoxelFormat();
 }
 
+VoxelNode::LocalCameraInfo VoxelNode::get_local_camera_info() const {
+	LocalCameraInfo info;
+	if (!is_inside_tree()) {
+		return info;
+	}
+#ifdef TOOLS_ENABLED
+	if (Engine::get_singleton()->is_editor_hint()) {
+		// Falling back on the editor's camera
+		info.position = godot::VoxelEngine::get_singleton()->get_editor_camera_position();
+		info.forward = godot::VoxelEngine::get_singleton()->get_editor_camera_direction();
+		return info;
+	}
+#endif
+	const Viewport *vp = get_viewport();
+	if (vp == nullptr) {
+		return info;
+	}
+	const Camera3D *camera = vp->get_camera_3d();
+	if (camera == nullptr) {
+		return info;
+	}
+	Transform3D trans = camera->get_global_transform();
+	info.forward = get_forward(trans);
+	info.position = trans.get_origin();
+	return info;
+}
+
 void VoxelNode::on_format_changed() {
 	// Implemented in subclasses
 }
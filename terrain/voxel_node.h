@@ -81,6 +81,14 @@ protected:
 
 	VoxelFormat get_internal_format() const;
 
+	struct LocalCameraInfo {
+		Vector3 position;
+		Vector3 forward;
+	};
+
+	// Gets the camera of the viewport this node is in, in world space. Fields are zero if there is no camera.
+	LocalCameraInfo get_local_camera_info() const;
+
 private:
 	Ref<VoxelMesher> _b_get_mesher() {
 		return get_mesher();
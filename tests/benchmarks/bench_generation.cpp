@@ -0,0 +1,113 @@
+#include "bench_generation.h"
+#include "../../generators/graph/node_type_db.h"
+#include "../../generators/graph/voxel_generator_graph.h"
+#include "../../storage/voxel_buffer.h"
+#include "../../util/testing/benchmark.h"
+#include "../../util/testing/test_macros.h"
+
+#ifdef VOXEL_ENABLE_MODIFIERS
+#include "../../modifiers/voxel_modifier_sphere.h"
+#include "../../modifiers/voxel_modifier_stack.h"
+#endif
+
+namespace zylann::voxel::benchmarks {
+
+namespace {
+
+const int GENERATED_BLOCK_SIZE = 16;
+
+Ref<VoxelGeneratorGraph> create_sphere_on_plane_graph() {
+	Ref<VoxelGeneratorGraph> generator;
+	generator.instantiate();
+	VoxelGraphFunction &g = **generator->get_main_function();
+
+	const uint32_t n_in_x = g.create_node(VoxelGraphFunction::NODE_INPUT_X, Vector2());
+	const uint32_t n_in_y = g.create_node(VoxelGraphFunction::NODE_INPUT_Y, Vector2());
+	const uint32_t n_in_z = g.create_node(VoxelGraphFunction::NODE_INPUT_Z, Vector2());
+	const uint32_t n_out_sdf = g.create_node(VoxelGraphFunction::NODE_OUTPUT_SDF, Vector2());
+	const uint32_t n_plane = g.create_node(VoxelGraphFunction::NODE_SDF_PLANE, Vector2());
+	const uint32_t n_sphere = g.create_node(VoxelGraphFunction::NODE_SDF_SPHERE, Vector2());
+	const uint32_t n_union = g.create_node(VoxelGraphFunction::NODE_SDF_SMOOTH_UNION, Vector2());
+
+	uint32_t union_smoothness_id;
+	ZN_ASSERT(
+			pg::NodeTypeDB::get_singleton().try_get_param_index_from_name(
+					VoxelGraphFunction::NODE_SDF_SMOOTH_UNION, "smoothness", union_smoothness_id
+			)
+	);
+
+	g.add_connection(n_in_x, 0, n_sphere, 0);
+	g.add_connection(n_in_y, 0, n_sphere, 1);
+	g.add_connection(n_in_z, 0, n_sphere, 2);
+	g.set_node_default_input(n_sphere, 3, 6.f);
+	g.add_connection(n_in_y, 0, n_plane, 0);
+	g.set_node_default_input(n_plane, 1, 0.f);
+	g.add_connection(n_sphere, 0, n_union, 0);
+	g.add_connection(n_plane, 0, n_union, 1);
+	g.set_node_param(n_union, union_smoothness_id, 2.f);
+	g.add_connection(n_union, 0, n_out_sdf, 0);
+
+	const pg::CompilationResult result = generator->compile(false);
+	ZN_TEST_ASSERT(result.success);
+	return generator;
+}
+
+void bench_generator_graph(testing::BenchmarkRunner &runner) {
+	Ref<VoxelGeneratorGraph> generator = create_sphere_on_plane_graph();
+
+	VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+	voxels.create(Vector3iUtil::create(GENERATED_BLOCK_SIZE));
+
+	// Intersects the surface, so range analysis can't skip the whole block
+	const Vector3i origin = -Vector3iUtil::create(GENERATED_BLOCK_SIZE / 2);
+
+	runner.run(
+			"generator_graph_generate_block",
+			"voxels",
+			Vector3iUtil::get_volume_u64(voxels.get_size()),
+			[&generator, &voxels, origin]() {
+				generator->generate_block(VoxelGenerator::VoxelQueryData{ voxels, origin, 0 });
+			}
+	);
+}
+
+#ifdef VOXEL_ENABLE_MODIFIERS
+
+void bench_modifier_stack(testing::BenchmarkRunner &runner) {
+	VoxelModifierStack modifiers;
+
+	// A few overlapping spheres, some adding and some subtracting matter
+	for (int i = 0; i < 4; ++i) {
+		const uint32_t id = modifiers.allocate_id();
+		VoxelModifierSphere *sphere = modifiers.add_modifier<VoxelModifierSphere>(id);
+		sphere->set_radius(5.f);
+		sphere->set_transform(Transform3D(Basis(), Vector3(i * 3, 0, 0)));
+		sphere->set_operation(i % 2 == 0 ? VoxelModifierSdf::OP_ADD : VoxelModifierSdf::OP_SUBTRACT);
+	}
+
+	VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+	voxels.create(Vector3iUtil::create(GENERATED_BLOCK_SIZE));
+	const AABB aabb(Vector3(-4, -8, -8), Vector3(voxels.get_size()));
+
+	runner.run(
+			"modifier_stack_apply",
+			"voxels",
+			Vector3iUtil::get_volume_u64(voxels.get_size()),
+			[&modifiers, &voxels, aabb]() { //
+				modifiers.apply(voxels, aabb);
+			}
+	);
+}
+
+#endif
+
+} // namespace
+
+void bench_generation(testing::BenchmarkRunner &runner) {
+	bench_generator_graph(runner);
+#ifdef VOXEL_ENABLE_MODIFIERS
+	bench_modifier_stack(runner);
+#endif
+}
+
+} // namespace zylann::voxel::benchmarks
@@ -0,0 +1,14 @@
+#ifndef VOXEL_BENCH_GENERATION_H
+#define VOXEL_BENCH_GENERATION_H
+
+namespace zylann::testing {
+class BenchmarkRunner;
+}
+
+namespace zylann::voxel::benchmarks {
+
+void bench_generation(testing::BenchmarkRunner &runner);
+
+} // namespace zylann::voxel::benchmarks
+
+#endif // VOXEL_BENCH_GENERATION_H
@@ -0,0 +1,104 @@
+#include "bench_meshing.h"
+#include "../../meshers/cubes/voxel_mesher_cubes.h"
+#include "../../storage/voxel_buffer.h"
+#include "../../util/math/color8.h"
+#include "../../util/testing/benchmark.h"
+#include "bench_util.h"
+
+#ifdef VOXEL_ENABLE_SMOOTH_MESHING
+#include "../../meshers/transvoxel/voxel_mesher_transvoxel.h"
+#endif
+
+namespace zylann::voxel::benchmarks {
+
+namespace {
+
+// Size of the area to mesh, not including padding
+const int MESH_BLOCK_SIZE = 16;
+
+Vector3i get_padded_size(const VoxelMesher &mesher) {
+	return Vector3iUtil::create(MESH_BLOCK_SIZE + mesher.get_minimum_padding() + mesher.get_maximum_padding());
+}
+
+uint64_t get_mesh_block_volume() {
+	return Vector3iUtil::get_volume_u64(Vector3iUtil::create(MESH_BLOCK_SIZE));
+}
+
+void bench_mesher(testing::BenchmarkRunner &runner, const char *name, VoxelMesher &mesher, const VoxelBuffer &voxels) {
+	runner.run(name, "voxels", get_mesh_block_volume(), [&mesher, &voxels]() {
+		VoxelMesher::Output output;
+		const VoxelMesher::Input input{ voxels, nullptr, Vector3i(), 0, false, false, false };
+		mesher.build(output, input);
+	});
+}
+
+#ifdef VOXEL_ENABLE_SMOOTH_MESHING
+
+void bench_mesher_transvoxel(testing::BenchmarkRunner &runner) {
+	Ref<VoxelMesherTransvoxel> mesher;
+	mesher.instantiate();
+
+	VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+	voxels.create(get_padded_size(**mesher));
+	generate_hills_sdf(voxels, Vector3i());
+
+	bench_mesher(runner, "mesher_transvoxel", **mesher, voxels);
+}
+
+#endif
+
+void bench_mesher_blocky(testing::BenchmarkRunner &runner) {
+	Ref<VoxelMesherBlocky> mesher = create_blocky_mesher();
+
+	VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+	voxels.create(get_padded_size(**mesher));
+	generate_hills_blocky(voxels, Vector3i(), 1);
+
+	bench_mesher(runner, "mesher_blocky", **mesher, voxels);
+}
+
+void bench_mesher_cubes(testing::BenchmarkRunner &runner) {
+	Ref<VoxelMesherCubes> mesher;
+	mesher.instantiate();
+	mesher->set_color_mode(VoxelMesherCubes::COLOR_RAW);
+
+	VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+	voxels.create(get_padded_size(**mesher));
+	voxels.set_channel_depth(VoxelBuffer::CHANNEL_COLOR, VoxelBuffer::DEPTH_16_BIT);
+
+	// Hills with a few different colors, so greedy meshing can't merge everything
+	VoxelBuffer hills(VoxelBuffer::ALLOCATOR_DEFAULT);
+	hills.create(voxels.get_size());
+	generate_hills_blocky(hills, Vector3i(), 1);
+
+	const uint16_t colors[] = {
+		Color8(0, 255, 0, 255).to_u16(), //
+		Color8(128, 64, 0, 255).to_u16(), //
+		Color8(128, 128, 128, 255).to_u16()
+	};
+	const Vector3i size = voxels.get_size();
+	Vector3i pos;
+	for (pos.z = 0; pos.z < size.z; ++pos.z) {
+		for (pos.x = 0; pos.x < size.x; ++pos.x) {
+			for (pos.y = 0; pos.y < size.y; ++pos.y) {
+				if (hills.get_voxel(pos, VoxelBuffer::CHANNEL_TYPE) != 0) {
+					voxels.set_voxel(colors[(pos.x / 3 + pos.y + pos.z / 5) % 3], pos, VoxelBuffer::CHANNEL_COLOR);
+				}
+			}
+		}
+	}
+
+	bench_mesher(runner, "mesher_cubes", **mesher, voxels);
+}
+
+} // namespace
+
+void bench_meshing(testing::BenchmarkRunner &runner) {
+#ifdef VOXEL_ENABLE_SMOOTH_MESHING
+	bench_mesher_transvoxel(runner);
+#endif
+	bench_mesher_blocky(runner);
+	bench_mesher_cubes(runner);
+}
+
+} // namespace zylann::voxel::benchmarks
@@ -0,0 +1,133 @@
+#include "bench_misc.h"
+#include "../../constants/voxel_constants.h"
+#include "../../edition/raycast.h"
+#include "../../storage/voxel_data.h"
+#include "../../util/containers/std_vector.h"
+#include "../../util/memory/memory.h"
+#include "../../util/tasks/threaded_task_runner.h"
+#include "../../util/testing/benchmark.h"
+#include "bench_util.h"
+
+namespace zylann::voxel::benchmarks {
+
+namespace {
+
+// Area filled with data for raycasts, in blocks
+const Vector3i RAYCAST_AREA_BLOCKS(4, 2, 4);
+const unsigned int RAY_COUNT = 256;
+
+enum TerrainType { //
+	TERRAIN_SDF,
+	TERRAIN_BLOCKY
+};
+
+void fill_voxel_data(VoxelData &data, TerrainType type) {
+	const int block_size = 1 << constants::DEFAULT_BLOCK_SIZE_PO2;
+	// Centered vertically around the surface
+	const Vector3i origin_offset(0, -RAYCAST_AREA_BLOCKS.y / 2, 0);
+
+	Vector3i bpos;
+	for (bpos.z = 0; bpos.z < RAYCAST_AREA_BLOCKS.z; ++bpos.z) {
+		for (bpos.x = 0; bpos.x < RAYCAST_AREA_BLOCKS.x; ++bpos.x) {
+			for (bpos.y = 0; bpos.y < RAYCAST_AREA_BLOCKS.y; ++bpos.y) {
+				const Vector3i block_pos = bpos + origin_offset;
+
+				std::shared_ptr<VoxelBuffer> vb = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
+				vb->create(Vector3iUtil::create(block_size));
+				if (type == TERRAIN_SDF) {
+					generate_hills_sdf(*vb, block_pos * block_size);
+				} else {
+					generate_hills_blocky(*vb, block_pos * block_size, 1);
+				}
+
+				VoxelDataBlock block(vb, 0);
+				block.set_edited(true);
+				data.try_set_block(block_pos, block);
+			}
+		}
+	}
+}
+
+// Rays going down from above the terrain at various angles, so they all hit the surface
+void generate_rays(StdVector<Vector3> &origins, StdVector<Vector3> &directions) {
+	const int block_size = 1 << constants::DEFAULT_BLOCK_SIZE_PO2;
+	const float area_size_x = RAYCAST_AREA_BLOCKS.x * block_size;
+	const float area_size_z = RAYCAST_AREA_BLOCKS.z * block_size;
+
+	for (unsigned int i = 0; i < RAY_COUNT; ++i) {
+		const float tx = static_cast<float>(i % 16) / 16.f;
+		const float tz = static_cast<float>(i / 16) / 16.f;
+		origins.push_back(Vector3(4.f + tx * (area_size_x - 8.f), 15.f, 4.f + tz * (area_size_z - 8.f)));
+		directions.push_back(Vector3(tx - 0.5f, -1.f, tz - 0.5f).normalized());
+	}
+}
+
+void bench_raycast_sdf(testing::BenchmarkRunner &runner) {
+	VoxelData data;
+	fill_voxel_data(data, TERRAIN_SDF);
+
+	StdVector<Vector3> origins;
+	StdVector<Vector3> directions;
+	generate_rays(origins, directions);
+
+	runner.run("raycast_sdf", "rays", RAY_COUNT, [&data, &origins, &directions]() {
+		for (unsigned int i = 0; i < origins.size(); ++i) {
+			Ref<VoxelRaycastResult> hit = raycast_sdf(data, origins[i], directions[i], 64.f, 4, true);
+		}
+	});
+}
+
+void bench_raycast_blocky(testing::BenchmarkRunner &runner) {
+	VoxelData data;
+	fill_voxel_data(data, TERRAIN_BLOCKY);
+
+	Ref<VoxelMesherBlocky> mesher = create_blocky_mesher();
+
+	StdVector<Vector3> origins;
+	StdVector<Vector3> directions;
+	generate_rays(origins, directions);
+
+	runner.run("raycast_blocky", "rays", RAY_COUNT, [&data, &mesher, &origins, &directions]() {
+		for (unsigned int i = 0; i < origins.size(); ++i) {
+			Ref<VoxelRaycastResult> hit = raycast_blocky(data, **mesher, origins[i], directions[i], 64.f, 0xffffffff);
+		}
+	});
+}
+
+void bench_threaded_task_runner(testing::BenchmarkRunner &runner) {
+	// Tasks doing almost nothing, so we mostly measure the overhead of scheduling
+	class EmptyTask : public IThreadedTask {
+	public:
+		void run(ThreadedTaskContext &ctx) override {
+			++counter;
+		}
+
+		uint32_t counter = 0;
+	};
+
+	const unsigned int task_count = 10'000;
+
+	ThreadedTaskRunner task_runner;
+	task_runner.set_thread_count(4);
+	task_runner.set_name("Benchmark");
+
+	runner.run("threaded_task_runner_throughput", "tasks", task_count, [&task_runner, task_count]() {
+		for (unsigned int i = 0; i < task_count; ++i) {
+			task_runner.enqueue(ZN_NEW(EmptyTask), false);
+		}
+		task_runner.wait_for_all_tasks();
+		task_runner.dequeue_completed_tasks([](IThreadedTask *task) { //
+			ZN_DELETE(task);
+		});
+	});
+}
+
+} // namespace
+
+void bench_misc(testing::BenchmarkRunner &runner) {
+	bench_raycast_sdf(runner);
+	bench_raycast_blocky(runner);
+	bench_threaded_task_runner(runner);
+}
+
+} // namespace zylann::voxel::benchmarks
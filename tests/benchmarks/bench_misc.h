@@ -0,0 +1,14 @@
+#ifndef VOXEL_BENCH_MISC_H
+#define VOXEL_BENCH_MISC_H
+
+namespace zylann::testing {
+class BenchmarkRunner;
+}
+
+namespace zylann::voxel::benchmarks {
+
+void bench_misc(testing::BenchmarkRunner &runner);
+
+} // namespace zylann::voxel::benchmarks
+
+#endif // VOXEL_BENCH_MISC_H
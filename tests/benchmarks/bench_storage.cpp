@@ -0,0 +1,175 @@
+#include "bench_storage.h"
+#include "../../storage/voxel_buffer.h"
+#include "../../streams/region/voxel_stream_region_files.h"
+#include "../../streams/voxel_block_serializer.h"
+#include "../../util/containers/std_vector.h"
+#include "../../util/testing/benchmark.h"
+#include "../../util/testing/test_directory.h"
+#include "../../util/testing/test_macros.h"
+#include "bench_util.h"
+
+#ifdef VOXEL_ENABLE_SQLITE
+#include "../../streams/sqlite/voxel_stream_sqlite.h"
+#endif
+
+namespace zylann::voxel::benchmarks {
+
+namespace {
+
+const int BLOCK_SIZE_PO2 = 4;
+const int BLOCK_SIZE = 1 << BLOCK_SIZE_PO2;
+// Blocks saved and loaded by stream benchmarks, in a cube of 4x4x4
+const int STREAM_AREA_SIZE = 4;
+
+void generate_stream_blocks(StdVector<VoxelBuffer> &buffers, StdVector<Vector3i> &positions) {
+	Vector3i bpos;
+	for (bpos.z = 0; bpos.z < STREAM_AREA_SIZE; ++bpos.z) {
+		for (bpos.x = 0; bpos.x < STREAM_AREA_SIZE; ++bpos.x) {
+			for (bpos.y = 0; bpos.y < STREAM_AREA_SIZE; ++bpos.y) {
+				VoxelBuffer &vb = buffers.emplace_back(VoxelBuffer::ALLOCATOR_DEFAULT);
+				vb.create(Vector3iUtil::create(BLOCK_SIZE));
+				// Centered around the surface so blocks are not all uniform
+				generate_hills_sdf(vb, (bpos - Vector3i(0, STREAM_AREA_SIZE / 2, 0)) * BLOCK_SIZE);
+				positions.push_back(bpos);
+			}
+		}
+	}
+}
+
+template <typename TStream>
+void bench_stream(
+		testing::BenchmarkRunner &runner,
+		Ref<TStream> stream,
+		const char *save_name,
+		const char *load_name
+) {
+	StdVector<VoxelBuffer> buffers;
+	StdVector<Vector3i> positions;
+	generate_stream_blocks(buffers, positions);
+
+	runner.run(save_name, "blocks", buffers.size(), [&stream, &buffers, &positions]() {
+		StdVector<VoxelStream::VoxelQueryData> queries;
+		for (unsigned int i = 0; i < buffers.size(); ++i) {
+			queries.push_back(VoxelStream::VoxelQueryData{ buffers[i], positions[i], 0, VoxelStream::RESULT_ERROR });
+		}
+		stream->save_voxel_blocks(to_span(queries));
+		stream->flush();
+	});
+
+	StdVector<VoxelBuffer> loaded_buffers;
+	for (unsigned int i = 0; i < buffers.size(); ++i) {
+		loaded_buffers.emplace_back(VoxelBuffer::ALLOCATOR_DEFAULT);
+	}
+
+	runner.run(load_name, "blocks", buffers.size(), [&stream, &loaded_buffers, &positions]() {
+		StdVector<VoxelStream::VoxelQueryData> queries;
+		for (unsigned int i = 0; i < loaded_buffers.size(); ++i) {
+			queries.push_back(
+					VoxelStream::VoxelQueryData{ loaded_buffers[i], positions[i], 0, VoxelStream::RESULT_ERROR }
+			);
+		}
+		stream->load_voxel_blocks(to_span(queries));
+	});
+}
+
+void bench_voxel_buffer(testing::BenchmarkRunner &runner) {
+	VoxelBuffer src(VoxelBuffer::ALLOCATOR_DEFAULT);
+	src.create(Vector3iUtil::create(32));
+	generate_hills_sdf(src, Vector3i(0, -16, 0));
+
+	const uint64_t volume = Vector3iUtil::get_volume_u64(src.get_size());
+
+	VoxelBuffer dst(VoxelBuffer::ALLOCATOR_DEFAULT);
+	dst.create(src.get_size());
+
+	runner.run("voxel_buffer_copy_channels_from", "voxels", volume, [&src, &dst]() { //
+		dst.copy_channels_from(src);
+	});
+
+	runner.run("voxel_buffer_copy_channel_from_box", "voxels", 16 * 16 * 16, [&src, &dst]() {
+		dst.copy_channel_from(src, Vector3i(8, 8, 8), Vector3i(24, 24, 24), Vector3i(), VoxelBuffer::CHANNEL_SDF);
+	});
+
+	VoxelBuffer half(VoxelBuffer::ALLOCATOR_DEFAULT);
+	half.create(Vector3iUtil::create(16));
+
+	runner.run("voxel_buffer_downscale_to", "voxels", volume, [&src, &half]() {
+		src.downscale_to(half, Vector3i(), src.get_size(), Vector3i());
+	});
+}
+
+void bench_block_serializer(testing::BenchmarkRunner &runner) {
+	VoxelBuffer vb(VoxelBuffer::ALLOCATOR_DEFAULT);
+	vb.create(Vector3iUtil::create(BLOCK_SIZE));
+	generate_hills_sdf(vb, Vector3i(0, 0, 0));
+
+	runner.run("block_serializer_serialize", "blocks", 1, [&vb]() {
+		const BlockSerializer::SerializeResult result = BlockSerializer::serialize(vb);
+		ZN_TEST_ASSERT(result.success);
+	});
+
+	struct CompressionMode {
+		CompressedData::Compression mode;
+		const char *serialize_name;
+		const char *deserialize_name;
+	};
+	const CompressionMode modes[] = {
+		{ CompressedData::COMPRESSION_LZ4, "block_serializer_serialize_lz4", "block_serializer_deserialize_lz4" },
+		{ CompressedData::COMPRESSION_ZSTD, "block_serializer_serialize_zstd", "block_serializer_deserialize_zstd" }
+	};
+
+	for (const CompressionMode &mode : modes) {
+		runner.run(mode.serialize_name, "blocks", 1, [&vb, &mode]() {
+			const BlockSerializer::SerializeResult result = BlockSerializer::serialize_and_compress(vb, mode.mode);
+			ZN_TEST_ASSERT(result.success);
+		});
+
+		// Result data is thread-local and gets overwritten by the next call, so keep a copy
+		const StdVector<uint8_t> data = BlockSerializer::serialize_and_compress(vb, mode.mode).data;
+		VoxelBuffer loaded(VoxelBuffer::ALLOCATOR_DEFAULT);
+
+		runner.run(mode.deserialize_name, "blocks", 1, [&data, &loaded]() {
+			ZN_TEST_ASSERT(BlockSerializer::decompress_and_deserialize(to_span(data), loaded));
+		});
+	}
+}
+
+void bench_stream_region_files(testing::BenchmarkRunner &runner) {
+	zylann::testing::TestDirectory test_dir;
+	ZN_TEST_ASSERT(test_dir.is_valid());
+
+	Ref<VoxelStreamRegionFiles> stream;
+	stream.instantiate();
+	stream->set_block_size_po2(BLOCK_SIZE_PO2);
+	stream->set_directory(test_dir.get_path());
+
+	bench_stream(runner, stream, "stream_region_files_save", "stream_region_files_load");
+}
+
+#ifdef VOXEL_ENABLE_SQLITE
+
+void bench_stream_sqlite(testing::BenchmarkRunner &runner) {
+	zylann::testing::TestDirectory test_dir;
+	ZN_TEST_ASSERT(test_dir.is_valid());
+
+	Ref<VoxelStreamSQLite> stream;
+	stream.instantiate();
+	stream->set_database_path(test_dir.get_path().path_join("database.sqlite"));
+
+	bench_stream(runner, stream, "stream_sqlite_save", "stream_sqlite_load");
+}
+
+#endif
+
+} // namespace
+
+void bench_storage(testing::BenchmarkRunner &runner) {
+	bench_voxel_buffer(runner);
+	bench_block_serializer(runner);
+	bench_stream_region_files(runner);
+#ifdef VOXEL_ENABLE_SQLITE
+	bench_stream_sqlite(runner);
+#endif
+}
+
+} // namespace zylann::voxel::benchmarks
@@ -0,0 +1,68 @@
+#include "bench_util.h"
+#include "../../meshers/blocky/voxel_blocky_library.h"
+#include "../../meshers/blocky/voxel_blocky_model_cube.h"
+#include "../../meshers/blocky/voxel_blocky_model_empty.h"
+#include "../../storage/voxel_buffer.h"
+#include "../../util/math/funcs.h"
+
+namespace zylann::voxel::benchmarks {
+
+namespace {
+
+inline float get_hills_height(int x, int z) {
+	return 8.f + 4.f * Math::sin(x * 0.21f) * Math::cos(z * 0.17f) + 2.f * Math::sin((x + z) * 0.53f);
+}
+
+} // namespace
+
+void generate_hills_sdf(VoxelBuffer &vb, Vector3i origin) {
+	const Vector3i size = vb.get_size();
+	Vector3i pos;
+	for (pos.z = 0; pos.z < size.z; ++pos.z) {
+		for (pos.x = 0; pos.x < size.x; ++pos.x) {
+			const float height = get_hills_height(origin.x + pos.x, origin.z + pos.z);
+			for (pos.y = 0; pos.y < size.y; ++pos.y) {
+				const float sd = static_cast<float>(origin.y + pos.y) - height;
+				vb.set_voxel_f(sd, pos, VoxelBuffer::CHANNEL_SDF);
+			}
+		}
+	}
+}
+
+void generate_hills_blocky(VoxelBuffer &vb, Vector3i origin, uint32_t type_id) {
+	const Vector3i size = vb.get_size();
+	Vector3i pos;
+	for (pos.z = 0; pos.z < size.z; ++pos.z) {
+		for (pos.x = 0; pos.x < size.x; ++pos.x) {
+			const float height = get_hills_height(origin.x + pos.x, origin.z + pos.z);
+			for (pos.y = 0; pos.y < size.y; ++pos.y) {
+				if (origin.y + pos.y < height) {
+					vb.set_voxel(type_id, pos, VoxelBuffer::CHANNEL_TYPE);
+				}
+			}
+		}
+	}
+}
+
+Ref<VoxelMesherBlocky> create_blocky_mesher() {
+	Ref<VoxelBlockyLibrary> library;
+	library.instantiate();
+	{
+		Ref<VoxelBlockyModelEmpty> air;
+		air.instantiate();
+		library->add_model(air);
+	}
+	{
+		Ref<VoxelBlockyModelCube> cube;
+		cube.instantiate();
+		library->add_model(cube);
+	}
+	library->bake();
+
+	Ref<VoxelMesherBlocky> mesher;
+	mesher.instantiate();
+	mesher->set_library(library);
+	return mesher;
+}
+
+} // namespace zylann::voxel::benchmarks
@@ -0,0 +1,26 @@
+#ifndef VOXEL_BENCH_UTIL_H
+#define VOXEL_BENCH_UTIL_H
+
+#include "../../meshers/blocky/voxel_mesher_blocky.h"
+#include "../../util/math/vector3i.h"
+
+namespace zylann::voxel {
+
+class VoxelBuffer;
+
+namespace benchmarks {
+
+// Fills the SDF channel with rolling hills, so that data is not uniform and produces meshes.
+// `origin` is the position of the buffer in the world, so neighbor buffers are continuous.
+void generate_hills_sdf(VoxelBuffer &vb, Vector3i origin);
+
+// Same shape as `generate_hills_sdf`, but with blocky voxels of the given type.
+void generate_hills_blocky(VoxelBuffer &vb, Vector3i origin, uint32_t type_id);
+
+// Creates a blocky mesher with air at index 0 and a cube at index 1.
+Ref<VoxelMesherBlocky> create_blocky_mesher();
+
+} // namespace benchmarks
+} // namespace zylann::voxel
+
+#endif // VOXEL_BENCH_UTIL_H
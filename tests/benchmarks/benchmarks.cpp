@@ -0,0 +1,52 @@
+#include "benchmarks.h"
+#include "../../constants/version.gen.h"
+#include "../../util/godot/core/array.h"
+#include "../../util/godot/core/dictionary.h"
+#include "../../util/io/log.h"
+#include "../../util/profiling.h"
+#include "../../util/testing/benchmark.h"
+#include "../../util/testing/test_options.h"
+
+#include "bench_generation.h"
+#include "bench_meshing.h"
+#include "bench_misc.h"
+#include "bench_storage.h"
+
+namespace zylann::voxel::benchmarks {
+
+#define VOXEL_BENCHMARK(fname)                                                                                         \
+	if (runner.can_run(#fname)) {                                                                                      \
+		ZN_PROFILE_SCOPE_NAMED(#fname);                                                                                \
+		fname(runner);                                                                                                 \
+	}
+
+String run_voxel_benchmarks(const testing::TestOptions &options) {
+	print_line("------------ Voxel benchmarks begin -------------");
+
+	testing::BenchmarkRunner runner(options);
+
+	VOXEL_BENCHMARK(bench_storage);
+	VOXEL_BENCHMARK(bench_meshing);
+	VOXEL_BENCHMARK(bench_generation);
+	VOXEL_BENCHMARK(bench_misc);
+
+	print_line("------------ Voxel benchmarks end -------------");
+
+	// Version information allows comparing results across commits
+	Dictionary root;
+	const String version = String("{0}.{1}.{2}-{3}").format(
+			varray(VOXEL_VERSION_MAJOR, VOXEL_VERSION_MINOR, VOXEL_VERSION_PATCH, VOXEL_VERSION_STATUS)
+	);
+	root["version"] = version;
+	root["edition"] = VOXEL_VERSION_EDITION;
+	root["git_hash"] = VOXEL_VERSION_GIT_HASH;
+#ifdef DEBUG_ENABLED
+	root["debug"] = true;
+#else
+	root["debug"] = false;
+#endif
+
+	return runner.to_json(root);
+}
+
+} // namespace zylann::voxel::benchmarks
@@ -0,0 +1,20 @@
+#ifndef VOXEL_BENCHMARKS_H
+#define VOXEL_BENCHMARKS_H
+
+#include "../../util/godot/core/string.h"
+
+namespace zylann {
+
+namespace testing {
+class TestOptions;
+}
+
+namespace voxel::benchmarks {
+
+// Runs benchmarks allowed by the given options, and returns results in JSON format.
+String run_voxel_benchmarks(const testing::TestOptions &options);
+
+} // namespace voxel::benchmarks
+} // namespace zylann
+
+#endif // VOXEL_BENCHMARKS_H
@@ -7,6 +7,7 @@
 #include "util/test_expression_parser.h"
 #include "util/test_flat_map.h"
 #include "util/test_island_finder.h"
+#include "util/test_linear_allocator.h"
 #include "util/test_math_funcs.h"
 #include "util/test_noise.h"
 #include "util/test_slot_map.h"
@@ -14,15 +15,24 @@
 #include "util/test_string_funcs.h"
 #include "util/test_threaded_task_runner.h"
 
+#include "voxel/test_async_edit_queue.h"
 #include "voxel/test_block_serializer.h"
+#include "voxel/test_clipbox_streaming.h"
 #include "voxel/test_curve_range.h"
 #include "voxel/test_edition_funcs.h"
+#include "voxel/test_load_block_data_task.h"
+#include "voxel/test_mesh_apply_queue.h"
+#include "voxel/test_mesh_block_cache.h"
+#include "voxel/test_mesh_block_task.h"
 #include "voxel/test_octree.h"
 #include "voxel/test_raycast.h"
 #include "voxel/test_region_file.h"
 #include "voxel/test_storage_funcs.h"
+#include "voxel/test_voxel_a_star_grid_3d.h"
+#include "voxel/test_voxel_box_mover.h"
 #include "voxel/test_voxel_buffer.h"
 #include "voxel/test_voxel_data_map.h"
+#include "voxel/test_voxel_generator_multipass_cb.h"
 #include "voxel/test_voxel_graph.h"
 #include "voxel/test_voxel_instancer.h"
 #include "voxel/test_voxel_mesher_cubes.h"
@@ -74,6 +84,24 @@ void run_voxel_tests(const testing::TestOptions &options) {
 	VOXEL_TEST(test_voxel_data_map_paste_mask);
 	VOXEL_TEST(test_voxel_data_map_paste_dst_mask);
 	VOXEL_TEST(test_voxel_data_map_copy);
+	VOXEL_TEST(test_voxel_data_save_copy_on_write);
+	VOXEL_TEST(test_voxel_data_mesh_snapshot);
+	VOXEL_TEST(test_voxel_data_edit_journal);
+	VOXEL_TEST(test_voxel_data_edit_journal_multiple_blocks);
+	VOXEL_TEST(test_voxel_data_edit_journal_capacity);
+	VOXEL_TEST(test_voxel_data_get_voxels_generated);
+	VOXEL_TEST(test_voxel_data_pre_generate_box);
+	VOXEL_TEST(test_voxel_data_pre_generate_to_stream);
+	VOXEL_TEST(test_voxel_data_read_view);
+	VOXEL_TEST(test_a_star_grid_3d_region_cache);
+	VOXEL_TEST(test_voxel_a_star_grid_3d_cache_reuse);
+	VOXEL_TEST(test_voxel_a_star_grid_3d_cache_invalidation);
+	VOXEL_TEST(test_voxel_box_mover_get_motions);
+	VOXEL_TEST(test_voxel_generator_multipass_cb_spilling);
+	VOXEL_TEST(test_voxel_generator_multipass_cb_unspill_failure);
+	VOXEL_TEST(test_voxel_generator_multipass_cb_spill_throttling);
+	VOXEL_TEST(test_voxel_generator_multipass_cb_subpass_waiters);
+	VOXEL_TEST(test_voxel_generator_multipass_cb_schedule_all_subpass_waiters);
 	VOXEL_TEST(test_encode_weights_packed_u16);
 	VOXEL_TEST(test_copy_3d_region_zxy);
 	VOXEL_TEST(test_voxel_graph_invalid_connection);
@@ -114,6 +142,7 @@ void run_voxel_tests(const testing::TestOptions &options) {
 	VOXEL_TEST(test_voxel_graph_empty_image);
 	VOXEL_TEST(test_voxel_graph_4_default_weights);
 	VOXEL_TEST(test_island_finder);
+	VOXEL_TEST(test_block_island_finder);
 	VOXEL_TEST(test_unordered_remove_if);
 	VOXEL_TEST(test_instance_data_serialization);
 	VOXEL_TEST(test_transform_3d_array_zxy);
@@ -134,11 +163,21 @@ void run_voxel_tests(const testing::TestOptions &options) {
 	VOXEL_TEST(test_flat_map);
 	VOXEL_TEST(test_expression_parser);
 	VOXEL_TEST(test_voxel_mesher_cubes);
+	VOXEL_TEST(test_mesh_apply_queue);
+	VOXEL_TEST(test_async_edit_queue);
+	VOXEL_TEST(test_load_block_data_task_batcher);
+	VOXEL_TEST(test_load_block_data_task_cancellation);
+	VOXEL_TEST(test_mesh_block_cache);
+	VOXEL_TEST(test_clipbox_streaming_entering_cells_by_distance);
+	VOXEL_TEST(test_build_mesh_compressed_positions);
+	VOXEL_TEST(test_build_mesh_compressed_normals);
 	VOXEL_TEST(test_threaded_task_runner_misc);
 	VOXEL_TEST(test_threaded_task_runner_debug_names);
 	VOXEL_TEST(test_task_priority_values);
+	VOXEL_TEST(test_threaded_task_runner_metrics);
 #ifdef VOXEL_ENABLE_MESH_SDF
 	VOXEL_TEST(test_voxel_mesh_sdf_issue463);
+	VOXEL_TEST(test_voxel_mesh_sdf_bvh);
 #endif
 #ifdef VOXEL_ENABLE_SMOOTH_MESHING
 #ifdef VOXEL_ENABLE_GPU
@@ -146,6 +185,7 @@ void run_voxel_tests(const testing::TestOptions &options) {
 #endif
 #endif
 	VOXEL_TEST(test_slot_map);
+	VOXEL_TEST(test_linear_allocator);
 	VOXEL_TEST(test_box_blur);
 	VOXEL_TEST(test_threaded_task_postponing);
 	VOXEL_TEST(test_spatial_lock_misc);
@@ -158,8 +198,13 @@ void run_voxel_tests(const testing::TestOptions &options) {
 	VOXEL_TEST(test_voxel_stream_sqlite_basic);
 	VOXEL_TEST(test_voxel_stream_sqlite_coordinate_format);
 	VOXEL_TEST(test_voxel_stream_sqlite_transaction_recovery);
+	VOXEL_TEST(test_voxel_stream_sqlite_cache_flush_threshold);
+	VOXEL_TEST(test_voxel_stream_sqlite_batched_queries);
 #endif
 	VOXEL_TEST(test_sdf_hemisphere);
+	VOXEL_TEST(test_brush_batch);
+	VOXEL_TEST(test_brush_batch_sparse);
+	VOXEL_TEST(test_voxel_tool_terrain_undo_redo);
 	VOXEL_TEST(test_fnl_range);
 	VOXEL_TEST(test_voxel_buffer_set_channel_bytes);
 	VOXEL_TEST(test_voxel_buffer_get_channel_bytes);
@@ -173,6 +218,7 @@ void run_voxel_tests(const testing::TestOptions &options) {
 #endif
 #ifdef VOXEL_ENABLE_INSTANCER
 	VOXEL_TEST(test_instance_generator_material_filter_issue774);
+	VOXEL_TEST(test_instance_generator_filters);
 #endif
 	VOXEL_TEST(test_spot_noise);
 	VOXEL_TEST(test_voxel_graph_multiple_function_instances);
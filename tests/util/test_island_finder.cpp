@@ -1,4 +1,5 @@
 #include "test_island_finder.h"
+#include "../../util/block_island_finder.h"
 #include "../../util/containers/std_vector.h"
 #include "../../util/island_finder.h"
 #include "../../util/testing/test_macros.h"
@@ -86,4 +87,79 @@ void test_island_finder() {
 	ZN_TEST_ASSERT(label_count == 3);
 }
 
+void test_block_island_finder() {
+	// Size is not a multiple of blocks on purpose
+	const Vector3i grid_size(21, 19, 23);
+
+	StdVector<uint8_t> grid;
+	grid.resize(Vector3iUtil::get_volume_u64(grid_size), 0);
+
+	auto fill_box = [&grid, grid_size](Box3i box) {
+		box.for_each_cell_zxy([&grid, grid_size](Vector3i pos) {
+			grid[Vector3iUtil::get_zxy_index(pos, grid_size)] = 1;
+		});
+	};
+
+	// Ground, covering a lot of full blocks
+	fill_box(Box3i(Vector3i(0, 0, 0), Vector3i(21, 9, 23)));
+	// Floating boxes crossing block boundaries
+	fill_box(Box3i(Vector3i(2, 11, 2), Vector3i(3, 3, 3)));
+	fill_box(Box3i(Vector3i(6, 12, 7), Vector3i(5, 2, 6)));
+	// Plate connected to the ground by a thin pillar
+	fill_box(Box3i(Vector3i(15, 9, 15), Vector3i(1, 5, 1)));
+	fill_box(Box3i(Vector3i(13, 14, 13), Vector3i(5, 2, 5)));
+	// U shape whose branches only join in another block
+	fill_box(Box3i(Vector3i(2, 17, 12), Vector3i(1, 1, 10)));
+	fill_box(Box3i(Vector3i(10, 17, 12), Vector3i(1, 1, 10)));
+	fill_box(Box3i(Vector3i(2, 17, 21), Vector3i(9, 1, 1)));
+	// Single voxel
+	grid[Vector3iUtil::get_zxy_index(Vector3i(18, 17, 3), grid_size)] = 1;
+
+	StdVector<uint8_t> expected_output;
+	expected_output.resize(grid.size());
+	unsigned int expected_label_count = 0;
+	{
+		IslandFinder island_finder;
+		island_finder.scan_3d(
+				Box3i(Vector3i(), grid_size),
+				[&grid, grid_size](Vector3i pos) { return grid[Vector3iUtil::get_zxy_index(pos, grid_size)] != 0; },
+				to_span(expected_output),
+				&expected_label_count
+		);
+	}
+	ZN_TEST_ASSERT(expected_label_count == 5);
+
+	StdVector<uint8_t> output;
+	output.resize(grid.size());
+	unsigned int label_count = 0;
+	{
+		BlockIslandFinder island_finder;
+		ZN_TEST_ASSERT(island_finder.scan_3d(to_span(grid), grid_size, to_span(output), label_count));
+	}
+	ZN_TEST_ASSERT(label_count == expected_label_count);
+
+	// Labels can be numbered differently, but they must partition cells the same way
+	FixedArray<uint8_t, 256> label_map;
+	fill(label_map, uint8_t(0));
+	for (unsigned int i = 0; i < grid.size(); ++i) {
+		const uint8_t label = output[i];
+		const uint8_t expected_label = expected_output[i];
+		ZN_TEST_ASSERT((label == 0) == (expected_label == 0));
+		if (label == 0) {
+			continue;
+		}
+		ZN_TEST_ASSERT(label <= label_count);
+		if (label_map[label] == 0) {
+			label_map[label] = expected_label;
+		} else {
+			ZN_TEST_ASSERT(label_map[label] == expected_label);
+		}
+	}
+	for (unsigned int a = 1; a <= label_count; ++a) {
+		for (unsigned int b = a + 1; b <= label_count; ++b) {
+			ZN_TEST_ASSERT(label_map[a] != label_map[b]);
+		}
+	}
+}
+
 } // namespace zylann::tests
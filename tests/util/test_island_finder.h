@@ -4,6 +4,7 @@
 namespace zylann::tests {
 
 void test_island_finder();
+void test_block_island_finder();
 
 } // namespace zylann::tests
 
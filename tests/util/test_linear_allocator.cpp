@@ -0,0 +1,59 @@
+#include "test_linear_allocator.h"
+#include "../../util/memory/linear_allocator.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::tests {
+
+void test_linear_allocator() {
+	LinearAllocator allocator(1024);
+	ZN_TEST_ASSERT(allocator.get_used_size() == 0);
+
+	{
+		LinearAllocatorScope scope(allocator);
+
+		StdTempVector<int> values(allocator);
+		// Enough to span several chunks
+		for (int i = 0; i < 1000; ++i) {
+			values.push_back(i);
+		}
+		for (int i = 0; i < 1000; ++i) {
+			ZN_TEST_ASSERT(values[i] == i);
+		}
+		ZN_TEST_ASSERT(allocator.get_chunk_count() > 1);
+
+		void *aligned = allocator.allocate(3, 64);
+		ZN_TEST_ASSERT((reinterpret_cast<uintptr_t>(aligned) % 64) == 0);
+
+		const size_t used_before_nested = allocator.get_used_size();
+		{
+			LinearAllocatorScope nested_scope(allocator);
+			StdTempVector<double> nested(allocator);
+			nested.resize(100);
+			ZN_TEST_ASSERT(allocator.get_used_size() > used_before_nested);
+		}
+		ZN_TEST_ASSERT(allocator.get_used_size() == used_before_nested);
+	}
+
+	ZN_TEST_ASSERT(allocator.get_used_size() == 0);
+
+	// Chunks are kept for re-use, until trimmed
+	const size_t capacity = allocator.get_capacity();
+	ZN_TEST_ASSERT(capacity > 0);
+	{
+		LinearAllocatorScope scope(allocator);
+		StdTempVector<int> values(allocator);
+		values.resize(100);
+		ZN_TEST_ASSERT(allocator.get_capacity() == capacity);
+	}
+
+	allocator.trim(0);
+	ZN_TEST_ASSERT(allocator.get_capacity() == 0);
+	ZN_TEST_ASSERT(allocator.get_chunk_count() == 0);
+
+	// Freeing the last allocation gives its memory back right away
+	void *p = allocator.allocate(16, 8);
+	allocator.deallocate(p, 16);
+	ZN_TEST_ASSERT(allocator.get_used_size() == 0);
+}
+
+} // namespace zylann::tests
@@ -461,4 +461,118 @@ void test_threaded_task_postponing() {
 #endif
 }
 
+void test_threaded_task_runner_metrics() {
+	{
+		DurationHistogram histogram;
+		histogram.add(0);
+		histogram.add(1);
+		histogram.add(3);
+		histogram.add(100);
+		const DurationHistogram::Snapshot s = histogram.get_snapshot();
+		ZN_TEST_ASSERT(s.count == 4);
+		ZN_TEST_ASSERT(s.total_usec == 104);
+		ZN_TEST_ASSERT(s.max_usec == 100);
+		ZN_TEST_ASSERT(s.buckets[0] == 1);
+		ZN_TEST_ASSERT(s.buckets[1] == 1);
+		ZN_TEST_ASSERT(s.buckets[2] == 1);
+		ZN_TEST_ASSERT(s.buckets[DurationHistogram::get_bucket_index(100)] == 1);
+		ZN_TEST_ASSERT(s.get_percentile_usec(0.5f) == 4);
+		// Bounded by the actual maximum
+		ZN_TEST_ASSERT(s.get_percentile_usec(1.f) == 100);
+	}
+
+	class SleepTask : public IThreadedTask {
+	public:
+		void run(ThreadedTaskContext &ctx) override {
+			Thread::sleep_usec(1000);
+		}
+		const char *get_debug_name() const override {
+			return "SleepTask";
+		}
+	};
+
+	class CancelledTask : public IThreadedTask {
+	public:
+		void run(ThreadedTaskContext &ctx) override {
+			ZN_TEST_ASSERT_MSG(false, "Cancelled task should not run");
+		}
+		bool is_cancelled() override {
+			return true;
+		}
+		const char *get_debug_name() const override {
+			return "CancelledTask";
+		}
+	};
+
+	class PostponedOnceTask : public IThreadedTask {
+	public:
+		bool postponed = false;
+
+		void run(ThreadedTaskContext &ctx) override {
+			if (!postponed) {
+				postponed = true;
+				ctx.status = ThreadedTaskContext::STATUS_POSTPONED;
+			}
+		}
+		const char *get_debug_name() const override {
+			return "PostponedOnceTask";
+		}
+	};
+
+	ThreadedTaskRunner runner;
+	runner.set_thread_count(2);
+	runner.set_name("Test");
+
+	for (unsigned int i = 0; i < 8; ++i) {
+		runner.enqueue(ZN_NEW(SleepTask), false);
+	}
+	for (unsigned int i = 0; i < 4; ++i) {
+		runner.enqueue(ZN_NEW(CancelledTask), false);
+	}
+	runner.enqueue(ZN_NEW(PostponedOnceTask), false);
+
+	runner.wait_for_all_tasks();
+	runner.dequeue_completed_tasks([](IThreadedTask *task) { //
+		ZN_DELETE(task);
+	});
+
+	const TaskMetrics &metrics = runner.get_metrics();
+	ZN_TEST_ASSERT(metrics.get_task_type_count() == 3);
+
+	bool found_sleep = false;
+	bool found_cancelled = false;
+	bool found_postponed = false;
+
+	for (unsigned int i = 0; i < metrics.get_task_type_count(); ++i) {
+		const TaskMetrics::TaskType &tt = metrics.get_task_type(i);
+		const StdString name = tt.name;
+
+		if (name == "SleepTask") {
+			found_sleep = true;
+			ZN_TEST_ASSERT(tt.completed_count == 8);
+			ZN_TEST_ASSERT(tt.cancelled_count == 0);
+			const DurationHistogram::Snapshot run = tt.run.get_snapshot();
+			ZN_TEST_ASSERT(run.count == 8);
+			ZN_TEST_ASSERT(run.max_usec >= 1000);
+			ZN_TEST_ASSERT(tt.queue_wait.get_snapshot().count == 8);
+
+		} else if (name == "CancelledTask") {
+			found_cancelled = true;
+			ZN_TEST_ASSERT(tt.cancelled_count == 4);
+			ZN_TEST_ASSERT(tt.completed_count == 0);
+			ZN_TEST_ASSERT(tt.run.get_snapshot().count == 0);
+
+		} else if (name == "PostponedOnceTask") {
+			found_postponed = true;
+			ZN_TEST_ASSERT(tt.postponed_count == 1);
+			ZN_TEST_ASSERT(tt.completed_count == 1);
+			ZN_TEST_ASSERT(tt.run.get_snapshot().count == 2);
+		}
+	}
+
+	ZN_TEST_ASSERT(found_sleep);
+	ZN_TEST_ASSERT(found_cancelled);
+	ZN_TEST_ASSERT(found_postponed);
+}
+
 } // namespace zylann::tests
@@ -7,6 +7,7 @@ void test_threaded_task_runner_misc();
 void test_threaded_task_runner_debug_names();
 void test_task_priority_values();
 void test_threaded_task_postponing();
+void test_threaded_task_runner_metrics();
 
 } // namespace zylann::tests
 
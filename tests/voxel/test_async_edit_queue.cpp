@@ -0,0 +1,138 @@
+#include "test_async_edit_queue.h"
+#include "../../terrain/fixed_lod/async_edit_queue.h"
+#include "../../util/memory/linear_allocator.h"
+#include "../../util/tasks/async_dependency_tracker.h"
+#include "../../util/tasks/threaded_task.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::voxel::tests {
+
+void test_async_edit_queue() {
+	class EditTask : public IThreadedTask {
+	public:
+		EditTask(unsigned int p_id, std::shared_ptr<AsyncDependencyTracker> p_tracker) :
+				id(p_id), tracker(p_tracker) {}
+
+		const char *get_debug_name() const override {
+			return "TestAsyncEdit";
+		}
+
+		void run(ThreadedTaskContext &ctx) override {
+			tracker->post_complete();
+		}
+
+		unsigned int id;
+		std::shared_ptr<AsyncDependencyTracker> tracker;
+	};
+
+	struct L {
+		static std::shared_ptr<AsyncDependencyTracker> push(AsyncEditQueue &queue, unsigned int id, Box3i box) {
+			std::shared_ptr<AsyncDependencyTracker> tracker = make_shared_instance<AsyncDependencyTracker>(1);
+			queue.push(ZN_NEW(EditTask(id, tracker)), box, tracker);
+			return tracker;
+		}
+
+		// Runs tasks as the thread pool would, and returns their IDs in the order they were scheduled
+		static StdVector<unsigned int> run(StdVector<IThreadedTask *> &tasks) {
+			StdVector<unsigned int> ids;
+			for (IThreadedTask *task : tasks) {
+				ids.push_back(static_cast<EditTask *>(task)->id);
+				ThreadedTaskContext ctx(0, TaskPriority(), get_tls_temp_allocator());
+				task->run(ctx);
+				ZN_DELETE(task);
+			}
+			tasks.clear();
+			return ids;
+		}
+	};
+
+	const Box3i box_a(Vector3i(0, 0, 0), Vector3i(10, 10, 10));
+	const Box3i box_a_overlap(Vector3i(5, 5, 5), Vector3i(10, 10, 10));
+	const Box3i box_b(Vector3i(100, 0, 0), Vector3i(10, 10, 10));
+
+	StdVector<IThreadedTask *> tasks;
+	StdVector<Box3i> completed_boxes;
+
+	// Non-overlapping edits are scheduled together, overlapping ones wait for the edit pushed before them
+	{
+		AsyncEditQueue queue;
+		std::shared_ptr<AsyncDependencyTracker> tracker0 = L::push(queue, 0, box_a);
+		std::shared_ptr<AsyncDependencyTracker> tracker1 = L::push(queue, 1, box_a_overlap);
+		std::shared_ptr<AsyncDependencyTracker> tracker2 = L::push(queue, 2, box_b);
+		// Overlaps with edit 1 only, which is still pending
+		std::shared_ptr<AsyncDependencyTracker> tracker3 =
+				L::push(queue, 3, Box3i(Vector3i(12, 12, 12), Vector3i(2, 2, 2)));
+
+		queue.process(tasks, completed_boxes);
+		ZN_TEST_ASSERT(completed_boxes.size() == 0);
+		ZN_TEST_ASSERT(queue.get_pending_count() == 2);
+		ZN_TEST_ASSERT(queue.get_running_count() == 2);
+		const StdVector<unsigned int> first_ids = L::run(tasks);
+		ZN_TEST_ASSERT(first_ids.size() == 2);
+		ZN_TEST_ASSERT(first_ids[0] == 0);
+		ZN_TEST_ASSERT(first_ids[1] == 2);
+
+		// Completed edits are reported, and the edits waiting on them can run
+		queue.process(tasks, completed_boxes);
+		ZN_TEST_ASSERT(completed_boxes.size() == 2);
+		ZN_TEST_ASSERT(completed_boxes[0] == box_a || completed_boxes[1] == box_a);
+		ZN_TEST_ASSERT(completed_boxes[0] == box_b || completed_boxes[1] == box_b);
+		completed_boxes.clear();
+		const StdVector<unsigned int> second_ids = L::run(tasks);
+		ZN_TEST_ASSERT(second_ids.size() == 1);
+		ZN_TEST_ASSERT(second_ids[0] == 1);
+		ZN_TEST_ASSERT(queue.get_pending_count() == 1);
+
+		queue.process(tasks, completed_boxes);
+		ZN_TEST_ASSERT(completed_boxes.size() == 1);
+		ZN_TEST_ASSERT(completed_boxes[0] == box_a_overlap);
+		completed_boxes.clear();
+		const StdVector<unsigned int> third_ids = L::run(tasks);
+		ZN_TEST_ASSERT(third_ids.size() == 1);
+		ZN_TEST_ASSERT(third_ids[0] == 3);
+
+		queue.process(tasks, completed_boxes);
+		ZN_TEST_ASSERT(completed_boxes.size() == 1);
+		completed_boxes.clear();
+		ZN_TEST_ASSERT(tasks.size() == 0);
+		ZN_TEST_ASSERT(queue.get_pending_count() == 0);
+		ZN_TEST_ASSERT(queue.get_running_count() == 0);
+
+		ZN_TEST_ASSERT(tracker0->is_complete());
+		ZN_TEST_ASSERT(tracker1->is_complete());
+		ZN_TEST_ASSERT(tracker2->is_complete());
+		ZN_TEST_ASSERT(tracker3->is_complete());
+	}
+	// Aborting drops pending edits and aborts their trackers, but running edits are still reported once complete
+	{
+		AsyncEditQueue queue;
+		std::shared_ptr<AsyncDependencyTracker> running_tracker = L::push(queue, 0, box_a);
+		queue.process(tasks, completed_boxes);
+		ZN_TEST_ASSERT(tasks.size() == 1);
+
+		std::shared_ptr<AsyncDependencyTracker> pending_tracker = L::push(queue, 1, box_a_overlap);
+		queue.abort_pending();
+		ZN_TEST_ASSERT(pending_tracker->is_aborted());
+		ZN_TEST_ASSERT(!running_tracker->is_aborted());
+		ZN_TEST_ASSERT(queue.get_pending_count() == 0);
+		ZN_TEST_ASSERT(queue.get_running_count() == 1);
+
+		L::run(tasks);
+		queue.process(tasks, completed_boxes);
+		ZN_TEST_ASSERT(tasks.size() == 0);
+		ZN_TEST_ASSERT(completed_boxes.size() == 1);
+		ZN_TEST_ASSERT(completed_boxes[0] == box_a);
+		completed_boxes.clear();
+	}
+	// Pending edits left when the queue is destroyed are aborted
+	{
+		std::shared_ptr<AsyncDependencyTracker> tracker;
+		{
+			AsyncEditQueue queue;
+			tracker = L::push(queue, 0, box_a);
+		}
+		ZN_TEST_ASSERT(tracker->is_aborted());
+	}
+}
+
+} // namespace zylann::voxel::tests
@@ -0,0 +1,10 @@
+#ifndef VOXEL_TESTS_ASYNC_EDIT_QUEUE_H
+#define VOXEL_TESTS_ASYNC_EDIT_QUEUE_H
+
+namespace zylann::voxel::tests {
+
+void test_async_edit_queue();
+
+} // namespace zylann::voxel::tests
+
+#endif // VOXEL_TESTS_ASYNC_EDIT_QUEUE_H
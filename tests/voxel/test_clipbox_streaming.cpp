@@ -0,0 +1,52 @@
+#include "test_clipbox_streaming.h"
+#include "../../terrain/variable_lod/voxel_lod_terrain_update_clipbox_streaming.h"
+#include "../../util/memory/linear_allocator.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::voxel::tests {
+
+void test_clipbox_streaming_entering_cells_by_distance() {
+	// Box moved diagonally, so the difference is made of several sub-boxes
+	const Box3i prev_box(Vector3i(-4, -4, -4), Vector3i(8, 8, 8));
+	const Box3i new_box(Vector3i(-2, -3, -4), Vector3i(8, 8, 8));
+	// Viewer on the far side of the box from where it moved, so sub-boxes are not visited by distance
+	const Vector3i center(3, 4, 2);
+
+	LinearAllocator &allocator = get_tls_temp_allocator();
+	LinearAllocatorScope las(allocator);
+	StdTempVector<Vector3i> cells(allocator);
+
+	get_entering_cells_by_distance(new_box, prev_box, center, cells);
+
+	// Exactly the cells of the new box that were not in the previous one, each once
+	unsigned int expected_count = 0;
+	new_box.for_each_cell([&prev_box, &cells, &expected_count](Vector3i pos) {
+		if (prev_box.contains(pos)) {
+			return;
+		}
+		++expected_count;
+		unsigned int found_count = 0;
+		for (const Vector3i cell : cells) {
+			if (cell == pos) {
+				++found_count;
+			}
+		}
+		ZN_TEST_ASSERT(found_count == 1);
+	});
+	ZN_TEST_ASSERT(expected_count > 0);
+	ZN_TEST_ASSERT(cells.size() == expected_count);
+
+	// Closest first
+	for (unsigned int i = 1; i < cells.size(); ++i) {
+		const Vector3i d0 = cells[i - 1] - center;
+		const Vector3i d1 = cells[i] - center;
+		ZN_TEST_ASSERT(math::dot(d0, d0) <= math::dot(d1, d1));
+	}
+
+	// Nothing enters if the box didn't move
+	StdTempVector<Vector3i> cells2(allocator);
+	get_entering_cells_by_distance(new_box, new_box, center, cells2);
+	ZN_TEST_ASSERT(cells2.size() == 0);
+}
+
+} // namespace zylann::voxel::tests
@@ -0,0 +1,10 @@
+#ifndef VOXEL_TESTS_CLIPBOX_STREAMING_H
+#define VOXEL_TESTS_CLIPBOX_STREAMING_H
+
+namespace zylann::voxel::tests {
+
+void test_clipbox_streaming_entering_cells_by_distance();
+
+} // namespace zylann::voxel::tests
+
+#endif // VOXEL_TESTS_CLIPBOX_STREAMING_H
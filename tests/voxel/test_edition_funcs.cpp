@@ -6,12 +6,36 @@
 #include "../../meshers/blocky/voxel_blocky_model_cube.h"
 #include "../../meshers/blocky/voxel_blocky_model_mesh.h"
 #include "../../storage/voxel_data.h"
+#include "../../terrain/fixed_lod/voxel_terrain.h"
 #include "../../util/godot/classes/image.h"
 #include "../../util/testing/test_macros.h"
 #include "test_util.h"
 
 namespace zylann::voxel::tests {
 
+namespace {
+
+// Adds blocks marked as edited to `data`, each with a copy of the voxels of `model`
+void add_edited_blocks(VoxelData &data, const Box3i blocks_box, const VoxelBuffer &model) {
+	ZN_TEST_ASSERT(model.get_size() == Vector3iUtil::create(data.get_block_size()));
+	blocks_box.for_each_cell_zxy([&data, &model](Vector3i bpos) {
+		std::shared_ptr<VoxelBuffer> buffer = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
+		buffer->create(model.get_size());
+		buffer->copy_channels_from(model);
+		VoxelDataBlock block(buffer, 0);
+		block.set_edited(true);
+		ZN_TEST_ASSERT(data.try_set_block(bpos, block));
+	});
+}
+
+VoxelBuffer make_block_buffer(const VoxelData &data) {
+	VoxelBuffer buffer(VoxelBuffer::ALLOCATOR_DEFAULT);
+	buffer.create(Vector3iUtil::create(data.get_block_size()));
+	return buffer;
+}
+
+} // namespace
+
 void test_run_blocky_random_tick_with_params(const Box3i voxel_box, const int voxel_count, const int batch_count) {
 	// Create library with tickable voxels
 	Ref<VoxelBlockyLibrary> library;
@@ -55,15 +79,7 @@ void test_run_blocky_random_tick_with_params(const Box3i voxel_box, const int vo
 			}
 		}
 
-		const Box3i world_blocks_box(-4, -4, -4, 8, 8, 8);
-		world_blocks_box.for_each_cell_zxy([&data, &model_buffer](Vector3i block_pos) {
-			std::shared_ptr<VoxelBuffer> buffer = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
-			buffer->create(model_buffer.get_size());
-			buffer->copy_channels_from(model_buffer);
-			VoxelDataBlock block(buffer, 0);
-			block.set_edited(true);
-			ZN_TEST_ASSERT(data.try_set_block(block_pos, block));
-		});
+		add_edited_blocks(data, Box3i(-4, -4, -4, 8, 8, 8), model_buffer);
 	}
 
 	struct Callback {
@@ -340,7 +356,7 @@ void test_discord_soakil_copypaste() {
 		ZN_ASSERT(voxel_data.is_area_loaded(op.box));
 
 		voxel_data.pre_generate_box(op.box);
-		voxel_data.get_blocks_grid(op.blocks, op.box, 0);
+		voxel_data.get_blocks_grid_for_write(op.blocks, op.box, 0);
 		op();
 	}
 
@@ -366,4 +382,277 @@ void test_sdf_hemisphere() {
 	ZN_TEST_ASSERT(shape(Vector3f(2, 0, 0)) > 0);
 }
 
-} // namespace zylann::voxel::tests
\ No newline at end of file
+namespace {
+
+// Minimal tool editing VoxelData, so batches go through the same code as terrains
+class BatchingVoxelTool : public VoxelTool {
+public:
+	VoxelData *data = nullptr;
+
+	void do_sphere(Vector3 center, float radius) override {
+		if (_try_add_sphere_to_brush_batch(center, radius)) {
+			return;
+		}
+		VoxelTool::do_sphere(center, radius);
+	}
+
+	bool is_area_editable(const Box3i &box) const override {
+		return data->is_area_loaded(box);
+	}
+
+protected:
+	uint64_t _get_voxel(Vector3i pos) const override {
+		VoxelSingleValue defval;
+		defval.i = 0;
+		return data->get_voxel(pos, get_channel(), defval).i;
+	}
+
+	void _set_voxel(Vector3i pos, uint64_t v) override {
+		data->try_set_voxel(v, pos, get_channel());
+	}
+
+	void _post_edit(const Box3i &box) override {}
+
+	void _do_brush_batch(const ops::BrushBatch &batch) override {
+		do_brush_batch_chunked(*data, batch, false);
+	}
+};
+
+} // namespace
+
+void test_brush_batch() {
+	static const VoxelBuffer::ChannelId channel = VoxelBuffer::CHANNEL_SDF;
+
+	const Box3i blocks_box(-2, -2, -2, 4, 4, 4);
+
+	ops::BrushBatch batch;
+	batch.channel = channel;
+	{
+		ops::BrushBatch::Item item;
+		item.shape_type = ops::BrushBatch::SHAPE_SPHERE;
+		item.mode = ops::MODE_ADD;
+		item.strength = 1.f;
+		item.blocky_value = 0;
+		item.sphere.center = Vector3f(-3.f, 1.f, 2.f);
+		item.sphere.radius = 10.f;
+		item.sphere.sdf_scale = 1.f;
+		item.box = item.sphere.get_box();
+		batch.items.push_back(item);
+
+		// Overlaps the first sphere, so the order matters
+		item.mode = ops::MODE_REMOVE;
+		item.sphere.center = Vector3f(4.f, 0.f, 0.f);
+		item.sphere.radius = 6.f;
+		item.box = item.sphere.get_box();
+		batch.items.push_back(item);
+
+		item.shape_type = ops::BrushBatch::SHAPE_BOX;
+		item.mode = ops::MODE_ADD;
+		item.aabox.center = Vector3f(5.f, -6.f, 3.f);
+		item.aabox.half_size = Vector3f(4.f, 2.f, 3.f);
+		item.aabox.sdf_scale = 1.f;
+		item.box = item.aabox.get_box();
+		batch.items.push_back(item);
+	}
+
+	// Reference: apply shapes one by one
+	VoxelData expected_data;
+	add_edited_blocks(expected_data, blocks_box, make_block_buffer(expected_data));
+	for (const ops::BrushBatch::Item &item : batch.items) {
+		VoxelDataGrid grid;
+		expected_data.get_blocks_grid_for_write(grid, item.box, 0);
+		VoxelDataGrid::LockWrite wlock(grid);
+
+		if (item.shape_type == ops::BrushBatch::SHAPE_SPHERE) {
+			ops::DoShapeChunked<ops::SdfSphere, ops::VoxelDataGridAccess> op;
+			op.shape = item.sphere;
+			op.block_access.grid = &grid;
+			op.box = item.box;
+			op.mode = item.mode;
+			op.channel = channel;
+			op.texture_params = item.texture_params;
+			op.blocky_value = item.blocky_value;
+			op.strength = item.strength;
+			op();
+		} else {
+			ops::DoShapeChunked<ops::SdfAxisAlignedBox, ops::VoxelDataGridAccess> op;
+			op.shape = item.aabox;
+			op.block_access.grid = &grid;
+			op.box = item.box;
+			op.mode = item.mode;
+			op.channel = channel;
+			op.texture_params = item.texture_params;
+			op.blocky_value = item.blocky_value;
+			op.strength = item.strength;
+			op();
+		}
+	}
+
+	VoxelData data;
+	add_edited_blocks(data, blocks_box, make_block_buffer(data));
+	const Box3i box = batch.get_box();
+	{
+		VoxelDataGrid grid;
+		data.get_blocks_grid_for_write(grid, box, 0);
+		VoxelDataGrid::LockWrite wlock(grid);
+		ops::do_brush_batch(batch, box, grid);
+	}
+
+	// The batch only quantizes once per voxel, so results can differ very slightly
+	box.for_each_cell_zxy([&data, &expected_data](Vector3i pos) {
+		const float expected_sd = expected_data.get_voxel_f(pos, channel);
+		const float sd = data.get_voxel_f(pos, channel);
+		ZN_TEST_ASSERT(Math::abs(expected_sd - sd) < 0.05f);
+	});
+
+	// Blocky voxels removed in a batch must use the eraser value, like when not batched
+	{
+		struct B {
+			static void init_data(VoxelData &data, const Box3i blocks_box) {
+				VoxelBuffer model = make_block_buffer(data);
+				model.fill(1, VoxelBuffer::CHANNEL_TYPE);
+				add_edited_blocks(data, blocks_box, model);
+			}
+
+			static void do_spheres(BatchingVoxelTool &vt) {
+				vt.set_channel(VoxelBuffer::CHANNEL_TYPE);
+				vt.set_value(2);
+				vt.set_eraser_value(3);
+				vt.set_mode(VoxelTool::MODE_ADD);
+				vt.do_sphere(Vector3(-3.3f, 1.2f, 2.1f), 8.4f);
+				vt.set_mode(VoxelTool::MODE_REMOVE);
+				vt.do_sphere(Vector3(4.1f, 0.3f, 0.2f), 6.3f);
+			}
+		};
+
+		VoxelData expected_blocky_data;
+		B::init_data(expected_blocky_data, blocks_box);
+		{
+			Ref<BatchingVoxelTool> vt;
+			vt.instantiate();
+			vt->data = &expected_blocky_data;
+			B::do_spheres(**vt);
+		}
+
+		VoxelData blocky_data;
+		B::init_data(blocky_data, blocks_box);
+		{
+			Ref<BatchingVoxelTool> vt;
+			vt.instantiate();
+			vt->data = &blocky_data;
+			vt->begin_brush_batch();
+			B::do_spheres(**vt);
+			vt->end_brush_batch();
+		}
+
+		bool found_erased = false;
+		VoxelSingleValue defval;
+		defval.i = 0;
+		const Box3i blocky_box(Vector3i(-16, -16, -16), Vector3i(32, 32, 32));
+		blocky_box.for_each_cell_zxy([&blocky_data, &expected_blocky_data, &found_erased, defval](Vector3i pos) {
+			const uint64_t expected_v = expected_blocky_data.get_voxel(pos, VoxelBuffer::CHANNEL_TYPE, defval).i;
+			const uint64_t v = blocky_data.get_voxel(pos, VoxelBuffer::CHANNEL_TYPE, defval).i;
+			ZN_TEST_ASSERT(expected_v == v);
+			if (v == 3) {
+				found_erased = true;
+			}
+		});
+		ZN_TEST_ASSERT(found_erased);
+	}
+}
+
+void test_brush_batch_sparse() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+
+	VoxelData data;
+	const int block_size = data.get_block_size();
+
+	// Two groups of loaded blocks far apart, with nothing loaded in between
+	const Box3i near_blocks_box(-1, -1, -1, 2, 2, 2);
+	const Box3i far_blocks_box(10, -1, -1, 2, 2, 2);
+	VoxelBuffer model = make_block_buffer(data);
+	model.fill(1, channel);
+	add_edited_blocks(data, near_blocks_box, model);
+	add_edited_blocks(data, far_blocks_box, model);
+
+	const Vector3i near_center;
+	const Vector3i far_center(11 * block_size, 0, 0);
+	const Vector3i unloaded_center(5 * block_size, 0, 0);
+
+	Ref<BatchingVoxelTool> vt;
+	vt.instantiate();
+	vt->data = &data;
+	vt->set_channel(VoxelBuffer::CHANNEL_TYPE);
+	vt->set_value(2);
+	vt->set_mode(VoxelTool::MODE_ADD);
+	vt->begin_brush_batch();
+	vt->do_sphere(to_vec3(near_center), 4.f);
+	vt->do_sphere(to_vec3(unloaded_center), 4.f);
+	vt->do_sphere(to_vec3(far_center), 4.f);
+	vt->end_brush_batch();
+
+	VoxelSingleValue defval;
+	defval.i = 0;
+	// The shape in the unloaded area is skipped, the others are still applied
+	ZN_TEST_ASSERT(data.get_voxel(near_center, channel, defval).i == 2);
+	ZN_TEST_ASSERT(data.get_voxel(far_center, channel, defval).i == 2);
+	ZN_TEST_ASSERT(data.get_voxel(near_center + Vector3i(6, 0, 0), channel, defval).i == 1);
+	ZN_TEST_ASSERT(data.get_voxel(far_center - Vector3i(6, 0, 0), channel, defval).i == 1);
+	ZN_TEST_ASSERT(!data.has_block(unloaded_center / block_size, 0));
+}
+
+void test_voxel_tool_terrain_undo_redo() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+
+	VoxelTerrain *terrain = memnew(VoxelTerrain);
+	terrain->set_edit_journal_size_mb(1);
+	VoxelData &data = terrain->get_storage();
+
+	const Box3i blocks_box(-1, -1, -1, 2, 2, 2);
+	VoxelBuffer model = make_block_buffer(data);
+	model.fill(1, channel);
+	add_edited_blocks(data, blocks_box, model);
+
+	const Box3i voxel_box(blocks_box.position * data.get_block_size(), blocks_box.size * data.get_block_size());
+
+	struct L {
+		static StdVector<uint64_t> get_voxels(const VoxelData &data, Box3i box) {
+			StdVector<uint64_t> values;
+			VoxelSingleValue defval;
+			defval.i = 0;
+			box.for_each_cell_zxy([&data, &values, defval](Vector3i pos) {
+				values.push_back(data.get_voxel(pos, channel, defval).i);
+			});
+			return values;
+		}
+	};
+
+	const StdVector<uint64_t> voxels_before = L::get_voxels(data, voxel_box);
+
+	// The sphere spans all blocks
+	Ref<VoxelTool> vt = terrain->get_voxel_tool();
+	vt->set_channel(VoxelBuffer::CHANNEL_TYPE);
+	vt->set_value(2);
+	vt->set_mode(VoxelTool::MODE_ADD);
+	vt->do_sphere(Vector3(0.5f, 0.5f, 0.5f), 5.f);
+
+	const StdVector<uint64_t> voxels_after = L::get_voxels(data, voxel_box);
+	ZN_TEST_ASSERT(voxels_after != voxels_before);
+	VoxelSingleValue defval;
+	defval.i = 0;
+	ZN_TEST_ASSERT(data.get_voxel(Vector3i(-1, -1, -1), channel, defval).i == 2);
+	ZN_TEST_ASSERT(data.get_voxel(Vector3i(0, 0, 0), channel, defval).i == 2);
+
+	ZN_TEST_ASSERT(vt->undo());
+	ZN_TEST_ASSERT(L::get_voxels(data, voxel_box) == voxels_before);
+	ZN_TEST_ASSERT(!vt->undo());
+
+	ZN_TEST_ASSERT(vt->redo());
+	ZN_TEST_ASSERT(L::get_voxels(data, voxel_box) == voxels_after);
+	ZN_TEST_ASSERT(!vt->redo());
+
+	vt.unref();
+	memdelete(terrain);
+}
+
+} // namespace zylann::voxel::tests
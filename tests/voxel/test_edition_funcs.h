@@ -7,6 +7,9 @@ void test_run_blocky_random_tick();
 void test_box_blur();
 void test_discord_soakil_copypaste();
 void test_sdf_hemisphere();
+void test_brush_batch();
+void test_brush_batch_sparse();
+void test_voxel_tool_terrain_undo_redo();
 
 } // namespace zylann::voxel::tests
 
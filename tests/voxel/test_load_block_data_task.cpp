@@ -0,0 +1,203 @@
+#include "test_load_block_data_task.h"
+#include "../../engine/voxel_engine.h"
+#include "../../storage/voxel_buffer.h"
+#include "../../storage/voxel_data.h"
+#include "../../streams/load_block_data_task.h"
+#include "../../streams/voxel_stream_memory.h"
+#include "../../util/memory/linear_allocator.h"
+#include "../../util/testing/test_macros.h"
+#include <array>
+
+namespace zylann::voxel::tests {
+
+namespace {
+
+PriorityDependency make_priority_dependency(
+		std::shared_ptr<PriorityDependency::ViewersData> viewers,
+		Vector3f world_position,
+		float drop_distance
+) {
+	PriorityDependency dep;
+	dep.shared = viewers;
+	dep.world_position = world_position;
+	dep.drop_distance_squared = drop_distance * drop_distance;
+	return dep;
+}
+
+} // namespace
+
+void test_load_block_data_task_batcher() {
+	std::shared_ptr<PriorityDependency::ViewersData> viewers = make_shared_instance<PriorityDependency::ViewersData>();
+	viewers->viewers_count = 0;
+
+	std::shared_ptr<StreamingDependency> stream_dependency;
+	StreamingDependency::reset(stream_dependency, Ref<VoxelStream>(), Ref<VoxelGenerator>());
+
+	LoadBlockDataTaskBatcher batcher(
+			VolumeID(), 16, false, stream_dependency, false, false, make_shared_instance<VoxelData>()
+	);
+
+	const int neighborhood_size = 1 << LoadBlockDataTaskBatcher::NEIGHBORHOOD_SIZE_PO2;
+	const unsigned int max_batch_size = LoadBlockDataTask::MAX_BATCH_SIZE;
+	const PriorityDependency near_dep = make_priority_dependency(viewers, Vector3f(), 100000.f);
+
+	// More blocks than fit in one batch, in the same neighborhood
+	const unsigned int first_neighborhood_count = max_batch_size + 4;
+	unsigned int added_count = 0;
+	Box3i(Vector3i(), Vector3iUtil::create(neighborhood_size)).for_each_cell_zxy([&](Vector3i bpos) {
+		if (added_count < first_neighborhood_count) {
+			batcher.add(bpos, 0, near_dep, TaskCancellationToken());
+			++added_count;
+		}
+	});
+	// Blocks requested in between, in a different neighborhood
+	batcher.add(Vector3i(neighborhood_size, 0, 0), 0, near_dep, TaskCancellationToken());
+	batcher.add(Vector3i(neighborhood_size + 1, 0, 0), 0, near_dep, TaskCancellationToken());
+	// A block in the first neighborhood, but much further away from viewers
+	batcher.add(
+			Vector3i(0, 0, neighborhood_size - 1),
+			0,
+			make_priority_dependency(viewers, Vector3f(10000.f, 0.f, 0.f), 100000.f),
+			TaskCancellationToken()
+	);
+	// The same block positions at another LOD
+	batcher.add(Vector3i(0, 0, 0), 1, near_dep, TaskCancellationToken());
+	batcher.add(Vector3i(1, 0, 0), 1, near_dep, TaskCancellationToken());
+	batcher.add(Vector3i(neighborhood_size, 0, 0), 1, near_dep, TaskCancellationToken());
+
+	StdVector<LoadBlockDataTask *> tasks;
+	batcher.flush(tasks);
+
+	// Closest blocks come first, then LODs are kept apart
+	const std::array<unsigned int, 6> expected_counts{ max_batch_size, 4, 2, 1, 2, 1 };
+	ZN_TEST_ASSERT(tasks.size() == expected_counts.size());
+	for (unsigned int i = 0; i < tasks.size(); ++i) {
+		ZN_TEST_ASSERT(tasks[i]->get_block_count() == expected_counts[i]);
+	}
+
+	// Requests are consumed
+	StdVector<LoadBlockDataTask *> tasks2;
+	batcher.flush(tasks2);
+	ZN_TEST_ASSERT(tasks2.size() == 0);
+
+	for (LoadBlockDataTask *task : tasks) {
+		ZN_DELETE(task);
+	}
+}
+
+void test_load_block_data_task_cancellation() {
+	struct Output {
+		Vector3i position;
+		std::shared_ptr<VoxelBuffer> voxels;
+		bool dropped;
+	};
+
+	struct L {
+		static void on_data_output(void *cb_data, VoxelEngine::BlockDataOutput &o) {
+			StdVector<Output> &outputs = *static_cast<StdVector<Output> *>(cb_data);
+			outputs.push_back(Output{ o.position, o.voxels, o.dropped });
+		}
+
+		static void on_mesh_output(void *cb_data, VoxelEngine::BlockMeshOutput &o) {}
+
+		static const Output *find(const StdVector<Output> &outputs, Vector3i bpos) {
+			for (const Output &o : outputs) {
+				if (o.position == bpos) {
+					return &o;
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	static const int saved_value = 42;
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+
+	std::shared_ptr<VoxelData> data = make_shared_instance<VoxelData>();
+	const int block_size = data->get_block_size();
+
+	Ref<VoxelStreamMemory> stream;
+	stream.instantiate();
+
+	std::shared_ptr<StreamingDependency> stream_dependency;
+	StreamingDependency::reset(stream_dependency, stream, Ref<VoxelGenerator>());
+
+	const Vector3i found_bpos(0, 0, 0);
+	const Vector3i not_found_bpos(1, 0, 0);
+	const Vector3i cancelled_bpos(2, 0, 0);
+	const Vector3i too_far_bpos(3, 0, 0);
+	{
+		VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+		voxels.create(Vector3iUtil::create(block_size));
+		voxels.fill(saved_value, channel);
+		VoxelStream::VoxelQueryData q{ voxels, found_bpos, 0, VoxelStream::RESULT_ERROR };
+		stream->save_voxel_block(q);
+	}
+
+	StdVector<Output> outputs;
+	VoxelEngine::VolumeCallbacks callbacks;
+	callbacks.data_output_callback = L::on_data_output;
+	callbacks.mesh_output_callback = L::on_mesh_output;
+	callbacks.data = &outputs;
+	VoxelEngine &engine = VoxelEngine::get_singleton();
+	const VolumeID volume_id = engine.add_volume(callbacks);
+
+	std::shared_ptr<PriorityDependency::ViewersData> viewers = make_shared_instance<PriorityDependency::ViewersData>();
+	viewers->viewers_count = 0;
+	const PriorityDependency near_dep = make_priority_dependency(viewers, Vector3f(), 100000.f);
+
+	LoadBlockDataTask task(volume_id, 0, block_size, false, stream_dependency, false, false, data);
+
+	TaskCancellationToken cancellation_token = TaskCancellationToken::create();
+	task.add_block(found_bpos, near_dep, TaskCancellationToken::create());
+	task.add_block(not_found_bpos, near_dep, TaskCancellationToken::create());
+	task.add_block(cancelled_bpos, near_dep, cancellation_token);
+	// No token, this one is cancelled by distance
+	task.add_block(too_far_bpos, make_priority_dependency(viewers, Vector3f(10000.f, 0.f, 0.f), 100.f), {});
+
+	// Cancelling some blocks of the batch doesn't cancel the others
+	cancellation_token.cancel();
+	task.get_priority();
+	ZN_TEST_ASSERT(!task.is_cancelled());
+
+	{
+		ThreadedTaskContext ctx(0, TaskPriority(), get_tls_temp_allocator());
+		task.run(ctx);
+	}
+	task.apply_result();
+	engine.remove_volume(volume_id);
+
+	// Every block of the batch gets a response
+	ZN_TEST_ASSERT(outputs.size() == 4);
+
+	const Output *found_output = L::find(outputs, found_bpos);
+	ZN_TEST_ASSERT(found_output != nullptr);
+	ZN_TEST_ASSERT(!found_output->dropped);
+	ZN_TEST_ASSERT(found_output->voxels != nullptr);
+	ZN_TEST_ASSERT(found_output->voxels->get_voxel(Vector3i(1, 1, 1), channel) == saved_value);
+
+	// Not in the stream, and caching generated blocks is off
+	const Output *not_found_output = L::find(outputs, not_found_bpos);
+	ZN_TEST_ASSERT(not_found_output != nullptr);
+	ZN_TEST_ASSERT(!not_found_output->dropped);
+	ZN_TEST_ASSERT(not_found_output->voxels == nullptr);
+
+	const Output *cancelled_output = L::find(outputs, cancelled_bpos);
+	ZN_TEST_ASSERT(cancelled_output != nullptr);
+	ZN_TEST_ASSERT(cancelled_output->dropped);
+
+	const Output *too_far_output = L::find(outputs, too_far_bpos);
+	ZN_TEST_ASSERT(too_far_output != nullptr);
+	ZN_TEST_ASSERT(too_far_output->dropped);
+
+	// The batch is cancelled when all its blocks are
+	LoadBlockDataTask task2(volume_id, 0, block_size, false, stream_dependency, false, false, data);
+	TaskCancellationToken cancellation_token2 = TaskCancellationToken::create();
+	task2.add_block(found_bpos, near_dep, cancellation_token);
+	task2.add_block(not_found_bpos, near_dep, cancellation_token2);
+	ZN_TEST_ASSERT(!task2.is_cancelled());
+	cancellation_token2.cancel();
+	ZN_TEST_ASSERT(task2.is_cancelled());
+}
+
+} // namespace zylann::voxel::tests
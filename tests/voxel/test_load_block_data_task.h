@@ -0,0 +1,11 @@
+#ifndef VOXEL_TESTS_LOAD_BLOCK_DATA_TASK_H
+#define VOXEL_TESTS_LOAD_BLOCK_DATA_TASK_H
+
+namespace zylann::voxel::tests {
+
+void test_load_block_data_task_batcher();
+void test_load_block_data_task_cancellation();
+
+} // namespace zylann::voxel::tests
+
+#endif // VOXEL_TESTS_LOAD_BLOCK_DATA_TASK_H
@@ -0,0 +1,73 @@
+#include "test_mesh_apply_queue.h"
+#include "../../terrain/mesh_apply_queue.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::voxel::tests {
+
+void test_mesh_apply_queue() {
+	struct L {
+		static VoxelEngine::BlockMeshOutput make_output(Vector3i position, uint8_t lod_index, bool visual) {
+			VoxelEngine::BlockMeshOutput o;
+			o.type = VoxelEngine::BlockMeshOutput::TYPE_MESHED;
+			o.position = position;
+			o.lod = lod_index;
+			o.has_mesh_resource = false;
+			o.visual_was_required = visual;
+			return o;
+		}
+	};
+
+	MeshApplyQueue queue;
+
+	queue.push(L::make_output(Vector3i(0, 0, 0), 0, false));
+	queue.push(L::make_output(Vector3i(5, 0, 0), 0, false));
+	queue.push(L::make_output(Vector3i(1, 0, 0), 0, false));
+	// Same position but different LOD, not a duplicate
+	queue.push(L::make_output(Vector3i(1, 0, 0), 1, false));
+	// Replaces the previous result of the same block
+	queue.push(L::make_output(Vector3i(5, 0, 0), 0, true));
+	ZN_TEST_ASSERT(queue.get_pending_count() == 4);
+
+	// Cost is the distance to the origin, LOD 1 blocks being further
+	const auto get_cost = [](const VoxelEngine::BlockMeshOutput &o) {
+		return float(o.position.x) + float(o.lod) * 100.f;
+	};
+
+	StdVector<VoxelEngine::BlockMeshOutput> applied;
+	const auto apply = [&applied](VoxelEngine::BlockMeshOutput &o) { //
+		applied.push_back(std::move(o));
+	};
+
+	// A budget of zero still applies one result, the most urgent
+	queue.process(0, get_cost, apply);
+	ZN_TEST_ASSERT(applied.size() == 1);
+	ZN_TEST_ASSERT(applied[0].position == Vector3i(0, 0, 0));
+	ZN_TEST_ASSERT(queue.get_pending_count() == 3);
+	ZN_TEST_ASSERT(queue.get_stats().pending_count == 4);
+	ZN_TEST_ASSERT(queue.get_stats().applied_count == 1);
+
+	// A large budget applies the rest in order
+	queue.process(1000000, get_cost, apply);
+	ZN_TEST_ASSERT(applied.size() == 4);
+	ZN_TEST_ASSERT(applied[1].position == Vector3i(1, 0, 0) && applied[1].lod == 0);
+	ZN_TEST_ASSERT(applied[2].position == Vector3i(5, 0, 0) && applied[2].visual_was_required);
+	ZN_TEST_ASSERT(applied[3].position == Vector3i(1, 0, 0) && applied[3].lod == 1);
+	ZN_TEST_ASSERT(queue.get_pending_count() == 0);
+
+	// Removed blocks can be queued again
+	queue.push(L::make_output(Vector3i(5, 0, 0), 0, false));
+	ZN_TEST_ASSERT(queue.get_pending_count() == 1);
+	queue.clear();
+	ZN_TEST_ASSERT(queue.get_pending_count() == 0);
+
+	// Blocks behind the camera cost more than blocks in front at the same distance
+	const Vector3 camera_forward(0, 0, -1);
+	const float distance_sq = 100.f * 100.f;
+	const float front_cost =
+			MeshApplyQueue::get_block_cost(Vector3(0, 0, -100), 8.f, distance_sq, Vector3(), camera_forward);
+	const float back_cost =
+			MeshApplyQueue::get_block_cost(Vector3(0, 0, 100), 8.f, distance_sq, Vector3(), camera_forward);
+	ZN_TEST_ASSERT(back_cost > front_cost);
+}
+
+} // namespace zylann::voxel::tests
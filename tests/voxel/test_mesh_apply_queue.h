@@ -0,0 +1,10 @@
+#ifndef VOXEL_TESTS_MESH_APPLY_QUEUE_H
+#define VOXEL_TESTS_MESH_APPLY_QUEUE_H
+
+namespace zylann::voxel::tests {
+
+void test_mesh_apply_queue();
+
+} // namespace zylann::voxel::tests
+
+#endif // VOXEL_TESTS_MESH_APPLY_QUEUE_H
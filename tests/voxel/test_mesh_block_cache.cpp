@@ -0,0 +1,117 @@
+#include "test_mesh_block_cache.h"
+#include "../../meshers/cubes/voxel_mesher_cubes.h"
+#include "../../meshers/mesh_block_cache.h"
+#include "../../storage/voxel_buffer.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::voxel::tests {
+
+void test_mesh_block_cache() {
+	VoxelBuffer vb(VoxelBuffer::ALLOCATOR_DEFAULT);
+	vb.create(8, 8, 8);
+	vb.set_channel_depth(VoxelBuffer::CHANNEL_COLOR, VoxelBuffer::DEPTH_16_BIT);
+	vb.set_voxel(Color8(0, 255, 0, 255).to_u16(), Vector3i(3, 4, 4), VoxelBuffer::CHANNEL_COLOR);
+
+	Ref<VoxelMesherCubes> mesher;
+	mesher.instantiate();
+	mesher->set_color_mode(VoxelMesherCubes::COLOR_RAW);
+
+	VoxelMesher::Input input{ vb, nullptr, Vector3i(), 0, false };
+	VoxelMesher::Output output;
+	mesher->build(output, input);
+	ZN_TEST_ASSERT(!VoxelMesher::is_mesh_empty(output.surfaces));
+
+	const uint32_t channels_mask = mesher->get_used_channels_mask();
+
+	MeshBlockCache::Key key;
+	key.voxels_hash = MeshBlockCache::hash_voxels(vb, channels_mask);
+	key.settings_version = mesher->get_settings_version();
+	key.position = Vector3i(1, 2, 3);
+
+	MeshBlockCache cache;
+
+	// Disabled by default
+	cache.put(key, output);
+	ZN_TEST_ASSERT(cache.get_entry_count() == 0);
+
+	cache.set_capacity(1024 * 1024);
+	cache.put(key, output);
+	ZN_TEST_ASSERT(cache.get_entry_count() == 1);
+	ZN_TEST_ASSERT(cache.get_size_in_bytes() > 0);
+
+	{
+		VoxelMesher::Output cached_output;
+		ZN_TEST_ASSERT(cache.try_get(key, cached_output));
+		ZN_TEST_ASSERT(cached_output.surfaces.size() == output.surfaces.size());
+		const PackedVector3Array expected_vertices = output.surfaces[0].arrays[Mesh::ARRAY_VERTEX];
+		const PackedVector3Array cached_vertices = cached_output.surfaces[0].arrays[Mesh::ARRAY_VERTEX];
+		ZN_TEST_ASSERT(expected_vertices == cached_vertices);
+
+		// Modifying the result must not modify what is in the cache
+		cached_output.surfaces[0].arrays[Mesh::ARRAY_VERTEX] = PackedVector3Array();
+		VoxelMesher::Output cached_output2;
+		ZN_TEST_ASSERT(cache.try_get(key, cached_output2));
+		const PackedVector3Array cached_vertices2 = cached_output2.surfaces[0].arrays[Mesh::ARRAY_VERTEX];
+		ZN_TEST_ASSERT(expected_vertices == cached_vertices2);
+	}
+
+	// Edited voxels have a different hash
+	vb.set_voxel(Color8(255, 0, 0, 255).to_u16(), Vector3i(4, 4, 4), VoxelBuffer::CHANNEL_COLOR);
+	{
+		MeshBlockCache::Key key2 = key;
+		key2.voxels_hash = MeshBlockCache::hash_voxels(vb, channels_mask);
+		ZN_TEST_ASSERT(key2.voxels_hash != key.voxels_hash);
+		VoxelMesher::Output cached_output;
+		ZN_TEST_ASSERT(!cache.try_get(key2, cached_output));
+	}
+
+	// Changing properties of the mesher, or resources it uses, must not give results built with previous settings
+	{
+		Ref<VoxelColorPalette> palette;
+		palette.instantiate();
+		mesher->set_palette(palette);
+		const uint64_t version_with_palette = mesher->get_settings_version();
+		ZN_TEST_ASSERT(version_with_palette != key.settings_version);
+
+		palette->set_color(1, Color(1, 0, 0));
+		ZN_TEST_ASSERT(mesher->get_settings_version() != version_with_palette);
+
+		MeshBlockCache::Key key2 = key;
+		key2.settings_version = mesher->get_settings_version();
+		VoxelMesher::Output cached_output;
+		ZN_TEST_ASSERT(!cache.try_get(key2, cached_output));
+	}
+
+	// Same voxels at a different position are a different entry
+	{
+		MeshBlockCache::Key key3 = key;
+		key3.position = Vector3i(1, 2, 4);
+		VoxelMesher::Output cached_output;
+		ZN_TEST_ASSERT(!cache.try_get(key3, cached_output));
+	}
+
+	// Least recently used entries are evicted when capacity is exceeded
+	{
+		const size_t entry_size = cache.get_size_in_bytes();
+		cache.set_capacity(entry_size * 4);
+		for (int i = 0; i < 8; ++i) {
+			MeshBlockCache::Key key4 = key;
+			key4.position = Vector3i(10 + i, 0, 0);
+			cache.put(key4, output);
+		}
+		ZN_TEST_ASSERT(cache.get_size_in_bytes() <= cache.get_capacity());
+		ZN_TEST_ASSERT(cache.get_entry_count() < 9);
+		VoxelMesher::Output cached_output;
+		// The first entry was used the least recently
+		ZN_TEST_ASSERT(!cache.try_get(key, cached_output));
+		MeshBlockCache::Key last_key = key;
+		last_key.position = Vector3i(17, 0, 0);
+		ZN_TEST_ASSERT(cache.try_get(last_key, cached_output));
+	}
+
+	cache.clear();
+	ZN_TEST_ASSERT(cache.get_entry_count() == 0);
+	ZN_TEST_ASSERT(cache.get_size_in_bytes() == 0);
+}
+
+} // namespace zylann::voxel::tests
@@ -0,0 +1,10 @@
+#ifndef VOXEL_TESTS_MESH_BLOCK_CACHE_H
+#define VOXEL_TESTS_MESH_BLOCK_CACHE_H
+
+namespace zylann::voxel::tests {
+
+void test_mesh_block_cache();
+
+} // namespace zylann::voxel::tests
+
+#endif // VOXEL_TESTS_MESH_BLOCK_CACHE_H
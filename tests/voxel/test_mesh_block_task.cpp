@@ -0,0 +1,151 @@
+#include "test_mesh_block_task.h"
+#include "../../meshers/mesh_block_task.h"
+#include "../../util/godot/core/version.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::voxel::tests {
+
+namespace {
+
+// Attribute compression is available since Godot 4.2
+#if !(GODOT_VERSION_MAJOR == 4 && GODOT_VERSION_MINOR <= 1)
+
+Array make_test_surface() {
+	// Triangles spread in a box not centered on the origin, with normals pointing in many directions, including along
+	// axes, where octahedral encoding has edge cases
+	static const unsigned int triangle_count = 64;
+
+	PackedVector3Array positions;
+	PackedVector3Array normals;
+	PackedInt32Array indices;
+
+	const Vector3 box_min(-10.f, -3.f, 2.f);
+	const Vector3 box_size(32.f, 16.f, 38.f);
+
+	for (unsigned int i = 0; i < triangle_count * 3; ++i) {
+		const float t = static_cast<float>(i);
+		const Vector3 frac(
+				Math::fposmod(t * 0.618034f, 1.f), Math::fposmod(t * 0.414214f, 1.f), Math::fposmod(t * 0.732051f, 1.f)
+		);
+		positions.push_back(box_min + box_size * frac);
+
+		Vector3 normal;
+		switch (i % 8) {
+			case 0:
+				normal = Vector3(0.f, 0.f, 1.f);
+				break;
+			case 1:
+				normal = Vector3(0.f, 0.f, -1.f);
+				break;
+			case 2:
+				normal = Vector3(-1.f, 0.f, 0.f);
+				break;
+			case 3:
+				normal = Vector3(0.f, 1.f, 0.f);
+				break;
+			default: {
+				const float theta = t * 2.39996f;
+				const float phi = Math::acos(1.f - 2.f * frac.y);
+				normal = Vector3(
+						Math::sin(phi) * Math::cos(theta), //
+						Math::cos(phi), //
+						Math::sin(phi) * Math::sin(theta)
+				);
+			} break;
+		}
+		normals.push_back(normal.normalized());
+
+		indices.push_back(i);
+	}
+
+	Array arrays;
+	arrays.resize(Mesh::ARRAY_MAX);
+	arrays[Mesh::ARRAY_VERTEX] = positions;
+	arrays[Mesh::ARRAY_NORMAL] = normals;
+	arrays[Mesh::ARRAY_INDEX] = indices;
+	return arrays;
+}
+
+// Builds a mesh the same way terrains do, and gets its arrays back, decoded by Godot
+Array build_mesh_and_get_arrays(const Array &arrays, const uint32_t flags) {
+	StdVector<VoxelMesher::Output::Surface> surfaces;
+	surfaces.resize(1);
+	VoxelMesher::Output::Surface &surface = surfaces[0];
+	surface.arrays = arrays;
+
+#ifdef ZN_GODOT_PACKED_SURFACES
+	// Like a mesh task converting surfaces in a thread, when arrays are only needed for rendering
+	ZN_TEST_ASSERT(zylann::godot::pack_surface(surface.arrays, Mesh::PRIMITIVE_TRIANGLES, flags, surface.packed));
+	surface.is_packed = true;
+	surface.arrays = Array();
+#endif
+
+	StdVector<uint16_t> material_indices;
+	Ref<ArrayMesh> mesh = build_mesh(to_span_const(surfaces), Mesh::PRIMITIVE_TRIANGLES, flags, material_indices);
+	ZN_TEST_ASSERT(mesh.is_valid());
+	ZN_TEST_ASSERT(mesh->get_surface_count() == 1);
+	ZN_TEST_ASSERT(
+			(mesh->surface_get_format(0) & Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES) ==
+			(flags & Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES)
+	);
+
+	return mesh->surface_get_arrays(0);
+}
+
+#endif
+
+} // namespace
+
+void test_build_mesh_compressed_positions() {
+#if !(GODOT_VERSION_MAJOR == 4 && GODOT_VERSION_MINOR <= 1)
+	const Array arrays = make_test_surface();
+	const PackedVector3Array positions = arrays[Mesh::ARRAY_VERTEX];
+
+	// Without compression, positions come back unchanged
+	{
+		const Array result = build_mesh_and_get_arrays(arrays, 0);
+		const PackedVector3Array result_positions = result[Mesh::ARRAY_VERTEX];
+		ZN_TEST_ASSERT(result_positions == positions);
+	}
+
+	// With compression, positions are quantized to 16 bits relative to the bounding box of the mesh
+	{
+		const Array result = build_mesh_and_get_arrays(arrays, Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES);
+		const PackedVector3Array result_positions = result[Mesh::ARRAY_VERTEX];
+		ZN_TEST_ASSERT(result_positions.size() == positions.size());
+
+		AABB aabb(positions[0], Vector3());
+		for (int i = 1; i < positions.size(); ++i) {
+			aabb.expand_to(positions[i]);
+		}
+		// One quantization step, with some room for float imprecision
+		const Vector3 max_error = aabb.size / 65535.f + Vector3(0.0001f, 0.0001f, 0.0001f);
+
+		for (int i = 0; i < positions.size(); ++i) {
+			const Vector3 error = (result_positions[i] - positions[i]).abs();
+			ZN_TEST_ASSERT(error.x <= max_error.x && error.y <= max_error.y && error.z <= max_error.z);
+		}
+	}
+#endif
+}
+
+void test_build_mesh_compressed_normals() {
+#if !(GODOT_VERSION_MAJOR == 4 && GODOT_VERSION_MINOR <= 1)
+	const Array arrays = make_test_surface();
+	const PackedVector3Array normals = arrays[Mesh::ARRAY_NORMAL];
+
+	// With compression, normals are octahedral-encoded
+	const Array result = build_mesh_and_get_arrays(arrays, Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES);
+	const PackedVector3Array result_normals = result[Mesh::ARRAY_NORMAL];
+	ZN_TEST_ASSERT(result_normals.size() == normals.size());
+
+	for (int i = 0; i < normals.size(); ++i) {
+		const Vector3 n = result_normals[i];
+		ZN_TEST_ASSERT(Math::abs(n.length() - 1.f) < 0.001f);
+		// Less than about 1 degree of difference
+		ZN_TEST_ASSERT(n.dot(normals[i]) > 0.9998f);
+	}
+#endif
+}
+
+} // namespace zylann::voxel::tests
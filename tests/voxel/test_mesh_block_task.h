@@ -0,0 +1,11 @@
+#ifndef VOXEL_TESTS_MESH_BLOCK_TASK_H
+#define VOXEL_TESTS_MESH_BLOCK_TASK_H
+
+namespace zylann::voxel::tests {
+
+void test_build_mesh_compressed_positions();
+void test_build_mesh_compressed_normals();
+
+} // namespace zylann::voxel::tests
+
+#endif // VOXEL_TESTS_MESH_BLOCK_TASK_H
@@ -1,5 +1,7 @@
 #include "test_mesh_sdf.h"
+#include "../../edition/mesh_sdf.h"
 #include "../../edition/voxel_mesh_sdf_gd.h"
+#include "../../util/testing/test_macros.h"
 
 namespace zylann::voxel::tests {
 
@@ -30,4 +32,98 @@ void test_voxel_mesh_sdf_issue463() {
 	msdf->call("_set_data", d);
 }
 
+namespace {
+
+// Builds a closed UV sphere with consistent winding
+void make_sphere_mesh(float radius, int stacks, int slices, StdVector<Vector3> &vertices, StdVector<int> &indices) {
+	vertices.push_back(Vector3(0, radius, 0));
+	for (int i = 1; i < stacks; ++i) {
+		const float phi = math::PI<float> * i / stacks;
+		for (int j = 0; j < slices; ++j) {
+			const float theta = 2.f * math::PI<float> * j / slices;
+			vertices.push_back(
+					Vector3(radius * Math::sin(phi) * Math::cos(theta),
+							radius * Math::cos(phi),
+							radius * Math::sin(phi) * Math::sin(theta))
+			);
+		}
+	}
+	const int bottom_index = vertices.size();
+	vertices.push_back(Vector3(0, -radius, 0));
+
+	struct L {
+		static int ring(int i, int j, int slices) {
+			return 1 + (i - 1) * slices + (j % slices);
+		}
+	};
+
+	for (int j = 0; j < slices; ++j) {
+		indices.push_back(0);
+		indices.push_back(L::ring(1, j, slices));
+		indices.push_back(L::ring(1, j + 1, slices));
+
+		for (int i = 1; i < stacks - 1; ++i) {
+			const int a = L::ring(i, j, slices);
+			const int b = L::ring(i, j + 1, slices);
+			const int c = L::ring(i + 1, j, slices);
+			const int d = L::ring(i + 1, j + 1, slices);
+			indices.push_back(a);
+			indices.push_back(c);
+			indices.push_back(b);
+			indices.push_back(b);
+			indices.push_back(c);
+			indices.push_back(d);
+		}
+
+		indices.push_back(bottom_index);
+		indices.push_back(L::ring(stacks - 1, j + 1, slices));
+		indices.push_back(L::ring(stacks - 1, j, slices));
+	}
+}
+
+} // namespace
+
+void test_voxel_mesh_sdf_bvh() {
+	StdVector<Vector3> vertices;
+	StdVector<int> indices;
+	make_sphere_mesh(1.f, 8, 12, vertices, indices);
+
+	StdVector<mesh_sdf::Triangle> triangles;
+	Vector3f mesh_min_pos;
+	Vector3f mesh_max_pos;
+	ZN_TEST_ASSERT(
+			mesh_sdf::prepare_triangles(to_span(vertices), to_span(indices), triangles, mesh_min_pos, mesh_max_pos)
+	);
+
+	const Vector3f min_pos(-1.5f);
+	const Vector3f max_pos(1.5f);
+	const Vector3i res(16, 16, 16);
+	const float cell_size = (max_pos.x - min_pos.x) / res.x;
+
+	StdVector<float> expected_grid;
+	expected_grid.resize(Vector3iUtil::get_volume_u64(res));
+	mesh_sdf::generate_mesh_sdf_naive(to_span(expected_grid), res, to_span(triangles), min_pos, max_pos);
+
+	// Closest triangles found with the BVH must give the same distances as checking every triangle
+	StdVector<float> bvh_grid;
+	bvh_grid.resize(expected_grid.size());
+	mesh_sdf::generate_mesh_sdf_bvh(to_span(bvh_grid), res, to_span(triangles), min_pos, max_pos);
+	for (unsigned int i = 0; i < expected_grid.size(); ++i) {
+		ZN_TEST_ASSERT(Math::abs(bvh_grid[i] - expected_grid[i]) < 0.0001f);
+	}
+
+	// The narrow band is exact, and remaining cells are close approximations with the same sign
+	StdVector<float> nb_grid;
+	nb_grid.resize(expected_grid.size());
+	mesh_sdf::generate_mesh_sdf_approx_narrow_band(to_span(nb_grid), res, to_span(triangles), min_pos, max_pos);
+	for (unsigned int i = 0; i < expected_grid.size(); ++i) {
+		const float expected_sd = expected_grid[i];
+		const float sd = nb_grid[i];
+		ZN_TEST_ASSERT(Math::abs(sd - expected_sd) < 2.f * cell_size);
+		if (Math::abs(expected_sd) > cell_size) {
+			ZN_TEST_ASSERT((sd < 0.f) == (expected_sd < 0.f));
+		}
+	}
+}
+
 } // namespace zylann::voxel::tests
@@ -371,4 +371,167 @@ void test_voxel_stream_sqlite_transaction_recovery() {
 	ZN_TEST_ASSERT(con.end_transaction());
 }
 
+void test_voxel_stream_sqlite_cache_flush_threshold() {
+	zylann::testing::TestDirectory test_dir;
+	ZN_TEST_ASSERT(test_dir.is_valid());
+
+	const String database_path = test_dir.get_path().path_join("database.sqlite");
+
+	VoxelBuffer vb1(VoxelBuffer::ALLOCATOR_DEFAULT);
+	vb1.create(Vector3i(16, 16, 16));
+	vb1.fill_area(1, Vector3i(5, 5, 5), Vector3i(10, 11, 12), 0);
+
+	Ref<VoxelStreamSQLite> writer;
+	writer.instantiate();
+	writer->set_database_path(database_path);
+
+	// Another stream on the same file only sees what was written to the database
+	Ref<VoxelStreamSQLite> reader;
+	reader.instantiate();
+	reader->set_database_path(database_path);
+
+	struct L {
+		static VoxelStream::ResultCode load(VoxelStreamSQLite &stream, Vector3i position, const VoxelBuffer *expected) {
+			VoxelBuffer loaded_vb(VoxelBuffer::ALLOCATOR_DEFAULT);
+			VoxelStream::VoxelQueryData q{ loaded_vb, position, 0, VoxelStream::RESULT_ERROR };
+			stream.load_voxel_block(q);
+			if (q.result == VoxelStream::RESULT_BLOCK_FOUND && expected != nullptr) {
+				ZN_TEST_ASSERT(loaded_vb.equals(*expected));
+			}
+			return q.result;
+		}
+	};
+
+	// Below the threshold, the block stays in the cache of the stream that saved it
+	{
+		const Vector3i position(1, 2, 3);
+		VoxelStream::VoxelQueryData q{ vb1, position, 0, VoxelStream::RESULT_ERROR };
+		writer->save_voxel_block(q);
+
+		ZN_TEST_ASSERT(L::load(**writer, position, &vb1) == VoxelStream::RESULT_BLOCK_FOUND);
+		ZN_TEST_ASSERT(L::load(**reader, position, nullptr) == VoxelStream::RESULT_BLOCK_NOT_FOUND);
+
+		writer->flush();
+		ZN_TEST_ASSERT(L::load(**reader, position, &vb1) == VoxelStream::RESULT_BLOCK_FOUND);
+	}
+
+	// With no threshold, saves are written immediately
+	writer->set_cache_flush_threshold_bytes(0);
+	{
+		const Vector3i position(4, 5, 6);
+		VoxelStream::VoxelQueryData q{ vb1, position, 0, VoxelStream::RESULT_ERROR };
+		writer->save_voxel_block(q);
+
+		ZN_TEST_ASSERT(L::load(**reader, position, &vb1) == VoxelStream::RESULT_BLOCK_FOUND);
+	}
+}
+
+void test_voxel_stream_sqlite_batched_queries() {
+	using namespace sqlite;
+
+	zylann::testing::TestDirectory test_dir;
+	ZN_TEST_ASSERT(test_dir.is_valid());
+
+	const String database_path = test_dir.get_path().path_join("database.sqlite");
+	const StdString database_path_str = zylann::godot::to_std_string(database_path);
+
+	Connection::Options options;
+	options.wal_enabled = true;
+
+	Connection con;
+	ZN_TEST_ASSERT(con.open(database_path_str.c_str(), BlockLocation::FORMAT_BLOB80_X25_Y25_Z25_L5, options));
+
+	// More blocks than a single statement can take, with a remainder, and all combinations of data types
+	const unsigned int block_count = Connection::MAX_BLOCKS_PER_STATEMENT * 3 + 5;
+
+	StdVector<StdVector<uint8_t>> voxels;
+	StdVector<StdVector<uint8_t>> instances;
+	StdVector<Connection::BlockData> blocks;
+	StdVector<BlockLocation> locations;
+	voxels.resize(block_count);
+	instances.resize(block_count);
+
+	for (unsigned int i = 0; i < block_count; ++i) {
+		voxels[i] = { static_cast<uint8_t>(i), 1 };
+		instances[i] = { static_cast<uint8_t>(i), 2 };
+
+		Connection::BlockData block;
+		block.location.position = Vector3i(i, -static_cast<int>(i), 2 * i);
+		block.location.lod = i % 4;
+		block.has_voxels = (i % 3) != 1;
+		block.has_instances = (i % 3) != 0;
+		if (block.has_voxels) {
+			block.voxels = to_span(voxels[i]);
+		}
+		if (block.has_instances) {
+			block.instances = to_span(instances[i]);
+		}
+		blocks.push_back(block);
+		locations.push_back(block.location);
+	}
+
+	ZN_TEST_ASSERT(con.begin_transaction());
+	ZN_TEST_ASSERT(con.save_blocks(to_span(blocks)));
+	ZN_TEST_ASSERT(con.end_transaction());
+
+	// Saving only voxels must leave instances untouched
+	{
+		const unsigned int i = 2;
+		ZN_TEST_ASSERT(blocks[i].has_voxels && blocks[i].has_instances);
+		voxels[i] = { 42 };
+		Connection::BlockData block;
+		block.location = blocks[i].location;
+		block.voxels = to_span(voxels[i]);
+		block.has_voxels = true;
+		ZN_TEST_ASSERT(con.save_blocks(Span<const Connection::BlockData>(&block, 1)));
+	}
+
+	// A location that was never saved
+	BlockLocation missing_location;
+	missing_location.position = Vector3i(-1, -1, -1);
+	missing_location.lod = 0;
+	locations.push_back(missing_location);
+
+	struct L {
+		static void load(
+				Connection &con,
+				Span<const BlockLocation> locations,
+				Connection::BlockType type,
+				StdVector<StdVector<uint8_t>> &out_data
+		) {
+			out_data.clear();
+			out_data.resize(locations.size());
+			ZN_TEST_ASSERT(con.load_blocks(locations, type, &out_data, process_block_func));
+		}
+
+		static void process_block_func(void *callback_data, unsigned int location_index, Span<const uint8_t> data) {
+			StdVector<StdVector<uint8_t>> &out_data = *static_cast<StdVector<StdVector<uint8_t>> *>(callback_data);
+			ZN_TEST_ASSERT(location_index < out_data.size());
+			out_data[location_index].assign(data.data(), data.data() + data.size());
+		}
+	};
+
+	StdVector<StdVector<uint8_t>> loaded;
+
+	L::load(con, to_span(locations), Connection::VOXELS, loaded);
+	for (unsigned int i = 0; i < block_count; ++i) {
+		if (blocks[i].has_voxels) {
+			ZN_TEST_ASSERT(loaded[i] == voxels[i]);
+		} else {
+			ZN_TEST_ASSERT(loaded[i].size() == 0);
+		}
+	}
+	ZN_TEST_ASSERT(loaded.back().size() == 0);
+
+	L::load(con, to_span(locations), Connection::INSTANCES, loaded);
+	for (unsigned int i = 0; i < block_count; ++i) {
+		if (blocks[i].has_instances) {
+			ZN_TEST_ASSERT(loaded[i] == instances[i]);
+		} else {
+			ZN_TEST_ASSERT(loaded[i].size() == 0);
+		}
+	}
+	ZN_TEST_ASSERT(loaded.back().size() == 0);
+}
+
 } // namespace zylann::voxel::tests
@@ -8,6 +8,8 @@ void test_voxel_stream_sqlite_coordinate_format();
 void test_voxel_stream_sqlite_key_string_csd_encoding();
 void test_voxel_stream_sqlite_key_blob80_encoding();
 void test_voxel_stream_sqlite_transaction_recovery();
+void test_voxel_stream_sqlite_cache_flush_threshold();
+void test_voxel_stream_sqlite_batched_queries();
 
 } // namespace zylann::voxel::tests
 
@@ -0,0 +1,156 @@
+#include "test_voxel_a_star_grid_3d.h"
+#include "../../generators/simple/voxel_generator_flat.h"
+#include "../../terrain/voxel_a_star_grid_3d.h"
+#include "../../util/a_star_grid_3d.h"
+#include "../../util/memory/memory.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::voxel::tests {
+
+void test_a_star_grid_3d_region_cache() {
+	// Region not aligned to chunks, to make sure offsets are accounted for
+	const Box3i region(Vector3i(-5, -3, 2), Vector3i(11, 7, 9));
+
+	AStarGrid3D::RegionCache cache;
+	cache.create(region, 2);
+
+	ZN_TEST_ASSERT(cache.aligned_box.contains(region));
+
+	// Some arbitrary pattern
+	auto is_solid_expected = [](Vector3i pos) { //
+		return ((pos.x * 7 + pos.y * 13 + pos.z * 3) % 5) == 0;
+	};
+
+	region.for_each_cell([&cache, &is_solid_expected](Vector3i pos) {
+		if (is_solid_expected(pos)) {
+			const Vector3i apos = pos - cache.aligned_box.position;
+			const Vector3i cpos = apos >> cache.chunk_size_po2;
+			const Vector3i rpos = apos & ((1 << cache.chunk_size_po2) - 1);
+			cache.solid_bits.set(
+					cache.get_chunk_bit_offset(cpos) +
+					Vector3iUtil::get_zxy_index(rpos, Vector3iUtil::create(1 << cache.chunk_size_po2))
+			);
+		}
+	});
+
+	region.for_each_cell([&cache, &is_solid_expected](Vector3i pos) {
+		ZN_TEST_ASSERT(cache.is_solid(pos) == is_solid_expected(pos));
+	});
+
+	// Outside of the cache, nothing is solid
+	ZN_TEST_ASSERT(cache.is_solid(cache.aligned_box.position - Vector3i(1, 0, 0)) == false);
+
+	// Compare box checks with brute force. Some boxes have no solid cells, and some columns cross chunks.
+	const Box3i boxes[] = {
+		region, //
+		Box3i(region.position, Vector3i(1, 1, 1)),
+		Box3i(Vector3i(-2, -1, 4), Vector3i(3, 2, 4)),
+		Box3i(Vector3i(0, 0, 5), Vector3i(6, 4, 6)),
+		Box3i(Vector3i(1, 1, 3), Vector3i(0, 2, 2)),
+		Box3i(Vector3i(0, -3, 2), Vector3i(1, 7, 1)),
+		Box3i(Vector3i(0, -2, 2), Vector3i(1, 4, 1)),
+		Box3i(Vector3i(1, 0, 4), Vector3i(1, 1, 1)),
+	};
+	for (const Box3i &box : boxes) {
+		const bool expected = !box.all_cells_match([&is_solid_expected](Vector3i pos) { //
+			return !is_solid_expected(pos);
+		});
+		ZN_TEST_ASSERT(cache.has_solid_cells(box) == expected);
+	}
+}
+
+void test_voxel_a_star_grid_3d_cache_reuse() {
+	std::shared_ptr<VoxelData> data = make_shared_instance<VoxelData>();
+	{
+		std::shared_ptr<VoxelBuffer> buffer = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
+		buffer->create(Vector3iUtil::create(data->get_block_size()));
+		VoxelDataBlock block(buffer, 0);
+		block.set_edited(true);
+		ZN_TEST_ASSERT(data->try_set_block(Vector3i(), block));
+	}
+
+	VoxelAStarGrid3DInternal astar;
+	astar.data = data;
+	astar.set_region(Box3i(Vector3i(), Vector3i(8, 8, 8)));
+	ZN_TEST_ASSERT(!astar.is_cache_up_to_date());
+
+	astar.update_cache();
+	ZN_TEST_ASSERT(astar.is_cache_up_to_date());
+	const AStarGrid3D::RegionCache *cache = astar.get_region_cache().get();
+	ZN_TEST_ASSERT(cache != nullptr);
+
+	// Nothing changed, the cache is reused
+	astar.update_cache();
+	ZN_TEST_ASSERT(astar.get_region_cache().get() == cache);
+
+	// Voxels changed, the cache is rebuilt
+	const Vector3i solid_pos(2, 3, 4);
+	ZN_TEST_ASSERT(!astar.get_region_cache()->is_solid(solid_pos));
+	ZN_TEST_ASSERT(data->try_set_voxel(1, solid_pos, VoxelBuffer::CHANNEL_TYPE));
+	ZN_TEST_ASSERT(!astar.is_cache_up_to_date());
+	astar.update_cache();
+	ZN_TEST_ASSERT(astar.is_cache_up_to_date());
+	ZN_TEST_ASSERT(astar.get_region_cache()->is_solid(solid_pos));
+
+	// Region changed, the cache is rebuilt
+	astar.set_region(Box3i(Vector3i(1, 1, 1), Vector3i(8, 8, 8)));
+	ZN_TEST_ASSERT(!astar.is_cache_up_to_date());
+	astar.update_cache();
+	ZN_TEST_ASSERT(astar.is_cache_up_to_date());
+	ZN_TEST_ASSERT(astar.get_region_cache()->region == astar.get_region());
+}
+
+void test_voxel_a_star_grid_3d_cache_invalidation() {
+	std::shared_ptr<VoxelData> data = make_shared_instance<VoxelData>();
+	const int block_size = data->get_block_size();
+
+	struct L {
+		static void add_block(VoxelData &data, Vector3i bpos) {
+			std::shared_ptr<VoxelBuffer> buffer = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
+			buffer->create(Vector3iUtil::create(data.get_block_size()));
+			VoxelDataBlock block(buffer, 0);
+			block.set_edited(true);
+			ZN_TEST_ASSERT(data.try_set_block(bpos, block));
+		}
+	};
+
+	const Vector3i inside_bpos(0, 0, 0);
+	const Vector3i outside_bpos(4, 0, 0);
+	L::add_block(*data, inside_bpos);
+	L::add_block(*data, outside_bpos);
+
+	VoxelAStarGrid3DInternal astar;
+	astar.data = data;
+	astar.set_region(Box3i(Vector3i(), Vector3iUtil::create(block_size)));
+	astar.update_cache();
+	ZN_TEST_ASSERT(astar.is_cache_up_to_date());
+
+	// Changes outside of the region don't invalidate the cache
+	ZN_TEST_ASSERT(data->try_set_voxel(1, outside_bpos * block_size, VoxelBuffer::CHANNEL_TYPE));
+	data->mark_area_modified(Box3i(outside_bpos * block_size, Vector3i(1, 1, 1)), nullptr, false);
+	L::add_block(*data, Vector3i(0, 3, 0));
+	ZN_TEST_ASSERT(astar.is_cache_up_to_date());
+
+	// Loading a block in the region invalidates it, since it was generated before
+	const Vector3i region2_origin = Vector3i(-1, 0, 0) * block_size;
+	astar.set_region(Box3i(region2_origin, Vector3iUtil::create(block_size)));
+	astar.update_cache();
+	ZN_TEST_ASSERT(astar.is_cache_up_to_date());
+	L::add_block(*data, Vector3i(-1, 0, 0));
+	ZN_TEST_ASSERT(!astar.is_cache_up_to_date());
+	astar.update_cache();
+	ZN_TEST_ASSERT(astar.is_cache_up_to_date());
+
+	// Unloading a block in the region invalidates it
+	data->unload_blocks(Box3i(Vector3i(-1, 0, 0), Vector3i(1, 1, 1)), 0, nullptr);
+	ZN_TEST_ASSERT(!astar.is_cache_up_to_date());
+	astar.update_cache();
+
+	// Changing the generator invalidates it
+	Ref<VoxelGeneratorFlat> generator;
+	generator.instantiate();
+	data->set_generator(generator);
+	ZN_TEST_ASSERT(!astar.is_cache_up_to_date());
+}
+
+} // namespace zylann::voxel::tests
@@ -0,0 +1,91 @@
+#include "test_voxel_box_mover.h"
+#include "../../meshers/cubes/voxel_mesher_cubes.h"
+#include "../../storage/voxel_buffer.h"
+#include "../../storage/voxel_data.h"
+#include "../../terrain/fixed_lod/voxel_box_mover.h"
+#include "../../util/testing/test_macros.h"
+#include <array>
+
+namespace zylann::voxel::tests {
+
+void test_voxel_box_mover_get_motions() {
+	static const int channel = VoxelBuffer::CHANNEL_COLOR;
+
+	// A floor filling y=0, and a wall filling x=8 on top of it
+	VoxelData data;
+	{
+		const int block_size = data.get_block_size();
+		std::shared_ptr<VoxelBuffer> voxels = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
+		voxels->create(Vector3iUtil::create(block_size));
+		for (int z = 0; z < block_size; ++z) {
+			for (int x = 0; x < block_size; ++x) {
+				voxels->set_voxel(1, Vector3i(x, 0, z), channel);
+			}
+			for (int y = 1; y < block_size; ++y) {
+				voxels->set_voxel(1, Vector3i(8, y, z), channel);
+			}
+		}
+		VoxelDataBlock block(voxels, 0);
+		ZN_TEST_ASSERT(data.try_set_block(Vector3i(), block));
+	}
+
+	Ref<VoxelMesherCubes> mesher;
+	mesher.instantiate();
+
+	Ref<VoxelBoxMover> mover;
+	mover.instantiate();
+
+	const AABB aabb(Vector3(-0.5f, 0.f, -0.5f), Vector3(1.f, 1.f, 1.f));
+
+	struct Expected {
+		VoxelBoxMover::Body body;
+		Vector3 motion;
+	};
+
+	static const unsigned int CASE_COUNT = 4;
+	const std::array<Expected, CASE_COUNT> cases{ {
+			// Falling on the floor, stops on top of it
+			{ { Vector3(3.f, 2.f, 3.f), Vector3(0.f, -3.f, 0.f), aabb }, Vector3(0.f, -1.f, 0.f) },
+			// Moving towards the wall, stops along X, slides along Z
+			{ { Vector3(5.f, 1.5f, 3.f), Vector3(4.f, 0.f, 1.f), aabb }, Vector3(2.5f, 0.f, 1.f) },
+			// Moving diagonally towards both the floor and the wall
+			{ { Vector3(6.f, 1.5f, 3.f), Vector3(3.f, -1.f, 0.f), aabb }, Vector3(1.5f, -0.5f, 0.f) },
+			// Nothing in the way
+			{ { Vector3(3.f, 5.f, 3.f), Vector3(1.f, 1.f, 1.f), aabb }, Vector3(1.f, 1.f, 1.f) },
+	} };
+
+	struct L {
+		static bool is_close(Vector3 a, Vector3 b) {
+			// Motions stop a small margin before collisions
+			return (a - b).length() < 0.01f;
+		}
+	};
+
+	// Results must not depend on where the terrain is
+	const std::array<Transform3D, 2> terrain_transforms{
+		Transform3D(), Transform3D(Basis(), Vector3(100.f, -20.f, 3.f))
+	};
+
+	for (const Transform3D &terrain_transform : terrain_transforms) {
+		std::array<VoxelBoxMover::Body, CASE_COUNT> bodies;
+		for (unsigned int i = 0; i < cases.size(); ++i) {
+			bodies[i] = cases[i].body;
+			bodies[i].position = terrain_transform.xform(bodies[i].position);
+		}
+
+		std::array<Vector3, CASE_COUNT> motions;
+		mover->get_motions(to_span(bodies), to_span(motions), data, terrain_transform, **mesher);
+
+		for (unsigned int i = 0; i < cases.size(); ++i) {
+			ZN_TEST_ASSERT(L::is_close(motions[i], cases[i].motion));
+
+			// Same as processing bodies one by one
+			const VoxelBoxMover::Body &body = bodies[i];
+			const Vector3 motion =
+					mover->get_motion(body.position, body.motion, body.aabb, data, terrain_transform, **mesher);
+			ZN_TEST_ASSERT(L::is_close(motions[i], motion));
+		}
+	}
+}
+
+} // namespace zylann::voxel::tests
@@ -1,6 +1,16 @@
 #include "test_voxel_data_map.h"
+#include "../../engine/voxel_engine.h"
+#include "../../generators/simple/voxel_generator_flat.h"
+#include "../../generators/simple/voxel_generator_waves.h"
 #include "../../storage/voxel_buffer.h"
+#include "../../storage/voxel_data.h"
+#include "../../storage/voxel_data_grid.h"
 #include "../../storage/voxel_data_map.h"
+#include "../../storage/voxel_data_read_view.h"
+#include "../../streams/pre_generate_stream_task.h"
+#include "../../streams/voxel_stream_memory.h"
+#include "../../util/memory/linear_allocator.h"
+#include "../../util/tasks/async_dependency_tracker.h"
 #include "../../util/testing/test_macros.h"
 
 namespace zylann::voxel::tests {
@@ -209,4 +219,490 @@ void test_voxel_data_map_copy() {
 	ZN_TEST_ASSERT(buffer.equals(buffer2));
 }
 
+namespace {
+
+// Creates an edited LOD0 block with all voxels of the TYPE channel set to `value`
+VoxelDataBlock make_filled_edited_block(const VoxelData &data, uint64_t value) {
+	std::shared_ptr<VoxelBuffer> buffer = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
+	buffer->create(Vector3iUtil::create(data.get_block_size()));
+	buffer->fill(value, VoxelBuffer::CHANNEL_TYPE);
+	VoxelDataBlock block(buffer, 0);
+	block.set_edited(true);
+	return block;
+}
+
+} // namespace
+
+void test_voxel_data_save_copy_on_write() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+	const Vector3i bpos(0, 0, 0);
+	const Vector3i rpos(1, 1, 1);
+
+	VoxelData data;
+	{
+		VoxelDataBlock block = make_filled_edited_block(data, 1);
+		block.set_modified(true);
+		ZN_TEST_ASSERT(data.try_set_block(bpos, block));
+	}
+
+	// The block is the only owner of its voxels, so they can be saved without copy
+	VoxelData::BlockToSave to_save;
+	ZN_TEST_ASSERT(data.consume_block_modifications(bpos, to_save));
+	ZN_TEST_ASSERT(to_save.voxels != nullptr);
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos) == to_save.voxels);
+
+	// Modifying the block must not affect voxels being saved
+	ZN_TEST_ASSERT(data.try_set_voxel(2, rpos, channel));
+	ZN_TEST_ASSERT(to_save.voxels->get_voxel(rpos, channel) == 1);
+	std::shared_ptr<VoxelBuffer> voxels = data.try_get_block_voxels(bpos);
+	ZN_TEST_ASSERT(voxels != nullptr);
+	ZN_TEST_ASSERT(voxels != to_save.voxels);
+	ZN_TEST_ASSERT(voxels->get_voxel(rpos, channel) == 2);
+
+	// Voxels are referenced elsewhere (here by the test), so they must be copied when saved
+	data.mark_area_modified(Box3i(rpos, Vector3i(1, 1, 1)), nullptr, false);
+	ZN_TEST_ASSERT(data.consume_block_modifications(bpos, to_save));
+	ZN_TEST_ASSERT(to_save.voxels != nullptr);
+	ZN_TEST_ASSERT(to_save.voxels != voxels);
+	ZN_TEST_ASSERT(to_save.voxels->get_voxel(rpos, channel) == 2);
+
+	// Reading doesn't copy voxels referenced by the save, writing does
+	voxels.reset();
+	data.mark_area_modified(Box3i(rpos, Vector3i(1, 1, 1)), nullptr, false);
+	ZN_TEST_ASSERT(data.consume_block_modifications(bpos, to_save));
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos) == to_save.voxels);
+	{
+		VoxelDataGrid grid;
+		static_cast<const VoxelData &>(data).get_blocks_grid(grid, Box3i(rpos, Vector3i(1, 1, 1)), 0);
+		ZN_TEST_ASSERT(data.try_get_block_voxels(bpos) == to_save.voxels);
+	}
+	voxels = data.try_get_block_voxels_for_write(bpos);
+	ZN_TEST_ASSERT(voxels != nullptr);
+	ZN_TEST_ASSERT(voxels != to_save.voxels);
+	ZN_TEST_ASSERT(voxels->get_voxel(rpos, channel) == 2);
+}
+
+void test_voxel_data_mesh_snapshot() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+	const Vector3i bpos(0, 0, 0);
+	const Vector3i rpos(1, 1, 1);
+
+	VoxelData data;
+	ZN_TEST_ASSERT(data.try_set_block(bpos, make_filled_edited_block(data, 1)));
+
+	// The block is the only owner of its voxels, so the snapshot doesn't copy them
+	std::shared_ptr<const VoxelBuffer> snapshot;
+	data.get_blocks_with_voxel_data(
+			Box3i(bpos, Vector3i(1, 1, 1)), 0, Span<std::shared_ptr<const VoxelBuffer>>(&snapshot, 1)
+	);
+	ZN_TEST_ASSERT(snapshot != nullptr);
+	ZN_TEST_ASSERT(snapshot == data.try_get_block_voxels(bpos));
+
+	// Editing the block must not affect the snapshot
+	ZN_TEST_ASSERT(data.try_set_voxel(2, rpos, channel));
+	ZN_TEST_ASSERT(snapshot->get_voxel(rpos, channel) == 1);
+	std::shared_ptr<VoxelBuffer> voxels = data.try_get_block_voxels(bpos);
+	ZN_TEST_ASSERT(voxels != nullptr);
+	ZN_TEST_ASSERT(voxels != snapshot);
+	ZN_TEST_ASSERT(voxels->get_voxel(rpos, channel) == 2);
+
+	// Voxels are referenced elsewhere (here by the test), so the snapshot must be a copy
+	std::shared_ptr<const VoxelBuffer> snapshot2;
+	data.get_blocks_with_voxel_data(
+			Box3i(bpos, Vector3i(1, 1, 1)), 0, Span<std::shared_ptr<const VoxelBuffer>>(&snapshot2, 1)
+	);
+	ZN_TEST_ASSERT(snapshot2 != nullptr);
+	ZN_TEST_ASSERT(snapshot2 != voxels);
+	ZN_TEST_ASSERT(snapshot2->get_voxel(rpos, channel) == 2);
+}
+
+void test_voxel_data_edit_journal() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+	const Vector3i bpos(0, 0, 0);
+	const Vector3i rpos(1, 1, 1);
+	const Box3i voxel_box(rpos, Vector3i(1, 1, 1));
+
+	VoxelData data;
+	data.set_edit_journal_capacity(1024 * 1024);
+	ZN_TEST_ASSERT(data.try_set_block(bpos, make_filled_edited_block(data, 1)));
+
+	VoxelEditJournal::Recording recording;
+	data.begin_edit_recording(voxel_box, recording);
+	ZN_TEST_ASSERT(data.try_set_voxel(2, rpos, channel));
+	data.end_edit_recording(recording);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_undo_count() == 1);
+
+	StdVector<Box3i> modified_boxes;
+	ZN_TEST_ASSERT(data.undo_edit(modified_boxes));
+	ZN_TEST_ASSERT(modified_boxes.size() == 1);
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos)->get_voxel(rpos, channel) == 1);
+	ZN_TEST_ASSERT(!data.undo_edit(modified_boxes));
+
+	ZN_TEST_ASSERT(data.redo_edit(modified_boxes));
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos)->get_voxel(rpos, channel) == 2);
+	ZN_TEST_ASSERT(!data.redo_edit(modified_boxes));
+
+	// A new edit after an undo can't be followed by a redo
+	ZN_TEST_ASSERT(data.undo_edit(modified_boxes));
+	ZN_TEST_ASSERT(data.get_edit_journal().get_redo_count() == 1);
+	data.begin_edit_recording(voxel_box, recording);
+	ZN_TEST_ASSERT(data.try_set_voxel(3, rpos, channel));
+	data.end_edit_recording(recording);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_redo_count() == 0);
+	ZN_TEST_ASSERT(!data.redo_edit(modified_boxes));
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos)->get_voxel(rpos, channel) == 3);
+	ZN_TEST_ASSERT(data.undo_edit(modified_boxes));
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos)->get_voxel(rpos, channel) == 1);
+}
+
+void test_voxel_data_edit_journal_multiple_blocks() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+
+	VoxelData data;
+	data.set_edit_journal_capacity(1024 * 1024);
+	const int block_size = data.get_block_size();
+	const Vector3i bpos0(0, 0, 0);
+	const Vector3i bpos1(1, 0, 0);
+	ZN_TEST_ASSERT(data.try_set_block(bpos0, make_filled_edited_block(data, 1)));
+	ZN_TEST_ASSERT(data.try_set_block(bpos1, make_filled_edited_block(data, 1)));
+
+	// Across the border between the two blocks
+	const Vector3i pos0(block_size - 1, 1, 1);
+	const Vector3i pos1(block_size, 1, 1);
+	const Box3i voxel_box(pos0, Vector3i(2, 1, 1));
+
+	VoxelEditJournal::Recording recording;
+	data.begin_edit_recording(voxel_box, recording);
+	ZN_TEST_ASSERT(data.try_set_voxel(2, pos0, channel));
+	ZN_TEST_ASSERT(data.try_set_voxel(3, pos1, channel));
+	data.end_edit_recording(recording);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_undo_count() == 1);
+
+	VoxelSingleValue defval;
+	defval.i = 0;
+
+	// Both blocks are restored by a single undo, and only the edited area is reported
+	StdVector<Box3i> modified_boxes;
+	ZN_TEST_ASSERT(data.undo_edit(modified_boxes));
+	ZN_TEST_ASSERT(modified_boxes.size() == 2);
+	for (const Box3i &box : modified_boxes) {
+		ZN_TEST_ASSERT(voxel_box.contains(box));
+	}
+	ZN_TEST_ASSERT(data.get_voxel(pos0, channel, defval).i == 1);
+	ZN_TEST_ASSERT(data.get_voxel(pos1, channel, defval).i == 1);
+
+	modified_boxes.clear();
+	ZN_TEST_ASSERT(data.redo_edit(modified_boxes));
+	ZN_TEST_ASSERT(modified_boxes.size() == 2);
+	ZN_TEST_ASSERT(data.get_voxel(pos0, channel, defval).i == 2);
+	ZN_TEST_ASSERT(data.get_voxel(pos1, channel, defval).i == 3);
+
+	// Voxels around the edited area are left untouched
+	ZN_TEST_ASSERT(data.get_voxel(pos0 - Vector3i(1, 0, 0), channel, defval).i == 1);
+	ZN_TEST_ASSERT(data.get_voxel(pos1 + Vector3i(1, 0, 0), channel, defval).i == 1);
+}
+
+void test_voxel_data_edit_journal_capacity() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+	const Vector3i bpos(0, 0, 0);
+	const Vector3i rpos(1, 1, 1);
+	const Box3i voxel_box(rpos, Vector3i(1, 1, 1));
+
+	VoxelData data;
+	data.set_edit_journal_capacity(1024 * 1024);
+	ZN_TEST_ASSERT(data.try_set_block(bpos, make_filled_edited_block(data, 1)));
+
+	struct L {
+		static void edit(VoxelData &data, Box3i box, uint64_t value) {
+			VoxelEditJournal::Recording recording;
+			data.begin_edit_recording(box, recording);
+			ZN_TEST_ASSERT(data.try_set_voxel(value, box.position, channel));
+			data.end_edit_recording(recording);
+		}
+	};
+
+	L::edit(data, voxel_box, 2);
+	const size_t edit_size = data.get_edit_journal().get_size_in_bytes();
+	ZN_TEST_ASSERT(edit_size > 0);
+
+	// Room for two edits of the same size
+	data.set_edit_journal_capacity(edit_size * 2);
+	L::edit(data, voxel_box, 3);
+	L::edit(data, voxel_box, 4);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_undo_count() == 2);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_size_in_bytes() <= edit_size * 2);
+
+	// The oldest edit was forgotten
+	StdVector<Box3i> modified_boxes;
+	ZN_TEST_ASSERT(data.undo_edit(modified_boxes));
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos)->get_voxel(rpos, channel) == 3);
+	ZN_TEST_ASSERT(data.undo_edit(modified_boxes));
+	ZN_TEST_ASSERT(data.try_get_block_voxels(bpos)->get_voxel(rpos, channel) == 2);
+	ZN_TEST_ASSERT(!data.undo_edit(modified_boxes));
+
+	// Disabling the journal clears it, and edits are no longer recorded
+	data.set_edit_journal_capacity(0);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_redo_count() == 0);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_size_in_bytes() == 0);
+	L::edit(data, voxel_box, 5);
+	ZN_TEST_ASSERT(data.get_edit_journal().get_undo_count() == 0);
+	ZN_TEST_ASSERT(!data.undo_edit(modified_boxes));
+}
+
+void test_voxel_data_get_voxels_generated() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+	static const uint64_t edited_value = 42;
+
+	Ref<VoxelGeneratorWaves> generator;
+	generator.instantiate();
+	generator->set_channel(VoxelBuffer::CHANNEL_TYPE);
+
+	VoxelData data;
+	data.set_streaming_enabled(false);
+	data.set_full_load_completed(true);
+	data.set_generator(generator);
+
+	// Waves are between -50 and -20 by default
+	const Vector3i edited_bpos(0, -3, 0);
+	const Box3i edited_box(edited_bpos * data.get_block_size(), Vector3iUtil::create(data.get_block_size()));
+	ZN_TEST_ASSERT(data.try_set_block(edited_bpos, make_filled_edited_block(data, edited_value)));
+
+	const Box3i box(Vector3i(-16, -64, 0), Vector3i(32, 48, 4));
+
+	VoxelBuffer expected(VoxelBuffer::ALLOCATOR_DEFAULT);
+	expected.create(box.size);
+	generator->generate_block(VoxelGenerator::VoxelQueryData{ expected, box.position, 0 });
+
+	StdVector<Vector3i> positions;
+	box.for_each_cell([&positions](Vector3i pos) { positions.push_back(pos); });
+
+	VoxelSingleValue defval;
+	defval.i = 0;
+	StdVector<VoxelSingleValue> values;
+	values.resize(positions.size());
+	data.get_voxels(to_span(positions), channel, defval, to_span(values));
+
+	for (unsigned int i = 0; i < positions.size(); ++i) {
+		const Vector3i pos = positions[i];
+		if (edited_box.contains(pos)) {
+			ZN_TEST_ASSERT(values[i].i == edited_value);
+		} else {
+			ZN_TEST_ASSERT(values[i].i == expected.get_voxel(pos - box.position, channel));
+		}
+		if ((i % 97) == 0) {
+			ZN_TEST_ASSERT(data.get_voxel(pos, channel, defval).i == values[i].i);
+		}
+	}
+
+	// SDF computed directly should match generated blocks, within quantization error
+	{
+		Ref<VoxelGeneratorFlat> flat;
+		flat.instantiate();
+		flat->set_channel(VoxelBuffer::CHANNEL_SDF);
+		flat->set_height(2.5f);
+
+		const Box3i sdf_box(Vector3i(-3, -8, 5), Vector3i(4, 16, 4));
+		VoxelBuffer sdf_expected(VoxelBuffer::ALLOCATOR_DEFAULT);
+		sdf_expected.create(sdf_box.size);
+		flat->generate_block(VoxelGenerator::VoxelQueryData{ sdf_expected, sdf_box.position, 0 });
+
+		positions.clear();
+		sdf_box.for_each_cell([&positions](Vector3i pos) { positions.push_back(pos); });
+		values.resize(positions.size());
+		flat->generate_single_batch(to_span(positions), VoxelBuffer::CHANNEL_SDF, to_span(values));
+
+		for (unsigned int i = 0; i < positions.size(); ++i) {
+			const float sd = sdf_expected.get_voxel_f(positions[i] - sdf_box.position, VoxelBuffer::CHANNEL_SDF);
+			ZN_TEST_ASSERT(math::abs(values[i].f - sd) < 0.01f);
+		}
+	}
+}
+
+void test_voxel_data_pre_generate_box() {
+	Ref<VoxelGeneratorFlat> generator;
+	generator.instantiate();
+	generator->set_channel(VoxelBuffer::CHANNEL_TYPE);
+	generator->set_voxel_type(1);
+	generator->set_height(0.f);
+
+	VoxelData data;
+	data.set_streaming_enabled(false);
+	data.set_full_load_completed(true);
+	data.set_generator(generator);
+	data.set_task_scheduler(VoxelEngine::get_task_scheduler());
+
+	// Spans several regions, each having enough blocks to be generated with the thread pool
+	const Box3i voxel_box(Vector3i(-150, -20, -10), Vector3i(300, 40, 40));
+	data.pre_generate_box(voxel_box);
+
+	const int block_size = data.get_block_size();
+	const Box3i block_box = voxel_box.downscaled(block_size);
+	block_box.for_each_cell([&data, block_size](Vector3i bpos) {
+		std::shared_ptr<VoxelBuffer> voxels = data.try_get_block_voxels(bpos);
+		ZN_TEST_ASSERT(voxels != nullptr);
+		for (const int y : { 0, block_size - 1 }) {
+			const int expected_value = bpos.y * block_size + y < 0 ? 1 : 0;
+			ZN_TEST_ASSERT(voxels->get_voxel(Vector3i(1, y, 1), VoxelBuffer::CHANNEL_TYPE) == expected_value);
+		}
+	});
+}
+
+void test_voxel_data_read_view() {
+	static const int channel = VoxelBuffer::CHANNEL_TYPE;
+	const Vector3i uniform_bpos(0, 0, 0);
+	const Vector3i bpos(1, 0, 0);
+
+	VoxelData data;
+	const int block_size = data.get_block_size();
+	ZN_TEST_ASSERT(data.try_set_block(uniform_bpos, make_filled_edited_block(data, 1)));
+	{
+		std::shared_ptr<VoxelBuffer> buffer = make_shared_instance<VoxelBuffer>(VoxelBuffer::ALLOCATOR_DEFAULT);
+		buffer->create(Vector3iUtil::create(block_size));
+		buffer->set_voxel(3, Vector3i(2, 3, 4), channel);
+		VoxelDataBlock block(buffer, 0);
+		ZN_TEST_ASSERT(data.try_set_block(bpos, block));
+	}
+
+	{
+		// Covers the two blocks and a missing one
+		VoxelDataReadView view;
+		data.acquire_read_view(view, Box3i(Vector3i(), Vector3i(3 * block_size, 1, 1)), 0);
+		ZN_TEST_ASSERT(view.is_acquired());
+		ZN_TEST_ASSERT(view.get_block_box() == Box3i(Vector3i(), Vector3i(3, 1, 1)));
+
+		ZN_TEST_ASSERT(view.get_block(uniform_bpos) != nullptr);
+		ZN_TEST_ASSERT(view.get_block(bpos) != nullptr);
+		ZN_TEST_ASSERT(view.get_block(Vector3i(2, 0, 0)) == nullptr);
+		ZN_TEST_ASSERT(view.get_block(Vector3i(-1, 0, 0)) == nullptr);
+
+		uint64_t v = 0;
+		ZN_TEST_ASSERT(view.try_get_voxel(Vector3i(5, 5, 5), channel, v));
+		ZN_TEST_ASSERT(v == 1);
+		ZN_TEST_ASSERT(view.try_get_voxel(Vector3i(block_size + 2, 3, 4), channel, v));
+		ZN_TEST_ASSERT(v == 3);
+		ZN_TEST_ASSERT(view.try_get_voxel(Vector3i(block_size + 2, 3, 5), channel, v));
+		ZN_TEST_ASSERT(v == 0);
+		ZN_TEST_ASSERT(view.try_get_voxel(Vector3i(2 * block_size, 0, 0), channel, v) == false);
+
+		VoxelDataReadView::ChannelData channel_data;
+		ZN_TEST_ASSERT(view.try_get_block_channel(uniform_bpos, channel, channel_data));
+		ZN_TEST_ASSERT(channel_data.bytes.size() == 0);
+		ZN_TEST_ASSERT(channel_data.uniform_value == 1);
+		ZN_TEST_ASSERT(view.try_get_block_channel(bpos, channel, channel_data));
+		ZN_TEST_ASSERT(channel_data.bytes.size() == Vector3iUtil::get_volume_u64(Vector3iUtil::create(block_size)));
+
+		unsigned int block_count = 0;
+		view.for_each_block([&block_count](Vector3i block_pos, const VoxelBuffer &voxels) { //
+			ZN_TEST_ASSERT(voxels.get_size().x > 0);
+			++block_count;
+		});
+		ZN_TEST_ASSERT(block_count == 2);
+	}
+
+	{
+		// Blocks can be replaced while a view is held, without taking the spatial lock (like loading responses do).
+		// The view must keep reading the voxels it was acquired with.
+		VoxelDataReadView view;
+		data.acquire_read_view(view, Box3i(Vector3i(), Vector3iUtil::create(block_size)), 0);
+		const VoxelBuffer *viewed_voxels = view.get_block(uniform_bpos);
+		ZN_TEST_ASSERT(viewed_voxels != nullptr);
+
+		const VoxelDataBlock block = make_filled_edited_block(data, 4);
+		const bool added = data.try_set_block(
+				uniform_bpos,
+				block,
+				[](VoxelDataBlock &existing_block, const VoxelDataBlock &incoming_block) {
+					existing_block.set_voxels(incoming_block.get_voxels_shared());
+				}
+		);
+		ZN_TEST_ASSERT(added == false);
+		ZN_TEST_ASSERT(data.try_get_block_voxels(uniform_bpos) == block.get_voxels_shared());
+
+		ZN_TEST_ASSERT(view.get_block(uniform_bpos) == viewed_voxels);
+		uint64_t v = 0;
+		ZN_TEST_ASSERT(view.try_get_voxel(Vector3i(5, 5, 5), channel, v));
+		ZN_TEST_ASSERT(v == 1);
+	}
+
+	// The view is released, so voxels can be edited again
+	ZN_TEST_ASSERT(data.try_set_voxel(2, Vector3i(5, 5, 5), channel));
+	std::shared_ptr<VoxelBuffer> voxels = data.try_get_block_voxels(uniform_bpos);
+	ZN_TEST_ASSERT(voxels != nullptr);
+	ZN_TEST_ASSERT(voxels->get_voxel(Vector3i(5, 5, 5), channel) == 2);
+}
+
+void test_voxel_data_pre_generate_to_stream() {
+	Ref<VoxelGeneratorFlat> generator;
+	generator.instantiate();
+	generator->set_channel(VoxelBuffer::CHANNEL_TYPE);
+	generator->set_voxel_type(1);
+	generator->set_height(0.f);
+
+	Ref<VoxelStreamMemory> stream;
+	stream.instantiate();
+
+	std::shared_ptr<VoxelData> data = make_shared_instance<VoxelData>();
+	data->set_generator(generator);
+	data->set_stream(stream);
+
+	std::shared_ptr<StreamingDependency> stream_dependency;
+	StreamingDependency::reset(stream_dependency, stream, generator);
+
+	const int block_size = data->get_block_size();
+	static const int saved_value = 42;
+
+	// As if that block was edited and saved before pre-generation. It must not be overwritten.
+	const Vector3i saved_block_pos(1, -1, 2);
+	{
+		VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+		voxels.create(Vector3iUtil::create(block_size));
+		voxels.fill(saved_value, VoxelBuffer::CHANNEL_TYPE);
+		VoxelStream::VoxelQueryData q{ voxels, saved_block_pos, 0, VoxelStream::RESULT_ERROR };
+		stream->save_voxel_block(q);
+	}
+
+	// Spans several regions, some of them only partially
+	const int region_size = PreGenerateStreamTask::REGION_SIZE_IN_BLOCKS;
+	const Box3i block_box(Vector3i(0, -1, 0), Vector3i(region_size + 2, 2, 3));
+	const unsigned int region_count = Vector3iUtil::get_volume_u64(block_box.downscaled(region_size).size);
+	ZN_TEST_ASSERT(region_count == 4);
+
+	StdVector<IThreadedTask *> tasks;
+	std::shared_ptr<AsyncDependencyTracker> tracker =
+			PreGenerateStreamTask::create_tasks(block_box, stream_dependency, data, tasks);
+	ZN_TEST_ASSERT(tracker != nullptr);
+	ZN_TEST_ASSERT(tasks.size() == region_count);
+	ZN_TEST_ASSERT(tracker->get_remaining_count() == static_cast<int>(region_count));
+
+	// Metrics are shared by all streams of the same class
+	const uint64_t saved_blocks_before = stream->get_metrics().saved_blocks.load();
+
+	// Run tasks on this thread, so progress can be checked after each of them
+	LinearAllocator &temp_allocator = get_tls_temp_allocator();
+	for (unsigned int i = 0; i < tasks.size(); ++i) {
+		ZN_TEST_ASSERT(!tracker->is_complete());
+		ThreadedTaskContext ctx(0, TaskPriority(), temp_allocator);
+		tasks[i]->run(ctx);
+		ZN_DELETE(tasks[i]);
+		ZN_TEST_ASSERT(tracker->get_remaining_count() == static_cast<int>(region_count - i - 1));
+	}
+	ZN_TEST_ASSERT(tracker->is_complete());
+	ZN_TEST_ASSERT(!tracker->is_aborted());
+
+	// Every block was saved once, except the one that was already in the stream
+	const uint64_t block_count = Vector3iUtil::get_volume_u64(block_box.size);
+	ZN_TEST_ASSERT(stream->get_metrics().saved_blocks.load() - saved_blocks_before == block_count - 1);
+
+	block_box.for_each_cell([&stream, block_size, &saved_block_pos](Vector3i bpos) {
+		VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+		voxels.create(Vector3iUtil::create(block_size));
+		VoxelStream::VoxelQueryData q{ voxels, bpos, 0, VoxelStream::RESULT_ERROR };
+		stream->load_voxel_block(q);
+		ZN_TEST_ASSERT(q.result == VoxelStream::RESULT_BLOCK_FOUND);
+
+		const int expected_value = bpos == saved_block_pos ? saved_value : (bpos.y < 0 ? 1 : 0);
+		ZN_TEST_ASSERT(voxels.get_voxel(Vector3i(1, 1, 1), VoxelBuffer::CHANNEL_TYPE) == expected_value);
+	});
+}
+
 } // namespace zylann::voxel::tests
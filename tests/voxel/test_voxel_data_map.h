@@ -7,6 +7,15 @@ void test_voxel_data_map_paste_fill();
 void test_voxel_data_map_paste_mask();
 void test_voxel_data_map_paste_dst_mask();
 void test_voxel_data_map_copy();
+void test_voxel_data_save_copy_on_write();
+void test_voxel_data_mesh_snapshot();
+void test_voxel_data_edit_journal();
+void test_voxel_data_edit_journal_multiple_blocks();
+void test_voxel_data_edit_journal_capacity();
+void test_voxel_data_get_voxels_generated();
+void test_voxel_data_pre_generate_box();
+void test_voxel_data_pre_generate_to_stream();
+void test_voxel_data_read_view();
 
 } // namespace zylann::voxel::tests
 
@@ -0,0 +1,258 @@
+#include "test_voxel_generator_multipass_cb.h"
+#include "../../engine/buffered_task_scheduler.h"
+#include "../../generators/multipass/voxel_generator_multipass_cb_structs.h"
+#include "../../util/tasks/threaded_task.h"
+#include "../../util/testing/test_macros.h"
+
+namespace zylann::voxel::tests {
+
+namespace {
+
+class NoopTask : public IThreadedTask {
+public:
+	void run(ThreadedTaskContext &ctx) override {}
+};
+
+VoxelGeneratorMultipassCBStructs::SubpassWaiter make_subpass_waiter(
+		IThreadedTask *task,
+		std::shared_ptr<std::atomic_int> dependency_counter,
+		uint8_t subpass_index
+) {
+	VoxelGeneratorMultipassCBStructs::SubpassWaiter waiter;
+	waiter.task = task;
+	waiter.dependency_counter = dependency_counter;
+	waiter.subpass_index = subpass_index;
+	return waiter;
+}
+
+} // namespace
+
+void test_voxel_generator_multipass_cb_spilling() {
+	using namespace VoxelGeneratorMultipassCBStructs;
+
+	Internal internal;
+	Map &map = internal.map;
+
+	const Vector2i cpos(1, -2);
+	const Vector3i block_size(16, 16, 16);
+
+	Column &column = map.columns[cpos];
+	column.blocks.resize(3);
+	column.subpass_index = 0;
+
+	for (unsigned int block_index = 0; block_index < column.blocks.size(); ++block_index) {
+		VoxelBuffer &voxels = column.blocks[block_index].voxels;
+		voxels.create(block_size);
+		voxels.set_voxel(block_index + 1, Vector3i(1, 2, 3), VoxelBuffer::CHANNEL_TYPE);
+	}
+	// Left uniform, so it has no memory cost
+	column.blocks[2].voxels.fill(7, VoxelBuffer::CHANNEL_TYPE);
+
+	update_column_memory_usage(map, column);
+	const size_t memory_usage = map.memory_usage.load();
+	ZN_TEST_ASSERT(memory_usage > 0);
+	ZN_TEST_ASSERT(memory_usage == column.memory_usage);
+
+	// Spilled in memory, compressed
+	ZN_TEST_ASSERT(spill_column(internal, cpos, column));
+	ZN_TEST_ASSERT(column.spilled);
+	ZN_TEST_ASSERT(map.memory_usage.load() < memory_usage);
+	for (const Block &block : column.blocks) {
+		ZN_TEST_ASSERT(block.voxels.is_uniform(VoxelBuffer::CHANNEL_TYPE));
+	}
+
+	// Single blocks can be read without bringing back the column
+	{
+		VoxelBuffer voxels(VoxelBuffer::ALLOCATOR_DEFAULT);
+		ZN_TEST_ASSERT(load_spilled_block(internal, cpos, column, 1, voxels));
+		ZN_TEST_ASSERT(voxels.get_size() == block_size);
+		ZN_TEST_ASSERT(voxels.get_voxel(Vector3i(1, 2, 3), VoxelBuffer::CHANNEL_TYPE) == 2);
+		ZN_TEST_ASSERT(column.spilled);
+	}
+
+	ZN_TEST_ASSERT(unspill_column(internal, cpos, column));
+	ZN_TEST_ASSERT(!column.spilled);
+	ZN_TEST_ASSERT(column.spilled_data.size() == 0);
+	ZN_TEST_ASSERT(map.memory_usage.load() == memory_usage);
+	ZN_TEST_ASSERT(column.blocks[0].voxels.get_voxel(Vector3i(1, 2, 3), VoxelBuffer::CHANNEL_TYPE) == 1);
+	ZN_TEST_ASSERT(column.blocks[1].voxels.get_voxel(Vector3i(1, 2, 3), VoxelBuffer::CHANNEL_TYPE) == 2);
+	ZN_TEST_ASSERT(column.blocks[2].voxels.get_voxel(Vector3i(1, 2, 3), VoxelBuffer::CHANNEL_TYPE) == 7);
+
+	// Columns over budget get spilled
+	internal.cache_memory_budget_bytes = 1;
+	spill_least_recently_used_columns(internal);
+	ZN_TEST_ASSERT(column.spilled);
+
+	discard_spilled_column(map, cpos, column);
+	ZN_TEST_ASSERT(map.memory_usage.load() == 0);
+	map.columns.clear();
+}
+
+void test_voxel_generator_multipass_cb_unspill_failure() {
+	using namespace VoxelGeneratorMultipassCBStructs;
+
+	Internal internal;
+	Map &map = internal.map;
+
+	const Vector2i cpos(3, 4);
+
+	Column &column = map.columns[cpos];
+	column.blocks.resize(2);
+	column.subpass_index = 1;
+
+	for (Block &block : column.blocks) {
+		block.voxels.create(Vector3i(16, 16, 16));
+		block.voxels.set_voxel(1, Vector3i(1, 2, 3), VoxelBuffer::CHANNEL_TYPE);
+	}
+
+	update_column_memory_usage(map, column);
+	ZN_TEST_ASSERT(spill_column(internal, cpos, column));
+
+	// Only keep the block count and the size of the first block, as if the data got truncated
+	column.spilled_data.resize(8);
+	ZN_TEST_ASSERT(!unspill_column(internal, cpos, column));
+	ZN_TEST_ASSERT(column.spilled);
+
+	reset_unspillable_column(map, cpos, column);
+	ZN_TEST_ASSERT(!column.spilled);
+	ZN_TEST_ASSERT(column.spilled_data.size() == 0);
+	// The column has to go through all passes again
+	ZN_TEST_ASSERT(column.subpass_index == -1);
+	ZN_TEST_ASSERT(column.memory_usage == 0);
+	ZN_TEST_ASSERT(map.memory_usage.load() == 0);
+	for (const Block &block : column.blocks) {
+		ZN_TEST_ASSERT(block.voxels.get_size() == Vector3i());
+	}
+
+	map.columns.clear();
+}
+
+void test_voxel_generator_multipass_cb_spill_throttling() {
+	using namespace VoxelGeneratorMultipassCBStructs;
+
+	Internal internal;
+	Map &map = internal.map;
+	internal.cache_memory_budget_bytes = 1000;
+
+	struct L {
+		static Column &add_column(Map &map, Vector2i cpos) {
+			Column &column = map.columns[cpos];
+			column.blocks.resize(1);
+			column.subpass_index = 0;
+			VoxelBuffer &voxels = column.blocks[0].voxels;
+			voxels.create(Vector3i(16, 16, 16));
+			voxels.set_voxel(1, Vector3i(1, 2, 3), VoxelBuffer::CHANNEL_TYPE);
+			update_column_memory_usage(map, column);
+			return column;
+		}
+	};
+
+	const Vector2i cpos0(0, 0);
+	Column &column0 = L::add_column(map, cpos0);
+	ZN_TEST_ASSERT(map.memory_usage.load() > internal.cache_memory_budget_bytes);
+
+	// A task is working on the column, so it can't be spilled
+	const BoxBounds2i bounds0 = BoxBounds2i::from_position(cpos0);
+	map.spatial_lock.lock_write(bounds0);
+	spill_least_recently_used_columns(internal);
+	ZN_TEST_ASSERT(!column0.spilled);
+	ZN_TEST_ASSERT(map.spill_threshold.load() > map.memory_usage.load());
+	map.spatial_lock.unlock_write(bounds0);
+
+	// Not attempted again until memory usage grows
+	spill_least_recently_used_columns(internal);
+	ZN_TEST_ASSERT(!column0.spilled);
+
+	const Vector2i cpos1(1, 0);
+	Column &column1 = L::add_column(map, cpos1);
+	ZN_TEST_ASSERT(map.memory_usage.load() > map.spill_threshold.load());
+	spill_least_recently_used_columns(internal);
+	ZN_TEST_ASSERT(column0.spilled);
+	ZN_TEST_ASSERT(column1.spilled);
+	// Back under budget, the threshold is reset
+	ZN_TEST_ASSERT(map.spill_threshold.load() == 0);
+
+	discard_spilled_column(map, cpos0, column0);
+	discard_spilled_column(map, cpos1, column1);
+	map.columns.clear();
+}
+
+void test_voxel_generator_multipass_cb_subpass_waiters() {
+	using namespace VoxelGeneratorMultipassCBStructs;
+
+	Map map;
+	Column &column0 = map.columns[Vector2i(0, 0)];
+	Column &column1 = map.columns[Vector2i(1, 0)];
+
+	// A task depending on two columns being worked on by other tasks, at different subpasses
+	IThreadedTask *task = ZN_NEW(NoopTask);
+	std::shared_ptr<std::atomic_int> dependency_counter = make_shared_instance<std::atomic_int>(2);
+	column0.subpass_waiters.push_back(make_subpass_waiter(task, dependency_counter, 0));
+	column1.subpass_waiters.push_back(make_subpass_waiter(task, dependency_counter, 1));
+	map.subpass_waiter_count = 2;
+
+	BufferedTaskScheduler &task_scheduler = BufferedTaskScheduler::get_for_current_thread();
+
+	// Another subpass completing doesn't notify the task
+	schedule_subpass_waiters(map, column1, 0, task_scheduler);
+	ZN_TEST_ASSERT(column1.subpass_waiters.size() == 1);
+	ZN_TEST_ASSERT(dependency_counter->load() == 2);
+
+	// The task still waits for the other column
+	schedule_subpass_waiters(map, column0, 0, task_scheduler);
+	ZN_TEST_ASSERT(column0.subpass_waiters.size() == 0);
+	ZN_TEST_ASSERT(dependency_counter->load() == 1);
+	ZN_TEST_ASSERT(task_scheduler.get_main_count() == 0);
+
+	// Scheduled again once the last column it was blocked by finishes
+	schedule_subpass_waiters(map, column1, 1, task_scheduler);
+	ZN_TEST_ASSERT(column1.subpass_waiters.size() == 0);
+	ZN_TEST_ASSERT(dependency_counter->load() == 0);
+	ZN_TEST_ASSERT(task_scheduler.get_main_count() == 1);
+	ZN_TEST_ASSERT(map.subpass_waiter_count.load() == 0);
+
+	task_scheduler.flush();
+	map.columns.clear();
+}
+
+void test_voxel_generator_multipass_cb_schedule_all_subpass_waiters() {
+	using namespace VoxelGeneratorMultipassCBStructs;
+
+	Map map;
+	Column &column0 = map.columns[Vector2i(0, 0)];
+	Column &column1 = map.columns[Vector2i(1, 0)];
+
+	// One task waiting only on the column that is about to be removed, another also waiting on a different column
+	IThreadedTask *task0 = ZN_NEW(NoopTask);
+	std::shared_ptr<std::atomic_int> dependency_counter0 = make_shared_instance<std::atomic_int>(1);
+	column0.subpass_waiters.push_back(make_subpass_waiter(task0, dependency_counter0, 1));
+
+	IThreadedTask *task1 = ZN_NEW(NoopTask);
+	std::shared_ptr<std::atomic_int> dependency_counter1 = make_shared_instance<std::atomic_int>(2);
+	column0.subpass_waiters.push_back(make_subpass_waiter(task1, dependency_counter1, 2));
+	column1.subpass_waiters.push_back(make_subpass_waiter(task1, dependency_counter1, 0));
+
+	map.subpass_waiter_count = 3;
+
+	BufferedTaskScheduler &task_scheduler = BufferedTaskScheduler::get_for_current_thread();
+
+	// Waiters of every subpass are notified
+	schedule_all_subpass_waiters(map, column0, task_scheduler);
+	ZN_TEST_ASSERT(column0.subpass_waiters.size() == 0);
+	ZN_TEST_ASSERT(dependency_counter0->load() == 0);
+	ZN_TEST_ASSERT(dependency_counter1->load() == 1);
+	ZN_TEST_ASSERT(task_scheduler.get_main_count() == 1);
+	ZN_TEST_ASSERT(map.subpass_waiter_count.load() == 1);
+
+	// The task depending on another column still waits for it
+	ZN_TEST_ASSERT(column1.subpass_waiters.size() == 1);
+	schedule_all_subpass_waiters(map, column1, task_scheduler);
+	ZN_TEST_ASSERT(dependency_counter1->load() == 0);
+	ZN_TEST_ASSERT(task_scheduler.get_main_count() == 2);
+	ZN_TEST_ASSERT(map.subpass_waiter_count.load() == 0);
+
+	task_scheduler.flush();
+	map.columns.clear();
+}
+
+} // namespace zylann::voxel::tests
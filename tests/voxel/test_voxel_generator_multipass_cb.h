@@ -0,0 +1,14 @@
+#ifndef VOXEL_TESTS_VOXEL_GENERATOR_MULTIPASS_CB_H
+#define VOXEL_TESTS_VOXEL_GENERATOR_MULTIPASS_CB_H
+
+namespace zylann::voxel::tests {
+
+void test_voxel_generator_multipass_cb_spilling();
+void test_voxel_generator_multipass_cb_unspill_failure();
+void test_voxel_generator_multipass_cb_spill_throttling();
+void test_voxel_generator_multipass_cb_subpass_waiters();
+void test_voxel_generator_multipass_cb_schedule_all_subpass_waiters();
+
+} // namespace zylann::voxel::tests
+
+#endif // VOXEL_TESTS_VOXEL_GENERATOR_MULTIPASS_CB_H
@@ -219,4 +219,116 @@ void test_instance_generator_material_filter_issue774() {
 	ZN_TEST_ASSERT(transforms.size() > 0);
 }
 
+void test_instance_generator_filters() {
+	static constexpr float block_size = 16.f;
+	static constexpr int grid_size = 16;
+	static constexpr float slope = 0.9f;
+
+	// Sloped plane going up along X, so points have different heights and span all octants
+	Array mesh_arrays;
+	{
+		PackedVector3Array vertices;
+		PackedVector3Array normals;
+		PackedInt32Array indices;
+
+		const Vector3 normal = Vector3(-slope, 1, 0).normalized();
+
+		for (int z = 0; z <= grid_size; ++z) {
+			for (int x = 0; x <= grid_size; ++x) {
+				vertices.push_back(Vector3(x, x * slope, z));
+				normals.push_back(normal);
+			}
+		}
+
+		for (int z = 0; z < grid_size; ++z) {
+			for (int x = 0; x < grid_size; ++x) {
+				const int i00 = x + z * (grid_size + 1);
+				const int i10 = i00 + 1;
+				const int i01 = i00 + grid_size + 1;
+				const int i11 = i01 + 1;
+				indices.push_back(i00);
+				indices.push_back(i01);
+				indices.push_back(i10);
+				indices.push_back(i10);
+				indices.push_back(i01);
+				indices.push_back(i11);
+			}
+		}
+
+		mesh_arrays.resize(ArrayMesh::ARRAY_MAX);
+		mesh_arrays[ArrayMesh::ARRAY_VERTEX] = vertices;
+		mesh_arrays[ArrayMesh::ARRAY_NORMAL] = normals;
+		mesh_arrays[ArrayMesh::ARRAY_INDEX] = indices;
+	}
+
+	Ref<VoxelInstanceGenerator> generator;
+	generator.instantiate();
+	generator->set_emit_mode(VoxelInstanceGenerator::EMIT_FROM_FACES);
+	generator->set_density(1.f);
+	generator->set_offset_along_normal(0.f);
+
+	struct L {
+		static void generate(
+				VoxelInstanceGenerator &generator,
+				const Array &mesh_arrays,
+				const uint8_t octant_mask,
+				StdVector<Transform3f> &transforms
+		) {
+			generator.generate_transforms(
+					transforms,
+					Vector3i(0, 0, 0),
+					0,
+					0,
+					mesh_arrays,
+					-1,
+					-1,
+					UP_MODE_POSITIVE_Y,
+					octant_mask,
+					block_size,
+					Ref<VoxelGenerator>()
+			);
+		}
+	};
+
+	StdVector<Transform3f> all_transforms;
+	L::generate(**generator, mesh_arrays, 0xff, all_transforms);
+	ZN_TEST_ASSERT(all_transforms.size() > 0);
+
+	// Only keep octants on the negative side of X
+	const uint8_t octant_mask = 0b01010101;
+	StdVector<Transform3f> transforms;
+	L::generate(**generator, mesh_arrays, octant_mask, transforms);
+	ZN_TEST_ASSERT(transforms.size() > 0);
+	ZN_TEST_ASSERT(transforms.size() < all_transforms.size());
+	for (const Transform3f &t : transforms) {
+		ZN_TEST_ASSERT(t.origin.x <= block_size / 2.f);
+	}
+
+	// Without falloff, the height filter is a strict range
+	const float min_height = 2.f;
+	const float max_height = 6.f;
+	generator->set_min_height(min_height);
+	generator->set_max_height(max_height);
+	generator->set_min_height_falloff(0.f);
+	generator->set_max_height_falloff(0.f);
+	L::generate(**generator, mesh_arrays, 0xff, transforms);
+	ZN_TEST_ASSERT(transforms.size() > 0);
+	for (const Transform3f &t : transforms) {
+		ZN_TEST_ASSERT(t.origin.y >= min_height && t.origin.y <= max_height);
+	}
+
+	// The slope of the plane is about 42 degrees
+	generator->set_min_height(std::numeric_limits<float>::min());
+	generator->set_max_height(std::numeric_limits<float>::max());
+	generator->set_min_slope_falloff_degrees(0.f);
+	generator->set_max_slope_falloff_degrees(0.f);
+	generator->set_max_slope_degrees(30.f);
+	L::generate(**generator, mesh_arrays, 0xff, transforms);
+	ZN_TEST_ASSERT(transforms.size() == 0);
+
+	generator->set_max_slope_degrees(60.f);
+	L::generate(**generator, mesh_arrays, 0xff, transforms);
+	ZN_TEST_ASSERT(transforms.size() == all_transforms.size());
+}
+
 } // namespace zylann::voxel::tests
@@ -167,7 +167,7 @@ bool AStarGrid3D::is_ground_close_enough(Vector3i pos) {
 		if (!_region.contains(below_pos)) {
 			return false;
 		}
-		const bool below_c = is_solid(below_pos);
+		const bool below_c = is_solid_cached(below_pos);
 		if (below_c) {
 			return true;
 		}
@@ -181,7 +181,10 @@ bool AStarGrid3D::fits(Vector3f pos, Vector3f agent_extents) {
 							  to_vec3i(math::ceil(pos + agent_extents))
 	)
 							  .clipped(_region);
-	return box.all_cells_match([this](const Vector3i ipos) { return !is_solid(ipos); });
+	if (_region_cache != nullptr && _region_cache->region == _region) {
+		return !_region_cache->has_solid_cells(box);
+	}
+	return box.all_cells_match([this](const Vector3i ipos) { return !is_solid_cached(ipos); });
 }
 
 namespace {
@@ -205,7 +208,7 @@ void AStarGrid3D::get_neighbor_positions(Vector3i pos, StdVector<Vector3i> &out_
 	ZN_PROFILE_SCOPE();
 
 	const Vector3i pos_below = pos - Vector3i(0, 1, 0);
-	const bool c_below = is_solid(pos_below);
+	const bool c_below = is_solid_cached(pos_below);
 
 	bool may_jump = false;
 
@@ -216,7 +219,7 @@ void AStarGrid3D::get_neighbor_positions(Vector3i pos, StdVector<Vector3i> &out_
 			continue;
 		}
 
-		const bool nc = is_solid(npos);
+		const bool nc = is_solid_cached(npos);
 		if (nc) {
 			may_jump = true;
 			continue;
@@ -228,7 +231,7 @@ void AStarGrid3D::get_neighbor_positions(Vector3i pos, StdVector<Vector3i> &out_
 				if (!_region.contains(npos_below)) {
 					continue;
 				}
-				const bool npos_below_c = is_solid(npos_below);
+				const bool npos_below_c = is_solid_cached(npos_below);
 				if (npos_below_c == false) {
 					// Can't fly
 					continue;
@@ -261,7 +264,7 @@ void AStarGrid3D::get_neighbor_positions(Vector3i pos, StdVector<Vector3i> &out_
 
 	{
 		// ZN_PROFILE_SCOPE_NAMED("Agent fitting checks");
-		// TODO This takes half of time in profiled results
+		// This used to take half of time in profiled results. It is much cheaper when a region cache is used.
 
 		unordered_remove_if(out_positions, [this, pos](Vector3i npos) {
 			// Check if fits the target cell
@@ -329,6 +332,58 @@ void AStarGrid3D::debug_get_visited_points(StdVector<Vector3i> &out_positions) c
 	}
 }
 
+void AStarGrid3D::set_region_cache(std::shared_ptr<const RegionCache> cache) {
+	_region_cache = cache;
+}
+
+void AStarGrid3D::RegionCache::create(Box3i p_region, unsigned int p_chunk_size_po2) {
+	ZN_ASSERT_RETURN(p_chunk_size_po2 >= 2);
+	region = p_region;
+	chunk_size_po2 = p_chunk_size_po2;
+	if (region.is_empty()) {
+		aligned_box = Box3i();
+		chunk_grid_size = Vector3i();
+		solid_bits.clear();
+		return;
+	}
+	aligned_box = region.snapped(1 << chunk_size_po2);
+	chunk_grid_size = aligned_box.size >> chunk_size_po2;
+	solid_bits.resize_no_init(Vector3iUtil::get_volume_u64(aligned_box.size));
+	solid_bits.fill(false);
+}
+
+bool AStarGrid3D::RegionCache::has_solid_cells(Box3i box) const {
+#ifdef DEV_ENABLED
+	ZN_ASSERT(aligned_box.contains(box));
+#endif
+	if (Vector3iUtil::get_volume_u64(box.size) == 0) {
+		return false;
+	}
+	const int chunk_size = 1 << chunk_size_po2;
+	const Vector3i chunk_size_v = Vector3iUtil::create(chunk_size);
+	const Vector3i min_pos = box.position - aligned_box.position;
+	const Vector3i max_pos = min_pos + box.size;
+
+	Vector3i apos;
+	for (apos.z = min_pos.z; apos.z < max_pos.z; ++apos.z) {
+		for (apos.x = min_pos.x; apos.x < max_pos.x; ++apos.x) {
+			apos.y = min_pos.y;
+			// The column may cross several chunks
+			while (apos.y < max_pos.y) {
+				const Vector3i cpos = apos >> chunk_size_po2;
+				const Vector3i rpos = apos & (chunk_size - 1);
+				const int count = math::min(max_pos.y - apos.y, chunk_size - rpos.y);
+				const uint64_t begin = get_chunk_bit_offset(cpos) + Vector3iUtil::get_zxy_index(rpos, chunk_size_v);
+				if (!solid_bits.is_range_clear(begin, count)) {
+					return true;
+				}
+				apos.y += count;
+			}
+		}
+	}
+	return false;
+}
+
 bool AStarGrid3D::debug_get_next_step_point(Vector3i &out_pos) const {
 	if (_open_list.size() == 0) {
 		return false;
@@ -1,12 +1,14 @@
 #ifndef ZN_ASTAR_GRID_3D_H
 #define ZN_ASTAR_GRID_3D_H
 
+#include "../util/containers/dynamic_bitset.h"
 #include "../util/containers/std_unordered_map.h"
 #include "../util/containers/std_vector.h"
 #include "../util/godot/core/sort_array.h"
 #include "../util/math/box3i.h"
 #include "../util/math/vector3f.h"
 #include <limits>
+#include <memory>
 #include <unordered_map>
 
 namespace zylann {
@@ -45,10 +47,65 @@ public:
 	void debug_get_visited_points(StdVector<Vector3i> &out_positions) const;
 	bool debug_get_next_step_point(Vector3i &out_pos) const;
 
+	// Precomputed solidity of a whole search region, using one bit per cell. When used, `is_solid` is no longer called,
+	// and agent fitting checks test whole columns of cells at once. It is not modified once built, so the same cache
+	// can be shared by searches running in parallel on the same region.
+	struct RegionCache {
+		// Region the cache was built for
+		Box3i region;
+		// Area covered by solid bits. It is larger than the region, in order to be aligned to chunks.
+		Box3i aligned_box;
+		Vector3i chunk_grid_size;
+		unsigned int chunk_size_po2 = 0;
+		// Solid bits grouped by chunk, so each chunk can be filled from a contiguous range. Chunks are in ZXY order,
+		// and bits within each chunk are in ZXY order too. So a column of cells along Y is a contiguous range of bits.
+		DynamicBitset solid_bits;
+
+		// Allocates bits, initially not solid. `chunk_size_po2` is expected to be at least 2.
+		void create(Box3i p_region, unsigned int p_chunk_size_po2);
+
+		// Gets the index of the first bit of a chunk. `cpos` is in chunk coordinates relative to `aligned_box`.
+		inline uint64_t get_chunk_bit_offset(Vector3i cpos) const {
+			const uint64_t chunk_volume = uint64_t(1) << (3 * chunk_size_po2);
+			return Vector3iUtil::get_zxy_index(cpos, chunk_grid_size) * chunk_volume;
+		}
+
+		inline bool is_solid(Vector3i pos) const {
+			if (!aligned_box.contains(pos)) {
+				return false;
+			}
+			const Vector3i apos = pos - aligned_box.position;
+			const Vector3i cpos = apos >> chunk_size_po2;
+			const Vector3i rpos = apos & ((1 << chunk_size_po2) - 1);
+			const uint64_t i = get_chunk_bit_offset(cpos) +
+					Vector3iUtil::get_zxy_index(rpos, Vector3iUtil::create(1 << chunk_size_po2));
+			return solid_bits.get(i);
+		}
+
+		// Tells if any cell of a box is solid. The box must be contained within `aligned_box`.
+		// Cells are tested one column at a time, using word operations, so the cost depends on the horizontal size of
+		// the box rather than its volume.
+		bool has_solid_cells(Box3i box) const;
+	};
+
+	void set_region_cache(std::shared_ptr<const RegionCache> cache);
+
+	inline const std::shared_ptr<const RegionCache> &get_region_cache() const {
+		return _region_cache;
+	}
+
 protected:
 	virtual bool is_solid(Vector3i pos);
 
 private:
+	inline bool is_solid_cached(Vector3i pos) {
+		// The cache may have been built for a different region
+		if (_region_cache != nullptr && _region_cache->region.contains(pos)) {
+			return _region_cache->is_solid(pos);
+		}
+		return is_solid(pos);
+	}
+
 	float evaluate_heuristic(Vector3i pos, Vector3i target_pos) const;
 	void reconstruct_path(uint32_t end_point_index);
 	void get_neighbor_positions(Vector3i pos, StdVector<Vector3i> &out_positions);
@@ -162,6 +219,8 @@ private:
 
 	StdVector<Vector3i> _path;
 	StdVector<Vector3i> _neighbor_positions;
+
+	std::shared_ptr<const RegionCache> _region_cache;
 };
 
 } // namespace zylann
@@ -0,0 +1,333 @@
+#include "block_island_finder.h"
+#include "containers/fixed_array.h"
+#include "errors.h"
+#include "math/vector3i.h"
+#include "profiling.h"
+#include <cstring>
+
+namespace zylann {
+
+void BlockIslandFinder::init(Span<const uint8_t> cells, Vector3i size) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN(Vector3iUtil::is_valid_size(size));
+	ZN_ASSERT_RETURN(cells.size() == Vector3iUtil::get_volume_u64(size));
+
+	_cells = cells;
+	_size = size;
+	_block_grid_size = math::ceildiv(size, int(BLOCK_SIZE));
+
+	_blocks.resize(Vector3iUtil::get_volume_u64(_block_grid_size));
+
+	const Box3i grid_box(Vector3i(), size);
+
+	unsigned int block_index = 0;
+	Vector3i bpos;
+	for (bpos.z = 0; bpos.z < _block_grid_size.z; ++bpos.z) {
+		for (bpos.x = 0; bpos.x < _block_grid_size.x; ++bpos.x) {
+			for (bpos.y = 0; bpos.y < _block_grid_size.y; ++bpos.y) {
+				Block &block = _blocks[block_index];
+				block.box = Box3i(bpos * int(BLOCK_SIZE), Vector3iUtil::create(BLOCK_SIZE)).clipped(grid_box);
+				block.state = BLOCK_EMPTY;
+				block.local_label_count = 0;
+				block.first_label = 0;
+				++block_index;
+			}
+		}
+	}
+
+	_local_labels.resize(cells.size());
+	_parents.clear();
+	_island_indices.clear();
+}
+
+void BlockIslandFinder::scan_block(unsigned int block_index) {
+	ZN_ASSERT_RETURN(block_index < _blocks.size());
+	Block &block = _blocks[block_index];
+	const Box3i box = block.box;
+
+	// Summarize
+
+	unsigned int solid_count = 0;
+	{
+		Vector3i pos;
+		for (pos.z = box.position.z; pos.z < box.position.z + box.size.z; ++pos.z) {
+			for (pos.x = box.position.x; pos.x < box.position.x + box.size.x; ++pos.x) {
+				pos.y = box.position.y;
+				const unsigned int row_index = Vector3iUtil::get_zxy_index(pos, _size);
+				for (int y = 0; y < box.size.y; ++y) {
+					solid_count += (_cells[row_index + y] != 0);
+				}
+			}
+		}
+	}
+
+	if (solid_count == 0) {
+		block.state = BLOCK_EMPTY;
+		return;
+	}
+	if (solid_count == Vector3iUtil::get_volume_u64(box.size)) {
+		block.state = BLOCK_FULL;
+		return;
+	}
+
+	block.state = BLOCK_MIXED;
+
+	// Label at full resolution with flood-fills, which don't need equivalence tables since the area is small.
+	// Positions in the stack are local to the block, packed in 3 bits per coordinate.
+	static_assert(BLOCK_SIZE_PO2 * 3 <= 16);
+	FixedArray<uint16_t, BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE> stack;
+	unsigned int stack_size = 0;
+
+	const Vector3i &bmin = box.position;
+	const Vector3i &bsize = box.size;
+
+	{
+		Vector3i pos;
+		for (pos.z = 0; pos.z < bsize.z; ++pos.z) {
+			for (pos.x = 0; pos.x < bsize.x; ++pos.x) {
+				const unsigned int row_index = Vector3iUtil::get_zxy_index(bmin + Vector3i(pos.x, 0, pos.z), _size);
+				for (pos.y = 0; pos.y < bsize.y; ++pos.y) {
+					_local_labels[row_index + pos.y] = 0;
+				}
+			}
+		}
+	}
+
+	uint16_t next_label = 1;
+
+	Vector3i pos;
+	for (pos.z = 0; pos.z < bsize.z; ++pos.z) {
+		for (pos.x = 0; pos.x < bsize.x; ++pos.x) {
+			for (pos.y = 0; pos.y < bsize.y; ++pos.y) {
+				const unsigned int seed_index = Vector3iUtil::get_zxy_index(bmin + pos, _size);
+				if (_cells[seed_index] == 0 || _local_labels[seed_index] != 0) {
+					continue;
+				}
+
+				const uint16_t label = next_label;
+				++next_label;
+
+				_local_labels[seed_index] = label;
+				stack[0] = pos.x | (pos.y << BLOCK_SIZE_PO2) | (pos.z << (2 * BLOCK_SIZE_PO2));
+				stack_size = 1;
+
+				while (stack_size > 0) {
+					--stack_size;
+					const uint16_t packed = stack[stack_size];
+					const Vector3i cpos( //
+							packed & (BLOCK_SIZE - 1),
+							(packed >> BLOCK_SIZE_PO2) & (BLOCK_SIZE - 1),
+							packed >> (2 * BLOCK_SIZE_PO2)
+					);
+
+					static const Vector3i s_dirs[6] = {
+						Vector3i(-1, 0, 0), //
+						Vector3i(1, 0, 0), //
+						Vector3i(0, -1, 0), //
+						Vector3i(0, 1, 0), //
+						Vector3i(0, 0, -1), //
+						Vector3i(0, 0, 1) //
+					};
+
+					for (unsigned int dir_index = 0; dir_index < 6; ++dir_index) {
+						const Vector3i npos = cpos + s_dirs[dir_index];
+						if (npos.x < 0 || npos.y < 0 || npos.z < 0 || npos.x >= bsize.x || npos.y >= bsize.y ||
+							npos.z >= bsize.z) {
+							continue;
+						}
+						const unsigned int nindex = Vector3iUtil::get_zxy_index(bmin + npos, _size);
+						if (_cells[nindex] == 0 || _local_labels[nindex] != 0) {
+							continue;
+						}
+						_local_labels[nindex] = label;
+						// Cells are labelled when pushed, so the stack can't hold more than the block's volume
+						stack[stack_size] = npos.x | (npos.y << BLOCK_SIZE_PO2) | (npos.z << (2 * BLOCK_SIZE_PO2));
+						++stack_size;
+					}
+				}
+			}
+		}
+	}
+
+	block.local_label_count = next_label - 1;
+}
+
+uint32_t BlockIslandFinder::get_label(const Block &block, unsigned int cell_index) const {
+	if (block.state == BLOCK_FULL) {
+		return block.first_label;
+	}
+	return block.first_label + _local_labels[cell_index] - 1;
+}
+
+uint32_t BlockIslandFinder::find_root(uint32_t label) {
+	// Path halving
+	while (_parents[label] != label) {
+		_parents[label] = _parents[_parents[label]];
+		label = _parents[label];
+	}
+	return label;
+}
+
+void BlockIslandFinder::merge_labels(uint32_t a, uint32_t b) {
+	a = find_root(a);
+	b = find_root(b);
+	// The smallest label is always the root, which allows assigning island indices in a single pass later
+	if (a < b) {
+		_parents[b] = a;
+	} else if (b < a) {
+		_parents[a] = b;
+	}
+}
+
+void BlockIslandFinder::merge_face(const Block &a, const Block &b, unsigned int axis) {
+	// `b` is the neighbor of `a` towards the positive side of `axis`
+	Box3i face = a.box;
+	face.position[axis] += face.size[axis] - 1;
+	face.size[axis] = 1;
+
+	const Vector3i fmax = face.position + face.size;
+	Vector3i offset;
+	offset[axis] = 1;
+
+	Vector3i pos;
+	for (pos.z = face.position.z; pos.z < fmax.z; ++pos.z) {
+		for (pos.x = face.position.x; pos.x < fmax.x; ++pos.x) {
+			for (pos.y = face.position.y; pos.y < fmax.y; ++pos.y) {
+				const unsigned int ia = Vector3iUtil::get_zxy_index(pos, _size);
+				const unsigned int ib = Vector3iUtil::get_zxy_index(pos + offset, _size);
+				if (_cells[ia] != 0 && _cells[ib] != 0) {
+					merge_labels(get_label(a, ia), get_label(b, ib));
+				}
+			}
+		}
+	}
+}
+
+bool BlockIslandFinder::merge(unsigned int &out_island_count) {
+	ZN_PROFILE_SCOPE();
+
+	uint32_t label_count = 0;
+	for (Block &block : _blocks) {
+		block.first_label = label_count;
+		if (block.state == BLOCK_FULL) {
+			label_count += 1;
+		} else if (block.state == BLOCK_MIXED) {
+			label_count += block.local_label_count;
+		}
+	}
+
+	_parents.resize(label_count);
+	for (uint32_t i = 0; i < label_count; ++i) {
+		_parents[i] = i;
+	}
+
+	const int block_stride[3] = { _block_grid_size.y, 1, _block_grid_size.x * _block_grid_size.y };
+
+	unsigned int block_index = 0;
+	Vector3i bpos;
+	for (bpos.z = 0; bpos.z < _block_grid_size.z; ++bpos.z) {
+		for (bpos.x = 0; bpos.x < _block_grid_size.x; ++bpos.x) {
+			for (bpos.y = 0; bpos.y < _block_grid_size.y; ++bpos.y, ++block_index) {
+				const Block &block = _blocks[block_index];
+				if (block.state == BLOCK_EMPTY) {
+					continue;
+				}
+				for (unsigned int axis = 0; axis < Vector3iUtil::AXIS_COUNT; ++axis) {
+					if (bpos[axis] + 1 >= _block_grid_size[axis]) {
+						continue;
+					}
+					const Block &neighbor = _blocks[block_index + block_stride[axis]];
+					if (neighbor.state == BLOCK_EMPTY) {
+						continue;
+					}
+					if (block.state == BLOCK_FULL && neighbor.state == BLOCK_FULL) {
+						merge_labels(block.first_label, neighbor.first_label);
+					} else {
+						merge_face(block, neighbor, axis);
+					}
+				}
+			}
+		}
+	}
+
+	// Assign consecutive island indices starting from 1. Roots are always the smallest label of their set, so they
+	// are visited before the other labels of that set.
+	_island_indices.resize(label_count);
+	unsigned int island_count = 0;
+	for (uint32_t label = 0; label < label_count; ++label) {
+		const uint32_t root = find_root(label);
+		if (root == label) {
+			if (island_count == MAX_ISLANDS) {
+				return false;
+			}
+			++island_count;
+			_island_indices[label] = island_count;
+		} else {
+			_island_indices[label] = _island_indices[root];
+		}
+	}
+
+	out_island_count = island_count;
+	return true;
+}
+
+void BlockIslandFinder::write_block_labels(unsigned int block_index, Span<uint8_t> output) const {
+	ZN_ASSERT_RETURN(block_index < _blocks.size());
+	ZN_ASSERT_RETURN(output.size() == _cells.size());
+	const Block &block = _blocks[block_index];
+	const Box3i box = block.box;
+
+	Vector3i pos;
+	for (pos.z = box.position.z; pos.z < box.position.z + box.size.z; ++pos.z) {
+		for (pos.x = box.position.x; pos.x < box.position.x + box.size.x; ++pos.x) {
+			pos.y = box.position.y;
+			const unsigned int row_index = Vector3iUtil::get_zxy_index(pos, _size);
+
+			switch (block.state) {
+				case BLOCK_EMPTY:
+					memset(&output[row_index], 0, box.size.y);
+					break;
+
+				case BLOCK_FULL:
+					memset(&output[row_index], _island_indices[block.first_label], box.size.y);
+					break;
+
+				case BLOCK_MIXED:
+					for (int y = 0; y < box.size.y; ++y) {
+						const unsigned int i = row_index + y;
+						const uint16_t local_label = _local_labels[i];
+						output[i] = local_label == 0 ? 0 : _island_indices[block.first_label + local_label - 1];
+					}
+					break;
+			}
+		}
+	}
+}
+
+bool BlockIslandFinder::scan_3d(
+		Span<const uint8_t> cells,
+		Vector3i size,
+		Span<uint8_t> output,
+		unsigned int &out_island_count
+) {
+	ZN_PROFILE_SCOPE();
+	ZN_ASSERT_RETURN_V(output.size() == cells.size(), false);
+
+	init(cells, size);
+
+	for (unsigned int i = 0; i < _blocks.size(); ++i) {
+		scan_block(i);
+	}
+
+	if (!merge(out_island_count)) {
+		return false;
+	}
+
+	for (unsigned int i = 0; i < _blocks.size(); ++i) {
+		write_block_labels(i, output);
+	}
+
+	return true;
+}
+
+} // namespace zylann
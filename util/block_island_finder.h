@@ -0,0 +1,87 @@
+#ifndef ZN_BLOCK_ISLAND_FINDER_H
+#define ZN_BLOCK_ISLAND_FINDER_H
+
+#include "containers/span.h"
+#include "containers/std_vector.h"
+#include "math/box3i.h"
+
+namespace zylann {
+
+// Labels contiguous islands of solid cells in a grid, like `IslandFinder`, but in two levels so it scales better with
+// large grids and can be spread over multiple threads.
+//
+// The grid is subdivided in small blocks, each summarized as either empty, full or mixed. Only mixed blocks are
+// labelled at full resolution, which can be done in parallel since blocks don't depend on each other. Then labels are
+// merged across block faces using union-find. Full blocks are a single label, so big solid areas cost very little.
+//
+// Usage:
+// - `init`
+// - `scan_block` for every block (can be called from different threads, with different indices)
+// - `merge` (single-threaded)
+// - `write_block_labels` for every block (can be called from different threads, with different indices)
+//
+// `scan_3d` does all of this on the calling thread.
+//
+// Cells are expected in ZXY order. Non-zero means solid. Islands are connected through faces only.
+//
+class BlockIslandFinder {
+public:
+	static const unsigned int BLOCK_SIZE_PO2 = 3;
+	static const unsigned int BLOCK_SIZE = 1 << BLOCK_SIZE_PO2;
+	// Labels are output as 8-bit integers, where 0 means "no island"
+	static const unsigned int MAX_ISLANDS = 255;
+
+	// The cells span must remain valid until labels are written.
+	void init(Span<const uint8_t> cells, Vector3i size);
+
+	unsigned int get_block_count() const {
+		return _blocks.size();
+	}
+
+	void scan_block(unsigned int block_index);
+
+	// Connects labels across blocks and assigns final labels. Returns false if more than `MAX_ISLANDS` were found.
+	bool merge(unsigned int &out_island_count);
+
+	// Output must have the same size as the input grid.
+	void write_block_labels(unsigned int block_index, Span<uint8_t> output) const;
+
+	bool scan_3d(Span<const uint8_t> cells, Vector3i size, Span<uint8_t> output, unsigned int &out_island_count);
+
+private:
+	enum BlockState : uint8_t { //
+		BLOCK_EMPTY,
+		BLOCK_FULL,
+		BLOCK_MIXED
+	};
+
+	struct Block {
+		// Area covered by the block within the grid. Blocks at the end of the grid can be smaller.
+		Box3i box;
+		BlockState state = BLOCK_EMPTY;
+		// Only relevant for mixed blocks
+		uint16_t local_label_count = 0;
+		// Index of the block's first label in the union-find table
+		uint32_t first_label = 0;
+	};
+
+	uint32_t get_label(const Block &block, unsigned int cell_index) const;
+	uint32_t find_root(uint32_t label);
+	void merge_labels(uint32_t a, uint32_t b);
+	void merge_face(const Block &a, const Block &b, unsigned int axis);
+
+	Span<const uint8_t> _cells;
+	Vector3i _size;
+	Vector3i _block_grid_size;
+	StdVector<Block> _blocks;
+	// Labels local to each mixed block, starting from 1. Same layout as the grid.
+	StdVector<uint16_t> _local_labels;
+	// Union-find table of all labels
+	StdVector<uint32_t> _parents;
+	// Final island index of each label
+	StdVector<uint8_t> _island_indices;
+};
+
+} // namespace zylann
+
+#endif // ZN_BLOCK_ISLAND_FINDER_H
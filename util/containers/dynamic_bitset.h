@@ -62,6 +62,30 @@ public:
 		}
 	}
 
+	// Tells if all bits from `begin` to `begin + count - 1` are unset. Tests 64 bits at a time.
+	bool is_range_clear(uint64_t begin, uint64_t count) const {
+		if (count == 0) {
+			return true;
+		}
+		const uint64_t end = begin + count;
+#ifdef DEBUG_ENABLED
+		ZN_ASSERT(end <= _size);
+#endif
+		const uint64_t last_word_index = (end - 1) >> 6;
+		uint64_t mask = ~uint64_t(0) << (begin & uint64_t(63));
+		for (uint64_t word_index = begin >> 6; word_index < last_word_index; ++word_index) {
+			if ((_bits[word_index] & mask) != 0) {
+				return false;
+			}
+			mask = ~uint64_t(0);
+		}
+		const uint64_t end_bit = end & uint64_t(63);
+		if (end_bit != 0) {
+			mask &= (uint64_t(1) << end_bit) - 1;
+		}
+		return (_bits[last_word_index] & mask) == 0;
+	}
+
 private:
 	StdVector<uint64_t> _bits;
 	unsigned int _size = 0;
@@ -1,4 +1,5 @@
 #include "mesh.h"
+#include "../../errors.h"
 
 namespace zylann::godot {
 
@@ -54,4 +55,74 @@ void offset_surface(Array &surface, Vector3 offset) {
 	surface[Mesh::ARRAY_VERTEX] = positions;
 }
 
+size_t get_surface_size_in_bytes(const Array &surface) {
+	size_t size = 0;
+	for (int i = 0; i < surface.size(); ++i) {
+		const Variant v = surface[i];
+		switch (v.get_type()) {
+			case Variant::PACKED_BYTE_ARRAY:
+				size += PackedByteArray(v).size();
+				break;
+			case Variant::PACKED_INT32_ARRAY:
+				size += PackedInt32Array(v).size() * sizeof(int32_t);
+				break;
+			case Variant::PACKED_FLOAT32_ARRAY:
+				size += PackedFloat32Array(v).size() * sizeof(float);
+				break;
+			case Variant::PACKED_FLOAT64_ARRAY:
+				size += PackedFloat64Array(v).size() * sizeof(double);
+				break;
+			case Variant::PACKED_VECTOR2_ARRAY:
+				size += PackedVector2Array(v).size() * sizeof(Vector2);
+				break;
+			case Variant::PACKED_VECTOR3_ARRAY:
+				size += PackedVector3Array(v).size() * sizeof(Vector3);
+				break;
+			case Variant::PACKED_COLOR_ARRAY:
+				size += PackedColorArray(v).size() * sizeof(Color);
+				break;
+			default:
+				break;
+		}
+	}
+	return size;
+}
+
+#ifdef ZN_GODOT_PACKED_SURFACES
+
+bool pack_surface(const Array &arrays, Mesh::PrimitiveType primitive, uint64_t flags, PackedSurface &out_surface) {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ZN_ASSERT_RETURN_V(rs != nullptr, false);
+	const Error err = rs->mesh_create_surface_data_from_arrays(
+			&out_surface,
+			static_cast<RenderingServerEnums::PrimitiveType>(primitive),
+			arrays,
+			Array(),
+			Dictionary(),
+			flags
+	);
+	return err == OK;
+}
+
+void add_packed_surface(ArrayMesh &mesh, const PackedSurface &surface) {
+	// Same as what `add_surface_from_arrays` does after conversion
+	mesh.add_surface(
+			surface.format,
+			static_cast<Mesh::PrimitiveType>(surface.primitive),
+			surface.vertex_data,
+			surface.attribute_data,
+			surface.skin_data,
+			surface.vertex_count,
+			surface.index_data,
+			surface.index_count,
+			surface.aabb,
+			surface.blend_shape_data,
+			surface.bone_aabbs,
+			surface.lods,
+			surface.uv_scale
+	);
+}
+
+#endif
+
 } // namespace zylann::godot
@@ -4,7 +4,16 @@
 #include "../../containers/span.h"
 
 #if defined(ZN_GODOT)
+#include "../core/version.h"
+#include "rendering_server.h"
 #include <scene/resources/mesh.h>
+
+#if !(GODOT_VERSION_MAJOR == 4 && GODOT_VERSION_MINOR <= 1)
+// Surfaces can be converted to renderer buffers ahead of time, and added to a mesh later with little processing.
+// This is not exposed to extensions.
+#define ZN_GODOT_PACKED_SURFACES
+#endif
+
 #elif defined(ZN_GODOT_EXTENSION)
 #include <godot_cpp/classes/mesh.hpp>
 using namespace godot;
@@ -22,6 +31,22 @@ void offset_vec3_array(PackedVector3Array &array, Vector3 offset);
 void scale_surface(Array &surface, float scale);
 void offset_surface(Array &surface, Vector3 offset);
 
+// Gets an estimation of how much memory is used by arrays of a surface.
+size_t get_surface_size_in_bytes(const Array &surface);
+
+#ifdef ZN_GODOT_PACKED_SURFACES
+
+typedef RenderingServer::SurfaceData PackedSurface;
+
+// Converts surface arrays into the vertex and index buffers used by the renderer, applying compression if requested
+// in `flags`. It does not change the state of the RenderingServer, so it can run in any thread.
+bool pack_surface(const Array &arrays, Mesh::PrimitiveType primitive, uint64_t flags, PackedSurface &out_surface);
+
+// Equivalent to `ArrayMesh::add_surface_from_arrays`, with the conversion already done.
+void add_packed_surface(ArrayMesh &mesh, const PackedSurface &surface);
+
+#endif
+
 } // namespace zylann::godot
 
 #endif // ZN_GODOT_MESH_H
@@ -3,6 +3,7 @@
 
 #include "math/funcs.h"
 #include <cstdint>
+#include <cstring>
 
 namespace zylann {
 
@@ -43,6 +44,59 @@ inline uint32_t hash_fmix32(uint32_t h) {
 	return h;
 }
 
+// MurmurHash64A, processing 8 bytes at a time. Suitable for hashing large buffers quickly.
+inline uint64_t hash_murmur64a_buffer(const uint8_t *data, size_t size, uint64_t seed = HASH_MURMUR3_SEED) {
+	const uint64_t m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+
+	uint64_t h = seed ^ (size * m);
+
+	const size_t word_count = size / 8;
+	for (size_t i = 0; i < word_count; ++i) {
+		uint64_t k;
+		// Buffers may not be aligned
+		memcpy(&k, data + i * 8, sizeof(k));
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	const uint8_t *tail = data + word_count * 8;
+	switch (size & 7) {
+		case 7:
+			h ^= uint64_t(tail[6]) << 48;
+			[[fallthrough]];
+		case 6:
+			h ^= uint64_t(tail[5]) << 40;
+			[[fallthrough]];
+		case 5:
+			h ^= uint64_t(tail[4]) << 32;
+			[[fallthrough]];
+		case 4:
+			h ^= uint64_t(tail[3]) << 24;
+			[[fallthrough]];
+		case 3:
+			h ^= uint64_t(tail[2]) << 16;
+			[[fallthrough]];
+		case 2:
+			h ^= uint64_t(tail[1]) << 8;
+			[[fallthrough]];
+		case 1:
+			h ^= uint64_t(tail[0]);
+			h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
+
 } // namespace zylann
 
 #endif // ZN_HASH_FUNCS_H
@@ -214,7 +214,8 @@ public:
 
 	// Subtracts another box from the current box.
 	// If any, boxes composing the remaining volume are added to the given vector.
-	inline void difference_to_vec(const Box3i &b, StdVector<Box3i> &output) const {
+	template <typename TAllocator>
+	inline void difference_to_vec(const Box3i &b, StdVector<Box3i, TAllocator> &output) const {
 		difference(b, [&output](const Box3i &sub_box) { output.push_back(sub_box); });
 	}
 
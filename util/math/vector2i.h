@@ -36,6 +36,10 @@ inline unsigned int get_yx_index(const Vector2i v, const Vector2i area_size) {
 	return v.x + v.y * area_size.x;
 }
 
+inline Vector2i from_yx_index(unsigned int i, const Vector2i area_size) {
+	return Vector2i(i % area_size.x, i / area_size.x);
+}
+
 } // namespace Vector2iUtil
 
 namespace math {
@@ -0,0 +1,120 @@
+#include "linear_allocator.h"
+#include "../math/funcs.h"
+#include "memory.h"
+
+namespace zylann {
+
+LinearAllocator::LinearAllocator(size_t chunk_size) : _chunk_size(chunk_size) {
+	ZN_ASSERT(chunk_size > 0);
+}
+
+LinearAllocator::~LinearAllocator() {
+	for (Chunk &chunk : _chunks) {
+		ZN_FREE(chunk.data);
+	}
+}
+
+void *LinearAllocator::try_allocate_in_current_chunk(size_t size, size_t alignment) {
+	const Chunk &chunk = _chunks[_chunk_index];
+	// Align the address rather than the offset, since chunk memory only has the heap's default alignment
+	const uintptr_t begin = reinterpret_cast<uintptr_t>(chunk.data);
+	const uintptr_t aligned = math::alignup(begin + _offset, alignment);
+	const size_t new_offset = aligned - begin + size;
+	if (new_offset > chunk.size) {
+		return nullptr;
+	}
+	_offset = new_offset;
+	return reinterpret_cast<void *>(aligned);
+}
+
+void *LinearAllocator::allocate(size_t size, size_t alignment) {
+	ZN_ASSERT(math::is_power_of_two(alignment));
+
+	if (_chunks.size() > 0) {
+		void *p = try_allocate_in_current_chunk(size, alignment);
+		if (p != nullptr) {
+			return p;
+		}
+		++_chunk_index;
+	}
+
+	// Enough to fit the allocation regardless of the chunk's alignment
+	const size_t min_chunk_size = size + alignment;
+
+	if (_chunk_index < _chunks.size()) {
+		Chunk &chunk = _chunks[_chunk_index];
+		if (chunk.size < min_chunk_size) {
+			// Replace the next chunk with a bigger one. It is unused, since it is after the current position.
+			_capacity -= chunk.size;
+			ZN_FREE(chunk.data);
+			chunk.size = math::max(_chunk_size, min_chunk_size);
+			chunk.data = static_cast<uint8_t *>(ZN_ALLOC(chunk.size));
+			ZN_ASSERT(chunk.data != nullptr);
+			_capacity += chunk.size;
+		}
+	} else {
+		Chunk chunk;
+		chunk.size = math::max(_chunk_size, min_chunk_size);
+		chunk.data = static_cast<uint8_t *>(ZN_ALLOC(chunk.size));
+		ZN_ASSERT(chunk.data != nullptr);
+		_capacity += chunk.size;
+		_chunks.push_back(chunk);
+		_chunk_index = _chunks.size() - 1;
+	}
+
+	_offset = 0;
+	void *p = try_allocate_in_current_chunk(size, alignment);
+	ZN_ASSERT(p != nullptr);
+	return p;
+}
+
+void LinearAllocator::deallocate(void *p, size_t size) {
+	if (_chunks.size() == 0) {
+		return;
+	}
+	const Chunk &chunk = _chunks[_chunk_index];
+	uint8_t *const bp = static_cast<uint8_t *>(p);
+	if (bp >= chunk.data && bp + size == chunk.data + _offset) {
+		_offset = bp - chunk.data;
+	}
+}
+
+void LinearAllocator::rewind(Marker marker) {
+	ZN_ASSERT_RETURN(
+			marker.chunk_index < _chunk_index || (marker.chunk_index == _chunk_index && marker.offset <= _offset)
+	);
+	_chunk_index = marker.chunk_index;
+	_offset = marker.offset;
+}
+
+void LinearAllocator::trim(size_t retained_capacity) {
+	// Only chunks after the current one can be freed, previous ones may contain live allocations
+	while (_chunks.size() > _chunk_index + 1 && _capacity > retained_capacity) {
+		Chunk &chunk = _chunks.back();
+		_capacity -= chunk.size;
+		ZN_FREE(chunk.data);
+		_chunks.pop_back();
+	}
+	// The first chunk can go too if nothing is allocated in it
+	if (_chunks.size() == 1 && _offset == 0 && _capacity > retained_capacity) {
+		_capacity -= _chunks[0].size;
+		ZN_FREE(_chunks[0].data);
+		_chunks.clear();
+		_chunk_index = 0;
+	}
+}
+
+size_t LinearAllocator::get_used_size() const {
+	size_t used = _offset;
+	for (unsigned int i = 0; i < _chunk_index; ++i) {
+		used += _chunks[i].size;
+	}
+	return used;
+}
+
+LinearAllocator &get_tls_temp_allocator() {
+	static thread_local LinearAllocator tls_allocator;
+	return tls_allocator;
+}
+
+} // namespace zylann
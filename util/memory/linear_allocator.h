@@ -0,0 +1,137 @@
+#ifndef ZN_LINEAR_ALLOCATOR_H
+#define ZN_LINEAR_ALLOCATOR_H
+
+#include "../containers/std_vector.h"
+#include "../errors.h"
+#include <cstdint>
+#include <limits>
+
+namespace zylann {
+
+// Bump allocator for short-lived temporary memory, such as buffers used during a task or a function call.
+// Allocating is just an offset increment, and memory is reclaimed all at once by rewinding to a previously taken
+// marker, without going through the global heap. Memory is taken from chunks which are kept around for re-use.
+//
+// It is not thread-safe. Each thread has its own instance, see `get_tls_temp_allocator()`.
+//
+// Allocations must be released in LIFO order: a container allocated before a scope must not grow while that scope is
+// active, otherwise its new storage would be reclaimed when the scope ends.
+class LinearAllocator {
+public:
+	static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+	// When trimming, unused chunks are given back to the heap until capacity gets below this.
+	static const size_t DEFAULT_RETAINED_CAPACITY = 1024 * 1024;
+
+	struct Marker {
+		unsigned int chunk_index;
+		size_t offset;
+	};
+
+	LinearAllocator(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+	~LinearAllocator();
+
+	LinearAllocator(const LinearAllocator &) = delete;
+	LinearAllocator &operator=(const LinearAllocator &) = delete;
+
+	[[nodiscard]] void *allocate(size_t size, size_t alignment);
+
+	// Memory is only given back if it was the last allocation. Otherwise it is reclaimed when rewinding.
+	void deallocate(void *p, size_t size);
+
+	inline Marker get_marker() const {
+		return { _chunk_index, _offset };
+	}
+
+	// Frees every allocation made after the marker was taken.
+	void rewind(Marker marker);
+
+	// Gives chunks that are not currently used back to the heap, as long as capacity is above the given amount.
+	void trim(size_t retained_capacity = DEFAULT_RETAINED_CAPACITY);
+
+	size_t get_used_size() const;
+
+	inline size_t get_capacity() const {
+		return _capacity;
+	}
+
+	inline unsigned int get_chunk_count() const {
+		return _chunks.size();
+	}
+
+private:
+	struct Chunk {
+		uint8_t *data;
+		size_t size;
+	};
+
+	void *try_allocate_in_current_chunk(size_t size, size_t alignment);
+
+	StdVector<Chunk> _chunks;
+	unsigned int _chunk_index = 0;
+	size_t _offset = 0;
+	size_t _capacity = 0;
+	size_t _chunk_size;
+};
+
+// Rewinds the allocator to where it was when the scope was created.
+class LinearAllocatorScope {
+public:
+	LinearAllocatorScope(LinearAllocator &allocator) : _allocator(allocator), _marker(allocator.get_marker()) {}
+
+	~LinearAllocatorScope() {
+		_allocator.rewind(_marker);
+	}
+
+	LinearAllocatorScope(const LinearAllocatorScope &) = delete;
+	LinearAllocatorScope &operator=(const LinearAllocatorScope &) = delete;
+
+private:
+	LinearAllocator &_allocator;
+	LinearAllocator::Marker _marker;
+};
+
+// Gets the temporary allocator of the calling thread. Threads of `ThreadedTaskRunner` rewind and trim it after each
+// task, and the main thread trims it every frame.
+LinearAllocator &get_tls_temp_allocator();
+
+// Allocator matching standard library requirements, allocating from a `LinearAllocator`.
+// It has no default constructor, so containers using it must be given the allocator they should use.
+template <class T>
+struct StdLinearAllocator {
+	typedef T value_type;
+
+	LinearAllocator *allocator;
+
+	StdLinearAllocator(LinearAllocator &p_allocator) : allocator(&p_allocator) {}
+
+	template <class U>
+	constexpr StdLinearAllocator(const StdLinearAllocator<U> &other) noexcept : allocator(other.allocator) {}
+
+	[[nodiscard]] T *allocate(std::size_t n) {
+		ZN_ASSERT(n <= std::numeric_limits<std::size_t>::max() / sizeof(T));
+		return static_cast<T *>(allocator->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *p, std::size_t n) noexcept {
+		allocator->deallocate(p, n * sizeof(T));
+	}
+};
+
+template <class T, class U>
+bool operator==(const StdLinearAllocator<T> &a, const StdLinearAllocator<U> &b) {
+	return a.allocator == b.allocator;
+}
+
+template <class T, class U>
+bool operator!=(const StdLinearAllocator<T> &a, const StdLinearAllocator<U> &b) {
+	return a.allocator != b.allocator;
+}
+
+// Vector using temporary memory. It must be destroyed before the scope it was allocated in ends.
+// Growing it repeatedly leaves previous storage unused until rewind, so reserving up-front is preferable.
+template <typename T>
+using StdTempVector = StdVector<T, StdLinearAllocator<T>>;
+
+} // namespace zylann
+
+#endif // ZN_LINEAR_ALLOCATOR_H
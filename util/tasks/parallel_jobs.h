@@ -0,0 +1,104 @@
+#ifndef ZYLANN_PARALLEL_JOBS_H
+#define ZYLANN_PARALLEL_JOBS_H
+
+#include "../containers/span.h"
+#include "../containers/std_vector.h"
+#include "../math/funcs.h"
+#include "../memory/memory.h"
+#include "../thread/semaphore.h"
+#include "threaded_task.h"
+#include <atomic>
+
+namespace zylann {
+
+// Thread pool to which tasks can be pushed, for code that must not depend on which one it is.
+struct TaskScheduler {
+	// Thread-safe.
+	void (*push_tasks)(Span<IThreadedTask *> tasks) = nullptr;
+	// Thread-safe.
+	unsigned int (*get_thread_count)() = nullptr;
+
+	inline bool is_valid() const {
+		return push_tasks != nullptr && get_thread_count != nullptr;
+	}
+};
+
+// Jobs shared between a calling thread and tasks of the thread pool. Each thread takes jobs until there are none left.
+template <typename F>
+struct ParallelJobs {
+	// Only valid while there are jobs left to take
+	F *func = nullptr;
+	uint32_t count = 0;
+	std::atomic_uint32_t next_index = { 0 };
+	std::atomic_uint32_t completed_count = { 0 };
+	Semaphore completed_semaphore;
+
+	void run() {
+		uint32_t index;
+		while ((index = next_index.fetch_add(1)) < count) {
+			(*func)(index);
+			if (completed_count.fetch_add(1) + 1 == count) {
+				completed_semaphore.post();
+			}
+		}
+	}
+};
+
+template <typename F>
+class ParallelJobsTask : public IThreadedTask {
+public:
+	ParallelJobsTask(std::shared_ptr<ParallelJobs<F>> jobs) : _jobs(jobs) {}
+
+	const char *get_debug_name() const override {
+		return "ParallelJobs";
+	}
+
+	void run(ThreadedTaskContext &ctx) override {
+		_jobs->run();
+	}
+
+private:
+	std::shared_ptr<ParallelJobs<F>> _jobs;
+};
+
+// Calls `func(index)` for every index from 0 to `count - 1`, using the given thread pool, and returns once all calls
+// are done. The calling thread takes jobs too, so this completes even if the thread pool is busy, or if it is called
+// from one of its threads. If the scheduler is not valid, all calls happen on the calling thread.
+template <typename F>
+void run_parallel_jobs(uint32_t count, F &func, const TaskScheduler &scheduler) {
+	if (count == 0) {
+		return;
+	}
+
+	if (!scheduler.is_valid() || count == 1) {
+		for (uint32_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	std::shared_ptr<ParallelJobs<F>> jobs = make_shared_instance<ParallelJobs<F>>();
+	jobs->func = &func;
+	jobs->count = count;
+
+	const uint32_t helper_count = math::min(count - 1, static_cast<uint32_t>(scheduler.get_thread_count()));
+	if (helper_count > 0) {
+		StdVector<IThreadedTask *> tasks;
+		tasks.reserve(helper_count);
+		for (uint32_t i = 0; i < helper_count; ++i) {
+			tasks.push_back(ZN_NEW(ParallelJobsTask<F>(jobs)));
+		}
+		scheduler.push_tasks(to_span(tasks));
+	}
+
+	jobs->run();
+
+	// Tasks that start after this point find no job left, and don't access `func`
+	if (jobs->completed_count.load() != count) {
+		jobs->completed_semaphore.wait();
+	}
+}
+
+} // namespace zylann
+
+#endif // ZYLANN_PARALLEL_JOBS_H
@@ -0,0 +1,114 @@
+#include "task_metrics.h"
+#include <cstring>
+
+namespace zylann {
+
+unsigned int DurationHistogram::get_bucket_index(uint64_t usec) {
+	unsigned int i = 0;
+	while (usec > 0 && i < BUCKET_COUNT - 1) {
+		usec >>= 1;
+		++i;
+	}
+	return i;
+}
+
+uint64_t DurationHistogram::get_bucket_upper_bound_usec(unsigned int bucket_index) {
+	return uint64_t(1) << bucket_index;
+}
+
+void DurationHistogram::add(uint64_t usec) {
+	// Relaxed ordering is enough, counters don't need to be consistent with each other when read
+	_buckets[get_bucket_index(usec)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_total_usec.fetch_add(usec, std::memory_order_relaxed);
+
+	uint64_t prev_max = _max_usec.load(std::memory_order_relaxed);
+	while (prev_max < usec && !_max_usec.compare_exchange_weak(prev_max, usec, std::memory_order_relaxed)) {
+	}
+}
+
+DurationHistogram::Snapshot DurationHistogram::get_snapshot() const {
+	Snapshot s;
+	for (unsigned int i = 0; i < BUCKET_COUNT; ++i) {
+		s.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+	}
+	s.count = _count.load(std::memory_order_relaxed);
+	s.total_usec = _total_usec.load(std::memory_order_relaxed);
+	s.max_usec = _max_usec.load(std::memory_order_relaxed);
+	return s;
+}
+
+uint64_t DurationHistogram::Snapshot::get_percentile_usec(float p) const {
+	// Count buckets instead of using `count`, since they may have been read at slightly different times
+	uint64_t bucket_total = 0;
+	for (const uint64_t c : buckets) {
+		bucket_total += c;
+	}
+	if (bucket_total == 0) {
+		return 0;
+	}
+	const uint64_t target = static_cast<uint64_t>(p * bucket_total);
+	uint64_t sum = 0;
+	for (unsigned int i = 0; i < BUCKET_COUNT; ++i) {
+		sum += buckets[i];
+		if (sum > target) {
+			const uint64_t bound = get_bucket_upper_bound_usec(i);
+			return bound < max_usec ? bound : max_usec;
+		}
+	}
+	return max_usec;
+}
+
+TaskMetrics::TaskType *TaskMetrics::find_task_type(const char *name, unsigned int count) {
+	// Debug names are usually string literals, so comparing pointers is often enough
+	for (unsigned int i = 0; i < count; ++i) {
+		if (_task_types[i].name == name) {
+			return &_task_types[i];
+		}
+	}
+	for (unsigned int i = 0; i < count; ++i) {
+		if (strcmp(_task_types[i].name, name) == 0) {
+			return &_task_types[i];
+		}
+	}
+	return nullptr;
+}
+
+TaskMetrics::TaskType &TaskMetrics::get_or_create_task_type(const char *name) {
+	if (name == nullptr) {
+		name = "<unnamed>";
+	}
+
+	TaskType *task_type = find_task_type(name, _task_type_count.load(std::memory_order_acquire));
+	if (task_type != nullptr) {
+		return *task_type;
+	}
+
+	MutexLock lock(_task_types_mutex);
+
+	// Might have been added by another thread in the meantime
+	const unsigned int count = _task_type_count.load(std::memory_order_acquire);
+	task_type = find_task_type(name, count);
+	if (task_type != nullptr) {
+		return *task_type;
+	}
+
+	if (count == MAX_TASK_TYPES - 1) {
+		// Keep the last slot for everything that doesn't fit
+		TaskType &other = _task_types[count];
+		other.name = "<other>";
+		_task_type_count.store(count + 1, std::memory_order_release);
+		return other;
+	}
+	if (count == MAX_TASK_TYPES) {
+		return _task_types[MAX_TASK_TYPES - 1];
+	}
+
+	TaskType &new_type = _task_types[count];
+	new_type.name = name;
+	// Readers only access types below the count, so the name must be written before it is published
+	_task_type_count.store(count + 1, std::memory_order_release);
+	return new_type;
+}
+
+} // namespace zylann
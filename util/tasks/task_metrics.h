@@ -0,0 +1,89 @@
+#ifndef ZN_TASK_METRICS_H
+#define ZN_TASK_METRICS_H
+
+#include "../containers/fixed_array.h"
+#include "../thread/mutex.h"
+#include <atomic>
+#include <cstdint>
+
+namespace zylann {
+
+// Distribution of durations in power-of-two buckets of microseconds.
+// Recording is lock-free and cheap enough to be always enabled, unlike profiler instrumentation.
+class DurationHistogram {
+public:
+	// Bucket 0 counts durations under 1 microsecond, bucket `i` counts durations in [2^(i-1), 2^i).
+	// The last bucket also counts anything longer.
+	static constexpr unsigned int BUCKET_COUNT = 24;
+
+	struct Snapshot {
+		uint64_t count = 0;
+		uint64_t total_usec = 0;
+		uint64_t max_usec = 0;
+		FixedArray<uint64_t, BUCKET_COUNT> buckets;
+
+		Snapshot() {
+			fill(buckets, uint64_t(0));
+		}
+
+		double get_mean_usec() const {
+			return count > 0 ? static_cast<double>(total_usec) / count : 0.0;
+		}
+
+		// Approximated to the upper bound of the bucket containing the percentile. `p` is from 0 to 1.
+		uint64_t get_percentile_usec(float p) const;
+	};
+
+	void add(uint64_t usec);
+	Snapshot get_snapshot() const;
+
+	static unsigned int get_bucket_index(uint64_t usec);
+	static uint64_t get_bucket_upper_bound_usec(unsigned int bucket_index);
+
+private:
+	std::atomic_uint64_t _buckets[BUCKET_COUNT] = {};
+	std::atomic_uint64_t _count = { 0 };
+	std::atomic_uint64_t _total_usec = { 0 };
+	std::atomic_uint64_t _max_usec = { 0 };
+};
+
+// Metrics of tasks run by a `ThreadedTaskRunner`, grouped by task type.
+class TaskMetrics {
+public:
+	// Tasks are grouped using their debug name. Types beyond this limit are counted together.
+	static constexpr unsigned int MAX_TASK_TYPES = 64;
+
+	struct TaskType {
+		// Points to the debug name of the first task recorded with this type
+		const char *name = nullptr;
+		// Time spent between being scheduled and starting to run
+		DurationHistogram queue_wait;
+		DurationHistogram run;
+		std::atomic_uint64_t completed_count = { 0 };
+		// Tasks that reported `is_cancelled()` before running
+		std::atomic_uint64_t cancelled_count = { 0 };
+		std::atomic_uint64_t postponed_count = { 0 };
+	};
+
+	// Thread-safe. Lookups don't lock, only the first occurrence of a new task type does.
+	TaskType &get_or_create_task_type(const char *name);
+
+	unsigned int get_task_type_count() const {
+		return _task_type_count.load(std::memory_order_acquire);
+	}
+
+	const TaskType &get_task_type(unsigned int i) const {
+		return _task_types[i];
+	}
+
+private:
+	TaskType *find_task_type(const char *name, unsigned int count);
+
+	FixedArray<TaskType, MAX_TASK_TYPES> _task_types;
+	std::atomic_uint32_t _task_type_count = { 0 };
+	Mutex _task_types_mutex;
+};
+
+} // namespace zylann
+
+#endif // ZN_TASK_METRICS_H
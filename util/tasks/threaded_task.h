@@ -6,6 +6,8 @@
 
 namespace zylann {
 
+class LinearAllocator;
+
 struct ThreadedTaskContext {
 	enum Status : uint8_t {
 		// The task is complete and will be put in the list of completed tasks by the TaskRunner. It will be deleted
@@ -26,16 +28,20 @@ struct ThreadedTaskContext {
 	Status status;
 	// Cached priority of the current task. May be useful to copy if the current task spawns other related tasks.
 	const TaskPriority task_priority;
+	// Temporary memory of the current thread. Anything allocated from it is reclaimed after the task runs, so it can
+	// be used for task-local buffers without going through the heap. See `LinearAllocator`.
+	LinearAllocator &temp_allocator;
 	// If this is set to a non-null task, it will run right after the current one on the same thread.
 	// By doing so, ownership is given to ThreadedTaskRunner. These tasks must not have been owned by the runner
 	// already. Priority of such tasks is not relevant.
 	// IThreadedTask *next_immediate_task;
 
-	ThreadedTaskContext(uint8_t p_thread_index, TaskPriority p_priority) :
+	ThreadedTaskContext(uint8_t p_thread_index, TaskPriority p_priority, LinearAllocator &p_temp_allocator) :
 			thread_index(p_thread_index),
 			// By default, if the task does not set this status, it will be considered complete after run
 			status(STATUS_COMPLETE),
-			task_priority(p_priority) {}
+			task_priority(p_priority),
+			temp_allocator(p_temp_allocator) {}
 
 	// To allow scheduling tasks from within tasks, without having to pass it in or use a global
 	// ThreadedTaskRunner &runner;
@@ -1,6 +1,7 @@
 #include "threaded_task_runner.h"
 #include "../dstack.h"
 #include "../godot/classes/time.h"
+#include "../memory/linear_allocator.h"
 #include "../profiling.h"
 #include "../string/format.h"
 
@@ -107,6 +108,7 @@ void ThreadedTaskRunner::enqueue(IThreadedTask *task, bool serial) {
 	TaskItem t;
 	t.task = task;
 	t.is_serial = serial;
+	t.queued_time_usec = Time::get_singleton()->get_ticks_usec();
 	{
 		MutexLock lock(_staged_tasks_mutex);
 		_staged_tasks.push_back(t);
@@ -127,6 +129,7 @@ void ThreadedTaskRunner::enqueue(Span<IThreadedTask *> new_tasks, bool serial) {
 		ZN_ASSERT(new_tasks[i] != nullptr);
 	}
 #endif
+	const uint64_t now_usec = Time::get_singleton()->get_ticks_usec();
 	{
 		MutexLock lock(_staged_tasks_mutex);
 		const size_t dst_begin = _staged_tasks.size();
@@ -136,6 +139,7 @@ void ThreadedTaskRunner::enqueue(Span<IThreadedTask *> new_tasks, bool serial) {
 			TaskItem t;
 			t.task = new_task;
 			t.is_serial = serial;
+			t.queued_time_usec = now_usec;
 			_staged_tasks[dst_begin + i] = t;
 
 #ifdef ZN_THREADED_TASK_RUNNER_CHECK_DUPLICATE_TASKS
@@ -228,6 +232,8 @@ void ThreadedTaskRunner::thread_func(ThreadData &data) {
 								item.cached_priority = item.task->get_priority();
 
 								if (item.task->is_cancelled()) {
+									_metrics.get_or_create_task_type(item.task->get_debug_name())
+											.cancelled_count.fetch_add(1, std::memory_order_relaxed);
 									cancelled_tasks.push_back(item.task);
 									_tasks[i] = _tasks.back();
 									_tasks.pop_back();
@@ -325,14 +331,27 @@ void ThreadedTaskRunner::thread_func(ThreadData &data) {
 		} else {
 			data.debug_state = STATE_RUNNING;
 
+			LinearAllocator &temp_allocator = get_tls_temp_allocator();
+
 			// Run each task
 			for (size_t i = 0; i < tasks.size(); ++i) {
 				TaskItem &item = tasks[i];
 
+				// Get the name before running, tasks taken out may be destroyed by another thread right after
+				const char *task_name = item.task->get_debug_name();
+				TaskMetrics::TaskType &task_metrics = _metrics.get_or_create_task_type(task_name);
+
 				if (!item.task->is_cancelled()) {
-					ThreadedTaskContext ctx(data.index, item.cached_priority);
-					data.debug_running_task_name = item.task->get_debug_name();
-					item.task->run(ctx);
+					const uint64_t start_time_usec = Time::get_singleton()->get_ticks_usec();
+					task_metrics.queue_wait.add(start_time_usec - item.queued_time_usec);
+
+					ThreadedTaskContext ctx(data.index, item.cached_priority, temp_allocator);
+					data.debug_running_task_name = task_name;
+					{
+						// Reclaim temporary memory even if the task didn't scope its allocations
+						LinearAllocatorScope temp_scope(temp_allocator);
+						item.task->run(ctx);
+					}
 #ifdef ZN_THREADED_TASK_RUNNER_CHECK_DUPLICATE_TASKS
 					if (ctx.status == ThreadedTaskContext::STATUS_TAKEN_OUT) {
 						debug_remove_owned_task(item.task);
@@ -341,6 +360,16 @@ void ThreadedTaskRunner::thread_func(ThreadData &data) {
 					item.status = ctx.status;
 					data.debug_running_task_name = nullptr;
 
+					const uint64_t end_time_usec = Time::get_singleton()->get_ticks_usec();
+					task_metrics.run.add(end_time_usec - start_time_usec);
+
+					if (ctx.status == ThreadedTaskContext::STATUS_POSTPONED) {
+						task_metrics.postponed_count.fetch_add(1, std::memory_order_relaxed);
+						item.queued_time_usec = end_time_usec;
+					} else {
+						task_metrics.completed_count.fetch_add(1, std::memory_order_relaxed);
+					}
+
 					/*
 					if (ctx.next_immediate_task != nullptr) {
 						TaskItem next;
@@ -351,6 +380,8 @@ void ThreadedTaskRunner::thread_func(ThreadData &data) {
 						tasks.push_back(next);
 					}
 					*/
+				} else {
+					task_metrics.cancelled_count.fetch_add(1, std::memory_order_relaxed);
 				}
 			}
 
@@ -391,6 +422,9 @@ void ThreadedTaskRunner::thread_func(ThreadData &data) {
 
 			tasks.clear();
 
+			// Don't keep temporary memory from occasional big tasks forever
+			temp_allocator.trim();
+
 			{
 				MutexLock lock(_spinning_tasks_mutex);
 				for (const TaskItem &item : postponed_tasks) {
@@ -11,6 +11,7 @@
 #include "../thread/mutex.h"
 #include "../thread/semaphore.h"
 #include "../thread/thread.h"
+#include "task_metrics.h"
 #include "threaded_task.h"
 
 // For debugging
@@ -96,6 +97,11 @@ public:
 	const char *get_thread_debug_task_name(unsigned int thread_index) const;
 	unsigned int get_debug_remaining_tasks() const;
 
+	// Always collected, regardless of profiling being enabled
+	const TaskMetrics &get_metrics() const {
+		return _metrics;
+	}
+
 private:
 	static StdVector<IThreadedTask *> &get_completed_tasks_temp_tls();
 
@@ -104,6 +110,8 @@ private:
 		TaskPriority cached_priority;
 		bool is_serial = false;
 		ThreadedTaskContext::Status status = ThreadedTaskContext::STATUS_COMPLETE;
+		// When the task was scheduled (or postponed), to measure how long it waits before running
+		uint64_t queued_time_usec = 0;
 	};
 
 	struct ThreadData {
@@ -173,6 +181,8 @@ private:
 	unsigned int _debug_completed_tasks = 0;
 	unsigned int _debug_taken_out_tasks = 0;
 
+	TaskMetrics _metrics;
+
 #ifdef ZN_THREADED_TASK_RUNNER_CHECK_DUPLICATE_TASKS
 	StdUnorderedMap<IThreadedTask *, StdString> _debug_owned_tasks;
 	Mutex _debug_owned_tasks_mutex;
@@ -0,0 +1,77 @@
+#include "benchmark.h"
+#include "../errors.h"
+#include "../godot/classes/json.h"
+#include "../godot/core/array.h"
+#include "../godot/core/dictionary.h"
+#include "../io/log.h"
+#include "../string/format.h"
+#include <algorithm>
+
+namespace zylann::testing {
+
+void BenchmarkRunner::set_min_iterations(uint32_t count) {
+	ZN_ASSERT_RETURN(count >= 1);
+	_min_iterations = count;
+}
+
+void BenchmarkRunner::set_max_iterations(uint32_t count) {
+	ZN_ASSERT_RETURN(count >= 1);
+	_max_iterations = count;
+}
+
+void BenchmarkRunner::add_result(const char *name, const char *unit, uint64_t items_per_iteration) {
+	ZN_ASSERT_RETURN(_samples.size() > 0);
+
+	Result result;
+	result.name = name;
+	result.unit = unit;
+	result.items_per_iteration = items_per_iteration;
+	result.iterations = _samples.size();
+
+	uint64_t sum = 0;
+	for (const uint64_t t : _samples) {
+		sum += t;
+	}
+	result.mean_usec = static_cast<double>(sum) / _samples.size();
+
+	std::sort(_samples.begin(), _samples.end());
+	result.min_usec = _samples.front();
+	result.max_usec = _samples.back();
+	result.median_usec = _samples[_samples.size() / 2];
+
+	print_line(format(
+			"Benchmark `{}`: median {} us, mean {} us, {} iterations",
+			result.name,
+			result.median_usec,
+			result.mean_usec,
+			result.iterations
+	));
+
+	_results.push_back(result);
+}
+
+String BenchmarkRunner::to_json(Dictionary root) const {
+	Array results;
+
+	for (const Result &result : _results) {
+		Dictionary d;
+		d["name"] = String(result.name.c_str());
+		d["unit"] = String(result.unit.c_str());
+		d["items_per_iteration"] = result.items_per_iteration;
+		d["iterations"] = result.iterations;
+		d["min_usec"] = result.min_usec;
+		d["max_usec"] = result.max_usec;
+		d["median_usec"] = result.median_usec;
+		d["mean_usec"] = result.mean_usec;
+		// Based on the median, which is less sensitive to outliers
+		d["items_per_second"] = result.median_usec > 0
+				? static_cast<double>(result.items_per_iteration) * 1'000'000.0 / result.median_usec
+				: 0.0;
+		results.append(d);
+	}
+
+	root["benchmarks"] = results;
+	return JSON::stringify(root, "\t", false);
+}
+
+} // namespace zylann::testing
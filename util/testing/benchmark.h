@@ -0,0 +1,85 @@
+#ifndef ZN_BENCHMARK_H
+#define ZN_BENCHMARK_H
+
+#include "../containers/std_vector.h"
+#include "../godot/core/dictionary.h"
+#include "../godot/core/string.h"
+#include "../profiling.h"
+#include "../profiling_clock.h"
+#include "../string/std_string.h"
+#include "test_options.h"
+
+namespace zylann::testing {
+
+// Measures how long pieces of code take to run, and collects results so they can be exported as JSON.
+// No framework is used, similarly to tests.
+class BenchmarkRunner {
+public:
+	struct Result {
+		StdString name;
+		// What each iteration processes (voxels, blocks, tasks...)
+		StdString unit;
+		uint64_t items_per_iteration;
+		uint32_t iterations;
+		uint64_t min_usec;
+		uint64_t max_usec;
+		uint64_t median_usec;
+		double mean_usec;
+	};
+
+	BenchmarkRunner(const TestOptions &options) : _options(options) {}
+
+	// Each benchmark keeps running until both the minimum duration and minimum iteration count are reached.
+	void set_min_duration_usec(uint64_t usec) {
+		_min_duration_usec = usec;
+	}
+
+	void set_min_iterations(uint32_t count);
+	void set_max_iterations(uint32_t count);
+
+	bool can_run(const char *group_name) const {
+		return _options.can_run_print(group_name);
+	}
+
+	// Calls `f` repeatedly and records how long each call takes. A first call is done without being measured, so
+	// caches, pools and lazy initializations don't skew results.
+	template <typename F>
+	void run(const char *name, const char *unit, uint64_t items_per_iteration, F f) {
+		ZN_PROFILE_SCOPE();
+		f();
+
+		_samples.clear();
+		ProfilingClock total_clock;
+		ProfilingClock clock;
+
+		while (_samples.size() < _min_iterations ||
+			   (total_clock.get_elapsed_microseconds() < _min_duration_usec && _samples.size() < _max_iterations)) {
+			clock.restart();
+			f();
+			_samples.push_back(clock.get_elapsed_microseconds());
+		}
+
+		add_result(name, unit, items_per_iteration);
+	}
+
+	const StdVector<Result> &get_results() const {
+		return _results;
+	}
+
+	// Results are added to `root` under the "benchmarks" key, so callers can add their own information.
+	String to_json(Dictionary root) const;
+
+private:
+	void add_result(const char *name, const char *unit, uint64_t items_per_iteration);
+
+	const TestOptions &_options;
+	uint64_t _min_duration_usec = 500'000;
+	uint32_t _min_iterations = 3;
+	uint32_t _max_iterations = 100'000;
+	StdVector<uint64_t> _samples;
+	StdVector<Result> _results;
+};
+
+} // namespace zylann::testing
+
+#endif // ZN_BENCHMARK_H